@@ -0,0 +1,37 @@
+'use strict';
+
+
+// "CrossOriginIsolationWorker.js" is a service worker that adds the headers for cross origin isolation to every response it serves.
+// Cross origin isolation is what allows SharedArrayBuffer and Atomics.wait(), which a "RasterWorkerPool" needs to run at all.
+// Servers that can set headers should set these on every response instead, and then this worker is never registered:
+//   Cross-Origin-Opener-Policy: same-origin
+//   Cross-Origin-Embedder-Policy: require-corp
+// Static hosts such as github pages can't set them, so "index.html" registers this worker under "?worker" when the page is not isolated.
+// It lives at the root of the site, since a service worker only controls pages at or below its own path.
+self.addEventListener('install', function() {
+    self.skipWaiting();
+});
+self.addEventListener('activate', function(event) {
+    event.waitUntil(self.clients.claim());
+});
+self.addEventListener('fetch', function(event) {
+    var request = event.request;
+    // NOTE: requests of this mode can only be fetched from the same origin, and throw otherwise
+    if (request.cache === 'only-if-cached' && request.mode !== 'same-origin') {
+        return;
+    }
+    event.respondWith(fetch(request).then(function(response) {
+        // opaque responses can't be modified, and are blocked by the embedder policy anyway
+        if (response.status === 0) {
+            return response;
+        }
+        var headers = new Headers(response.headers);
+        headers.set('Cross-Origin-Opener-Policy', 'same-origin');
+        headers.set('Cross-Origin-Embedder-Policy', 'require-corp');
+        return new Response(response.body, {
+            status:     response.status,
+            statusText: response.statusText,
+            headers:    headers,
+        });
+    }));
+});
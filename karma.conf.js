@@ -21,7 +21,16 @@ module.exports = function (config) {
               'noncompiled/academics/OrbitalMechanics.js',
               'tests/scripts/Academics.js',
 
+              'noncompiled/Profiler.js',
               'noncompiled/models/Memo.js',
+              'noncompiled/models/Scheduler.js',
+              'tests/scripts/Models.js',
+
+              'libraries/base64-arraybuffer.js',
+              'noncompiled/file-io/JsonSerializer.js',
+              'noncompiled/file-io/BinarySerializer.js',
+              'tests/scripts/FileIO.js',
+
               'noncompiled/generators/CrustGenerator.js',
               'noncompiled/academics/Hydrology.js',
               'noncompiled/academics/FluidMechanics.js',
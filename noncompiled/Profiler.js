@@ -0,0 +1,288 @@
+'use strict';
+
+// The Profiler records how long the hot paths of a frame take, so that stalls can be traced to the code that caused them.
+// It does nothing unless "Profiler.is_enabled" is set, e.g. by the "?profile" querystring of index.html.
+//
+// Time is recorded as "events", each with a name, a category, a start, and a duration, in milliseconds:
+//   "frame"   each Simulation.update()
+//   "model"   the invalidate(), calcChanges(), and applyChanges() of each subsystem of a world, see "Profiler.instrument"
+//   "memo"    each recomputed Memo, by the name that it reports to "Memo.timings"
+//   "view"    the updates of views, which includes uploading rasters to the gpu
+//   "gpu"     each pass of a view's composer, timed on the gpu if possible, see "Profiler.GpuTimer"
+// Some values are instead recorded as "counters" once a frame, such as the memory used by "RasterStackBuffer.scratchpad".
+// Events are aggregated into a rolling histogram for each name, see "Profiler.Histogram", which is shown by "Profiler.Overlay",
+//   and both events and counters can be exported in the trace event format of chrome://tracing, see "Profiler.get_trace".
+// Events of a simulation that runs within a worker are posted with its snapshots, see "Profiler.take_events".
+var Profiler = {};
+Profiler.is_enabled = false;
+// the most recent events that are kept for "get_trace", older events are dropped
+Profiler.MAX_EVENT_COUNT = 100000;
+// the thread ids under which events are exported, see "get_trace"
+Profiler.MAIN_THREAD = 1;
+Profiler.GPU_THREAD = 2;
+Profiler.WORKER_THREAD = 3;
+Profiler.THREAD_NAMES = { 1: 'main', 2: 'gpu', 3: 'simulation worker' };
+Profiler.events = [];
+Profiler.histograms = {};
+
+// "record" records an event that started at "start", as given by performance.now(), and lasted for "milliseconds"
+Profiler.record = function(name, category, start, milliseconds, thread) {
+    var events = Profiler.events;
+    events.push({ name: name, cat: category, ph: 'X', ts: start*1000, dur: milliseconds*1000, pid: 1, tid: thread || Profiler.MAIN_THREAD });
+    if (events.length > Profiler.MAX_EVENT_COUNT) {
+        events.splice(0, events.length - Profiler.MAX_EVENT_COUNT/2);
+    }
+    if (Profiler.histograms[name] === void 0) {
+        Profiler.histograms[name] = new Profiler.Histogram(name, category);
+    }
+    Profiler.histograms[name].add(milliseconds);
+}
+// "count" records the values of a counter, an object of numbers
+Profiler.count = function(name, values) {
+    var events = Profiler.events;
+    events.push({ name: name, cat: 'counter', ph: 'C', ts: performance.now()*1000, pid: 1, tid: Profiler.MAIN_THREAD, args: values });
+}
+// "instrument" replaces each method of "object" that's named in "method_names" with one that records an event,
+//   named by "prefix" and the method, whenever the profiler is enabled
+Profiler.instrument = function(object, prefix, method_names, category) {
+    method_names.forEach(function(method_name) {
+        var method = object[method_name];
+        var name = prefix + '.' + method_name;
+        object[method_name] = function() {
+            if (!Profiler.is_enabled) {
+                return method.apply(this, arguments);
+            }
+            var start = performance.now();
+            try {
+                return method.apply(this, arguments);
+            } finally {
+                Profiler.record(name, category, start, performance.now() - start);
+            }
+        };
+    });
+}
+// "count_rasters" records counters for the memory that raster functions use for temporaries, see "Simulation.update"
+// The peak of the scratchpad is reset, so each counter describes the frame since the last.
+Profiler.count_rasters = function() {
+    var scratchpad = RasterStackBuffer.scratchpad;
+    var pool = RasterPool.scratchpad;
+    Profiler.count('RasterStackBuffer.scratchpad', { peak_bytes: scratchpad.peak_pos, allocation_count: scratchpad.allocation_count });
+    Profiler.count('RasterPool.scratchpad', { acquire_count: pool.acquire_count, create_count: pool.create_count });
+    scratchpad.peak_pos = scratchpad.pos;
+    scratchpad.allocation_count = 0;
+    pool.acquire_count = 0;
+    pool.create_count = 0;
+}
+
+// "take_events" returns the events that were recorded since it was last called, and forgets them,
+//   so that a worker can post them to the main thread, where they're added with "add_events"
+Profiler.take_events = function() {
+    var events = Profiler.events;
+    Profiler.events = [];
+    return { time_origin: performance.timeOrigin, events: events };
+}
+// "add_events" adds events that were taken from a worker, under the thread id "thread"
+// NOTE: times are relative to the time origin of the thread that recorded them, so they are shifted to our own
+Profiler.add_events = function(taken, thread) {
+    var offset = taken.time_origin - performance.timeOrigin;
+    for (var event of taken.events) {
+        if (event.ph === 'X') {
+            Profiler.record(event.name, event.cat, event.ts/1000 + offset, event.dur/1000, thread);
+        } else {
+            event.ts += offset * 1000;
+            event.tid = thread;
+            Profiler.events.push(event);
+        }
+    }
+}
+
+Profiler.reset = function() {
+    Profiler.events = [];
+    Profiler.histograms = {};
+}
+// "get_trace" returns the events that were recorded as an object that chrome://tracing can load once it's written as JSON
+Profiler.get_trace = function() {
+    var metadata = Object.keys(Profiler.THREAD_NAMES).map(tid =>
+        ({ name: 'thread_name', ph: 'M', pid: 1, tid: parseInt(tid), args: { name: Profiler.THREAD_NAMES[tid] } }));
+    return { traceEvents: metadata.concat(Profiler.events), displayTimeUnit: 'ms' };
+}
+// "get_summaries" returns the summaries of every histogram, see "Profiler.Histogram", those with the most time first
+Profiler.get_summaries = function() {
+    return Object.values(Profiler.histograms).map(histogram => histogram.get_summary()).sort((a,b) => b.total - a.total);
+}
+
+// A Histogram keeps the durations of the last SAMPLE_COUNT events of a name, in milliseconds,
+//   and sorts them into buckets whose upper bounds are BUCKET_BOUNDS, with a last bucket for anything greater
+Profiler.Histogram = function(name, category) {
+    this.name = name;
+    this.category = category;
+    this.samples = new Float32Array(Profiler.Histogram.SAMPLE_COUNT);
+    this.sample_count = 0;
+    this.next = 0;
+}
+Profiler.Histogram.SAMPLE_COUNT = 256;
+Profiler.Histogram.BUCKET_BOUNDS = [0.01, 0.03, 0.1, 0.3, 1, 3, 10, 30, 100, 300];
+Profiler.Histogram.prototype.add = function(milliseconds) {
+    this.samples[this.next] = milliseconds;
+    this.next = (this.next + 1) % this.samples.length;
+    this.sample_count = Math.min(this.sample_count + 1, this.samples.length);
+}
+// "get_summary" returns statistics of the samples: { name, category, count, total, mean, min, median, p95, max, buckets }
+Profiler.Histogram.prototype.get_summary = function() {
+    var sorted = this.samples.slice(0, this.sample_count).sort();
+    var bounds = Profiler.Histogram.BUCKET_BOUNDS;
+    var buckets = new Array(bounds.length + 1).fill(0);
+    var total = 0;
+    for (var i = 0; i < sorted.length; i++) {
+        var bucket = 0;
+        while (bucket < bounds.length && sorted[i] > bounds[bucket]) {
+            bucket++;
+        }
+        buckets[bucket]++;
+        total += sorted[i];
+    }
+    var count = sorted.length;
+    return {
+        name:       this.name,
+        category:   this.category,
+        count:      count,
+        total:      total,
+        mean:       count > 0? total / count : 0,
+        min:        count > 0? sorted[0] : 0,
+        median:     count > 0? sorted[Math.floor(count/2)] : 0,
+        p95:        count > 0? sorted[Math.min(Math.floor(count*0.95), count-1)] : 0,
+        max:        count > 0? sorted[count-1] : 0,
+        buckets:    buckets,
+    };
+}
+
+// A GpuTimer times draw calls using EXT_disjoint_timer_query, if "gl" supports it.
+// Otherwise it times them on the cpu, waiting for the gpu to finish with gl.finish(),
+//   which also counts the time needed to submit them, and stalls the pipeline, so it's only good for comparing runs that use it.
+// "timer" is "gpu" or "cpu" depending on which is used.
+// Only one query may be active at a time, so "begin" and "end" must not be nested.
+Profiler.GpuTimer = function(gl) {
+    var extension = gl.getExtension('EXT_disjoint_timer_query');
+    var start = 0;
+    var pending = [];
+    this.timer = extension !== null? 'gpu' : 'cpu';
+    // "begin" starts timing, and "on_milliseconds" is called with the time once it's known, see "poll"
+    this.begin = function(on_milliseconds) {
+        if (extension !== null) {
+            var query = extension.createQueryEXT();
+            extension.beginQueryEXT(extension.TIME_ELAPSED_EXT, query);
+            pending.push({ query: query, on_milliseconds: on_milliseconds });
+        } else {
+            gl.finish();
+            start = performance.now();
+            pending.push({ on_milliseconds: on_milliseconds });
+        }
+    }
+    this.end = function() {
+        if (extension !== null) {
+            extension.endQueryEXT(extension.TIME_ELAPSED_EXT);
+        } else {
+            gl.finish();
+            pending[pending.length-1].milliseconds = performance.now() - start;
+        }
+    }
+    // "poll" calls back every query whose result is available, and returns the number of queries that are still pending
+    // Results of a "disjoint" period, such as one where the gpu changed its clock speed, are dropped.
+    this.poll = function() {
+        var is_disjoint = extension !== null && gl.getParameter(extension.GPU_DISJOINT_EXT);
+        while (pending.length > 0) {
+            var entry = pending[0];
+            if (extension !== null) {
+                if (!extension.getQueryObjectEXT(entry.query, extension.QUERY_RESULT_AVAILABLE_EXT)) {
+                    break;
+                }
+                if (!is_disjoint) {
+                    entry.on_milliseconds(extension.getQueryObjectEXT(entry.query, extension.QUERY_RESULT_EXT) / 1e6);
+                }
+                extension.deleteQueryEXT(entry.query);
+            } else {
+                entry.on_milliseconds(entry.milliseconds);
+            }
+            pending.shift();
+        }
+        return pending.length;
+    }
+}
+// "instrument_pass" replaces the render() of "pass", a pass of an EffectComposer,
+//   with one that's timed by "gpu_timer" whenever the profiler is enabled, and recorded as an event of "name"
+// The name is kept as "pass.profiled_name", which can be changed later, e.g. if the pass changes shaders.
+Profiler.instrument_pass = function(pass, name, gpu_timer) {
+    var render = pass.render;
+    pass.profiled_name = name;
+    pass.render = function() {
+        if (!Profiler.is_enabled) {
+            return render.apply(this, arguments);
+        }
+        var start = performance.now();
+        var name = pass.profiled_name;
+        gpu_timer.begin(milliseconds => Profiler.record(name, 'gpu', start, milliseconds, Profiler.GPU_THREAD));
+        try {
+            return render.apply(this, arguments);
+        } finally {
+            gpu_timer.end();
+        }
+    };
+}
+
+// An Overlay shows the summaries of histograms within "parent", a DOM element, at most every UPDATE_MILLISECONDS,
+//   along with a link that downloads the trace, see "get_trace"
+Profiler.Overlay = function(parent) {
+    var element = document.createElement('div');
+    element.style.cssText = 'position:fixed; left:0; bottom:0; z-index:100; max-height:50%; overflow:auto; ' +
+        'background:rgba(0,0,0,0.7); color:white; font:11px monospace; padding:4px; pointer-events:auto;';
+    var link = document.createElement('a');
+    link.textContent = 'export trace';
+    link.href = '#';
+    link.style.color = 'white';
+    link.addEventListener('click', function(event) {
+        event.preventDefault();
+        var blob = new Blob([JSON.stringify(Profiler.get_trace())], { type: 'application/json' });
+        var download = document.createElement('a');
+        download.href = URL.createObjectURL(blob);
+        download.download = 'tectonics-trace.json';
+        download.click();
+        URL.revokeObjectURL(download.href);
+    });
+    var table = document.createElement('pre');
+    table.style.margin = '0';
+    element.appendChild(link);
+    element.appendChild(table);
+    parent.appendChild(element);
+
+    var last_update = 0;
+    this.update = function() {
+        var now = performance.now();
+        if (now - last_update < Profiler.Overlay.UPDATE_MILLISECONDS) {
+            return;
+        }
+        last_update = now;
+        var lines = ['name'.padEnd(48) + 'count  median     p95     max  histogram (' +
+            Profiler.Histogram.BUCKET_BOUNDS[0] + 'ms ... ' + Profiler.Histogram.BUCKET_BOUNDS.slice(-1)[0] + 'ms+)'];
+        for (var summary of Profiler.get_summaries().slice(0, Profiler.Overlay.MAX_ROW_COUNT)) {
+            lines.push(
+                (summary.category + ' ' + summary.name).slice(0, 47).padEnd(48) +
+                summary.count.toString().padStart(5) +
+                summary.median.toFixed(2).padStart(8) +
+                summary.p95.toFixed(2).padStart(8) +
+                summary.max.toFixed(2).padStart(8) + '  ' +
+                Profiler.Overlay.get_sparkline(summary.buckets));
+        }
+        table.textContent = lines.join('\n');
+    }
+    this.remove = function() {
+        parent.removeChild(element);
+    }
+}
+Profiler.Overlay.UPDATE_MILLISECONDS = 500;
+Profiler.Overlay.MAX_ROW_COUNT = 30;
+// "get_sparkline" returns a line of block characters, one for each of "buckets", whose heights are proportional to its counts
+Profiler.Overlay.get_sparkline = function(buckets) {
+    var blocks = ' ▁▂▃▄▅▆▇█';
+    var max = Math.max(...buckets, 1);
+    return buckets.map(count => blocks[Math.ceil(count / max * (blocks.length-1))]).join('');
+}
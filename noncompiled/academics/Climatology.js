@@ -40,7 +40,9 @@ var Climatology = (function() {
     }
     Climatology.guess_surface_air_pressures = function(temperature, lat, material_heat_capacity, atmospheric_height, result, scratch) {
         result = result || Float32Raster(lat.grid);
-        scratch = scratch || Float32Raster(lat.grid);
+        var pool = RasterPool.scratchpad;
+        pool.allocate('Climatology.guess_surface_air_pressures');
+        scratch = scratch || pool.getFloat32Raster(lat.grid);
 
         surface_air_pressure_lat_effect(lat, result);
 
@@ -50,6 +52,7 @@ var Climatology = (function() {
         ScalarField.add_scalar_term(result, temperature_effect, 3, result);
         Float32Dataset.normalize(result, result, 980e3, 1030e3);
 
+        pool.deallocate('Climatology.guess_surface_air_pressures');
         return result;
     }
     Climatology.guess_precipitation_fluxes = function(lat, result) {
@@ -17,7 +17,9 @@ FluidMechanics.get_fluid_pressures = function(buoyancy, pressure, scratch) {
     var fine_pressure = pressure;
 
     fine_pressure = fine_pressure || Float32Raster(fine_grid);
-    scratch = scratch || Float32Raster(fine_grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('FluidMechanics.get_fluid_pressures');
+    scratch = scratch || pool.getFloat32Raster(fine_grid);
 
     ScalarField.mult_scalar(fine_buoyancy, -1, fine_pressure);
 
@@ -25,21 +27,18 @@ FluidMechanics.get_fluid_pressures = function(buoyancy, pressure, scratch) {
     // This is a very costly operation, and it's output is dependant on grid resolution,
     // so we resample buoyancy onto to a constantly defined, coarse grid 
     // This way, we guarantee performant behavior that's invariant to resolution.
-    var diffuse = ScalarField.diffusion_by_constant;
+    // Iterations run on the gpu where possible, and results are only read back once all iterations are done.
+    var diffuse = ScalarField.diffusion_by_constant_iterations;
 
     // smooth at fine resolution a few times so that coarse resolution does not capture random details
-    for (var i=0; i<3; ++i) {
-        diffuse(fine_pressure, 1, fine_pressure, scratch);
-    }
+    diffuse(fine_pressure, 1, 3, fine_pressure, scratch);
 
     // convert to coarse resolution
     var coarse_ids = fine_grid.getNearestIds(coarse_grid.pos);
-    var coarse_pressure = Float32Raster.get_ids(fine_pressure, coarse_ids);
+    var coarse_pressure = Float32Raster.get_ids(fine_pressure, coarse_ids, pool.getFloat32Raster(coarse_grid));
 
     // smooth at coarse resolution
-    for (var i=0; i<30; ++i) {
-        diffuse(coarse_pressure, 1, coarse_pressure, scratch);
-    }
+    diffuse(coarse_pressure, 1, 30, coarse_pressure, pool.getFloat32Raster(coarse_grid));
 
     // convert back to fine resolution
     var fine_ids = coarse_grid.getNearestIds(fine_grid.pos);
@@ -50,9 +49,8 @@ FluidMechanics.get_fluid_pressures = function(buoyancy, pressure, scratch) {
     // so we smooth it a second time, this time using the fine_grid resolution
 
     // smooth at fine resolution
-    for (var i=0; i<3; ++i) {
-        diffuse(fine_pressure, 1, fine_pressure, scratch);
-    }
+    diffuse(fine_pressure, 1, 3, fine_pressure, scratch);
+    pool.deallocate('FluidMechanics.get_fluid_pressures');
     return fine_pressure;
 }
 
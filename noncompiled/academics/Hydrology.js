@@ -6,22 +6,19 @@
 var Hydrology = {};
 
 Hydrology.get_surface_heights = function(displacement, sealevel, result) {
-    ScalarField.sub_scalar(displacement, sealevel, result);
-    ScalarField.max_scalar(result, 0, result);
-    return result;
+    return Float32RasterExpression(displacement).sub_scalar(sealevel).max_scalar(0).evaluate(result);
 }
 
 Hydrology.get_ocean_depths = function(displacement, sealevel, result) {
-    ScalarField.sub_scalar(displacement, sealevel, result);
-    ScalarField.mult_scalar(result, -1, result);
-    ScalarField.max_scalar(result, 0, result);
-    return result;
+    return Float32RasterExpression(displacement).sub_scalar(sealevel).mult_scalar(-1).max_scalar(0).evaluate(result);
 }
 
 // solve for sealevel using iterative numerical approximation
 Hydrology.solve_sealevel = function(displacement, total_ocean_mass, ocean_density, scratch, iterations) {
     iterations = iterations || 10;
-    scratch = scratch || Float32Raster(displacement.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Hydrology.solve_sealevel');
+    scratch = scratch || pool.getFloat32Raster(displacement.grid);
 
     // lowest possible value - assumes total_ocean_mass == 0
     var sealevel_min = 0;
@@ -47,5 +44,6 @@ Hydrology.solve_sealevel = function(displacement, total_ocean_mass, ocean_densit
             sealevel_max = sealevel_guess;
         }
     }
+    pool.deallocate('Hydrology.solve_sealevel');
     return sealevel_guess;
 }
@@ -86,13 +86,16 @@ Tectonophysics.guess_plate_velocity = function(plate_mask, buoyancy, material_vi
 }
 
 Tectonophysics.get_plate_center_of_mass = function(mass, plate_mask, scratch) {
-    scratch = scratch || Float32Raster(mass.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Tectonophysics.get_plate_center_of_mass');
+    scratch = scratch || pool.getFloat32Raster(mass.grid);
 
     // find plate's center of mass
     var plate_mass = scratch;
     ScalarField.mult_field             (mass, plate_mask,                     plate_mass);
     var center_of_plate = VectorDataset.weighted_average (plate_mass.grid.pos, plate_mass);
     // Vector.normalize(center_of_plate.x, center_of_plate.y, center_of_plate.z, center_of_plate);
+    pool.deallocate('Tectonophysics.get_plate_center_of_mass');
     return center_of_plate;
 }
 
@@ -82,12 +82,12 @@ var Thermodynamics = (function() {
             result
         ) {
         result = result || Float32Raster(temperature.grid);
-        Float32Raster.fill(result, 1);
-        ScalarField.mult_field    (result,         temperature,                         result);
-        ScalarField.mult_field    (result,         temperature,                         result);
-        ScalarField.mult_field    (result,         temperature,                         result);
-        ScalarField.mult_field    (result,         temperature,                         result);
-        ScalarField.mult_scalar    (result,         Thermodynamics.STEPHAN_BOLTZMANN_CONSTANT,     result);
+        Float32RasterExpression(temperature)
+            .mult_field  (temperature)
+            .mult_field  (temperature)
+            .mult_field  (temperature)
+            .mult_scalar (Thermodynamics.STEPHAN_BOLTZMANN_CONSTANT)
+            .evaluate    (result);
 
         return result;
     }
@@ -0,0 +1,266 @@
+// BinarySerializer stores the parameters of a simulation in a binary container,
+//   so that saves are smaller than those of JsonSerializer and can be loaded without decoding rasters.
+//
+// The container consists of:
+//   a 16 byte prefix: the magic string "TECTSIM\0", the format version, and the byte length of the header, as little endian uint32s
+//   a header: UTF-8 JSON of the form {"sections": [byte lengths...], "parameters": {...}},
+//     where each ArrayBuffer within "parameters" is replaced by the string "section:<index>",
+//     and strings that would otherwise be mistaken for one are escaped by prefixing them with "string:", see "escape"
+//   the sections themselves, the raw bytes of each ArrayBuffer, in order
+// The header and each section start on 8 byte boundaries, padded with zeros,
+//   so a section can be read as a typed array wherever the container is loaded.
+// A container can also be gzip compressed as a whole, see "BinaryDeserializer.parameters_from_stream".
+var BinarySerializer = {};
+BinarySerializer.MAGIC = 'TECTSIM\0';
+// NOTE: version 1 did not escape strings, so they are read back as they are
+BinarySerializer.VERSION = 2;
+BinarySerializer.PREFIX_BYTE_LENGTH = 16;
+BinarySerializer.ALIGNMENT = 8;
+BinarySerializer.SECTION_PREFIX = 'section:';
+BinarySerializer.ESCAPE_PREFIX = 'string:';
+
+// "escape" returns a string that is read back as "string", and is never mistaken for a section, see "BinaryDeserializer.unescape"
+BinarySerializer.escape = function(string) {
+    return string.startsWith(BinarySerializer.SECTION_PREFIX) || string.startsWith(BinarySerializer.ESCAPE_PREFIX)?
+        BinarySerializer.ESCAPE_PREFIX + string : string;
+}
+
+// "get_padding" returns the number of bytes needed to align "byte_length" to the next boundary
+BinarySerializer.get_padding = function(byte_length) {
+    return (BinarySerializer.ALIGNMENT - byte_length % BinarySerializer.ALIGNMENT) % BinarySerializer.ALIGNMENT;
+}
+// "is_buffer" indicates whether "value" is a buffer that's stored as a section
+// NOTE: parameters of simulations that run in shared memory contain SharedArrayBuffers, see "RemoteSimulation"
+BinarySerializer.is_buffer = function(value) {
+    return value instanceof ArrayBuffer ||
+        (typeof SharedArrayBuffer !== 'undefined' && value instanceof SharedArrayBuffer);
+}
+
+BinarySerializer.sim = function (sim) {
+    return BinarySerializer.parameters(sim.getParameters());
+}
+// "parameters" serializes the result of Simulation.getParameters()
+// It returns a list of Uint8Arrays that make up the container when concatenated,
+//   so sections are never copied into a single buffer, e.g. `new Blob(BinarySerializer.parameters(parameters))`
+BinarySerializer.parameters = function (parameters) {
+    var buffers = [];
+    var replacer = function(key, value) {
+        if (BinarySerializer.is_buffer(value)) {
+            buffers.push(value);
+            return BinarySerializer.SECTION_PREFIX + (buffers.length-1);
+        } else if (typeof value === 'string') {
+            return BinarySerializer.escape(value);
+        }
+        return value;
+    }
+    var parameters_json = JSON.stringify(parameters, replacer);
+    var header_json = `{"sections":${JSON.stringify(buffers.map(buffer => buffer.byteLength))},"parameters":${parameters_json}}`;
+    var header = new TextEncoder().encode(header_json);
+
+    var prefix = new Uint8Array(BinarySerializer.PREFIX_BYTE_LENGTH);
+    var prefix_view = new DataView(prefix.buffer);
+    for (var i = 0; i < BinarySerializer.MAGIC.length; i++) {
+        prefix[i] = BinarySerializer.MAGIC.charCodeAt(i);
+    }
+    prefix_view.setUint32(8,  BinarySerializer.VERSION, true);
+    prefix_view.setUint32(12, header.byteLength,        true);
+
+    var chunks = [prefix, header, new Uint8Array(BinarySerializer.get_padding(header.byteLength))];
+    for (var buffer of buffers) {
+        // NOTE: Blobs can not be built from shared memory, so shared buffers are copied
+        var bytes = buffer instanceof ArrayBuffer? new Uint8Array(buffer) : new Uint8Array(buffer).slice();
+        chunks.push(bytes, new Uint8Array(BinarySerializer.get_padding(bytes.byteLength)));
+    }
+    return chunks;
+}
+
+// "blob" returns a promise of a Blob made of "chunks", as returned by "parameters", 
+//   which is gzip compressed if "is_compressed" is set and the browser supports it
+BinarySerializer.blob = function (chunks, is_compressed) {
+    var blob = new Blob(chunks, {type : 'application/octet-stream'});
+    if (!is_compressed || typeof CompressionStream === 'undefined') {
+        return Promise.resolve(blob);
+    }
+    return new Response(blob.stream().pipeThrough(new CompressionStream('gzip'))).blob();
+}
+
+var BinaryDeserializer = {};
+
+// A BinaryDeserializer.Reader rebuilds parameters from a container that arrives in chunks of any size.
+// Each section is allocated as its own ArrayBuffer once the header is read, and bytes are copied there as they arrive,
+//   so the container is never held in memory as a whole, and rasters are used as they are stored with no decode step.
+BinaryDeserializer.Reader = function() {
+    // the regions that bytes are copied to next, in order, along with what to do once each is full
+    var targets = [];
+    var version = 0;
+    var header_byte_length = 0;
+    var header = void 0;
+    var sections = [];
+    var parameters = void 0;
+
+    function expect(bytes, on_full) {
+        targets.push({ bytes: bytes, offset: 0, on_full: on_full });
+    }
+    function read_prefix(bytes) {
+        for (var i = 0; i < BinarySerializer.MAGIC.length; i++) {
+            if (bytes[i] !== BinarySerializer.MAGIC.charCodeAt(i)) {
+                throw 'BinaryDeserializer: not a binary save';
+            }
+        }
+        var view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+        version = view.getUint32(8, true);
+        if (version > BinarySerializer.VERSION) {
+            throw `BinaryDeserializer: unsupported version ${version}`;
+        }
+        header_byte_length = view.getUint32(12, true);
+        expect(new Uint8Array(header_byte_length + BinarySerializer.get_padding(header_byte_length)), read_header);
+    }
+    function read_header(bytes) {
+        header = JSON.parse(new TextDecoder().decode(bytes.subarray(0, header_byte_length)));
+        for (var byte_length of header.sections) {
+            var section = new ArrayBuffer(byte_length);
+            sections.push(section);
+            expect(new Uint8Array(section), function() {});
+            expect(new Uint8Array(BinarySerializer.get_padding(byte_length)), function() {});
+        }
+        expect(new Uint8Array(0), read_end);
+    }
+    function read_end() {
+        var revive = function(value) {
+            if (typeof value === 'string' && value.startsWith(BinarySerializer.SECTION_PREFIX)) {
+                var section = sections[parseInt(value.substr(BinarySerializer.SECTION_PREFIX.length))];
+                if (section === void 0) {
+                    throw `BinaryDeserializer: the save refers to a section that does not exist, "${value}"`;
+                }
+                return section;
+            } else if (typeof value === 'string' && version >= 2) {
+                return BinaryDeserializer.unescape(value);
+            } else if (Array.isArray(value)) {
+                for (var i = 0; i < value.length; i++) { value[i] = revive(value[i]); }
+            } else if (value !== null && typeof value === 'object') {
+                for (var key in value) { value[key] = revive(value[key]); }
+            }
+            return value;
+        }
+        parameters = revive(header.parameters);
+    }
+    // "drain" calls back on any targets that are full, which includes targets that are empty to begin with
+    function drain() {
+        while (targets.length > 0 && targets[0].offset >= targets[0].bytes.length) {
+            var target = targets.shift();
+            target.on_full(target.bytes);
+        }
+    }
+    expect(new Uint8Array(BinarySerializer.PREFIX_BYTE_LENGTH), read_prefix);
+
+    // "push" reads the next chunk of the container, a Uint8Array
+    this.push = function(chunk) {
+        var offset = 0;
+        drain();
+        while (offset < chunk.length) {
+            if (targets.length === 0) {
+                throw 'BinaryDeserializer: unexpected bytes after the end of the save';
+            }
+            var target = targets[0];
+            var byte_length = Math.min(target.bytes.length - target.offset, chunk.length - offset);
+            target.bytes.set(chunk.subarray(offset, offset + byte_length), target.offset);
+            target.offset += byte_length;
+            offset += byte_length;
+            drain();
+        }
+    }
+    this.is_done = function() {
+        return parameters !== void 0;
+    }
+    this.parameters = function() {
+        if (parameters === void 0) {
+            throw 'BinaryDeserializer: the save ended before it was complete';
+        }
+        return parameters;
+    }
+}
+
+// "unescape" is the inverse of "BinarySerializer.escape"
+BinaryDeserializer.unescape = function(string) {
+    return string.startsWith(BinarySerializer.ESCAPE_PREFIX)? string.substr(BinarySerializer.ESCAPE_PREFIX.length) : string;
+}
+// "is_binary" indicates whether "bytes", the start of a save, is a binary container rather than JSON
+// NOTE: "bytes" must hold the whole magic string to be recognized, see "BinaryDeserializer.parameters_from_stream"
+BinaryDeserializer.is_binary = function(bytes) {
+    if (bytes.length < BinarySerializer.MAGIC.length) {
+        return false;
+    }
+    for (var i = 0; i < BinarySerializer.MAGIC.length; i++) {
+        if (bytes[i] !== BinarySerializer.MAGIC.charCodeAt(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+// "is_gzip" indicates whether "bytes", the start of a save, is gzip compressed
+BinaryDeserializer.is_gzip = function(bytes) {
+    return bytes.length >= 2 && bytes[0] === 0x1f && bytes[1] === 0x8b;
+}
+
+BinaryDeserializer.sim = function (buffer) {
+    var reader = new BinaryDeserializer.Reader();
+    reader.push(new Uint8Array(buffer));
+    return new Simulation(reader.parameters());
+}
+// "parameters_from_stream" reads a save from a ReadableStream of Uint8Arrays,
+//   such as the body of a fetch() response, or the stream of a File,
+//   and returns a promise of the parameters of the simulation it contains.
+// Saves can be binary containers, gzip compressed binary containers, or JSON saves from JsonSerializer.
+BinaryDeserializer.parameters_from_stream = function (stream) {
+    var stream_reader = stream.getReader();
+    function read_all(on_chunk) {
+        return stream_reader.read().then(function(result) {
+            if (result.done) { return; }
+            on_chunk(result.value);
+            return read_all(on_chunk);
+        });
+    }
+    // "read_head" reads chunks until "bytes" holds at least the magic string, or the stream ends,
+    //   since chunks can be of any size, and a save can't be recognized from fewer bytes
+    function read_head(bytes) {
+        if (bytes.length >= BinarySerializer.MAGIC.length) {
+            return Promise.resolve(bytes);
+        }
+        return stream_reader.read().then(function(result) {
+            if (result.done) { return bytes; }
+            var head = new Uint8Array(bytes.length + result.value.length);
+            head.set(bytes);
+            head.set(result.value, bytes.length);
+            return read_head(head);
+        });
+    }
+    return read_head(new Uint8Array(0)).then(function(bytes) {
+        if (bytes.length === 0) {
+            throw 'BinaryDeserializer: the save is empty';
+        }
+        if (BinaryDeserializer.is_gzip(bytes)) {
+            if (typeof DecompressionStream === 'undefined') {
+                throw 'BinaryDeserializer: the save is compressed, but this browser can not decompress it';
+            }
+            // NOTE: the chunks that were read are put back in front of the rest of the stream before it is decompressed
+            var restream = new ReadableStream({
+                start: function(controller) { controller.enqueue(bytes); },
+                pull: function(controller) {
+                    return stream_reader.read().then(function(result) {
+                        if (result.done) { controller.close(); } else { controller.enqueue(result.value); }
+                    });
+                },
+            });
+            return BinaryDeserializer.parameters_from_stream(restream.pipeThrough(new DecompressionStream('gzip')));
+        } else if (BinaryDeserializer.is_binary(bytes)) {
+            var reader = new BinaryDeserializer.Reader();
+            reader.push(bytes);
+            return read_all(reader.push).then(function() { return reader.parameters(); });
+        } else {
+            var decoder = new TextDecoder();
+            var json = decoder.decode(bytes, { stream: true });
+            return read_all(function(chunk) { json += decoder.decode(chunk, { stream: true }); })
+                .then(function() { return JsonDeserializer.parameters(json + decoder.decode()); });
+        }
+    });
+}
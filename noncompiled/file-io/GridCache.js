@@ -0,0 +1,95 @@
+'use strict';
+
+
+// GridCache persists the entries of "Grid.cache" across page loads, using IndexedDB,
+//   so that grids of a mesh that was seen before are built without repeating their most expensive steps,
+//   such as populating the cells of their VoronoiSphere.
+// Entries are stored by their cache key, which includes "Grid.CACHE_VERSION",
+//   so entries from older versions of the app are never used, and are deleted once they are found.
+// IndexedDB is optional: if it is unavailable or fails, grids are simply built as they were before.
+var GridCache = {};
+GridCache.DATABASE_NAME = 'grid-cache';
+GridCache.STORE_NAME = 'entries';
+
+// "open" returns a promise of the database, or of undefined if it can not be opened
+GridCache.open = function() {
+    return new Promise(function(resolve) {
+        if (typeof indexedDB === 'undefined') {
+            resolve(void 0);
+            return;
+        }
+        var request;
+        try {
+            request = indexedDB.open(GridCache.DATABASE_NAME, 1);
+        } catch (error) {
+            resolve(void 0);
+            return;
+        }
+        request.onupgradeneeded = function() {
+            request.result.createObjectStore(GridCache.STORE_NAME);
+        };
+        request.onsuccess = function() { resolve(request.result); };
+        request.onerror   = function() { resolve(void 0); };
+        request.onblocked = function() { resolve(void 0); };
+    });
+}
+
+// "load" adds stored entries of the current version to "Grid.cache", for as long as it has room, see "Grid.MAX_CACHE_ENTRY_COUNT",
+//   returning a promise that resolves once it is done, whether or not any entries could be read
+GridCache.load = function() {
+    return GridCache.open().then(function(database) {
+        if (database === void 0) { return; }
+        return new Promise(function(resolve) {
+            var transaction = database.transaction(GridCache.STORE_NAME, 'readwrite');
+            var request = transaction.objectStore(GridCache.STORE_NAME).openCursor();
+            request.onsuccess = function() {
+                var cursor = request.result;
+                if (!cursor) { return; }
+                var entry = cursor.value;
+                if (entry.version !== Grid.CACHE_VERSION) {
+                    cursor.delete();
+                } else if (!Grid.cache.has(cursor.key) && Grid.cache.size < Grid.MAX_CACHE_ENTRY_COUNT) {
+                    entry.is_persisted = true;
+                    Grid.set_cache_entry(cursor.key, entry);
+                }
+                cursor.continue();
+            };
+            transaction.oncomplete = function() { database.close(); resolve(); };
+            transaction.onerror    = function() { database.close(); resolve(); };
+            transaction.onabort    = function() { database.close(); resolve(); };
+        });
+    });
+}
+
+// "save" stores every entry of "Grid.cache" that has not been stored already,
+//   returning a promise that resolves once it is done, whether or not any entries could be written
+GridCache.save = function() {
+    // NOTE: entries are kept from the start, since they could be dropped from "Grid.cache" before they are written
+    var keys = [];
+    var entries = [];
+    Grid.cache.forEach(function(entry, key) {
+        if (!entry.is_persisted) { keys.push(key); entries.push(entry); }
+    });
+    if (keys.length === 0) {
+        return Promise.resolve();
+    }
+    return GridCache.open().then(function(database) {
+        if (database === void 0) { return; }
+        return new Promise(function(resolve) {
+            var transaction = database.transaction(GridCache.STORE_NAME, 'readwrite');
+            var store = transaction.objectStore(GridCache.STORE_NAME);
+            for (var i = 0; i < keys.length; i++) {
+                store.put(entries[i], keys[i]);
+            }
+            transaction.oncomplete = function() {
+                for (var entry of entries) {
+                    entry.is_persisted = true;
+                }
+                database.close();
+                resolve();
+            };
+            transaction.onerror = function() { database.close(); resolve(); };
+            transaction.onabort = function() { database.close(); resolve(); };
+        });
+    });
+}
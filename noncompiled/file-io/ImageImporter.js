@@ -25,3 +25,13 @@ ImageImporter.get_elevations_from_canvas_context = function (canvas_context, gri
 
     return elevations;
 }
+// "set_elevations" replaces the crust of "world" with crust that has the given elevations, see "CrustGenerator.get_crust_from_elevations"
+// NOTE: this is also how "SimulationWorker.js" applies elevations that were imported on the main thread, see "RemoteSimulation.import_elevations"
+ImageImporter.set_elevations = function (world, elevations) {
+    CrustGenerator.get_crust_from_elevations(
+        elevations, 
+        CrustGenerator.modern_earth_attribute_height_maps, 
+        world.lithosphere.total_crust
+    );
+    world.lithosphere.invalidate();
+}
@@ -1,5 +1,10 @@
 var JsonSerializer     = {};
 JsonSerializer.sim = function (sim) {
+    return JsonSerializer.parameters(sim.getParameters());
+}
+// "parameters" serializes the result of Simulation.getParameters(), 
+//   for simulations whose parameters are retrieved asynchronously, see "RemoteSimulation.request_parameters"
+JsonSerializer.parameters = function (parameters) {
 
     var replacer = function(key, value) {
         if (value !== void 0 && value.constructor === ArrayBuffer) {
@@ -8,10 +13,14 @@ JsonSerializer.sim = function (sim) {
         return value;
     }
 
-    return JSON.stringify(sim.getParameters(), replacer);
+    return JSON.stringify(parameters, replacer);
 }
 var JsonDeserializer = {};
 JsonDeserializer.sim = function (json, sim) {
+    return new Simulation(JsonDeserializer.parameters(json));
+}
+// "parameters" deserializes the result of Simulation.getParameters(), see "JsonSerializer.parameters"
+JsonDeserializer.parameters = function (json) {
 
     var reviver = function(key, value) {
         if (typeof value === 'string' && value.startsWith('buffer:')) {
@@ -20,5 +29,68 @@ JsonDeserializer.sim = function (json, sim) {
         return value;
     }
 
-    return new Simulation(JSON.parse(json, reviver));
+    return JSON.parse(json, reviver);
+}
+
+// "render_state" serializes only what's needed to render the focus of a simulation with the "realistic" view,
+//   so that it can be rendered without running the model, see "precompiled/cpp/render.cpp".
+// Rasters are stored as buffers in the same way as JsonSerializer.sim(), 
+//   and vector rasters are stored as their "everything" array.
+// Coverage fractions are in [0,1], so they are stored at 2 bytes per cell, as the parameters of a "fixed16" QuantizedRaster,
+//   which "render.cpp" decodes as it loads them.
+// Light sources are sampled at the current time only, whereas View.js also samples across short cycles.
+JsonSerializer.render_state = function (sim) {
+    var universe = sim.model();
+    var world = sim.focus;
+    var stars = universe.bodies.filter(body => body instanceof Star);
+    var star_sample_positions_map_ = universe.star_sample_positions_map(universe.config, world, 0, 1);
+
+    var light_rgb_intensities = [];
+    var light_directions = [];
+    for (var star of stars){
+        var star_position = star_sample_positions_map_[star.name][0];
+        var light_distance = Vector.magnitude(star_position.x, star_position.y, star_position.z);
+        var light_direction = Vector.normalize(star_position.x, star_position.y, star_position.z);
+        var light_rgb_intensity = Thermodynamics.solve_rgb_intensity_of_light_emitted_by_black_body(star.surface_temperature);
+        var light_attenuation = SphericalGeometry.get_surface_area(star.radius) / SphericalGeometry.get_surface_area(light_distance);
+        light_rgb_intensities.push({
+            x: light_rgb_intensity.x * light_attenuation, 
+            y: light_rgb_intensity.y * light_attenuation, 
+            z: light_rgb_intensity.z * light_attenuation,
+        });
+        light_directions.push({x: light_direction.x, y: light_direction.y, z: light_direction.z});
+    }
+
+    // NOTE: this must match the derivation of "atmosphere_scale_height" in RealisticWorldView.js
+    var average_molecular_mass_of_air = 4.8e-26 * Units.KILOGRAM;
+    var atmosphere_temperature = Float32Dataset.average(world.atmosphere.surface_temperature);
+    var atmosphere_scale_height = 
+        Thermodynamics.BOLTZMANN_CONSTANT * atmosphere_temperature / (world.surface_gravity * average_molecular_mass_of_air);
+
+    var gradient = world.surface_gradient.value();
+
+    var quantize = raster => QuantizedRaster.getParameters(QuantizedRaster.encode(raster, QuantizedRaster.Fixed16(world.grid, 0, 1)));
+
+    var replacer = function(key, value) {
+        if (value !== void 0 && value.constructor === ArrayBuffer) {
+            return 'buffer:' + Base64.encode(value);
+        }
+        return value;
+    }
+
+    return JSON.stringify({
+        type:                       'render_state',
+        name:                       world.name,
+        grid:                       world.grid.getParameters(),
+        radius:                     world.radius,
+        sealevel:                   world.hydrosphere.sealevel.value(),
+        atmosphere_scale_height:    atmosphere_scale_height,
+        light_directions:           light_directions,
+        light_rgb_intensities:      light_rgb_intensities,
+        displacement:               world.lithosphere.displacement.value().slice(0).buffer,
+        gradient:                   gradient.everything.slice(0).buffer,
+        surface_temperature:        world.atmosphere.surface_temperature.slice(0).buffer,
+        snow_coverage:              quantize(world.hydrosphere.snow_coverage.value()),
+        plant_coverage:             quantize(world.biosphere.plant_coverage.value()),
+    }, replacer);
 }
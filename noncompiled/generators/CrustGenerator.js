@@ -17,7 +17,7 @@ CrustGenerator.get_crust_from_elevations = function(elevations, attribute_height
 }
 CrustGenerator.get_elevations_from_height_ranks = function (height_ranks, hypsography, random, elevations) {
     // order cells by height rank
-    var sorted_cell_ids = new Uint16Array(height_ranks.length);
+    var sorted_cell_ids = new Uint32Array(height_ranks.length);
     for(var i=0, length = sorted_cell_ids.length; i<length; i++) {
         sorted_cell_ids[i] = i;
     }
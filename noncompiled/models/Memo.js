@@ -1,20 +1,199 @@
 'use strict';
 
 
-function Memo(initial_value, get_value, is_dirty) {
+// A Memo lazily computes a value, and caches it until invalidate() is called.
+//
+// Memos also form a dependency graph: while a memo computes its value,
+//   any other memo whose value() it calls is recorded as one of its "dependencies".
+// Each memo keeps a "version", which only increases when a recomputed value differs from the last one.
+// If "options.is_pure" is set, the memo promises its value depends on nothing but its dependencies,
+//   so when it is invalidated but none of its dependencies changed version, it keeps its value without recomputing.
+// This lets values that depend on slow moving fields skip work on the many frames where those fields do not change.
+//
+// "options" may contain:
+//   "name":    the name under which time spent computing is recorded, see "Memo.timings"
+//   "is_pure": whether the value depends only on other memos, see above
+//   "epsilon": the largest difference between values that is still considered unchanged, 0 by default
+function Memo(initial_value, get_value, is_dirty, options) {
     is_dirty = is_dirty === void 0? true : is_dirty;
     get_value = get_value === void 0? (result => result) : get_value;
+    options = options || {};
     var value = initial_value;
+    var is_pure = options.is_pure || false;
+    var epsilon = options.epsilon || 0;
+    var timing = options.name !== void 0? Memo.get_timing(options.name) : void 0;
+
+    this.version = 0;
+    // memos that were used the last time this one was computed, along with the versions that were used
+    this.dependencies = [];
+    this.dependency_versions = [];
+    // whether any pure memo depends on this one, in which case changes must be detected
+    this.has_pure_dependents = false;
+    this.is_pure = is_pure;
+
+    // a copy of the last value, used to detect whether a recomputed value changed
+    var snapshot = void 0;
+    var has_computed = false;
+
+    var self = this;
+    function compute() {
+        var stack = Memo.stack;
+        var start = performance.now();
+        self.dependencies = [];
+        self.dependency_versions = [];
+        self.child_milliseconds = 0;
+        stack.push(self);
+        try {
+            value = get_value(value);
+        } finally {
+            stack.pop();
+        }
+        // NOTE: time spent computing dependencies is counted towards them, so it is excluded from ours
+        var elapsed = performance.now() - start;
+        if (timing !== void 0) {
+            timing.computed++;
+            timing.milliseconds += elapsed - self.child_milliseconds;
+        }
+        if (stack.length > 0) {
+            stack[stack.length-1].child_milliseconds += elapsed;
+        }
+        // NOTE: the profiler records events that nest, so it counts time spent computing dependencies, see "Profiler"
+        if (Profiler.is_enabled && options.name !== void 0) {
+            Profiler.record(options.name, 'memo', start, elapsed);
+        }
+
+        if (!self.has_pure_dependents) {
+            self.version++;
+            snapshot = void 0;
+        } else if (snapshot === void 0 || !Memo.is_equal(value, snapshot, epsilon)) {
+            self.version++;
+            snapshot = Memo.copy(value, snapshot);
+        }
+        has_computed = true;
+    }
+    // "is_unchanged" indicates whether every dependency still has the version it had when we last computed
+    // NOTE: dependencies are brought up to date first, which may recompute them
+    function is_unchanged() {
+        var dependencies = self.dependencies;
+        var versions = self.dependency_versions;
+        // NOTE: we are pushed to the stack so that dependencies are not recorded as dependencies of whatever called us
+        Memo.stack.push(self);
+        try {
+            for (var i = 0; i < dependencies.length; i++) {
+                dependencies[i].value();
+                if (dependencies[i].version !== versions[i]) {
+                    return false;
+                }
+            }
+        } finally {
+            Memo.stack.pop();
+        }
+        return true;
+    }
+
+    // time spent computing dependencies while computing this memo
+    this.child_milliseconds = 0;
     this.invalidate = function() {
         is_dirty = true;
     }
     this.value = function(){
+        var stack = Memo.stack;
         if (is_dirty) {
             // NOTE: we set is_dirty first in order to resolve circular dependencies between memos
             //  e.g. snow coverage depends on temperature which depends on albedo which depends on snow coverage
             is_dirty = false;
-            value = get_value(value); 
+            if (is_pure && has_computed && is_unchanged()) {
+                if (timing !== void 0) { timing.skipped++; }
+            } else {
+                compute();
+            }
+        }
+        // record ourselves as a dependency of whatever memo is computing
+        if (stack.length > 0) {
+            var dependent = stack[stack.length-1];
+            if (dependent !== self && dependent.dependencies.indexOf(self) < 0) {
+                dependent.dependencies.push(self);
+                dependent.dependency_versions.push(self.version);
+                if (dependent.is_pure && !self.has_pure_dependents) {
+                    self.has_pure_dependents = true;
+                    // NOTE: a copy is taken now so that the next recomputed value can be compared against it
+                    snapshot = Memo.copy(value, void 0);
+                }
+            }
         }
         return value;
     }
 }
+
+// the memos that are currently computing, innermost last
+Memo.stack = [];
+
+// "timings" records how often memos of each name were computed or skipped, and the time spent computing them,
+//   not counting time spent computing their dependencies
+Memo.timings = {};
+Memo.get_timing = function(name) {
+    if (Memo.timings[name] === void 0) {
+        Memo.timings[name] = { name: name, computed: 0, skipped: 0, milliseconds: 0 };
+    }
+    return Memo.timings[name];
+}
+Memo.reset_timings = function() {
+    for (var name in Memo.timings) {
+        var timing = Memo.timings[name];
+        timing.computed = 0;
+        timing.skipped = 0;
+        timing.milliseconds = 0;
+    }
+}
+
+// "is_equal" compares a value against a copy made by "Memo.copy"
+// Values can be numbers, typed arrays, or objects of either, like vector rasters.
+Memo.is_equal = function(value, snapshot, epsilon) {
+    if (typeof value === 'number') {
+        return Memo.is_number_equal(value, snapshot, epsilon);
+    } else if (ArrayBuffer.isView(value)) {
+        if (!ArrayBuffer.isView(snapshot) || value.length !== snapshot.length) {
+            return false;
+        }
+        for (var i = 0, li = value.length; i < li; i++) {
+            if (!Memo.is_number_equal(value[i], snapshot[i], epsilon)) {
+                return false;
+            }
+        }
+        return true;
+    } else if (value !== null && typeof value === 'object') {
+        if (snapshot === void 0 || snapshot === null) {
+            return false;
+        }
+        for (var key in value) {
+            // NOTE: "everything" in vector rasters aliases x, y, and z, so there is no need to compare it
+            if (key === 'everything' || key === 'grid') { continue; }
+            if (!Memo.is_equal(value[key], snapshot[key], epsilon)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return value === snapshot;
+}
+Memo.is_number_equal = function(a, b, epsilon) {
+    return a === b || (a !== a && b !== b) || Math.abs(a - b) <= epsilon;
+}
+// "copy" copies "value" into "snapshot", reusing it if possible, and returns the copy
+Memo.copy = function(value, snapshot) {
+    if (ArrayBuffer.isView(value)) {
+        if (!ArrayBuffer.isView(snapshot) || snapshot.length !== value.length || snapshot.constructor !== value.constructor) {
+            return value.slice();
+        }
+        snapshot.set(value);
+        return snapshot;
+    } else if (value !== null && typeof value === 'object') {
+        snapshot = snapshot !== null && typeof snapshot === 'object'? snapshot : {};
+        for (var key in value) {
+            if (key === 'everything' || key === 'grid') { continue; }
+            snapshot[key] = Memo.copy(value[key], snapshot[key]);
+        }
+        return snapshot;
+    }
+    return value;
+}
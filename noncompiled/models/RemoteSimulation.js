@@ -0,0 +1,213 @@
+'use strict';
+
+
+// A RemoteSimulation runs a Simulation within a Web Worker, see "SimulationWorker.js",
+//   so that stepping the model never holds up rendering or input on the main thread.
+// It stands in for the Simulation that it is constructed from, which it calls the "local" simulation.
+// The worker is started from the parameters of the local simulation, and from then on it steps on its own clock.
+// After each step, the worker copies the rasters that views need into a "snapshot" and transfers it here, see "RemoteSimulation.snapshot_rasters".
+// Snapshots are double buffered: the worker owns a pool of two frames, and while the main thread renders from one,
+//   the worker fills the other. A frame is transferred back once a newer one arrives, so neither side ever copies it,
+//   and the worker skips publishing whenever it has no frame to fill, so the main thread is never flooded.
+// "focus" is a view of the local world whose rasters are swapped for those of the latest snapshot.
+// Anything not in a snapshot is read from the local world, which is left as it was when the worker started.
+function RemoteSimulation(local, script_url) {
+    script_url = script_url || 'noncompiled/models/SimulationWorker.js';
+    var this_ = this;
+    var worker = new Worker(script_url);
+    var speed = local.speed;
+    var paused = local.paused;
+    var front = void 0;
+    var parameter_callbacks = [];
+    // the rasters that quantized snapshot rasters are decoded to, see "RemoteSimulation.decode"
+    var decoded = {};
+
+    this.local = local;
+    this.focus = local.focus;
+    this.elapsed_time = local.elapsed_time;
+    this.seed = local.seed;
+    this.random = local.random;
+
+    Object.defineProperty(this, 'speed', {
+        get: function() { return speed; },
+        set: function(value) {
+            speed = value;
+            worker.postMessage({ type: 'simulation_set', speed: speed });
+        },
+    });
+    Object.defineProperty(this, 'paused', {
+        get: function() { return paused; },
+        set: function(value) {
+            paused = value;
+            worker.postMessage({ type: 'simulation_set', paused: paused });
+        },
+    });
+
+    this.model = function() {
+        return local.model();
+    }
+
+    // the worker steps on its own, so there is nothing to do here
+    this.update = function() {
+    }
+
+    this.toggle_pause = function() {
+        this.paused = !this.paused;
+    }
+
+    // parameters are held by the worker, so they can only be retrieved asynchronously, see "request_parameters"
+    this.getParameters = function() {
+        throw 'RemoteSimulation: getParameters() is not available, use request_parameters() instead';
+    }
+    // "request_parameters" calls "callback" with the result of getParameters() on the simulation within the worker
+    this.request_parameters = function(callback) {
+        parameter_callbacks.push(callback);
+        worker.postMessage({ type: 'simulation_get_parameters' });
+    }
+
+    // "import_elevations" replaces the crust of the world within the worker, see "ImageImporter.set_elevations",
+    //   since edits to the local world are never seen by the worker, and would be overwritten by the next snapshot
+    this.import_elevations = function(elevations) {
+        worker.postMessage({ type: 'simulation_import_elevations', elevations: elevations });
+    }
+
+    this.terminate = function() {
+        worker.terminate();
+    }
+
+    worker.addEventListener('message', function(event) {
+        var message = event.data;
+        if (message.type === 'simulation_snapshot') {
+            var world = local.focus;
+            var rasters = RemoteSimulation.decode(RemoteSimulation.unpack(message.frame, world.grid), decoded);
+            var focus = Object.create(world);
+            focus.lithosphere = Object.create(world.lithosphere);
+            focus.lithosphere.displacement   = new Memo(rasters.displacement,   void 0, false);
+            focus.lithosphere.surface_height = new Memo(rasters.surface_height, void 0, false);
+            focus.hydrosphere = Object.create(world.hydrosphere);
+            focus.hydrosphere.sealevel       = new Memo(message.sealevel,       void 0, false);
+            focus.hydrosphere.snow_coverage  = new Memo(rasters.snow_coverage,  void 0, false);
+            focus.atmosphere = Object.create(world.atmosphere);
+            focus.atmosphere.surface_temperature = rasters.surface_temperature;
+            focus.biosphere = Object.create(world.biosphere);
+            focus.biosphere.plant_coverage   = new Memo(rasters.plant_coverage, void 0, false);
+            focus.surface_gradient           = new Memo(rasters.surface_gradient, void 0, false);
+
+            local.model().config = message.config;
+            this_.elapsed_time = message.elapsed_time;
+            this_.focus = focus;
+
+            if (front !== void 0) {
+                worker.postMessage({ type: 'simulation_release', frame: front }, [front]);
+            }
+            front = message.frame;
+            if (message.profile !== void 0) {
+                Profiler.add_events(message.profile, Profiler.WORKER_THREAD);
+            }
+        } else if (message.type === 'simulation_parameters') {
+            var callback = parameter_callbacks.shift();
+            if (callback !== void 0) {
+                callback(message.parameters);
+            }
+        }
+    });
+
+    // the grid of the local world was already built, so the worker is given its cache entry rather than building it again, see "Grid.cache"
+    var grid = local.focus.grid;
+    worker.postMessage({ 
+        type:             'simulation_init', 
+        parameters:       local.getParameters(), 
+        grid_cache_key:   grid.cache_key, 
+        grid_cache_entry: Grid.get_cache_entry(grid.cache_key),
+        is_debugging_allocations: RasterPool.is_debugging,
+        is_profiling:     Profiler.is_enabled,
+        is_using_wasm_kernels: RasterWasmKernels.is_enabled,
+    });
+}
+
+// the rasters that are copied into snapshots, as functions that return them from a world,
+//   along with the number of floats per cell.
+// Scalar rasters with an "encoding" are stored as a QuantizedRaster of that encoding over [min, max],
+//   which halves their size within a frame, and they are decoded once a snapshot arrives, see "RemoteSimulation.decode".
+RemoteSimulation.snapshot_rasters = {
+    displacement:        { component_count: 1, get: world => world.lithosphere.displacement.value() },
+    surface_height:      { component_count: 1, get: world => world.lithosphere.surface_height.value() },
+    surface_temperature: { component_count: 1, get: world => world.atmosphere.surface_temperature },
+    snow_coverage:       { component_count: 1, get: world => world.hydrosphere.snow_coverage.value(), encoding: 'fixed16', min: 0, max: 1 },
+    plant_coverage:      { component_count: 1, get: world => world.biosphere.plant_coverage.value(), encoding: 'fixed16', min: 0, max: 1 },
+    surface_gradient:    { component_count: 3, get: world => world.surface_gradient.value() },
+};
+// "get_snapshot_raster_byte_length" returns the size of a snapshot raster within a frame for "grid", 
+//   padded so that the next raster starts on a 4 byte boundary
+RemoteSimulation.get_snapshot_raster_byte_length = function(snapshot_raster, grid) {
+    var bytes_per_element = snapshot_raster.encoding !== void 0? Uint16Array.BYTES_PER_ELEMENT : Float32Array.BYTES_PER_ELEMENT;
+    var byte_length = snapshot_raster.component_count * grid.vertices.length * bytes_per_element;
+    return Math.ceil(byte_length / Float32Array.BYTES_PER_ELEMENT) * Float32Array.BYTES_PER_ELEMENT;
+}
+// "get_frame_byte_length" returns the size of a frame that holds a snapshot for "grid"
+RemoteSimulation.get_frame_byte_length = function(grid) {
+    var byte_length = 0;
+    for (var key in RemoteSimulation.snapshot_rasters) {
+        byte_length += RemoteSimulation.get_snapshot_raster_byte_length(RemoteSimulation.snapshot_rasters[key], grid);
+    }
+    return byte_length;
+}
+// "pack" copies the snapshot rasters of "world" into "frame", an ArrayBuffer
+RemoteSimulation.pack = function(world, frame) {
+    var rasters = RemoteSimulation.unpack(frame, world.grid);
+    for (var key in RemoteSimulation.snapshot_rasters) {
+        var value = RemoteSimulation.snapshot_rasters[key].get(world);
+        if (rasters[key].encoding !== void 0) {
+            QuantizedRaster.encode(value, rasters[key]);
+        } else if (value instanceof Float32Array) {
+            rasters[key].set(value);
+        } else {
+            rasters[key].x.set(value.x);
+            rasters[key].y.set(value.y);
+            rasters[key].z.set(value.z);
+        }
+    }
+}
+// "unpack" returns rasters of "grid" that are views into "frame", indexed by the keys of "snapshot_rasters"
+// Rasters with an "encoding" are returned as QuantizedRasters, see "decode".
+RemoteSimulation.unpack = function(frame, grid) {
+    var length = grid.vertices.length;
+    var byte_offset = 0;
+    var rasters = {};
+    for (var key in RemoteSimulation.snapshot_rasters) {
+        var snapshot_raster = RemoteSimulation.snapshot_rasters[key];
+        var component_count = snapshot_raster.component_count;
+        var byte_length = RemoteSimulation.get_snapshot_raster_byte_length(snapshot_raster, grid);
+        if (snapshot_raster.encoding !== void 0) {
+            rasters[key] = QuantizedRaster.FromBuffer(frame, grid, byte_offset, snapshot_raster.encoding, snapshot_raster.min, snapshot_raster.max);
+            byte_offset += byte_length;
+            continue;
+        }
+        var everything = new Float32Array(frame, byte_offset, component_count * length);
+        if (component_count === 1) {
+            everything.grid = grid;
+            rasters[key] = everything;
+        } else {
+            rasters[key] = {
+                x: everything.subarray(0 * length, 1 * length),
+                y: everything.subarray(1 * length, 2 * length),
+                z: everything.subarray(2 * length, 3 * length),
+                everything: everything,
+                grid: grid,
+            };
+        }
+        byte_offset += byte_length;
+    }
+    return rasters;
+}
+// "decode" replaces the QuantizedRasters within "rasters", as returned by "unpack", with Float32Rasters,
+//   which are stored in "decoded", indexed by the same keys, so that they are reused from one snapshot to the next
+RemoteSimulation.decode = function(rasters, decoded) {
+    for (var key in rasters) {
+        if (rasters[key].encoding !== void 0) {
+            decoded[key] = decoded[key] || Float32Raster(rasters[key].grid);
+            rasters[key] = QuantizedRaster.decode(rasters[key], decoded[key]);
+        }
+    }
+    return rasters;
+}
@@ -0,0 +1,32 @@
+'use strict';
+
+
+// A Scheduler decides how often a subsystem is stepped, and by how much, given the timesteps of the simulation.
+// Subsystems can have natural timescales that are nothing like the timestep of a rendered frame:
+//   a frame at high speed can span thousands of years, which is next to nothing for plate tectonics but far too much for weather.
+// Time accumulates until it reaches "min_timestep", at which point the subsystem steps over all of it at once,
+//   and if that exceeds "max_timestep", the step is split into equal substeps.
+// No more than "max_substep_count" substeps are run at once, so a subsystem that can not keep up
+//   takes longer steps rather than falling further and further behind.
+function Scheduler(min_timestep, max_timestep, max_substep_count) {
+    this.min_timestep = min_timestep || 0;
+    this.max_timestep = max_timestep || Infinity;
+    this.max_substep_count = max_substep_count || 1;
+    // time that has passed since the subsystem was last stepped
+    this.pending_time = 0;
+}
+// "advance" adds "timestep" to the pending time, then calls "step" for each substep that is due, if any
+// Returns the number of substeps that were run.
+Scheduler.prototype.advance = function(timestep, step) {
+    this.pending_time += timestep;
+    if (this.pending_time <= 0 || this.pending_time < this.min_timestep) {
+        return 0;
+    }
+    var substep_count = Math.max(Math.min(Math.ceil(this.pending_time / this.max_timestep), this.max_substep_count), 1);
+    var substep = this.pending_time / substep_count;
+    this.pending_time = 0;
+    for (var i = 0; i < substep_count; i++) {
+        step(substep);
+    }
+    return substep_count;
+}
@@ -61,10 +61,9 @@ function Simulation (parameters) {
         var seconds = (now - this._last_update_timestamp)/1000;
         this._last_update_timestamp = now;
 
-        //minimum refresh rate of 5fps
-        if (seconds > 1/5){
-            return;
-        }
+        // minimum refresh rate of 5fps: slower frames are simulated as if they took 1/5s, 
+        //  so a long frame never causes a jump, and an occasional slow frame does not lose any time
+        seconds = Math.min(seconds, 1/5);
 
         if (this.paused){
             return;
@@ -81,9 +80,21 @@ function Simulation (parameters) {
         _model.invalidate(timestep);
         _model.calcChanges(timestep);
         _model.applyChanges(timestep);
+
+        if (Profiler.is_enabled) {
+            Profiler.count_rasters();
+        }
+
+        // report the call sites that created rasters during this step, see "RasterPool.is_debugging"
+        if (RasterPool.is_debugging) {
+            console.table(RasterPool.get_allocations());
+            RasterPool.reset_allocations();
+        }
     };
 
     this.toggle_pause = function () {
         this.paused = !this.paused;
     }
+
+    Profiler.instrument(this, 'simulation', ['update'], 'frame');
 }
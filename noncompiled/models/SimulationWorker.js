@@ -0,0 +1,132 @@
+'use strict';
+
+
+// "SimulationWorker.js" is the script of the Web Worker that a RemoteSimulation runs its Simulation in.
+// It is never loaded as a <script>, only by "new Worker()", so it loads the scripts of the model itself.
+// Paths are relative to this script.
+//
+// The worker receives the following messages:
+//   "simulation_init":           creates the simulation from "parameters", then starts stepping it,
+//                                where "grid_cache_entry" is added to "Grid.cache" beforehand, if given
+//                                and "is_profiling" enables the "Profiler", whose events are then sent along with each snapshot
+//                                and "is_using_wasm_kernels" loads the simd kernels, see "RasterWasmKernels.is_enabled"
+//   "simulation_set":            sets "speed" and/or "paused"
+//   "simulation_release":        returns a "frame" that the main thread has finished rendering
+//   "simulation_get_parameters": replies with a "simulation_parameters" message
+//   "simulation_import_elevations": replaces the crust of the focus with crust of the given "elevations", see "ImageImporter.set_elevations"
+// After each step, it posts a "simulation_snapshot" message whose "frame" is transferred, see "RemoteSimulation".
+importScripts(
+    '../../libraries/three.js/Three.js',
+    '../../libraries/random-0.26.js',
+    '../../postcompiled/Rasters.js',
+    '../Units.js',
+    '../Interpolation.js',
+    '../Logging.js',
+    '../Profiler.js',
+    '../academics/SphericalGeometry.js',
+    '../academics/Optics.js',
+    '../academics/Thermodynamics.js',
+    '../academics/FluidMechanics.js',
+    '../academics/OrbitalMechanics.js',
+    '../academics/Tectonophysics.js',
+    '../academics/Hydrology.js',
+    '../academics/Climatology.js',
+    '../academics/PlantBiology.js',
+    '../generators/CrustGenerator.js',
+    '../file-io/ImageImporter.js',
+    'Memo.js',
+    'Scheduler.js',
+    'RemoteSimulation.js',
+    'universe/Orbit.js',
+    'universe/Spin.js',
+    'universe/Star.js',
+    'universe/System.js',
+    'universe/Universe.js',
+    'lithosphere/Crust.js',
+    'lithosphere/RockColumn.js',
+    'lithosphere/Plate.js',
+    'lithosphere/SupercontinentCycle.js',
+    'lithosphere/Lithosphere.js',
+    'hydrosphere/Hydrosphere.js',
+    'atmosphere/Atmosphere.js',
+    'biosphere/Biosphere.js',
+    'World.js',
+    'Simulation.js'
+);
+
+(function() {
+    // the number of frames that are shared with the main thread, see "RemoteSimulation"
+    var FRAME_COUNT = 2;
+    // the maximum rate at which the simulation is stepped, in steps per second
+    var MAX_STEP_RATE = 20;
+
+    var sim = void 0;
+    var frames = [];
+
+    // the raster workers can only run while this thread is able to block, which requires cross origin isolation,
+    //   i.e. the page must be served with "Cross-Origin-Opener-Policy: same-origin" and "Cross-Origin-Embedder-Policy: require-corp",
+    //   or through "CrossOriginIsolationWorker.js" where the host can't send them.
+    // otherwise, the simd kernels are used if they were enabled, see "simulation_init"
+    if (self.crossOriginIsolated) {
+        Grid.default_options = { is_shared: true };
+        RasterStackBuffer.scratchpad = new RasterStackBuffer(RasterStackBuffer.scratchpad.buffer.byteLength, true);
+        RasterWorkerPool.start(void 0, '../../postcompiled/Rasters.js');
+    }
+    // iterated stencils run on the gpu if this worker can create a WebGL context, see "RasterGpuKernels"
+    RasterGpuKernels.load();
+
+    function publish() {
+        var frame = frames.pop();
+        if (frame === void 0) {
+            return;
+        }
+        var universe = sim.model();
+        var world = sim.focus;
+        RemoteSimulation.pack(world, frame);
+        self.postMessage({
+            type:         'simulation_snapshot',
+            frame:        frame,
+            elapsed_time: sim.elapsed_time,
+            config:       universe.config,
+            sealevel:     world.hydrosphere.sealevel.value(),
+            profile:      Profiler.is_enabled ? Profiler.take_events() : void 0,
+        }, [frame]);
+    }
+
+    function step() {
+        setTimeout(step, 1000/MAX_STEP_RATE);
+        sim.update();
+        publish();
+    }
+
+    self.addEventListener('message', function(event) {
+        var message = event.data;
+        if (message.type === 'simulation_init') {
+            if (message.grid_cache_entry !== void 0) {
+                Grid.set_cache_entry(message.grid_cache_key, message.grid_cache_entry);
+            }
+            RasterPool.is_debugging = message.is_debugging_allocations;
+            Profiler.is_enabled = message.is_profiling;
+            RasterWasmKernels.is_enabled = message.is_using_wasm_kernels;
+            if (RasterWasmKernels.is_enabled && !self.crossOriginIsolated) {
+                RasterWasmKernels.load('../../postcompiled/RasterKernels.wasm');
+            }
+            sim = new Simulation(message.parameters);
+            frames = [];
+            for (var i = 0; i < FRAME_COUNT; i++) {
+                frames.push(new ArrayBuffer(RemoteSimulation.get_frame_byte_length(sim.focus.grid)));
+            }
+            sim._last_update_timestamp = performance.now();
+            step();
+        } else if (message.type === 'simulation_set') {
+            if (message.speed  !== void 0) { sim.speed  = message.speed; }
+            if (message.paused !== void 0) { sim.paused = message.paused; }
+        } else if (message.type === 'simulation_release') {
+            frames.push(message.frame);
+        } else if (message.type === 'simulation_get_parameters') {
+            self.postMessage({ type: 'simulation_parameters', parameters: sim.getParameters() });
+        } else if (message.type === 'simulation_import_elevations') {
+            ImageImporter.set_elevations(sim.focus, Float32Raster.FromArray(message.elevations, sim.focus.grid));
+        }
+    });
+})();
@@ -53,6 +53,36 @@ function World(parameters) {
     this.atmosphere     = new Atmosphere    (this.grid, parameters.atmosphere     || {});
     this.biosphere         = new Biosphere        (this.grid, parameters.biosphere     || {});
 
+    // "surface_gradient" is the gradient of surface height, per meter of distance along the surface
+    this.surface_gradient = new Memo(
+        VectorRaster(this.grid),
+        result => {
+            ScalarField.gradient(this.lithosphere.surface_height.value(), result);
+            VectorField.div_scalar(result, this.radius, result);
+            return result;
+        },
+        true,
+        { name: 'world.surface_gradient', is_pure: true }
+    );
+
+    // how often each subsystem is stepped, see "Scheduler"
+    // the lithosphere changes so slowly that it is stepped in batches of at least 10 thousand years, 
+    //  so fast forwarding geologic time does not cost a full lithosphere update for every frame
+    // the atmosphere is stepped every frame, so the day side warms and the night side cools as the planet turns.
+    //  It is never batched: at speeds where a frame is short, batches would hold back the temperature field by many frames,
+    //  and at speeds where a frame is long, every frame already spans a batch.
+    //  Its steps are never split either: past a week it jumps straight to its equilibrium temperature, see "Atmosphere.applyChanges",
+    //  so substeps of a longer step would each do the same thing.
+    // the hydrosphere and biosphere only derive their fields from other subsystems, so they follow the atmosphere
+    this.schedulers = {
+        lithosphere: new Scheduler(1e4*Units.YEAR, 1e5*Units.YEAR, 2),
+        hydrosphere: new Scheduler(),
+        atmosphere:  new Scheduler(),
+        biosphere:   new Scheduler(),
+    };
+    // whether the lithosphere was stepped since its memos were last invalidated
+    var is_lithosphere_changed = true;
+
 
     this.getParameters = function() {
         return { 
@@ -125,23 +155,27 @@ function World(parameters) {
         this.biosphere.initialize();
     }
 
+    // the steps of each subsystem are recorded by the Profiler, if enabled
+    Profiler.instrument(this.lithosphere, 'lithosphere', ['invalidate', 'calcChanges', 'applyChanges'], 'model');
+    Profiler.instrument(this.hydrosphere, 'hydrosphere', ['invalidate', 'calcChanges', 'applyChanges'], 'model');
+    Profiler.instrument(this.atmosphere,  'atmosphere',  ['invalidate', 'calcChanges', 'applyChanges'], 'model');
+    Profiler.instrument(this.biosphere,   'biosphere',   ['invalidate', 'calcChanges', 'applyChanges'], 'model');
+
     this.invalidate = function() {
-        this.lithosphere.invalidate();
+        // NOTE: lithosphere fields only change when the lithosphere is stepped, so they are only invalidated then
+        if (is_lithosphere_changed) {
+            this.lithosphere.invalidate();
+            this.surface_gradient.invalidate();
+            is_lithosphere_changed = false;
+        }
         this.hydrosphere.invalidate();
         this.atmosphere.invalidate();
         this.biosphere.invalidate();
     }
 
+    // NOTE: subsystems calculate and apply their changes together within applyChanges(), 
+    //  since each substep must see the changes applied by the last one
     this.calcChanges = function(timestep) {
-        if (timestep === 0) {
-            return;
-        };
-
-        // TODO: switch all submodels to record time in seconds
-        this.lithosphere.calcChanges(timestep);
-        this.hydrosphere.calcChanges(timestep);
-        this.atmosphere.calcChanges(timestep);
-        this.biosphere.calcChanges(timestep);
     };
 
     this.applyChanges = function(timestep) {
@@ -149,10 +183,29 @@ function World(parameters) {
             return;
         };
 
-        this.lithosphere.applyChanges(timestep);
-        this.hydrosphere.applyChanges(timestep);
-        this.atmosphere.applyChanges(timestep);
-        this.biosphere.applyChanges(timestep);
+        // TODO: switch all submodels to record time in seconds
+        var this_ = this;
+        var lithosphere_timestep = this.lithosphere.is_perceivable(timestep)? timestep : 0;
+        this.schedulers.lithosphere.advance(lithosphere_timestep, function(substep) {
+            if (is_lithosphere_changed) {
+                this_.invalidate();
+            }
+            this_.lithosphere.calcChanges(substep);
+            this_.lithosphere.applyChanges(substep);
+            is_lithosphere_changed = true;
+        });
+        this.schedulers.hydrosphere.advance(timestep, function(substep) {
+            this_.hydrosphere.calcChanges(substep);
+            this_.hydrosphere.applyChanges(substep);
+        });
+        this.schedulers.atmosphere.advance(timestep, function(substep) {
+            this_.atmosphere.calcChanges(substep);
+            this_.atmosphere.applyChanges(substep);
+        });
+        this.schedulers.biosphere.advance(timestep, function(substep) {
+            this_.biosphere.calcChanges(substep);
+            this_.biosphere.applyChanges(substep);
+        });
     };
     return this;
 }
\ No newline at end of file
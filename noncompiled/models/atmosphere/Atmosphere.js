@@ -24,7 +24,9 @@ function Atmosphere(grid, parameters) {
             var absorbed_radiation = this.scratch; // double duty for performance
             ScalarField.mult_field( this.absorption.value(), long_term_average_insolation, result );
             return result;
-        }
+        },
+        true,
+        { name: 'atmosphere.long_term_absorbed_radiation' }
     );
     this.long_term_heat_flow = new Memo(
         Float32Raster(grid),  
@@ -48,7 +50,9 @@ function Atmosphere(grid, parameters) {
                 result
             );
             return result;
-        }
+        },
+        true,
+        { name: 'atmosphere.long_term_heat_flow', is_pure: true }
     );
     this.long_term_sealevel_temperature = new Memo(
         Float32Raster(grid),  
@@ -59,21 +63,19 @@ function Atmosphere(grid, parameters) {
             ScalarField.div_scalar(incoming_heat, this.emission_coefficient, incoming_heat);
             Thermodynamics.get_equilibrium_temperatures(incoming_heat, result);
             return result;
-        }
+        },
+        true,
+        { name: 'atmosphere.long_term_sealevel_temperature', is_pure: true }
     );
     this.long_term_surface_temperature = new Memo(
         Float32Raster(grid),  
         result => ScalarField.sub_scalar_term ( this.long_term_sealevel_temperature.value(), surface_height.value(), this.lapse_rate, result ),
+        true,
+        { name: 'atmosphere.long_term_surface_temperature', is_pure: true }
     );
 
     this.average_insolation = Float32Raster(grid);
-    this.absorbed_radiation = Float32Raster(grid);
     this.get_varying_heat_capacity = Float32Raster(grid);
-    this.incoming_heat = Float32Raster(grid);
-    this.outgoing_heat = Float32Raster(grid);
-    this.net_heat_gain = Float32Raster(grid);
-    this.temperature_delta_rate = Float32Raster(grid);
-    this.temperature_delta = Float32Raster(grid);
     this.sealevel_temperature = undefined;
     this.surface_temperature = Float32Raster(grid);
 
@@ -83,7 +85,8 @@ function Atmosphere(grid, parameters) {
         // result => Climatology.get_albedos(ocean_coverage.value(), snow_coverage.value(), plant_coverage.value(), material_reflectivity, result),
         // result => Climatology.get_albedos(ocean_coverage.value(), undefined, plant_coverage.value(), material_reflectivity, result),
         result => { Float32Raster.fill(result, 0.2); return result; },
-        false // assume everything gets absorbed initially to prevent circular dependencies
+        false, // assume everything gets absorbed initially to prevent circular dependencies
+        { name: 'atmosphere.get_varying_albedo', is_pure: true }
     );
     this.absorption = new Memo(
         Float32Raster(grid),  
@@ -92,14 +95,20 @@ function Atmosphere(grid, parameters) {
             ScalarField.add_scalar     ( result, 1, result );
             return result;
         },
+        true,
+        { name: 'atmosphere.absorption', is_pure: true }
     );
     var lat = new Memo(
         Float32Raster(grid),  
-        result => SphericalGeometry.get_latitudes(grid.pos.y, result)
+        result => SphericalGeometry.get_latitudes(grid.pos.y, result),
+        true,
+        { name: 'atmosphere.lat', is_pure: true }
     ); 
     this.surface_pressure = new Memo(
         Float32Raster(grid),  
-        result => Climatology.guess_surface_air_pressures( this.surface_temperature, lat.value(), material_heat_capacity, 100e3, result)
+        result => Climatology.guess_surface_air_pressures( this.surface_temperature, lat.value(), material_heat_capacity, 100e3, result),
+        true,
+        { name: 'atmosphere.surface_pressure' }
     ); 
     this.surface_wind_velocity = new Memo(
         VectorRaster(grid),  
@@ -108,11 +117,15 @@ function Atmosphere(grid, parameters) {
             _this.surface_pressure.value(), 
             angular_speed, 
             result
-        )
+        ),
+        true,
+        { name: 'atmosphere.surface_wind_velocity', is_pure: true }
     ); 
     this.precipitation = new Memo(
         Float32Raster(grid),  
-        result => Climatology.guess_precipitation_fluxes(lat.value(), result)
+        result => Climatology.guess_precipitation_fluxes(lat.value(), result),
+        true,
+        { name: 'atmosphere.precipitation', is_pure: true }
     );
 
     // private variables
@@ -172,21 +185,23 @@ function Atmosphere(grid, parameters) {
             this.sealevel_temperature = Float32Raster.copy(this.long_term_sealevel_temperature.value(),     this.sealevel_temperature);
         } else {
             get_average_insolation(timestep,                                              this.average_insolation);
-            ScalarField.mult_field( this.absorption.value(), this.average_insolation,     this.absorbed_radiation );
-
-            ScalarField.add_field(
-                this.absorbed_radiation, 
-                this.long_term_heat_flow.value(), 
-                this.incoming_heat
-            );
-
-            Thermodynamics.get_intensity_of_light_emitted_by_black_bodies(this.sealevel_temperature, this.outgoing_heat);
-            ScalarField.mult_scalar       ( this.outgoing_heat, this.emission_coefficient,     this.outgoing_heat);
             Climatology.get_heat_capacities(ocean_coverage.value(), material_heat_capacity,    this.get_varying_heat_capacity);
-            ScalarField.sub_field         ( this.incoming_heat, this.outgoing_heat,            this.net_heat_gain );
-            ScalarField.div_field         ( this.net_heat_gain, this.get_varying_heat_capacity,this.temperature_delta_rate );
-            ScalarField.mult_scalar       ( this.temperature_delta_rate, timestep,             this.temperature_delta );
-            ScalarField.add_field         ( this.temperature_delta, this.sealevel_temperature, this.sealevel_temperature );
+
+            // the heat budget is evaluated as a single loop, so none of its terms need rasters of their own
+            var temperature = this.sealevel_temperature;
+            var outgoing_heat = Float32RasterExpression(temperature)
+                .mult_field  (temperature)
+                .mult_field  (temperature)
+                .mult_field  (temperature)
+                .mult_scalar (Thermodynamics.STEPHAN_BOLTZMANN_CONSTANT * this.emission_coefficient);
+            Float32RasterExpression(this.absorption.value())
+                .mult_field  (this.average_insolation)
+                .add_field   (this.long_term_heat_flow.value())
+                .sub_field   (outgoing_heat)
+                .div_field   (this.get_varying_heat_capacity)
+                .mult_scalar (timestep)
+                .add_field   (temperature)
+                .evaluate    (temperature);
         }
 
 
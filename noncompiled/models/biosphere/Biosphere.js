@@ -21,15 +21,21 @@ function Biosphere(grid, parameters) {
         Float32Raster(grid),  
         result => {
             return PlantBiology.net_primary_productivities(long_term_surface_temperature.value(), precipitation.value(), npp_max, result)
-        }
+        },
+        true,
+        { name: 'biosphere.npp', is_pure: true }
     ); 
     this.lai = new Memo(
         Float32Raster(grid),  
-        result => PlantBiology.leaf_area_indices(self.npp.value(), npp_max, lai_max, result, growth_factor)
+        result => PlantBiology.leaf_area_indices(self.npp.value(), npp_max, lai_max, result, growth_factor),
+        true,
+        { name: 'biosphere.lai', is_pure: true }
     ); 
     this.plant_coverage = new Memo(
         Float32Raster(grid),  
-        result => Float32RasterInterpolation.linearstep(0, 1, self.lai.value(), result)
+        result => Float32RasterInterpolation.linearstep(0, 1, self.lai.value(), result),
+        true,
+        { name: 'biosphere.plant_coverage', is_pure: true }
     ); 
 
     // private variables
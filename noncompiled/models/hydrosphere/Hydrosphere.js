@@ -17,6 +17,7 @@ function Hydrosphere(grid, parameters) {
                 // Float32Raster(grid) 
             ),
         true,
+        { name: 'hydrosphere.sealevel', is_pure: true }
     ); 
 
     this.getParameters = function() {
@@ -27,20 +28,28 @@ function Hydrosphere(grid, parameters) {
 
     // height of sealevel, in meters, relative to the same datum level used by displacement
     this.epipelagic = new Memo( 0,  
-        current_value => _this.sealevel.value()-200
+        current_value => _this.sealevel.value()-200,
+        true,
+        { name: 'hydrosphere.epipelagic', is_pure: true }
     ); 
     this.mesopelagic = new Memo( 0,  
-        current_value => _this.sealevel.value()-1000
+        current_value => _this.sealevel.value()-1000,
+        true,
+        { name: 'hydrosphere.mesopelagic', is_pure: true }
     ); 
     // "elevation" is the height of the crust relative to sealevel
     this.elevation = new Memo(
         Float32Raster(grid),  
-        result => ScalarField.sub_scalar(displacement.value(), _this.sealevel.value(), result)
+        result => ScalarField.sub_scalar(displacement.value(), _this.sealevel.value(), result),
+        true,
+        { name: 'hydrosphere.elevation', is_pure: true }
     ); 
     // "ocean_depth" is the depth of the ocean - if elevation > 0, then ocean_depth = 0; if elevation < 0, then ocean_depth > 0 
     this.ocean_depth = new Memo(
         Float32Raster(grid),  
-        result => Hydrology.get_ocean_depths(displacement.value(), _this.sealevel.value(), result)
+        result => Hydrology.get_ocean_depths(displacement.value(), _this.sealevel.value(), result),
+        true,
+        { name: 'hydrosphere.ocean_depth', is_pure: true }
     ); 
     this.snow_coverage = new Memo(
         Float32Raster(grid),  
@@ -69,7 +78,8 @@ function Hydrosphere(grid, parameters) {
             );
             return result;
         },
-        false
+        false,
+        { name: 'hydrosphere.snow_coverage' }
     );
     this.ocean_coverage = new Memo(
         Float32Raster(grid),  
@@ -78,7 +88,9 @@ function Hydrosphere(grid, parameters) {
             _this.epipelagic.value(), 
             displacement.value(), 
             result
-        )
+        ),
+        true,
+        { name: 'hydrosphere.ocean_coverage', is_pure: true }
     ); 
 
     this.invalidate = function() {
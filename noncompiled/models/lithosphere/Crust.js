@@ -208,13 +208,16 @@ Crust.add_values_to_ids = function(crust, id_raster, value_crust, result_crust)
     }
 }
 Crust.fix_delta = function(crust_delta, crust, scratch) {
-    var scratch = scratch || Float32Raster(crust_delta.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Crust.fix_delta');
+    var scratch = scratch || pool.getFloat32Raster(crust_delta.grid);
     var f = ScalarTransport.fix_nonnegative_conserved_quantity_delta;
     var delta_pools = crust_delta.conserved_pools;
     var crust_pools = crust.conserved_pools;
     for (var i = 0, li = crust_pools.length; i < li; ++i) {
         f(delta_pools[i], crust_pools[i], scratch);
     }
+    pool.deallocate('Crust.fix_delta');
 }
 Crust.is_conserved_delta = function(crust_delta, threshold) {
     return ScalarTransport.is_conserved_quantity_delta(crust_delta.conserved_array, threshold);
@@ -230,7 +233,9 @@ Crust.is_conserved_transport_delta = function(crust_delta, threshold) {
     return true;
 }
 Crust.is_conserved_reaction_delta = function(crust_delta, threshold, scratch) {
-    var sum = scratch || Float32Raster(crust_delta.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Crust.is_conserved_reaction_delta');
+    var sum = scratch || pool.getFloat32Raster(crust_delta.grid);
     sum.fill(0);
     var f = ScalarField.add_field;
     var delta_pools = crust_delta.conserved_pools;
@@ -238,7 +243,9 @@ Crust.is_conserved_reaction_delta = function(crust_delta, threshold, scratch) {
         f(sum, delta_pools[i], sum);
     }
     ScalarField.mult_field(sum, sum, sum);
-    return Uint8Dataset.sum(ScalarField.gt_scalar(sum, threshold * threshold)) == 0;
+    var is_conserved = Uint8Dataset.sum(ScalarField.gt_scalar(sum, threshold * threshold, pool.getUint8Raster(crust_delta.grid))) == 0;
+    pool.deallocate('Crust.is_conserved_reaction_delta');
+    return is_conserved;
 }
 
 
@@ -258,7 +265,9 @@ Crust.overlap = function(crust1, crust2, crust2_exists, crust2_on_top, result_cr
 Crust.get_thickness = function(crust, material_density, thickness) {
     thickness = thickness || Float32Raster(crust.grid);
 
-    var scratch = Float32Raster(crust.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Crust.get_thickness');
+    var scratch = pool.getFloat32Raster(crust.grid);
 
     var fraction_of_lifetime = scratch;
     Float32RasterInterpolation.linearstep    (0* Units.MEGAYEAR, 250* Units.MEGAYEAR, crust.age, fraction_of_lifetime);
@@ -278,6 +287,7 @@ Crust.get_thickness = function(crust, material_density, thickness) {
         f(thickness, crust_pools[i], 1/pool_densities[i],  thickness);
     }
 
+    pool.deallocate('Crust.get_thickness');
     return thickness;
 }
 
@@ -424,7 +434,9 @@ Crust.model_weathering = function(
         material_density, surface_gravity,
         top_crust, crust_delta, crust_scratch){
   var grid = surface_height.grid;
-  var scratch = Float32Raster(grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('Crust.model_weathering');
+  var scratch = pool.getFloat32Raster(grid);
 
   var precip = 1.05 / Units.YEAR;
   // ^^^ measured in meters of rain per million years 
@@ -437,7 +449,7 @@ Crust.model_weathering = function(
  
   var earth_surface_gravity = 9.8; // m/s^2 
    
-  var average_difference = ScalarField.average_difference(surface_height); 
+  var average_difference = ScalarField.average_difference(surface_height, pool.getFloat32Raster(grid)); 
   var weathering = scratch;
   // NOTE: result array does double duty for performance reasons 
  
@@ -450,7 +462,7 @@ Crust.model_weathering = function(
     surface_gravity/earth_surface_gravity, //correct for planet's gravity 
     weathering) 
    
-  var bedrock_exposure = Float32Raster(grid); 
+  var bedrock_exposure = pool.getFloat32Raster(grid); 
   ScalarField.div_scalar(top_crust.sediment,  
     -critical_sediment_thickness * material_density.sediment
     // * material_density.sediment 
@@ -463,7 +475,8 @@ Crust.model_weathering = function(
   
   // NOTE: this draws from all pools equally
   // TODO: draw from topmost pools, first, borrowing code from bedrock_exposure
-  var conserved = Float32Raster(grid);
+  var conserved = pool.getFloat32Raster(grid);
+  Float32Raster.fill(conserved, 0);
   ScalarField.add_field(conserved, top_crust.sedimentary, conserved);
   ScalarField.add_field(conserved, top_crust.metamorphic, conserved);
   ScalarField.add_field(conserved, top_crust.felsic_plutonic,         conserved);
@@ -472,9 +485,9 @@ Crust.model_weathering = function(
   ScalarField.min_field(weathering, conserved, weathering); 
   ScalarField.max_scalar(weathering, 0, weathering); 
 
-  var ratio = ScalarField.div_field(weathering, conserved);
+  var ratio = ScalarField.div_field(weathering, conserved, pool.getFloat32Raster(grid));
 
-  var is_div_by_zero = ScalarField.lt_scalar(conserved, 0.01);
+  var is_div_by_zero = ScalarField.lt_scalar(conserved, 0.01, pool.getUint8Raster(grid));
 
   Float32RasterGraphics.fill_into_selection(ratio, 0, is_div_by_zero, ratio);
 
@@ -486,6 +499,8 @@ Crust.model_weathering = function(
   Float32Raster.fill(crust_delta.mafic_volcanic, 0);
 
   ScalarField.mult_scalar(crust_delta.everything, -1, crust_delta.everything);
+
+  pool.deallocate('Crust.model_weathering');
 } 
 
 
@@ -517,18 +532,17 @@ Crust.model_erosion = function(
     var outbound_height_transfer = scratchpad.getFloat32Raster(surface_height.grid);
     Float32Raster.fill(outbound_height_transfer, 0);
 
-    var arrows = surface_height.grid.arrows;
-    var arrow;
+    var arrow_from = surface_height.grid.arrow_from;
+    var arrow_to = surface_height.grid.arrow_to;
     var from = 0;
     var to = 0;
     var height_difference = 0.0;
     var outbound_height_transfer_i = 0.0;
       var neighbor_count = surface_height.grid.neighbor_count;
 
-    for (var i=0, li=arrows.length; i<li; ++i) {
-        arrow = arrows[i];
-        from = arrow[0];
-        to = arrow[1];
+    for (var i=0, li=arrow_from.length; i<li; ++i) {
+        from = arrow_from[i];
+        to = arrow_to[i];
         height_difference = surface_height[from] - surface_height[to];
         outbound_height_transfer[from] += height_difference > 0? height_difference *precip * seconds * erosiveFactor * material_density.felsic_plutonic : 0;
     }
@@ -577,10 +591,9 @@ Crust.model_erosion = function(
     var felsic_volcanic_delta          = crust_delta.felsic_volcanic;
 
     var transfer = 0.0;
-    for (var i=0, li=arrows.length; i<li; ++i) {
-        arrow = arrows[i];
-        from = arrow[0];
-        to = arrow[1];
+    for (var i=0, li=arrow_from.length; i<li; ++i) {
+        from = arrow_from[i];
+        to = arrow_to[i];
         height_difference = surface_height[from] - surface_height[to];
         outbound_height_transfer_i = height_difference > 0? height_difference *precip * seconds * erosiveFactor * material_density.felsic_plutonic : 0;
 
@@ -35,30 +35,42 @@ function Lithosphere(grid, parameters) {
     // "surface_height" is the height of the surface relative to sealevel - if elevation < 0, then surface_height = 0
     this.surface_height = new Memo(
         Float32Raster(grid),  
-        result => Hydrology.get_surface_heights(this.displacement.value(), sealevel.value(), result)
+        result => Hydrology.get_surface_heights(this.displacement.value(), sealevel.value(), result),
+        true,
+        { name: 'lithosphere.surface_height', is_pure: true }
     ); 
     this.displacement = new Memo(  
         Float32Raster(grid),  
-        result => FluidMechanics.get_isostatic_displacements(self.thickness.value(), self.density.value(), material_density, result) 
+        result => FluidMechanics.get_isostatic_displacements(self.thickness.value(), self.density.value(), material_density, result),
+        true,
+        { name: 'lithosphere.displacement', is_pure: true }
     ); 
     // the thickness of the crust in km
     this.thickness = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_thickness(self.total_crust, material_density, result)
+        result => Crust.get_thickness(self.total_crust, material_density, result),
+        true,
+        { name: 'lithosphere.thickness' }
     ); 
     // total mass of the crust in kg
     this.total_mass = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_total_mass(self.total_crust, result)
+        result => Crust.get_total_mass(self.total_crust, result),
+        true,
+        { name: 'lithosphere.total_mass' }
     ); 
     // the average density of the crust, in kg/m^3
     this.density = new Memo(
         Float32Raster(grid),  
-        result => Crust.get_density(self.total_mass.value(), self.thickness.value(),    material_density.mafic_volcanic_min, result)
+        result => Crust.get_density(self.total_mass.value(), self.thickness.value(),    material_density.mafic_volcanic_min, result),
+        true,
+        { name: 'lithosphere.density', is_pure: true }
     ); 
     this.buoyancy = new Memo(
         Float32Raster(grid),  
-        result => Crust.get_buoyancy(self.density.value(), material_density, surface_gravity, result)
+        result => Crust.get_buoyancy(self.density.value(), material_density, surface_gravity, result),
+        true,
+        { name: 'lithosphere.buoyancy', is_pure: true }
     ); 
 
     this.top_plate_map             = Uint8Raster(grid);
@@ -101,7 +113,7 @@ function Lithosphere(grid, parameters) {
         Uint8Raster.fill(master.plate_count, 0);
 
         
-        var master_density = Float32Raster(grid); 
+        var master_density = scratchpad.getFloat32Raster(grid); 
         Float32Raster.fill(master_density, 9999);
 
         //local variables
@@ -176,23 +188,32 @@ function Lithosphere(grid, parameters) {
 
           //rifting/detaching variables
         var localized_is_riftable = scratchpad.getUint8Raster(grid);
-        var localized_will_stay_riftable = scratchpad.getUint8Raster(grid);
-        var localized_is_just_outside_border = scratchpad.getUint8Raster(grid);
         var localized_is_rifting = scratchpad.getUint8Raster(grid);
 
+        // morphology is done on bitsets, see "BitsetMorphology"
+        var localized_plate_mask_bits = scratchpad.getBitset(grid);
+        var localized_is_riftable_bits = scratchpad.getBitset(grid);
+        var localized_will_stay_riftable_bits = scratchpad.getBitset(grid);
+        var localized_is_just_outside_border_bits = scratchpad.getBitset(grid);
+        var localized_is_rifting_bits = scratchpad.getBitset(grid);
+
         //global rifting/detaching variables
         var globalized_is_empty = scratchpad.getUint8Raster(grid);
         var globalized_is_alone = scratchpad.getUint8Raster(grid);
         var globalized_is_riftable = scratchpad.getUint8Raster(grid);
         var globalized_is_on_top = scratchpad.getUint8Raster(grid);
 
-        var scratch_ui8 = scratchpad.getUint8Raster(grid);
+        var scratch_bits = scratchpad.getBitset(grid);
 
         var resample = Uint8Raster.get_ids;
-        var margin = BinaryMorphology.margin;
+        var margin = BitsetMorphology.margin;
         var or = BinaryMorphology.union;
         var and = BinaryMorphology.intersection;
-        var erode = BinaryMorphology.erosion;
+        var and_bits = BitsetMorphology.intersection;
+        var erode = BitsetMorphology.erosion;
+        var pack = BitsetMorphology.pack;
+        var unpack = BitsetMorphology.unpack;
+        var count = BitsetMorphology.count;
         var equals = Uint8Field.eq_scalar;
         var fill_into = Uint8RasterGraphics.fill_into_selection;
         var fill_into_crust = Crust.fill_into_selection;
@@ -211,10 +232,17 @@ function Lithosphere(grid, parameters) {
             or         (globalized_is_riftable, globalized_is_empty,                       globalized_is_riftable); 
 
             resample(globalized_is_riftable, plate.global_ids_of_local_cells,           localized_is_riftable); 
-            erode     (localized_is_riftable, 1,                                           localized_will_stay_riftable,     scratch_ui8); 
-            margin     (plate.mask, 1,                                                       localized_is_just_outside_border, scratch_ui8); 
-            and     (localized_will_stay_riftable, localized_is_just_outside_border,      localized_is_rifting); 
-
+            pack     (localized_is_riftable,                                              localized_is_riftable_bits);
+            pack     (plate.mask,                                                         localized_plate_mask_bits);
+            erode     (localized_is_riftable_bits, 1,                                      localized_will_stay_riftable_bits,     scratch_bits); 
+            margin     (localized_plate_mask_bits, 1,                                       localized_is_just_outside_border_bits, scratch_bits); 
+            and_bits (localized_will_stay_riftable_bits, localized_is_just_outside_border_bits, localized_is_rifting_bits); 
+
+            // most plates are not rifting at any given step, so there is nothing to fill
+            if (count(localized_is_rifting_bits) === 0) {
+                continue;
+            }
+            unpack   (localized_is_rifting_bits,                                          localized_is_rifting);
             fill_into(plate.mask, 1, localized_is_rifting,                                 plate.mask); 
             fill_into_crust(plate.crust, rifting_crust, localized_is_rifting,                     plate.crust);
         }
@@ -233,11 +261,16 @@ function Lithosphere(grid, parameters) {
 
           //rifting/detaching variables
         var localized_is_subducted = scratchpad.getUint8Raster(grid);
-        var localized_will_stay_detachable = scratchpad.getUint8Raster(grid);
-        var localized_is_just_inside_border = scratchpad.getUint8Raster(grid);
         var localized_is_detaching = scratchpad.getUint8Raster(grid);
 
-        var localized_scratch_ui8 = scratchpad.getUint8Raster(grid); 
+        // morphology is done on bitsets, see "BitsetMorphology"
+        var localized_plate_mask_bits = scratchpad.getBitset(grid);
+        var localized_is_subducted_bits = scratchpad.getBitset(grid);
+        var localized_will_stay_detachable_bits = scratchpad.getBitset(grid);
+        var localized_is_just_inside_border_bits = scratchpad.getBitset(grid);
+        var localized_is_detaching_bits = scratchpad.getBitset(grid);
+
+        var localized_scratch_bits = scratchpad.getBitset(grid); 
         var localized_accretion = scratchpad.getFloat32Raster(grid); 
 
         //global rifting/detaching variables
@@ -252,9 +285,13 @@ function Lithosphere(grid, parameters) {
         var fill_into_f32 = Float32RasterGraphics.fill_into_selection;
         var resample_ui8 = Uint8Raster.get_ids;
         var resample_f32 = Float32Raster.get_ids;
-        var padding = BinaryMorphology.padding;
+        var padding = BitsetMorphology.padding;
         var and = BinaryMorphology.intersection;
-        var erode = BinaryMorphology.erosion;
+        var and_bits = BitsetMorphology.intersection;
+        var erode = BitsetMorphology.erosion;
+        var pack = BitsetMorphology.pack;
+        var unpack = BitsetMorphology.unpack;
+        var count = BitsetMorphology.count;
         var not_equals = Uint8Field.ne_scalar;
         var gt_f32 = ScalarField.gt_scalar;
         var add = ScalarField.add_field;
@@ -286,12 +323,20 @@ function Lithosphere(grid, parameters) {
             fill_into_f32(plate.crust.felsic_plutonic,         0, localized_is_subducted,                 plate.crust.felsic_plutonic);
             fill_into_f32(plate.crust.felsic_volcanic,         0, localized_is_subducted,                 plate.crust.felsic_volcanic);
 
-            erode        (localized_is_subducted, 1,                                            localized_will_stay_detachable,     localized_scratch_ui8);
-            padding     (plate.mask, 1,                                                     localized_is_just_inside_border,     localized_scratch_ui8);
+            pack        (localized_is_subducted,                                               localized_is_subducted_bits);
+            pack        (plate.mask,                                                           localized_plate_mask_bits);
+            erode        (localized_is_subducted_bits, 1,                                       localized_will_stay_detachable_bits,  localized_scratch_bits);
+            padding     (localized_plate_mask_bits, 1,                                         localized_is_just_inside_border_bits, localized_scratch_bits);
             gt_f32        (plate.density.value(), material_density.mantle,                    localized_is_subducted);
-            and         (localized_will_stay_detachable, localized_is_just_inside_border,     localized_is_detaching);
-            and         (localized_is_detaching, localized_is_subducted,                     localized_is_detaching);
-
+            pack        (localized_is_subducted,                                               localized_is_subducted_bits);
+            and_bits    (localized_will_stay_detachable_bits, localized_is_just_inside_border_bits, localized_is_detaching_bits);
+            and_bits    (localized_is_detaching_bits, localized_is_subducted_bits,             localized_is_detaching_bits);
+
+            // most plates are not detaching at any given step, so there is nothing to fill, and no accretion to add
+            if (count(localized_is_detaching_bits) === 0) {
+                continue;
+            }
+            unpack      (localized_is_detaching_bits,                                          localized_is_detaching);
             fill_into     (plate.mask, 0, localized_is_detaching,                             plate.mask); 
             
             // calculate accretion delta
@@ -468,9 +513,14 @@ function Lithosphere(grid, parameters) {
 
     var mean_supercontinent_cycle_duration = 150 * Units.MEGAYEAR;
 
-    this.calcChanges = function(seconds) {
+    // "is_perceivable" indicates whether plate motion would be noticeable if "seconds" pass every frame
+    this.is_perceivable = function(seconds) {
         var max_perceivable_duration = 60*60*24*30 * seconds; // 1 day worth of real time at 30fps
-        if (mean_supercontinent_cycle_duration > max_perceivable_duration) {
+        return mean_supercontinent_cycle_duration <= max_perceivable_duration;
+    }
+
+    this.calcChanges = function(seconds) {
+        if (!this.is_perceivable(seconds)) {
             return;
         }
         
@@ -480,8 +530,7 @@ function Lithosphere(grid, parameters) {
     };
 
     this.applyChanges = function(seconds){
-        var max_perceivable_duration = 60*60*24*30 * seconds; // 1 day worth of real time at 30fps
-        if (mean_supercontinent_cycle_duration > max_perceivable_duration) {
+        if (!this.is_perceivable(seconds)) {
             return;
         }
 
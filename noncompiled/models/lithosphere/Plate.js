@@ -28,43 +28,63 @@ function Plate(grid, parameters)
     // It is not called "elevation" because we want to emphasize that it is not relative to sea level
     this.displacement = new Memo(
         Float32Raster(grid),  
-        result => FluidMechanics.get_isostatic_displacements(self.thickness.value(), self.density.value(), material_density, result) 
+        result => FluidMechanics.get_isostatic_displacements(self.thickness.value(), self.density.value(), material_density, result),
+        true,
+        { name: 'plate.displacement' }
     ); 
     // the thickness of the crust in km
     this.thickness = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_thickness(self.crust, material_density, result)
+        result => Crust.get_thickness(self.crust, material_density, result),
+        true,
+        { name: 'plate.thickness' }
     ); 
     // total mass of the crust in tons
     this.total_mass = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_total_mass(self.crust, result)
+        result => Crust.get_total_mass(self.crust, result),
+        true,
+        { name: 'plate.total_mass' }
     ); 
     // the average density of the crust, in kg/m^3
     this.density = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_density(self.total_mass.value(), self.thickness.value(),    material_density.mafic_volcanic_min, result)
+        result => Crust.get_density(self.total_mass.value(), self.thickness.value(),    material_density.mafic_volcanic_min, result),
+        true,
+        { name: 'plate.density' }
     ); 
     this.buoyancy = new Memo(  
         Float32Raster(grid),  
-        result => Crust.get_buoyancy(self.density.value(), material_density, surface_gravity, result)
+        result => Crust.get_buoyancy(self.density.value(), material_density, surface_gravity, result),
+        true,
+        { name: 'plate.buoyancy' }
     ); 
     this.velocity = new Memo(  
         VectorRaster(grid), 
-        result => Tectonophysics.guess_plate_velocity(self.mask, self.buoyancy.value(), material_viscosity, result)
+        result => Tectonophysics.guess_plate_velocity(self.mask, self.buoyancy.value(), material_viscosity, result),
+        true,
+        { name: 'plate.velocity' }
     ); 
     this.center_of_mass = new Memo(  
         { x:0, y:0, z:0 },
-        result => Tectonophysics.get_plate_center_of_mass    (self.total_mass.value(), self.mask)
+        result => Tectonophysics.get_plate_center_of_mass    (self.total_mass.value(), self.mask),
+        true,
+        { name: 'plate.center_of_mass' }
     ); 
 
 
 
-    this.global_ids_of_local_cells = Uint16Raster(grid);
-    this.local_ids_of_global_cells = Uint16Raster(grid);
+    this.global_ids_of_local_cells = grid.createIdRaster();
+    this.local_ids_of_global_cells = grid.createIdRaster();
 
-    this.global_pos_of_local_cells = VectorRaster(grid);
-    this.local_pos_of_global_cells = VectorRaster(grid);
+    // ids are resampled incrementally, so each step only looks up the cells that could have changed their nearest id,
+    //   and the cost of a step scales with how far the plate moves, see "Grid.updateNearestIds"
+    // "*_drift" is the greatest distance any cell could have moved since the plate was created,
+    //   and "*_thresholds" is the drift at which each cell needs to be looked up again
+    this.global_ids_drift = 0;
+    this.local_ids_drift = 0;
+    this.global_ids_thresholds = new Float64Array(grid.vertices.length).fill(-Infinity);
+    this.local_ids_thresholds = new Float64Array(grid.vertices.length).fill(-Infinity);
 
     var material_density = undefined;
     var material_viscosity = undefined;
@@ -99,17 +119,19 @@ function Plate(grid, parameters)
 
         var rotation_matrix = Tectonophysics.get_plate_rotation_matrix3x3(this.velocity.value(), this.center_of_mass.value(), megayears);
 
+        var last_local_to_global_matrix = Matrix3x3.ColumnMajorOrder(this.local_to_global_matrix);
+        var last_global_to_local_matrix = Matrix3x3.ColumnMajorOrder(this.global_to_local_matrix);
         Matrix3x3.mult_matrix(this.local_to_global_matrix, rotation_matrix, this.local_to_global_matrix);
         Matrix3x3.invert(this.local_to_global_matrix, this.global_to_local_matrix);
 
         // for each cell in the master's grid, this raster indicates the id of the corresponding cell in the plate's grid
         // this is used to convert between global and local coordinate systems
-        VectorField.mult_matrix(grid.pos, this.global_to_local_matrix, this.local_pos_of_global_cells); 
-        grid.getNearestIds(this.local_pos_of_global_cells, this.local_ids_of_global_cells);
+        this.local_ids_drift += Matrix3x3.get_max_displacement(this.global_to_local_matrix, last_global_to_local_matrix);
+        grid.updateNearestIds(grid.pos, this.global_to_local_matrix, this.local_ids_drift, this.local_ids_thresholds, this.local_ids_of_global_cells);
 
         // for each cell in the plate's grid, this raster indicates the id of the corresponding cell in the world's grid
         // this is used to convert between global and local coordinate systems
-        VectorField.mult_matrix(grid.pos, this.local_to_global_matrix, this.global_pos_of_local_cells);
-        grid.getNearestIds(this.global_pos_of_local_cells, this.global_ids_of_local_cells);
+        this.global_ids_drift += Matrix3x3.get_max_displacement(this.local_to_global_matrix, last_local_to_global_matrix);
+        grid.updateNearestIds(grid.pos, this.local_to_global_matrix, this.global_ids_drift, this.global_ids_thresholds, this.global_ids_of_local_cells);
     }
 }
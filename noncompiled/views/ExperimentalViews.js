@@ -7,7 +7,7 @@ experimentalViews.eliptic_ids = new ScalarWorldView(
         new HeatmapRasterView( { scaling: true}), 
         function (crust) { 
           var ids = Float32Raster(crust.grid); 
-          Float32Raster.FromUint16Raster(crust.grid.vertex_ids, ids); 
+          Float32Raster.FromIdRaster(crust.grid.vertex_ids, ids); 
           var pos = OrbitalMechanics.get_ecliptic_coordinates_raster_from_equatorial_coordinates_raster( 
             crust.grid.pos, 
             23.5/180*Math.PI, 
@@ -0,0 +1,120 @@
+'use strict';
+
+// GridBufferGeometry creates indexed THREE.BufferGeometry whose vertices are the cells of a grid, in the order of the grid.
+// Every cell of a raster is therefore the value of an attribute at the same index,
+//   so rasters can be uploaded straight from their backing store, without expanding them to every corner of every face.
+//
+// Three.js r66 draws indexed geometry using 16 bit indices, so faces are split into "offsets",
+//   each of which starts at a base vertex that is added to each of its indices, see "get_offsets".
+// Grids of up to 65536 vertices need only one offset. Larger grids work so long as no single face spans more than that.
+// Vector rasters are uploaded as one attribute per component, e.g. "gradient_x", "gradient_y", and "gradient_z",
+//   since their components are stored as separate arrays, see "VectorRaster".
+var GridBufferGeometry = {};
+
+// the maximum number of vertices that can be addressed by the indices of a single offset
+GridBufferGeometry.MAX_OFFSET_VERTEX_COUNT = 65536;
+
+// index arrays and offsets, indexed by grid, since they are shared between all geometry of a grid
+GridBufferGeometry.indices = new WeakMap();
+
+// "create" returns geometry for "grid" that has position, normal, and index attributes
+GridBufferGeometry.create = function(grid) {
+    var vertices = grid.vertices;
+    var geometry = new THREE.BufferGeometry();
+    var positions = geometry.addAttribute('position', Float32Array, vertices.length, 3).array;
+    var normals   = geometry.addAttribute('normal',   Float32Array, vertices.length, 3).array;
+    for (var i = 0, i3 = 0, li = vertices.length; i < li; i++, i3 += 3) {
+        var vertex = vertices[i];
+        var length = Math.sqrt(vertex.x*vertex.x + vertex.y*vertex.y + vertex.z*vertex.z) || 1;
+        positions[i3+0] = vertex.x;
+        positions[i3+1] = vertex.y;
+        positions[i3+2] = vertex.z;
+        normals[i3+0] = vertex.x / length;
+        normals[i3+1] = vertex.y / length;
+        normals[i3+2] = vertex.z / length;
+    }
+    var indices = GridBufferGeometry.get_indices(grid);
+    // NOTE: the index array is copied, since three.js keeps the array of each geometry until it is disposed
+    geometry.attributes.index = { itemSize: 1, array: indices.array.slice() };
+    geometry.offsets = indices.offsets.map(offset => Object.assign({}, offset));
+    return geometry;
+}
+
+// "get_indices" returns the index array and offsets of "grid", creating them if needed
+GridBufferGeometry.get_indices = function(grid) {
+    var indices = GridBufferGeometry.indices.get(grid);
+    if (indices === void 0) {
+        indices = GridBufferGeometry.get_offsets(grid.faces, GridBufferGeometry.MAX_OFFSET_VERTEX_COUNT);
+        GridBufferGeometry.indices.set(grid, indices);
+    }
+    return indices;
+}
+// "get_offsets" splits "faces" into runs of consecutive faces whose vertices lie within "max_vertex_count" of each other,
+//   returning a Uint16Array of indices relative to the lowest vertex of their run, along with the runs themselves
+GridBufferGeometry.get_offsets = function(faces, max_vertex_count) {
+    var array = new Uint16Array(faces.length * 3);
+    var offsets = [];
+    var start = 0;
+    var min_id = Infinity;
+    var max_id = -Infinity;
+    function add_offset(end) {
+        for (var j = start; j < end; j++) {
+            var face = faces[j];
+            array[3*j+0] = face.a - min_id;
+            array[3*j+1] = face.b - min_id;
+            array[3*j+2] = face.c - min_id;
+        }
+        offsets.push({ start: 3*start, count: 3*(end-start), index: min_id });
+    }
+    for (var i = 0, li = faces.length; i < li; i++) {
+        var face = faces[i];
+        var face_min_id = Math.min(face.a, face.b, face.c);
+        var face_max_id = Math.max(face.a, face.b, face.c);
+        if (face_max_id - face_min_id >= max_vertex_count) {
+            throw `GridBufferGeometry: face ${i} spans more vertices than 16 bit indices can address`;
+        }
+        if (i > start && Math.max(max_id, face_max_id) - Math.min(min_id, face_min_id) >= max_vertex_count) {
+            add_offset(i);
+            start = i;
+            min_id = Infinity;
+            max_id = -Infinity;
+        }
+        min_id = Math.min(min_id, face_min_id);
+        max_id = Math.max(max_id, face_max_id);
+    }
+    if (start < faces.length) {
+        add_offset(faces.length);
+    }
+    return { array: array, offsets: offsets };
+}
+
+// "add_attribute" adds an attribute to "geometry" that holds a Float32Raster of its grid
+GridBufferGeometry.add_attribute = function(geometry, key) {
+    geometry.addAttribute(key, Float32Array, geometry.attributes.position.array.length / 3, 1);
+}
+// "add_vector_attribute" adds attributes to "geometry" that hold each component of a VectorRaster of its grid
+GridBufferGeometry.add_vector_attribute = function(geometry, key) {
+    GridBufferGeometry.add_attribute(geometry, key+'_x');
+    GridBufferGeometry.add_attribute(geometry, key+'_y');
+    GridBufferGeometry.add_attribute(geometry, key+'_z');
+}
+
+// "update_attribute" uploads "raster" to the attribute of "geometry" named "key"
+// Once the renderer has created the buffer of the attribute, the raster is written to it directly with bufferSubData(),
+//   otherwise it is copied to the array of the attribute, which the renderer reads from when it creates the buffer.
+GridBufferGeometry.update_attribute = function(gl_state, geometry, key, raster) {
+    var attribute = geometry.attributes[key];
+    if (attribute.buffer === void 0) {
+        attribute.array.set(raster);
+        attribute.needsUpdate = true;
+        return;
+    }
+    var gl = gl_state.renderer.getContext();
+    gl.bindBuffer(gl.ARRAY_BUFFER, attribute.buffer);
+    gl.bufferSubData(gl.ARRAY_BUFFER, 0, raster);
+}
+GridBufferGeometry.update_vector_attribute = function(gl_state, geometry, key, raster) {
+    GridBufferGeometry.update_attribute(gl_state, geometry, key+'_x', raster.x);
+    GridBufferGeometry.update_attribute(gl_state, geometry, key+'_y', raster.y);
+    GridBufferGeometry.update_attribute(gl_state, geometry, key+'_z', raster.z);
+}
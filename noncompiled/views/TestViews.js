@@ -28,7 +28,7 @@ testViews.id_rotated     = new ScalarWorldView(
         new HeatmapRasterView( {scaling: true}),
         function (crust) {
             var ids = Float32Raster(crust.grid);
-            Float32Raster.FromUint16Raster(crust.grid.vertex_ids, ids);
+            Float32Raster.FromIdRaster(crust.grid.vertex_ids, ids);
             var rotationMatrix = Matrix3x3.rotation_about_axis(1,0,0, 0.5);
             var pos = VectorField.mult_matrix(crust.grid.pos, rotationMatrix);
             return Float32Raster.get_nearest_values(ids, pos);
@@ -51,7 +51,7 @@ testViews.eliptic_ids = new ScalarWorldView(
         new HeatmapRasterView( {scaling: true}),
         function (crust) {
             var ids = Float32Raster(crust.grid);
-            Float32Raster.FromUint16Raster(crust.grid.vertex_ids, ids);
+            Float32Raster.FromIdRaster(crust.grid.vertex_ids, ids);
             var pos = OrbitalMechanics.get_ecliptic_coordinates_raster_from_equatorial_coordinates_raster(
                 crust.grid.pos,
                 23.5/180*Math.PI,
@@ -10,7 +10,17 @@ function ThreeJsState() {
     this.renderer.setClearColor( 0x000000, 1 );
     this.renderer.setSize( innerWidth, innerHeight );
 
-    this.composer = new THREE.EffectComposer(this.renderer);
+    // if supported, passes render to float targets, so views can store linear intensities between passes,
+    //   see ToneMappingPass.js
+    this.is_hdr = ToneMappingPass.is_supported(this.renderer);
+    this.composer = new THREE.EffectComposer(this.renderer, !this.is_hdr? void 0 :
+        new THREE.WebGLRenderTarget( innerWidth, innerHeight, {
+            minFilter: THREE.LinearFilter,
+            magFilter: THREE.LinearFilter,
+            format: THREE.RGBAFormat,
+            type: THREE.FloatType,
+            stencilBuffer: false,
+        }));
 
     // put a camera in the scene
 
@@ -40,6 +50,10 @@ function ThreeJsState() {
     }, 'input_texture');
     this.shaderpass.renderToScreen = true;
     this.composer.passes.push(this.shaderpass);
+
+    // "scene_version" changes whenever anything that's drawn by passes before tone mapping could have changed,
+    //   so frames where only exposure changed can tone map the last frame again, see ToneMappingPass.js
+    this.scene_version = 0;
 }
 
 function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
@@ -56,15 +70,119 @@ function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
         snow_visibility: 1.0,
         shadow_visibility: 1.0,
         insolation_max: 0,
+        // the atmosphere is raymarched at 1/N resolution along each axis, see ReducedResolutionAtmospherePass.js
+        atmosphere_resolution_divisor: 1,
+        // exposure for views that tone map, in Watts/m^2, see ToneMappingPass.js
+        exposure_intensity: 150.,
+        auto_exposure: false,
+        // evaluate black body emission exactly instead of using a lookup table, to validate the table
+        exact_emission: false,
+        // light the realistic view once per vertex instead of once per pixel, for map projections of large grids
+        vertex_lighting: false,
     };
 
+    // "options_version" changes whenever options that require an update of the scene change, see "uniform"
+    var options_version = 0;
+    // the state of the last update, which is skipped if nothing has changed since, see "update"
+    var last_update = { focus: void 0, elapsed_time: void 0, speed: void 0, options_version: -1 };
+    // "get_camera_tracker" returns a function that indicates whether the camera or canvas changed since it was last called.
+    // "render" and "update" each have their own, since "render" runs on every frame and would otherwise absorb
+    //   every change before "update" saw it, leaving the scene built for a camera it no longer has, e.g. after a resize
+    function get_camera_tracker() {
+        var last_camera = { view: new THREE.Matrix4(), projection: new THREE.Matrix4(), width: 0, height: 0 };
+        return function() {
+            var camera = gl_state.camera;
+            var canvas = gl_state.renderer.domElement;
+            camera.updateMatrixWorld();
+            var is_changed = 
+                canvas.width !== last_camera.width || canvas.height !== last_camera.height ||
+                camera.matrixWorld.elements.some((x, i) => x !== last_camera.view.elements[i]) ||
+                camera.projectionMatrix.elements.some((x, i) => x !== last_camera.projection.elements[i]);
+            if (is_changed) {
+                last_camera.view.copy(camera.matrixWorld);
+                last_camera.projection.copy(camera.projectionMatrix);
+                last_camera.width  = canvas.width;
+                last_camera.height = canvas.height;
+            }
+            return is_changed;
+        }
+    }
+    // the camera of the last frame, which is drawn again if it changes, see "render"
+    var is_camera_changed_since_render = get_camera_tracker();
+    // the camera of the last update, which the scene is built for, see "update"
+    var is_camera_changed_since_update = get_camera_tracker();
+    // "get_tone_mapping_pass" returns the ToneMappingPass that ends the composer, if there is one
+    function get_tone_mapping_pass() {
+        var passes = gl_state.composer.passes;
+        var pass = passes[passes.length-1];
+        return pass instanceof ToneMappingPass? pass : void 0;
+    }
+
+    // passes of the composer are timed by the Profiler, if enabled, and named by their fragment shaders, see "get_pass_name"
+    var gpu_timer = void 0;
+    function instrument_passes() {
+        gpu_timer = gpu_timer || new Profiler.GpuTimer(gl_state.renderer.context);
+        for (var pass of gl_state.composer.passes) {
+            var name = 'gpu.' + get_pass_name(pass);
+            if (pass.profiled_name === void 0) {
+                Profiler.instrument_pass(pass, name, gpu_timer);
+            }
+            pass.profiled_name = name;
+        }
+        gpu_timer.poll();
+    }
+    function get_pass_name(pass) {
+        if (pass === gl_state.renderpass) {
+            return 'scene';
+        }
+        var fragment_shader = pass.material !== void 0? pass.material.fragmentShader : void 0;
+        var name = Object.keys(fragmentShaders).find(name => fragmentShaders[name] === fragment_shader);
+        return name || 'pass';
+    }
+    // "get_gpu_timer" returns the Profiler.GpuTimer that times passes, if any have been
+    this.get_gpu_timer = function() {
+        return gpu_timer;
+    }
+
+    // "render" draws a frame, however if the scene and camera are unchanged since the last frame,
+    //   and the last frame was tone mapped, only tone mapping is run again, e.g. so exposure can adapt or change
     this.render = function() {
         gl_state.controls.update();
-        gl_state.composer.render();
+        if (Profiler.is_enabled) {
+            instrument_passes();
+        }
+        if (is_camera_changed_since_render()) {
+            gl_state.scene_version++;
+        }
+        var tone_mapping_pass = get_tone_mapping_pass();
+        if (tone_mapping_pass !== void 0 && tone_mapping_pass.scene_version === gl_state.scene_version) {
+            tone_mapping_pass.render_again(gl_state.renderer);
+        } else {
+            gl_state.composer.render();
+            if (tone_mapping_pass !== void 0) {
+                tone_mapping_pass.scene_version = gl_state.scene_version;
+            }
+        }
     };
 
     this.update = function(sim){
 
+        // nothing is drawn differently if the simulation, options, and camera have not changed since the last update, e.g. while paused,
+        //   so the scene is left as it is, and frames only run tone mapping, see "render"
+        // NOTE: "is_camera_changed_since_update" is called first so that it always tracks the latest camera
+        if (!is_camera_changed_since_update() &&
+            sim.focus === last_update.focus && 
+            sim.elapsed_time === last_update.elapsed_time && 
+            sim.speed === last_update.speed && 
+            options_version === last_update.options_version) {
+            return;
+        }
+        last_update.focus           = sim.focus;
+        last_update.elapsed_time    = sim.elapsed_time;
+        last_update.speed           = sim.speed;
+        last_update.options_version = options_version;
+        gl_state.scene_version++;
+
         var universe = sim.model();
         var body = sim.focus;
         var stars = universe.bodies.filter(body => body instanceof Star);
@@ -115,9 +233,13 @@ function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
                 }, options)
             );
     }
+    Profiler.instrument(this, 'view', ['update'], 'view');
+
     this.print = function(value, options){
         options = options || {};
+        gl_state.scene_version++;
         if (value.x instanceof Float32Array || 
+            value.x instanceof Uint32Array  ||
             value.x instanceof Uint16Array  ||
             value.x instanceof Uint8Array ) { // scalar raster
             scalarProjectionView.updateScene(gl_state, value, 
@@ -159,6 +281,7 @@ function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
             scalarView.removeFromScene(gl_state);
         }
         scalarView = value;
+        options_version++;
     };
 
     this.setVectorView = function(value) {
@@ -169,6 +292,7 @@ function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
             vectorView.removeFromScene(gl_state);
         }
         vectorView = value;
+        options_version++;
     };
 
     this.setProjectionView = function(value){
@@ -182,10 +306,24 @@ function View(innerWidth, innerHeight, scalarView, vectorView, projectionView) {
         projectionView = value;
         scalarProjectionView = value.clone();
         vectorProjectionView = value.clone();
+        options_version++;
     }
 
     this.uniform = function(key, value){
         options[key] = value;
+        // exposure is set on the tone mapping pass directly if there is one, since nothing else depends on it
+        var tone_mapping_pass = get_tone_mapping_pass();
+        if (tone_mapping_pass !== void 0 && (key === 'exposure_intensity' || key === 'auto_exposure')) {
+            tone_mapping_pass[key] = value;
+        } else {
+            options_version++;
+        }
+    }
+
+    // "invalidate" rebuilds the scene on the next update, for edits that change the world in place,
+    //   which the update would otherwise skip, since neither the focus nor the elapsed time changes, e.g. "loadImage" in index.html
+    this.invalidate = function() {
+        options_version++;
     }
 
     this.toggleControls = function() {
@@ -29,14 +29,9 @@ function ColorscaleRasterView(options) {
 
     function create_mesh(raster, options) {
         var grid = raster.grid;
-        var faces = grid.faces;
-        var geometry = THREE.BufferGeometryUtils.fromGeometry({
-            faces: grid.faces, 
-            vertices: grid.vertices, 
-            faceVertexUvs: [[]], // HACK: necessary for use with BufferGeometryUtils.fromGeometry
-        });
-        geometry.addAttribute('displacement', Float32Array, faces.length*3, 1);
-        geometry.addAttribute('scalar', Float32Array, faces.length*3, 1);
+        var geometry = GridBufferGeometry.create(grid);
+        GridBufferGeometry.add_attribute(geometry, 'displacement');
+        GridBufferGeometry.add_attribute(geometry, 'scalar');
 
         var material = new THREE.ShaderMaterial({
             attributes: {
@@ -73,9 +68,8 @@ function ColorscaleRasterView(options) {
             mesh.material.uniforms[key].needsUpdate = true;
         }
     }
-    function update_attribute(key, raster) {
-        Float32Raster.get_ids(raster, raster.grid.buffer_array_to_cell, mesh.geometry.attributes[key].array); 
-        mesh.geometry.attributes[key].needsUpdate = true;
+    function update_attribute(gl_state, key, raster) {
+        GridBufferGeometry.update_attribute(gl_state, mesh.geometry, key, raster);
     }
 
     this.updateScene = function(gl_state, raster, options) {
@@ -91,6 +85,9 @@ function ColorscaleRasterView(options) {
         if (raster instanceof Uint16Array) {
             raster = Float32Raster.FromUint16Raster(raster);
         }
+        if (raster instanceof Uint32Array) {
+            raster = Float32Raster.FromUint32Raster(raster);
+        }
 
         if (scaled_raster === void 0 || scaled_raster.grid !== raster.grid) {
             scaled_raster = Float32Raster(raster.grid);
@@ -113,7 +110,7 @@ function ColorscaleRasterView(options) {
             this.mesh = mesh; 
         } 
 
-        update_attribute('scalar',             scaled_raster);
+        update_attribute(gl_state, 'scalar',             scaled_raster);
                 
         update_uniform('world_radius',        options.world_radius || Units.EARTH_RADIUS);
         update_uniform('ocean_visibility',        options.ocean_visibility);
@@ -122,7 +119,7 @@ function ColorscaleRasterView(options) {
         update_vertex_shader(options.vertexShader);
 
         if (options.displacement !== void 0) {
-            update_attribute('displacement', options.displacement);
+            update_attribute(gl_state, 'displacement', options.displacement);
         }
         if (options.displacement !== void 0) {
             update_uniform('sealevel',         options.sealevel);
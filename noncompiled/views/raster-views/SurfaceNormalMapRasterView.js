@@ -15,19 +15,16 @@ function SurfaceNormalMapRasterView(options) {
 
     function create_mesh(raster, options) {
         var grid = raster.grid;
-        var faces = grid.faces;
-        var geometry = THREE.BufferGeometryUtils.fromGeometry({
-            faces: grid.faces, 
-            vertices: grid.vertices, 
-            faceVertexUvs: [[]], // HACK: necessary for use with BufferGeometryUtils.fromGeometry
-        });
-        geometry.addAttribute('displacement', Float32Array, faces.length*3, 1);
-        geometry.addAttribute('gradient',     Float32Array, faces.length*3*3, 1);
+        var geometry = GridBufferGeometry.create(grid);
+        GridBufferGeometry.add_attribute(geometry, 'displacement');
+        GridBufferGeometry.add_vector_attribute(geometry, 'gradient');
 
         var material = new THREE.ShaderMaterial({
             attributes: {
               displacement: { type: 'f', value: null },
-              gradient:     { type: 'v3',value: null },
+              gradient_x:   { type: 'f', value: null },
+              gradient_y:   { type: 'f', value: null },
+              gradient_z:   { type: 'f', value: null },
             },
             uniforms: {
               reference_distance: { type: 'f', value: options.reference_distance || Units.EARTH_RADIUS },
@@ -56,22 +53,11 @@ function SurfaceNormalMapRasterView(options) {
             mesh.material.uniforms[key].needsUpdate = true;
         }
     }
-    function update_scalar_attribute(key, raster) {
-        Float32Raster.get_ids(raster, raster.grid.buffer_array_to_cell, mesh.geometry.attributes[key].array); 
-        mesh.geometry.attributes[key].needsUpdate = true;
+    function update_scalar_attribute(gl_state, key, raster) {
+        GridBufferGeometry.update_attribute(gl_state, mesh.geometry, key, raster);
     }
-    function update_vector_attribute(key, raster) {
-        var x = raster.x;
-        var y = raster.y;
-        var z = raster.z;
-        var array = mesh.geometry.attributes[key].array;
-        var buffer_array_to_cell = raster.grid.buffer_array_to_cell;
-        for (var i = 0, li = buffer_array_to_cell.length; i < li; i++) {
-            array[i+li*0] = x[buffer_array_to_cell[i]];
-            array[i+li*1] = y[buffer_array_to_cell[i]];
-            array[i+li*2] = z[buffer_array_to_cell[i]];
-        }
-        mesh.geometry.attributes[key].needsUpdate = true;
+    function update_vector_attribute(gl_state, key, raster) {
+        GridBufferGeometry.update_vector_attribute(gl_state, mesh.geometry, key, raster);
     }
 
     this.updateScene = function(gl_state, raster, options) {
@@ -87,6 +73,9 @@ function SurfaceNormalMapRasterView(options) {
         if (raster instanceof Uint16Array) {
             raster = Float32Raster.FromUint16Raster(raster);
         }
+        if (raster instanceof Uint32Array) {
+            raster = Float32Raster.FromUint32Raster(raster);
+        }
 
         if (mesh === void 0) {
             mesh = create_mesh(raster, options);
@@ -103,8 +92,8 @@ function SurfaceNormalMapRasterView(options) {
         var gradient = ScalarField.gradient(raster);
         VectorField.mult_scalar(gradient, exaggeration_factor/world_radius, gradient);
 
-        update_vector_attribute('gradient',      gradient);
-        update_scalar_attribute('displacement',  raster);
+        update_vector_attribute(gl_state, 'gradient',      gradient);
+        update_scalar_attribute(gl_state, 'displacement',  raster);
         update_uniform('world_radius',        options.world_radius || Units.EARTH_RADIUS);
         update_uniform('ocean_visibility',        options.ocean_visibility);
         update_uniform('map_projection_offset',                options.map_projection_offset);
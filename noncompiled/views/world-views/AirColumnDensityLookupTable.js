@@ -0,0 +1,58 @@
+'use strict';
+
+// AirColumnDensityLookupTable renders the lookup table that's described in "raymarching.glsl.c" to a float render target.
+// It is sampled by shaders that were compiled with "AIR_COLUMN_DENSITY_LUT",
+//   such as fragmentShaders.atmosphere_using_luts.
+// The table only depends on world radius and atmosphere scale height, so it is only rendered when either changes.
+function AirColumnDensityLookupTable() {
+    // NOTE: these must match AIR_COLUMN_DENSITY_LUT_WIDTH and AIR_COLUMN_DENSITY_LUT_HEIGHT in "raymarching.glsl.c"
+    const WIDTH  = 256;
+    const HEIGHT = 64;
+
+    var world_radius = void 0;
+    var atmosphere_scale_height = void 0;
+
+    var material = new THREE.ShaderMaterial({
+        uniforms: {
+            world_radius:            { type: "f", value: Units.EARTH_RADIUS },
+            atmosphere_scale_height: { type: "f", value: 0. },
+        },
+        vertexShader:   vertexShaders.passthrough,
+        fragmentShader: fragmentShaders.air_column_density_lut,
+    });
+    var camera = new THREE.OrthographicCamera( -1, 1, 1, -1, 0, 1 );
+    var scene  = new THREE.Scene();
+    scene.add(new THREE.Mesh( new THREE.PlaneGeometry( 2, 2 ), material ));
+
+    this.texture = new THREE.WebGLRenderTarget( WIDTH, HEIGHT, {
+        minFilter: THREE.LinearFilter,
+        magFilter: THREE.LinearFilter,
+        format: THREE.RGBAFormat,
+        type: THREE.FloatType,
+        depthBuffer: false,
+        stencilBuffer: false,
+    });
+    this.texture.generateMipmaps = false;
+
+    this.update = function(renderer, radius, scale_height) {
+        if (world_radius === radius && atmosphere_scale_height === scale_height) {
+            return;
+        }
+        world_radius = radius;
+        atmosphere_scale_height = scale_height;
+        material.uniforms.world_radius.value = radius;
+        material.uniforms.atmosphere_scale_height.value = scale_height;
+        renderer.render(scene, camera, this.texture, true);
+    };
+
+    this.dispose = function() {
+        this.texture.dispose();
+        material.dispose();
+    };
+}
+// "is_supported" indicates whether a renderer can render to and linearly interpolate float textures,
+//   which the lookup table requires. Views should fall back to shaders without the table if it returns false.
+AirColumnDensityLookupTable.is_supported = function(renderer) {
+    var gl = renderer.context;
+    return !!(gl.getExtension('OES_texture_float') && gl.getExtension('OES_texture_float_linear'));
+};
@@ -0,0 +1,43 @@
+'use strict';
+
+// BlackbodyLookupTable renders the lookup table for black body emission that's described in "emission.glsl.c" to a float render target.
+// It is sampled by shaders that were compiled with "BLACKBODY_LUT",
+//   such as fragmentShaders.realistic_using_luts.
+// The table does not depend on any property of the world, so it is only rendered once.
+function BlackbodyLookupTable() {
+    // NOTE: this must match BLACKBODY_LUT_WIDTH in "emission.glsl.c"
+    const WIDTH = 256;
+
+    var material = new THREE.ShaderMaterial({
+        uniforms:       {},
+        vertexShader:   vertexShaders.passthrough,
+        fragmentShader: fragmentShaders.blackbody_lut,
+    });
+    var camera = new THREE.OrthographicCamera( -1, 1, 1, -1, 0, 1 );
+    var scene  = new THREE.Scene();
+    scene.add(new THREE.Mesh( new THREE.PlaneGeometry( 2, 2 ), material ));
+    var is_rendered = false;
+
+    this.texture = new THREE.WebGLRenderTarget( WIDTH, 1, {
+        minFilter: THREE.LinearFilter,
+        magFilter: THREE.LinearFilter,
+        format: THREE.RGBAFormat,
+        type: THREE.FloatType,
+        depthBuffer: false,
+        stencilBuffer: false,
+    });
+    this.texture.generateMipmaps = false;
+
+    this.update = function(renderer) {
+        if (is_rendered) {
+            return;
+        }
+        renderer.render(scene, camera, this.texture, true);
+        is_rendered = true;
+    };
+
+    this.dispose = function() {
+        this.texture.dispose();
+        material.dispose();
+    };
+}
@@ -0,0 +1,62 @@
+'use strict';
+
+// MultipleScatteringLookupTable renders the lookup table for multiple scattering 
+//   that's described in "raymarching.glsl.c" to a float render target.
+// It is sampled by shaders that were compiled with "MULTIPLE_SCATTERING_LUT",
+//   such as fragmentShaders.atmosphere_using_luts.
+// Building the table is costly, so it is only rendered when properties of the world or atmosphere change.
+function MultipleScatteringLookupTable() {
+    // NOTE: these must match MULTIPLE_SCATTERING_LUT_WIDTH and MULTIPLE_SCATTERING_LUT_HEIGHT in "raymarching.glsl.c"
+    const WIDTH  = 32;
+    const HEIGHT = 32;
+
+    var uniforms = {
+        world_radius:                                 { type: "f",  value: Units.EARTH_RADIUS },
+        atmosphere_scale_height:                      { type: "f",  value: 0. },
+        surface_air_rayleigh_scattering_coefficients: { type: "v3", value: new THREE.Vector3() },
+        surface_air_mie_scattering_coefficients:      { type: "v3", value: new THREE.Vector3() },
+        surface_air_absorption_coefficients:          { type: "v3", value: new THREE.Vector3() },
+    };
+    var material = new THREE.ShaderMaterial({
+        uniforms:       uniforms,
+        vertexShader:   vertexShaders.passthrough,
+        fragmentShader: fragmentShaders.multiple_scattering_lut,
+    });
+    var camera = new THREE.OrthographicCamera( -1, 1, 1, -1, 0, 1 );
+    var scene  = new THREE.Scene();
+    scene.add(new THREE.Mesh( new THREE.PlaneGeometry( 2, 2 ), material ));
+    var is_rendered = false;
+
+    this.texture = new THREE.WebGLRenderTarget( WIDTH, HEIGHT, {
+        minFilter: THREE.LinearFilter,
+        magFilter: THREE.LinearFilter,
+        format: THREE.RGBAFormat,
+        type: THREE.FloatType,
+        depthBuffer: false,
+        stencilBuffer: false,
+    });
+    this.texture.generateMipmaps = false;
+
+    this.update = function(renderer, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs) {
+        if (is_rendered &&
+            uniforms.world_radius.value === world_radius && 
+            uniforms.atmosphere_scale_height.value === atmosphere_scale_height &&
+            uniforms.surface_air_rayleigh_scattering_coefficients.value.equals(beta_ray) &&
+            uniforms.surface_air_mie_scattering_coefficients.value.equals(beta_mie) &&
+            uniforms.surface_air_absorption_coefficients.value.equals(beta_abs)) {
+            return;
+        }
+        uniforms.world_radius.value = world_radius;
+        uniforms.atmosphere_scale_height.value = atmosphere_scale_height;
+        uniforms.surface_air_rayleigh_scattering_coefficients.value.copy(beta_ray);
+        uniforms.surface_air_mie_scattering_coefficients.value.copy(beta_mie);
+        uniforms.surface_air_absorption_coefficients.value.copy(beta_abs);
+        renderer.render(scene, camera, this.texture, true);
+        is_rendered = true;
+    };
+
+    this.dispose = function() {
+        this.texture.dispose();
+        material.dispose();
+    };
+}
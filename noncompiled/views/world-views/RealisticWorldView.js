@@ -5,8 +5,45 @@ function RealisticWorldView(shader_return_value) {
         return new RealisticWorldView(shader_return_value);
     }
 
-    var fragmentShader = fragmentShaders.realistic;
-        
+    var fragmentShader = void 0;
+    // if "vertex_lighting" is set, map projections light the surface once per vertex, 
+    //   see get_realistic_vertex_shader() in "precompiled/Shaders.js"
+    // it returns undefined if the projection can't, in which case the surface is lit once per pixel
+    function get_vertex_lit_shader(options) {
+        return options.vertex_lighting? 
+            get_realistic_vertex_shader(
+                options.vertexShader,
+                options.light_directions.length,
+                options.ocean_visibility > 0,
+                options.specular_visibility * options.shadow_visibility > 0
+            ) : void 0;
+    }
+    function get_vertex_shader(options) {
+        return get_vertex_lit_shader(options) || options.vertexShader;
+    }
+    // "realistic.glsl.c" is specialized for the view's settings, see get_realistic_fragment_shader() in "precompiled/Shaders.js"
+    function get_fragment_shader(options) {
+        if (get_vertex_lit_shader(options) !== void 0) {
+            return is_hdr? fragmentShaders.realistic_vertex_lit_using_luts : fragmentShaders.realistic_vertex_lit;
+        }
+        return get_realistic_fragment_shader(
+            options.light_directions.length,
+            options.ocean_visibility > 0,
+            options.specular_visibility * options.shadow_visibility > 0,
+            is_hdr,
+            options.exact_emission
+        );
+    }
+    // lookup tables are only created if the renderer supports them, see AirColumnDensityLookupTable.js
+    var air_column_density_lut = void 0;
+    var multiple_scattering_lut = void 0;
+    var blackbody_lut = void 0;
+    // the atmosphere can optionally be raymarched at reduced resolution, see ReducedResolutionAtmospherePass.js
+    var is_reduced_resolution_supported = void 0;
+    // if the composer renders to float targets, the atmosphere writes linear intensities and tone mapping is a separate pass
+    var is_hdr = false;
+    var tone_mapping_pass = new ToneMappingPass();
+
     this.chartViews = []; 
     var added = false;
     var mesh = void 0;
@@ -14,10 +51,11 @@ function RealisticWorldView(shader_return_value) {
     var renderpass_uniforms = {};
     var vertexShader = void 0;
     const MAX_LIGHT_COUNT = 9;
-    var shaderpass = new THREE.ShaderPass({
+    var atmosphere_shader = {
         uniforms: {
             shaderpass_visibility:             { type: 'f', value: 0 },
             background_rgb_signal_texture:  { type: "t", value: null },
+            exposure_intensity:             { type: 'f', value: 150. },
             
             projection_matrix_inverse:  { type: "m4",  value: new THREE.Matrix4()         },
             view_matrix_inverse:        { type: "m4",  value: new THREE.Matrix4()         },
@@ -35,31 +73,32 @@ function RealisticWorldView(shader_return_value) {
             surface_air_rayleigh_scattering_coefficients: { type: "v3", value: new THREE.Vector3() },
             surface_air_mie_scattering_coefficients:      { type: "v3", value: new THREE.Vector3() },
             surface_air_absorption_coefficients:          { type: "v3", value: new THREE.Vector3() },
+            air_column_density_lut:                       { type: "t",  value: null },
+            multiple_scattering_lut:                      { type: "t",  value: null },
         },
         vertexShader:   vertexShaders.passthrough,
         fragmentShader: fragmentShaders.atmosphere,
-    }, 'background_rgb_signal_texture');
+    };
+    var shaderpass = new THREE.ShaderPass(atmosphere_shader, 'background_rgb_signal_texture');
     shaderpass.renderToScreen = true;
+    var reduced_resolution_shaderpass = new ReducedResolutionAtmospherePass(atmosphere_shader, 'background_rgb_signal_texture');
 
     function create_mesh(world, options) {
         var grid = world.grid;
-        var faces = grid.faces;
-        var geometry = THREE.BufferGeometryUtils.fromGeometry({
-            faces: grid.faces, 
-            vertices: grid.vertices, 
-            faceVertexUvs: [[]], // HACK: necessary for use with BufferGeometryUtils.fromGeometry
-        });
-        geometry.addAttribute('displacement',   Float32Array, faces.length*3,   1);
-        geometry.addAttribute('gradient',       Float32Array, faces.length*3*3, 1);
-        geometry.addAttribute('snow_coverage',   Float32Array, faces.length*3,   1);
-        geometry.addAttribute('surface_temperature',   Float32Array, faces.length*3,   1);
-        geometry.addAttribute('plant_coverage', Float32Array, faces.length*3,   1);
-        geometry.addAttribute('scalar',         Float32Array, faces.length*3,   1);
+        var geometry = GridBufferGeometry.create(grid);
+        GridBufferGeometry.add_attribute(geometry, 'displacement');
+        GridBufferGeometry.add_vector_attribute(geometry, 'gradient');
+        GridBufferGeometry.add_attribute(geometry, 'snow_coverage');
+        GridBufferGeometry.add_attribute(geometry, 'surface_temperature');
+        GridBufferGeometry.add_attribute(geometry, 'plant_coverage');
+        GridBufferGeometry.add_attribute(geometry, 'scalar');
 
         var material = new THREE.ShaderMaterial({
             attributes: {
               displacement: { type: 'f', value: null },
-              gradient:     { type: 'v3',value: null },
+              gradient_x:   { type: 'f', value: null },
+              gradient_y:   { type: 'f', value: null },
+              gradient_z:   { type: 'f', value: null },
               snow_coverage: { type: 'f', value: null },
               surface_temperature: { type: 'f', value: null },
               plant_coverage: { type: 'f', value: null },
@@ -93,6 +132,10 @@ function RealisticWorldView(shader_return_value) {
               surface_air_rayleigh_scattering_coefficients: { type: "v3", value: new THREE.Vector3() },
               surface_air_mie_scattering_coefficients:      { type: "v3", value: new THREE.Vector3() },
               surface_air_absorption_coefficients:          { type: "v3", value: new THREE.Vector3() },
+              air_column_density_lut:                       { type: "t",  value: null },
+
+              // EMISSION PROPERTIES
+              blackbody_lut:                                { type: "t",  value: null },
 
               // SEA PROPERTIES
               sealevel:                                     { type: 'f', value: 0 },
@@ -102,7 +145,7 @@ function RealisticWorldView(shader_return_value) {
 
             },
             blending: THREE.NoBlending,
-            vertexShader: options.vertexShader,
+            vertexShader: vertexShader,
             fragmentShader: fragmentShader
         });
         return new THREE.Mesh( geometry, material);
@@ -114,6 +157,13 @@ function RealisticWorldView(shader_return_value) {
             mesh.material.needsUpdate = true; 
         }
     }
+    function update_renderpass_fragment_shader(value) {
+        if (fragmentShader !== value) {
+            fragmentShader = value;
+            mesh.material.fragmentShader = value; 
+            mesh.material.needsUpdate = true; 
+        }
+    }
     function update_renderpass_uniform(key, value) {
         if (renderpass_uniforms[key] !== value) {
             renderpass_uniforms[key] = value;
@@ -126,39 +176,66 @@ function RealisticWorldView(shader_return_value) {
             shaderpass_uniforms[key] = value;
             shaderpass.uniforms[key].value = value;
             shaderpass.uniforms[key].needsUpdate = true;
+            reduced_resolution_shaderpass.uniforms[key].value = value;
+            reduced_resolution_shaderpass.uniforms[key].needsUpdate = true;
         }
     }
-    function update_renderpass_attribute(key, raster) {
-        Float32Raster.get_ids(raster, raster.grid.buffer_array_to_cell, mesh.geometry.attributes[key].array); 
-        mesh.geometry.attributes[key].needsUpdate = true;
-    }
-    function update_renderpass_vector_attribute(key, raster) {
-        var x = raster.x;
-        var y = raster.y;
-        var z = raster.z;
-        var array = mesh.geometry.attributes[key].array;
-        var buffer_array_to_cell = raster.grid.buffer_array_to_cell;
-        for (var i = 0, li = buffer_array_to_cell.length; i < li; i++) {
-            array[i+li*0] = x[buffer_array_to_cell[i]];
-            array[i+li*1] = y[buffer_array_to_cell[i]];
-            array[i+li*2] = z[buffer_array_to_cell[i]];
+    function update_postprocessing_passes(gl_state, passes) {
+        // NOTE: the first pass of the composer is always gl_state.renderpass, see View.js
+        var composer_passes = gl_state.composer.passes;
+        var is_changed = composer_passes.length !== passes.length + 1 || 
+            passes.some((pass, i) => composer_passes[i+1] !== pass);
+        if (is_changed) {
+            for (var pass of passes) {
+                pass.renderToScreen = pass === passes[passes.length-1];
+            }
+            composer_passes.splice(1, composer_passes.length-1, ...passes);
         }
-        mesh.geometry.attributes[key].needsUpdate = true;
+    }
+    function update_renderpass_attribute(gl_state, key, raster) {
+        GridBufferGeometry.update_attribute(gl_state, mesh.geometry, key, raster);
+    }
+    function update_renderpass_vector_attribute(gl_state, key, raster) {
+        GridBufferGeometry.update_vector_attribute(gl_state, mesh.geometry, key, raster);
     }
     this.updateScene = function(gl_state, world, options) {
 
         if (!added) {
+            // NOTE: the "_using_luts" shaders also write linear intensities, see precompiled/Shaders.js
+            if (air_column_density_lut === void 0 && gl_state.is_hdr && AirColumnDensityLookupTable.is_supported(gl_state.renderer)) {
+                air_column_density_lut  = new AirColumnDensityLookupTable();
+                multiple_scattering_lut = new MultipleScatteringLookupTable();
+                blackbody_lut           = new BlackbodyLookupTable();
+                is_hdr = true;
+                shaderpass.material.fragmentShader = fragmentShaders.atmosphere_using_luts;
+                shaderpass.material.needsUpdate = true;
+                reduced_resolution_shaderpass.material.fragmentShader = fragmentShaders.atmosphere_scattering_using_luts;
+                reduced_resolution_shaderpass.material.needsUpdate = true;
+                reduced_resolution_shaderpass.upsampling_material.fragmentShader = fragmentShaders.atmosphere_upsampling_using_luts;
+                reduced_resolution_shaderpass.upsampling_material.needsUpdate = true;
+            }
+            if (is_reduced_resolution_supported === void 0) {
+                is_reduced_resolution_supported = ReducedResolutionAtmospherePass.is_supported(gl_state.renderer);
+            }
+            vertexShader = get_vertex_shader(options);
+            fragmentShader = get_fragment_shader(options);
             mesh = create_mesh(world, options);
             renderpass_uniforms = Object.assign({}, options);
-            vertexShader = options.vertexShader;
             gl_state.scene.add(mesh);
 
-            gl_state.composer.passes.pop();
-            gl_state.composer.passes.push(shaderpass);
-
             added = true;
         } 
 
+        // swap in the reduced resolution atmosphere if it's requested and supported
+        var atmosphere_pass = 
+            options.atmosphere_resolution_divisor > 1 && is_reduced_resolution_supported? 
+                reduced_resolution_shaderpass : shaderpass;
+        reduced_resolution_shaderpass.resolution_divisor = options.atmosphere_resolution_divisor;
+        update_postprocessing_passes(gl_state, is_hdr? [atmosphere_pass, tone_mapping_pass] : [atmosphere_pass]);
+
+        tone_mapping_pass.exposure_intensity = options.exposure_intensity;
+        tone_mapping_pass.auto_exposure      = options.auto_exposure;
+
         var projection_matrix_inverse = new THREE.Matrix4().getInverse(gl_state.camera.projectionMatrix);
 
 
@@ -177,13 +254,30 @@ function RealisticWorldView(shader_return_value) {
         // NOTE: NOT USED, intended to eventually represent absorption
         var surface_air_absorber_density = 0;
 
-        var gradient = ScalarField.gradient(world.lithosphere.surface_height.value());
-        VectorField.div_scalar(gradient, world.radius, gradient);
+        var surface_air_rayleigh_scattering_coefficients = new THREE.Vector3(5.20e-6, 1.21e-5, 2.96e-5);
+        var surface_air_mie_scattering_coefficients      = new THREE.Vector3(2.1e-8,  2.1e-8,  2.1e-8 );
+        var surface_air_absorption_coefficients          = new THREE.Vector3(0);
+
+        if (air_column_density_lut !== void 0) {
+            air_column_density_lut.update(gl_state.renderer, world.radius, atmosphere_scale_height);
+        }
+        if (blackbody_lut !== void 0) {
+            blackbody_lut.update(gl_state.renderer);
+        }
+        if (multiple_scattering_lut !== void 0) {
+            multiple_scattering_lut.update(gl_state.renderer, world.radius, atmosphere_scale_height,
+                surface_air_rayleigh_scattering_coefficients, 
+                surface_air_mie_scattering_coefficients, 
+                surface_air_absorption_coefficients);
+        }
+
+        var gradient = world.surface_gradient.value();
 
         // RENDERPASS PROPERTIES -----------------------------------------------
 
         // VIEW PROPERTIES
-        update_renderpass_vertex_shader(options.vertexShader);
+        update_renderpass_vertex_shader(get_vertex_shader(options));
+        update_renderpass_fragment_shader(get_fragment_shader(options));
         update_renderpass_uniform  ('projection_matrix_inverse', projection_matrix_inverse);
         update_renderpass_uniform  ('view_matrix_inverse',       gl_state.camera.matrixWorld);
         update_renderpass_uniform  ('reference_distance',        world.radius);
@@ -204,17 +298,21 @@ function RealisticWorldView(shader_return_value) {
         // WORLD PROPERTIES
         update_renderpass_uniform  ('world_position',            new THREE.Vector3());
         update_renderpass_uniform  ('world_radius',              world.radius);
-        update_renderpass_attribute('displacement',              world.lithosphere.displacement.value());
-        update_renderpass_attribute('surface_temperature',       world.atmosphere.surface_temperature);
-        update_renderpass_attribute('snow_coverage',             world.hydrosphere.snow_coverage.value());
-        update_renderpass_attribute('plant_coverage',            world.biosphere.plant_coverage.value());
-        update_renderpass_vector_attribute('gradient',           gradient);
+        update_renderpass_attribute(gl_state, 'displacement',              world.lithosphere.displacement.value());
+        update_renderpass_attribute(gl_state, 'surface_temperature',       world.atmosphere.surface_temperature);
+        update_renderpass_attribute(gl_state, 'snow_coverage',             world.hydrosphere.snow_coverage.value());
+        update_renderpass_attribute(gl_state, 'plant_coverage',            world.biosphere.plant_coverage.value());
+        update_renderpass_vector_attribute(gl_state, 'gradient',           gradient);
 
         // ATMOSPHERE PROPERTIES
         update_renderpass_uniform  ('atmosphere_scale_height',   atmosphere_scale_height );
-        update_renderpass_uniform  ('surface_air_rayleigh_scattering_coefficients', new THREE.Vector3(5.20e-6, 1.21e-5, 2.96e-5));
-        update_renderpass_uniform  ('surface_air_mie_scattering_coefficients',      new THREE.Vector3(2.1e-8,  2.1e-8,  2.1e-8 ));
-        update_renderpass_uniform  ('surface_air_absorption_coefficients',          new THREE.Vector3(0));
+        update_renderpass_uniform  ('surface_air_rayleigh_scattering_coefficients', surface_air_rayleigh_scattering_coefficients);
+        update_renderpass_uniform  ('surface_air_mie_scattering_coefficients',      surface_air_mie_scattering_coefficients);
+        update_renderpass_uniform  ('surface_air_absorption_coefficients',          surface_air_absorption_coefficients);
+        update_renderpass_uniform  ('air_column_density_lut',                       air_column_density_lut && air_column_density_lut.texture);
+
+        // EMISSION PROPERTIES
+        update_renderpass_uniform  ('blackbody_lut',             blackbody_lut && blackbody_lut.texture);
 
         // SEA PROPERTIES
         update_renderpass_uniform  ('sealevel',             world.hydrosphere.sealevel.value());
@@ -229,6 +327,7 @@ function RealisticWorldView(shader_return_value) {
         update_shaderpass_uniform  ('view_matrix_inverse',       gl_state.camera.matrixWorld);
         update_shaderpass_uniform  ('reference_distance',        world.radius);
         update_shaderpass_uniform  ('shaderpass_visibility',     (options.shaderpass_visibility * options.shadow_visibility) || 0);
+        update_shaderpass_uniform  ('exposure_intensity',        options.exposure_intensity);
 
         // LIGHT PROPERTIES
         update_shaderpass_uniform  ('light_rgb_intensities',     options.light_rgb_intensities   );
@@ -242,9 +341,11 @@ function RealisticWorldView(shader_return_value) {
 
         // ATMOSPHERE PROPERTIES
         update_shaderpass_uniform  ('atmosphere_scale_height',  atmosphere_scale_height  );
-        update_shaderpass_uniform  ('surface_air_rayleigh_scattering_coefficients', new THREE.Vector3(5.20e-6, 1.21e-5, 2.96e-5));
-        update_shaderpass_uniform  ('surface_air_mie_scattering_coefficients',      new THREE.Vector3(2.1e-8,  2.1e-8,  2.1e-8 ));
-        update_shaderpass_uniform  ('surface_air_absorption_coefficients',          new THREE.Vector3(0));
+        update_shaderpass_uniform  ('surface_air_rayleigh_scattering_coefficients', surface_air_rayleigh_scattering_coefficients);
+        update_shaderpass_uniform  ('surface_air_mie_scattering_coefficients',      surface_air_mie_scattering_coefficients);
+        update_shaderpass_uniform  ('surface_air_absorption_coefficients',          surface_air_absorption_coefficients);
+        update_shaderpass_uniform  ('air_column_density_lut',                       air_column_density_lut && air_column_density_lut.texture);
+        update_shaderpass_uniform  ('multiple_scattering_lut',                      multiple_scattering_lut && multiple_scattering_lut.texture);
     };
 
     this.removeFromScene = function(gl_state) {
@@ -255,8 +356,7 @@ function RealisticWorldView(shader_return_value) {
             mesh.material.dispose();
             mesh = void 0;
 
-            gl_state.composer.passes.pop();
-            gl_state.composer.passes.push(gl_state.shaderpass);
+            update_postprocessing_passes(gl_state, [gl_state.shaderpass]);
 
             added = false;
         }
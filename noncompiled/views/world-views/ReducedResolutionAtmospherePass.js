@@ -0,0 +1,100 @@
+'use strict';
+
+// ReducedResolutionAtmospherePass is a drop-in replacement for the THREE.ShaderPass that renders the atmosphere.
+// The atmosphere's raymarch is costly, but the light it scatters varies slowly across the screen,
+//   so it's found at a fraction of screen resolution ("resolution_divisor") using fragmentShaders.atmosphere_scattering,
+//   then upsampled to full resolution using fragmentShaders.atmosphere_upsampling,
+//   which also adds light from the background that's transmitted through the atmosphere.
+// Upsampling uses the silhouette of the world to prevent scattered light from bleeding across the limb.
+// Both shaders share the same uniforms, so it can be updated in the same way as a THREE.ShaderPass.
+// "material" is the material for the reduced resolution pass, it can be swapped for a variant that uses lookup tables.
+function ReducedResolutionAtmospherePass(shader, textureID) {
+    this.textureID = textureID;
+    this.resolution_divisor = 2;
+
+    this.uniforms = THREE.UniformsUtils.clone( shader.uniforms );
+    this.uniforms.scattering_texture      = { type: "t",  value: null };
+    this.uniforms.scattering_texture_size = { type: "v2", value: new THREE.Vector2() };
+
+    this.material = new THREE.ShaderMaterial({
+        uniforms:       this.uniforms,
+        vertexShader:   shader.vertexShader,
+        fragmentShader: fragmentShaders.atmosphere_scattering,
+    });
+    this.upsampling_material = new THREE.ShaderMaterial({
+        uniforms:       this.uniforms,
+        vertexShader:   shader.vertexShader,
+        fragmentShader: fragmentShaders.atmosphere_upsampling,
+    });
+
+    this.renderToScreen = false;
+
+    this.enabled = true;
+    this.needsSwap = true;
+    this.clear = false;
+
+    this.camera = new THREE.OrthographicCamera( -1, 1, 1, -1, 0, 1 );
+    this.scene  = new THREE.Scene();
+
+    this.quad = new THREE.Mesh( new THREE.PlaneGeometry( 2, 2 ), null );
+    this.scene.add( this.quad );
+
+    // the render target is created on first render, and recreated whenever the size of the screen changes
+    this.scattering_target = void 0;
+}
+
+ReducedResolutionAtmospherePass.prototype = {
+
+    render: function ( renderer, writeBuffer, readBuffer, delta ) {
+
+        var width  = Math.max(1, Math.ceil(readBuffer.width  / this.resolution_divisor));
+        var height = Math.max(1, Math.ceil(readBuffer.height / this.resolution_divisor));
+        if (this.scattering_target === void 0 ||
+            this.scattering_target.width  !== width ||
+            this.scattering_target.height !== height) {
+            if (this.scattering_target !== void 0) {
+                this.scattering_target.dispose();
+            }
+            // NOTE: texels are interpolated by the upsampling shader, so nearest filtering is required
+            this.scattering_target = new THREE.WebGLRenderTarget( width, height, {
+                minFilter: THREE.NearestFilter,
+                magFilter: THREE.NearestFilter,
+                format: THREE.RGBAFormat,
+                type: THREE.FloatType,
+                depthBuffer: false,
+                stencilBuffer: false,
+            });
+            this.scattering_target.generateMipmaps = false;
+        }
+
+        this.uniforms.scattering_texture.value = this.scattering_target;
+        this.uniforms.scattering_texture_size.value.set(width, height);
+        this.uniforms[ this.textureID ].value = readBuffer;
+
+        this.quad.material = this.material;
+        renderer.render( this.scene, this.camera, this.scattering_target, true );
+
+        this.quad.material = this.upsampling_material;
+        if ( this.renderToScreen ) {
+            renderer.render( this.scene, this.camera );
+        } else {
+            renderer.render( this.scene, this.camera, writeBuffer, this.clear );
+        }
+
+    },
+
+    dispose: function() {
+        if (this.scattering_target !== void 0) {
+            this.scattering_target.dispose();
+        }
+        this.material.dispose();
+        this.upsampling_material.dispose();
+    },
+
+};
+// "is_supported" indicates whether a renderer can render to float textures, which the pass requires.
+// Views should fall back to rendering the atmosphere at full resolution if it returns false.
+ReducedResolutionAtmospherePass.is_supported = function(renderer) {
+    var gl = renderer.context;
+    return !!gl.getExtension('OES_texture_float');
+};
@@ -32,6 +32,9 @@ function ScalarWorldView(scalarRasterView, getField) {
         if (raster instanceof Uint16Array) {
             raster = Float32Raster.FromUint16Raster(raster);
         }
+        if (raster instanceof Uint32Array) {
+            raster = Float32Raster.FromUint32Raster(raster);
+        }
         if (!(raster instanceof Float32Array)) { 
             log_once("ScalarWorldView.getField() did not return a TypedArray.");
             this.removeFromScene(gl_state);
@@ -65,6 +68,9 @@ function ScalarWorldView(scalarRasterView, getField) {
         if (raster instanceof Uint16Array) {
             raster = Float32Raster.FromUint16Raster(raster);
         }
+        if (raster instanceof Uint32Array) {
+            raster = Float32Raster.FromUint32Raster(raster);
+        }
         if (!(raster instanceof Float32Array)) { 
             log_once("ScalarWorldView.getField() did not return a TypedArray.");
             this.removeFromScene(gl_state);
@@ -0,0 +1,147 @@
+'use strict';
+
+// ToneMappingPass is the last pass for views whose shaders write linear intensities to float render targets,
+//   such as the "_using_luts" variants of fragmentShaders.atmosphere.
+// It maps intensities to rgb signals using fragmentShaders.tone_mapping, so exposure can be changed
+//   by setting "exposure_intensity" without recompiling or changing the passes before it.
+// If "auto_exposure" is set, exposure is instead found from the average luminance of the input using fragmentShaders.auto_exposure.
+// That exposure is stored in a 1x1 float render target that never leaves the gpu,
+//   and it adapts gradually across frames, so a pair of targets is swapped each frame.
+// The input of the last frame is kept, so if nothing before tone mapping has changed,
+//   the frame can be tone mapped again without re-running the passes before it, see "render_again".
+function ToneMappingPass() {
+    this.exposure_intensity = 150.;     // Watts/m^2
+    this.auto_exposure = false;
+    this.adaptation_rate = 0.05;        // fraction of the difference in exposure that's closed each frame
+    this.min_exposure_intensity = 1.;   // Watts/m^2
+    this.max_exposure_intensity = 1e4;  // Watts/m^2
+
+    this.material = new THREE.ShaderMaterial({
+        uniforms: {
+            input_texture:            { type: "t", value: null },
+            exposure_texture:         { type: "t", value: null },
+            exposure_intensity:       { type: "f", value: this.exposure_intensity },
+            auto_exposure_visibility: { type: "f", value: 0. },
+        },
+        vertexShader:   vertexShaders.passthrough,
+        fragmentShader: fragmentShaders.tone_mapping,
+    });
+    this.auto_exposure_material = new THREE.ShaderMaterial({
+        uniforms: {
+            input_texture:             { type: "t", value: null },
+            previous_exposure_texture: { type: "t", value: null },
+            adaptation_rate:           { type: "f", value: this.adaptation_rate },
+            min_exposure_intensity:    { type: "f", value: this.min_exposure_intensity },
+            max_exposure_intensity:    { type: "f", value: this.max_exposure_intensity },
+        },
+        vertexShader:   vertexShaders.passthrough,
+        fragmentShader: fragmentShaders.auto_exposure,
+    });
+
+    this.renderToScreen = false;
+
+    this.enabled = true;
+    this.needsSwap = true;
+    this.clear = false;
+
+    this.camera = new THREE.OrthographicCamera( -1, 1, 1, -1, 0, 1 );
+    this.scene  = new THREE.Scene();
+
+    this.quad = new THREE.Mesh( new THREE.PlaneGeometry( 2, 2 ), null );
+    this.scene.add( this.quad );
+
+    function create_exposure_target() {
+        var target = new THREE.WebGLRenderTarget( 1, 1, {
+            minFilter: THREE.NearestFilter,
+            magFilter: THREE.NearestFilter,
+            format: THREE.RGBAFormat,
+            type: THREE.FloatType,
+            depthBuffer: false,
+            stencilBuffer: false,
+        });
+        target.generateMipmaps = false;
+        return target;
+    }
+    this.exposure_target          = create_exposure_target();
+    this.previous_exposure_target = create_exposure_target();
+    // NOTE: the first frame of auto exposure must not adapt from a previous frame, see "auto_exposure.glsl.c"
+    this.is_previous_exposure_cleared = false;
+
+    // the render targets of the last frame, and the "scene_version" of ThreeJsState when they were rendered, see View.js
+    this.last_read_buffer  = void 0;
+    this.last_write_buffer = void 0;
+    this.scene_version = void 0;
+}
+
+ToneMappingPass.prototype = {
+
+    render: function ( renderer, writeBuffer, readBuffer, delta ) {
+
+        this.last_read_buffer  = readBuffer;
+        this.last_write_buffer = writeBuffer;
+
+        if ( this.auto_exposure ) {
+
+            if ( !this.is_previous_exposure_cleared ) {
+                renderer.clearTarget( this.previous_exposure_target, true, false, false );
+                this.is_previous_exposure_cleared = true;
+            }
+
+            var uniforms = this.auto_exposure_material.uniforms;
+            uniforms.input_texture.value             = readBuffer;
+            uniforms.previous_exposure_texture.value = this.previous_exposure_target;
+            uniforms.adaptation_rate.value           = this.adaptation_rate;
+            uniforms.min_exposure_intensity.value    = this.min_exposure_intensity;
+            uniforms.max_exposure_intensity.value    = this.max_exposure_intensity;
+
+            this.quad.material = this.auto_exposure_material;
+            renderer.render( this.scene, this.camera, this.exposure_target, true );
+
+            var swap = this.exposure_target;
+            this.exposure_target = this.previous_exposure_target;
+            this.previous_exposure_target = swap;
+
+        } else {
+
+            this.is_previous_exposure_cleared = false;
+
+        }
+
+        var uniforms = this.material.uniforms;
+        uniforms.input_texture.value            = readBuffer;
+        // NOTE: after swapping, the exposure for this frame is in "previous_exposure_target"
+        uniforms.exposure_texture.value         = this.previous_exposure_target;
+        uniforms.exposure_intensity.value       = this.exposure_intensity;
+        uniforms.auto_exposure_visibility.value = this.auto_exposure? 1. : 0.;
+
+        this.quad.material = this.material;
+        if ( this.renderToScreen ) {
+            renderer.render( this.scene, this.camera );
+        } else {
+            renderer.render( this.scene, this.camera, writeBuffer, this.clear );
+        }
+
+    },
+
+    // "render_again" tone maps the input of the last frame, with the current exposure.
+    // The composer must not have rendered other frames since, or the input may have been overwritten.
+    render_again: function ( renderer ) {
+
+        this.render( renderer, this.last_write_buffer, this.last_read_buffer );
+
+    },
+
+    dispose: function() {
+        this.exposure_target.dispose();
+        this.previous_exposure_target.dispose();
+        this.material.dispose();
+        this.auto_exposure_material.dispose();
+    },
+
+};
+// "is_supported" indicates whether a renderer can render to and linearly interpolate float textures,
+//   which are needed so that passes before it can store linear intensities.
+ToneMappingPass.is_supported = function(renderer) {
+    var gl = renderer.context;
+    return !!(gl.getExtension('OES_texture_float') && gl.getExtension('OES_texture_float_linear'));
+};
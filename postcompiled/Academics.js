@@ -128,6 +128,41 @@ function solve_rgb_intensity_of_light_emitted_by_black_body(
              solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
            );
 }
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const BLACKBODY_LUT_WIDTH = 256.;
+const BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+function get_blackbody_lut_texcoord(
+    temperature
+){
+    let u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+function get_blackbody_lut_temperature(
+    texcoord
+){
+    let u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+function get_blackbody_lut_texel(
+    temperature
+){
+    let I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, glm.vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
 // Rayleigh phase function factor [-1, 1]
 function get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
     cos_scatter_angle
@@ -231,6 +266,51 @@ function get_fraction_of_microfacets_with_angle(
 const BIG = 1e20;
 const SMALL = 1e-20;
 const MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+function get_air_column_density_lut_texcoord(
+    h,
+    cos_zenith,
+    r,
+    H
+){
+    let R = r + max(h, 0.);
+    let cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    let u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    let v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return glm.vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+function get_air_column_density_lut_ray(
+    texcoord,
+    r,
+    H
+){
+    let u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    let v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    let h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    let R = r + h;
+    let cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return glm.vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
 // "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
 //   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
 //   taking into account the curvature of the world.
@@ -274,6 +354,12 @@ function approx_air_column_density_ratio_along_2d_ray_for_curved_world(
         return BIG;
     }
     let r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
     let x1 = sqrt(max(r1*r1-z2, 0.));
     let xb = x0+(x1-x0)*b;
     let rb2 = xb*xb + z2;
@@ -310,7 +396,153 @@ function approx_air_column_density_ratio_along_3d_ray_for_curved_world (
     let z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
     return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
 }
-// TODO: multiple scattering events
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+function get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    h, cos_light_zenith,
+    world_radius, atmosphere_scale_height,
+    beta_ray, beta_mie, beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    let r = world_radius;
+    let H = atmosphere_scale_height;
+    let P = glm.vec3(0., r + h, 0.);
+    let L = glm.vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    let beta_sum = beta_ray + beta_mie + beta_abs;
+    let beta_sca = beta_ray + beta_mie;
+    let V; // unit vector for the direction being sampled
+    let xv; // distance from the point to closest approach for the sampled direction
+    let zv2; // squared distance to the center of the world at closest approach
+    let xv_in_air; let xv_out_air;
+    let xv_in_world; let xv_out_world;
+    let dx;
+    let xvi;
+    let Pi; // position for a single iteration of the march
+    let ri;
+    let xl;
+    let T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    let S; // fraction of light that's scattered at a single iteration, per unit distance
+    let E_2nd = glm.vec3(0); // fraction of light that arrives after scattering twice 
+    let f_ms = glm.vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (let i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (let j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            let cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            let sin_theta = sqrt(1. - cos_theta*cos_theta);
+            let phi = 2. * Math.PI * (j + 0.5) / DIRECTION_COUNT;
+            V = glm.vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            let is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (let k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*Math.PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, glm.vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+function get_multiple_scattering_lut_texcoord(
+    h,
+    cos_light_zenith,
+    H
+){
+    let u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    let v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return glm.vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+function get_multiple_scattering_lut_point(
+    texcoord,
+    H
+){
+    let u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    let v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return glm.vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+function get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    view_origin, view_direction,
+    world_position, world_radius,
+    atmosphere_scale_height,
+    beta_ray, beta_mie, beta_abs
+){
+    let P = view_origin - world_position;
+    let V = view_direction;
+    let r = world_radius;
+    let H = atmosphere_scale_height;
+    let xv = dot(-P,V);
+    let zv2 = dot( P,P) - xv * xv;
+    let xv_in_air; let xv_out_air;
+    let xv_in_world; let xv_out_world;
+    let is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    let is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return glm.vec3(1); }
+    let xv_start = max(xv_in_air, 0.);
+    let xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    let sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+function get_fraction_along_raymarch(
+    u,
+    u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
 // TODO: support for light sources from within atmosphere
 function get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     view_origin, view_direction,
@@ -351,7 +583,6 @@ function get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     let I_back = background_rgb_intensity;
     let r = world_radius;
     let H = atmosphere_scale_height;
-    const let STEP_COUNT = 16.;// number of steps taken while marching along the view ray
     let xv = dot(-P,V); // distance from view ray origin to closest approach
     let zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
     let xv_in_air; // distance along the view ray at which the ray enters the atmosphere
@@ -377,8 +608,21 @@ function get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     let beta_gamma;
     let xv_start = max(xv_in_air, 0.);
     let xv_stop = is_obstructed? xv_in_world : xv_out_air;
-    let dx = (xv_stop - xv_start) / STEP_COUNT;
-    let xvi = xv_start - xv + 0.5 * dx;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    let xv_surface = -sqrt(max(r*r - zv2, 0.));
+    let sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    let step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*Math.PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    let u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    let sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    let u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    let u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    let dx; // distance covered by a single iteration of the view ray march
+    let xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
     let L; // unit vector pointing to light source
     let I; // vector indicating intensity of light source for each color channel
     let xl; // distance from light ray origin to closest approach
@@ -388,11 +632,17 @@ function get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     let sigma_v; // columnar density encountered along the view ray,  relative to surface density
     let sigma_l; // columnar density encountered along the light ray, relative to surface density
     let E = glm.vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
-    for (let i = 0.; i < STEP_COUNT; ++i)
+    for (let i = 0.; i < 16.; ++i)
     {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
         r2 = xvi*xvi+zv2;
         h = sqrt(r2) - r;
         sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
         for (let j = 0; j < MAX_LIGHT_COUNT; ++j)
         {
             if (j >= light_count) { break; }
@@ -411,11 +661,12 @@ function get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
                 // outgoing fraction: the fraction of light that scatters away from camera
                 * exp(-beta_sum * (sigma_l + sigma_v));
         }
-        xvi += dx;
     }
     // now calculate the intensity of light that traveled straight in from the background, and add it to the total
-    sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
-    E += I_back * exp(-beta_sum * sigma_v);
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
     return E;
 }
 function get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
@@ -505,6 +756,31 @@ function get_rgb_signal_of_wavelength (
         bump(w, 570e-9, 625e-9, 0.30)
       );
 }
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+function get_luminance_of_rgb_intensity(
+    I
+){
+    return dot(I, glm.vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+function get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    I,
+    exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+function get_exposure_intensity_of_average_luminance(
+    average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
 // "GAMMA" is the constant that's used to map between 
 //   rgb signals sent to a monitor and their actual intensity
 const GAMMA = 2.2;
@@ -195,6 +195,17 @@ Matrix3x3.hadamard_matrix = function(A, B, result) {
   C[8] = A[8]*B[8];
   return C;
 }
+// "get_max_displacement" returns an upper bound on the distance between A*v and B*v for any unit vector v,
+//   which is the Frobenius norm of their difference, since that is never less than its largest singular value
+Matrix3x3.get_max_displacement = function(A, B) {
+  if ((A.length !== 9) || !(A instanceof Float32Array)) { throw "A" + ' is not a 3x3 matrix'; }
+  if ((B.length !== 9) || !(B instanceof Float32Array)) { throw "B" + ' is not a 3x3 matrix'; }
+  var sum = 0;
+  for (var i = 0; i < 9; i++) {
+    sum += (A[i]-B[i])*(A[i]-B[i]);
+  }
+  return Math.sqrt(sum);
+}
 // NOTE:
 // I don't have time to roll my own Matrix4x4 class, so 
 // I'm just borrowing code from the gl-matrix library and adapting it to fit with my own math backend
@@ -1326,6 +1337,17 @@ Vector.normalize = function(x, y, z, result) {
   result.z = z/(magnitude||1);
   return result;
 }
+// "RasterArrayBuffer" returns the buffer that backs a new raster of "grid".
+// If the grid was created with the "is_shared" option, it returns a SharedArrayBuffer, 
+//   so that the raster can be read and written by the workers of a RasterWorkerPool without being copied.
+// Otherwise it returns a plain ArrayBuffer, which is what rasters have always used.
+// Every raster that is created outside a pool passes through here, so this is where allocations are counted, see "RasterPool.is_debugging".
+function RasterArrayBuffer(grid, byte_length) {
+    if (RasterPool.is_debugging) {
+        RasterPool.record_allocation(byte_length);
+    }
+    return grid !== void 0 && grid.is_shared? new SharedArrayBuffer(byte_length) : new ArrayBuffer(byte_length);
+}
 // Float32Raster represents a grid where each cell contains a 32 bit floating point value
 // A Float32Raster is composed of two parts:
 //         The first is a object of type Grid, representing a collection of vertices that are connected by edges
@@ -1342,7 +1364,7 @@ Vector.normalize = function(x, y, z, result) {
 // This design is meant to promote separation of concerns at the expense of encapsulation.
 // I want raster objects to be as bare as possible, functioning more like primitive datatypes.
 function Float32Raster(grid, fill) {
-    var result = new Float32Array(grid.vertices.length);
+    var result = new Float32Array(RasterArrayBuffer(grid, grid.vertices.length * Float32Array.BYTES_PER_ELEMENT));
     result.grid = grid;
     if (fill !== void 0) {
     result.fill(fill);
@@ -1351,19 +1373,19 @@ function Float32Raster(grid, fill) {
 };
 Float32Raster.FromExample = function(raster) {
   var length = 0;
-  if (raster instanceof Float32Array || raster instanceof Uint8Array || raster instanceof Uint16Array) {
+  if (raster instanceof Float32Array || raster instanceof Uint8Array || raster instanceof Uint16Array || raster instanceof Uint32Array) {
     length = raster.length;
   } else if(raster !== void 0 && raster.x instanceof Float32Array) {
     length = raster.x.length;
   } else {
     throw 'must supply a vector or scalar raster'
   }
-  var result = new Float32Array(length);
+  var result = new Float32Array(RasterArrayBuffer(raster.grid, length * Float32Array.BYTES_PER_ELEMENT));
   result.grid = raster.grid;
   return result;
 }
 Float32Raster.OfLength = function(length, grid) {
-  var result = new Float32Array(length);
+  var result = new Float32Array(RasterArrayBuffer(grid, length * Float32Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   return result;
 }
@@ -1396,6 +1418,22 @@ Float32Raster.FromUint16Raster = function(raster, result) {
   }
   return result;
 }
+Float32Raster.FromUint32Raster = function(raster, result) {
+  var result = result || Float32Raster(raster.grid);
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = raster[i];
+  }
+  return result;
+}
+// "FromIdRaster" converts a raster that was created by "Grid.prototype.createIdRaster", 
+//   which may be either a Uint16Raster or a Uint32Raster depending on the size of the grid
+Float32Raster.FromIdRaster = function(raster, result) {
+  return raster instanceof Uint32Array?
+    Float32Raster.FromUint32Raster(raster, result) :
+    Float32Raster.FromUint16Raster(raster, result);
+}
 Float32Raster.copy = function(raster, result) {
   var result = result || Float32Raster(raster.grid);
   if (!(raster instanceof Float32Array)) { throw "raster" + ' is not a ' + "Float32Array"; }
@@ -1639,6 +1677,100 @@ Uint16Raster.set_ids_to_values = function(raster, id_array, value_array) {
   }
   return raster;
 }
+// Uint32Raster represents a grid where each cell contains a 32 bit unsigned integer
+// Uint32Rasters are mostly used to store ids of cells within grids that have too many vertices to be indexed by a Uint16Raster.
+// Use "Grid.prototype.createIdRaster" if you need to store cell ids, since it picks whichever of the two a grid needs.
+// 
+// Like other rasters, operations on Uint32Rasters are spread out as friend functions across several namespaces.
+// Only the operations that are needed to store and look up cell ids are implemented here.
+function Uint32Raster(grid, fill) {
+  var result = new Uint32Array(grid.vertices.length);
+  result.grid = grid;
+  if (fill !== void 0) {
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = fill;
+  }
+  }
+  return result;
+};
+Uint32Raster.OfLength = function(length, grid) {
+  var result = new Uint32Array(length);
+  result.grid = grid;
+  return result;
+}
+Uint32Raster.FromBuffer = function(buffer, grid) {
+  var result = new Uint32Array(buffer, 0, grid.vertices.length);
+  result.grid = grid;
+  return result;
+}
+Uint32Raster.FromUint16Raster = function(raster) {
+  var result = Uint32Raster(raster.grid);
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = raster[i];
+  }
+  return result;
+}
+Uint32Raster.copy = function(raster, result) {
+  var result = result || Uint32Raster(raster.grid);
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; }
+  result.set(raster);
+  return result;
+}
+Uint32Raster.fill = function (raster, value) {
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  raster.fill(value);
+};
+Uint32Raster.get_nearest_value = function(raster, pos) {
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  return raster[raster.grid.getNearestId(pos)];
+}
+Uint32Raster.get_nearest_values = function(value_raster, pos_raster, result) {
+  result = result || Uint32Raster(pos_raster.grid);
+  if (!(value_raster instanceof Uint32Array)) { throw "value_raster" + ' is not a ' + "Uint32Array"; }
+  if ((pos_raster.everything === void 0) || !(pos_raster.everything instanceof Float32Array)) { throw "pos_raster" + ' is not a vector raster'; }
+  if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; }
+  var ids = pos_raster.grid.getNearestIds(pos_raster);
+  for (var i=0, li=ids.length; i<li; ++i) {
+      result[i] = value_raster[ids[i]];
+  }
+  return result;
+}
+Uint32Raster.get_ids = function(value_raster, id_array, result) {
+  result = result || (id_array.grid !== void 0? Uint32Raster(id_array.grid) : Uint32Array(id_array.length));
+  if (!(value_raster instanceof Uint32Array)) { throw "value_raster" + ' is not a ' + "Uint32Array"; }
+  if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; }
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      result[i] = value_raster[id_array[i]];
+  }
+  return result;
+}
+Uint32Raster.get_mask = function(raster, mask) {
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  if (!(mask instanceof Uint8Array)) { throw "mask" + ' is not a ' + "Uint8Array"; }
+  var result = new Uint32Array(Uint8Dataset.sum(mask));
+  for (var i = 0, j = 0, li = mask.length; i < li; i++) {
+    if (mask[i] > 0) {
+      result[j] = raster[i];
+      j++;
+    }
+  }
+  return result;
+}
+Uint32Raster.set_ids_to_value = function(raster, id_array, value) {
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      raster[id_array[i]] = value;
+  }
+  return raster;
+}
+Uint32Raster.set_ids_to_values = function(raster, id_array, value_array) {
+  if (!(raster instanceof Uint32Array)) { throw "raster" + ' is not a ' + "Uint32Array"; }
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      raster[id_array[i]] = value_array[i];
+  }
+  return raster;
+}
 // Uint8Raster represents a grid where each cell contains a 32 bit floating point value
 // A Uint8Raster is composed of two parts:
 //    The first is a object of type Grid, representing a collection of vertices that are connected by edges
@@ -1655,7 +1787,7 @@ Uint16Raster.set_ids_to_values = function(raster, id_array, value_array) {
 // This design is meant to promote separation of concerns at the expense of encapsulation.
 // I want raster objects to be as bare as possible, functioning more like primitive datatypes.
 function Uint8Raster(grid, fill) {
-  var result = new Uint8Array(grid.vertices.length);
+  var result = new Uint8Array(RasterArrayBuffer(grid, grid.vertices.length * Uint8Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   if (fill !== void 0) {
   for (var i=0, li=result.length; i<li; ++i) {
@@ -1665,7 +1797,7 @@ function Uint8Raster(grid, fill) {
   return result;
 };
 Uint8Raster.OfLength = function(length, grid) {
-  var result = new Uint8Array(length);
+  var result = new Uint8Array(RasterArrayBuffer(grid, length * Uint8Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   return result;
 }
@@ -1796,7 +1928,7 @@ function VectorRaster(grid) {
   return VectorRaster.OfLength(grid.vertices.length, grid);
 }
 VectorRaster.OfLength = function(length, grid) {
-  var buffer = new ArrayBuffer(3 * Float32Array.BYTES_PER_ELEMENT * length);
+  var buffer = RasterArrayBuffer(grid, 3 * Float32Array.BYTES_PER_ELEMENT * length);
   return {
     x: new Float32Array(buffer, 0 * Float32Array.BYTES_PER_ELEMENT * length, length),
     y: new Float32Array(buffer, 1 * Float32Array.BYTES_PER_ELEMENT * length, length),
@@ -1930,6 +2062,112 @@ VectorRaster.get_ids = function(value_raster, ids_raster, result) {
   }
   return result;
 }
+// QuantizedRaster represents a grid where each cell contains a value that is stored in 16 bits rather than 32
+// It is a Uint16Array with a "grid", like Uint16Raster, along with the "encoding" of its values:
+//    "fixed16" stores "offset + scale * q" for an integer q in [0, 65535],
+//      so it suits fields of known range, such as coverage fractions in [0,1], where it resolves steps of (max-min)/65535
+//    "float16" stores an IEEE 754 half precision float, with "offset" and "scale" left at 0 and 1,
+//      so it suits fields of unknown range that only need 3 significant figures. It can not represent magnitudes above 65504.
+//
+// QuantizedRasters only store values: raster operations never read them directly.
+// They are decoded into a Float32Raster before use ("decode"), and encoded from one once a result is known ("encode"),
+//   e.g. within a pooled scope, see "RasterPool":
+//
+//   var field = QuantizedRaster.decode(quantized, pool.getFloat32Raster(grid));
+//   ScalarField.diffusion_by_constant(field, 1, field);
+//   QuantizedRaster.encode(field, quantized);
+//
+// Values that fall outside the range of a "fixed16" raster are clamped, and NaN is stored as "offset".
+// NOTE: there is no quantized equivalent of VectorRaster, since vector fields are either normalized or used in full precision
+function QuantizedRaster(grid, encoding, min, max) {
+    var result = new Uint16Array(RasterArrayBuffer(grid, grid.vertices.length * Uint16Array.BYTES_PER_ELEMENT));
+    return QuantizedRaster.describe(result, grid, encoding, min, max);
+};
+QuantizedRaster.Fixed16 = function(grid, min, max) {
+    return QuantizedRaster(grid, 'fixed16', min, max);
+}
+QuantizedRaster.Float16 = function(grid) {
+    return QuantizedRaster(grid, 'float16');
+}
+// "describe" attaches "grid" and an encoding to "array", a Uint16Array, see "QuantizedRaster"
+QuantizedRaster.describe = function(array, grid, encoding, min, max) {
+    if (encoding === 'fixed16') {
+        if (!(max > min)) {
+            throw `a fixed16 raster requires a range where max > min, but min is ${min} and max is ${max}`;
+        }
+        array.offset = min;
+        array.scale = (max - min) / QuantizedRaster.FIXED16_MAX;
+    } else if (encoding === 'float16') {
+        array.offset = 0;
+        array.scale = 1;
+    } else {
+        throw `unsupported quantized raster encoding: ${encoding}`;
+    }
+    array.grid = grid;
+    array.encoding = encoding;
+    return array;
+}
+QuantizedRaster.FIXED16_MAX = 65535;
+// "FromExample" returns a new raster with the same grid and encoding as "raster"
+QuantizedRaster.FromExample = function(raster) {
+    var result = new Uint16Array(RasterArrayBuffer(raster.grid, raster.length * Uint16Array.BYTES_PER_ELEMENT));
+    result.grid = raster.grid;
+    result.encoding = raster.encoding;
+    result.offset = raster.offset;
+    result.scale = raster.scale;
+    return result;
+}
+QuantizedRaster.FromBuffer = function(buffer, grid, start, encoding, min, max) {
+    start = start || 0;
+    var result = new Uint16Array(buffer, start, grid.vertices.length);
+    return QuantizedRaster.describe(result, grid, encoding, min, max);
+}
+// "getParameters" returns what's needed to recreate "raster" with "FromParameters",
+//   including its values as an ArrayBuffer, so they are stored at 2 bytes per cell by BinarySerializer and JsonSerializer,
+//   e.g. for the coverage fractions of "JsonSerializer.render_state"
+QuantizedRaster.getParameters = function(raster) {
+    return {
+        encoding: raster.encoding,
+        offset: raster.offset,
+        scale: raster.scale,
+        buffer: raster.slice(0).buffer,
+    };
+}
+QuantizedRaster.FromParameters = function(parameters, grid) {
+    var result = new Uint16Array(parameters.buffer, 0, grid.vertices.length);
+    result.grid = grid;
+    result.encoding = parameters.encoding;
+    result.offset = parameters.offset;
+    result.scale = parameters.scale;
+    return result;
+}
+// "encode" stores the values of "raster", a Float32Raster, in "result", which must be a QuantizedRaster
+QuantizedRaster.encode = function(raster, result) {
+    if (!(raster instanceof Float32Array)) { throw "raster" + ' is not a ' + "Float32Array"; }
+    if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
+    if (result.encoding === 'fixed16') {
+        RasterWorkerPool.run('encode_fixed16', { x: raster, offset: result.offset, scale: result.scale, result: result }, void 0, raster.length);
+    } else if (result.encoding === 'float16') {
+        RasterWorkerPool.run('encode_float16', { x: raster, result: result }, void 0, raster.length);
+    } else {
+        throw `unsupported quantized raster encoding: ${result.encoding}`;
+    }
+    return result;
+}
+// "decode" returns the values of "raster", a QuantizedRaster, as a Float32Raster
+QuantizedRaster.decode = function(raster, result) {
+    if (!(raster instanceof Uint16Array)) { throw "raster" + ' is not a ' + "Uint16Array"; }
+    result = result || Float32Raster(raster.grid);
+    if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
+    if (raster.encoding === 'fixed16') {
+        RasterWorkerPool.run('decode_fixed16', { x: raster, offset: raster.offset, scale: raster.scale, result: result }, void 0, raster.length);
+    } else if (raster.encoding === 'float16') {
+        RasterWorkerPool.run('decode_float16', { x: raster, result: result }, void 0, raster.length);
+    } else {
+        throw `unsupported quantized raster encoding: ${raster.encoding}`;
+    }
+    return result;
+}
 // The Dataset namespaces provide operations over statistical datasets.
 // All datasets are represented by raster objects, e.g. VectorRaster or Float32Raster
 var Float32Dataset = {};
@@ -1962,12 +2200,16 @@ Float32Dataset.average = function (dataset) {
   return result / dataset.length;
 };
 Float32Dataset.median = function (dataset, scratch) {
-  scratch = scratch || Float32Raster(dataset.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('Float32Dataset.median');
+  scratch = scratch || pool.getFloat32Raster(dataset.grid);
   if (!(dataset instanceof Float32Array)) { throw "dataset" + ' is not a ' + "Float32Array"; }
   if (!(scratch instanceof Float32Array)) { throw "scratch" + ' is not a ' + "Float32Array"; }
   Float32Raster.copy(dataset, scratch);
   scratch.sort();
-  return scratch[Math.floor(scratch.length/2)];
+  var median = scratch[Math.floor(scratch.length/2)];
+  pool.deallocate('Float32Dataset.median');
+  return median;
 };
 Float32Dataset.standard_deviation = function (dataset) {
   if (!(dataset instanceof Float32Array)) { throw "dataset" + ' is not a ' + "Float32Array"; }
@@ -2417,8 +2659,8 @@ ScalarField.ne_scalar = function (scalar_field1, scalar, threshold, result) {
 ScalarField.add_field_term = function (scalar_field1, scalar_field2, scalar_field3, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(scalar_field3 instanceof Float32Array || scalar_field3 instanceof Uint16Array || scalar_field3 instanceof Uint8Array)) { throw "scalar_field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field3 instanceof Float32Array || scalar_field3 instanceof Uint32Array || scalar_field3 instanceof Uint16Array || scalar_field3 instanceof Uint8Array)) { throw "scalar_field3" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   var length = scalar_field3.length;
   for (var i = 0, li = result.length; i < li; i++) {
@@ -2429,39 +2671,33 @@ ScalarField.add_field_term = function (scalar_field1, scalar_field2, scalar_fiel
 ScalarField.add_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (typeof scalar != "number" || isNaN(scalar) || !isFinite(scalar)) { throw "scalar" + ' is not a real number'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] + scalar * scalar_field2[i];
-  }
+  RasterWorkerPool.run('add_scalar_term', { a: scalar_field1, b: scalar_field2, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.add_field = function (scalar_field1, scalar_field2, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] + scalar_field2[i];
-  }
+  RasterWorkerPool.run('add_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_field = function (scalar_field1, scalar_field2, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] - scalar_field2[i];
-  }
+  RasterWorkerPool.run('sub_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_field_term = function (scalar_field1, scalar_field2, field3, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(field3 instanceof Float32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(field3 instanceof Float32Array || field3 instanceof Uint32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] - field3[i] * scalar_field2[i];
@@ -2471,7 +2707,7 @@ ScalarField.sub_field_term = function (scalar_field1, scalar_field2, field3, res
 ScalarField.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (typeof scalar != "number" || isNaN(scalar) || !isFinite(scalar)) { throw "scalar" + ' is not a real number'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
@@ -2482,17 +2718,15 @@ ScalarField.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, re
 ScalarField.mult_field = function (scalar_field1, scalar_field2, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] * scalar_field2[i];
-  }
+  RasterWorkerPool.run('mult_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.div_field = function (scalar_field1, scalar_field2, result) {
   result = result || Float32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] / scalar_field2[i];
@@ -2523,9 +2757,7 @@ ScalarField.add_scalar = function (scalar_field, scalar, result) {
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if (typeof scalar != "number" || isNaN(scalar) || !isFinite(scalar)) { throw "scalar" + ' is not a real number'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field[i] + scalar;
-  }
+  RasterWorkerPool.run('add_scalar', { a: scalar_field, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_scalar = function (scalar_field, scalar, result) {
@@ -2543,9 +2775,7 @@ ScalarField.mult_scalar = function (scalar_field, scalar, result) {
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if (typeof scalar != "number" || isNaN(scalar) || !isFinite(scalar)) { throw "scalar" + ' is not a real number'; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field[i] * scalar;
-  }
+  RasterWorkerPool.run('mult_scalar', { a: scalar_field, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.div_scalar = function (scalar_field, scalar, result) {
@@ -2591,8 +2821,8 @@ ScalarField.differential = function (scalar_field, result) {
   result = result || VectorRaster(scalar_field.grid);
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if ((result.everything === void 0) || !(result.everything instanceof Float32Array)) { throw "result" + ' is not a vector raster'; }
-  var arrows = scalar_field.grid.arrows;
-  var arrow = [];
+  var arrow_from = scalar_field.grid.arrow_from;
+  var arrow_to = scalar_field.grid.arrow_to;
   var from = 0, to = 0;
   var x = result.x;
   var y = result.y;
@@ -2600,60 +2830,26 @@ ScalarField.differential = function (scalar_field, result) {
   Float32Raster.fill(x, 0);
   Float32Raster.fill(y, 0);
   Float32Raster.fill(z, 0);
-  for (var i = 0, li = arrows.length; i < li; i++) {
-    arrow = arrows[i];
-    from = arrow[0];
-    to = arrow[1];
+  for (var i = 0, li = arrow_from.length; i < li; i++) {
+    from = arrow_from[i];
+    to = arrow_to[i];
     x[to] += scalar_field[from] - scalar_field[to];
     y[to] += scalar_field[from] - scalar_field[to];
     z[to] += scalar_field[from] - scalar_field[to];
   }
-  var neighbor_lookup = scalar_field.grid.neighbor_lookup;
-  var neighbor_count = 0;
-  for (var i = 0, li = neighbor_lookup.length; i < li; i++) {
-    neighbor_count = neighbor_lookup[i].length;
-    x[i] /= neighbor_count || 1;
-    y[i] /= neighbor_count || 1;
-    z[i] /= neighbor_count || 1;
+  var neighbor_count = scalar_field.grid.neighbor_count;
+  for (var i = 0, li = neighbor_count.length; i < li; i++) {
+    x[i] /= neighbor_count[i] || 1;
+    y[i] /= neighbor_count[i] || 1;
+    z[i] /= neighbor_count[i] || 1;
   }
   return result;
 };
+// NOTE: "scratch" and "scratch2" are no longer used, they are only kept so that existing calls still work
 ScalarField.gradient = function (scalar_field, result, scratch, scratch2) {
   result = result || VectorRaster(scalar_field.grid);
-  scratch = scratch || Float32Raster(scalar_field.grid);
-  scratch2 = scratch2 || Float32Raster(scalar_field.grid);
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
-  if (!(scratch instanceof Float32Array)) { throw "scratch" + ' is not a ' + "Float32Array"; }
-  if (!(scratch2 instanceof Float32Array)) { throw "scratch2" + ' is not a ' + "Float32Array"; }
   if ((result.everything === void 0) || !(result.everything instanceof Float32Array)) { throw "result" + ' is not a vector raster'; }
-  var pos = scalar_field.grid.pos;
-  var ix = pos.x;
-  var iy = pos.y;
-  var iz = pos.z;
-  var dpos_hat = scalar_field.grid.pos_arrow_differential_normalized;
-  var dxhat = dpos_hat.x;
-  var dyhat = dpos_hat.y;
-  var dzhat = dpos_hat.z;
-  var dpos = scalar_field.grid.pos_arrow_differential;
-  var dx = dpos.x;
-  var dy = dpos.y;
-  var dz = dpos.z;
-  var arrows = scalar_field.grid.arrows;
-  var arrow = [];
-  var dlength = scalar_field.grid.pos_arrow_distances;
-  var neighbor_count = scalar_field.grid.neighbor_count;
-  var average = scratch;
-  var x = result.x;
-  var y = result.y;
-  var z = result.z;
-  var arrow_distance = 0;
-  var average_distance = scalar_field.grid.average_distance;
-  var slope = 0;
-  var slope_magnitude = 0;
-  var from = 0;
-  var to = 0;
-  var max_slope_from = 0;
-  var PI = Math.PI;
   //
   // NOTE: 
   // The naive implementation is to estimate the gradient based on each individual neighbor,
@@ -2668,25 +2864,7 @@ ScalarField.gradient = function (scalar_field, result, scratch, scratch2) {
   //   ∇ϕ = 1/V ∫∫ₐ ϕn̂ da
   // so find flux out of an area, then divide by volume
   // the area/volume is calculated for a circle that reaches halfway to neighboring vertices
-  Float32Raster.fill(x, 0);
-  Float32Raster.fill(y, 0);
-  Float32Raster.fill(z, 0);
-  var difference = 0;
-  for (var i = 0, li = arrows.length; i < li; i++) {
-    arrow = arrows[i];
-    from = arrow[0];
-    to = arrow[1];
-    difference = (scalar_field[to] - scalar_field[from]);
-    x[from] += difference * dxhat[i] * dlength[i]/neighbor_count[from] * PI;
-    y[from] += difference * dyhat[i] * dlength[i]/neighbor_count[from] * PI;
-    z[from] += difference * dzhat[i] * dlength[i]/neighbor_count[from] * PI;
-  }
-  var inverse_volume = 1 / (PI * (average_distance/2) * (average_distance/2));
-  for (var i = 0, li = scalar_field.length; i < li; i++) {
-    x[i] *= inverse_volume;
-    y[i] *= inverse_volume;
-    z[i] *= inverse_volume;
-  }
+  RasterWorkerPool.run('gradient', { field: scalar_field, x: result.x, y: result.y, z: result.z }, scalar_field.grid, scalar_field.length);
   return result;
 };
 ScalarField.average_difference = function (scalar_field, result) {
@@ -2694,17 +2872,7 @@ ScalarField.average_difference = function (scalar_field, result) {
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   if (scalar_field === result) { throw "scalar_field" + ' and ' + "result" + ' cannot be the same'; }
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-  Float32Raster.fill(result, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      result[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      result[i] /= neighbor_count[i];
-  }
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: 1, result: result }, scalar_field.grid, result.length);
   return result;
 };
 // This function computes the laplacian of a surface. 
@@ -2733,68 +2901,81 @@ ScalarField.laplacian = function (scalar_field, result) {
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   if (scalar_field === result) { throw "scalar_field" + ' and ' + "result" + ' cannot be the same'; }
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-  Float32Raster.fill(result, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      result[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
   var average_distance = scalar_field.grid.average_distance;
   var average_area = average_distance * average_distance;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      result[i] /= average_area * neighbor_count[i];
-  }
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: average_area, result: result }, scalar_field.grid, result.length);
   return result;
 };
 // iterates through time using the diffusion equation
 ScalarField.diffusion_by_constant = function (scalar_field, constant, result, scratch) {
   result = result || Float32Raster(scalar_field.grid);
-  scratch = scratch || Float32Raster(scalar_field.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('ScalarField.diffusion_by_constant');
+  scratch = scratch || pool.getFloat32Raster(scalar_field.grid);
   if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   if (!(scratch instanceof Float32Array)) { throw "scratch" + ' is not a ' + "Float32Array"; }
   if (typeof constant != "number" || isNaN(constant) || !isFinite(constant)) { throw "constant" + ' is not a real number'; }
   var laplacian = scratch;
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-  Float32Raster.fill(laplacian, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      laplacian[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      laplacian[i] /= neighbor_count[i];
-  }
-  for (var i=0, li=laplacian.length; i<li; ++i) {
-      result[i] = scalar_field[i] + constant * laplacian[i];
-  }
+  // NOTE: the laplacian is found for every cell before any are written to "result", in case "result" is "scalar_field"
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: 1, result: laplacian }, scalar_field.grid, laplacian.length);
+  RasterWorkerPool.run('add_scalar_term', { a: scalar_field, b: laplacian, scalar: constant, result: result }, void 0, laplacian.length);
+  pool.deallocate('ScalarField.diffusion_by_constant');
   return result;
 };
 // iterates through time using the diffusion equation
 ScalarField.diffusion_by_field = function (scalar_field1, scalar_field2, result, scratch) {
   result = result || Float32Raster(scalar_field1.grid);
-  scratch = scratch || Float32Raster(scalar_field1.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('ScalarField.diffusion_by_field');
+  scratch = scratch || pool.getFloat32Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
   if (!(scalar_field2 instanceof Float32Array)) { throw "scalar_field2" + ' is not a ' + "Float32Array"; }
   if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
   if (!(scratch instanceof Float32Array)) { throw "scratch" + ' is not a ' + "Float32Array"; }
   var laplacian = scratch;
-  var arrows = scalar_field1.grid.arrows;
-  var arrow
-  Float32Raster.fill(laplacian, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      laplacian[arrow[0]] += scalar_field1[arrow[1]] - scalar_field1[arrow[0]];
-  }
-  var neighbor_count = scalar_field1.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      laplacian[i] /= neighbor_count[i];
+  // NOTE: the laplacian is found for every cell before any are written to "result", in case "result" is "scalar_field1"
+  RasterWorkerPool.run('average_difference', { field: scalar_field1, scale: 1, result: laplacian }, scalar_field1.grid, laplacian.length);
+  RasterWorkerPool.run('add_field_product', { a: scalar_field1, b: laplacian, c: scalar_field2, result: result }, void 0, laplacian.length);
+  pool.deallocate('ScalarField.diffusion_by_field');
+  return result;
+};
+// iterates through time using the diffusion equation, for "iterations" iterations of "diffusion_by_constant"
+// If enough iterations are requested, they run on the gpu, see "RasterGpuKernels"
+ScalarField.diffusion_by_constant_iterations = function (scalar_field, constant, iterations, result, scratch) {
+  result = result || Float32Raster(scalar_field.grid);
+  if (!(scalar_field instanceof Float32Array)) { throw "scalar_field" + ' is not a ' + "Float32Array"; }
+  if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
+  if (typeof constant != "number" || isNaN(constant) || !isFinite(constant)) { throw "constant" + ' is not a real number'; }
+  if (iterations >= RasterGpuKernels.MIN_ITERATION_COUNT && RasterGpuKernels.can_run(scalar_field.grid)) {
+    return RasterGpuKernels.diffusion(scalar_field, constant, void 0, iterations, result);
+  }
+  if (iterations < 1) {
+    return Float32Raster.copy(scalar_field, result);
+  }
+  ScalarField.diffusion_by_constant(scalar_field, constant, result, scratch);
+  for (var i = 1; i < iterations; i++) {
+    ScalarField.diffusion_by_constant(result, constant, result, scratch);
+  }
+  return result;
+};
+// iterates through time using the diffusion equation, for "iterations" iterations of "diffusion_by_field"
+// If enough iterations are requested, they run on the gpu, see "RasterGpuKernels"
+ScalarField.diffusion_by_field_iterations = function (scalar_field1, scalar_field2, iterations, result, scratch) {
+  result = result || Float32Raster(scalar_field1.grid);
+  if (!(scalar_field1 instanceof Float32Array)) { throw "scalar_field1" + ' is not a ' + "Float32Array"; }
+  if (!(scalar_field2 instanceof Float32Array)) { throw "scalar_field2" + ' is not a ' + "Float32Array"; }
+  if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
+  if (scalar_field2 === result) { throw "scalar_field2" + ' and ' + "result" + ' cannot be the same'; }
+  if (iterations >= RasterGpuKernels.MIN_ITERATION_COUNT && RasterGpuKernels.can_run(scalar_field1.grid)) {
+    return RasterGpuKernels.diffusion(scalar_field1, 0, scalar_field2, iterations, result);
   }
-  for (var i=0, li=laplacian.length; i<li; ++i) {
-      result[i] = scalar_field1[i] + scalar_field2[i] * laplacian[i];
+  if (iterations < 1) {
+    return Float32Raster.copy(scalar_field1, result);
+  }
+  ScalarField.diffusion_by_field(scalar_field1, scalar_field2, result, scratch);
+  for (var i = 1; i < iterations; i++) {
+    ScalarField.diffusion_by_field(result, scalar_field2, result, scratch);
   }
   return result;
 };
@@ -2964,8 +3145,8 @@ Uint16Field.ne_scalar = function (scalar_field1, scalar, result) {
 Uint16Field.add_field_term = function (scalar_field1, scalar_field2, field3, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(field3 instanceof Float32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(field3 instanceof Float32Array || field3 instanceof Uint32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] + field3[i] * scalar_field2[i];
@@ -2975,7 +3156,7 @@ Uint16Field.add_field_term = function (scalar_field1, scalar_field2, field3, res
 Uint16Field.add_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(typeof scalar == "number")) { throw "scalar" + ' is not a ' + "number"; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
@@ -2986,7 +3167,7 @@ Uint16Field.add_scalar_term = function (scalar_field1, scalar_field2, scalar, re
 Uint16Field.add_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] + scalar_field2[i];
@@ -2996,7 +3177,7 @@ Uint16Field.add_field = function (scalar_field1, scalar_field2, result) {
 Uint16Field.sub_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] - scalar_field2[i];
@@ -3006,8 +3187,8 @@ Uint16Field.sub_field = function (scalar_field1, scalar_field2, result) {
 Uint16Field.sub_field_term = function (scalar_field1, scalar_field2, field3, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(field3 instanceof Float32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(field3 instanceof Float32Array || field3 instanceof Uint32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] - field3[i] * scalar_field2[i];
@@ -3017,7 +3198,7 @@ Uint16Field.sub_field_term = function (scalar_field1, scalar_field2, field3, res
 Uint16Field.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(typeof scalar == "number")) { throw "scalar" + ' is not a ' + "number"; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
@@ -3028,7 +3209,7 @@ Uint16Field.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, re
 Uint16Field.mult_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] * scalar_field2[i];
@@ -3038,7 +3219,7 @@ Uint16Field.mult_field = function (scalar_field1, scalar_field2, result) {
 Uint16Field.div_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint16Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint16Array)) { throw "scalar_field1" + ' is not a ' + "Uint16Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint16Array)) { throw "result" + ' is not a ' + "Uint16Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] / scalar_field2[i];
@@ -3268,8 +3449,8 @@ Uint8Field.ne_scalar = function (scalar_field1, scalar, result) {
 Uint8Field.add_field_term = function (scalar_field1, scalar_field2, field3, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(field3 instanceof Float32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(field3 instanceof Float32Array || field3 instanceof Uint32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] + field3[i] * scalar_field2[i];
@@ -3279,7 +3460,7 @@ Uint8Field.add_field_term = function (scalar_field1, scalar_field2, field3, resu
 Uint8Field.add_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(typeof scalar == "number")) { throw "scalar" + ' is not a ' + "number"; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
@@ -3290,7 +3471,7 @@ Uint8Field.add_scalar_term = function (scalar_field1, scalar_field2, scalar, res
 Uint8Field.add_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] + scalar_field2[i];
@@ -3300,7 +3481,7 @@ Uint8Field.add_field = function (scalar_field1, scalar_field2, result) {
 Uint8Field.sub_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] - scalar_field2[i];
@@ -3310,8 +3491,8 @@ Uint8Field.sub_field = function (scalar_field1, scalar_field2, result) {
 Uint8Field.sub_field_term = function (scalar_field1, scalar_field2, field3, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
-  if (!(field3 instanceof Float32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(field3 instanceof Float32Array || field3 instanceof Uint32Array || field3 instanceof Uint16Array || field3 instanceof Uint8Array)) { throw "field3" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] - field3[i] * scalar_field2[i];
@@ -3321,7 +3502,7 @@ Uint8Field.sub_field_term = function (scalar_field1, scalar_field2, field3, resu
 Uint8Field.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(typeof scalar == "number")) { throw "scalar" + ' is not a ' + "number"; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
@@ -3332,7 +3513,7 @@ Uint8Field.sub_scalar_term = function (scalar_field1, scalar_field2, scalar, res
 Uint8Field.mult_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] * scalar_field2[i];
@@ -3342,7 +3523,7 @@ Uint8Field.mult_field = function (scalar_field1, scalar_field2, result) {
 Uint8Field.div_field = function (scalar_field1, scalar_field2, result) {
   result = result || Uint8Raster(scalar_field1.grid);
   if (!(scalar_field1 instanceof Uint8Array)) { throw "scalar_field1" + ' is not a ' + "Uint8Array"; }
-  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
+  if (!(scalar_field2 instanceof Float32Array || scalar_field2 instanceof Uint32Array || scalar_field2 instanceof Uint16Array || scalar_field2 instanceof Uint8Array)) { throw "scalar_field2" + ' is not a typed array'; }
   if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
   for (var i = 0, li = result.length; i < li; i++) {
     result[i] = scalar_field1[i] / scalar_field2[i];
@@ -3423,8 +3604,8 @@ Uint8Field.gradient = function (scalar_field, result) {
   var dx = dpos.x;
   var dy = dpos.y;
   var dz = dpos.z;
-  var arrows = grid.arrows;
-  var arrow = [];
+  var arrow_from = grid.arrow_from;
+  var arrow_to = grid.arrow_to;
   var dlength = grid.pos_arrow_distances;
   var neighbor_count = grid.neighbor_count;
   var x = result.x;
@@ -3456,10 +3637,9 @@ Uint8Field.gradient = function (scalar_field, result) {
   y.fill(0);
   z.fill(0);
   var average_value = 0;
-  for (var i = 0, li = arrows.length; i < li; i++) {
-    arrow = arrows[i];
-    from = arrow[0];
-    to = arrow[1];
+  for (var i = 0, li = arrow_from.length; i < li; i++) {
+    from = arrow_from[i];
+    to = arrow_to[i];
     average_value = (scalar_field[to] - scalar_field[from]);
     x[from] += average_value * dxhat[i] * PI * dlength[i]/neighbor_count[from];
     y[from] += average_value * dyhat[i] * PI * dlength[i]/neighbor_count[from];
@@ -3484,9 +3664,7 @@ VectorField.add_vector_field = function(vector_field1, vector_field2, result) {
     var u = vector_field1.everything;
     var v = vector_field2.everything;
     var out = result.everything;
-    for (var i=0, li=u.length; i<li; ++i) {
-        out[i] = u[i] + v[i];
-    }
+    RasterWorkerPool.run('add_field', { a: u, b: v, result: out }, void 0, u.length);
     return result;
 };
 VectorField.sub_vector_field = function(vector_field1, vector_field2, result) {
@@ -3497,9 +3675,7 @@ VectorField.sub_vector_field = function(vector_field1, vector_field2, result) {
     var u = vector_field1.everything;
     var v = vector_field2.everything;
     var out = result.everything;
-    for (var i=0, li=u.length; i<li; ++i) {
-        out[i] = u[i] - v[i];
-    }
+    RasterWorkerPool.run('sub_field', { a: u, b: v, result: out }, void 0, u.length);
     return result;
 };
 VectorField.dot_vector_field = function(vector_field1, vector_field2, result) {
@@ -3993,16 +4169,7 @@ VectorField.magnitude = function(vector_field, result) {
     var x = vector_field.x;
     var y = vector_field.y;
     var z = vector_field.z;
-    var xi=0, yi=0, zi=0;
-    var sqrt = Math.sqrt;
-    for (var i = 0, li = result.length; i<li; i++) {
-        var xi = x[i];
-        var yi = y[i];
-        var zi = z[i];
-        result[i] = sqrt( xi * xi +
-                            yi * yi +
-                            zi * zi );
-    }
+    RasterWorkerPool.run('magnitude', { x: x, y: y, z: z, result: result }, void 0, result.length);
     return result;
 }
 VectorField.normalize = function(vector_field, result) {
@@ -4015,27 +4182,14 @@ VectorField.normalize = function(vector_field, result) {
     var ox = result.x;
     var oy = result.y;
     var oz = result.z;
-    var xi=0., yi=0., zi=0.;
-    var sqrt = Math.sqrt;
-    var mag = 0.;
-    for (var i = 0, li = x.length; i<li; i++) {
-        var xi = x[i];
-        var yi = y[i];
-        var zi = z[i];
-        mag = sqrt( xi * xi +
-                    yi * yi +
-                    zi * zi );
-        ox[i] = xi/(mag||1);
-        oy[i] = yi/(mag||1);
-        oz[i] = zi/(mag||1);
-    }
+    RasterWorkerPool.run('normalize', { x: x, y: y, z: z, ox: ox, oy: oy, oz: oz }, void 0, x.length);
     return result;
 }
 // ∂X
 // NOTE: should arrow_differential exist at all? 
 // Consider moving its code to grid
 VectorField.arrow_differential = function(vector_field, result) {
-    result = result || VectorRaster.OfLength(vector_field.grid.arrows.length, undefined);
+    result = result || VectorRaster.OfLength(vector_field.grid.arrow_from.length, undefined);
     if ((vector_field.everything === void 0) || !(vector_field.everything instanceof Float32Array)) { throw "vector_field" + ' is not a vector raster'; }
     if ((result.everything === void 0) || !(result.everything instanceof Float32Array)) { throw "result" + ' is not a vector raster'; }
     var x1 = vector_field.x;
@@ -4044,12 +4198,13 @@ VectorField.arrow_differential = function(vector_field, result) {
     var x = result.x;
     var y = result.y;
     var z = result.z;
-    var arrows = vector_field.grid.arrows;
+    var arrow_from = vector_field.grid.arrow_from;
+    var arrow_to = vector_field.grid.arrow_to;
     var from = 0;
     var to = 0;
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
+    for (var i = 0, li = arrow_from.length; i<li; i++) {
+        from = arrow_from[i];
+        to = arrow_to[i];
         x[i] = x1[to] - x1[from];
         y[i] = y1[to] - y1[from];
         z[i] = z1[to] - z1[from];
@@ -4078,30 +4233,7 @@ VectorField.divergence = function(vector_field, result) {
     result = result || Float32Raster.OfLength(vector_field.x.length, vector_field.grid);
     if ((vector_field.everything === void 0) || !(vector_field.everything instanceof Float32Array)) { throw "vector_field" + ' is not a vector raster'; }
     if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-    var dlength = vector_field.grid.pos_arrow_distances;
-    var arrows = vector_field.grid.arrows;
-    var x = vector_field.x;
-    var y = vector_field.y;
-    var z = vector_field.z;
-    var arrow_pos_diff_normalized = vector_field.grid.pos_arrow_differential_normalized;
-    var dxhat = arrow_pos_diff_normalized.x;
-    var dyhat = arrow_pos_diff_normalized.y;
-    var dzhat = arrow_pos_diff_normalized.z;
-    var from = 0;
-    var to = 0;
-    Float32Raster.fill(result, 0);
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
-        result[from] +=
-          ( (x[to] - x[from]) * dxhat[i]
-           +(y[to] - y[from]) * dyhat[i]
-           +(z[to] - z[from]) * dzhat[i]) / dlength[i];
-    }
-    var neighbor_count = vector_field.grid.neighbor_count;
-    for (var i = 0, li = neighbor_count.length; i < li; i++) {
-        result[i] /= neighbor_count[i] || 1;
-    }
+    RasterWorkerPool.run('divergence', { x: vector_field.x, y: vector_field.y, z: vector_field.z, result: result }, vector_field.grid, result.length);
     return result;
 }
 // This function computes the curl of a 3d mesh. 
@@ -4120,7 +4252,8 @@ VectorField.curl = function(vector_field, result) {
     if ((vector_field.everything === void 0) || !(vector_field.everything instanceof Float32Array)) { throw "vector_field" + ' is not a vector raster'; }
     if ((result.everything === void 0) || !(result.everything instanceof Float32Array)) { throw "result" + ' is not a vector raster'; }
     var dlength = vector_field.grid.pos_arrow_distances;
-    var arrows = vector_field.grid.arrows;
+    var arrow_from = vector_field.grid.arrow_from;
+    var arrow_to = vector_field.grid.arrow_to;
     var curl_fx = result.x;
     var curl_fy = result.y;
     var curl_fz = result.z;
@@ -4139,9 +4272,9 @@ VectorField.curl = function(vector_field, result) {
     Float32Raster.fill(curl_fx, 0);
     Float32Raster.fill(curl_fy, 0);
     Float32Raster.fill(curl_fz, 0);
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
+    for (var i = 0, li = arrow_from.length; i<li; i++) {
+        from = arrow_from[i];
+        to = arrow_to[i];
         dfx = fx[to] - fx[from];
         dfy = fy[to] - fy[from];
         dfz = fz[to] - fz[from];
@@ -4231,13 +4364,20 @@ Uint8RasterGraphics.fill_into_selection = function(raster, fill, selection, resu
 var VectorRasterGraphics = {};
 VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, start_id, mask, result, scratch_ui8) {
     result = result || Uint8Raster(vector_raster.grid);
-    scratch_ui8 = scratch_ui8 || Uint8Raster(vector_raster.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('VectorRasterGraphics.magic_wand_select');
+    if (!scratch_ui8) {
+        // rasters from the pool are not cleared, unlike new rasters
+        scratch_ui8 = pool.getUint8Raster(vector_raster.grid);
+        Uint8Raster.fill(scratch_ui8, 0);
+    }
     if ((vector_raster.everything === void 0) || !(vector_raster.everything instanceof Float32Array)) { throw "vector_raster" + ' is not a vector raster'; }
     if (!(typeof start_id == "number")) { throw "start_id" + ' is not a ' + "number"; }
     if (!(mask instanceof Uint8Array)) { throw "mask" + ' is not a ' + "Uint8Array"; }
     if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; }
     Uint8Raster.fill(result, 0);
-    var neighbor_lookup = vector_raster.grid.neighbor_lookup;
+    var arrow_offsets = vector_raster.grid.arrow_offsets;
+    var arrow_to = vector_raster.grid.arrow_to;
     var similarity = Vector.similarity;
     var magnitude = Vector.magnitude;
     var x = vector_raster.x;
@@ -4249,7 +4389,6 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
     searched[start_id] = 1;
     var id = 0;
     var neighbor_id = 0;
-    var neighbors = [];
     var is_similar = 0;
     var threshold = Math.cos(Math.PI * 60/180);
     var start_x = x[start_id];
@@ -4261,9 +4400,8 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
                                  start_x, start_y, start_z) > threshold;
         if (is_similar) {
             grouped[id] = 1;
-            neighbors = neighbor_lookup[id];
-            for (var i=0, li=neighbors.length; i<li; ++i) {
-                neighbor_id = neighbors[i];
+            for (var i=arrow_offsets[id], li=arrow_offsets[id+1]; i<li; ++i) {
+                neighbor_id = arrow_to[i];
                 if (searched[neighbor_id] === 0 && mask[id] != 0) {
                     searching.push(neighbor_id);
                     searched[neighbor_id] = 1;
@@ -4271,6 +4409,7 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
             }
         }
     }
+    pool.deallocate('VectorRasterGraphics.magic_wand_select');
     return result;
 }
 VectorRasterGraphics.copy_into_selection = function(vector_raster, copied, selection, result) {
@@ -4347,11 +4486,7 @@ Float32RasterInterpolation.clamp = function(x, min_value, max_value, result) {
     if (!(x instanceof Float32Array)) { throw "x" + ' is not a ' + "Float32Array"; }
     result = result || Float32Raster.FromExample(x);
     if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-    var x_i = 0.0;
-    for (var i = 0, li = x.length; i < li; i++) {
-        x_i = x[i];
-        result[i] = x_i > max_value? max_value : x_i < min_value? min_value : x_i;
-    }
+    RasterWorkerPool.run('clamp', { x: x, min_value: min_value, max_value: max_value, result: result }, void 0, x.length);
     return result;
 }
 Float32RasterInterpolation.step = function(edge, x, result) {
@@ -4367,26 +4502,14 @@ Float32RasterInterpolation.linearstep = function(edge0, edge1, x, result) {
     if (!(x instanceof Float32Array)) { throw "x" + ' is not a ' + "Float32Array"; }
     result = result || Float32Raster.FromExample(x);
     if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-    var fraction = 0.;
-    var inverse_edge_distance = 1 / (edge1 - edge0);
-    for (var i = 0, li = result.length; i < li; i++) {
-        fraction = (x[i] - edge0) * inverse_edge_distance;
-        result[i] = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
-    }
+    RasterWorkerPool.run('linearstep', { x: x, edge0: edge0, edge1: edge1, result: result }, void 0, result.length);
     return result;
 }
 Float32RasterInterpolation.smoothstep = function(edge0, edge1, x, result) {
     if (!(x instanceof Float32Array)) { throw "x" + ' is not a ' + "Float32Array"; }
     result = result || Float32Raster.FromExample(x);
     if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
-    var inverse_edge_distance = 1 / (edge1 - edge0);
-    var fraction = 0.;
-    var linearstep = 0.;
-    for (var i = 0, li = result.length; i < li; i++) {
-        fraction = (x[i] - edge0) * inverse_edge_distance;
-        linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
-        result[i] = linearstep*linearstep*(3-2*linearstep);
-    }
+    RasterWorkerPool.run('smoothstep', { x: x, edge0: edge0, edge1: edge1, result: result }, void 0, result.length);
     return result;
 }
 // NOTE: you probably don't want to use this - you should use "smoothstep", instead
@@ -4408,7 +4531,9 @@ Float32RasterInterpolation.smoothstep2 = function(x, k, result) {
 Float32RasterInterpolation.lerp = function(control_points_x, control_points_y, x, result, scratch) {
     if (!(x instanceof Float32Array)) { throw "x" + ' is not a ' + "Float32Array"; }
     result = result || Float32Raster.FromExample(x);
-    scratch = scratch || Float32Raster.FromExample(x);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Float32RasterInterpolation.lerp');
+    scratch = scratch || pool.getFloat32Raster(x.grid);
     var mix = Float32RasterInterpolation.mix_fsf;
     var linearstep = Float32RasterInterpolation.linearstep;
     Float32Raster.fill(result, control_points_y[0]);
@@ -4416,8 +4541,168 @@ Float32RasterInterpolation.lerp = function(control_points_x, control_points_y, x
         linearstep (control_points_x[i-1], control_points_x[i], x, scratch)
         mix (result, control_points_y[i], scratch, result);
     }
+    pool.deallocate('Float32RasterInterpolation.lerp');
+    return result;
+}
+// Float32RasterExpression records a chain of element-wise raster operations, then runs them as a single loop.
+// Model code often chains operations like ScalarField.mult_scalar() -> ScalarField.add_field() -> Float32RasterInterpolation.clamp(),
+//   each of which streams a raster through memory and often needs a scratch raster to hold its result.
+// A fused loop reads each input once per cell and writes the result once, with no scratch rasters in between.
+//
+// Usage:
+//   Float32RasterExpression(a).mult_scalar(2).add_field(b).clamp(0, 1).evaluate(result);
+//
+// Methods are named after their counterparts in ScalarField and Float32RasterInterpolation, and behave the same.
+// Operands of "*_field" methods can either be Float32Rasters or other expressions.
+// Since every input is read for a cell before its result is written, "result" can be one of the inputs.
+//
+// "evaluate" generates the source of the loop and compiles it with "new Function".
+// Scalars are passed as parameters rather than written into the source,
+//   so a chain that runs every timestep with different scalars is only compiled once.
+function Float32RasterExpression(operand) {
+    if (!(this instanceof Float32RasterExpression)) {
+        return new Float32RasterExpression(operand);
+    }
+    if (!(operand instanceof Float32Array)) { throw "operand" + ' is not a ' + "Float32Array"; }
+    this.op = 'raster';
+    this.operands = [operand];
+}
+// functions that are available to the source of compiled loops
+// NOTE: these are written to match the raster operations they stand in for, including how they treat NaN
+Float32RasterExpression.helpers = {
+    min: function(a, b) {
+        return a < b? a : b;
+    },
+    max: function(a, b) {
+        return a > b? a : b;
+    },
+    clamp: function(x, min_value, max_value) {
+        return x > max_value? max_value : x < min_value? min_value : x;
+    },
+    linearstep: function(x, edge0, edge1) {
+        var fraction = (x - edge0) * (1 / (edge1 - edge0));
+        return fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+    },
+    smoothstep: function(x, edge0, edge1) {
+        var fraction = (x - edge0) * (1 / (edge1 - edge0));
+        var linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+        return linearstep*linearstep*(3-2*linearstep);
+    },
+};
+// compiled loops, indexed by their source
+Float32RasterExpression.compiled = new Map();
+// "templates" map each operation onto source, where "$0" is the expression so far, and "$1", "$2" are its operands
+Float32RasterExpression.templates = {
+    add_field: '($0 + $1)',
+    sub_field: '($0 - $1)',
+    mult_field: '($0 * $1)',
+    div_field: '($0 / $1)',
+    min_field: 'min($0, $1)',
+    max_field: 'max($0, $1)',
+    add_field_term: '($0 + $2 * $1)',
+    add_scalar: '($0 + $1)',
+    sub_scalar: '($0 - $1)',
+    mult_scalar: '($0 * $1)',
+    div_scalar: '($0 / $1)',
+    min_scalar: 'min($0, $1)',
+    max_scalar: 'max($0, $1)',
+    pow_scalar: 'pow($0, $1)',
+    add_scalar_term: '($0 + $2 * $1)',
+    sub_scalar_term: '($0 - $2 * $1)',
+    clamp: 'clamp($0, $1, $2)',
+    linearstep: 'linearstep($0, $1, $2)',
+    smoothstep: 'smoothstep($0, $1, $2)',
+};
+Float32RasterExpression.prototype.chain = function(op, operands) {
+    var result = Object.create(Float32RasterExpression.prototype);
+    result.op = op;
+    result.operands = [this].concat(operands);
+    return result;
+}
+Float32RasterExpression.prototype.add_field = function(b) { return this.chain('add_field', [b]); }
+Float32RasterExpression.prototype.sub_field = function(b) { return this.chain('sub_field', [b]); }
+Float32RasterExpression.prototype.mult_field = function(b) { return this.chain('mult_field', [b]); }
+Float32RasterExpression.prototype.div_field = function(b) { return this.chain('div_field', [b]); }
+Float32RasterExpression.prototype.min_field = function(b) { return this.chain('min_field', [b]); }
+Float32RasterExpression.prototype.max_field = function(b) { return this.chain('max_field', [b]); }
+Float32RasterExpression.prototype.add_field_term = function(b, c) { return this.chain('add_field_term', [b, c]); }
+Float32RasterExpression.prototype.add_scalar = function(b) { return this.chain('add_scalar', [b]); }
+Float32RasterExpression.prototype.sub_scalar = function(b) { return this.chain('sub_scalar', [b]); }
+Float32RasterExpression.prototype.mult_scalar = function(b) { return this.chain('mult_scalar', [b]); }
+Float32RasterExpression.prototype.div_scalar = function(b) { return this.chain('div_scalar', [b]); }
+Float32RasterExpression.prototype.min_scalar = function(b) { return this.chain('min_scalar', [b]); }
+Float32RasterExpression.prototype.max_scalar = function(b) { return this.chain('max_scalar', [b]); }
+Float32RasterExpression.prototype.pow_scalar = function(b) { return this.chain('pow_scalar', [b]); }
+Float32RasterExpression.prototype.add_scalar_term = function(b, scalar) { return this.chain('add_scalar_term', [b, scalar]); }
+Float32RasterExpression.prototype.sub_scalar_term = function(b, scalar) { return this.chain('sub_scalar_term', [b, scalar]); }
+Float32RasterExpression.prototype.clamp = function(min_value, max_value) { return this.chain('clamp', [min_value, max_value]); }
+Float32RasterExpression.prototype.linearstep = function(edge0, edge1) { return this.chain('linearstep', [edge0, edge1]); }
+Float32RasterExpression.prototype.smoothstep = function(edge0, edge1) { return this.chain('smoothstep', [edge0, edge1]); }
+// "evaluate" runs the expression over every cell, storing it in "result"
+Float32RasterExpression.prototype.evaluate = function(result) {
+    var rasters = [];
+    var scalars = [];
+    // NOTE: rasters are found by identity, so a raster that appears several times is only read once per cell
+    function source(operand) {
+        if (operand instanceof Float32RasterExpression) {
+            if (operand.op === 'raster') {
+                return source(operand.operands[0]);
+            }
+            var template = Float32RasterExpression.templates[operand.op];
+            var operand_sources = operand.operands.map(source);
+            return template.replace(/\$(\d)/g, function(match, j) { return operand_sources[j]; });
+        } else if (ArrayBuffer.isView(operand)) {
+            if (!(operand instanceof Float32Array)) { throw "operand" + ' is not a ' + "Float32Array"; }
+            var index = rasters.indexOf(operand);
+            if (index < 0) {
+                index = rasters.length;
+                rasters.push(operand);
+            }
+            return 'x' + index;
+        } else {
+            if (typeof operand != "number" || isNaN(operand) || !isFinite(operand)) { throw "operand" + ' is not a real number'; }
+            scalars.push(operand);
+            return 's' + (scalars.length-1);
+        }
+    }
+    var expression = source(this);
+    result = result || Float32Raster.FromExample(rasters[0]);
+    if (!(result instanceof Float32Array)) { throw "result" + ' is not a ' + "Float32Array"; }
+    for (var j = 0; j < rasters.length; j++) {
+        if (rasters[j].length !== result.length) {
+            throw `Float32RasterExpression: rasters must all be the same length`;
+        }
+    }
+    // NOTE: the source names every raster and scalar it uses, so it is enough to identify the loop
+    var loop = Float32RasterExpression.compiled.get(expression);
+    if (loop === void 0) {
+        loop = Float32RasterExpression.compile(expression, rasters.length, scalars.length);
+        Float32RasterExpression.compiled.set(expression, loop);
+    }
+    loop(rasters, scalars, result, Float32RasterExpression.helpers);
     return result;
 }
+// "compile" returns a function that evaluates "expression" for every cell of "result"
+Float32RasterExpression.compile = function(expression, raster_count, scalar_count) {
+    var lines = [
+        'var pow = Math.pow;',
+        'var min = helpers.min, max = helpers.max, clamp = helpers.clamp, linearstep = helpers.linearstep, smoothstep = helpers.smoothstep;',
+    ];
+    var j = 0;
+    for (j = 0; j < raster_count; j++) {
+        lines.push('var r' + j + ' = rasters[' + j + '];');
+    }
+    for (j = 0; j < scalar_count; j++) {
+        lines.push('var s' + j + ' = scalars[' + j + '];');
+    }
+    lines.push('for (var i = 0, li = result.length; i < li; i++) {');
+    for (j = 0; j < raster_count; j++) {
+        lines.push('    var x' + j + ' = r' + j + '[i];');
+    }
+    lines.push('    result[i] = ' + expression + ';');
+    lines.push('}');
+    return new Function('rasters', 'scalars', 'result', 'helpers', lines.join('\n'));
+}
 var Float32RasterTrigonometry = {};
 Float32RasterTrigonometry.cos = function(radians, result) {
   var result = result || Float32Raster(radians.grid);
@@ -4515,11 +4800,17 @@ var VectorImageAnalysis = {};
 // NOTE: this uses no particular algorithm, I wrote it before I started looking into the research
 // This function repeatedly uses the flood fill algorithm from VectorRasterGraphics
 VectorImageAnalysis.image_segmentation = function(vector_field, segment_num, min_segment_size, result, scratch_ui8_1, scratch_ui8_2, scratch_ui8_3) {
-  var scratch_ui8_1 = scratch_ui8_1 || Uint8Raster(vector_field.grid);
-  var scratch_ui8_2 = scratch_ui8_2 || Uint8Raster(vector_field.grid);
-  var scratch_ui8_3 = scratch_ui8_3 || Uint8Raster(vector_field.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('VectorImageAnalysis.image_segmentation');
+  var scratch_ui8_1 = scratch_ui8_1 || pool.getUint8Raster(vector_field.grid);
+  var scratch_ui8_2 = scratch_ui8_2 || pool.getUint8Raster(vector_field.grid);
+  if (!scratch_ui8_3) {
+    // rasters from the pool are not cleared, unlike new rasters
+    scratch_ui8_3 = pool.getUint8Raster(vector_field.grid);
+    Uint8Raster.fill(scratch_ui8_3, 0);
+  }
   var max_iterations = 2 * segment_num;
-  var magnitude = VectorField.magnitude(vector_field);
+  var magnitude = VectorField.magnitude(vector_field, pool.getFloat32Raster(vector_field.grid));
   var segments = result || Uint8Raster(vector_field.grid);
   Uint8Raster.fill(segments, 0);
   var segment = scratch_ui8_1;
@@ -4540,6 +4831,7 @@ VectorImageAnalysis.image_segmentation = function(vector_field, segment_num, min
         i++;
     }
   }
+  pool.deallocate('VectorImageAnalysis.image_segmentation');
   return segments;
 }
 var BinaryMorphology = {};
@@ -4602,63 +4894,45 @@ BinaryMorphology.negation = function(field, result) {
 BinaryMorphology.dilation = function(field, radius, result, scratch) {
     radius = radius || 1;
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.dilation');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     if (!(field instanceof Uint8Array)) { throw "field" + ' is not a ' + "Uint8Array"; };
     if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; };
     var buffer1 = radius % 2 == 1? result: scratch;
     var buffer2 = radius % 2 == 0? result: scratch;
-    scratch.set(field);
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
     var temp = buffer1;
-    var neighbor_lookup = field.grid.neighbor_lookup;
-    var neighbors = [];
-    var buffer_i = true;
     for (var k=0; k<radius; ++k) {
-        for (var i=0, li=neighbor_lookup.length; i<li; ++i) {
-            neighbors = neighbor_lookup[i];
-            buffer_i = buffer2[i] === 1;
-            for (var j=0, lj=neighbors.length; j<lj; ++j) {
-                if (buffer_i) {
-                    continue;
-                }
-                buffer_i = buffer_i || buffer2[neighbors[j]] === 1;
-            }
-            buffer1[i] = buffer_i? 1:0;
-        }
+        RasterWorkerPool.run('dilation', { field: buffer2, result: buffer1 }, field.grid, field.length);
         temp = buffer1;
         buffer1 = buffer2;
         buffer2 = temp;
     }
+    pool.deallocate('BinaryMorphology.dilation');
     return buffer2;
 }
 BinaryMorphology.erosion = function(field, radius, result, scratch) {
     radius = radius || 1;
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.erosion');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     if (!(field instanceof Uint8Array)) { throw "field" + ' is not a ' + "Uint8Array"; };
     if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; };
     var buffer1 = radius % 2 == 1? result: scratch;
     var buffer2 = radius % 2 == 0? result: scratch;
-    scratch.set(field);
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
     var temp = buffer1;
-    var neighbor_lookup = field.grid.neighbor_lookup;
-    var neighbors = [];
-    var buffer_i = true;
     for (var k=0; k<radius; ++k) {
-        for (var i=0, li=neighbor_lookup.length; i<li; ++i) {
-            neighbors = neighbor_lookup[i];
-            buffer_i = buffer2[i] === 1;
-            for (var j=0, lj=neighbors.length; j<lj; ++j) {
-                if (!buffer_i) {
-                    continue;
-                }
-                buffer_i = buffer_i && buffer2[neighbors[j]] === 1;
-            }
-            buffer1[i] = buffer_i? 1:0;
-        }
+        RasterWorkerPool.run('erosion', { field: buffer2, result: buffer1 }, field.grid, field.length);
         temp = buffer1;
         buffer1 = buffer2;
         buffer2 = temp;
     }
+    pool.deallocate('BinaryMorphology.erosion');
     return buffer2;
 }
 BinaryMorphology.opening = function(field, radius) {
@@ -4682,45 +4956,1216 @@ BinaryMorphology.black_top_hat = function(field, radius) {
 // Its name eludes to the "margin" concept within the html box model
 BinaryMorphology.margin = function(field, radius, result, scratch) {
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.margin');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     if (!(field instanceof Uint8Array)) { throw "field" + ' is not a ' + "Uint8Array"; };
     if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; };
     if (!(scratch instanceof Uint8Array)) { throw "scratch" + ' is not a ' + "Uint8Array"; };
-    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
     var dilation = result; // reuse result raster for performance reasons
     BinaryMorphology.dilation(field, radius, dilation, scratch);
-    return BinaryMorphology.difference(dilation, field, result);
+    BinaryMorphology.difference(dilation, field, result);
+    pool.deallocate('BinaryMorphology.margin');
+    return result;
 }
 // NOTE: this is not a standard concept in math morphology
 // It is meant to represent the difference between a figure and its erosion
 // Its name eludes to the "padding" concept within the html box model
 BinaryMorphology.padding = function(field, radius, result, scratch) {
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.padding');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     if (!(field instanceof Uint8Array)) { throw "field" + ' is not a ' + "Uint8Array"; };
     if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; };
     if (!(scratch instanceof Uint8Array)) { throw "scratch" + ' is not a ' + "Uint8Array"; };
-    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
     var erosion = result; // reuse result raster for performance reasons
     BinaryMorphology.erosion(field, radius, erosion, scratch);
-    return BinaryMorphology.difference(field, erosion, result, scratch);
+    BinaryMorphology.difference(field, erosion, result, scratch);
+    pool.deallocate('BinaryMorphology.padding');
+    return result;
 }
-//Data structure mapping 3d coordinates onto a lattice for fast lookups 
-// lattice assumes that max distance to nearest neighbors will never exceed farthest_nearest_neighbor_distance
-function IntegerLattice(points, getDistance, farthest_nearest_neighbor_distance){
-    var lattice = [];
-    var N = 3;
-    var cell_width = 2*farthest_nearest_neighbor_distance;
-    var max_x = Math.max.apply(null, points.map(point => point.x));
-    var min_x = Math.min.apply(null, points.map(point => point.x));
-    var range_x = max_x - min_x;
-    var cell_num_x = range_x / cell_width;
-    var max_y = Math.max.apply(null, points.map(point => point.y));
-    var min_y = Math.min.apply(null, points.map(point => point.y));
-    var range_y = max_y - min_y;
+// BitsetMorphology mirrors BinaryMorphology for masks that are packed into bitsets, 32 cells per Uint32 word.
+// Cell i of a bitset is bit (i % 32) of word floor(i / 32). Bits past the last cell of a grid are always 0.
+// Boolean operations work on whole words, "count" finds area with a popcount,
+//   and dilation/erosion decide whole words at once wherever a word and its neighbors agree, see "get_neighborhood".
+// Bitsets are 8x smaller than the Uint8Arrays of BinaryMorphology, and convert to and from them with "pack" and "unpack".
+var BitsetMorphology = {};
+BitsetMorphology.Bitset = function(grid) {
+    var result = new Uint32Array(RasterArrayBuffer(grid, BitsetMorphology.get_word_count(grid.vertices.length) * Uint32Array.BYTES_PER_ELEMENT));
+    result.grid = grid;
+    return result;
+}
+// "get_word_count" returns the number of words in a bitset of "cell_count" cells
+BitsetMorphology.get_word_count = function(cell_count) {
+    return (cell_count + 31) >>> 5;
+}
+// "get_tail_mask" returns the bits of the last word of a bitset of "cell_count" cells that belong to cells
+BitsetMorphology.get_tail_mask = function(cell_count) {
+    var tail_length = cell_count & 31;
+    return tail_length === 0? 0xFFFFFFFF : ((1 << tail_length) - 1) >>> 0;
+}
+// "neighborhoods" are indexed by grid, since they never change once a grid is created
+BitsetMorphology.neighborhoods = new WeakMap();
+// "get_neighborhood" returns, for each word of a bitset of "grid", the other words that hold neighbors of its cells,
+//   along with masks of which bits within those words are neighbors, stored as compressed sparse rows:
+//   the neighbors of word i are "words[j]" and "masks[j]" for j from "offsets[i]" up to but excluding "offsets[i+1]".
+// Since grid cells are numbered so that nearby cells have nearby ids, each word has only a few neighboring words,
+//   so a word can be tested against all of its neighbors at once by "dilation" and "erosion".
+BitsetMorphology.get_neighborhood = function(grid) {
+    var neighborhood = BitsetMorphology.neighborhoods.get(grid);
+    if (neighborhood !== void 0) {
+        return neighborhood;
+    }
+    var word_count = BitsetMorphology.get_word_count(grid.vertices.length);
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var offsets = new Uint32Array(word_count+1);
+    var words = [];
+    var masks = [];
+    var word_masks = new Map();
+    for (var w = 0; w < word_count; w++) {
+        offsets[w] = words.length;
+        word_masks.clear();
+        for (var i = w << 5, li = Math.min(i + 32, grid.vertices.length); i < li; i++) {
+            for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+                var neighbor = arrow_to[j];
+                var neighbor_word = neighbor >>> 5;
+                if (neighbor_word !== w) {
+                    word_masks.set(neighbor_word, (word_masks.get(neighbor_word) || 0) | (1 << (neighbor & 31)));
+                }
+            }
+        }
+        word_masks.forEach(function(mask, neighbor_word) {
+            words.push(neighbor_word);
+            masks.push(mask >>> 0);
+        });
+    }
+    offsets[word_count] = words.length;
+    neighborhood = { offsets: offsets, words: new Uint32Array(words), masks: new Uint32Array(masks) };
+    BitsetMorphology.neighborhoods.set(grid, neighborhood);
+    return neighborhood;
+}
+// "pack" converts "field", a Uint8Array as used by BinaryMorphology, to a bitset
+BitsetMorphology.pack = function(field, result) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if (!(field instanceof Uint8Array)) { throw "field" + ' is not a ' + "Uint8Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    var word = 0;
+    for (var w = 0, i = 0, li = field.length, lw = result.length; w < lw; w++) {
+        word = 0;
+        for (var b = 0; b < 32 && i < li; b++, i++) {
+            word |= (field[i] === 1? 1:0) << b;
+        }
+        result[w] = word;
+    }
+    return result;
+}
+// "unpack" converts "bitset" to a Uint8Array as used by BinaryMorphology
+BitsetMorphology.unpack = function(bitset, result) {
+    result = result || Uint8Raster(bitset.grid);
+    if (!(bitset instanceof Uint32Array)) { throw "bitset" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint8Array)) { throw "result" + ' is not a ' + "Uint8Array"; };
+    for (var i = 0, li = result.length; i < li; i++) {
+        result[i] = (bitset[i >>> 5] >>> (i & 31)) & 1;
+    }
+    return result;
+}
+// "get_ids" is the counterpart of "Uint8Raster.get_ids": bit i of the result is the bit of "bitset" at "id_array[i]"
+BitsetMorphology.get_ids = function(bitset, id_array, result) {
+    result = result || BitsetMorphology.Bitset(id_array.grid);
+    if (!(bitset instanceof Uint32Array)) { throw "bitset" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    var word = 0;
+    var id = 0;
+    for (var w = 0, i = 0, li = id_array.length, lw = result.length; w < lw; w++) {
+        word = 0;
+        for (var b = 0; b < 32 && i < li; b++, i++) {
+            id = id_array[i];
+            word |= ((bitset[id >>> 5] >>> (id & 31)) & 1) << b;
+        }
+        result[w] = word;
+    }
+    return result;
+}
+BitsetMorphology.universal = function(result) {
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    result.fill(0xFFFFFFFF);
+    result[result.length-1] = BitsetMorphology.get_tail_mask(result.grid.vertices.length);
+}
+BitsetMorphology.empty = function(result) {
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    result.fill(0);
+}
+BitsetMorphology.union = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    if (!(field1 instanceof Uint32Array)) { throw "field1" + ' is not a ' + "Uint32Array"; };
+    if (!(field2 instanceof Uint32Array)) { throw "field2" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] | field2[w];
+    }
+    return result;
+}
+BitsetMorphology.intersection = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    if (!(field1 instanceof Uint32Array)) { throw "field1" + ' is not a ' + "Uint32Array"; };
+    if (!(field2 instanceof Uint32Array)) { throw "field2" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] & field2[w];
+    }
+    return result;
+}
+BitsetMorphology.difference = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    if (!(field1 instanceof Uint32Array)) { throw "field1" + ' is not a ' + "Uint32Array"; };
+    if (!(field2 instanceof Uint32Array)) { throw "field2" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] & ~field2[w];
+    }
+    return result;
+}
+BitsetMorphology.negation = function(field, result) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    for (var w = 0, lw = field.length; w < lw; ++w) {
+        result[w] = ~field[w];
+    }
+    // NOTE: bits past the last cell must stay 0, so that "count" and whole word tests stay correct
+    result[field.length-1] &= BitsetMorphology.get_tail_mask(field.grid.vertices.length);
+    return result;
+}
+// "count" returns the number of cells that are set within "field"
+BitsetMorphology.count = function(field) {
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    var count = 0;
+    var word = 0;
+    for (var w = 0, lw = field.length; w < lw; ++w) {
+        // population count, see "Bit Twiddling Hacks" by Sean Eron Anderson
+        word = field[w];
+        word = word - ((word >>> 1) & 0x55555555);
+        word = (word & 0x33333333) + ((word >>> 2) & 0x33333333);
+        count += Math.imul((word + (word >>> 4)) & 0x0F0F0F0F, 0x01010101) >>> 24;
+    }
+    return count;
+}
+// "dilate_once" sets each cell of "result" that is set in "field", or that neighbors a cell set in "field"
+// Words with no set cells among themselves or their neighbors are left empty, and full words are left full,
+//   so only words near the border of the mask are visited cell by cell.
+BitsetMorphology.dilate_once = function(field, grid, result) {
+    var neighborhood = BitsetMorphology.get_neighborhood(grid);
+    var offsets = neighborhood.offsets;
+    var words = neighborhood.words;
+    var masks = neighborhood.masks;
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var last_word = field.length-1;
+    var cell_count = grid.vertices.length;
+    var tail_mask = BitsetMorphology.get_tail_mask(cell_count);
+    var word = 0;
+    var nearby = 0;
+    var result_word = 0;
+    var neighbor = 0;
+    for (var w = 0; w <= last_word; w++) {
+        word = field[w];
+        nearby = word;
+        for (var j = offsets[w], lj = offsets[w+1]; j < lj; j++) {
+            nearby |= field[words[j]] & masks[j];
+        }
+        if (nearby === 0 || word === (w === last_word? tail_mask : 0xFFFFFFFF)) {
+            result[w] = word;
+            continue;
+        }
+        result_word = word;
+        for (var b = 0, i = w << 5; b < 32 && i < cell_count; b++, i++) {
+            if ((word >>> b) & 1) { continue; }
+            for (var k = arrow_offsets[i], lk = arrow_offsets[i+1]; k < lk; k++) {
+                neighbor = arrow_to[k];
+                if ((field[neighbor >>> 5] >>> (neighbor & 31)) & 1) {
+                    result_word |= 1 << b;
+                    break;
+                }
+            }
+        }
+        result[w] = result_word;
+    }
+}
+// "erode_once" sets each cell of "result" that is set in "field", and whose neighbors are all set in "field"
+// Empty words are left empty, and full words whose neighbors are all set are left full,
+//   so only words near the border of the mask are visited cell by cell.
+BitsetMorphology.erode_once = function(field, grid, result) {
+    var neighborhood = BitsetMorphology.get_neighborhood(grid);
+    var offsets = neighborhood.offsets;
+    var words = neighborhood.words;
+    var masks = neighborhood.masks;
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var last_word = field.length-1;
+    var cell_count = grid.vertices.length;
+    var tail_mask = BitsetMorphology.get_tail_mask(cell_count);
+    var word = 0;
+    var is_surrounded = true;
+    var result_word = 0;
+    var neighbor = 0;
+    for (var w = 0; w <= last_word; w++) {
+        word = field[w];
+        if (word === 0) {
+            result[w] = 0;
+            continue;
+        }
+        if (word === (w === last_word? tail_mask : 0xFFFFFFFF)) {
+            is_surrounded = true;
+            for (var j = offsets[w], lj = offsets[w+1]; j < lj && is_surrounded; j++) {
+                is_surrounded = ((field[words[j]] & masks[j]) >>> 0) === masks[j];
+            }
+            if (is_surrounded) {
+                result[w] = word;
+                continue;
+            }
+        }
+        result_word = word;
+        for (var b = 0, i = w << 5; b < 32 && i < cell_count; b++, i++) {
+            if (((word >>> b) & 1) === 0) { continue; }
+            for (var k = arrow_offsets[i], lk = arrow_offsets[i+1]; k < lk; k++) {
+                neighbor = arrow_to[k];
+                if (((field[neighbor >>> 5] >>> (neighbor & 31)) & 1) === 0) {
+                    result_word &= ~(1 << b);
+                    break;
+                }
+            }
+        }
+        result[w] = result_word;
+    }
+}
+BitsetMorphology.dilation = function(field, radius, result, scratch) {
+    radius = radius || 1;
+    result = result || BitsetMorphology.Bitset(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.dilation');
+    scratch = scratch || pool.getBitset(field.grid);
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    var buffer1 = radius % 2 == 1? result: scratch;
+    var buffer2 = radius % 2 == 0? result: scratch;
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
+    var temp = buffer1;
+    for (var k=0; k<radius; ++k) {
+        BitsetMorphology.dilate_once(buffer2, field.grid, buffer1);
+        temp = buffer1;
+        buffer1 = buffer2;
+        buffer2 = temp;
+    }
+    pool.deallocate('BitsetMorphology.dilation');
+    return buffer2;
+}
+BitsetMorphology.erosion = function(field, radius, result, scratch) {
+    radius = radius || 1;
+    result = result || BitsetMorphology.Bitset(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.erosion');
+    scratch = scratch || pool.getBitset(field.grid);
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    var buffer1 = radius % 2 == 1? result: scratch;
+    var buffer2 = radius % 2 == 0? result: scratch;
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
+    var temp = buffer1;
+    for (var k=0; k<radius; ++k) {
+        BitsetMorphology.erode_once(buffer2, field.grid, buffer1);
+        temp = buffer1;
+        buffer1 = buffer2;
+        buffer2 = temp;
+    }
+    pool.deallocate('BitsetMorphology.erosion');
+    return buffer2;
+}
+// see "BinaryMorphology.margin"
+BitsetMorphology.margin = function(field, radius, result, scratch) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.margin');
+    scratch = scratch || pool.getBitset(field.grid);
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    if (!(scratch instanceof Uint32Array)) { throw "scratch" + ' is not a ' + "Uint32Array"; };
+    var dilation = result; // reuse result raster for performance reasons
+    BitsetMorphology.dilation(field, radius, dilation, scratch);
+    BitsetMorphology.difference(dilation, field, result);
+    pool.deallocate('BitsetMorphology.margin');
+    return result;
+}
+// see "BinaryMorphology.padding"
+BitsetMorphology.padding = function(field, radius, result, scratch) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.padding');
+    scratch = scratch || pool.getBitset(field.grid);
+    if (!(field instanceof Uint32Array)) { throw "field" + ' is not a ' + "Uint32Array"; };
+    if (!(result instanceof Uint32Array)) { throw "result" + ' is not a ' + "Uint32Array"; };
+    if (!(scratch instanceof Uint32Array)) { throw "scratch" + ' is not a ' + "Uint32Array"; };
+    var erosion = result; // reuse result raster for performance reasons
+    BitsetMorphology.erosion(field, radius, erosion, scratch);
+    BitsetMorphology.difference(field, erosion, result);
+    pool.deallocate('BitsetMorphology.padding');
+    return result;
+}
+// The RasterKernels namespace contains the loops of raster operations that can be run in parallel by a RasterWorkerPool.
+// Kernels are called as "kernel(args, grid, start, end)", where:
+//   "args" is an object that only contains typed arrays and numbers, so that it can be posted to workers,
+//   "grid" is either a Grid or a copy of its arrays in shared memory, see "RasterWorkerPool.prototype.get_shared_grid",
+//   "start" and "end" are the range of cells that the kernel must write to.
+// A kernel must only write to cells in [start, end) of its outputs, so that partitions never write to the same cell.
+// Arrow-wise kernels visit the arrows that start from cells within that range, 
+//   which thanks to Grid sorting arrows by the cell they start from, are the arrows within [arrow_offsets[start], arrow_offsets[end]).
+// Raster operations such as ScalarField.laplacian() call kernels through "RasterWorkerPool.run", never directly.
+var RasterKernels = {};
+RasterKernels.add_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + b[i];
+  }
+};
+RasterKernels.sub_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] - b[i];
+  }
+};
+RasterKernels.mult_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] * b[i];
+  }
+};
+RasterKernels.add_scalar = function(args, grid, start, end) {
+  var a = args.a, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + scalar;
+  }
+};
+RasterKernels.mult_scalar = function(args, grid, start, end) {
+  var a = args.a, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] * scalar;
+  }
+};
+RasterKernels.add_scalar_term = function(args, grid, start, end) {
+  var a = args.a, b = args.b, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + scalar * b[i];
+  }
+};
+RasterKernels.add_field_product = function(args, grid, start, end) {
+  var a = args.a, b = args.b, c = args.c, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + c[i] * b[i];
+  }
+};
+RasterKernels.magnitude = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z, result = args.result;
+  var sqrt = Math.sqrt;
+  var xi = 0., yi = 0., zi = 0.;
+  for (var i = start; i < end; i++) {
+    xi = x[i];
+    yi = y[i];
+    zi = z[i];
+    result[i] = sqrt(xi * xi + yi * yi + zi * zi);
+  }
+};
+RasterKernels.normalize = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z;
+  var ox = args.ox, oy = args.oy, oz = args.oz;
+  var sqrt = Math.sqrt;
+  var xi = 0., yi = 0., zi = 0., mag = 0.;
+  for (var i = start; i < end; i++) {
+    xi = x[i];
+    yi = y[i];
+    zi = z[i];
+    mag = sqrt(xi * xi + yi * yi + zi * zi);
+    ox[i] = xi/(mag||1);
+    oy[i] = yi/(mag||1);
+    oz[i] = zi/(mag||1);
+  }
+};
+RasterKernels.clamp = function(args, grid, start, end) {
+  var x = args.x, min_value = args.min_value, max_value = args.max_value, result = args.result;
+  var x_i = 0.;
+  for (var i = start; i < end; i++) {
+    x_i = x[i];
+    result[i] = x_i > max_value? max_value : x_i < min_value? min_value : x_i;
+  }
+};
+RasterKernels.linearstep = function(args, grid, start, end) {
+  var x = args.x, edge0 = args.edge0, result = args.result;
+  var inverse_edge_distance = 1 / (args.edge1 - edge0);
+  var fraction = 0.;
+  for (var i = start; i < end; i++) {
+    fraction = (x[i] - edge0) * inverse_edge_distance;
+    result[i] = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+  }
+};
+RasterKernels.smoothstep = function(args, grid, start, end) {
+  var x = args.x, edge0 = args.edge0, result = args.result;
+  var inverse_edge_distance = 1 / (args.edge1 - edge0);
+  var fraction = 0.;
+  var linearstep = 0.;
+  for (var i = start; i < end; i++) {
+    fraction = (x[i] - edge0) * inverse_edge_distance;
+    linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+    result[i] = linearstep*linearstep*(3-2*linearstep);
+  }
+};
+// quantization kernels, see "QuantizedRaster"
+RasterKernels.encode_fixed16 = function(args, grid, start, end) {
+  var x = args.x, offset = args.offset, result = args.result;
+  var inverse_scale = 1 / args.scale;
+  var q = 0.;
+  for (var i = start; i < end; i++) {
+    q = Math.round((x[i] - offset) * inverse_scale);
+    // NOTE: NaN fails both comparisons, so it is stored as 0
+    result[i] = q > 65535? 65535 : q > 0? q : 0;
+  }
+};
+RasterKernels.decode_fixed16 = function(args, grid, start, end) {
+  var x = args.x, offset = args.offset, scale = args.scale, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = offset + scale * x[i];
+  }
+};
+// "encode_float16" rounds to the nearest half precision float, with ties to even,
+//   by operating on the bits of each 32 bit float. Magnitudes above 65504 become infinite.
+RasterKernels.encode_float16 = function(args, grid, start, end) {
+  var x = args.x, result = args.result;
+  var float = new Float32Array(1);
+  var bits = new Uint32Array(float.buffer);
+  var b = 0, sign = 0, exponent = 0, mantissa = 0, shift = 0, remainder = 0, halfway = 0, h = 0;
+  for (var i = start; i < end; i++) {
+    float[0] = x[i];
+    b = bits[0];
+    sign = (b >>> 16) & 0x8000;
+    exponent = ((b >>> 23) & 0xff) - 127 + 15;
+    mantissa = b & 0x7fffff;
+    if (exponent === 0xff - 127 + 15) {
+      // infinity, or NaN
+      h = sign | 0x7c00 | (mantissa !== 0? 0x200 : 0);
+    } else if (exponent >= 0x1f) {
+      h = sign | 0x7c00;
+    } else if (exponent <= 0) {
+      // subnormal, or too small to represent
+      if (exponent < -10) {
+        h = sign;
+      } else {
+        mantissa = mantissa | 0x800000;
+        shift = 14 - exponent;
+        h = mantissa >>> shift;
+        remainder = mantissa & ((1 << shift) - 1);
+        halfway = 1 << (shift - 1);
+        if (remainder > halfway || (remainder === halfway && (h & 1))) { h++; }
+        h = sign | h;
+      }
+    } else {
+      h = (exponent << 10) | (mantissa >>> 13);
+      remainder = mantissa & 0x1fff;
+      // NOTE: a carry out of the mantissa correctly increments the exponent, and rounds to infinity past 65504
+      if (remainder > 0x1000 || (remainder === 0x1000 && (h & 1))) { h++; }
+      h = sign | h;
+    }
+    result[i] = h;
+  }
+};
+RasterKernels.decode_float16 = function(args, grid, start, end) {
+  var x = args.x, result = args.result;
+  var float = new Float32Array(1);
+  var bits = new Uint32Array(float.buffer);
+  var h = 0, sign = 0, exponent = 0, mantissa = 0;
+  for (var i = start; i < end; i++) {
+    h = x[i];
+    sign = (h & 0x8000) << 16;
+    exponent = (h >>> 10) & 0x1f;
+    mantissa = h & 0x3ff;
+    if (exponent === 0) {
+      // subnormal, or zero
+      result[i] = (sign? -1 : 1) * mantissa * 5.960464477539063e-8; // 2^-24
+    } else {
+      bits[0] = sign | ((exponent === 0x1f? 0xff : exponent - 15 + 127) << 23) | (mantissa << 13);
+      result[i] = float[0];
+    }
+  }
+};
+// arrow-wise kernels
+RasterKernels.average_difference = function(args, grid, start, end) {
+  var field = args.field, result = args.result, scale = args.scale;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var field_i = 0.;
+  var sum = 0.;
+  for (var i = start; i < end; i++) {
+    field_i = field[i];
+    sum = 0.;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      sum += field[arrow_to[j]] - field_i;
+    }
+    result[i] = sum / (scale * neighbor_count[i]);
+  }
+};
+RasterKernels.gradient = function(args, grid, start, end) {
+  var field = args.field;
+  var x = args.x, y = args.y, z = args.z;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var dlength = grid.pos_arrow_distances;
+  var dxhat = grid.pos_arrow_differential_normalized.x;
+  var dyhat = grid.pos_arrow_differential_normalized.y;
+  var dzhat = grid.pos_arrow_differential_normalized.z;
+  var average_distance = grid.average_distance;
+  var PI = Math.PI;
+  var inverse_volume = 1 / (PI * (average_distance/2) * (average_distance/2));
+  var difference = 0.;
+  var xi = 0., yi = 0., zi = 0.;
+  for (var i = start; i < end; i++) {
+    xi = 0.;
+    yi = 0.;
+    zi = 0.;
+    // see ScalarField.gradient for why this is weighted the way it is
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      difference = field[arrow_to[j]] - field[i];
+      xi += difference * dxhat[j] * dlength[j]/neighbor_count[i] * PI;
+      yi += difference * dyhat[j] * dlength[j]/neighbor_count[i] * PI;
+      zi += difference * dzhat[j] * dlength[j]/neighbor_count[i] * PI;
+    }
+    x[i] = xi * inverse_volume;
+    y[i] = yi * inverse_volume;
+    z[i] = zi * inverse_volume;
+  }
+};
+RasterKernels.divergence = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var dlength = grid.pos_arrow_distances;
+  var dxhat = grid.pos_arrow_differential_normalized.x;
+  var dyhat = grid.pos_arrow_differential_normalized.y;
+  var dzhat = grid.pos_arrow_differential_normalized.z;
+  var to = 0;
+  var sum = 0.;
+  for (var i = start; i < end; i++) {
+    sum = 0.;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      to = arrow_to[j];
+      sum += ( (x[to] - x[i]) * dxhat[j]
+              +(y[to] - y[i]) * dyhat[j]
+              +(z[to] - z[i]) * dzhat[j]) / dlength[j];
+    }
+    result[i] = sum / (neighbor_count[i] || 1);
+  }
+};
+RasterKernels.dilation = function(args, grid, start, end) {
+  var field = args.field, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var result_i = false;
+  for (var i = start; i < end; i++) {
+    result_i = field[i] === 1;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj && !result_i; j++) {
+      result_i = field[arrow_to[j]] === 1;
+    }
+    result[i] = result_i? 1:0;
+  }
+};
+RasterKernels.erosion = function(args, grid, start, end) {
+  var field = args.field, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var result_i = true;
+  for (var i = start; i < end; i++) {
+    result_i = field[i] === 1;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj && result_i; j++) {
+      result_i = field[arrow_to[j]] === 1;
+    }
+    result[i] = result_i? 1:0;
+  }
+};
+// RasterWasmKernels runs a subset of "RasterKernels.js" using "postcompiled/RasterKernels.wasm",
+//   which is built from "precompiled/cpp/raster_kernels.cpp" by "make wasm", using 128 bit SIMD.
+// WebAssembly can only read its own memory, so kernels only run here if every raster they are given
+//   is a Float32Array that lives within that memory. Otherwise, the JS kernel runs instead.
+// Only temporary rasters from the scratchpad ever live there: the fields of models are allocated
+//   by "RasterArrayBuffer" in memory of their own, so operations on them are out of scope, and always run in JS.
+// Once loaded, "RasterStackBuffer.scratchpad" is replaced by a buffer within that memory,
+//   so temporary rasters that are requested from the scratchpad are eligible.
+// A shared scratchpad belongs to a "RasterWorkerPool" instead, so it is never replaced:
+//   the workers can't see the memory of this module, and the pool would stop dispatching to them.
+// The memory is created with a fixed size, so it never grows, and views into it are never detached.
+// If the module fails to load, for instance if the browser does not support SIMD, nothing changes.
+// The module is not committed, since it needs a clang that targets wasm32, so it is only loaded if enabled.
+var RasterWasmKernels = {};
+// whether the module should be loaded, which is set under "?wasm", once "make wasm" has built it
+RasterWasmKernels.is_enabled = false;
+// the exports of the module, if it has loaded
+RasterWasmKernels.exports = void 0;
+RasterWasmKernels.memory = void 0;
+// "load" fetches and instantiates the module, returning a promise that resolves to whether it loaded
+// Failures are silent, since the JS kernels are always there to fall back to.
+// "byte_length" is the size of the scratchpad, and defaults to the size of the scratchpad it replaces
+RasterWasmKernels.load = function(url, byte_length) {
+    url = url || 'postcompiled/RasterKernels.wasm';
+    byte_length = byte_length || RasterStackBuffer.scratchpad.buffer.byteLength;
+    if (typeof WebAssembly === 'undefined' || typeof fetch === 'undefined') {
+        return Promise.resolve(false);
+    }
+    var page_byte_length = 65536;
+    // NOTE: extra pages are reserved for the data and stack of the module, which live below "__heap_base"
+    var page_count = Math.ceil(byte_length / page_byte_length) + 16;
+    var memory = new WebAssembly.Memory({ initial: page_count, maximum: page_count });
+    return fetch(url)
+        .then(function(response) {
+            if (!response.ok) {
+                throw `RasterWasmKernels: could not fetch "${url}"`;
+            }
+            return response.arrayBuffer();
+        })
+        .then(function(bytes) { return WebAssembly.instantiate(bytes, { env: { memory: memory } }); })
+        .then(function(result) {
+            var exports = result.instance.exports;
+            var heap_base = exports.__heap_base !== void 0? exports.__heap_base.value : 0;
+            RasterWasmKernels.exports = exports;
+            RasterWasmKernels.memory = memory;
+            // NOTE: load() resolves between simulation steps, when nothing has been allocated from the scratchpad
+            var scratchpad = RasterStackBuffer.scratchpad;
+            var is_shared = typeof SharedArrayBuffer !== 'undefined' && scratchpad.buffer instanceof SharedArrayBuffer;
+            if (scratchpad.stack.length === 0 && !is_shared) {
+                RasterStackBuffer.scratchpad = RasterStackBuffer.FromArrayBuffer(memory.buffer, heap_base);
+            }
+            return true;
+        })
+        .catch(function() {
+            return false;
+        });
+}
+// "adapters" map the "args" of a JS kernel onto the parameters of its export
+// Rasters are passed as byte offsets into memory, followed by the range of cells to write to.
+RasterWasmKernels.adapters = {
+    add_field: function(e, args, start, end) { e.add_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    sub_field: function(e, args, start, end) { e.sub_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    mult_field: function(e, args, start, end) { e.mult_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    add_scalar: function(e, args, start, end) { e.add_scalar(args.a.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    mult_scalar: function(e, args, start, end) { e.mult_scalar(args.a.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    add_scalar_term: function(e, args, start, end) { e.add_scalar_term(args.a.byteOffset, args.b.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    add_field_product: function(e, args, start, end) { e.add_field_product(args.a.byteOffset, args.b.byteOffset, args.c.byteOffset, args.result.byteOffset, start, end); },
+    clamp: function(e, args, start, end) { e.clamp(args.x.byteOffset, args.min_value, args.max_value, args.result.byteOffset, start, end); },
+    linearstep: function(e, args, start, end) { e.linearstep(args.x.byteOffset, args.edge0, args.edge1, args.result.byteOffset, start, end); },
+    smoothstep: function(e, args, start, end) { e.smoothstep(args.x.byteOffset, args.edge0, args.edge1, args.result.byteOffset, start, end); },
+    magnitude: function(e, args, start, end) { e.magnitude(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.result.byteOffset, start, end); },
+    normalize: function(e, args, start, end) {
+        e.normalize(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.ox.byteOffset, args.oy.byteOffset, args.oz.byteOffset, start, end);
+    },
+    nearest_cell_ids: function(e, args, start, end) {
+        e.nearest_cell_ids(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.cell_width, args.dimension_x, args.dimension_y, args.result.byteOffset, start, end);
+    },
+};
+// "array_types" lists the arguments of kernels that are typed arrays other than Float32Arrays, along with their types
+RasterWasmKernels.array_types = {
+    nearest_cell_ids: { result: Uint32Array },
+};
+// "can_run" indicates whether "kernel_name" has an export, and every typed array in "args" is of its expected type within its memory
+// Typed arrays are expected to be Float32Arrays unless listed in "array_types".
+RasterWasmKernels.can_run = function(kernel_name, args) {
+    if (RasterWasmKernels.exports === void 0 || RasterWasmKernels.exports[kernel_name] === void 0 || RasterWasmKernels.adapters[kernel_name] === void 0) {
+        return false;
+    }
+    var buffer = RasterWasmKernels.memory.buffer;
+    var types = RasterWasmKernels.array_types[kernel_name] || {};
+    var value;
+    for (var key in args) {
+        value = args[key];
+        if (ArrayBuffer.isView(value) && !(value instanceof (types[key] || Float32Array) && value.buffer === buffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+RasterWasmKernels.run = function(kernel_name, args, start, end) {
+    RasterWasmKernels.adapters[kernel_name](RasterWasmKernels.exports, args, start, end);
+}
+// RasterGpuKernels runs iterated neighbor stencils, such as many iterations of diffusion, on the gpu using WebGL.
+// Rasters are uploaded to float textures once, iterated by rendering back and forth between two float render targets,
+//   and read back only once every iteration is done, see "diffusion.glsl.c" for how rasters and grids are laid out.
+// It renders using its own context on an offscreen canvas, rather than the context of the view,
+//   so that it never disturbs the state that three.js keeps for its context, and so that it also works within workers.
+// The gpu adds in 32 bit floats, whereas RasterKernels adds in 64 bit floats, so results differ within float precision.
+// If the context can not be created, or can not render to float textures and read them back, nothing changes:
+//   "can_run" returns false, and callers run RasterKernels instead.
+var RasterGpuKernels = {};
+// the context, if it loaded
+RasterGpuKernels.gl = void 0;
+RasterGpuKernels.programs = {};
+// the number of iterations below which the cost of uploading and reading back rasters exceeds what the gpu saves
+RasterGpuKernels.MIN_ITERATION_COUNT = 4;
+// NOTE: this must match the number of calls to add_neighbor() in "diffusion.glsl.c"
+RasterGpuKernels.MAX_NEIGHBOR_COUNT = 8;
+RasterGpuKernels.vertex_shader = `
+// "quad.glsl.c" covers the render target of a compute shader with a quad whose corners are given in clip space,
+//   see RasterGpuKernels.js. Compute shaders find which texel they are writing from gl_FragCoord, so nothing is passed on.
+attribute vec2 position;
+void main() {
+    gl_Position = vec4(position, 0., 1.);
+}
+`;
+RasterGpuKernels.fragment_shaders = {};
+RasterGpuKernels.fragment_shaders.diffusion = `
+// NOTE: these macros are here to allow porting the code between several languages
+// "diffusion.glsl.c" runs one iteration of the diffusion equation over the cells of a grid, see RasterGpuKernels.js.
+// It matches ScalarField.diffusion_by_constant, or ScalarField.diffusion_by_field if "has_diffusivity_texture" is set.
+// Rasters are stored in float textures with one cell per texel, in order of cell id, 
+//   in rows that are "texture_size.x" texels wide. Only the red channel is used.
+// The ids of the neighbors of each cell are stored in the same order, four per texel across two textures,
+//   where missing neighbors are given an id of -1.
+precision highp float;
+uniform sampler2D field_texture;
+uniform sampler2D neighbor_ids_texture0;
+uniform sampler2D neighbor_ids_texture1;
+uniform sampler2D diffusivity_texture;
+uniform bool has_diffusivity_texture;
+uniform float diffusivity;
+uniform vec2 texture_size;
+// NOTE: "texture_size.x" is a power of two, so division and floor() are exact for any id below 2^24
+float get_field_value(in float id) {
+    float row = floor(id / texture_size.x);
+    vec2 texel = vec2(id - row * texture_size.x, row);
+    return texture2D(field_texture, (texel + 0.5) / texture_size).r;
+}
+void add_neighbor(in float id, in float field_i, inout float sum, inout float neighbor_count) {
+    if (id >= 0.) {
+        sum += get_field_value(id) - field_i;
+        neighbor_count += 1.;
+    }
+}
+void main() {
+    vec2 uv = gl_FragCoord.xy / texture_size;
+    float field_i = texture2D(field_texture, uv).r;
+    vec4 ids0 = texture2D(neighbor_ids_texture0, uv);
+    vec4 ids1 = texture2D(neighbor_ids_texture1, uv);
+    float sum = 0.;
+    float neighbor_count = 0.;
+    add_neighbor(ids0.x, field_i, sum, neighbor_count);
+    add_neighbor(ids0.y, field_i, sum, neighbor_count);
+    add_neighbor(ids0.z, field_i, sum, neighbor_count);
+    add_neighbor(ids0.w, field_i, sum, neighbor_count);
+    add_neighbor(ids1.x, field_i, sum, neighbor_count);
+    add_neighbor(ids1.y, field_i, sum, neighbor_count);
+    add_neighbor(ids1.z, field_i, sum, neighbor_count);
+    add_neighbor(ids1.w, field_i, sum, neighbor_count);
+    // see RasterKernels.average_difference
+    float laplacian = sum / max(neighbor_count, 1.);
+    float k = has_diffusivity_texture? texture2D(diffusivity_texture, uv).r : diffusivity;
+    gl_FragColor = vec4(field_i + k * laplacian, 0., 0., 1.);
+}
+`;
+// "load" creates the context and compiles its programs, returning whether it succeeded
+RasterGpuKernels.load = function() {
+    var canvas =
+        typeof OffscreenCanvas !== 'undefined'? new OffscreenCanvas(1, 1) :
+        typeof document !== 'undefined'? document.createElement('canvas') : void 0;
+    var gl = canvas !== void 0 && canvas.getContext? canvas.getContext('webgl', { antialias: false, depth: false, stencil: false }) : void 0;
+    if (!gl || !gl.getExtension('OES_texture_float')) {
+        return false;
+    }
+    gl.getExtension('WEBGL_color_buffer_float');
+    try {
+        RasterGpuKernels.programs.diffusion = RasterGpuKernels.get_program(gl, RasterGpuKernels.vertex_shader, RasterGpuKernels.fragment_shaders.diffusion);
+    } catch (error) {
+        console.log(error);
+        return false;
+    }
+    if (!RasterGpuKernels.is_float_readable(gl)) {
+        return false;
+    }
+    // every program draws the same quad
+    var quad = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, quad);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array([-1,-1, 1,-1, -1,1, 1,1]), gl.STATIC_DRAW);
+    gl.disable(gl.DEPTH_TEST);
+    gl.disable(gl.BLEND);
+    RasterGpuKernels.gl = gl;
+    RasterGpuKernels.grid_states = new WeakMap();
+    return true;
+}
+RasterGpuKernels.get_program = function(gl, vertex_source, fragment_source) {
+    function get_shader(type, source) {
+        var shader = gl.createShader(type);
+        gl.shaderSource(shader, source);
+        gl.compileShader(shader);
+        if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+            throw `RasterGpuKernels: could not compile shader: ${gl.getShaderInfoLog(shader)}`;
+        }
+        return shader;
+    }
+    var program = gl.createProgram();
+    gl.attachShader(program, get_shader(gl.VERTEX_SHADER, vertex_source));
+    gl.attachShader(program, get_shader(gl.FRAGMENT_SHADER, fragment_source));
+    gl.bindAttribLocation(program, 0, 'position');
+    gl.linkProgram(program);
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+        throw `RasterGpuKernels: could not link program: ${gl.getProgramInfoLog(program)}`;
+    }
+    var uniforms = {};
+    for (var i = 0, li = gl.getProgramParameter(program, gl.ACTIVE_UNIFORMS); i < li; i++) {
+        var name = gl.getActiveUniform(program, i).name;
+        uniforms[name] = gl.getUniformLocation(program, name);
+    }
+    return { program: program, uniforms: uniforms };
+}
+// "is_float_readable" indicates whether a float texture can be rendered to, then read back without loss
+// WebGL only guarantees reading back bytes, so this is checked by reading back a value that bytes can not represent.
+RasterGpuKernels.is_float_readable = function(gl) {
+    var target = RasterGpuKernels.get_render_target(gl, 1, 1);
+    var is_readable = gl.checkFramebufferStatus(gl.FRAMEBUFFER) === gl.FRAMEBUFFER_COMPLETE;
+    if (is_readable) {
+        var pixel = new Float32Array(4);
+        gl.clearColor(0.3125, 0, 0, 1);
+        gl.clear(gl.COLOR_BUFFER_BIT);
+        gl.readPixels(0, 0, 1, 1, gl.RGBA, gl.FLOAT, pixel);
+        is_readable = gl.getError() === gl.NO_ERROR && pixel[0] === 0.3125;
+    }
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    gl.deleteFramebuffer(target.framebuffer);
+    gl.deleteTexture(target.texture);
+    return is_readable;
+}
+RasterGpuKernels.get_texture = function(gl, width, height, format, data) {
+    var texture = gl.createTexture();
+    gl.bindTexture(gl.TEXTURE_2D, texture);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    gl.texImage2D(gl.TEXTURE_2D, 0, format, width, height, 0, format, gl.FLOAT, data || null);
+    return texture;
+}
+// "get_render_target" returns an RGBA float texture that is attached to a framebuffer, leaving the framebuffer bound
+RasterGpuKernels.get_render_target = function(gl, width, height) {
+    var texture = RasterGpuKernels.get_texture(gl, width, height, gl.RGBA);
+    var framebuffer = gl.createFramebuffer();
+    gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+    gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, texture, 0);
+    return { texture: texture, framebuffer: framebuffer };
+}
+// "get_texture_width" returns the width of textures for a grid of "cell_count" cells,
+//   a power of two so that ids convert to texels exactly, see "diffusion.glsl.c"
+RasterGpuKernels.get_texture_width = function(cell_count) {
+    return 1 << Math.ceil(Math.log2(Math.max(Math.sqrt(cell_count), 1)));
+}
+// "get_neighbor_ids" returns the ids of the neighbors of each cell of "grid" as laid out in "diffusion.glsl.c",
+//   in the order of "arrow_to", which is the order that RasterKernels.average_difference visits them
+RasterGpuKernels.get_neighbor_ids = function(grid, texel_count) {
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var MAX_NEIGHBOR_COUNT = RasterGpuKernels.MAX_NEIGHBOR_COUNT;
+    var result = [new Float32Array(4*texel_count).fill(-1), new Float32Array(4*texel_count).fill(-1)];
+    for (var i = 0, li = grid.vertices.length; i < li; i++) {
+        for (var j = arrow_offsets[i], k = 0, lj = arrow_offsets[i+1]; j < lj && k < MAX_NEIGHBOR_COUNT; j++, k++) {
+            result[k >> 2][4*i + (k & 3)] = arrow_to[j];
+        }
+    }
+    return result;
+}
+// "get_grid_state" returns the textures, render targets, and staging arrays for rasters of "grid",
+//   or undefined if the gpu can not run kernels for the grid. States are created on first use, then kept for the life of the grid.
+RasterGpuKernels.get_grid_state = function(grid) {
+    var state = RasterGpuKernels.grid_states.get(grid);
+    if (state !== void 0) {
+        return state || void 0;
+    }
+    var gl = RasterGpuKernels.gl;
+    var cell_count = grid.vertices.length;
+    var width = RasterGpuKernels.get_texture_width(cell_count);
+    var height = Math.ceil(cell_count / width);
+    var max_neighbor_count = 0;
+    for (var i = 0; i < cell_count; i++) {
+        max_neighbor_count = Math.max(max_neighbor_count, grid.neighbor_count[i]);
+    }
+    if (max_neighbor_count > RasterGpuKernels.MAX_NEIGHBOR_COUNT || width > gl.getParameter(gl.MAX_TEXTURE_SIZE)) {
+        RasterGpuKernels.grid_states.set(grid, null);
+        return void 0;
+    }
+    var neighbor_ids = RasterGpuKernels.get_neighbor_ids(grid, width * height);
+    state = {
+        width: width,
+        height: height,
+        neighbor_ids_texture0: RasterGpuKernels.get_texture(gl, width, height, gl.RGBA, neighbor_ids[0]),
+        neighbor_ids_texture1: RasterGpuKernels.get_texture(gl, width, height, gl.RGBA, neighbor_ids[1]),
+        field_texture: RasterGpuKernels.get_texture(gl, width, height, gl.LUMINANCE),
+        diffusivity_texture: RasterGpuKernels.get_texture(gl, width, height, gl.LUMINANCE),
+        targets: [RasterGpuKernels.get_render_target(gl, width, height), RasterGpuKernels.get_render_target(gl, width, height)],
+        // rasters are padded to fill whole rows when uploaded, and read back as RGBA
+        upload: new Float32Array(width * height),
+        readback: new Float32Array(4 * width * height),
+    };
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    RasterGpuKernels.grid_states.set(grid, state);
+    return state;
+}
+RasterGpuKernels.upload = function(gl, state, texture, raster) {
+    state.upload.set(raster);
+    gl.bindTexture(gl.TEXTURE_2D, texture);
+    gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, state.width, state.height, gl.LUMINANCE, gl.FLOAT, state.upload);
+}
+RasterGpuKernels.read = function(gl, state, framebuffer, result) {
+    var readback = state.readback;
+    gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+    gl.readPixels(0, 0, state.width, state.height, gl.RGBA, gl.FLOAT, readback);
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    for (var i = 0, li = result.length; i < li; i++) {
+        result[i] = readback[4*i];
+    }
+}
+// "can_run" indicates whether kernels can run on the gpu for rasters of "grid"
+RasterGpuKernels.can_run = function(grid) {
+    var gl = RasterGpuKernels.gl;
+    return gl !== void 0 && !gl.isContextLost() && grid !== void 0 && RasterGpuKernels.get_grid_state(grid) !== void 0;
+}
+// "diffusion" runs "iterations" iterations of ScalarField.diffusion_by_constant,
+//   or of ScalarField.diffusion_by_field if "diffusivity_field" is given, in which case "diffusivity" is ignored.
+// "iterations" must be at least 1, and "result" may be "field".
+RasterGpuKernels.diffusion = function(field, diffusivity, diffusivity_field, iterations, result) {
+    var gl = RasterGpuKernels.gl;
+    var state = RasterGpuKernels.get_grid_state(field.grid);
+    var program = RasterGpuKernels.programs.diffusion;
+    var uniforms = program.uniforms;
+    RasterGpuKernels.upload(gl, state, state.field_texture, field);
+    if (diffusivity_field !== void 0) {
+        RasterGpuKernels.upload(gl, state, state.diffusivity_texture, diffusivity_field);
+    }
+    gl.useProgram(program.program);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+    gl.viewport(0, 0, state.width, state.height);
+    gl.uniform1i(uniforms.field_texture, 0);
+    gl.uniform1i(uniforms.neighbor_ids_texture0, 1);
+    gl.uniform1i(uniforms.neighbor_ids_texture1, 2);
+    gl.uniform1i(uniforms.diffusivity_texture, 3);
+    gl.uniform1i(uniforms.has_diffusivity_texture, diffusivity_field !== void 0? 1 : 0);
+    gl.uniform1f(uniforms.diffusivity, diffusivity);
+    gl.uniform2f(uniforms.texture_size, state.width, state.height);
+    gl.activeTexture(gl.TEXTURE1);
+    gl.bindTexture(gl.TEXTURE_2D, state.neighbor_ids_texture0);
+    gl.activeTexture(gl.TEXTURE2);
+    gl.bindTexture(gl.TEXTURE_2D, state.neighbor_ids_texture1);
+    gl.activeTexture(gl.TEXTURE3);
+    gl.bindTexture(gl.TEXTURE_2D, state.diffusivity_texture);
+    // the first iteration reads the uploaded field, then iterations alternate between render targets
+    var input = state.field_texture;
+    var output = void 0;
+    for (var i = 0; i < iterations; i++) {
+        output = state.targets[i % 2];
+        gl.bindFramebuffer(gl.FRAMEBUFFER, output.framebuffer);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, input);
+        gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+        input = output.texture;
+    }
+    RasterGpuKernels.read(gl, state, output.framebuffer, result);
+    return result;
+}
+// RasterWorkerPool runs the kernels in "RasterKernels.js" across a pool of Web Workers.
+// Each worker loads "postcompiled/Rasters.js" as its script, so workers share every kernel with the thread that calls them.
+//
+// Work is partitioned into contiguous ranges of cells, one per worker plus one for the calling thread.
+// Arrow-wise kernels visit the arrows that start from cells within their range,
+//   which works because Grid sorts arrows by the cell they start from, so no two partitions ever write to the same cell.
+//
+// Workers only see rasters that are allocated in shared memory, see "RasterArrayBuffer".
+// Grid arrays are copied to shared memory once per grid, see "get_shared_grid".
+// Kernels are dispatched synchronously: the calling thread blocks with Atomics.wait() until every partition is done,
+//   so raster operations keep their signatures and callers never notice whether they ran in parallel.
+// Browsers only allow blocking outside the main thread, so kernels run on the calling thread instead if:
+//   the calling thread is the main thread, no pool was started, workers have yet to load,
+//   the raster is too small to be worth it, or any raster is not in shared memory.
+// Shared memory needs cross origin isolation, so the page must be served with these headers,
+//   or through "CrossOriginIsolationWorker.js" where the host can't send them:
+//   Cross-Origin-Opener-Policy: same-origin
+//   Cross-Origin-Embedder-Policy: require-corp
+// The scratchpad is owned by the pool whenever it is shared, and "RasterWasmKernels.load" leaves it alone.
+function RasterWorkerPool(worker_count, script_url) {
+    script_url = script_url || 'postcompiled/Rasters.js';
+    // status[READY_COUNT]:     the number of workers that are ready to run kernels
+    // status[REMAINING_COUNT]: the number of partitions that have yet to finish
+    // status[ERROR_COUNT]:     the number of partitions that threw since the last dispatch
+    this.status = new Int32Array(new SharedArrayBuffer(3 * Int32Array.BYTES_PER_ELEMENT));
+    this.workers = [];
+    for (var i = 0; i < worker_count; i++) {
+        var worker = new Worker(script_url);
+        worker.postMessage({ type: 'raster_worker_init', status: this.status });
+        this.workers.push(worker);
+    }
+    this.shared_grids = new WeakMap();
+}
+RasterWorkerPool.READY_COUNT = 0;
+RasterWorkerPool.REMAINING_COUNT = 1;
+RasterWorkerPool.ERROR_COUNT = 2;
+// the number of cells below which dispatching to workers costs more than it saves
+RasterWorkerPool.MIN_PARALLEL_LENGTH = 16384;
+// the pool that "RasterWorkerPool.run" dispatches to, if any, see "RasterWorkerPool.start"
+RasterWorkerPool.instance = void 0;
+// indicates whether the calling thread is allowed to block using Atomics.wait()
+RasterWorkerPool.is_blocking_allowed =
+    typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope &&
+    typeof SharedArrayBuffer !== 'undefined' && typeof Atomics !== 'undefined';
+// "start" creates the pool that raster operations dispatch to
+// "worker_count" defaults to one less than the number of logical processors, since the calling thread also takes a partition
+RasterWorkerPool.start = function(worker_count, script_url) {
+    if (RasterWorkerPool.instance !== void 0) {
+        RasterWorkerPool.instance.terminate();
+    }
+    worker_count = worker_count !== void 0? worker_count : Math.max((navigator.hardwareConcurrency || 1) - 1, 1);
+    RasterWorkerPool.instance = new RasterWorkerPool(worker_count, script_url);
+    return RasterWorkerPool.instance;
+}
+// "run" is called by raster operations. It runs "RasterKernels[kernel_name]" over cells [0, length),
+//   using the workers of "RasterWorkerPool.instance" if possible, or the calling thread if not.
+// On the calling thread, the WebAssembly version of the kernel is used if it can be, see "RasterWasmKernels.js".
+RasterWorkerPool.run = function(kernel_name, args, grid, length) {
+    var pool = RasterWorkerPool.instance;
+    if (pool !== void 0 &&
+        RasterWorkerPool.is_blocking_allowed &&
+        length >= RasterWorkerPool.MIN_PARALLEL_LENGTH &&
+        pool.is_ready() &&
+        RasterWorkerPool.is_shared(args)) {
+        pool.run(kernel_name, args, grid, length);
+    } else if (RasterWasmKernels.can_run(kernel_name, args)) {
+        RasterWasmKernels.run(kernel_name, args, 0, length);
+    } else {
+        RasterKernels[kernel_name](args, grid, 0, length);
+    }
+}
+// "is_shared" indicates whether every typed array in "args" is backed by shared memory
+RasterWorkerPool.is_shared = function(args) {
+    var value;
+    for (var key in args) {
+        value = args[key];
+        if (ArrayBuffer.isView(value) && !(value.buffer instanceof SharedArrayBuffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+RasterWorkerPool.prototype.is_ready = function() {
+    return Atomics.load(this.status, RasterWorkerPool.READY_COUNT) === this.workers.length;
+}
+// "get_shared_grid" returns copies of the arrays of "grid" that kernels need, in shared memory
+// Grid arrays never change once a grid is created, so copies are made only once per grid.
+RasterWorkerPool.prototype.get_shared_grid = function(grid) {
+    var shared_grid = this.shared_grids.get(grid);
+    if (shared_grid !== void 0) {
+        return shared_grid;
+    }
+    function share(array) {
+        var copy = new array.constructor(new SharedArrayBuffer(array.byteLength));
+        copy.set(array);
+        return copy;
+    }
+    shared_grid = {
+        arrow_offsets: share(grid.arrow_offsets),
+        arrow_from: share(grid.arrow_from),
+        arrow_to: share(grid.arrow_to),
+        neighbor_count: share(grid.neighbor_count),
+        pos_arrow_distances: share(grid.pos_arrow_distances),
+        pos_arrow_differential_normalized: {
+            x: share(grid.pos_arrow_differential_normalized.x),
+            y: share(grid.pos_arrow_differential_normalized.y),
+            z: share(grid.pos_arrow_differential_normalized.z),
+        },
+        average_distance: grid.average_distance,
+    };
+    this.shared_grids.set(grid, shared_grid);
+    return shared_grid;
+}
+RasterWorkerPool.prototype.run = function(kernel_name, args, grid, length) {
+    var status = this.status;
+    var workers = this.workers;
+    var partition_count = workers.length + 1;
+    var shared_grid = grid !== void 0? this.get_shared_grid(grid) : void 0;
+    Atomics.store(status, RasterWorkerPool.ERROR_COUNT, 0);
+    Atomics.store(status, RasterWorkerPool.REMAINING_COUNT, workers.length);
+    for (var i = 0; i < workers.length; i++) {
+        workers[i].postMessage({
+            type: 'raster_kernel',
+            kernel: kernel_name,
+            args: args,
+            grid: shared_grid,
+            start: Math.floor( i * length / partition_count),
+            end: Math.floor((i+1) * length / partition_count),
+        });
+    }
+    // the calling thread takes the last partition, while workers handle the rest
+    RasterKernels[kernel_name](args, grid, Math.floor(workers.length * length / partition_count), length);
+    var remaining = 0;
+    while ((remaining = Atomics.load(status, RasterWorkerPool.REMAINING_COUNT)) > 0) {
+        Atomics.wait(status, RasterWorkerPool.REMAINING_COUNT, remaining);
+    }
+    if (Atomics.load(status, RasterWorkerPool.ERROR_COUNT) > 0) {
+        throw `RasterWorkerPool: the kernel "${kernel_name}" threw an error within a worker`;
+    }
+}
+RasterWorkerPool.prototype.terminate = function() {
+    for (var i = 0; i < this.workers.length; i++) {
+        this.workers[i].terminate();
+    }
+    this.workers = [];
+}
+// if this script is running within a worker, it can be used as a worker of a RasterWorkerPool
+if (typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope) {
+    (function() {
+        var status = void 0;
+        self.addEventListener('message', function(event) {
+            var message = event.data;
+            if (message.type === 'raster_worker_init') {
+                status = message.status;
+                Atomics.add(status, RasterWorkerPool.READY_COUNT, 1);
+            } else if (message.type === 'raster_kernel') {
+                try {
+                    RasterKernels[message.kernel](message.args, message.grid, message.start, message.end);
+                } catch (error) {
+                    Atomics.add(status, RasterWorkerPool.ERROR_COUNT, 1);
+                    throw error;
+                } finally {
+                    if (Atomics.sub(status, RasterWorkerPool.REMAINING_COUNT, 1) === 1) {
+                        Atomics.notify(status, RasterWorkerPool.REMAINING_COUNT);
+                    }
+                }
+            }
+        });
+    })();
+}
+//Data structure mapping 3d coordinates onto a lattice for fast lookups 
+// lattice assumes that max distance to nearest neighbors will never exceed farthest_nearest_neighbor_distance
+function IntegerLattice(points, getDistance, farthest_nearest_neighbor_distance){
+    // NOTE: bounds are found using reduce(), since Math.max.apply() overflows the stack for large grids
+    var lattice = [];
+    var N = 3;
+    var cell_width = 2*farthest_nearest_neighbor_distance;
+    var max_x = points.reduce((a, point) => Math.max(a, point.x), -Infinity);
+    var min_x = points.reduce((a, point) => Math.min(a, point.x), Infinity);
+    var range_x = max_x - min_x;
+    var cell_num_x = range_x / cell_width;
+    var max_y = points.reduce((a, point) => Math.max(a, point.y), -Infinity);
+    var min_y = points.reduce((a, point) => Math.min(a, point.y), Infinity);
+    var range_y = max_y - min_y;
     var cell_num_y = range_y / cell_width;
-    var max_z = Math.max.apply(null, points.map(point => point.z));
-    var min_z = Math.min.apply(null, points.map(point => point.z));
+    var max_z = points.reduce((a, point) => Math.max(a, point.z), -Infinity);
+    var min_z = points.reduce((a, point) => Math.min(a, point.z), Infinity);
     var range_z = max_z - min_z;
     var cell_num_z = range_z / cell_width;
     var ceil = Math.ceil;
@@ -4793,6 +6238,14 @@ var VoronoiSphere = (function() {
     var OCTAHEDRON_SIDE_X = VectorRaster.ToArray(OCTAHEDRON_SIDE_X);
     var OCTAHEDRON_SIDE_Y = VectorRaster.ToArray(OCTAHEDRON_SIDE_Y);
     var OCTAHEDRON_SIDE_Z = VectorRaster.ToArray(OCTAHEDRON_SIDE_Z);
+    // the axes of each side, indexed by side id, in "structure of arrays" form,
+    //   so that hot loops index typed arrays rather than look up properties of objects
+    var SIDE_X_X = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.x));
+    var SIDE_X_Y = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.y));
+    var SIDE_X_Z = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.z));
+    var SIDE_Y_X = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.x));
+    var SIDE_Y_Y = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.y));
+    var SIDE_Y_Z = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.z));
     var cell_count = function (dimensions_x, dimensions_y){
         return OCTAHEDRON_SIDE_COUNT * dimensions_x * dimensions_y;
     }
@@ -4806,11 +6259,14 @@ var VoronoiSphere = (function() {
     function VoronoiSphere(pos, cell_width, farthest_distance){
         var dimension_x = Math.ceil(2./cell_width)+1;
         var dimension_y = Math.ceil(2./cell_width)+1;
-        var cells = new Uint16Array(cell_count(dimension_x, dimension_y));
+        // NOTE: cells store ids of vertices, so they need the same id array type as "Grid.IdArray"
+        var IdArray = pos.x.length > Grid.MAX_UINT16_VERTEX_COUNT? Uint32Array : Uint16Array;
+        var cells = new IdArray(cell_count(dimension_x, dimension_y));
         this.cell_width = cell_width;
         this.dimension_x = dimension_x;
         this.dimension_y = dimension_y;
         this.cells = cells;
+        this.IdArray = IdArray;
         //Feed locations into an integer lattice for fast lookups
         var points = [];
         var x = pos.x;
@@ -4865,40 +6321,136 @@ var VoronoiSphere = (function() {
             }
         }
     }
+    // "FromCells" returns a VoronoiSphere whose cells were populated earlier, such as those cached by "Grid.cache",
+    //   since populating them is the most expensive part of building a grid
+    VoronoiSphere.FromCells = function(cells, cell_width, dimension_x, dimension_y) {
+        var result = Object.create(VoronoiSphere.prototype);
+        result.cell_width = cell_width;
+        result.dimension_x = dimension_x;
+        result.dimension_y = dimension_y;
+        result.cells = cells;
+        result.IdArray = cells.constructor;
+        return result;
+    }
+    // "get_nearest_cell_ids" is the first pass of "getNearestIds": 
+    //   for each position in "args.x", "args.y", and "args.z", it writes the index of the cell that it maps to within the table
+    // See "nearest_cell_ids" in "precompiled/cpp/raster_kernels.cpp" for its WebAssembly counterpart.
+    var get_nearest_cell_ids = function(args, start, end) {
+        var x = args.x, y = args.y, z = args.z, result = args.result;
+        var cell_width = args.cell_width;
+        var side_stride = args.dimension_x * args.dimension_y;
+        var row_stride = args.dimension_y;
+        var floor = Math.floor;
+        var xi = 0., yi = 0., zi = 0.;
+        var side_id = 0;
+        for (var i = start; i < end; i++) {
+            xi = x[i];
+            yi = y[i];
+            zi = z[i];
+            side_id =
+              (( xi > 0) ) +
+              (( yi > 0) << 1) +
+              (( zi > 0) << 2) ;
+            result[i] = side_id * side_stride
+                + floor((SIDE_X_X[side_id] * xi + SIDE_X_Y[side_id] * yi + SIDE_X_Z[side_id] * zi + 1.) / cell_width) * row_stride
+                + floor((SIDE_Y_X[side_id] * xi + SIDE_Y_Y[side_id] * yi + SIDE_Y_Z[side_id] * zi + 1.) / cell_width);
+        }
+    }
+    // "getNearestIds" runs in two passes over the whole batch of positions: 
+    //   the first finds the index within the table of each position, 
+    //   and the second reads the table at those indices.
+    // Keeping arithmetic and table reads in separate loops keeps the first loop free of memory stalls,
+    //   and lets it run as WebAssembly SIMD when the positions lie within module memory, see "RasterWasmKernels".
+    // NOTE: sorting reads by index was also tried, but sorting costs more than the cache misses it saves
     VoronoiSphere.prototype.getNearestIds = function(pos_field, result) {
-        result = result || new Uint16Array(pos_field.x.length);
+        var length = pos_field.x.length;
+        result = result || new this.IdArray(length);
+        var scratchpad = RasterStackBuffer.scratchpad;
+        scratchpad.allocate('getNearestIds');
+        var cell_ids = pos_field.grid !== void 0? scratchpad.getUint32Raster(pos_field.grid) : new Uint32Array(length);
+        var args = {
+            x: pos_field.x,
+            y: pos_field.y,
+            z: pos_field.z,
+            cell_width: this.cell_width,
+            dimension_x: this.dimension_x,
+            dimension_y: this.dimension_y,
+            result: cell_ids,
+        };
+        if (RasterWasmKernels.can_run('nearest_cell_ids', args)) {
+            RasterWasmKernels.run('nearest_cell_ids', args, 0, length);
+        } else {
+            get_nearest_cell_ids(args, 0, length);
+        }
+        var cells = this.cells;
+        for (var i = 0; i < length; i++) {
+            result[i] = cells[cell_ids[i]];
+        }
+        scratchpad.deallocate('getNearestIds');
+        return result;
+    }
+    // "updateNearestIds" finds the nearest ids of "pos_field" after it is transformed by "matrix", like getNearestIds(),
+    //   but only for those positions whose nearest id could have changed since they were last found.
+    // "drift" is an upper bound on how far any position could have moved in total since the first call, see "Matrix3x3.get_max_displacement".
+    // "thresholds" holds, for each position, the drift at which it must next be looked up,
+    //   which is the drift at its last lookup, plus its distance to its nearest boundary between cells.
+    // Within that distance, a position stays in the same cell, and so maps to the same id,
+    //   so results match those of getNearestIds() while only positions near boundaries are looked up.
+    // "thresholds" should start at -Infinity, so that every position is looked up on the first call.
+    VoronoiSphere.prototype.updateNearestIds = function(pos_field, matrix, drift, thresholds, result) {
+        result = result || new this.IdArray(pos_field.x.length);
         var cell_width = this.cell_width;
         var dimension_x = this.dimension_x;
         var dimension_y = this.dimension_y;
         var cells = this.cells;
-        var side_x = OCTAHEDRON_SIDE_X[0];
-        var side_y = OCTAHEDRON_SIDE_Y[0];
-        var projection_x = 0;
-        var projection_y = 0;
+        var xx = matrix[0]; var xy = matrix[3]; var xz = matrix[6];
+        var yx = matrix[1]; var yy = matrix[4]; var yz = matrix[7];
+        var zx = matrix[2]; var zy = matrix[5]; var zz = matrix[8];
+        var pos_x = pos_field.x;
+        var pos_y = pos_field.y;
+        var pos_z = pos_field.z;
+        var xi = 0;
+        var yi = 0;
+        var zi = 0;
+        var grid_x = 0;
+        var grid_y = 0;
         var grid_pos_x = 0;
         var grid_pos_y = 0;
-        var pos_field_xi = 0;
-        var pos_field_yi = 0;
-        var pos_field_zi = 0;
         var side_id = 0;
-        var dot = Vector.dot_vector;
+        var margin = 0;
+        // the margin that is lost to rounding of transformed positions, which is well above the precision of 32 bit floats
+        const ROUNDING_MARGIN = 1e-6;
+        var abs = Math.abs;
+        var min = Math.min;
         var floor = Math.floor;
-        for (var i = 0, li = pos_field.x.length; i < li; i++)
+        // NOTE: transformed positions are rounded to 32 bits, as they would be if they were stored in a VectorRaster first
+        var fround = Math.fround;
+        for (var i = 0, li = pos_x.length; i < li; i++)
         {
-            pos_field_xi = pos_field.x[i];
-            pos_field_yi = pos_field.y[i];
-            pos_field_zi = pos_field.z[i];
-            var side_id =
-              (( pos_field_xi > 0) ) +
-              (( pos_field_yi > 0) << 1) +
-              (( pos_field_zi > 0) << 2) ;
-            side_x = OCTAHEDRON_SIDE_X[side_id];
-            side_y = OCTAHEDRON_SIDE_Y[side_id];
-            projection_x = dot( side_x.x, side_x.y, side_x.z, pos_field_xi, pos_field_yi, pos_field_zi );
-            projection_y = dot( side_y.x, side_y.y, side_y.z, pos_field_xi, pos_field_yi, pos_field_zi );
-            grid_pos_x = floor((projection_x + 1.) / cell_width);
-            grid_pos_y = floor((projection_y + 1.) / cell_width);
+            if (drift < thresholds[i]) {
+                continue;
+            }
+            xi = fround(pos_x[i] * xx + pos_y[i] * xy + pos_z[i] * xz);
+            yi = fround(pos_x[i] * yx + pos_y[i] * yy + pos_z[i] * yz);
+            zi = fround(pos_x[i] * zx + pos_y[i] * zy + pos_z[i] * zz);
+            side_id =
+              (( xi > 0) ) +
+              (( yi > 0) << 1) +
+              (( zi > 0) << 2) ;
+            grid_x = (SIDE_X_X[side_id] * xi + SIDE_X_Y[side_id] * yi + SIDE_X_Z[side_id] * zi + 1.) / cell_width;
+            grid_y = (SIDE_Y_X[side_id] * xi + SIDE_Y_Y[side_id] * yi + SIDE_Y_Z[side_id] * zi + 1.) / cell_width;
+            grid_pos_x = floor(grid_x);
+            grid_pos_y = floor(grid_y);
             result[i] = cells[cell_id(side_id, grid_pos_x, grid_pos_y, dimension_x, dimension_y)];
+            // a position changes sides when one of its components changes sign,
+            //   and it changes cells when either of its projections crosses a multiple of "cell_width",
+            //   and neither can happen before the position moves by more than the distance to either
+            margin = min(
+                abs(xi), abs(yi), abs(zi),
+                min(grid_x - grid_pos_x, 1. - (grid_x - grid_pos_x)) * cell_width,
+                min(grid_y - grid_pos_y, 1. - (grid_y - grid_pos_y)) * cell_width
+            );
+            thresholds[i] = drift + margin - ROUNDING_MARGIN;
         }
         return result;
     }
@@ -4908,9 +6460,12 @@ var VoronoiSphere = (function() {
 // You can find grid cells by neighbor, by position, and by the index of a WebGL buffer array
 // It is the lowest level data structure in the app - all raster operations under rasters/ depend on it
 function Grid(parameters, options){
-    options = options || {};
-    var neighbor_lookup, face, points, vertex;
+    options = options || Grid.default_options;
     this.parameters = parameters;
+    // if "is_shared" is set, rasters of this grid are allocated in shared memory, see "RasterArrayBuffer"
+    this.is_shared = !!options.is_shared;
+    // unless "is_cached" is false, what is derived from the mesh is shared with other grids of the same mesh, see "Grid.cache"
+    var is_cached = options.is_cached !== false;
     // Precompute map between buffer array ids and grid cell ids
     // This helps with mapping cells within the model to buffer arrays in three.js
     // Map is created by flattening this.parameters.faces
@@ -4924,14 +6479,17 @@ function Grid(parameters, options){
    vertices: vertices.map(v => { return {x: v.x, y: v.y, z: v.z} } ),
   };
  }
-    var vertex_ids = new Uint16Array(this.vertices.length);
+    // Cell ids are stored in Uint16Arrays when they fit, so small grids keep their compact layout,
+    // otherwise they are stored in Uint32Arrays. See "Grid.prototype.createIdRaster".
+    this.IdArray = vertices.length > Grid.MAX_UINT16_VERTEX_COUNT? Uint32Array : Uint16Array;
+    var vertex_ids = new this.IdArray(this.vertices.length);
     for (var i=0, li=vertex_ids.length; i<li; ++i) {
         vertex_ids[i] = i;
     }
     this.vertex_ids = vertex_ids;
     this.vertex_ids.grid = this;
     this.pos = VectorRaster.FromVectors(this.vertices, this);
-    var buffer_array_to_cell = new Uint16Array(faces.length * 3);
+    var buffer_array_to_cell = new this.IdArray(faces.length * 3);
     for (var i=0, i3=0, li = faces.length; i<li; i++, i3+=3) {
         var face = faces[i];
         buffer_array_to_cell[i3+0] = face.a;
@@ -4939,6 +6497,105 @@ function Grid(parameters, options){
         buffer_array_to_cell[i3+2] = face.c;
     };
     this.buffer_array_to_cell = buffer_array_to_cell;
+    // Everything below is derived from the mesh alone, and is expensive to build for large grids,
+    //   so it is built once per mesh and cached, see "Grid.cache"
+    var cache_key = Grid.get_cache_key(faces, vertices);
+    var cached = is_cached? Grid.get_cache_entry(cache_key) : void 0;
+    if (cached === void 0) {
+        cached = Grid.build_cache_entry(faces, vertices, this.pos);
+        if (is_cached) {
+            Grid.set_cache_entry(cache_key, cached);
+        }
+    }
+    this.cache_key = cache_key;
+    // NOTE: cached arrays are shared between grids of the same mesh, 
+    //   but each grid gets its own views of them, since rasters keep a reference to their grid
+    // NOTE: cached arrays may be views into a larger buffer, such as those that are sent from another thread
+    var neighbor_count = new Uint8Array(cached.neighbor_count.buffer, cached.neighbor_count.byteOffset, cached.neighbor_count.length);
+    neighbor_count.grid = this;
+    this.neighbor_count = neighbor_count;
+    // an "arrow" in graph theory is an ordered set of vertices 
+    // it is also known as a directed edge 
+    // i.e. arrows include duplicate neighbor pairs 
+    // e.g. it includes [1,2] *and* [2,1] 
+    // an "edge" in graph theory is a unordered set of vertices 
+    // i.e. edges do not include duplicate neighbor pairs 
+    // e.g. it includes [1,2] but not [2,1] 
+    //
+    // Arrows and edges are stored as pairs of typed arrays, so that hot loops avoid a heap object per arrow.
+    // Arrows are sorted by the cell they start from, so they also form the "compressed sparse row" representation of the grid:
+    //   the arrows that start from cell i are those from "arrow_offsets[i]" up to but excluding "arrow_offsets[i+1]",
+    //   and the neighbors of cell i are the values of "arrow_to" within that range.
+    this.arrow_from = cached.arrow_from;
+    this.arrow_to = cached.arrow_to;
+    this.arrow_offsets = cached.arrow_offsets;
+    this.edge_from = cached.edge_from;
+    this.edge_to = cached.edge_to;
+    var arrow_count = cached.arrow_from.length;
+    this.pos_arrow_differential = Grid.get_vector_view(cached.pos_arrow_differential, arrow_count);
+    this.pos_arrow_differential_normalized = Grid.get_vector_view(cached.pos_arrow_differential_normalized, arrow_count);
+    this.pos_arrow_distances = cached.pos_arrow_distances;
+    this.average_distance = Float32Dataset.average(this.pos_arrow_distances);
+    this.average_area = this.average_distance * this.average_distance;
+    this._voronoi = VoronoiSphere.FromCells(cached.voronoi.cells, cached.voronoi.cell_width, cached.voronoi.dimension_x, cached.voronoi.dimension_y);
+}
+// the number of vertices above which cell ids no longer fit in a Uint16Array
+Grid.MAX_UINT16_VERTEX_COUNT = 65536;
+// the options used by grids that are constructed without any,
+//   such as those of worlds that are simulated by "noncompiled/models/SimulationWorker.js"
+Grid.default_options = { is_shared: false };
+// the version of the layout of cache entries, which must change whenever "build_cache_entry" changes what it returns
+Grid.CACHE_VERSION = 1;
+// "cache" maps the key of each mesh that a grid was built for onto the structures that were derived from it, see "build_cache_entry"
+// Entries are plain objects of typed arrays, so they can be stored outside of memory and added back, see "GridCache.js"
+// Entries are kept in order of when they were last used, and only the most recent are kept, see "MAX_CACHE_ENTRY_COUNT".
+// Grids keep the arrays of their entry, so an entry that is dropped only costs the time to build it again.
+Grid.cache = new Map();
+// the number of entries that "Grid.cache" keeps, which covers a world along with the grids of a few resolutions it was viewed at
+Grid.MAX_CACHE_ENTRY_COUNT = 4;
+// "get_cache_entry" returns the entry of "Grid.cache" for "key", if any, and marks it as the most recently used
+Grid.get_cache_entry = function(key) {
+    var entry = Grid.cache.get(key);
+    if (entry !== void 0) {
+        Grid.cache.delete(key);
+        Grid.cache.set(key, entry);
+    }
+    return entry;
+}
+// "set_cache_entry" adds "entry" to "Grid.cache" as its most recently used, 
+//   then drops the least recently used entries until there are no more than "MAX_CACHE_ENTRY_COUNT"
+// NOTE: maps iterate in the order that keys were added, so the first key is always the least recently used
+Grid.set_cache_entry = function(key, entry) {
+    Grid.cache.delete(key);
+    Grid.cache.set(key, entry);
+    while (Grid.cache.size > Grid.MAX_CACHE_ENTRY_COUNT) {
+        Grid.cache.delete(Grid.cache.keys().next().value);
+    }
+}
+// "get_cache_key" returns a string that identifies a mesh, made of its version, its size, and a hash of its faces and vertices
+Grid.get_cache_key = function(faces, vertices) {
+    var float64 = new Float64Array(1);
+    var uint32 = new Uint32Array(float64.buffer);
+    var imul = Math.imul;
+    // FNV-1a, on 32 bit words
+    var hash = 0x811c9dc5;
+    for (var i = 0, li = vertices.length; i < li; i++) {
+        var vertex = vertices[i];
+        float64[0] = vertex.x; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+        float64[0] = vertex.y; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+        float64[0] = vertex.z; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+    }
+    for (var i = 0, li = faces.length; i < li; i++) {
+        var face = faces[i];
+        hash = imul(hash ^ face.a, 0x01000193);
+        hash = imul(hash ^ face.b, 0x01000193);
+        hash = imul(hash ^ face.c, 0x01000193);
+    }
+    return `${Grid.CACHE_VERSION}:${vertices.length}:${faces.length}:${(hash >>> 0).toString(16)}`;
+}
+// "build_cache_entry" derives the structures of a grid from its mesh, where "pos" holds the position of each vertex
+Grid.build_cache_entry = function(faces, vertices, pos) {
+    var face;
     //Precompute neighbors for O(1) lookups
     var neighbor_lookup = vertices.map(function(vertex) { return {}});
     for(var i=0, il = faces.length; i<il; i++){
@@ -4951,65 +6608,108 @@ function Grid(parameters, options){
         neighbor_lookup[face.c][face.b] = face.b;
     }
     neighbor_lookup = neighbor_lookup.map(function(set) { return Object.values(set); });
-    this.neighbor_lookup = neighbor_lookup;
-    var neighbor_count = Uint8Raster(this);
+    var neighbor_count = new Uint8Array(vertices.length);
     for (var i = 0, li=neighbor_lookup.length; i<li; i++) {
         neighbor_count[i] = neighbor_lookup[i].length;
     }
-    this.neighbor_count = neighbor_count;
-    // an "edge" in graph theory is a unordered set of vertices 
-    // i.e. this.edges does not contain duplicate neighbor pairs 
-    // e.g. it includes [1,2] but not [2,1] 
-    var edges = [];
-    var edge_lookup = [];
-    // an "arrow" in graph theory is an ordered set of vertices 
-    // it is also known as a directed edge 
-    // i.e. this.arrows contains duplicate neighbor pairs 
-    // e.g. it includes [1,2] *and* [2,1] 
-    var arrows = [];
-    var arrow_lookup = [];
+    var arrow_count = 0;
+    for (var i = 0, li=neighbor_count.length; i<li; i++) {
+        arrow_count += neighbor_count[i];
+    }
+    var arrow_offsets = new Uint32Array(neighbor_count.length+1);
+    var arrow_from = new Uint32Array(arrow_count);
+    var arrow_to = new Uint32Array(arrow_count);
+    var edge_from = new Uint32Array(arrow_count/2);
+    var edge_to = new Uint32Array(arrow_count/2);
     var neighbors = [];
     var neighbor = 0;
+    var arrow_id = 0;
+    var edge_id = 0;
     //Precompute a list of neighboring vertex pairs for O(N) traversal 
     for (var i = 0, li=neighbor_lookup.length; i<li; i++) {
+      arrow_offsets[i] = arrow_id;
       neighbors = neighbor_lookup[i];
       for (var j = 0, lj=neighbors.length; j<lj; j++) {
         neighbor = neighbors[j];
-        arrows.push([i, neighbor]);
-        arrow_lookup[i] = arrow_lookup[i] || [];
-        arrow_lookup[i].push(arrows.length-1);
+        arrow_from[arrow_id] = i;
+        arrow_to[arrow_id] = neighbor;
+        arrow_id++;
         if (i < neighbor) {
-          edges.push([i, neighbor]);
-          edge_lookup[i] = edge_lookup[i] || [];
-          edge_lookup[i].push(edges.length-1);
-          edge_lookup[neighbor] = edge_lookup[neighbor] || [];
-          edge_lookup[neighbor].push(edges.length-1);
+          edge_from[edge_id] = i;
+          edge_to[edge_id] = neighbor;
+          edge_id++;
         }
       }
     }
-    this.edges = edges;
-    this.edge_lookup = edge_lookup;
-    this.arrows = arrows;
-    this.arrow_lookup = arrow_lookup;
-    this.pos_arrow_differential = VectorField.arrow_differential(this.pos);
-    this.pos_arrow_differential_normalized = VectorRaster.OfLength(arrows.length, undefined)
-    this.pos_arrow_differential_normalized = VectorField.normalize(this.pos_arrow_differential, this.pos_arrow_differential_normalized);
-    this.pos_arrow_distances = Float32Raster.OfLength(arrows.length, undefined)
-    VectorField.magnitude(this.pos_arrow_differential, this.pos_arrow_distances);
-    this.average_distance = Float32Dataset.average(this.pos_arrow_distances);
-    this.average_area = this.average_distance * this.average_distance;
+    arrow_offsets[neighbor_lookup.length] = arrow_id;
+    // NOTE: arrow differentials are found without a grid, since the grid they would belong to is still being built
+    var arrow_differential = VectorRaster.OfLength(arrow_count, undefined);
+    var x = pos.x;
+    var y = pos.y;
+    var z = pos.z;
+    for (var i = 0; i < arrow_count; i++) {
+        arrow_differential.x[i] = x[arrow_to[i]] - x[arrow_from[i]];
+        arrow_differential.y[i] = y[arrow_to[i]] - y[arrow_from[i]];
+        arrow_differential.z[i] = z[arrow_to[i]] - z[arrow_from[i]];
+    }
+    var arrow_differential_normalized = VectorRaster.OfLength(arrow_count, undefined);
+    VectorField.normalize(arrow_differential, arrow_differential_normalized);
+    var arrow_distances = Float32Raster.OfLength(arrow_count, undefined);
+    VectorField.magnitude(arrow_differential, arrow_distances);
     const CELLS_PER_VERTEX = 8;
-    this._voronoi = new VoronoiSphere(this.pos, Float32Dataset.min(this.pos_arrow_distances)/CELLS_PER_VERTEX, Float32Dataset.max(this.pos_arrow_distances));
+    var voronoi = new VoronoiSphere(pos, Float32Dataset.min(arrow_distances)/CELLS_PER_VERTEX, Float32Dataset.max(arrow_distances));
+    return {
+        version: Grid.CACHE_VERSION,
+        neighbor_count: neighbor_count,
+        arrow_offsets: arrow_offsets,
+        arrow_from: arrow_from,
+        arrow_to: arrow_to,
+        edge_from: edge_from,
+        edge_to: edge_to,
+        pos_arrow_differential: arrow_differential.everything,
+        pos_arrow_differential_normalized: arrow_differential_normalized.everything,
+        pos_arrow_distances: arrow_distances,
+        voronoi: {
+            cells: voronoi.cells,
+            cell_width: voronoi.cell_width,
+            dimension_x: voronoi.dimension_x,
+            dimension_y: voronoi.dimension_y,
+        },
+    };
+}
+// "get_vector_view" returns a vector raster of "length" whose components are views into "everything"
+Grid.get_vector_view = function(everything, length) {
+    return {
+        x: everything.subarray(0 * length, 1 * length),
+        y: everything.subarray(1 * length, 2 * length),
+        z: everything.subarray(2 * length, 3 * length),
+        everything: everything,
+        grid: undefined,
+    };
+}
+// "createIdRaster" returns a raster for "grid" that can store ids of cells within this grid, 
+//   such as those returned by "getNearestIds". "grid" defaults to this grid.
+Grid.prototype.createIdRaster = function(grid) {
+    grid = grid || this;
+    var result = new this.IdArray(grid.vertices.length);
+    result.grid = grid;
+    return result;
 }
 Grid.prototype.getNearestId = function(vertex) {
     return this._voronoi.getNearestId(vertex);
 }
 Grid.prototype.getNearestIds = function(pos_field, result) {
-    result = result || Uint16Raster(pos_field.grid);
+    result = result || this.createIdRaster(pos_field.grid);
     return this._voronoi.getNearestIds(pos_field, result);
 }
+// "updateNearestIds" is equivalent to getNearestIds() of "pos_field" transformed by "matrix", 
+//   but it only looks up positions that could have changed cells since their last lookup, see "VoronoiSphere.updateNearestIds"
+Grid.prototype.updateNearestIds = function(pos_field, matrix, drift, thresholds, result) {
+    result = result || this.createIdRaster(pos_field.grid);
+    return this._voronoi.updateNearestIds(pos_field, matrix, drift, thresholds, result);
+}
 Grid.prototype.getNeighborIds = function(id) {
-    return this.neighbor_lookup[id];
+    return this.arrow_to.subarray(this.arrow_offsets[id], this.arrow_offsets[id+1]);
 }
 // Raster based methods often need to create temporary rasters that the calling function never sees
 // Creating new rasters is very costly, so often several "scratch" rasters would be created once then reused multiple times
@@ -5018,19 +6718,39 @@ Grid.prototype.getNeighborIds = function(id) {
 // You can request new rasters without fear of performance penalties or referencing issues
 // Additionally, you can push and pop method names to the stack so the stack knows when to deallocate rasters
 // Think of it as a dedicated stack based memory for Javascript TypedArrays
-function RasterStackBuffer(byte_length){
-    this.buffer = new ArrayBuffer(byte_length);
+// If "is_shared" is set, memory is allocated as a SharedArrayBuffer, so its rasters can be used by a RasterWorkerPool
+// "peak_pos" and "allocation_count" are the highest position, and the number of methods allocated, since they were last reset,
+//   which are reported by the Profiler
+function RasterStackBuffer(byte_length, is_shared){
+    this.buffer = is_shared? new SharedArrayBuffer(byte_length) : new ArrayBuffer(byte_length);
     this.pos = 0;
     this.stack = [];
     this.method_names = [];
+    this.peak_pos = 0;
+    this.allocation_count = 0;
+}
+// "FromArrayBuffer" creates a RasterStackBuffer over memory that is owned by something else,
+//   such as the memory of a WebAssembly module, starting at "byte_offset"
+RasterStackBuffer.FromArrayBuffer = function(buffer, byte_offset) {
+    var result = Object.create(RasterStackBuffer.prototype);
+    result.buffer = buffer;
+    result.pos = 4*Math.ceil((byte_offset || 0)/4);
+    result.stack = [];
+    result.method_names = [];
+    result.peak_pos = result.pos;
+    result.allocation_count = 0;
+    return result;
 }
 // allocate memory to a method
 RasterStackBuffer.prototype.allocate = function(name) {
     this.stack.push(this.pos);
     this.method_names.push(name);
+    this.allocation_count++;
 }
 // deallocate memory reserved for a method
+// NOTE: the position only ever falls here, so this is where its peak is found
 RasterStackBuffer.prototype.deallocate = function(name) {
+    this.peak_pos = Math.max(this.peak_pos, this.pos);
     this.pos = this.stack.pop();
     var method = this.method_names.pop();
     if (method !== name) {
@@ -5073,6 +6793,30 @@ RasterStackBuffer.prototype.getUint16Raster = function(grid) {
     this.pos = 4*Math.ceil(new_pos/4);
     return raster;
 };
+RasterStackBuffer.prototype.getUint32Raster = function(grid) {
+    var length = grid.vertices.length;
+    var new_pos = this.pos + length * Uint32Array.BYTES_PER_ELEMENT;
+    if (new_pos >= this.buffer.length) {
+        throw `The raster stack buffer is overflowing! Either check for memory leaks, or initialize with more memory`;
+    }
+    var raster = new Uint32Array(this.buffer, this.pos, length);
+    raster.grid = grid;
+    // round to nearest 4 bytes
+    this.pos = 4*Math.ceil(new_pos/4);
+    return raster;
+};
+// "getBitset" returns a bitset for "grid", see "BitsetMorphology"
+RasterStackBuffer.prototype.getBitset = function(grid) {
+    var length = BitsetMorphology.get_word_count(grid.vertices.length);
+    var new_pos = this.pos + length * Uint32Array.BYTES_PER_ELEMENT;
+    if (new_pos >= this.buffer.length) {
+        throw `The raster stack buffer is overflowing! Either check for memory leaks, or initialize with more memory`;
+    }
+    var raster = new Uint32Array(this.buffer, this.pos, length);
+    raster.grid = grid;
+    this.pos = new_pos;
+    return raster;
+};
 RasterStackBuffer.prototype.getVectorRaster = function(grid) {
     var length = grid.vertices.length;
     var byte_length_per_index = length * 4;
@@ -5101,3 +6845,127 @@ RasterStackBuffer.scratchpad = new RasterStackBuffer(1e7);
 // b = buffer.getUint8Raster({vertices:{length:1}})
 // v = buffer.getVectorRaster({vertices:{length:1}})
 // buffer.deallocate('1')
+// RasterPool hands out temporary rasters the same way as RasterStackBuffer,
+//   but keeps a free list of rasters for each grid and each type of raster, rather than carving them out of a single buffer.
+// Rasters are acquired within a scope that is opened with "allocate" and closed with "deallocate",
+//   and every raster acquired within a scope is returned to its free list when the scope closes.
+// Rasters are created with the regular constructors, so they can be used by a RasterWorkerPool if their grid is shared,
+//   and the pool grows to fit whatever is needed, so it never overflows.
+// Like RasterStackBuffer, rasters are not cleared: they contain whatever was written to them by their last user.
+//
+// Raster functions use "RasterPool.scratchpad" for implicit temporaries, such as "scratch" arguments that the caller omitted,
+//   so omitting them no longer creates a new raster on every call:
+//
+//   var pool = RasterPool.scratchpad;
+//   pool.allocate('ScalarField.diffusion_by_constant');
+//   scratch = scratch || pool.getFloat32Raster(grid);
+//   ...
+//   pool.deallocate('ScalarField.diffusion_by_constant');
+//
+// Rasters that are returned to the caller must never come from the pool.
+function RasterPool() {
+    this.free_lists = new WeakMap();
+    this.acquired = [];
+    this.acquired_lists = [];
+    this.stack = [];
+    this.method_names = [];
+    // the number of rasters that were acquired, and the number that had to be created, since these were last reset by the Profiler
+    this.acquire_count = 0;
+    this.create_count = 0;
+}
+// open a scope for a method
+RasterPool.prototype.allocate = function(name) {
+    this.stack.push(this.acquired.length);
+    this.method_names.push(name);
+}
+// close the scope of a method, returning every raster acquired within it to the pool
+RasterPool.prototype.deallocate = function(name) {
+    var start = this.stack.pop();
+    var method = this.method_names.pop();
+    if (method !== name) {
+        throw `memory was deallocated for the method, ${name} but memory was not allocated. This indicates improper memory management.`;
+    }
+    var acquired = this.acquired;
+    var acquired_lists = this.acquired_lists;
+    for (var i = acquired.length - 1; i >= start; i--) {
+        acquired_lists[i].push(acquired[i]);
+    }
+    acquired.length = start;
+    acquired_lists.length = start;
+}
+// "get_free_list" returns the list of unused rasters of "grid" that were created by "constructor"
+RasterPool.prototype.get_free_list = function(grid, constructor) {
+    var free_lists = this.free_lists.get(grid);
+    if (free_lists === void 0) {
+        free_lists = new Map();
+        this.free_lists.set(grid, free_lists);
+    }
+    var free_list = free_lists.get(constructor);
+    if (free_list === void 0) {
+        free_list = [];
+        free_lists.set(constructor, free_list);
+    }
+    return free_list;
+}
+// "acquire" returns an unused raster of "grid" that was created by "constructor", creating one only if none are left
+RasterPool.prototype.acquire = function(grid, constructor) {
+    if (this.stack.length === 0) {
+        throw `a raster was requested from the pool outside any method. Call "allocate" first.`;
+    }
+    var free_list = this.get_free_list(grid, constructor);
+    this.acquire_count++;
+    if (free_list.length === 0) {
+        this.create_count++;
+    }
+    var raster = free_list.length > 0? free_list.pop() : constructor(grid);
+    this.acquired.push(raster);
+    this.acquired_lists.push(free_list);
+    return raster;
+}
+RasterPool.prototype.getFloat32Raster = function(grid) {
+    return this.acquire(grid, Float32Raster);
+};
+RasterPool.prototype.getUint8Raster = function(grid) {
+    return this.acquire(grid, Uint8Raster);
+};
+RasterPool.prototype.getUint16Raster = function(grid) {
+    return this.acquire(grid, Uint16Raster);
+};
+RasterPool.prototype.getUint32Raster = function(grid) {
+    return this.acquire(grid, Uint32Raster);
+};
+// "getBitset" returns a bitset for "grid", see "BitsetMorphology"
+RasterPool.prototype.getBitset = function(grid) {
+    return this.acquire(grid, BitsetMorphology.Bitset);
+};
+RasterPool.prototype.getVectorRaster = function(grid) {
+    return this.acquire(grid, VectorRaster);
+};
+RasterPool.scratchpad = new RasterPool();
+// If "is_debugging" is set, every raster that is created outside a pool is counted by the call site that created it,
+//   so that call sites which create rasters on every step of a simulation can be found. See "Simulation.update".
+// "allocations" records the number of rasters and bytes created at each call site since the last "reset_allocations",
+//   where each call site is named by the function that created the raster, followed by the function that called it.
+RasterPool.is_debugging = false;
+RasterPool.allocations = {};
+RasterPool.record_allocation = function(byte_length) {
+    var frames = new Error().stack.split('\n').slice(1);
+    // skip the frames of the constructors themselves
+    var i = 0;
+    while (i < frames.length - 1 && /RasterArrayBuffer|Raster \(|Raster\.OfLength|Raster\.FromExample|Bitset \(|RasterPool/.test(frames[i])) {
+        i++;
+    }
+    var site = frames.slice(i, i+2).map(frame => frame.trim().replace(/^at /, '')).join(' < ');
+    if (RasterPool.allocations[site] === void 0) {
+        RasterPool.allocations[site] = { site: site, count: 0, bytes: 0 };
+    }
+    RasterPool.allocations[site].count += 1;
+    RasterPool.allocations[site].bytes += byte_length;
+}
+// "get_allocations" returns the entries of "allocations", largest first
+RasterPool.get_allocations = function() {
+    return Object.values(RasterPool.allocations).sort((a,b) => b.bytes - a.bytes);
+}
+RasterPool.reset_allocations = function() {
+    RasterPool.allocations = {};
+}
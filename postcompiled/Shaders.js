@@ -13,7 +13,10 @@ varying vec4 position_v;
 uniform float sealevel;
 uniform float world_radius;
 attribute float displacement;
-attribute vec3 gradient;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
 attribute float surface_temperature;
 attribute float snow_coverage;
 attribute float plant_coverage;
@@ -38,7 +41,7 @@ float lat(vec3 pos) {
 }
 void main() {
     displacement_v = displacement;
-    gradient_v = gradient;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
     plant_coverage_v = plant_coverage;
     surface_temperature_v = surface_temperature;
     snow_coverage_v = snow_coverage;
@@ -80,7 +83,10 @@ varying vec4 position_v;
 uniform float sealevel;
 uniform float world_radius;
 attribute float displacement;
-attribute vec3 gradient;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
 attribute float surface_temperature;
 attribute float snow_coverage;
 attribute float plant_coverage;
@@ -105,7 +111,7 @@ float lat(vec3 pos) {
 }
 void main() {
     displacement_v = displacement;
-    gradient_v = gradient;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
     plant_coverage_v = plant_coverage;
     snow_coverage_v = snow_coverage;
     surface_temperature_v = surface_temperature;
@@ -143,7 +149,10 @@ varying vec4 position_v;
 uniform float sealevel;
 uniform float world_radius;
 attribute float displacement;
-attribute vec3 gradient;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
 attribute float surface_temperature;
 attribute float snow_coverage;
 attribute float plant_coverage;
@@ -162,7 +171,7 @@ attribute float vector_fraction_traversed;
 varying float vector_fraction_traversed_v;
 void main() {
     displacement_v = displacement;
-    gradient_v = gradient;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
     plant_coverage_v = plant_coverage;
     snow_coverage_v = snow_coverage;
     surface_temperature_v = surface_temperature;
@@ -191,7 +200,10 @@ varying vec4 position_v;
 uniform float sealevel;
 uniform float world_radius;
 attribute float displacement;
-attribute vec3 gradient;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
 attribute float surface_temperature;
 attribute float snow_coverage;
 attribute float plant_coverage;
@@ -347,6 +359,41 @@ vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
              solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
            );
 }
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
 // Rayleigh phase function factor [-1, 1]
 float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
     in float cos_scatter_angle
@@ -450,6 +497,51 @@ float get_fraction_of_microfacets_with_angle(
 const float BIG = 1e20;
 const float SMALL = 1e-20;
 const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
 // "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
 //   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
 //   taking into account the curvature of the world.
@@ -493,6 +585,12 @@ float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
         return BIG;
     }
     float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
     float x1 = sqrt(max(r1*r1-z2, 0.));
     float xb = x0+(x1-x0)*b;
     float rb2 = xb*xb + z2;
@@ -529,13 +627,159 @@ float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
     float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
     return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
 }
-// TODO: multiple scattering events
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
 // TODO: support for light sources from within atmosphere
 vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     in vec3 view_origin, in vec3 view_direction,
     in vec3 world_position, in float world_radius,
-    in vec3 [MAX_LIGHT_COUNT] light_directions,
-    in vec3 [MAX_LIGHT_COUNT] light_rgb_intensities,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
     in int light_count,
     in vec3 background_rgb_intensity,
     in float atmosphere_scale_height,
@@ -570,7 +814,6 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     vec3 I_back = background_rgb_intensity;
     float r = world_radius;
     float H = atmosphere_scale_height;
-    const float STEP_COUNT = 16.;// number of steps taken while marching along the view ray
     float xv = dot(-P,V); // distance from view ray origin to closest approach
     float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
     float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
@@ -596,8 +839,21 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     vec3 beta_gamma;
     float xv_start = max(xv_in_air, 0.);
     float xv_stop = is_obstructed? xv_in_world : xv_out_air;
-    float dx = (xv_stop - xv_start) / STEP_COUNT;
-    float xvi = xv_start - xv + 0.5 * dx;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
     vec3 L; // unit vector pointing to light source
     vec3 I; // vector indicating intensity of light source for each color channel
     float xl; // distance from light ray origin to closest approach
@@ -607,11 +863,17 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     float sigma_v; // columnar density encountered along the view ray,  relative to surface density
     float sigma_l; // columnar density encountered along the light ray, relative to surface density
     vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
-    for (float i = 0.; i < STEP_COUNT; ++i)
+    for (float i = 0.; i < 16.; ++i)
     {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
         r2 = xvi*xvi+zv2;
         h = sqrt(r2) - r;
         sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
         for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
         {
             if (j >= light_count) { break; }
@@ -630,11 +892,12 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
                 // outgoing fraction: the fraction of light that scatters away from camera
                 * exp(-beta_sum * (sigma_l + sigma_v));
         }
-        xvi += dx;
     }
     // now calculate the intensity of light that traveled straight in from the background, and add it to the total
-    sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
-    E += I_back * exp(-beta_sum * sigma_v);
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
     return E;
 }
 vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
@@ -724,6 +987,31 @@ vec3 get_rgb_signal_of_wavelength (
         bump(w, 570e-9, 625e-9, 0.30)
       );
 }
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
 // "GAMMA" is the constant that's used to map between 
 //   rgb signals sent to a monitor and their actual intensity
 const float GAMMA = 2.2;
@@ -754,6 +1042,7 @@ uniform mat4 projection_matrix_inverse;
 uniform mat4 view_matrix_inverse;
 uniform float reference_distance;
 uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
 // WORLD PROPERTIES ------------------------------------------------------------
 uniform vec3 world_position;
 uniform float world_radius;
@@ -814,11 +1103,7 @@ void main() {
             beta_ray, beta_mie, beta_abs
         );
     rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
-    // TODO: move this to a separate shader pass!
-    // see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
-    float exposure_intensity = 150.; // Watts/m^2
-    vec3 ldr_tone_map = 1.0 - exp(-rgb_intensity/exposure_intensity);
-    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(ldr_tone_map), 1);
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure_intensity)), 1);
     // gl_FragColor = 3.*background_rgb_signal;
 }
 `;
@@ -874,8 +1159,79 @@ void main() {
     gl_FragColor = texture2D( input_texture, vUv );
 }
 `;
-fragmentShaders.realistic = `
+fragmentShaders.realistic_vertex_lit = `
+// NOTE: these macros are here to allow porting the code between several languages
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "realistic_vertex_lit.glsl.c" is the counterpart to "realistic.glsl.c" for vertex shaders that light the surface,
+//   see "vertex/vertex_lighting.glsl.c". It only interpolates the intensity of light between vertices.
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+varying vec3 rgb_intensity_v;
+void main() {
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(rgb_intensity_v/insolation_max),1);
+}
+`;
+// map projections can also light the surface once per vertex for "realistic" views, see get_realistic_vertex_shader() below
+var realistic_vertex_shader_templates = {};
+realistic_vertex_shader_templates.equirectangular = `
 // NOTE: these macros are here to allow porting the code between several languages
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+varying vec3 view_direction_v;
+varying vec3 view_origin_v;
+varying vec4 position_v;
+// WORLD PROPERTIES
+uniform float sealevel;
+uniform float world_radius;
+attribute float displacement;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
+attribute float surface_temperature;
+attribute float snow_coverage;
+attribute float plant_coverage;
+attribute float scalar;
+attribute vec3 vector;
+varying float displacement_v;
+varying vec3 gradient_v;
+varying float surface_temperature_v;
+varying float snow_coverage_v;
+varying float plant_coverage_v;
+varying float scalar_v;
+// MISCELLANEOUS PROPERTIES
+uniform float map_projection_offset;
+uniform float animation_phase_angle;
+attribute float vector_fraction_traversed;
+varying float vector_fraction_traversed_v;
+// LIGHTING PROPERTIES
+// NOTE: the surface is lit once per vertex, see "vertex_lighting.glsl.c"
+varying vec3 rgb_intensity_v;
+// "vertex_lighting.glsl.c" lets map projection vertex shaders light the surface of a world once per vertex,
+//   using the same model that "fragment/realistic.glsl.c" uses once per pixel.
+// It is only included by "template.glsl.c" if "VERTEX_LIGHTING" is defined, see get_realistic_vertex_shader() in "precompiled/Shaders.js"
+// NOTE: "math/constants.glsl.c" is already included by "template.glsl.c"
 const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
 const float RADIAN = 1.;
 const float KELVIN = 1.;
@@ -918,7 +1274,6 @@ const float SOLAR_MASS = 2e30; // kilograms
 const float SOLAR_RADIUS = 695.7e6; // meters
 const float SOLAR_LUMINOSITY = 3.828e26; // watts
 const float SOLAR_TEMPERATURE = 5772.; // kelvin
-const float PI = 3.14159265358979323846264338327950288419716939937510;
 float get_surface_area_of_sphere(
     in float radius
 ) {
@@ -1006,6 +1361,41 @@ vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
              solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
            );
 }
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
 // Rayleigh phase function factor [-1, 1]
 float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
     in float cos_scatter_angle
@@ -1109,6 +1499,51 @@ float get_fraction_of_microfacets_with_angle(
 const float BIG = 1e20;
 const float SMALL = 1e-20;
 const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
 // "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
 //   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
 //   taking into account the curvature of the world.
@@ -1152,6 +1587,12 @@ float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
         return BIG;
     }
     float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
     float x1 = sqrt(max(r1*r1-z2, 0.));
     float xb = x0+(x1-x0)*b;
     float rb2 = xb*xb + z2;
@@ -1188,13 +1629,159 @@ float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
     float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
     return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
 }
-// TODO: multiple scattering events
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
 // TODO: support for light sources from within atmosphere
 vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     in vec3 view_origin, in vec3 view_direction,
     in vec3 world_position, in float world_radius,
-    in vec3 [MAX_LIGHT_COUNT] light_directions,
-    in vec3 [MAX_LIGHT_COUNT] light_rgb_intensities,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
     in int light_count,
     in vec3 background_rgb_intensity,
     in float atmosphere_scale_height,
@@ -1229,7 +1816,6 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     vec3 I_back = background_rgb_intensity;
     float r = world_radius;
     float H = atmosphere_scale_height;
-    const float STEP_COUNT = 16.;// number of steps taken while marching along the view ray
     float xv = dot(-P,V); // distance from view ray origin to closest approach
     float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
     float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
@@ -1255,8 +1841,21 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     vec3 beta_gamma;
     float xv_start = max(xv_in_air, 0.);
     float xv_stop = is_obstructed? xv_in_world : xv_out_air;
-    float dx = (xv_stop - xv_start) / STEP_COUNT;
-    float xvi = xv_start - xv + 0.5 * dx;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
     vec3 L; // unit vector pointing to light source
     vec3 I; // vector indicating intensity of light source for each color channel
     float xl; // distance from light ray origin to closest approach
@@ -1266,11 +1865,17 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     float sigma_v; // columnar density encountered along the view ray,  relative to surface density
     float sigma_l; // columnar density encountered along the light ray, relative to surface density
     vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
-    for (float i = 0.; i < STEP_COUNT; ++i)
+    for (float i = 0.; i < 16.; ++i)
     {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
         r2 = xvi*xvi+zv2;
         h = sqrt(r2) - r;
         sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
         for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
         {
             if (j >= light_count) { break; }
@@ -1289,11 +1894,12 @@ vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
                 // outgoing fraction: the fraction of light that scatters away from camera
                 * exp(-beta_sum * (sigma_l + sigma_v));
         }
-        xvi += dx;
     }
     // now calculate the intensity of light that traveled straight in from the background, and add it to the total
-    sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
-    E += I_back * exp(-beta_sum * sigma_v);
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
     return E;
 }
 vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
@@ -1354,60 +1960,19 @@ vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
     float sigma = ocean_depth / cos_incident_angle;
     return exp(-sigma * (beta_ray + beta_mie + beta_abs));
 }
-// This function returns a rgb vector that quickly approximates a spectral "bump".
-// Adapted from GPU Gems and Alan Zucconi
-// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
-float bump (
-    in float x,
-    in float edge0,
-    in float edge1,
-    in float height
-){
-    float center = (edge1 + edge0) / 2.;
-    float width = (edge1 - edge0) / 2.;
-    float offset = (x - center) / width;
-    return height * max(1. - offset * offset, 0.);
-}
-// This function returns a rgb vector that best represents color at a given wavelength
-// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
-// I've adapted the function so that coefficients are expressed in meters.
-vec3 get_rgb_signal_of_wavelength (
-    in float w
-){
-    return vec3(
-        bump(w, 530e-9, 690e-9, 1.00)+
-        bump(w, 410e-9, 460e-9, 0.15),
-        bump(w, 465e-9, 635e-9, 0.75)+
-        bump(w, 420e-9, 700e-9, 0.15),
-        bump(w, 400e-9, 570e-9, 0.45)+
-        bump(w, 570e-9, 625e-9, 0.30)
-      );
-}
-// "GAMMA" is the constant that's used to map between 
-//   rgb signals sent to a monitor and their actual intensity
-const float GAMMA = 2.2;
-vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
-){
-    return vec3(
-        pow(signal.x, GAMMA),
-        pow(signal.y, GAMMA),
-        pow(signal.z, GAMMA)
-    );
-}
-vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
-){
-    return vec3(
-        pow(intensity.x, 1./GAMMA),
-        pow(intensity.y, 1./GAMMA),
-        pow(intensity.z, 1./GAMMA)
-    );
-}
-// Determines the length of a unit of distance within the view, in meters, 
-// it is generally the radius of whatever world's the focus for the scene.
-// The view uses different units for length to prevent certain issues with
-// floating point precision. 
+// "realistic_surface.glsl.c" finds the light that's emitted or reflected by the surface of a world, for "realistic" shaders.
+// It is shared by the fragment shader "realistic.glsl.c", which lights every pixel,
+//   by map projection vertex shaders that are compiled with "VERTEX_LIGHTING", which light every vertex,
+//   and by the native renderer, see "precompiled/cpp/realistic.hpp".
+// It expects the includer to have included the academics layer.
+// Under GL_ES, it also expects the includer to have declared the uniforms "sealevel" and "world_radius",
+//   and the varyings that are declared in "vertex/template.glsl.c", from which it reads the properties of the surface.
+// It is specialized by constants that are described in get_realistic_fragment_shader() of "precompiled/Shaders.js":
+//   "VARIANT_LIGHT_COUNT"   the most light sources the shader loops over, "light_count" may be smaller
+//   "VARIANT_HAS_OCEAN"     whether the ocean can be visible
+//   "VARIANT_HAS_SPECULAR"  whether surfaces can have specular reflection
+//   "VARIANT_HAS_EXACT_EMISSION" whether to evaluate emission exactly, even if a lookup table is available
 // VIEW SETTINGS ---------------------------------------------------------------
-uniform float reference_distance;
 uniform float ocean_visibility;
 uniform float sediment_visibility;
 uniform float plant_visibility;
@@ -1418,28 +1983,17 @@ uniform float specular_visibility;
 uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
 uniform vec3 light_directions [MAX_LIGHT_COUNT];
 uniform int light_count;
-uniform float insolation_max;
 // ATMOSPHERE PROPERTIES -------------------------------------------------------
 uniform float atmosphere_scale_height;
 uniform vec3 surface_air_rayleigh_scattering_coefficients;
 uniform vec3 surface_air_mie_scattering_coefficients;
 uniform vec3 surface_air_absorption_coefficients;
 // SEA PROPERTIES -------------------------------------------------------
-uniform float sealevel;
 uniform vec3 ocean_rayleigh_scattering_coefficients;
 uniform vec3 ocean_mie_scattering_coefficients;
 uniform vec3 ocean_absorption_coefficients;
 // WORLD PROPERTIES ------------------------------------------------------------
 uniform vec3 world_position; // location for the center of the world, in meters
-uniform float world_radius; // radius of the world being rendered, in meters
-varying float displacement_v;
-varying vec3 gradient_v;
-varying float plant_coverage_v;
-varying float snow_coverage_v;
-varying float scalar_v;
-varying float surface_temperature_v;
-varying vec4 position_v;
-varying vec3 view_direction_v;
 // "SOLAR_RGB_LUMINOSITY" is the rgb luminosity of earth's sun, in Watts.
 //   It is used to convert the above true color values to absorption coefficients.
 //   You can also generate these numbers by calling solve_rgb_intensity_of_light_emitted_by_black_body(SOLAR_TEMPERATURE)
@@ -1536,7 +2090,7 @@ vec3 get_rgb_intensity_of_light_from_surface_of_world(
             atmosphere_scale_height, atmosphere_beta_ray, atmosphere_beta_mie, atmosphere_beta_abs
         );
     // "E_surface_reflected" is the intensity of light that is immediately reflected by the surface, A.K.A. "specular" reflection
-    vec3 E_surface_reflected = I_surface
+    vec3 E_surface_reflected = !VARIANT_HAS_SPECULAR? vec3(0) : I_surface
         * get_rgb_fraction_of_light_reflected_on_surface(HV, F0)
         * get_fraction_of_light_masked_or_shaded_by_surface(NV, m)
         * get_fraction_of_microfacets_with_angle(NH, m)
@@ -1546,12 +2100,12 @@ vec3 get_rgb_intensity_of_light_from_surface_of_world(
     //   or scattered back to the view as diffuse reflection.
     // We would ideally like to negate the integral of reflectance over all possible angles, 
     //   but finding that is hard, so let's just negate the reflectance for the angle at which it occurs the most, or "HV"
-    vec3 I_surface_refracted =
+    vec3 I_surface_refracted = !VARIANT_HAS_SPECULAR? I_surface :
         I_surface * (1. - get_rgb_fraction_of_light_reflected_on_surface(HV, F0));
       //+ I_sun     *  atmosphere_ambient_light_factor;
     // If sea is present, "E_ocean_scattered" is the rgb intensity of light 
     //   scattered by the sea towards the camera. Otherwise, it equals 0.
-    vec3 E_ocean_scattered =
+    vec3 E_ocean_scattered = !VARIANT_HAS_OCEAN? vec3(0) :
         get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
             NV, NL, LV, ocean_depth, I_surface_refracted,
             ocean_beta_ray, ocean_beta_mie, ocean_beta_abs
@@ -1559,53 +2113,87 @@ vec3 get_rgb_intensity_of_light_from_surface_of_world(
     // if sea is present, "I_ocean_trasmitted" is the rgb intensity of light 
     //   that reaches the ground after being filtered by air and sea. 
     //   Otherwise, it equals I_surface_refracted.
-    vec3 I_ocean_trasmitted= I_surface_refracted
+    vec3 I_ocean_trasmitted= !VARIANT_HAS_OCEAN? I_surface_refracted : I_surface_refracted
         * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NL, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
     // "E_diffuse" is diffuse reflection of any nontrasparent component beneath the transparent surface,
     // It effectively describes diffuse reflection as understood within the phong model of reflectance.
     vec3 E_diffuse = I_ocean_trasmitted * NL * surface_diffuse_color_rgb_fraction;
     // if sea is present, "E_ocean_transmitted" is the fraction 
     //   of E_diffuse that makes it out of the sea. Otheriwse, it equals E_diffuse
-    vec3 E_ocean_transmitted = E_diffuse
+    vec3 E_ocean_transmitted = !VARIANT_HAS_OCEAN? E_diffuse : E_diffuse
         * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NV, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
     return
         E_surface_reflected
       + E_ocean_transmitted
       + E_ocean_scattered;
 }
-void main() {
-    bool is_ocean = sealevel > displacement_v;
-    bool is_visible_ocean = sealevel * ocean_visibility > displacement_v;
-    float ocean_depth = max(sealevel*ocean_visibility - displacement_v, 0.);
-    float surface_height = max(displacement_v - sealevel*ocean_visibility, 0.);
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer.
+// Its arguments are named after the uniforms and varyings that are passed to it by the overload below.
+vec3 get_rgb_intensity_of_surface_of_world(
+    // view settings
+    in float ocean_visibility,
+    in float sediment_visibility,
+    in float plant_visibility,
+    in float snow_visibility,
+    in float shadow_visibility,
+    in float specular_visibility,
+    // light properties
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    // atmosphere properties
+    in float atmosphere_scale_height,
+    in vec3 surface_air_rayleigh_scattering_coefficients,
+    in vec3 surface_air_mie_scattering_coefficients,
+    in vec3 surface_air_absorption_coefficients,
+    // sea properties
+    in float sealevel,
+    in vec3 ocean_rayleigh_scattering_coefficients,
+    in vec3 ocean_mie_scattering_coefficients,
+    in vec3 ocean_absorption_coefficients,
+    // world properties
+    in float world_radius,
+    // surface properties
+    in float displacement,
+    in vec3 gradient,
+    in float plant_coverage,
+    in float snow_coverage,
+    in float surface_temperature,
+    in vec3 position,
+    // view properties
+    in vec3 view_direction
+){
+    bool is_ocean = sealevel > displacement;
+    bool is_visible_ocean = VARIANT_HAS_OCEAN && sealevel * ocean_visibility > displacement;
+    float ocean_depth = VARIANT_HAS_OCEAN? max(sealevel*ocean_visibility - displacement, 0.) : 0.;
+    float surface_height = max(displacement - sealevel*ocean_visibility, 0.);
     // TODO: pass felsic_coverage in from attribute
     // we currently guess how much rock is felsic depending on displacement
     // Absorption coefficients are physically based.
     // Scattering coefficients have been determined aesthetically.
-    float felsic_coverage = smoothstep(sealevel - 4000., sealevel+5000., displacement_v);
-    float mineral_coverage = displacement_v > sealevel? smoothstep(sealevel + 10000., sealevel, displacement_v) : 0.;
-    float organic_coverage = smoothstep(30., -30., surface_temperature_v);
-    float snow_coverage = snow_coverage_v;
-    float plant_coverage = plant_coverage_v * (!is_visible_ocean? 1. : 0.);
+    float felsic_coverage = smoothstep(sealevel - 4000., sealevel+5000., displacement);
+    float mineral_coverage = displacement > sealevel? smoothstep(sealevel + 10000., sealevel, displacement) : 0.;
+    float organic_coverage = smoothstep(30., -30., surface_temperature);
+    float visible_plant_coverage = plant_coverage * (!is_visible_ocean? 1. : 0.);
     // TODO: more sensible microfacet model
     vec3 color_of_bedrock = mix(LAND_COLOR_MAFIC, LAND_COLOR_FELSIC, felsic_coverage);
     vec3 color_with_sediment = mix(color_of_bedrock, mix(LAND_COLOR_SAND, LAND_COLOR_PEAT, organic_coverage), mineral_coverage * sediment_visibility);
-    vec3 color_with_plants = mix(color_with_sediment, JUNGLE_COLOR, !is_ocean? plant_coverage * plant_visibility * sediment_visibility : 0.);
+    vec3 color_with_plants = mix(color_with_sediment, JUNGLE_COLOR, !is_ocean? visible_plant_coverage * plant_visibility * sediment_visibility : 0.);
     vec3 color_with_snow = mix(color_with_plants, SNOW_COLOR, snow_coverage * snow_visibility);
     // "n" is the surface normal for a perfectly smooth sphere
-    vec3 n = normalize(position_v.xyz);
+    vec3 n = normalize(position);
     vec3 surface_position =
         n * (world_radius + surface_height);
     vec3 surface_normal =
-        normalize(n + gradient_v);
+        normalize(n + gradient);
     float surface_slope_root_mean_squared =
         is_visible_ocean?
             WATER_ROOT_MEAN_SLOPE_SQUARED :
-            mix(LAND_ROOT_MEAN_SLOPE_SQUARED, JUNGLE_ROOT_MEAN_SLOPE_SQUARED, plant_coverage);
+            mix(LAND_ROOT_MEAN_SLOPE_SQUARED, JUNGLE_ROOT_MEAN_SLOPE_SQUARED, visible_plant_coverage);
     vec3 surface_diffuse_color_rgb_fraction =
         get_rgb_intensity_of_rgb_signal(color_with_snow);
     // TODO: model refractive index as a function of wavelength
-    vec3 surface_specular_color_rgb_fraction =
+    vec3 surface_specular_color_rgb_fraction = !VARIANT_HAS_SPECULAR? vec3(0) :
         shadow_visibility * specular_visibility * // turn off specular reflection if darkness is disabled
         vec3(mix(
             is_visible_ocean?
@@ -1616,7 +2204,7 @@ void main() {
         ));
     float ocean_visible_depth = mix(ocean_depth, 0., snow_coverage*snow_coverage*snow_coverage*snow_visibility);
     vec3 E_surface_reemitted = vec3(0);
-    for (int i = 0; i < MAX_LIGHT_COUNT; ++i)
+    for (int i = 0; i < VARIANT_LIGHT_COUNT; ++i)
     {
         if (i >= light_count){ break; }
         vec3 light_direction = normalize(mix(n, light_directions[i], shadow_visibility));
@@ -1645,30 +2233,2332 @@ void main() {
                 ocean_mie_scattering_coefficients,
                 ocean_absorption_coefficients,
                 // view properties
-                -view_direction_v
+                -view_direction
             );
     }
-    vec3 E_surface_emitted = solve_rgb_intensity_of_light_emitted_by_black_body(surface_temperature_v);
+    vec3 E_surface_emitted = solve_rgb_intensity_of_light_emitted_by_black_body(surface_temperature);
     // NOTE: we do not filter E_total by atmospheric scattering
     //   that job is done by the atmospheric shader pass, in "atmosphere.glsl.c"
     vec3 E_total =
           E_surface_emitted
         + E_surface_reemitted;
-    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(E_total/insolation_max),1);
+    return E_total;
 }
-`;
-fragmentShaders.surface_normal_map = `
-varying float displacement_v;
-varying vec3 gradient_v;
-varying vec4 position_v;
-uniform float sealevel;
-uniform float ocean_visibility;
-void main() {
-    // CODE to generate a tangent-space normal map:
-    // "n" is the surface normal for a perfectly smooth sphere
-    vec3 n = normalize(position_v.xyz);
-    // "N" is the actual surface normal as reported by the gradient of displacement
-    vec3 N = normalize(n + gradient_v);
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer,
+//   for the surface that's described by the varyings of "vertex/template.glsl.c".
+// In a vertex shader, those varyings must be written before it is called.
+vec3 get_rgb_intensity_of_surface_of_world(){
+    return get_rgb_intensity_of_surface_of_world(
+        ocean_visibility, sediment_visibility, plant_visibility, snow_visibility, shadow_visibility, specular_visibility,
+        light_directions, light_rgb_intensities, light_count,
+        atmosphere_scale_height,
+        surface_air_rayleigh_scattering_coefficients,
+        surface_air_mie_scattering_coefficients,
+        surface_air_absorption_coefficients,
+        sealevel,
+        ocean_rayleigh_scattering_coefficients,
+        ocean_mie_scattering_coefficients,
+        ocean_absorption_coefficients,
+        world_radius,
+        displacement_v, gradient_v, plant_coverage_v, snow_coverage_v, surface_temperature_v, position_v.xyz,
+        view_direction_v
+    );
+}
+float lon(vec3 pos) {
+    return atan(-pos.z, pos.x) + PI;
+}
+float lat(vec3 pos) {
+    return asin(pos.y / length(pos));
+}
+void main() {
+    displacement_v = displacement;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
+    plant_coverage_v = plant_coverage;
+    surface_temperature_v = surface_temperature;
+    snow_coverage_v = snow_coverage;
+    scalar_v = scalar;
+    position_v = modelMatrix * vec4( position, 1.0 );
+    float height = displacement > sealevel? 0.005 : 0.0;
+    float index_offset = map_projection_offset;
+    float focus = lon(cameraPosition) + index_offset;
+    float lon_focused = mod(lon(position_v.xyz) - focus, 2.*PI) - PI;
+    float lat_focused = lat(position_v.xyz); //+ (map_projection_offset*PI);
+    bool is_on_edge = lon_focused > PI*0.9 || lon_focused < -PI*0.9;
+    vec4 displaced = vec4(
+        lon_focused + index_offset,
+        lat(position_v.xyz), //+ (map_projection_offset*PI), 
+        is_on_edge? 0. : length(position),
+        1);
+    mat4 scaleMatrix = mat4(1);
+    scaleMatrix[3] = viewMatrix[3] * reference_distance / world_radius;
+    gl_Position = projectionMatrix * scaleMatrix * displaced;
+    view_direction_v = -position_v.xyz;
+    view_direction_v.y = 0.;
+    view_direction_v = normalize(view_direction_v);
+    view_origin_v = view_matrix_inverse[3].xyz * reference_distance;
+    view_origin_v.y = 0.;
+    view_origin_v = normalize(view_origin_v);
+    // NOTE: this must be called after all varyings are written, since it reads from them
+    rgb_intensity_v = get_rgb_intensity_of_surface_of_world();
+}
+`;
+realistic_vertex_shader_templates.texture = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+varying vec3 view_direction_v;
+varying vec3 view_origin_v;
+varying vec4 position_v;
+// WORLD PROPERTIES
+uniform float sealevel;
+uniform float world_radius;
+attribute float displacement;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
+attribute float surface_temperature;
+attribute float snow_coverage;
+attribute float plant_coverage;
+attribute float scalar;
+attribute vec3 vector;
+varying float displacement_v;
+varying vec3 gradient_v;
+varying float surface_temperature_v;
+varying float snow_coverage_v;
+varying float plant_coverage_v;
+varying float scalar_v;
+// MISCELLANEOUS PROPERTIES
+uniform float map_projection_offset;
+uniform float animation_phase_angle;
+attribute float vector_fraction_traversed;
+varying float vector_fraction_traversed_v;
+// LIGHTING PROPERTIES
+// NOTE: the surface is lit once per vertex, see "vertex_lighting.glsl.c"
+varying vec3 rgb_intensity_v;
+// "vertex_lighting.glsl.c" lets map projection vertex shaders light the surface of a world once per vertex,
+//   using the same model that "fragment/realistic.glsl.c" uses once per pixel.
+// It is only included by "template.glsl.c" if "VERTEX_LIGHTING" is defined, see get_realistic_vertex_shader() in "precompiled/Shaders.js"
+// NOTE: "math/constants.glsl.c" is already included by "template.glsl.c"
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// "realistic_surface.glsl.c" finds the light that's emitted or reflected by the surface of a world, for "realistic" shaders.
+// It is shared by the fragment shader "realistic.glsl.c", which lights every pixel,
+//   by map projection vertex shaders that are compiled with "VERTEX_LIGHTING", which light every vertex,
+//   and by the native renderer, see "precompiled/cpp/realistic.hpp".
+// It expects the includer to have included the academics layer.
+// Under GL_ES, it also expects the includer to have declared the uniforms "sealevel" and "world_radius",
+//   and the varyings that are declared in "vertex/template.glsl.c", from which it reads the properties of the surface.
+// It is specialized by constants that are described in get_realistic_fragment_shader() of "precompiled/Shaders.js":
+//   "VARIANT_LIGHT_COUNT"   the most light sources the shader loops over, "light_count" may be smaller
+//   "VARIANT_HAS_OCEAN"     whether the ocean can be visible
+//   "VARIANT_HAS_SPECULAR"  whether surfaces can have specular reflection
+//   "VARIANT_HAS_EXACT_EMISSION" whether to evaluate emission exactly, even if a lookup table is available
+// VIEW SETTINGS ---------------------------------------------------------------
+uniform float ocean_visibility;
+uniform float sediment_visibility;
+uniform float plant_visibility;
+uniform float snow_visibility;
+uniform float shadow_visibility;
+uniform float specular_visibility;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+// SEA PROPERTIES -------------------------------------------------------
+uniform vec3 ocean_rayleigh_scattering_coefficients;
+uniform vec3 ocean_mie_scattering_coefficients;
+uniform vec3 ocean_absorption_coefficients;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position; // location for the center of the world, in meters
+// "SOLAR_RGB_LUMINOSITY" is the rgb luminosity of earth's sun, in Watts.
+//   It is used to convert the above true color values to absorption coefficients.
+//   You can also generate these numbers by calling solve_rgb_intensity_of_light_emitted_by_black_body(SOLAR_TEMPERATURE)
+const vec3 SOLAR_RGB_LUMINOSITY = vec3(7247419., 8223259., 8121487.);
+const float AIR_REFRACTIVE_INDEX = 1.000277;
+const float WATER_REFRACTIVE_INDEX = 1.333;
+const float WATER_ROOT_MEAN_SLOPE_SQUARED = 0.18;
+const vec3 LAND_COLOR_MAFIC = vec3(50,45,50)/255.; // observed on lunar maria 
+const vec3 LAND_COLOR_FELSIC = vec3(214,181,158)/255.; // observed color of rhyolite sample
+const vec3 LAND_COLOR_SAND = vec3(245,215,145)/255.;
+const vec3 LAND_COLOR_PEAT = vec3(100,85,60)/255.;
+const float LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE = 0.04; // NOTE: "0.04" is a representative value for plastics and other diffuse reflectors
+const float LAND_ROOT_MEAN_SLOPE_SQUARED = 0.2;
+const vec3 JUNGLE_COLOR = vec3(30,50,10)/255.;
+const float JUNGLE_ROOT_MEAN_SLOPE_SQUARED = 30.0;
+const vec3 SNOW_COLOR = vec3(0.9, 0.9, 0.9);
+const float SNOW_REFRACTIVE_INDEX = 1.333;
+// TODO: calculate airglow for nightside using scattering equations from atmosphere.glsl.c, 
+//   also keep in mind this: https://en.wikipedia.org/wiki/Airglow
+const float AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR = 0.000001;
+// TODO: multiple scattering events
+// TODO: support for light sources from within atmosphere
+// "get_rgb_intensity_of_light_from_surface_of_world" 
+//   traces a ray of light through the atmosphere and into a surface,
+// NOTE: this function does not trace the ray out of the atmosphere,
+//   since that is a job that only our atmosphere shader is capable of doing.
+//   Nor does it determine emission, since it is designed to be looped 
+//   over several light sources, and this would oversaturate the contribution from emission.
+vec3 get_rgb_intensity_of_light_from_surface_of_world(
+    // light properties
+    in vec3 light_direction,
+    in vec3 light_rgb_intensity,
+    // atmoshere properties
+    in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 atmosphere_beta_ray,
+    in vec3 atmosphere_beta_mie,
+    in vec3 atmosphere_beta_abs,
+    in float atmosphere_ambient_light_factor,
+    // surface properties
+    in vec3 surface_position,
+    in vec3 surface_normal,
+    in float surface_slope_root_mean_squared,
+    in vec3 surface_diffuse_color_rgb_fraction,
+    in vec3 surface_specular_color_rgb_fraction,
+    // ocean properties
+    in float ocean_depth,
+    in vec3 ocean_beta_ray,
+    in vec3 ocean_beta_mie,
+    in vec3 ocean_beta_abs,
+    // view properties
+    in vec3 view_direction
+){
+    // NOTE: the single letter variable names here are industry standard, learn them!
+    // Uppercase indicates vectors
+    // lowercase indicates scalars
+    // "P" is the origin of the rays: the surface of the planet
+    vec3 P = surface_position;
+    // "N" is the surface normal
+    vec3 N = surface_normal;
+    // "V" is the normal vector indicating the direction from the view
+    // TODO: standardize view_direction as view from surface to camera
+    vec3 V = view_direction;
+    // "L" is the normal vector indicating the direction to the light source
+    vec3 L = light_direction;
+    // "H" is the halfway vector between normal and view.
+    // It represents the surface normal that's needed to cause reflection.
+    // It can also be thought of as the surface normal of a microfacet that's 
+    //   producing the reflections seen by the camera.
+    vec3 H = normalize(V+L);
+    // Here we setup  several useful dot products of unit vectors
+    //   we can think of them as the cosines of the angles formed between them,
+    //   or their "cosine similarity": https://en.wikipedia.org/wiki/Cosine_similarity
+    float LV = dot(L,V);
+    float NV = abs(dot(N,V));
+    float NL = abs(dot(N,L));
+    float NH = dot(N,H);
+    float HV = max(dot(V,H), 0.);
+    // "F0" is the characteristic fresnel reflectance.
+    //   it is the fraction of light that's immediately reflected when striking the surface head on.
+    vec3 F0 = surface_specular_color_rgb_fraction;
+    // "m" is the "ROOT_MEAN_SLOPE_SQUARED", the root mean square of the slope of all microfacets 
+    // see https://www.desmos.com/calculator/0tqwgsjcje for a way to estimate it using a function to describe the surface
+    float m = surface_slope_root_mean_squared;
+    // "D" is the diffuse reflection fraction, essentially the color of the surface
+    vec3 D = surface_diffuse_color_rgb_fraction;
+    // "I_sun" is the rgb Intensity of Incoming Incident light, A.K.A. "Insolation"
+    vec3 I_sun = light_rgb_intensity;
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    vec3 I_surface = I_sun
+      * get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+            // NOTE: we nudge the origin of light ray by a small amount so that collision isn't detected with the world
+            1.000001 * P, L, 3.*world_radius, vec3(0), world_radius,
+            atmosphere_scale_height, atmosphere_beta_ray, atmosphere_beta_mie, atmosphere_beta_abs
+        );
+    // "E_surface_reflected" is the intensity of light that is immediately reflected by the surface, A.K.A. "specular" reflection
+    vec3 E_surface_reflected = !VARIANT_HAS_SPECULAR? vec3(0) : I_surface
+        * get_rgb_fraction_of_light_reflected_on_surface(HV, F0)
+        * get_fraction_of_light_masked_or_shaded_by_surface(NV, m)
+        * get_fraction_of_microfacets_with_angle(NH, m)
+        / (4.*PI); // NOTE: NV*VL should appear here in the denominator, but I can't get it to work
+    // "I_surface_refracted" is the intensity of light that is not immediately reflected, 
+    //   but penetrates into the material, either to be absorbed, scattered away, 
+    //   or scattered back to the view as diffuse reflection.
+    // We would ideally like to negate the integral of reflectance over all possible angles, 
+    //   but finding that is hard, so let's just negate the reflectance for the angle at which it occurs the most, or "HV"
+    vec3 I_surface_refracted = !VARIANT_HAS_SPECULAR? I_surface :
+        I_surface * (1. - get_rgb_fraction_of_light_reflected_on_surface(HV, F0));
+      //+ I_sun     *  atmosphere_ambient_light_factor;
+    // If sea is present, "E_ocean_scattered" is the rgb intensity of light 
+    //   scattered by the sea towards the camera. Otherwise, it equals 0.
+    vec3 E_ocean_scattered = !VARIANT_HAS_OCEAN? vec3(0) :
+        get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+            NV, NL, LV, ocean_depth, I_surface_refracted,
+            ocean_beta_ray, ocean_beta_mie, ocean_beta_abs
+        );
+    // if sea is present, "I_ocean_trasmitted" is the rgb intensity of light 
+    //   that reaches the ground after being filtered by air and sea. 
+    //   Otherwise, it equals I_surface_refracted.
+    vec3 I_ocean_trasmitted= !VARIANT_HAS_OCEAN? I_surface_refracted : I_surface_refracted
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NL, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    // "E_diffuse" is diffuse reflection of any nontrasparent component beneath the transparent surface,
+    // It effectively describes diffuse reflection as understood within the phong model of reflectance.
+    vec3 E_diffuse = I_ocean_trasmitted * NL * surface_diffuse_color_rgb_fraction;
+    // if sea is present, "E_ocean_transmitted" is the fraction 
+    //   of E_diffuse that makes it out of the sea. Otheriwse, it equals E_diffuse
+    vec3 E_ocean_transmitted = !VARIANT_HAS_OCEAN? E_diffuse : E_diffuse
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NV, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    return
+        E_surface_reflected
+      + E_ocean_transmitted
+      + E_ocean_scattered;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer.
+// Its arguments are named after the uniforms and varyings that are passed to it by the overload below.
+vec3 get_rgb_intensity_of_surface_of_world(
+    // view settings
+    in float ocean_visibility,
+    in float sediment_visibility,
+    in float plant_visibility,
+    in float snow_visibility,
+    in float shadow_visibility,
+    in float specular_visibility,
+    // light properties
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    // atmosphere properties
+    in float atmosphere_scale_height,
+    in vec3 surface_air_rayleigh_scattering_coefficients,
+    in vec3 surface_air_mie_scattering_coefficients,
+    in vec3 surface_air_absorption_coefficients,
+    // sea properties
+    in float sealevel,
+    in vec3 ocean_rayleigh_scattering_coefficients,
+    in vec3 ocean_mie_scattering_coefficients,
+    in vec3 ocean_absorption_coefficients,
+    // world properties
+    in float world_radius,
+    // surface properties
+    in float displacement,
+    in vec3 gradient,
+    in float plant_coverage,
+    in float snow_coverage,
+    in float surface_temperature,
+    in vec3 position,
+    // view properties
+    in vec3 view_direction
+){
+    bool is_ocean = sealevel > displacement;
+    bool is_visible_ocean = VARIANT_HAS_OCEAN && sealevel * ocean_visibility > displacement;
+    float ocean_depth = VARIANT_HAS_OCEAN? max(sealevel*ocean_visibility - displacement, 0.) : 0.;
+    float surface_height = max(displacement - sealevel*ocean_visibility, 0.);
+    // TODO: pass felsic_coverage in from attribute
+    // we currently guess how much rock is felsic depending on displacement
+    // Absorption coefficients are physically based.
+    // Scattering coefficients have been determined aesthetically.
+    float felsic_coverage = smoothstep(sealevel - 4000., sealevel+5000., displacement);
+    float mineral_coverage = displacement > sealevel? smoothstep(sealevel + 10000., sealevel, displacement) : 0.;
+    float organic_coverage = smoothstep(30., -30., surface_temperature);
+    float visible_plant_coverage = plant_coverage * (!is_visible_ocean? 1. : 0.);
+    // TODO: more sensible microfacet model
+    vec3 color_of_bedrock = mix(LAND_COLOR_MAFIC, LAND_COLOR_FELSIC, felsic_coverage);
+    vec3 color_with_sediment = mix(color_of_bedrock, mix(LAND_COLOR_SAND, LAND_COLOR_PEAT, organic_coverage), mineral_coverage * sediment_visibility);
+    vec3 color_with_plants = mix(color_with_sediment, JUNGLE_COLOR, !is_ocean? visible_plant_coverage * plant_visibility * sediment_visibility : 0.);
+    vec3 color_with_snow = mix(color_with_plants, SNOW_COLOR, snow_coverage * snow_visibility);
+    // "n" is the surface normal for a perfectly smooth sphere
+    vec3 n = normalize(position);
+    vec3 surface_position =
+        n * (world_radius + surface_height);
+    vec3 surface_normal =
+        normalize(n + gradient);
+    float surface_slope_root_mean_squared =
+        is_visible_ocean?
+            WATER_ROOT_MEAN_SLOPE_SQUARED :
+            mix(LAND_ROOT_MEAN_SLOPE_SQUARED, JUNGLE_ROOT_MEAN_SLOPE_SQUARED, visible_plant_coverage);
+    vec3 surface_diffuse_color_rgb_fraction =
+        get_rgb_intensity_of_rgb_signal(color_with_snow);
+    // TODO: model refractive index as a function of wavelength
+    vec3 surface_specular_color_rgb_fraction = !VARIANT_HAS_SPECULAR? vec3(0) :
+        shadow_visibility * specular_visibility * // turn off specular reflection if darkness is disabled
+        vec3(mix(
+            is_visible_ocean?
+            get_fraction_of_light_reflected_on_surface_head_on(WATER_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX) :
+            LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE,
+            get_fraction_of_light_reflected_on_surface_head_on(SNOW_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX),
+            snow_coverage*snow_visibility
+        ));
+    float ocean_visible_depth = mix(ocean_depth, 0., snow_coverage*snow_coverage*snow_coverage*snow_visibility);
+    vec3 E_surface_reemitted = vec3(0);
+    for (int i = 0; i < VARIANT_LIGHT_COUNT; ++i)
+    {
+        if (i >= light_count){ break; }
+        vec3 light_direction = normalize(mix(n, light_directions[i], shadow_visibility));
+        vec3 light_rgb_intensity = light_rgb_intensities[i];
+        E_surface_reemitted +=
+            get_rgb_intensity_of_light_from_surface_of_world(
+                // light properties
+                light_direction,
+                light_rgb_intensity,
+                // atmosphere properties
+                world_radius,
+                atmosphere_scale_height,
+                surface_air_rayleigh_scattering_coefficients,
+                surface_air_mie_scattering_coefficients,
+                surface_air_absorption_coefficients,
+                AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR,
+                // surface properties
+                surface_position,
+                surface_normal,
+                surface_slope_root_mean_squared,
+                surface_diffuse_color_rgb_fraction,
+                surface_specular_color_rgb_fraction,
+                // ocean properties
+                ocean_visible_depth,
+                ocean_rayleigh_scattering_coefficients,
+                ocean_mie_scattering_coefficients,
+                ocean_absorption_coefficients,
+                // view properties
+                -view_direction
+            );
+    }
+    vec3 E_surface_emitted = solve_rgb_intensity_of_light_emitted_by_black_body(surface_temperature);
+    // NOTE: we do not filter E_total by atmospheric scattering
+    //   that job is done by the atmospheric shader pass, in "atmosphere.glsl.c"
+    vec3 E_total =
+          E_surface_emitted
+        + E_surface_reemitted;
+    return E_total;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer,
+//   for the surface that's described by the varyings of "vertex/template.glsl.c".
+// In a vertex shader, those varyings must be written before it is called.
+vec3 get_rgb_intensity_of_surface_of_world(){
+    return get_rgb_intensity_of_surface_of_world(
+        ocean_visibility, sediment_visibility, plant_visibility, snow_visibility, shadow_visibility, specular_visibility,
+        light_directions, light_rgb_intensities, light_count,
+        atmosphere_scale_height,
+        surface_air_rayleigh_scattering_coefficients,
+        surface_air_mie_scattering_coefficients,
+        surface_air_absorption_coefficients,
+        sealevel,
+        ocean_rayleigh_scattering_coefficients,
+        ocean_mie_scattering_coefficients,
+        ocean_absorption_coefficients,
+        world_radius,
+        displacement_v, gradient_v, plant_coverage_v, snow_coverage_v, surface_temperature_v, position_v.xyz,
+        view_direction_v
+    );
+}
+float lon(vec3 pos) {
+    return atan(-pos.z, pos.x) + PI;
+}
+float lat(vec3 pos) {
+    return asin(pos.y / length(pos));
+}
+void main() {
+    displacement_v = displacement;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
+    plant_coverage_v = plant_coverage;
+    snow_coverage_v = snow_coverage;
+    surface_temperature_v = surface_temperature;
+    scalar_v = scalar;
+    position_v = modelMatrix * vec4( position, 1.0 );
+    float index_offset = map_projection_offset;
+    float focus = lon(cameraPosition) + index_offset;
+    float lon_focused = mod(lon(position_v.xyz) - focus, 2.*PI) - PI + index_offset;
+    float lat_focused = lat(position_v.xyz); //+ (map_projection_offset*PI);
+    float height = displacement > sealevel? 0.005 : 0.0;
+    gl_Position = vec4(
+        lon_focused / PI,
+        lat_focused / (PI/2.),
+        -height,
+        1);
+    view_direction_v = -position_v.xyz;
+    view_direction_v.y = 0.;
+    view_direction_v = normalize(view_direction_v);
+    view_origin_v = view_matrix_inverse[3].xyz * reference_distance;
+    view_origin_v.y = 0.;
+    view_origin_v = normalize(view_origin_v);
+    // NOTE: this must be called after all varyings are written, since it reads from them
+    rgb_intensity_v = get_rgb_intensity_of_surface_of_world();
+}
+`;
+// "realistic" is specialized for each view, see get_realistic_fragment_shader() below
+var realistic_fragment_shader_templates = {};
+realistic_fragment_shader_templates.realistic = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// This shader is never compiled as is, it is specialized by get_realistic_fragment_shader() in "precompiled/Shaders.js",
+//   which declares constants ahead of it so that glsl compilers can drop code the view never needs,
+//   see "realistic_surface.glsl.c" for what they are.
+// Determines the length of a unit of distance within the view, in meters, 
+// it is generally the radius of whatever world's the focus for the scene.
+// The view uses different units for length to prevent certain issues with
+// floating point precision. 
+// VIEW SETTINGS ---------------------------------------------------------------
+uniform float reference_distance;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+// SEA PROPERTIES -------------------------------------------------------
+uniform float sealevel;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius; // radius of the world being rendered, in meters
+varying float displacement_v;
+varying vec3 gradient_v;
+varying float plant_coverage_v;
+varying float snow_coverage_v;
+varying float scalar_v;
+varying float surface_temperature_v;
+varying vec4 position_v;
+varying vec3 view_direction_v;
+// "realistic_surface.glsl.c" finds the light that's emitted or reflected by the surface of a world, for "realistic" shaders.
+// It is shared by the fragment shader "realistic.glsl.c", which lights every pixel,
+//   by map projection vertex shaders that are compiled with "VERTEX_LIGHTING", which light every vertex,
+//   and by the native renderer, see "precompiled/cpp/realistic.hpp".
+// It expects the includer to have included the academics layer.
+// Under GL_ES, it also expects the includer to have declared the uniforms "sealevel" and "world_radius",
+//   and the varyings that are declared in "vertex/template.glsl.c", from which it reads the properties of the surface.
+// It is specialized by constants that are described in get_realistic_fragment_shader() of "precompiled/Shaders.js":
+//   "VARIANT_LIGHT_COUNT"   the most light sources the shader loops over, "light_count" may be smaller
+//   "VARIANT_HAS_OCEAN"     whether the ocean can be visible
+//   "VARIANT_HAS_SPECULAR"  whether surfaces can have specular reflection
+//   "VARIANT_HAS_EXACT_EMISSION" whether to evaluate emission exactly, even if a lookup table is available
+// VIEW SETTINGS ---------------------------------------------------------------
+uniform float ocean_visibility;
+uniform float sediment_visibility;
+uniform float plant_visibility;
+uniform float snow_visibility;
+uniform float shadow_visibility;
+uniform float specular_visibility;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+// SEA PROPERTIES -------------------------------------------------------
+uniform vec3 ocean_rayleigh_scattering_coefficients;
+uniform vec3 ocean_mie_scattering_coefficients;
+uniform vec3 ocean_absorption_coefficients;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position; // location for the center of the world, in meters
+// "SOLAR_RGB_LUMINOSITY" is the rgb luminosity of earth's sun, in Watts.
+//   It is used to convert the above true color values to absorption coefficients.
+//   You can also generate these numbers by calling solve_rgb_intensity_of_light_emitted_by_black_body(SOLAR_TEMPERATURE)
+const vec3 SOLAR_RGB_LUMINOSITY = vec3(7247419., 8223259., 8121487.);
+const float AIR_REFRACTIVE_INDEX = 1.000277;
+const float WATER_REFRACTIVE_INDEX = 1.333;
+const float WATER_ROOT_MEAN_SLOPE_SQUARED = 0.18;
+const vec3 LAND_COLOR_MAFIC = vec3(50,45,50)/255.; // observed on lunar maria 
+const vec3 LAND_COLOR_FELSIC = vec3(214,181,158)/255.; // observed color of rhyolite sample
+const vec3 LAND_COLOR_SAND = vec3(245,215,145)/255.;
+const vec3 LAND_COLOR_PEAT = vec3(100,85,60)/255.;
+const float LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE = 0.04; // NOTE: "0.04" is a representative value for plastics and other diffuse reflectors
+const float LAND_ROOT_MEAN_SLOPE_SQUARED = 0.2;
+const vec3 JUNGLE_COLOR = vec3(30,50,10)/255.;
+const float JUNGLE_ROOT_MEAN_SLOPE_SQUARED = 30.0;
+const vec3 SNOW_COLOR = vec3(0.9, 0.9, 0.9);
+const float SNOW_REFRACTIVE_INDEX = 1.333;
+// TODO: calculate airglow for nightside using scattering equations from atmosphere.glsl.c, 
+//   also keep in mind this: https://en.wikipedia.org/wiki/Airglow
+const float AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR = 0.000001;
+// TODO: multiple scattering events
+// TODO: support for light sources from within atmosphere
+// "get_rgb_intensity_of_light_from_surface_of_world" 
+//   traces a ray of light through the atmosphere and into a surface,
+// NOTE: this function does not trace the ray out of the atmosphere,
+//   since that is a job that only our atmosphere shader is capable of doing.
+//   Nor does it determine emission, since it is designed to be looped 
+//   over several light sources, and this would oversaturate the contribution from emission.
+vec3 get_rgb_intensity_of_light_from_surface_of_world(
+    // light properties
+    in vec3 light_direction,
+    in vec3 light_rgb_intensity,
+    // atmoshere properties
+    in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 atmosphere_beta_ray,
+    in vec3 atmosphere_beta_mie,
+    in vec3 atmosphere_beta_abs,
+    in float atmosphere_ambient_light_factor,
+    // surface properties
+    in vec3 surface_position,
+    in vec3 surface_normal,
+    in float surface_slope_root_mean_squared,
+    in vec3 surface_diffuse_color_rgb_fraction,
+    in vec3 surface_specular_color_rgb_fraction,
+    // ocean properties
+    in float ocean_depth,
+    in vec3 ocean_beta_ray,
+    in vec3 ocean_beta_mie,
+    in vec3 ocean_beta_abs,
+    // view properties
+    in vec3 view_direction
+){
+    // NOTE: the single letter variable names here are industry standard, learn them!
+    // Uppercase indicates vectors
+    // lowercase indicates scalars
+    // "P" is the origin of the rays: the surface of the planet
+    vec3 P = surface_position;
+    // "N" is the surface normal
+    vec3 N = surface_normal;
+    // "V" is the normal vector indicating the direction from the view
+    // TODO: standardize view_direction as view from surface to camera
+    vec3 V = view_direction;
+    // "L" is the normal vector indicating the direction to the light source
+    vec3 L = light_direction;
+    // "H" is the halfway vector between normal and view.
+    // It represents the surface normal that's needed to cause reflection.
+    // It can also be thought of as the surface normal of a microfacet that's 
+    //   producing the reflections seen by the camera.
+    vec3 H = normalize(V+L);
+    // Here we setup  several useful dot products of unit vectors
+    //   we can think of them as the cosines of the angles formed between them,
+    //   or their "cosine similarity": https://en.wikipedia.org/wiki/Cosine_similarity
+    float LV = dot(L,V);
+    float NV = abs(dot(N,V));
+    float NL = abs(dot(N,L));
+    float NH = dot(N,H);
+    float HV = max(dot(V,H), 0.);
+    // "F0" is the characteristic fresnel reflectance.
+    //   it is the fraction of light that's immediately reflected when striking the surface head on.
+    vec3 F0 = surface_specular_color_rgb_fraction;
+    // "m" is the "ROOT_MEAN_SLOPE_SQUARED", the root mean square of the slope of all microfacets 
+    // see https://www.desmos.com/calculator/0tqwgsjcje for a way to estimate it using a function to describe the surface
+    float m = surface_slope_root_mean_squared;
+    // "D" is the diffuse reflection fraction, essentially the color of the surface
+    vec3 D = surface_diffuse_color_rgb_fraction;
+    // "I_sun" is the rgb Intensity of Incoming Incident light, A.K.A. "Insolation"
+    vec3 I_sun = light_rgb_intensity;
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    vec3 I_surface = I_sun
+      * get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+            // NOTE: we nudge the origin of light ray by a small amount so that collision isn't detected with the world
+            1.000001 * P, L, 3.*world_radius, vec3(0), world_radius,
+            atmosphere_scale_height, atmosphere_beta_ray, atmosphere_beta_mie, atmosphere_beta_abs
+        );
+    // "E_surface_reflected" is the intensity of light that is immediately reflected by the surface, A.K.A. "specular" reflection
+    vec3 E_surface_reflected = !VARIANT_HAS_SPECULAR? vec3(0) : I_surface
+        * get_rgb_fraction_of_light_reflected_on_surface(HV, F0)
+        * get_fraction_of_light_masked_or_shaded_by_surface(NV, m)
+        * get_fraction_of_microfacets_with_angle(NH, m)
+        / (4.*PI); // NOTE: NV*VL should appear here in the denominator, but I can't get it to work
+    // "I_surface_refracted" is the intensity of light that is not immediately reflected, 
+    //   but penetrates into the material, either to be absorbed, scattered away, 
+    //   or scattered back to the view as diffuse reflection.
+    // We would ideally like to negate the integral of reflectance over all possible angles, 
+    //   but finding that is hard, so let's just negate the reflectance for the angle at which it occurs the most, or "HV"
+    vec3 I_surface_refracted = !VARIANT_HAS_SPECULAR? I_surface :
+        I_surface * (1. - get_rgb_fraction_of_light_reflected_on_surface(HV, F0));
+      //+ I_sun     *  atmosphere_ambient_light_factor;
+    // If sea is present, "E_ocean_scattered" is the rgb intensity of light 
+    //   scattered by the sea towards the camera. Otherwise, it equals 0.
+    vec3 E_ocean_scattered = !VARIANT_HAS_OCEAN? vec3(0) :
+        get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+            NV, NL, LV, ocean_depth, I_surface_refracted,
+            ocean_beta_ray, ocean_beta_mie, ocean_beta_abs
+        );
+    // if sea is present, "I_ocean_trasmitted" is the rgb intensity of light 
+    //   that reaches the ground after being filtered by air and sea. 
+    //   Otherwise, it equals I_surface_refracted.
+    vec3 I_ocean_trasmitted= !VARIANT_HAS_OCEAN? I_surface_refracted : I_surface_refracted
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NL, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    // "E_diffuse" is diffuse reflection of any nontrasparent component beneath the transparent surface,
+    // It effectively describes diffuse reflection as understood within the phong model of reflectance.
+    vec3 E_diffuse = I_ocean_trasmitted * NL * surface_diffuse_color_rgb_fraction;
+    // if sea is present, "E_ocean_transmitted" is the fraction 
+    //   of E_diffuse that makes it out of the sea. Otheriwse, it equals E_diffuse
+    vec3 E_ocean_transmitted = !VARIANT_HAS_OCEAN? E_diffuse : E_diffuse
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NV, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    return
+        E_surface_reflected
+      + E_ocean_transmitted
+      + E_ocean_scattered;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer.
+// Its arguments are named after the uniforms and varyings that are passed to it by the overload below.
+vec3 get_rgb_intensity_of_surface_of_world(
+    // view settings
+    in float ocean_visibility,
+    in float sediment_visibility,
+    in float plant_visibility,
+    in float snow_visibility,
+    in float shadow_visibility,
+    in float specular_visibility,
+    // light properties
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    // atmosphere properties
+    in float atmosphere_scale_height,
+    in vec3 surface_air_rayleigh_scattering_coefficients,
+    in vec3 surface_air_mie_scattering_coefficients,
+    in vec3 surface_air_absorption_coefficients,
+    // sea properties
+    in float sealevel,
+    in vec3 ocean_rayleigh_scattering_coefficients,
+    in vec3 ocean_mie_scattering_coefficients,
+    in vec3 ocean_absorption_coefficients,
+    // world properties
+    in float world_radius,
+    // surface properties
+    in float displacement,
+    in vec3 gradient,
+    in float plant_coverage,
+    in float snow_coverage,
+    in float surface_temperature,
+    in vec3 position,
+    // view properties
+    in vec3 view_direction
+){
+    bool is_ocean = sealevel > displacement;
+    bool is_visible_ocean = VARIANT_HAS_OCEAN && sealevel * ocean_visibility > displacement;
+    float ocean_depth = VARIANT_HAS_OCEAN? max(sealevel*ocean_visibility - displacement, 0.) : 0.;
+    float surface_height = max(displacement - sealevel*ocean_visibility, 0.);
+    // TODO: pass felsic_coverage in from attribute
+    // we currently guess how much rock is felsic depending on displacement
+    // Absorption coefficients are physically based.
+    // Scattering coefficients have been determined aesthetically.
+    float felsic_coverage = smoothstep(sealevel - 4000., sealevel+5000., displacement);
+    float mineral_coverage = displacement > sealevel? smoothstep(sealevel + 10000., sealevel, displacement) : 0.;
+    float organic_coverage = smoothstep(30., -30., surface_temperature);
+    float visible_plant_coverage = plant_coverage * (!is_visible_ocean? 1. : 0.);
+    // TODO: more sensible microfacet model
+    vec3 color_of_bedrock = mix(LAND_COLOR_MAFIC, LAND_COLOR_FELSIC, felsic_coverage);
+    vec3 color_with_sediment = mix(color_of_bedrock, mix(LAND_COLOR_SAND, LAND_COLOR_PEAT, organic_coverage), mineral_coverage * sediment_visibility);
+    vec3 color_with_plants = mix(color_with_sediment, JUNGLE_COLOR, !is_ocean? visible_plant_coverage * plant_visibility * sediment_visibility : 0.);
+    vec3 color_with_snow = mix(color_with_plants, SNOW_COLOR, snow_coverage * snow_visibility);
+    // "n" is the surface normal for a perfectly smooth sphere
+    vec3 n = normalize(position);
+    vec3 surface_position =
+        n * (world_radius + surface_height);
+    vec3 surface_normal =
+        normalize(n + gradient);
+    float surface_slope_root_mean_squared =
+        is_visible_ocean?
+            WATER_ROOT_MEAN_SLOPE_SQUARED :
+            mix(LAND_ROOT_MEAN_SLOPE_SQUARED, JUNGLE_ROOT_MEAN_SLOPE_SQUARED, visible_plant_coverage);
+    vec3 surface_diffuse_color_rgb_fraction =
+        get_rgb_intensity_of_rgb_signal(color_with_snow);
+    // TODO: model refractive index as a function of wavelength
+    vec3 surface_specular_color_rgb_fraction = !VARIANT_HAS_SPECULAR? vec3(0) :
+        shadow_visibility * specular_visibility * // turn off specular reflection if darkness is disabled
+        vec3(mix(
+            is_visible_ocean?
+            get_fraction_of_light_reflected_on_surface_head_on(WATER_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX) :
+            LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE,
+            get_fraction_of_light_reflected_on_surface_head_on(SNOW_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX),
+            snow_coverage*snow_visibility
+        ));
+    float ocean_visible_depth = mix(ocean_depth, 0., snow_coverage*snow_coverage*snow_coverage*snow_visibility);
+    vec3 E_surface_reemitted = vec3(0);
+    for (int i = 0; i < VARIANT_LIGHT_COUNT; ++i)
+    {
+        if (i >= light_count){ break; }
+        vec3 light_direction = normalize(mix(n, light_directions[i], shadow_visibility));
+        vec3 light_rgb_intensity = light_rgb_intensities[i];
+        E_surface_reemitted +=
+            get_rgb_intensity_of_light_from_surface_of_world(
+                // light properties
+                light_direction,
+                light_rgb_intensity,
+                // atmosphere properties
+                world_radius,
+                atmosphere_scale_height,
+                surface_air_rayleigh_scattering_coefficients,
+                surface_air_mie_scattering_coefficients,
+                surface_air_absorption_coefficients,
+                AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR,
+                // surface properties
+                surface_position,
+                surface_normal,
+                surface_slope_root_mean_squared,
+                surface_diffuse_color_rgb_fraction,
+                surface_specular_color_rgb_fraction,
+                // ocean properties
+                ocean_visible_depth,
+                ocean_rayleigh_scattering_coefficients,
+                ocean_mie_scattering_coefficients,
+                ocean_absorption_coefficients,
+                // view properties
+                -view_direction
+            );
+    }
+    vec3 E_surface_emitted = solve_rgb_intensity_of_light_emitted_by_black_body(surface_temperature);
+    // NOTE: we do not filter E_total by atmospheric scattering
+    //   that job is done by the atmospheric shader pass, in "atmosphere.glsl.c"
+    vec3 E_total =
+          E_surface_emitted
+        + E_surface_reemitted;
+    return E_total;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer,
+//   for the surface that's described by the varyings of "vertex/template.glsl.c".
+// In a vertex shader, those varyings must be written before it is called.
+vec3 get_rgb_intensity_of_surface_of_world(){
+    return get_rgb_intensity_of_surface_of_world(
+        ocean_visibility, sediment_visibility, plant_visibility, snow_visibility, shadow_visibility, specular_visibility,
+        light_directions, light_rgb_intensities, light_count,
+        atmosphere_scale_height,
+        surface_air_rayleigh_scattering_coefficients,
+        surface_air_mie_scattering_coefficients,
+        surface_air_absorption_coefficients,
+        sealevel,
+        ocean_rayleigh_scattering_coefficients,
+        ocean_mie_scattering_coefficients,
+        ocean_absorption_coefficients,
+        world_radius,
+        displacement_v, gradient_v, plant_coverage_v, snow_coverage_v, surface_temperature_v, position_v.xyz,
+        view_direction_v
+    );
+}
+void main() {
+    vec3 E_total = get_rgb_intensity_of_surface_of_world();
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(E_total/insolation_max),1);
+}
+`;
+fragmentShaders.surface_normal_map = `
+varying float displacement_v;
+varying vec3 gradient_v;
+varying vec4 position_v;
+uniform float sealevel;
+uniform float ocean_visibility;
+void main() {
+    // CODE to generate a tangent-space normal map:
+    // "n" is the surface normal for a perfectly smooth sphere
+    vec3 n = normalize(position_v.xyz);
+    // "N" is the actual surface normal as reported by the gradient of displacement
+    vec3 N = normalize(n + gradient_v);
     // "j" is coordinate basis for the y axis
     vec3 j = vec3(0,1,0);
     // "u" is the left/right axis on a uv map
@@ -1679,65 +4569,7158 @@ void main() {
     // in other words, we take the dot product between n and the respective u/v/n coordinate bases.
     gl_FragColor = vec4((2.*vec3(dot(N, u), dot(N, v), dot(N, n))-1.), 1);
 }
-`;
-fragmentShaders.topographic = `
-varying float displacement_v;
-varying float plant_coverage_v;
-varying float snow_coverage_v;
-varying float scalar_v;
-varying vec4 position_v;
-uniform float sealevel;
-uniform float ocean_visibility;
-//converts a float ranging from [-1,1] to a topographic map visualization
-//credit goes to Gaëtan Renaudeau: http://greweb.me/glsl.js/examples/heatmap/
-void main() {
-    //deep ocean
-    vec3 color = vec3(0,0,0.8);
-    //shallow ocean
-    color = mix(
-        color,
-        vec3(0.5,0.5,1),
-        smoothstep(-1., -0.01, scalar_v)
-    );
-    //lowland
-    color = mix(
-        color,
-        vec3(0,0.55,0),
-        smoothstep(-0.01, 0.01, scalar_v)
-    );
-    //highland
-    color = mix(
-        color,
-        vec3(0.95,0.95,0),
-        smoothstep(0., 0.45, scalar_v)
-    );
-    //mountain
-    color = mix(
-        color,
-        vec3(0.5,0.5,0),
-        smoothstep(0.2, 0.7, scalar_v)
+`;
+fragmentShaders.topographic = `
+varying float displacement_v;
+varying float plant_coverage_v;
+varying float snow_coverage_v;
+varying float scalar_v;
+varying vec4 position_v;
+uniform float sealevel;
+uniform float ocean_visibility;
+//converts a float ranging from [-1,1] to a topographic map visualization
+//credit goes to Gaëtan Renaudeau: http://greweb.me/glsl.js/examples/heatmap/
+void main() {
+    //deep ocean
+    vec3 color = vec3(0,0,0.8);
+    //shallow ocean
+    color = mix(
+        color,
+        vec3(0.5,0.5,1),
+        smoothstep(-1., -0.01, scalar_v)
+    );
+    //lowland
+    color = mix(
+        color,
+        vec3(0,0.55,0),
+        smoothstep(-0.01, 0.01, scalar_v)
+    );
+    //highland
+    color = mix(
+        color,
+        vec3(0.95,0.95,0),
+        smoothstep(0., 0.45, scalar_v)
+    );
+    //mountain
+    color = mix(
+        color,
+        vec3(0.5,0.5,0),
+        smoothstep(0.2, 0.7, scalar_v)
+    );
+    //mountain
+    color = mix(
+        color,
+        vec3(0.5,0.5,0.5),
+        smoothstep(0.4, 0.8, scalar_v)
+    );
+    //snow cap
+    color = mix(
+        color,
+        vec3(0.95),
+        smoothstep(0.75, 1., scalar_v)
+    );
+    gl_FragColor = vec4(color, 1.);
+}
+`;
+fragmentShaders.vector_field = `
+const float PI = 3.14159265358979;
+uniform float animation_phase_angle;
+varying float vector_fraction_traversed_v;
+void main() {
+    float state = (cos(2.*PI*vector_fraction_traversed_v - animation_phase_angle) + 1.) / 2.;
+    gl_FragColor = vec4(state) * vec4(vec3(0.8),0.) + vec4(vec3(0.2),0.);
+}
+`;
+fragmentShaders.air_column_density_lut = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// "air_column_density_lut.glsl.c" builds the lookup table that's described in "raymarching.glsl.c".
+// It is rendered once to a float render target whose dimensions are 
+//   AIR_COLUMN_DENSITY_LUT_WIDTH x AIR_COLUMN_DENSITY_LUT_HEIGHT, 
+//   and again only when the world radius or atmosphere scale height changes.
+varying vec2 vUv;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+void main() {
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec2 ray = get_air_column_density_lut_ray(vUv, r, H);
+    float R = r + ray.x;
+    float cos_zenith = ray.y;
+    // NOTE: "3.*r" is the same distance used to represent space for light rays, see "raymarching.glsl.c"
+    float sigma = approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+        R * cos_zenith, 3.*r, R*R*(1.-cos_zenith*cos_zenith), r, H
+    );
+    gl_FragColor = vec4(sigma);
+}
+`;
+fragmentShaders.multiple_scattering_lut = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// "multiple_scattering_lut.glsl.c" builds the lookup table for multiple scattering that's described in "raymarching.glsl.c".
+// It is rendered to a float render target whose dimensions are 
+//   MULTIPLE_SCATTERING_LUT_WIDTH x MULTIPLE_SCATTERING_LUT_HEIGHT, 
+//   and again only when properties of the world or atmosphere change.
+varying vec2 vUv;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+void main() {
+    vec2 point = get_multiple_scattering_lut_point(vUv, atmosphere_scale_height);
+    gl_FragColor = vec4(
+        get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+            point.x, point.y,
+            world_radius, atmosphere_scale_height,
+            surface_air_rayleigh_scattering_coefficients,
+            surface_air_mie_scattering_coefficients,
+            surface_air_absorption_coefficients
+        ),
+        1.
+    );
+}
+`;
+fragmentShaders.blackbody_lut = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+// "blackbody_lut.glsl.c" builds the lookup table for black body emission that's described in "emission.glsl.c".
+// It is rendered to a float render target whose dimensions are BLACKBODY_LUT_WIDTH x 1, 
+//   and only once, since black body emission only depends on temperature.
+varying vec2 vUv;
+void main() {
+    gl_FragColor = vec4(get_blackbody_lut_texel(get_blackbody_lut_temperature(vUv.x)), 1.);
+}
+`;
+fragmentShaders.atmosphere_scattering = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "atmosphere_scattering" is the first half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It renders the intensity of light that's scattered towards the viewer by the atmosphere, without any light from the background,
+//   and stores whether the view ray is obstructed by the world in the alpha channel.
+// It is meant to be rendered to a float texture that's smaller than the screen, 
+//   and is then upsampled by "atmosphere_upsampling.glsl.c".
+varying vec2 vUv;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position;
+uniform float world_radius;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+void main() {
+    vec2 screenspace = vUv;
+    vec2 clipspace = 2.0 * screenspace - 1.0;
+    vec3 view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3 view_origin = view_matrix_inverse[3].xyz * reference_distance;
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3 beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3 beta_mie = surface_air_mie_scattering_coefficients;
+    vec3 beta_abs = surface_air_absorption_coefficients;
+    vec3 rgb_intensity =
+        get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+            view_origin, view_direction,
+            world_position, world_radius,
+            light_directions, // rgb vectors indicating intensities of light sources
+            light_rgb_intensities, // unit vectors indicating directions to light sources
+            light_count,
+            vec3(0), // background light is added back after upsampling
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+    // the silhouette of the world, which is used to weigh samples during upsampling
+    vec3 P = view_origin - world_position;
+    float xv = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+    gl_FragColor = vec4(rgb_intensity, is_obstructed? 1. : 0.);
+}
+`;
+fragmentShaders.atmosphere_upsampling = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+// "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
+//   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
+//   taking into account the curvature of the world.
+// It does this by making a quadratic approximation for the height above the surface.
+// The derivative of this approximation never reaches 0, and this allows us to find a closed form solution 
+//   for the column density ratio using integration by substitution.
+// "x_start" and "x_stop" are distances along the ray from closest approach.
+//   If there is no intersection, they are the distances from the closest approach to the upper bound.
+//   Negative numbers indicate the rays are firing towards the ground.
+// "z2" is the closest distance from the ray to the center of the world, squared.
+// "r" is the radius of the world.
+// "H" is the scale height of the atmosphere.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    // GUIDE TO VARIABLE NAMES:
+    //  "x*" distance along the ray from closest approach
+    //  "z*" distance from the center of the world at closest approach
+    //  "r*" distance ("radius") from the center of the world
+    //  "h*" distance ("height") from the center of the world
+    //  "*b" variable at which the slope and intercept of the height approximation is sampled
+    //  "*0" variable at which the surface of the world occurs
+    //  "*1" variable at which the top of the atmosphere occurs
+    //  "*2" the square of a variable
+    //  "d*dx" a derivative, a rate of change over distance along the ray
+    // "a" is the factor by which we "stretch out" the quadratic height approximation
+    //   this is done to ensure we do not divide by zero when we perform integration by substitution
+    const float a = 0.45;
+    // "b" is the fraction along the path from the surface to the top of the atmosphere 
+    //   at which we sample for the slope and intercept of our height approximation
+    const float b = 0.45;
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    float r1 = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
+    float x1 = sqrt(max(r1*r1-z2, 0.));
+    float xb = x0+(x1-x0)*b;
+    float rb2 = xb*xb + z2;
+    float rb = sqrt(rb2);
+    float d2hdx2 = z2 / sqrt(rb2*rb2*rb2);
+    float dhdx = xb / rb;
+    float hb = rb - r;
+    float dx0 = x0 -xb;
+    float dx_stop = abs(x_stop )-xb;
+    float dx_start= abs(x_start)-xb;
+    float h0 = (0.5 * a * d2hdx2 * dx0 + dhdx) * dx0 + hb;
+    float h_stop = (0.5 * a * d2hdx2 * dx_stop + dhdx) * dx_stop + hb;
+    float h_start = (0.5 * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+    float rho0 = exp(-h0/H);
+    float sigma =
+        sign(x_stop ) * max(H/dhdx * (rho0 - exp(-h_stop /H)), 0.)
+      - sign(x_start) * max(H/dhdx * (rho0 - exp(-h_start/H)), 0.);
+    // NOTE: we clamp the result to prevent the generation of inifinities and nans, 
+    // which can cause graphical artifacts.
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "atmosphere_upsampling" is the second half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It upsamples the light that was scattered by the atmosphere in "atmosphere_scattering.glsl.c",
+//   then adds light from the background that's transmitted through the atmosphere, which is cheap enough to find for every pixel.
+// Scattered light changes suddenly across the silhouette of the world, so upsampling is bilateral:
+//   of the four nearest texels, those that disagree with the pixel on whether the world obstructs the view are given little weight.
+// The result matches "atmosphere.glsl.c" everywhere but the silhouette.
+varying vec2 vUv;
+uniform sampler2D background_rgb_signal_texture;
+uniform sampler2D scattering_texture;
+uniform vec2 scattering_texture_size;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position;
+uniform float world_radius;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+// "get_weight_of_scattering_sample" returns the weight of a texel from "scattering_texture", 
+//   given its bilinear weight and whether it agrees with the pixel on obstruction.
+// NOTE: weights are never zero, so the sum of weights is never zero
+float get_weight_of_scattering_sample(float bilinear_weight, float sample_obstruction, float pixel_obstruction)
+{
+    return bilinear_weight * mix(1., 1e-3, abs(sample_obstruction - pixel_obstruction));
+}
+vec3 get_rgb_intensity_of_upsampled_scattering(vec2 screenspace, float pixel_obstruction)
+{
+    // NOTE: "scattering_texture" uses nearest filtering, so we can interpolate texels ourselves
+    vec2 texel = screenspace * scattering_texture_size - 0.5;
+    vec2 f = fract(texel);
+    vec2 uv00 = (floor(texel) + 0.5) / scattering_texture_size;
+    vec2 du = vec2(1./scattering_texture_size.x, 0.);
+    vec2 dv = vec2(0., 1./scattering_texture_size.y);
+    vec4 s00 = texture2D(scattering_texture, uv00 );
+    vec4 s10 = texture2D(scattering_texture, uv00 + du );
+    vec4 s01 = texture2D(scattering_texture, uv00 + dv);
+    vec4 s11 = texture2D(scattering_texture, uv00 + du + dv);
+    float w00 = get_weight_of_scattering_sample((1.-f.x)*(1.-f.y), s00.a, pixel_obstruction);
+    float w10 = get_weight_of_scattering_sample(( f.x)*(1.-f.y), s10.a, pixel_obstruction);
+    float w01 = get_weight_of_scattering_sample((1.-f.x)*( f.y), s01.a, pixel_obstruction);
+    float w11 = get_weight_of_scattering_sample(( f.x)*( f.y), s11.a, pixel_obstruction);
+    return (s00.rgb*w00 + s10.rgb*w10 + s01.rgb*w01 + s11.rgb*w11) / (w00 + w10 + w01 + w11);
+}
+void main() {
+    vec2 screenspace = vUv;
+    vec2 clipspace = 2.0 * screenspace - 1.0;
+    vec3 view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3 view_origin = view_matrix_inverse[3].xyz * reference_distance;
+    vec4 background_rgb_signal = texture2D( background_rgb_signal_texture, vUv );
+    vec3 background_rgb_intensity = insolation_max * get_rgb_intensity_of_rgb_signal(background_rgb_signal.rgb);
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3 beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3 beta_mie = surface_air_mie_scattering_coefficients;
+    vec3 beta_abs = surface_air_absorption_coefficients;
+    vec3 P = view_origin - world_position;
+    float xv = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+    vec3 rgb_intensity =
+        get_rgb_intensity_of_upsampled_scattering(screenspace, is_obstructed? 1. : 0.) +
+        background_rgb_intensity *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction,
+            world_position, world_radius,
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+    rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure_intensity)), 1);
+}
+`;
+fragmentShaders.tone_mapping = `
+// NOTE: these macros are here to allow porting the code between several languages
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "tone_mapping" maps the linear intensities of a float render target to the rgb signals of a monitor,
+//   see ToneMappingPass.js for how it's used.
+// Exposure is either given by "exposure_intensity", 
+//   or if "auto_exposure_visibility" is 1, it's read from the 1x1 texture that's rendered by "auto_exposure.glsl.c".
+varying vec2 vUv;
+uniform sampler2D input_texture;
+uniform sampler2D exposure_texture;
+uniform float exposure_intensity; // Watts/m^2
+uniform float auto_exposure_visibility;
+void main() {
+    vec3 rgb_intensity = texture2D( input_texture, vUv ).rgb;
+    float exposure = mix(exposure_intensity, texture2D( exposure_texture, vec2(0.5) ).r, auto_exposure_visibility);
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure)), 1);
+}
+`;
+fragmentShaders.auto_exposure = `
+// NOTE: these macros are here to allow porting the code between several languages
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "auto_exposure" renders a 1x1 float texture whose red channel is the exposure intensity for "tone_mapping.glsl.c",
+//   see ToneMappingPass.js for how it's used.
+// The average luminance of the scene is found as a geometric mean over a coarse grid of samples,
+//   so that a small bright light source does not darken the rest of the scene.
+// Exposure adapts gradually towards that of the average, the way an eye does, 
+//   so it reads the exposure of the previous frame from "previous_exposure_texture".
+uniform sampler2D input_texture;
+uniform sampler2D previous_exposure_texture;
+uniform float adaptation_rate; // fraction of the difference in exposure that's closed each frame
+uniform float min_exposure_intensity; // Watts/m^2
+uniform float max_exposure_intensity; // Watts/m^2
+void main() {
+    const float SAMPLE_COUNT = 8.; // number of samples taken along each axis, for a total of SAMPLE_COUNT^2
+    float log_luminance_sum = 0.;
+    for (float i = 0.; i < SAMPLE_COUNT; ++i)
+    {
+        for (float j = 0.; j < SAMPLE_COUNT; ++j)
+        {
+            vec3 rgb_intensity = texture2D( input_texture, (vec2(i, j) + 0.5) / SAMPLE_COUNT ).rgb;
+            // NOTE: luminance is offset so the log of a black sample is finite
+            log_luminance_sum += log(get_luminance_of_rgb_intensity(rgb_intensity) + 1e-4);
+        }
+    }
+    float average_luminance = exp(log_luminance_sum / (SAMPLE_COUNT*SAMPLE_COUNT));
+    float target_exposure = clamp(get_exposure_intensity_of_average_luminance(average_luminance),
+                                    min_exposure_intensity, max_exposure_intensity);
+    // NOTE: the previous exposure is 0 on the first frame, in which case we adopt the target immediately
+    float previous_exposure = texture2D( previous_exposure_texture, vec2(0.5) ).r;
+    float exposure = previous_exposure > 0.? mix(previous_exposure, target_exposure, adaptation_rate) : target_exposure;
+    gl_FragColor = vec4(exposure, 0, 0, 1);
+}
+`;
+// variants for renderers that support float textures, see AirColumnDensityLookupTable.is_supported():
+//   they sample from lookup tables, see "raymarching.glsl.c" and "emission.glsl.c",
+//   and they write linear intensities to float render targets, see ToneMappingPass.js
+fragmentShaders.atmosphere_using_luts = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+uniform sampler2D blackbody_lut;
+// "sample_blackbody_lut" is a drop-in replacement for solve_rgb_intensity_of_light_emitted_by_black_body()
+vec3 sample_blackbody_lut(
+    in float temperature
+){
+    if (temperature < BLACKBODY_LUT_MIN_TEMPERATURE) { return vec3(0); }
+    return exp(texture2D(blackbody_lut, vec2(get_blackbody_lut_texcoord(temperature), 0.5)).rgb);
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+uniform sampler2D air_column_density_lut;
+// "sample_air_column_density_lut" returns the column density ratio along a ray from a point to space,
+//   where the point is given as a distance "x" along the ray from closest approach, 
+//   and "z2" is the closest distance from the ray to the center of the world, squared.
+float sample_air_column_density_lut(
+    in float x,
+    in float z2,
+    in float r,
+    in float H
+){
+    float R_max = r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float x_lut = x;
+    float R2 = x*x + z2;
+    // points above the table are moved to where the ray enters the table, 
+    //   or considered empty if the ray never enters
+    if (R2 > R_max*R_max)
+    {
+        if (x > 0. || z2 > R_max*R_max) { return 0.; }
+        x_lut = -sqrt(R_max*R_max - z2);
+        R2 = R_max*R_max;
+    }
+    float R = sqrt(R2);
+    return texture2D(air_column_density_lut, get_air_column_density_lut_texcoord(R - r, x_lut/R, r, H)).x;
+}
+// This is a drop-in replacement for the function of the same name below, 
+//   it finds the column density ratio along a segment as the difference between two rays that run out to space.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    // if the segment is headed towards the ground, the rays that run from it to space would be obstructed,
+    //   so we instead find the column density along the same segment in the reverse direction
+    bool is_downward = z2 < r*r && x_stop < 0.;
+    float sigma = is_downward?
+        sample_air_column_density_lut(-x_stop, z2, r, H) - sample_air_column_density_lut(-x_start, z2, r, H) :
+        sample_air_column_density_lut( x_start, z2, r, H) - sample_air_column_density_lut( x_stop, z2, r, H);
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+uniform sampler2D multiple_scattering_lut;
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+            // light that scatters towards the camera after it has already scattered elsewhere,
+            // this adds the light that keeps the sky lit during twilight
+            E += I
+                * texture2D(multiple_scattering_lut, get_multiple_scattering_lut_texcoord(h, -xl/sqrt(r2), H)).rgb
+                * exp(-h/H) * (beta_ray + beta_mie) * dx
+                * exp(-beta_sum * sigma_v);
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+varying vec2 vUv;
+uniform sampler2D background_rgb_signal_texture;
+// Determines the length of a unit of distance within the view, in meters, 
+// it is generally the radius of whatever world's the focus for the scene.
+// The view uses different units for length to prevent certain issues with
+// floating point precision. 
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position;
+uniform float world_radius;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+uniform float insolation_max;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+bool isnan(float x)
+{
+    return !(0. <= x || x <= 0.);
+}
+bool isbig(float x)
+{
+    return abs(x)>BIG;
+}
+vec2 get_chartspace(vec2 bottomleft, vec2 topright, vec2 screenspace){
+    return screenspace * abs(topright - bottomleft) + bottomleft;
+}
+vec3 line(float y, vec2 chartspace, float line_width, vec3 line_color){
+    return abs(y-chartspace.y) < line_width? line_color : vec3(1.);
+}
+vec3 chart_scratch(vec2 screenspace){
+    vec2 bottomleft = vec2(-500e3, -100e3);
+    vec2 topright = vec2( 500e3, 100e3);
+    vec2 chartspace = get_chartspace(bottomleft, topright, screenspace);
+    float line_width = 0.01 * abs(topright - bottomleft).y;
+    float y = chartspace.x;
+    return line(y, chartspace, line_width, vec3(1,0,0));
+}
+void main() {
+    vec2 screenspace = vUv;
+    // gl_FragColor = vec4(chart_scratch(screenspace), 1);
+    // return;
+    vec2 clipspace = 2.0 * screenspace - 1.0;
+    vec3 view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3 view_origin = view_matrix_inverse[3].xyz * reference_distance;
+    vec4 background_rgb_signal = texture2D( background_rgb_signal_texture, vUv );
+    // NOTE: float render targets store intensities linearly, there is no signal to decode
+    vec3 background_rgb_intensity = insolation_max * background_rgb_signal.rgb;
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3 beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3 beta_mie = surface_air_mie_scattering_coefficients;
+    vec3 beta_abs = surface_air_absorption_coefficients;
+    vec3 rgb_intensity =
+        get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+            view_origin, view_direction,
+            world_position, world_radius,
+            light_directions, // rgb vectors indicating intensities of light sources
+            light_rgb_intensities, // unit vectors indicating directions to light sources
+            light_count,
+            background_rgb_intensity,
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+    rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
+    // NOTE: intensities are written linearly to a float render target, they are tone mapped by "tone_mapping.glsl.c"
+    gl_FragColor = vec4(rgb_intensity, 1);
+    // gl_FragColor = 3.*background_rgb_signal;
+}
+`;
+fragmentShaders.atmosphere_scattering_using_luts = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+uniform sampler2D blackbody_lut;
+// "sample_blackbody_lut" is a drop-in replacement for solve_rgb_intensity_of_light_emitted_by_black_body()
+vec3 sample_blackbody_lut(
+    in float temperature
+){
+    if (temperature < BLACKBODY_LUT_MIN_TEMPERATURE) { return vec3(0); }
+    return exp(texture2D(blackbody_lut, vec2(get_blackbody_lut_texcoord(temperature), 0.5)).rgb);
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+uniform sampler2D air_column_density_lut;
+// "sample_air_column_density_lut" returns the column density ratio along a ray from a point to space,
+//   where the point is given as a distance "x" along the ray from closest approach, 
+//   and "z2" is the closest distance from the ray to the center of the world, squared.
+float sample_air_column_density_lut(
+    in float x,
+    in float z2,
+    in float r,
+    in float H
+){
+    float R_max = r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float x_lut = x;
+    float R2 = x*x + z2;
+    // points above the table are moved to where the ray enters the table, 
+    //   or considered empty if the ray never enters
+    if (R2 > R_max*R_max)
+    {
+        if (x > 0. || z2 > R_max*R_max) { return 0.; }
+        x_lut = -sqrt(R_max*R_max - z2);
+        R2 = R_max*R_max;
+    }
+    float R = sqrt(R2);
+    return texture2D(air_column_density_lut, get_air_column_density_lut_texcoord(R - r, x_lut/R, r, H)).x;
+}
+// This is a drop-in replacement for the function of the same name below, 
+//   it finds the column density ratio along a segment as the difference between two rays that run out to space.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    // if the segment is headed towards the ground, the rays that run from it to space would be obstructed,
+    //   so we instead find the column density along the same segment in the reverse direction
+    bool is_downward = z2 < r*r && x_stop < 0.;
+    float sigma = is_downward?
+        sample_air_column_density_lut(-x_stop, z2, r, H) - sample_air_column_density_lut(-x_start, z2, r, H) :
+        sample_air_column_density_lut( x_start, z2, r, H) - sample_air_column_density_lut( x_stop, z2, r, H);
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+uniform sampler2D multiple_scattering_lut;
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+            // light that scatters towards the camera after it has already scattered elsewhere,
+            // this adds the light that keeps the sky lit during twilight
+            E += I
+                * texture2D(multiple_scattering_lut, get_multiple_scattering_lut_texcoord(h, -xl/sqrt(r2), H)).rgb
+                * exp(-h/H) * (beta_ray + beta_mie) * dx
+                * exp(-beta_sum * sigma_v);
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "atmosphere_scattering" is the first half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It renders the intensity of light that's scattered towards the viewer by the atmosphere, without any light from the background,
+//   and stores whether the view ray is obstructed by the world in the alpha channel.
+// It is meant to be rendered to a float texture that's smaller than the screen, 
+//   and is then upsampled by "atmosphere_upsampling.glsl.c".
+varying vec2 vUv;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position;
+uniform float world_radius;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+void main() {
+    vec2 screenspace = vUv;
+    vec2 clipspace = 2.0 * screenspace - 1.0;
+    vec3 view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3 view_origin = view_matrix_inverse[3].xyz * reference_distance;
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3 beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3 beta_mie = surface_air_mie_scattering_coefficients;
+    vec3 beta_abs = surface_air_absorption_coefficients;
+    vec3 rgb_intensity =
+        get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+            view_origin, view_direction,
+            world_position, world_radius,
+            light_directions, // rgb vectors indicating intensities of light sources
+            light_rgb_intensities, // unit vectors indicating directions to light sources
+            light_count,
+            vec3(0), // background light is added back after upsampling
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+    // the silhouette of the world, which is used to weigh samples during upsampling
+    vec3 P = view_origin - world_position;
+    float xv = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+    gl_FragColor = vec4(rgb_intensity, is_obstructed? 1. : 0.);
+}
+`;
+fragmentShaders.atmosphere_upsampling_using_luts = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+uniform sampler2D blackbody_lut;
+// "sample_blackbody_lut" is a drop-in replacement for solve_rgb_intensity_of_light_emitted_by_black_body()
+vec3 sample_blackbody_lut(
+    in float temperature
+){
+    if (temperature < BLACKBODY_LUT_MIN_TEMPERATURE) { return vec3(0); }
+    return exp(texture2D(blackbody_lut, vec2(get_blackbody_lut_texcoord(temperature), 0.5)).rgb);
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+uniform sampler2D air_column_density_lut;
+// "sample_air_column_density_lut" returns the column density ratio along a ray from a point to space,
+//   where the point is given as a distance "x" along the ray from closest approach, 
+//   and "z2" is the closest distance from the ray to the center of the world, squared.
+float sample_air_column_density_lut(
+    in float x,
+    in float z2,
+    in float r,
+    in float H
+){
+    float R_max = r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float x_lut = x;
+    float R2 = x*x + z2;
+    // points above the table are moved to where the ray enters the table, 
+    //   or considered empty if the ray never enters
+    if (R2 > R_max*R_max)
+    {
+        if (x > 0. || z2 > R_max*R_max) { return 0.; }
+        x_lut = -sqrt(R_max*R_max - z2);
+        R2 = R_max*R_max;
+    }
+    float R = sqrt(R2);
+    return texture2D(air_column_density_lut, get_air_column_density_lut_texcoord(R - r, x_lut/R, r, H)).x;
+}
+// This is a drop-in replacement for the function of the same name below, 
+//   it finds the column density ratio along a segment as the difference between two rays that run out to space.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    // if the segment is headed towards the ground, the rays that run from it to space would be obstructed,
+    //   so we instead find the column density along the same segment in the reverse direction
+    bool is_downward = z2 < r*r && x_stop < 0.;
+    float sigma = is_downward?
+        sample_air_column_density_lut(-x_stop, z2, r, H) - sample_air_column_density_lut(-x_start, z2, r, H) :
+        sample_air_column_density_lut( x_start, z2, r, H) - sample_air_column_density_lut( x_stop, z2, r, H);
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+uniform sampler2D multiple_scattering_lut;
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+            // light that scatters towards the camera after it has already scattered elsewhere,
+            // this adds the light that keeps the sky lit during twilight
+            E += I
+                * texture2D(multiple_scattering_lut, get_multiple_scattering_lut_texcoord(h, -xl/sqrt(r2), H)).rgb
+                * exp(-h/H) * (beta_ray + beta_mie) * dx
+                * exp(-beta_sum * sigma_v);
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// "atmosphere_upsampling" is the second half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It upsamples the light that was scattered by the atmosphere in "atmosphere_scattering.glsl.c",
+//   then adds light from the background that's transmitted through the atmosphere, which is cheap enough to find for every pixel.
+// Scattered light changes suddenly across the silhouette of the world, so upsampling is bilateral:
+//   of the four nearest texels, those that disagree with the pixel on whether the world obstructs the view are given little weight.
+// The result matches "atmosphere.glsl.c" everywhere but the silhouette.
+varying vec2 vUv;
+uniform sampler2D background_rgb_signal_texture;
+uniform sampler2D scattering_texture;
+uniform vec2 scattering_texture_size;
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4 projection_matrix_inverse;
+uniform mat4 view_matrix_inverse;
+uniform float reference_distance;
+uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position;
+uniform float world_radius;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+// "get_weight_of_scattering_sample" returns the weight of a texel from "scattering_texture", 
+//   given its bilinear weight and whether it agrees with the pixel on obstruction.
+// NOTE: weights are never zero, so the sum of weights is never zero
+float get_weight_of_scattering_sample(float bilinear_weight, float sample_obstruction, float pixel_obstruction)
+{
+    return bilinear_weight * mix(1., 1e-3, abs(sample_obstruction - pixel_obstruction));
+}
+vec3 get_rgb_intensity_of_upsampled_scattering(vec2 screenspace, float pixel_obstruction)
+{
+    // NOTE: "scattering_texture" uses nearest filtering, so we can interpolate texels ourselves
+    vec2 texel = screenspace * scattering_texture_size - 0.5;
+    vec2 f = fract(texel);
+    vec2 uv00 = (floor(texel) + 0.5) / scattering_texture_size;
+    vec2 du = vec2(1./scattering_texture_size.x, 0.);
+    vec2 dv = vec2(0., 1./scattering_texture_size.y);
+    vec4 s00 = texture2D(scattering_texture, uv00 );
+    vec4 s10 = texture2D(scattering_texture, uv00 + du );
+    vec4 s01 = texture2D(scattering_texture, uv00 + dv);
+    vec4 s11 = texture2D(scattering_texture, uv00 + du + dv);
+    float w00 = get_weight_of_scattering_sample((1.-f.x)*(1.-f.y), s00.a, pixel_obstruction);
+    float w10 = get_weight_of_scattering_sample(( f.x)*(1.-f.y), s10.a, pixel_obstruction);
+    float w01 = get_weight_of_scattering_sample((1.-f.x)*( f.y), s01.a, pixel_obstruction);
+    float w11 = get_weight_of_scattering_sample(( f.x)*( f.y), s11.a, pixel_obstruction);
+    return (s00.rgb*w00 + s10.rgb*w10 + s01.rgb*w01 + s11.rgb*w11) / (w00 + w10 + w01 + w11);
+}
+void main() {
+    vec2 screenspace = vUv;
+    vec2 clipspace = 2.0 * screenspace - 1.0;
+    vec3 view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3 view_origin = view_matrix_inverse[3].xyz * reference_distance;
+    vec4 background_rgb_signal = texture2D( background_rgb_signal_texture, vUv );
+    // NOTE: float render targets store intensities linearly, there is no signal to decode
+    vec3 background_rgb_intensity = insolation_max * background_rgb_signal.rgb;
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3 beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3 beta_mie = surface_air_mie_scattering_coefficients;
+    vec3 beta_abs = surface_air_absorption_coefficients;
+    vec3 P = view_origin - world_position;
+    float xv = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+    vec3 rgb_intensity =
+        get_rgb_intensity_of_upsampled_scattering(screenspace, is_obstructed? 1. : 0.) +
+        background_rgb_intensity *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction,
+            world_position, world_radius,
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+    rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
+    // NOTE: intensities are written linearly to a float render target, they are tone mapped by "tone_mapping.glsl.c"
+    gl_FragColor = vec4(rgb_intensity, 1);
+}
+`;
+realistic_fragment_shader_templates.realistic_using_luts = `
+// NOTE: these macros are here to allow porting the code between several languages
+const float DEGREE = 3.141592653589793238462643383279502884197169399/180.;
+const float RADIAN = 1.;
+const float KELVIN = 1.;
+const float MICROGRAM = 1e-9; // kilograms
+const float MILLIGRAM = 1e-6; // kilograms
+const float GRAM = 1e-3; // kilograms
+const float KILOGRAM = 1.; // kilograms
+const float TON = 1000.; // kilograms
+const float NANOMETER = 1e-9; // meters
+const float MICROMETER = 1e-6; // meters
+const float MILLIMETER = 1e-3; // meters
+const float METER = 1.; // meters
+const float KILOMETER = 1000.; // meters
+const float MOLE = 6.02214076e23;
+const float MILLIMOLE = MOLE / 1e3;
+const float MICROMOLE = MOLE / 1e6;
+const float NANOMOLE = MOLE / 1e9;
+const float FEMTOMOLE = MOLE / 1e12;
+const float SECOND = 1.; // seconds
+const float MINUTE = 60.; // seconds
+const float HOUR = MINUTE*60.; // seconds
+const float DAY = HOUR*24.; // seconds
+const float WEEK = DAY*7.; // seconds
+const float MONTH = DAY*29.53059; // seconds
+const float YEAR = DAY*365.256363004; // seconds
+const float MEGAYEAR = YEAR*1e6; // seconds
+const float NEWTON = KILOGRAM * METER / (SECOND * SECOND);
+const float JOULE = NEWTON * METER;
+const float WATT = JOULE / SECOND;
+const float EARTH_MASS = 5.972e24; // kilograms
+const float EARTH_RADIUS = 6.367e6; // meters
+const float STANDARD_GRAVITY = 9.80665; // meters/second^2
+const float STANDARD_TEMPERATURE = 273.15; // kelvin
+const float STANDARD_PRESSURE = 101325.; // pascals
+const float ASTRONOMICAL_UNIT = 149597870700.;// meters
+const float GLOBAL_SOLAR_CONSTANT = 1361.; // watts/meter^2
+const float JUPITER_MASS = 1.898e27; // kilograms
+const float JUPITER_RADIUS = 71e6; // meters
+const float SOLAR_MASS = 2e30; // kilograms
+const float SOLAR_RADIUS = 695.7e6; // meters
+const float SOLAR_LUMINOSITY = 3.828e26; // watts
+const float SOLAR_TEMPERATURE = 5772.; // kelvin
+const float PI = 3.14159265358979323846264338327950288419716939937510;
+float get_surface_area_of_sphere(
+    in float radius
+) {
+    return 4.*PI*radius*radius;
+}
+// TODO: try to get this to work with structs!
+// See: http://www.lighthouse3d.com/tutorials/maths/ray-sphere-intersection/
+void get_relation_between_ray_and_point(
+    in vec3 point_position,
+    in vec3 ray_origin,
+    in vec3 V,
+    out float z2,
+    out float xz
+){
+    vec3 P = point_position - ray_origin;
+    xz = dot(P, V);
+    z2 = dot(P, P) - xz * xz;
+}
+bool try_get_relation_between_ray_and_sphere(
+    in float sphere_radius,
+    in float z2,
+    in float xz,
+    out float distance_to_entrance,
+    out float distance_to_exit
+){
+    float sphere_radius2 = sphere_radius * sphere_radius;
+    float distance_from_closest_approach_to_exit = sqrt(max(sphere_radius2 - z2, 1e-10));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit = xz + distance_from_closest_approach_to_exit;
+    return (distance_to_exit > 0. && z2 < sphere_radius*sphere_radius);
+}
+const float SPEED_OF_LIGHT = 299792458. * METER / SECOND;
+const float BOLTZMANN_CONSTANT = 1.3806485279e-23 * JOULE / KELVIN;
+const float STEPHAN_BOLTZMANN_CONSTANT = 5.670373e-8 * WATT / (METER*METER* KELVIN*KELVIN*KELVIN*KELVIN);
+const float PLANCK_CONSTANT = 6.62607004e-34 * JOULE * SECOND;
+// see Lawson 2004, "The Blackbody Fraction, Infinite Series and Spreadsheets"
+// we only do a single iteration with n=1, because it doesn't have a noticeable effect on output
+float solve_fraction_of_light_emitted_by_black_body_below_wavelength(
+    in float wavelength,
+    in float temperature
+){
+    const float iterations = 2.;
+    const float h = PLANCK_CONSTANT;
+    const float k = BOLTZMANN_CONSTANT;
+    const float c = SPEED_OF_LIGHT;
+    float L = wavelength;
+    float T = temperature;
+    float C2 = h*c/k;
+    float z = C2 / (L*T);
+    float z2 = z*z;
+    float z3 = z2*z;
+    float sum = 0.;
+    float n2=0.;
+    float n3=0.;
+    for (float n=1.; n <= iterations; n++) {
+        n2 = n*n;
+        n3 = n2*n;
+        sum += (z3 + 3.*z2/n + 6.*z/n2 + 6./n3) * exp(-n*z) / n;
+    }
+    return 15.*sum/(PI*PI*PI*PI);
+}
+float solve_fraction_of_light_emitted_by_black_body_between_wavelengths(
+    in float lo,
+    in float hi,
+    in float temperature
+){
+    return solve_fraction_of_light_emitted_by_black_body_below_wavelength(hi, temperature) -
+            solve_fraction_of_light_emitted_by_black_body_below_wavelength(lo, temperature);
+}
+// This calculates the radiation (in watts/m^2) that's emitted 
+// by a single object using the Stephan-Boltzmann equation
+float get_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    float T = temperature;
+    return STEPHAN_BOLTZMANN_CONSTANT * T*T*T*T;
+}
+vec3 solve_rgb_intensity_of_light_emitted_by_black_body(
+    in float temperature
+){
+    return get_intensity_of_light_emitted_by_black_body(temperature)
+         * vec3(
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(600e-9*METER, 700e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
+             solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
+           );
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+const float BLACKBODY_LUT_WIDTH = 256.;
+const float BLACKBODY_LUT_MIN_TEMPERATURE = 300. * KELVIN;
+const float BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+const float BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+float get_blackbody_lut_texcoord(
+    in float temperature
+){
+    float u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) /
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+float get_blackbody_lut_temperature(
+    in float texcoord
+){
+    float u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+vec3 get_blackbody_lut_texel(
+    in float temperature
+){
+    vec3 I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+uniform sampler2D blackbody_lut;
+// "sample_blackbody_lut" is a drop-in replacement for solve_rgb_intensity_of_light_emitted_by_black_body()
+vec3 sample_blackbody_lut(
+    in float temperature
+){
+    if (temperature < BLACKBODY_LUT_MIN_TEMPERATURE) { return vec3(0); }
+    return exp(texture2D(blackbody_lut, vec2(get_blackbody_lut_texcoord(temperature), 0.5)).rgb);
+}
+// Rayleigh phase function factor [-1, 1]
+float get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    return 3. * (1. + cos_scatter_angle*cos_scatter_angle)
+    / //------------------------
+                (16. * PI);
+}
+// Henyey-Greenstein phase function factor [-1, 1]
+// represents the average cosine of the scattered directions
+// 0 is isotropic scattering
+// > 1 is forward scattering, < 1 is backwards
+float get_fraction_of_mie_scattered_light_scattered_by_angle(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    return (1. - g*g)
+    / //---------------------------------------------
+        ((4. + PI) * pow(1. + g*g - 2.*g*cos_scatter_angle, 1.5));
+}
+// Schlick's fast approximation to the Henyey-Greenstein phase function factor
+// Pharr and  Humphreys [2004] equivalence to g above
+float approx_fraction_of_mie_scattered_light_scattered_by_angle_fast(
+    in float cos_scatter_angle
+){
+    const float g = 0.76;
+    const float k = 1.55*g - 0.55 * (g*g*g);
+    return (1. - k*k)
+    / //-------------------------------------------
+        (4. * PI * (1. + k*cos_scatter_angle) * (1. + k*cos_scatter_angle));
+}
+// "get_fraction_of_light_reflected_on_surface_head_on" finds the fraction of light that's reflected
+//   by a boundary between materials when striking head on.
+//   It is also known as the "characteristic reflectance" within the fresnel reflectance equation.
+//   The refractive indices can be provided as parameters in any order.
+float get_fraction_of_light_reflected_on_surface_head_on(
+    in float refractivate_index1,
+    in float refractivate_index2
+){
+    float n1 = refractivate_index1;
+    float n2 = refractivate_index2;
+    float sqrtR0 = ((n1-n2)/(n1+n2));
+    float R0 = sqrtR0 * sqrtR0;
+    return R0;
+}
+// "get_fraction_of_light_reflected_on_surface" returns Fresnel reflectance.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+float get_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in float characteristic_reflectance
+){
+    float R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_rgb_fraction_of_light_reflected_on_surface" returns Fresnel reflectance for each color channel.
+//   Fresnel reflectance is the fraction of light that's immediately reflected upon striking the surface.
+//   It is the fraction of light that causes specular reflection.
+//   Here, we use Schlick's fast approximation for Fresnel reflectance.
+//   see https://en.wikipedia.org/wiki/Schlick%27s_approximation for a summary 
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for implementation details
+vec3 get_rgb_fraction_of_light_reflected_on_surface(
+    in float cos_incident_angle,
+    in vec3 characteristic_reflectance
+){
+    vec3 R0 = characteristic_reflectance;
+    float _1_u = 1.-cos_incident_angle;
+    return R0 + (1.-R0) * _1_u*_1_u*_1_u*_1_u*_1_u;
+}
+// "get_fraction_of_light_masked_or_shaded_by_surface" is Schlick's fast approximation for Smith's function
+//   see Hoffmann 2015 for a gentle introduction to the concept
+//   see Schlick (1994) for even more details.
+float get_fraction_of_light_masked_or_shaded_by_surface(
+    in float cos_view_angle,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float v = cos_view_angle;
+    float k = sqrt(2.*m*m/PI);
+    return v/(v-k*v+k);
+}
+// "get_fraction_of_microfacets_with_angle" 
+//   This is also known as the Beckmann Surface Normal Distribution Function.
+//   This is the probability of finding a microfacet whose surface normal deviates from the average by a certain angle.
+//   see Hoffmann 2015 for a gentle introduction to the concept.
+//   see Schlick (1994) for even more details.
+float get_fraction_of_microfacets_with_angle(
+    in float cos_angle_of_deviation,
+    in float root_mean_slope_squared
+){
+    float m = root_mean_slope_squared;
+    float t = cos_angle_of_deviation;
+    return exp((t*t-1.)/(m*m*t*t))/(m*m*t*t*t*t);
+}
+const float BIG = 1e20;
+const float SMALL = 1e-20;
+const int MAX_LIGHT_COUNT = 9;
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+const float AIR_COLUMN_DENSITY_LUT_WIDTH = 256.;
+const float AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+const float AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+vec2 get_air_column_density_lut_texcoord(
+    in float h,
+    in float cos_zenith,
+    in float r,
+    in float H
+){
+    float R = r + max(h, 0.);
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    float u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_air_column_density_lut_ray(
+    in vec2 texcoord,
+    in float r,
+    in float H
+){
+    float u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH - 1.);
+    float v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    float h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float R = r + h;
+    float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+uniform sampler2D air_column_density_lut;
+// "sample_air_column_density_lut" returns the column density ratio along a ray from a point to space,
+//   where the point is given as a distance "x" along the ray from closest approach, 
+//   and "z2" is the closest distance from the ray to the center of the world, squared.
+float sample_air_column_density_lut(
+    in float x,
+    in float z2,
+    in float r,
+    in float H
+){
+    float R_max = r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    float x_lut = x;
+    float R2 = x*x + z2;
+    // points above the table are moved to where the ray enters the table, 
+    //   or considered empty if the ray never enters
+    if (R2 > R_max*R_max)
+    {
+        if (x > 0. || z2 > R_max*R_max) { return 0.; }
+        x_lut = -sqrt(R_max*R_max - z2);
+        R2 = R_max*R_max;
+    }
+    float R = sqrt(R2);
+    return texture2D(air_column_density_lut, get_air_column_density_lut_texcoord(R - r, x_lut/R, r, H)).x;
+}
+// This is a drop-in replacement for the function of the same name below, 
+//   it finds the column density ratio along a segment as the difference between two rays that run out to space.
+float approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    in float x_start,
+    in float x_stop,
+    in float z2,
+    in float r,
+    in float H
+){
+    float x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    // if the segment is headed towards the ground, the rays that run from it to space would be obstructed,
+    //   so we instead find the column density along the same segment in the reverse direction
+    bool is_downward = z2 < r*r && x_stop < 0.;
+    float sigma = is_downward?
+        sample_air_column_density_lut(-x_stop, z2, r, H) - sample_air_column_density_lut(-x_start, z2, r, H) :
+        sample_air_column_density_lut( x_start, z2, r, H) - sample_air_column_density_lut( x_stop, z2, r, H);
+    return min(abs(sigma),BIG);
+}
+// "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
+//   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
+// Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
+//   or return false to indicate the ray passes through the surface of the world.
+float approx_air_column_density_ratio_along_3d_ray_for_curved_world (
+    in vec3 P,
+    in vec3 V,
+    in float x,
+    in float r,
+    in float H
+){
+    float xz = dot(-P,V); // distance ("radius") from the ray to the center of the world at closest approach, squared
+    float z2 = dot( P,P) - xz * xz; // distance from the origin at which closest approach occurs
+    return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
+}
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+vec3 get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    in float h, in float cos_light_zenith,
+    in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    vec3 P = vec3(0., r + h, 0.);
+    vec3 L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+    const float DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    const float STEP_COUNT = 20.; // number of steps taken while marching along each direction
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_sca = beta_ray + beta_mie;
+    vec3 V; // unit vector for the direction being sampled
+    float xv; // distance from the point to closest approach for the sampled direction
+    float zv2; // squared distance to the center of the world at closest approach
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    float dx;
+    float xvi;
+    vec3 Pi; // position for a single iteration of the march
+    float ri;
+    float xl;
+    vec3 T_v; // fraction of light transmitted along the sampled direction, from the iteration to the point
+    vec3 S; // fraction of light that's scattered at a single iteration, per unit distance
+    vec3 E_2nd = vec3(0); // fraction of light that arrives after scattering twice 
+    vec3 f_ms = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+    for (float i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (float j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            float cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            float sin_theta = sqrt(1. - cos_theta*cos_theta);
+            float phi = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air, xv_out_air );
+            try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            bool is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+            dx = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (float k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi = P + V * xvi;
+                ri = length(Pi);
+                xl = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+const float MULTIPLE_SCATTERING_LUT_WIDTH = 32.;
+const float MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+vec2 get_multiple_scattering_lut_texcoord(
+    in float h,
+    in float cos_light_zenith,
+    in float H
+){
+    float u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    float v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+vec2 get_multiple_scattering_lut_point(
+    in vec2 texcoord,
+    in float H
+){
+    float u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH - 1.);
+    float v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+uniform sampler2D multiple_scattering_lut;
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+vec3 get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V);
+    float zv2 = dot( P,P) - xv * xv;
+    float xv_in_air; float xv_out_air;
+    float xv_in_world; float xv_out_world;
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    if (!is_scattered){ return vec3(1); }
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    float sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+float get_fraction_along_raymarch(
+    in float u,
+    in float u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense, SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+// TODO: support for light sources from within atmosphere
+vec3 get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    in vec3 view_origin, in vec3 view_direction,
+    in vec3 world_position, in float world_radius,
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    in vec3 background_rgb_intensity,
+    in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    // For an excellent introduction to what we're try to do here, see Alan Zucconi: 
+    //   https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    // We will be using most of the same terminology and variable names.
+    // GUIDE TO VARIABLE NAMES:
+    //  Uppercase letters indicate vectors.
+    //  Lowercase letters indicate scalars.
+    //  Going for terseness because I tried longhand names and trust me, you can't read them.
+    //  "x*"     distance along a ray, either from the ray origin or from closest approach
+    //  "z*"     distance from the center of the world to closest approach
+    //  "r*"     a distance ("radius") from the center of the world
+    //  "h*"     a distance ("height") from the surface of the world
+    //  "*v*"    property of the view ray, the ray cast from the viewer to the object being viewed
+    //  "*l*"    property of the light ray, the ray cast from the object to the light source
+    //  "*2"     the square of a variable
+    //  "*_i"    property of an iteration within the raymarch
+    //  "beta*"  a scattering coefficient, the number of e-foldings in light intensity per unit distance
+    //  "gamma*" a phase factor, the fraction of light that's scattered in a certain direction
+    //  "rho*"   a density ratio, the density of air relative to surface density
+    //  "sigma*" a column density ratio, the density of a column of air relative to surface density
+    //  "I*"     intensity of source lighting for each color channel
+    //  "E*"     intensity of light cast towards the viewer for each color channel
+    //  "*_ray"  property of rayleigh scattering
+    //  "*_mie"  property of mie scattering
+    //  "*_abs"  property of absorption
+    vec3 P = view_origin - world_position;
+    vec3 V = view_direction;
+    vec3 I_back = background_rgb_intensity;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    float xv = dot(-P,V); // distance from view ray origin to closest approach
+    float zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
+    float xv_in_air; // distance along the view ray at which the ray enters the atmosphere
+    float xv_out_air; // distance along the view ray at which the ray exits the atmosphere
+    float xv_in_world; // distance along the view ray at which the ray enters the surface of the world
+    float xv_out_world; // distance along the view ray at which the ray enters the surface of the world
+    //   We only set it to 3 scale heights because we are using this parameter for raymarching, and not a closed form solution
+    bool is_scattered = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air, xv_out_air );
+    bool is_obstructed = try_get_relation_between_ray_and_sphere(r, zv2, xv, xv_in_world, xv_out_world);
+    // if view ray does not interact with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!is_scattered){ return I_back; }
+    // cosine of angle between view and light directions
+    float VL;
+    // "gamma_*" indicates the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine, A.K.A. "VL").
+    // It only accounts for a portion of the sunlight that's lost during the scatter, which is irrespective of wavelength or density
+    float gamma_ray;
+    float gamma_mie;
+    // "beta_*" indicates the rest of the fractional loss.
+    // it is dependant on wavelength, and the density ratio, which is dependant on height
+    // So all together, the fraction of sunlight that scatters to a given angle is: beta(wavelength) * gamma(angle) * density_ratio(height)
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    vec3 beta_gamma;
+    float xv_start = max(xv_in_air, 0.);
+    float xv_stop = is_obstructed? xv_in_world : xv_out_air;
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    float xv_surface = -sqrt(max(r*r - zv2, 0.));
+    float sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    float step_count = ceil(mix(6., 16., sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    float u_dense = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    float sigma_v_max = -log(1e-3) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+    float u_start; // fraction of the march's distance at which a single iteration of the view ray march starts
+    float u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    float dx; // distance covered by a single iteration of the view ray march
+    float xvi; // distance along the view ray from closest approach for a single iteration of the view ray march
+    vec3 L; // unit vector pointing to light source
+    vec3 I; // vector indicating intensity of light source for each color channel
+    float xl; // distance from light ray origin to closest approach
+    float zl2; // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    float r2; // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    float h; // distance ("height") from the surface of the world for a single iteration of the view ray march
+    float sigma_v; // columnar density encountered along the view ray,  relative to surface density
+    float sigma_l; // columnar density encountered along the light ray, relative to surface density
+    vec3 E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+    for (float i = 0.; i < 16.; ++i)
+    {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
+        r2 = xvi*xvi+zv2;
+        h = sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
+        for (int j = 0; j < MAX_LIGHT_COUNT; ++j)
+        {
+            if (j >= light_count) { break; }
+            L = light_directions[j];
+            I = light_rgb_intensities[j];
+            VL = dot(V, L);
+            xl = dot(P+V*(xvi+xv),-L);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, 3.*r, zl2, r, H );
+            gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL);
+            gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(VL);
+            beta_gamma= beta_ray * gamma_ray + beta_mie * gamma_mie;
+            E += I
+                // incoming fraction: the fraction of light that scatters towards camera
+                * exp(-h/H) * beta_gamma * dx
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(-beta_sum * (sigma_l + sigma_v));
+            // light that scatters towards the camera after it has already scattered elsewhere,
+            // this adds the light that keeps the sky lit during twilight
+            E += I
+                * texture2D(multiple_scattering_lut, get_multiple_scattering_lut_texcoord(h, -xl/sqrt(r2), H)).rgb
+                * exp(-h/H) * (beta_ray + beta_mie) * dx
+                * exp(-beta_sum * sigma_v);
+        }
+    }
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    E += I_back *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
+    return E;
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+    in vec3 segment_origin, in vec3 segment_direction, in float segment_length,
+    in vec3 world_position, in float world_radius, in float atmosphere_scale_height,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    vec3 O = world_position;
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+    // "sigma" is the column density of air, relative to the surface of the world, that's along the light's path of travel,
+    //   we use it to estimate the amount of light that's filtered by the atmosphere before reaching the surface
+    //   see https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-1/ for an awesome introduction
+    float sigma = approx_air_column_density_ratio_along_3d_ray_for_curved_world (segment_origin-world_position, segment_direction, segment_length, r, H);
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+vec3 get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+    in float cos_view_angle,
+    in float cos_light_angle,
+    in float cos_scatter_angle,
+    in float ocean_depth,
+    in vec3 refracted_light_rgb_intensity,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float NV = cos_view_angle;
+    float NL = cos_light_angle;
+    float LV = cos_scatter_angle;
+    vec3 I = refracted_light_rgb_intensity;
+    // "gamma_*" variables indicate the fraction of scattered sunlight that scatters to a given angle (indicated by its cosine).
+    // it is also known as the "phase factor"
+    // It varies
+    // see mention of "gamma" by Alan Zucconi: https://www.alanzucconi.com/2017/10/10/atmospheric-scattering-3/
+    float gamma_ray = get_fraction_of_rayleigh_scattered_light_scattered_by_angle(LV);
+    float gamma_mie = get_fraction_of_mie_scattered_light_scattered_by_angle(LV);
+    vec3 beta_gamma = beta_ray * gamma_ray + beta_mie * gamma_mie;
+    vec3 beta_sum = beta_ray + beta_mie + beta_abs;
+    // "sigma_v"  is the column density, relative to the surface, that's along the view ray.
+    // "sigma_l" is the column density, relative to the surface, that's along the light ray.
+    // "sigma_ratio" is the column density ratio of the full path of light relative to the distance along the incoming path
+    // Since water is treated as incompressible, the density remains constant, 
+    //   so they are effectively the distances traveled along their respective paths.
+    // TODO: model vector of refracted light within ocean
+    float sigma_v = ocean_depth / NV;
+    float sigma_l = ocean_depth / NL;
+    float sigma_ratio = 1. + NV/NL;
+    return I
+        // incoming fraction: the fraction of light that scatters towards camera
+        * beta_gamma
+        // outgoing fraction: the fraction of light that scatters away from camera
+        * (exp(-sigma_v * sigma_ratio * beta_sum) - 1.)
+        / (-sigma_ratio * beta_sum);
+}
+vec3 get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(
+    in float cos_incident_angle, in float ocean_depth,
+    in vec3 beta_ray, in vec3 beta_mie, in vec3 beta_abs
+){
+    float sigma = ocean_depth / cos_incident_angle;
+    return exp(-sigma * (beta_ray + beta_mie + beta_abs));
+}
+// This function returns a rgb vector that quickly approximates a spectral "bump".
+// Adapted from GPU Gems and Alan Zucconi
+// from https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+float bump (
+    in float x,
+    in float edge0,
+    in float edge1,
+    in float height
+){
+    float center = (edge1 + edge0) / 2.;
+    float width = (edge1 - edge0) / 2.;
+    float offset = (x - center) / width;
+    return height * max(1. - offset * offset, 0.);
+}
+// This function returns a rgb vector that best represents color at a given wavelength
+// It is from Alan Zucconi: https://www.alanzucconi.com/2017/07/15/improving-the-rainbow/
+// I've adapted the function so that coefficients are expressed in meters.
+vec3 get_rgb_signal_of_wavelength (
+    in float w
+){
+    return vec3(
+        bump(w, 530e-9, 690e-9, 1.00)+
+        bump(w, 410e-9, 460e-9, 0.15),
+        bump(w, 465e-9, 635e-9, 0.75)+
+        bump(w, 420e-9, 700e-9, 0.15),
+        bump(w, 400e-9, 570e-9, 0.45)+
+        bump(w, 570e-9, 625e-9, 0.30)
+      );
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+float get_luminance_of_rgb_intensity(
+    in vec3 I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+vec3 get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    in vec3 I,
+    in float exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+const float MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+float get_exposure_intensity_of_average_luminance(
+    in float average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
+    );
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
+    );
+}
+// This shader is never compiled as is, it is specialized by get_realistic_fragment_shader() in "precompiled/Shaders.js",
+//   which declares constants ahead of it so that glsl compilers can drop code the view never needs,
+//   see "realistic_surface.glsl.c" for what they are.
+// Determines the length of a unit of distance within the view, in meters, 
+// it is generally the radius of whatever world's the focus for the scene.
+// The view uses different units for length to prevent certain issues with
+// floating point precision. 
+// VIEW SETTINGS ---------------------------------------------------------------
+uniform float reference_distance;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+// SEA PROPERTIES -------------------------------------------------------
+uniform float sealevel;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius; // radius of the world being rendered, in meters
+varying float displacement_v;
+varying vec3 gradient_v;
+varying float plant_coverage_v;
+varying float snow_coverage_v;
+varying float scalar_v;
+varying float surface_temperature_v;
+varying vec4 position_v;
+varying vec3 view_direction_v;
+// "realistic_surface.glsl.c" finds the light that's emitted or reflected by the surface of a world, for "realistic" shaders.
+// It is shared by the fragment shader "realistic.glsl.c", which lights every pixel,
+//   by map projection vertex shaders that are compiled with "VERTEX_LIGHTING", which light every vertex,
+//   and by the native renderer, see "precompiled/cpp/realistic.hpp".
+// It expects the includer to have included the academics layer.
+// Under GL_ES, it also expects the includer to have declared the uniforms "sealevel" and "world_radius",
+//   and the varyings that are declared in "vertex/template.glsl.c", from which it reads the properties of the surface.
+// It is specialized by constants that are described in get_realistic_fragment_shader() of "precompiled/Shaders.js":
+//   "VARIANT_LIGHT_COUNT"   the most light sources the shader loops over, "light_count" may be smaller
+//   "VARIANT_HAS_OCEAN"     whether the ocean can be visible
+//   "VARIANT_HAS_SPECULAR"  whether surfaces can have specular reflection
+//   "VARIANT_HAS_EXACT_EMISSION" whether to evaluate emission exactly, even if a lookup table is available
+// VIEW SETTINGS ---------------------------------------------------------------
+uniform float ocean_visibility;
+uniform float sediment_visibility;
+uniform float plant_visibility;
+uniform float snow_visibility;
+uniform float shadow_visibility;
+uniform float specular_visibility;
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3 light_directions [MAX_LIGHT_COUNT];
+uniform int light_count;
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3 surface_air_rayleigh_scattering_coefficients;
+uniform vec3 surface_air_mie_scattering_coefficients;
+uniform vec3 surface_air_absorption_coefficients;
+// SEA PROPERTIES -------------------------------------------------------
+uniform vec3 ocean_rayleigh_scattering_coefficients;
+uniform vec3 ocean_mie_scattering_coefficients;
+uniform vec3 ocean_absorption_coefficients;
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3 world_position; // location for the center of the world, in meters
+// "SOLAR_RGB_LUMINOSITY" is the rgb luminosity of earth's sun, in Watts.
+//   It is used to convert the above true color values to absorption coefficients.
+//   You can also generate these numbers by calling solve_rgb_intensity_of_light_emitted_by_black_body(SOLAR_TEMPERATURE)
+const vec3 SOLAR_RGB_LUMINOSITY = vec3(7247419., 8223259., 8121487.);
+const float AIR_REFRACTIVE_INDEX = 1.000277;
+const float WATER_REFRACTIVE_INDEX = 1.333;
+const float WATER_ROOT_MEAN_SLOPE_SQUARED = 0.18;
+const vec3 LAND_COLOR_MAFIC = vec3(50,45,50)/255.; // observed on lunar maria 
+const vec3 LAND_COLOR_FELSIC = vec3(214,181,158)/255.; // observed color of rhyolite sample
+const vec3 LAND_COLOR_SAND = vec3(245,215,145)/255.;
+const vec3 LAND_COLOR_PEAT = vec3(100,85,60)/255.;
+const float LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE = 0.04; // NOTE: "0.04" is a representative value for plastics and other diffuse reflectors
+const float LAND_ROOT_MEAN_SLOPE_SQUARED = 0.2;
+const vec3 JUNGLE_COLOR = vec3(30,50,10)/255.;
+const float JUNGLE_ROOT_MEAN_SLOPE_SQUARED = 30.0;
+const vec3 SNOW_COLOR = vec3(0.9, 0.9, 0.9);
+const float SNOW_REFRACTIVE_INDEX = 1.333;
+// TODO: calculate airglow for nightside using scattering equations from atmosphere.glsl.c, 
+//   also keep in mind this: https://en.wikipedia.org/wiki/Airglow
+const float AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR = 0.000001;
+// TODO: multiple scattering events
+// TODO: support for light sources from within atmosphere
+// "get_rgb_intensity_of_light_from_surface_of_world" 
+//   traces a ray of light through the atmosphere and into a surface,
+// NOTE: this function does not trace the ray out of the atmosphere,
+//   since that is a job that only our atmosphere shader is capable of doing.
+//   Nor does it determine emission, since it is designed to be looped 
+//   over several light sources, and this would oversaturate the contribution from emission.
+vec3 get_rgb_intensity_of_light_from_surface_of_world(
+    // light properties
+    in vec3 light_direction,
+    in vec3 light_rgb_intensity,
+    // atmoshere properties
+    in float world_radius,
+    in float atmosphere_scale_height,
+    in vec3 atmosphere_beta_ray,
+    in vec3 atmosphere_beta_mie,
+    in vec3 atmosphere_beta_abs,
+    in float atmosphere_ambient_light_factor,
+    // surface properties
+    in vec3 surface_position,
+    in vec3 surface_normal,
+    in float surface_slope_root_mean_squared,
+    in vec3 surface_diffuse_color_rgb_fraction,
+    in vec3 surface_specular_color_rgb_fraction,
+    // ocean properties
+    in float ocean_depth,
+    in vec3 ocean_beta_ray,
+    in vec3 ocean_beta_mie,
+    in vec3 ocean_beta_abs,
+    // view properties
+    in vec3 view_direction
+){
+    // NOTE: the single letter variable names here are industry standard, learn them!
+    // Uppercase indicates vectors
+    // lowercase indicates scalars
+    // "P" is the origin of the rays: the surface of the planet
+    vec3 P = surface_position;
+    // "N" is the surface normal
+    vec3 N = surface_normal;
+    // "V" is the normal vector indicating the direction from the view
+    // TODO: standardize view_direction as view from surface to camera
+    vec3 V = view_direction;
+    // "L" is the normal vector indicating the direction to the light source
+    vec3 L = light_direction;
+    // "H" is the halfway vector between normal and view.
+    // It represents the surface normal that's needed to cause reflection.
+    // It can also be thought of as the surface normal of a microfacet that's 
+    //   producing the reflections seen by the camera.
+    vec3 H = normalize(V+L);
+    // Here we setup  several useful dot products of unit vectors
+    //   we can think of them as the cosines of the angles formed between them,
+    //   or their "cosine similarity": https://en.wikipedia.org/wiki/Cosine_similarity
+    float LV = dot(L,V);
+    float NV = abs(dot(N,V));
+    float NL = abs(dot(N,L));
+    float NH = dot(N,H);
+    float HV = max(dot(V,H), 0.);
+    // "F0" is the characteristic fresnel reflectance.
+    //   it is the fraction of light that's immediately reflected when striking the surface head on.
+    vec3 F0 = surface_specular_color_rgb_fraction;
+    // "m" is the "ROOT_MEAN_SLOPE_SQUARED", the root mean square of the slope of all microfacets 
+    // see https://www.desmos.com/calculator/0tqwgsjcje for a way to estimate it using a function to describe the surface
+    float m = surface_slope_root_mean_squared;
+    // "D" is the diffuse reflection fraction, essentially the color of the surface
+    vec3 D = surface_diffuse_color_rgb_fraction;
+    // "I_sun" is the rgb Intensity of Incoming Incident light, A.K.A. "Insolation"
+    vec3 I_sun = light_rgb_intensity;
+    // "I_surface" is the intensity of light that reaches the surface after being filtered by atmosphere
+    vec3 I_surface = I_sun
+      * get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+            // NOTE: we nudge the origin of light ray by a small amount so that collision isn't detected with the world
+            1.000001 * P, L, 3.*world_radius, vec3(0), world_radius,
+            atmosphere_scale_height, atmosphere_beta_ray, atmosphere_beta_mie, atmosphere_beta_abs
+        );
+    // "E_surface_reflected" is the intensity of light that is immediately reflected by the surface, A.K.A. "specular" reflection
+    vec3 E_surface_reflected = !VARIANT_HAS_SPECULAR? vec3(0) : I_surface
+        * get_rgb_fraction_of_light_reflected_on_surface(HV, F0)
+        * get_fraction_of_light_masked_or_shaded_by_surface(NV, m)
+        * get_fraction_of_microfacets_with_angle(NH, m)
+        / (4.*PI); // NOTE: NV*VL should appear here in the denominator, but I can't get it to work
+    // "I_surface_refracted" is the intensity of light that is not immediately reflected, 
+    //   but penetrates into the material, either to be absorbed, scattered away, 
+    //   or scattered back to the view as diffuse reflection.
+    // We would ideally like to negate the integral of reflectance over all possible angles, 
+    //   but finding that is hard, so let's just negate the reflectance for the angle at which it occurs the most, or "HV"
+    vec3 I_surface_refracted = !VARIANT_HAS_SPECULAR? I_surface :
+        I_surface * (1. - get_rgb_fraction_of_light_reflected_on_surface(HV, F0));
+      //+ I_sun     *  atmosphere_ambient_light_factor;
+    // If sea is present, "E_ocean_scattered" is the rgb intensity of light 
+    //   scattered by the sea towards the camera. Otherwise, it equals 0.
+    vec3 E_ocean_scattered = !VARIANT_HAS_OCEAN? vec3(0) :
+        get_rgb_intensity_of_light_scattered_from_fluid_for_flat_world(
+            NV, NL, LV, ocean_depth, I_surface_refracted,
+            ocean_beta_ray, ocean_beta_mie, ocean_beta_abs
+        );
+    // if sea is present, "I_ocean_trasmitted" is the rgb intensity of light 
+    //   that reaches the ground after being filtered by air and sea. 
+    //   Otherwise, it equals I_surface_refracted.
+    vec3 I_ocean_trasmitted= !VARIANT_HAS_OCEAN? I_surface_refracted : I_surface_refracted
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NL, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    // "E_diffuse" is diffuse reflection of any nontrasparent component beneath the transparent surface,
+    // It effectively describes diffuse reflection as understood within the phong model of reflectance.
+    vec3 E_diffuse = I_ocean_trasmitted * NL * surface_diffuse_color_rgb_fraction;
+    // if sea is present, "E_ocean_transmitted" is the fraction 
+    //   of E_diffuse that makes it out of the sea. Otheriwse, it equals E_diffuse
+    vec3 E_ocean_transmitted = !VARIANT_HAS_OCEAN? E_diffuse : E_diffuse
+        * get_rgb_fraction_of_light_transmitted_through_fluid_for_flat_world(NV, ocean_depth, ocean_beta_ray, ocean_beta_mie, ocean_beta_abs);
+    return
+        E_surface_reflected
+      + E_ocean_transmitted
+      + E_ocean_scattered;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer.
+// Its arguments are named after the uniforms and varyings that are passed to it by the overload below.
+vec3 get_rgb_intensity_of_surface_of_world(
+    // view settings
+    in float ocean_visibility,
+    in float sediment_visibility,
+    in float plant_visibility,
+    in float snow_visibility,
+    in float shadow_visibility,
+    in float specular_visibility,
+    // light properties
+    in vec3[MAX_LIGHT_COUNT] light_directions,
+    in vec3[MAX_LIGHT_COUNT] light_rgb_intensities,
+    in int light_count,
+    // atmosphere properties
+    in float atmosphere_scale_height,
+    in vec3 surface_air_rayleigh_scattering_coefficients,
+    in vec3 surface_air_mie_scattering_coefficients,
+    in vec3 surface_air_absorption_coefficients,
+    // sea properties
+    in float sealevel,
+    in vec3 ocean_rayleigh_scattering_coefficients,
+    in vec3 ocean_mie_scattering_coefficients,
+    in vec3 ocean_absorption_coefficients,
+    // world properties
+    in float world_radius,
+    // surface properties
+    in float displacement,
+    in vec3 gradient,
+    in float plant_coverage,
+    in float snow_coverage,
+    in float surface_temperature,
+    in vec3 position,
+    // view properties
+    in vec3 view_direction
+){
+    bool is_ocean = sealevel > displacement;
+    bool is_visible_ocean = VARIANT_HAS_OCEAN && sealevel * ocean_visibility > displacement;
+    float ocean_depth = VARIANT_HAS_OCEAN? max(sealevel*ocean_visibility - displacement, 0.) : 0.;
+    float surface_height = max(displacement - sealevel*ocean_visibility, 0.);
+    // TODO: pass felsic_coverage in from attribute
+    // we currently guess how much rock is felsic depending on displacement
+    // Absorption coefficients are physically based.
+    // Scattering coefficients have been determined aesthetically.
+    float felsic_coverage = smoothstep(sealevel - 4000., sealevel+5000., displacement);
+    float mineral_coverage = displacement > sealevel? smoothstep(sealevel + 10000., sealevel, displacement) : 0.;
+    float organic_coverage = smoothstep(30., -30., surface_temperature);
+    float visible_plant_coverage = plant_coverage * (!is_visible_ocean? 1. : 0.);
+    // TODO: more sensible microfacet model
+    vec3 color_of_bedrock = mix(LAND_COLOR_MAFIC, LAND_COLOR_FELSIC, felsic_coverage);
+    vec3 color_with_sediment = mix(color_of_bedrock, mix(LAND_COLOR_SAND, LAND_COLOR_PEAT, organic_coverage), mineral_coverage * sediment_visibility);
+    vec3 color_with_plants = mix(color_with_sediment, JUNGLE_COLOR, !is_ocean? visible_plant_coverage * plant_visibility * sediment_visibility : 0.);
+    vec3 color_with_snow = mix(color_with_plants, SNOW_COLOR, snow_coverage * snow_visibility);
+    // "n" is the surface normal for a perfectly smooth sphere
+    vec3 n = normalize(position);
+    vec3 surface_position =
+        n * (world_radius + surface_height);
+    vec3 surface_normal =
+        normalize(n + gradient);
+    float surface_slope_root_mean_squared =
+        is_visible_ocean?
+            WATER_ROOT_MEAN_SLOPE_SQUARED :
+            mix(LAND_ROOT_MEAN_SLOPE_SQUARED, JUNGLE_ROOT_MEAN_SLOPE_SQUARED, visible_plant_coverage);
+    vec3 surface_diffuse_color_rgb_fraction =
+        get_rgb_intensity_of_rgb_signal(color_with_snow);
+    // TODO: model refractive index as a function of wavelength
+    vec3 surface_specular_color_rgb_fraction = !VARIANT_HAS_SPECULAR? vec3(0) :
+        shadow_visibility * specular_visibility * // turn off specular reflection if darkness is disabled
+        vec3(mix(
+            is_visible_ocean?
+            get_fraction_of_light_reflected_on_surface_head_on(WATER_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX) :
+            LAND_CHARACTERISTIC_FRESNEL_REFLECTANCE,
+            get_fraction_of_light_reflected_on_surface_head_on(SNOW_REFRACTIVE_INDEX, AIR_REFRACTIVE_INDEX),
+            snow_coverage*snow_visibility
+        ));
+    float ocean_visible_depth = mix(ocean_depth, 0., snow_coverage*snow_coverage*snow_coverage*snow_visibility);
+    vec3 E_surface_reemitted = vec3(0);
+    for (int i = 0; i < VARIANT_LIGHT_COUNT; ++i)
+    {
+        if (i >= light_count){ break; }
+        vec3 light_direction = normalize(mix(n, light_directions[i], shadow_visibility));
+        vec3 light_rgb_intensity = light_rgb_intensities[i];
+        E_surface_reemitted +=
+            get_rgb_intensity_of_light_from_surface_of_world(
+                // light properties
+                light_direction,
+                light_rgb_intensity,
+                // atmosphere properties
+                world_radius,
+                atmosphere_scale_height,
+                surface_air_rayleigh_scattering_coefficients,
+                surface_air_mie_scattering_coefficients,
+                surface_air_absorption_coefficients,
+                AMBIENT_LIGHT_AESTHETIC_BRIGHTNESS_FACTOR,
+                // surface properties
+                surface_position,
+                surface_normal,
+                surface_slope_root_mean_squared,
+                surface_diffuse_color_rgb_fraction,
+                surface_specular_color_rgb_fraction,
+                // ocean properties
+                ocean_visible_depth,
+                ocean_rayleigh_scattering_coefficients,
+                ocean_mie_scattering_coefficients,
+                ocean_absorption_coefficients,
+                // view properties
+                -view_direction
+            );
+    }
+    vec3 E_surface_emitted = VARIANT_HAS_EXACT_EMISSION?
+        solve_rgb_intensity_of_light_emitted_by_black_body(surface_temperature) :
+        sample_blackbody_lut(surface_temperature);
+    // NOTE: we do not filter E_total by atmospheric scattering
+    //   that job is done by the atmospheric shader pass, in "atmosphere.glsl.c"
+    vec3 E_total =
+          E_surface_emitted
+        + E_surface_reemitted;
+    return E_total;
+}
+// "get_rgb_intensity_of_surface_of_world" returns the intensity of light that leaves the surface towards the viewer,
+//   for the surface that's described by the varyings of "vertex/template.glsl.c".
+// In a vertex shader, those varyings must be written before it is called.
+vec3 get_rgb_intensity_of_surface_of_world(){
+    return get_rgb_intensity_of_surface_of_world(
+        ocean_visibility, sediment_visibility, plant_visibility, snow_visibility, shadow_visibility, specular_visibility,
+        light_directions, light_rgb_intensities, light_count,
+        atmosphere_scale_height,
+        surface_air_rayleigh_scattering_coefficients,
+        surface_air_mie_scattering_coefficients,
+        surface_air_absorption_coefficients,
+        sealevel,
+        ocean_rayleigh_scattering_coefficients,
+        ocean_mie_scattering_coefficients,
+        ocean_absorption_coefficients,
+        world_radius,
+        displacement_v, gradient_v, plant_coverage_v, snow_coverage_v, surface_temperature_v, position_v.xyz,
+        view_direction_v
     );
-    //mountain
-    color = mix(
-        color,
-        vec3(0.5,0.5,0.5),
-        smoothstep(0.4, 0.8, scalar_v)
+}
+void main() {
+    vec3 E_total = get_rgb_intensity_of_surface_of_world();
+    // NOTE: intensities are written linearly to a float render target, so they are not clipped
+    gl_FragColor = vec4(E_total/insolation_max,1);
+}
+`;
+fragmentShaders.realistic_vertex_lit_using_luts = `
+// NOTE: these macros are here to allow porting the code between several languages
+// "GAMMA" is the constant that's used to map between 
+//   rgb signals sent to a monitor and their actual intensity
+const float GAMMA = 2.2;
+vec3 get_rgb_intensity_of_rgb_signal(in vec3 signal
+){
+    return vec3(
+        pow(signal.x, GAMMA),
+        pow(signal.y, GAMMA),
+        pow(signal.z, GAMMA)
     );
-    //snow cap
-    color = mix(
-        color,
-        vec3(0.95),
-        smoothstep(0.75, 1., scalar_v)
+}
+vec3 get_rgb_signal_of_rgb_intensity(in vec3 intensity
+){
+    return vec3(
+        pow(intensity.x, 1./GAMMA),
+        pow(intensity.y, 1./GAMMA),
+        pow(intensity.z, 1./GAMMA)
     );
-    gl_FragColor = vec4(color, 1.);
 }
-`;
-fragmentShaders.vector_field = `
-const float PI = 3.14159265358979;
-uniform float animation_phase_angle;
-varying float vector_fraction_traversed_v;
+// "realistic_vertex_lit.glsl.c" is the counterpart to "realistic.glsl.c" for vertex shaders that light the surface,
+//   see "vertex/vertex_lighting.glsl.c". It only interpolates the intensity of light between vertices.
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+varying vec3 rgb_intensity_v;
 void main() {
-    float state = (cos(2.*PI*vector_fraction_traversed_v - animation_phase_angle) + 1.) / 2.;
-    gl_FragColor = vec4(state) * vec4(vec3(0.8),0.) + vec4(vec3(0.2),0.);
+    // NOTE: intensities are written linearly to a float render target, so they are not clipped
+    gl_FragColor = vec4(rgb_intensity_v/insolation_max,1);
 }
 `;
+// "get_realistic_fragment_shader" returns the cheapest variant of "realistic.glsl.c" that can render a view.
+// Settings that rarely change are compiled into the variant as glsl constants,
+//   so the glsl compiler can unroll the light loop and drop branches that the view would never take.
+// Variants exist for each combination of the following settings:
+//   "light_count"   the number of light sources, rounded up to 1, 2, or MAX_LIGHT_COUNT
+//   "has_ocean"     whether the ocean can be visible
+//   "has_specular"  whether surfaces can have specular reflection
+//   "using_luts"    whether to use the variant for float textures, described above
+//   "exact_emission" whether to evaluate black body emission exactly instead of using its lookup table, for validation
+// Variants are built on first request and cached, so that three.js finds the same program for the same variant.
+var realistic_fragment_shader_variants = {};
+function get_realistic_fragment_shader(light_count, has_ocean, has_specular, using_luts, exact_emission) {
+    var key = [get_realistic_variant_light_count(light_count), !!has_ocean, !!has_specular, !!using_luts, !!exact_emission].join(' ');
+    if (realistic_fragment_shader_variants[key] === void 0) {
+        realistic_fragment_shader_variants[key] =
+            get_realistic_variant_constants(light_count, has_ocean, has_specular, exact_emission) +
+            realistic_fragment_shader_templates[using_luts? 'realistic_using_luts' : 'realistic'];
+    }
+    return realistic_fragment_shader_variants[key];
+}
+// "get_realistic_vertex_shader" returns the variant of a map projection's vertex shader that lights the surface once per vertex,
+//   for use with fragmentShaders.realistic_vertex_lit or fragmentShaders.realistic_vertex_lit_using_luts.
+// Lighting is linearly interpolated between vertices, so it is cheaper but coarser than per pixel lighting,
+//   and it is only worthwhile when vertices are smaller than pixels, as with map projections of large grids.
+// It takes the same settings as get_realistic_fragment_shader(), however lookup tables are never used,
+//   since not every gpu can sample textures in vertex shaders.
+// It returns undefined if there is no such variant for "vertex_shader", in which case views should light every pixel.
+var realistic_vertex_shader_variants = {};
+function get_realistic_vertex_shader(vertex_shader, light_count, has_ocean, has_specular) {
+    var template =
+        vertex_shader === vertexShaders.equirectangular? 'equirectangular' :
+        vertex_shader === vertexShaders.texture? 'texture' : void 0;
+    if (template === void 0) {
+        return void 0;
+    }
+    var key = [template, get_realistic_variant_light_count(light_count), !!has_ocean, !!has_specular].join(' ');
+    if (realistic_vertex_shader_variants[key] === void 0) {
+        realistic_vertex_shader_variants[key] =
+            get_realistic_variant_constants(light_count, has_ocean, has_specular, true) +
+            realistic_vertex_shader_templates[template];
+    }
+    return realistic_vertex_shader_variants[key];
+}
+function get_realistic_variant_light_count(light_count) {
+    // NOTE: this must match MAX_LIGHT_COUNT in "raymarching.glsl.c"
+    const MAX_LIGHT_COUNT = 9;
+    return light_count <= 1? 1 : light_count <= 2? 2 : MAX_LIGHT_COUNT;
+}
+// "get_realistic_variant_constants" returns the glsl constants that are declared ahead of a variant, see "realistic_surface.glsl.c"
+function get_realistic_variant_constants(light_count, has_ocean, has_specular, exact_emission) {
+    return 'const int  VARIANT_LIGHT_COUNT  = ' + get_realistic_variant_light_count(light_count) + ';\n' +
+            'const bool VARIANT_HAS_OCEAN    = ' + !!has_ocean + ';\n' +
+            'const bool VARIANT_HAS_SPECULAR = ' + !!has_specular + ';\n' +
+            'const bool VARIANT_HAS_EXACT_EMISSION = ' + !!exact_emission + ';\n';
+}
+// the most general variants, for views that do not specialize
+fragmentShaders.realistic = get_realistic_fragment_shader(Infinity, true, true, false, false);
+fragmentShaders.realistic_using_luts = get_realistic_fragment_shader(Infinity, true, true, true, false);
@@ -0,0 +1,24 @@
+#pragma once
+
+// "Academics.hpp" is the C++ counterpart to "Academics.js".
+// It compiles the same *.glsl.c sources under the "CPP" branch of "cross_platform_macros.glsl.c",
+// so precomputation and headless rendering can run natively without the overhead of javascript.
+// All functions are declared within the "academics" namespace.
+#include "precompiled/cpp/glm.hpp"
+
+#define CPP
+#include "precompiled/cross_platform_macros.glsl.c"
+
+namespace academics {
+using namespace glm;
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/emission.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/physics/reflectance.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+#include "precompiled/academics/psychophysics.glsl.c"
+#include "precompiled/academics/electronics.glsl.c"
+}
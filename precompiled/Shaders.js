@@ -25,7 +25,22 @@ fragmentShaders.colorscale = `
 fragmentShaders.passthrough = `
 #include "precompiled/shaders/fragment/passthrough.glsl.c"
 `;
-fragmentShaders.realistic = `
+fragmentShaders.realistic_vertex_lit = `
+#include "precompiled/shaders/fragment/realistic_vertex_lit.glsl.c"
+`;
+// map projections can also light the surface once per vertex for "realistic" views, see get_realistic_vertex_shader() below
+#define VERTEX_LIGHTING
+var realistic_vertex_shader_templates = {};
+realistic_vertex_shader_templates.equirectangular = `
+#include "precompiled/shaders/vertex/equirectangular.glsl.c"
+`;
+realistic_vertex_shader_templates.texture = `
+#include "precompiled/shaders/vertex/texture.glsl.c"
+`;
+#undef VERTEX_LIGHTING
+// "realistic" is specialized for each view, see get_realistic_fragment_shader() below
+var realistic_fragment_shader_templates = {};
+realistic_fragment_shader_templates.realistic = `
 #include "precompiled/shaders/fragment/realistic.glsl.c"
 `;
 fragmentShaders.surface_normal_map = `
@@ -36,4 +51,111 @@ fragmentShaders.topographic = `
 `;
 fragmentShaders.vector_field = `
 #include "precompiled/shaders/fragment/vector_field.glsl.c"
-`;
\ No newline at end of file
+`;
+fragmentShaders.air_column_density_lut = `
+#include "precompiled/shaders/fragment/air_column_density_lut.glsl.c"
+`;
+fragmentShaders.multiple_scattering_lut = `
+#include "precompiled/shaders/fragment/multiple_scattering_lut.glsl.c"
+`;
+fragmentShaders.blackbody_lut = `
+#include "precompiled/shaders/fragment/blackbody_lut.glsl.c"
+`;
+fragmentShaders.atmosphere_scattering = `
+#include "precompiled/shaders/fragment/atmosphere_scattering.glsl.c"
+`;
+fragmentShaders.atmosphere_upsampling = `
+#include "precompiled/shaders/fragment/atmosphere_upsampling.glsl.c"
+`;
+fragmentShaders.tone_mapping = `
+#include "precompiled/shaders/fragment/tone_mapping.glsl.c"
+`;
+fragmentShaders.auto_exposure = `
+#include "precompiled/shaders/fragment/auto_exposure.glsl.c"
+`;
+
+// variants for renderers that support float textures, see AirColumnDensityLookupTable.is_supported():
+//   they sample from lookup tables, see "raymarching.glsl.c" and "emission.glsl.c",
+//   and they write linear intensities to float render targets, see ToneMappingPass.js
+#define AIR_COLUMN_DENSITY_LUT
+#define MULTIPLE_SCATTERING_LUT
+#define BLACKBODY_LUT
+#define HDR_RENDER_TARGET
+fragmentShaders.atmosphere_using_luts = `
+#include "precompiled/shaders/fragment/atmosphere.glsl.c"
+`;
+fragmentShaders.atmosphere_scattering_using_luts = `
+#include "precompiled/shaders/fragment/atmosphere_scattering.glsl.c"
+`;
+fragmentShaders.atmosphere_upsampling_using_luts = `
+#include "precompiled/shaders/fragment/atmosphere_upsampling.glsl.c"
+`;
+realistic_fragment_shader_templates.realistic_using_luts = `
+#include "precompiled/shaders/fragment/realistic.glsl.c"
+`;
+fragmentShaders.realistic_vertex_lit_using_luts = `
+#include "precompiled/shaders/fragment/realistic_vertex_lit.glsl.c"
+`;
+#undef AIR_COLUMN_DENSITY_LUT
+#undef MULTIPLE_SCATTERING_LUT
+#undef BLACKBODY_LUT
+#undef HDR_RENDER_TARGET
+
+// "get_realistic_fragment_shader" returns the cheapest variant of "realistic.glsl.c" that can render a view.
+// Settings that rarely change are compiled into the variant as glsl constants,
+//   so the glsl compiler can unroll the light loop and drop branches that the view would never take.
+// Variants exist for each combination of the following settings:
+//   "light_count"   the number of light sources, rounded up to 1, 2, or MAX_LIGHT_COUNT
+//   "has_ocean"     whether the ocean can be visible
+//   "has_specular"  whether surfaces can have specular reflection
+//   "using_luts"    whether to use the variant for float textures, described above
+//   "exact_emission" whether to evaluate black body emission exactly instead of using its lookup table, for validation
+// Variants are built on first request and cached, so that three.js finds the same program for the same variant.
+var realistic_fragment_shader_variants = {};
+function get_realistic_fragment_shader(light_count, has_ocean, has_specular, using_luts, exact_emission) {
+    var key = [get_realistic_variant_light_count(light_count), !!has_ocean, !!has_specular, !!using_luts, !!exact_emission].join(' ');
+    if (realistic_fragment_shader_variants[key] === void 0) {
+        realistic_fragment_shader_variants[key] = 
+            get_realistic_variant_constants(light_count, has_ocean, has_specular, exact_emission) +
+            realistic_fragment_shader_templates[using_luts? 'realistic_using_luts' : 'realistic'];
+    }
+    return realistic_fragment_shader_variants[key];
+}
+// "get_realistic_vertex_shader" returns the variant of a map projection's vertex shader that lights the surface once per vertex,
+//   for use with fragmentShaders.realistic_vertex_lit or fragmentShaders.realistic_vertex_lit_using_luts.
+// Lighting is linearly interpolated between vertices, so it is cheaper but coarser than per pixel lighting,
+//   and it is only worthwhile when vertices are smaller than pixels, as with map projections of large grids.
+// It takes the same settings as get_realistic_fragment_shader(), however lookup tables are never used,
+//   since not every gpu can sample textures in vertex shaders.
+// It returns undefined if there is no such variant for "vertex_shader", in which case views should light every pixel.
+var realistic_vertex_shader_variants = {};
+function get_realistic_vertex_shader(vertex_shader, light_count, has_ocean, has_specular) {
+    var template = 
+        vertex_shader === vertexShaders.equirectangular? 'equirectangular' :
+        vertex_shader === vertexShaders.texture?         'texture' : void 0;
+    if (template === void 0) {
+        return void 0;
+    }
+    var key = [template, get_realistic_variant_light_count(light_count), !!has_ocean, !!has_specular].join(' ');
+    if (realistic_vertex_shader_variants[key] === void 0) {
+        realistic_vertex_shader_variants[key] = 
+            get_realistic_variant_constants(light_count, has_ocean, has_specular, true) +
+            realistic_vertex_shader_templates[template];
+    }
+    return realistic_vertex_shader_variants[key];
+}
+function get_realistic_variant_light_count(light_count) {
+    // NOTE: this must match MAX_LIGHT_COUNT in "raymarching.glsl.c"
+    const MAX_LIGHT_COUNT = 9;
+    return light_count <= 1? 1 : light_count <= 2? 2 : MAX_LIGHT_COUNT;
+}
+// "get_realistic_variant_constants" returns the glsl constants that are declared ahead of a variant, see "realistic_surface.glsl.c"
+function get_realistic_variant_constants(light_count, has_ocean, has_specular, exact_emission) {
+    return  'const int  VARIANT_LIGHT_COUNT  = ' + get_realistic_variant_light_count(light_count) + ';\n' +
+            'const bool VARIANT_HAS_OCEAN    = ' + !!has_ocean          + ';\n' +
+            'const bool VARIANT_HAS_SPECULAR = ' + !!has_specular       + ';\n' +
+            'const bool VARIANT_HAS_EXACT_EMISSION = ' + !!exact_emission + ';\n';
+}
+// the most general variants, for views that do not specialize
+fragmentShaders.realistic            = get_realistic_fragment_shader(Infinity, true, true, false, false);
+fragmentShaders.realistic_using_luts = get_realistic_fragment_shader(Infinity, true, true, true,  false);
\ No newline at end of file
@@ -53,4 +53,52 @@ FUNC(vec3) solve_rgb_intensity_of_light_emitted_by_black_body(
              solve_fraction_of_light_emitted_by_black_body_between_wavelengths(500e-9*METER, 600e-9*METER, temperature),
              solve_fraction_of_light_emitted_by_black_body_between_wavelengths(400e-9*METER, 500e-9*METER, temperature)
            );
-}
\ No newline at end of file
+}
+// "BLACKBODY_LUT_*" describe an optional lookup table for the output of solve_rgb_intensity_of_light_emitted_by_black_body(),
+//   indexed by temperature along its width, between BLACKBODY_LUT_MIN_TEMPERATURE and BLACKBODY_LUT_MAX_TEMPERATURE.
+// Intensities span dozens of orders of magnitude, so the table stores their natural logarithm,
+//   and texels are spaced evenly by the reciprocal of temperature, along which the logarithm is nearly linear.
+// Visible light emitted below BLACKBODY_LUT_MIN_TEMPERATURE is less than 1e-20 W/m^2, so it is treated as 0.
+// Shaders sample from it if "BLACKBODY_LUT" is defined when this file is included,
+//   see "blackbody_lut.glsl.c" for the shader that builds it.
+CONST(float) BLACKBODY_LUT_WIDTH = 256.;
+CONST(float) BLACKBODY_LUT_MIN_TEMPERATURE = 300.   * KELVIN;
+CONST(float) BLACKBODY_LUT_MAX_TEMPERATURE = 30000. * KELVIN;
+// "BLACKBODY_LUT_MIN_INTENSITY" is stored in place of intensities that are smaller or underflow,
+//   it prevents infinities from being interpolated
+CONST(float) BLACKBODY_LUT_MIN_INTENSITY = 1e-30 * WATT / (METER*METER);
+
+FUNC(float) get_blackbody_lut_texcoord(
+    IN(float) temperature
+){
+    VAR(float) u = clamp(
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / max(temperature, BLACKBODY_LUT_MIN_TEMPERATURE)) / 
+        (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE), 0., 1.);
+    return (0.5 + u * (BLACKBODY_LUT_WIDTH - 1.)) / BLACKBODY_LUT_WIDTH;
+}
+// "get_blackbody_lut_temperature" is the inverse of "get_blackbody_lut_texcoord"
+FUNC(float) get_blackbody_lut_temperature(
+    IN(float) texcoord
+){
+    VAR(float) u = (texcoord * BLACKBODY_LUT_WIDTH - 0.5) / (BLACKBODY_LUT_WIDTH - 1.);
+    return BLACKBODY_LUT_MIN_TEMPERATURE / (1. - u * (1. - BLACKBODY_LUT_MIN_TEMPERATURE / BLACKBODY_LUT_MAX_TEMPERATURE));
+}
+// "get_blackbody_lut_texel" returns what's stored in the table for a temperature
+FUNC(vec3) get_blackbody_lut_texel(
+    IN(float) temperature
+){
+    VAR(vec3) I = solve_rgb_intensity_of_light_emitted_by_black_body(temperature);
+    return log(max(I, vec3(BLACKBODY_LUT_MIN_INTENSITY)));
+}
+
+#if defined(GL_ES) && defined(BLACKBODY_LUT)
+uniform sampler2D blackbody_lut;
+
+// "sample_blackbody_lut" is a drop-in replacement for solve_rgb_intensity_of_light_emitted_by_black_body()
+FUNC(vec3) sample_blackbody_lut(
+    IN(float) temperature
+){
+    if (temperature < BLACKBODY_LUT_MIN_TEMPERATURE) { return vec3(0); }
+    return exp(texture2D(blackbody_lut, vec2(get_blackbody_lut_texcoord(temperature), 0.5)).rgb);
+}
+#endif
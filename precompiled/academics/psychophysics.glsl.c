@@ -27,4 +27,29 @@ FUNC(vec3) get_rgb_signal_of_wavelength (
         bump(w, 400e-9, 570e-9, 0.45)+
         bump(w, 570e-9, 625e-9, 0.30)
       );
-}
\ No newline at end of file
+}
+// "get_luminance_of_rgb_intensity" returns the perceived brightness of an rgb intensity,
+//   using the weights for linear rgb from ITU-R BT.709
+FUNC(float) get_luminance_of_rgb_intensity(
+    IN(vec3) I
+){
+    return dot(I, vec3(0.2126, 0.7152, 0.0722));
+}
+// "get_ldr_rgb_intensity_of_hdr_rgb_intensity" maps intensities of any magnitude to the range a monitor can display.
+// "exposure_intensity" is the intensity that maps to 1-1/e of the monitor's maximum.
+// see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
+FUNC(vec3) get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+    IN(vec3)  I, 
+    IN(float) exposure_intensity
+){
+    return 1. - exp(-I/exposure_intensity);
+}
+// "MIDDLE_GREY_INTENSITY" is the displayed intensity that an eye, once adapted, perceives as the average brightness of a scene
+CONST(float) MIDDLE_GREY_INTENSITY = 0.18;
+// "get_exposure_intensity_of_average_luminance" returns the exposure intensity 
+//   for which get_ldr_rgb_intensity_of_hdr_rgb_intensity() maps the average luminance of a scene to middle grey.
+FUNC(float) get_exposure_intensity_of_average_luminance(
+    IN(float) average_luminance
+){
+    return average_luminance / -log(1. - MIDDLE_GREY_INTENSITY);
+}
@@ -2,6 +2,105 @@ CONST(float) BIG = 1e20;
 CONST(float) SMALL = 1e-20;
 CONST(int)   MAX_LIGHT_COUNT = 9;
 
+// "AIR_COLUMN_DENSITY_LUT_*" describe an optional lookup table for the column density ratio of air,
+//   along rays that run from a point in the atmosphere out to space.
+// The table is indexed by the cosine of the angle between the ray and the zenith (along its width), 
+//   and the height of the point above the surface (along its height).
+// It only depends on the radius of the world and the scale height of the atmosphere, 
+//   so it can be built once and sampled in place of "approx_air_column_density_ratio_along_2d_ray_for_curved_world".
+// Shaders sample from it if "AIR_COLUMN_DENSITY_LUT" is defined when this file is included,
+//   see "air_column_density_lut.glsl.c" for the shader that builds it.
+CONST(float) AIR_COLUMN_DENSITY_LUT_WIDTH  = 256.;
+CONST(float) AIR_COLUMN_DENSITY_LUT_HEIGHT = 64.;
+CONST(float) AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS = 12.; // height of the top of the table, in scale heights
+
+// "get_air_column_density_lut_texcoord" returns the texture coordinate of the lookup table 
+//   for a ray starting at height "h" above the surface, whose direction makes an angle of "cos_zenith" with the zenith.
+// Rays that point below the horizon are clamped to the horizon, since they have no meaningful value.
+// Heights are distributed by their square root, so more texels are spent near the surface where density changes fastest.
+FUNC(vec2) get_air_column_density_lut_texcoord(
+    IN(float) h, 
+    IN(float) cos_zenith, 
+    IN(float) r, 
+    IN(float) H
+){
+    VAR(float) R           = r + max(h, 0.);
+    VAR(float) cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    VAR(float) u = clamp((cos_zenith - cos_horizon) / (1. - cos_horizon), 0., 1.);
+    VAR(float) v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    // NOTE: texture coordinates are nudged so that the first and last texels lie on the bounds of the table
+    return vec2(
+        (0.5 + u * (AIR_COLUMN_DENSITY_LUT_WIDTH  - 1.)) / AIR_COLUMN_DENSITY_LUT_WIDTH,
+        (0.5 + v * (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.)) / AIR_COLUMN_DENSITY_LUT_HEIGHT
+    );
+}
+// "get_air_column_density_lut_ray" is the inverse of "get_air_column_density_lut_texcoord",
+//   it returns the height and cosine of the zenith angle (in that order) that is represented by a texture coordinate.
+FUNC(vec2) get_air_column_density_lut_ray(
+    IN(vec2)  texcoord, 
+    IN(float) r, 
+    IN(float) H
+){
+    VAR(float) u = (texcoord.x * AIR_COLUMN_DENSITY_LUT_WIDTH  - 0.5) / (AIR_COLUMN_DENSITY_LUT_WIDTH  - 1.);
+    VAR(float) v = (texcoord.y * AIR_COLUMN_DENSITY_LUT_HEIGHT - 0.5) / (AIR_COLUMN_DENSITY_LUT_HEIGHT - 1.);
+    VAR(float) h = v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    VAR(float) R = r + h;
+    VAR(float) cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+    return vec2(h, cos_horizon + u * (1. - cos_horizon));
+}
+
+#if defined(GL_ES) && defined(AIR_COLUMN_DENSITY_LUT)
+uniform sampler2D air_column_density_lut;
+
+// "sample_air_column_density_lut" returns the column density ratio along a ray from a point to space,
+//   where the point is given as a distance "x" along the ray from closest approach, 
+//   and "z2" is the closest distance from the ray to the center of the world, squared.
+FUNC(float) sample_air_column_density_lut(
+    IN(float) x, 
+    IN(float) z2, 
+    IN(float) r, 
+    IN(float) H
+){
+    VAR(float) R_max = r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+    VAR(float) x_lut = x;
+    VAR(float) R2    = x*x + z2;
+    // points above the table are moved to where the ray enters the table, 
+    //   or considered empty if the ray never enters
+    if (R2 > R_max*R_max)
+    {
+        if (x > 0. || z2 > R_max*R_max) { return 0.; }
+        x_lut = -sqrt(R_max*R_max - z2);
+        R2    = R_max*R_max;
+    }
+    VAR(float) R = sqrt(R2);
+    return texture2D(air_column_density_lut, get_air_column_density_lut_texcoord(R - r, x_lut/R, r, H)).x;
+}
+
+// This is a drop-in replacement for the function of the same name below, 
+//   it finds the column density ratio along a segment as the difference between two rays that run out to space.
+FUNC(float) approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    IN(float) x_start, 
+    IN(float) x_stop, 
+    IN(float) z2, 
+    IN(float) r, 
+    IN(float) H
+){
+    VAR(float) x0 = sqrt(max(r *r -z2, 0.));
+    // if ray is obstructed
+    if (x_start < x0 && -x0 < x_stop && z2 < r*r)
+    {
+        // return ludicrously big number to represent obstruction
+        return BIG;
+    }
+    // if the segment is headed towards the ground, the rays that run from it to space would be obstructed,
+    //   so we instead find the column density along the same segment in the reverse direction
+    VAR(bool)  is_downward = z2 < r*r && x_stop < 0.;
+    VAR(float) sigma = is_downward?
+        sample_air_column_density_lut(-x_stop,  z2, r, H) - sample_air_column_density_lut(-x_start, z2, r, H) :
+        sample_air_column_density_lut( x_start, z2, r, H) - sample_air_column_density_lut( x_stop,  z2, r, H);
+    return min(abs(sigma),BIG);
+}
+#else
 // "approx_air_column_density_ratio_along_2d_ray_for_curved_world" 
 //   calculates column density ratio of air for a ray emitted from the surface of a world to a desired distance, 
 //   taking into account the curvature of the world.
@@ -49,6 +148,12 @@ FUNC(float) approx_air_column_density_ratio_along_2d_ray_for_curved_world(
     }
     
     VAR(float) r1      = r + 6.*H;
+    // if ray passes above the top of the atmosphere, 
+    //   there is no slope to the height approximation, so we treat the ray as if it were empty
+    if (z2 > r1*r1)
+    {
+        return 0.;
+    }
     VAR(float) x1      = sqrt(max(r1*r1-z2, 0.));
     VAR(float) xb      = x0+(x1-x0)*b;
     VAR(float) rb2     = xb*xb + z2;
@@ -72,6 +177,8 @@ FUNC(float) approx_air_column_density_ratio_along_2d_ray_for_curved_world(
     // which can cause graphical artifacts.
     return min(abs(sigma),BIG);
 }
+#endif
+
 // "try_approx_air_column_density_ratio_along_ray" is an all-in-one convenience wrapper 
 //   for approx_air_column_density_ratio_along_ray_2d() and approx_reference_air_column_density_ratio_along_ray.
 // Just pass it the origin and direction of a 3d ray and it will find the column density ratio along its path, 
@@ -88,13 +195,189 @@ FUNC(float) approx_air_column_density_ratio_along_3d_ray_for_curved_world (
     return approx_air_column_density_ratio_along_2d_ray_for_curved_world( 0.-xz, x-xz, z2, r, H );
 }
 
-// TODO: multiple scattering events
+// "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world" 
+//   approximates the fraction of light that reaches a point in the atmosphere after scattering two or more times,
+//   per unit scattering coefficient, for a point at height "h" and a light source at "cos_light_zenith" from the zenith.
+// It follows Hillaire 2020, "A Scalable and Production Ready Sky and Atmosphere Rendering Technique":
+//   second order scattering is found by marching rays in all directions from the point, assuming isotropic phase,
+//   and higher orders are found by summing the geometric series of the fraction of light that's transferred each order.
+// The result is multiplied by the scattering coefficient and intensity of light at the point to find the intensity of light it scatters.
+// It is costly, so it is meant to be used to build a lookup table, see "multiple_scattering_lut.glsl.c".
+FUNC(vec3) get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+    IN(float) h,               IN(float) cos_light_zenith,
+    IN(float) world_radius,    IN(float) atmosphere_scale_height,
+    IN(vec3)  beta_ray,        IN(vec3)  beta_mie,     IN(vec3)  beta_abs
+){
+    // NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+    VAR(float) r = world_radius;
+    VAR(float) H = atmosphere_scale_height;
+    VAR(vec3)  P = vec3(0., r + h, 0.);
+    VAR(vec3)  L = vec3(sqrt(max(1. - cos_light_zenith*cos_light_zenith, 0.)), cos_light_zenith, 0.);
+
+    CONST(float) DIRECTION_COUNT = 8.; // number of directions sampled along each of two axes, for a total of DIRECTION_COUNT^2
+    CONST(float) STEP_COUNT = 20.;     // number of steps taken while marching along each direction
+
+    VAR(vec3)  beta_sum = beta_ray + beta_mie + beta_abs;
+    VAR(vec3)  beta_sca = beta_ray + beta_mie;
+
+    VAR(vec3)  V;           // unit vector for the direction being sampled
+    VAR(float) xv;          // distance from the point to closest approach for the sampled direction
+    VAR(float) zv2;         // squared distance to the center of the world at closest approach
+    VAR(float) xv_in_air;   VAR(float) xv_out_air;
+    VAR(float) xv_in_world; VAR(float) xv_out_world;
+    VAR(float) dx;
+    VAR(float) xvi;
+    VAR(vec3)  Pi;          // position for a single iteration of the march
+    VAR(float) ri;
+    VAR(float) xl;
+    VAR(vec3)  T_v;         // fraction of light transmitted along the sampled direction, from the iteration to the point
+    VAR(vec3)  S;           // fraction of light that's scattered at a single iteration, per unit distance
+    VAR(vec3)  E_2nd  = vec3(0); // fraction of light that arrives after scattering twice 
+    VAR(vec3)  f_ms   = vec3(0); // fraction of light that's transferred from one order of scattering to the next
+
+    for (VAR(float) i = 0.; i < DIRECTION_COUNT; ++i)
+    {
+        for (VAR(float) j = 0.; j < DIRECTION_COUNT; ++j)
+        {
+            // directions are stratified so they are uniformly distributed over a sphere
+            VAR(float) cos_theta = 1. - 2. * (i + 0.5) / DIRECTION_COUNT;
+            VAR(float) sin_theta = sqrt(1. - cos_theta*cos_theta);
+            VAR(float) phi       = 2. * PI * (j + 0.5) / DIRECTION_COUNT;
+            V   = vec3(sin_theta * cos(phi), cos_theta, sin_theta * sin(phi));
+            xv  = dot(-P,V);
+            zv2 = dot( P,P) - xv * xv;
+
+            try_get_relation_between_ray_and_sphere(r + AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS*H, zv2, xv, xv_in_air,   xv_out_air  );
+            try_get_relation_between_ray_and_sphere(r,                                          zv2, xv, xv_in_world, xv_out_world);
+            // NOTE: obstruction is found by comparing against the horizon, 
+            //   since points on the surface are too close to the surface to reliably detect intersection 
+            VAR(bool) is_obstructed = -xv < -sqrt(max(dot(P,P) - r*r, 0.));
+
+            dx  = (is_obstructed? max(xv_in_world, 0.) : xv_out_air) / STEP_COUNT;
+            xvi = 0.5 * dx;
+            for (VAR(float) k = 0.; k < STEP_COUNT; ++k)
+            {
+                Pi  = P + V * xvi;
+                ri  = length(Pi);
+                xl  = dot(Pi, L);
+                T_v = exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi-xv, zv2, r, H));
+                S   = beta_sca * exp(-(ri-r)/H) * dx;
+                E_2nd += T_v * S / (4.*PI)
+                    * exp(-beta_sum * approx_air_column_density_ratio_along_2d_ray_for_curved_world(xl, 3.*r, ri*ri-xl*xl, r, H));
+                f_ms  += T_v * S;
+                xvi += dx;
+            }
+        }
+    }
+    E_2nd /= DIRECTION_COUNT * DIRECTION_COUNT;
+    f_ms  /= DIRECTION_COUNT * DIRECTION_COUNT;
+    // NOTE: we clamp the transfer fraction to prevent division by zero for implausibly thick atmospheres
+    return E_2nd / (1. - min(f_ms, vec3(0.99)));
+}
+
+// "MULTIPLE_SCATTERING_LUT_*" describe an optional lookup table for the output of 
+//   get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(),
+//   indexed by the cosine of the angle between the light source and the zenith (along its width), 
+//   and the height above the surface (along its height).
+// It depends on the radius of the world, the scale height of the atmosphere, and its scattering coefficients.
+// Shaders sample from it if "MULTIPLE_SCATTERING_LUT" is defined when this file is included,
+//   see "multiple_scattering_lut.glsl.c" for the shader that builds it.
+CONST(float) MULTIPLE_SCATTERING_LUT_WIDTH  = 32.;
+CONST(float) MULTIPLE_SCATTERING_LUT_HEIGHT = 32.;
+
+FUNC(vec2) get_multiple_scattering_lut_texcoord(
+    IN(float) h, 
+    IN(float) cos_light_zenith, 
+    IN(float) H
+){
+    VAR(float) u = clamp(0.5 * cos_light_zenith + 0.5, 0., 1.);
+    VAR(float) v = sqrt(clamp(h / (AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H), 0., 1.));
+    return vec2(
+        (0.5 + u * (MULTIPLE_SCATTERING_LUT_WIDTH  - 1.)) / MULTIPLE_SCATTERING_LUT_WIDTH,
+        (0.5 + v * (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.)) / MULTIPLE_SCATTERING_LUT_HEIGHT
+    );
+}
+// "get_multiple_scattering_lut_point" is the inverse of "get_multiple_scattering_lut_texcoord",
+//   it returns the height and cosine of the light's zenith angle (in that order) that is represented by a texture coordinate.
+FUNC(vec2) get_multiple_scattering_lut_point(
+    IN(vec2)  texcoord, 
+    IN(float) H
+){
+    VAR(float) u = (texcoord.x * MULTIPLE_SCATTERING_LUT_WIDTH  - 0.5) / (MULTIPLE_SCATTERING_LUT_WIDTH  - 1.);
+    VAR(float) v = (texcoord.y * MULTIPLE_SCATTERING_LUT_HEIGHT - 0.5) / (MULTIPLE_SCATTERING_LUT_HEIGHT - 1.);
+    return vec2(v * v * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H, 2. * u - 1.);
+}
+
+#if defined(GL_ES) && defined(MULTIPLE_SCATTERING_LUT)
+uniform sampler2D multiple_scattering_lut;
+#endif
+
+// "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world" 
+//   returns the fraction of light from the background that reaches the viewer along a view ray.
+// It is the term that get_rgb_intensity_of_light_scattered_from_air_for_curved_world() applies to "background_rgb_intensity",
+//   so the output of that function can be split into light that's scattered and light that's transmitted.
+// This lets shaders find scattered light at reduced resolution while still finding transmitted light at full resolution.
+// NOTE: see get_rgb_intensity_of_light_scattered_from_air_for_curved_world() for a guide to variable names
+FUNC(vec3) get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+    IN(vec3)  view_origin,     IN(vec3) view_direction,
+    IN(vec3)  world_position,  IN(float) world_radius,
+    IN(float) atmosphere_scale_height,
+    IN(vec3) beta_ray, IN(vec3) beta_mie, IN(vec3)  beta_abs
+){
+    VAR(vec3)  P = view_origin - world_position;
+    VAR(vec3)  V = view_direction;
+    VAR(float) r = world_radius;
+    VAR(float) H = atmosphere_scale_height;
+
+    VAR(float) xv  = dot(-P,V);
+    VAR(float) zv2 = dot( P,P) - xv * xv;
+
+    VAR(float) xv_in_air;   VAR(float) xv_out_air;
+    VAR(float) xv_in_world; VAR(float) xv_out_world;
+
+    VAR(bool) is_scattered  = try_get_relation_between_ray_and_sphere(r + 12.*H, zv2, xv, xv_in_air,   xv_out_air  );
+    VAR(bool) is_obstructed = try_get_relation_between_ray_and_sphere(r,         zv2, xv, xv_in_world, xv_out_world);
+
+    if (!is_scattered){ return vec3(1); }
+
+    VAR(float) xv_start = max(xv_in_air, 0.);
+    VAR(float) xv_stop  = is_obstructed? xv_in_world : xv_out_air;
+    VAR(float) sigma_v  = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    return exp(-(beta_ray + beta_mie + beta_abs) * sigma_v);
+}
+
+// "RAYMARCH_*" control the quality of the march along view rays in get_rgb_intensity_of_light_scattered_from_air_for_curved_world(),
+//   includers may define them beforehand to trade quality for speed:
+//   "RAYMARCH_MIN_STEP_COUNT"    the number of steps taken along a ray that crosses little air, such as one that looks straight down from space
+//   "RAYMARCH_MAX_STEP_COUNT"    the number of steps taken along a ray that crosses at least as much air as a ray along the horizon
+//   "RAYMARCH_MIN_TRANSMITTANCE" the fraction of light along the view ray below which the march stops, since further steps are negligible
+#ifndef RAYMARCH_MIN_STEP_COUNT
+#define RAYMARCH_MIN_STEP_COUNT 6.
+#endif
+#ifndef RAYMARCH_MAX_STEP_COUNT
+#define RAYMARCH_MAX_STEP_COUNT 16.
+#endif
+#ifndef RAYMARCH_MIN_TRANSMITTANCE
+#define RAYMARCH_MIN_TRANSMITTANCE 1e-3
+#endif
+
+// "get_fraction_along_raymarch" maps "u", a fraction of the steps in a march, to the fraction of the march's distance they cover.
+// Steps are spaced quadratically so they are closest together at "u_dense", the fraction along the march where air is densest.
+FUNC(float) get_fraction_along_raymarch(
+    IN(float) u,
+    IN(float) u_dense
+){
+    return u < u_dense?
+        u_dense - (u_dense-u)*(u_dense-u) / max(u_dense,    SMALL) :
+        u_dense + (u-u_dense)*(u-u_dense) / max(1.-u_dense, SMALL);
+}
+
 // TODO: support for light sources from within atmosphere
 FUNC(vec3) get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     IN(vec3)  view_origin,     IN(vec3) view_direction,
     IN(vec3)  world_position,  IN(float) world_radius,
-    IN(vec3 [MAX_LIGHT_COUNT]) light_directions, 
-    IN(vec3 [MAX_LIGHT_COUNT]) light_rgb_intensities,
+    IN(ARRAY(vec3, MAX_LIGHT_COUNT)) light_directions, 
+    IN(ARRAY(vec3, MAX_LIGHT_COUNT)) light_rgb_intensities,
     IN(int)                    light_count,
     IN(vec3) background_rgb_intensity,
     IN(float) atmosphere_scale_height,
@@ -132,8 +415,6 @@ FUNC(vec3) get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     VAR(float) r = world_radius;
     VAR(float) H = atmosphere_scale_height;
 
-    const VAR(float) STEP_COUNT = 16.;// number of steps taken while marching along the view ray
-
     VAR(float) xv  = dot(-P,V);           // distance from view ray origin to closest approach
     VAR(float) zv2 = dot( P,P) - xv * xv; // squared distance from the view ray to the center of the world at closest approach
 
@@ -165,8 +446,23 @@ FUNC(vec3) get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     
     VAR(float) xv_start = max(xv_in_air, 0.);
     VAR(float) xv_stop  = is_obstructed? xv_in_world : xv_out_air;
-    VAR(float) dx       = (xv_stop - xv_start) / STEP_COUNT;
-    VAR(float) xvi      = xv_start - xv + 0.5 * dx;
+
+    // the number of steps grows with the column density along the march, relative to that of a ray from the surface along the horizon,
+    //   so rays that cross little air, like most that look down from space, take few steps
+    // NOTE: obstructed marches are given an end that lies exactly on the surface, as found by the column density function,
+    //   since rounding could otherwise place it beneath the surface, where it would be treated as obstructed
+    VAR(float) xv_surface  = -sqrt(max(r*r - zv2, 0.));
+    VAR(float) sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, is_obstructed? xv_surface : xv_stop-xv, zv2, r, H );
+    VAR(float) step_count  = ceil(mix(RAYMARCH_MIN_STEP_COUNT, RAYMARCH_MAX_STEP_COUNT, sqrt(min(sigma_march / sqrt(0.5*PI*r*H), 1.))));
+    // steps are concentrated where air is densest, which is the point along the march that's closest to the world
+    VAR(float) u_dense     = clamp((xv - xv_start) / max(xv_stop - xv_start, SMALL), 0., 1.);
+    // the march stops once the view ray has passed through enough air that light beyond it is negligible
+    VAR(float) sigma_v_max = -log(RAYMARCH_MIN_TRANSMITTANCE) / max(min(beta_sum.x, min(beta_sum.y, beta_sum.z)), SMALL);
+
+    VAR(float) u_start;     // fraction of the march's distance at which a single iteration of the view ray march starts
+    VAR(float) u_stop = 0.; // fraction of the march's distance at which a single iteration of the view ray march stops
+    VAR(float) dx;          // distance covered by a single iteration of the view ray march
+    VAR(float) xvi;         // distance along the view ray from closest approach for a single iteration of the view ray march
 
     VAR(vec3)  L;           // unit vector pointing to light source
     VAR(vec3)  I;           // vector indicating intensity of light source for each color channel
@@ -178,11 +474,17 @@ FUNC(vec3) get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
     VAR(float) sigma_l;     // columnar density encountered along the light ray, relative to surface density
     VAR(vec3)  E = vec3(0); // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
 
-    for (VAR(float) i = 0.; i < STEP_COUNT; ++i)
+    for (VAR(float) i = 0.; i < RAYMARCH_MAX_STEP_COUNT; ++i)
     {
+        if (i >= step_count) { break; }
+        u_start = u_stop;
+        u_stop  = get_fraction_along_raymarch((i+1.) / step_count, u_dense);
+        dx  = (u_stop - u_start) * (xv_stop - xv_start);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5) / step_count, u_dense) * (xv_stop - xv_start);
         r2  = xvi*xvi+zv2;
         h   = sqrt(r2) - r;
         sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        if (sigma_v > sigma_v_max) { break; }
 
         for (VAR(int) j = 0; j < MAX_LIGHT_COUNT; ++j)
         {
@@ -202,14 +504,23 @@ FUNC(vec3) get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
                 * exp(-h/H) * beta_gamma * dx
                 // outgoing fraction: the fraction of light that scatters away from camera
                 * exp(-beta_sum * (sigma_l + sigma_v));
-        }
 
-        xvi  += dx;
+#if defined(GL_ES) && defined(MULTIPLE_SCATTERING_LUT)
+            // light that scatters towards the camera after it has already scattered elsewhere,
+            // this adds the light that keeps the sky lit during twilight
+            E += I
+                * texture2D(multiple_scattering_lut, get_multiple_scattering_lut_texcoord(h, -xl/sqrt(r2), H)).rgb
+                * exp(-h/H) * (beta_ray + beta_mie) * dx
+                * exp(-beta_sum * sigma_v);
+#endif
+        }
     }
 
     // now calculate the intensity of light that traveled straight in from the background, and add it to the total
-    sigma_v  = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
-    E += I_back * exp(-beta_sum * sigma_v);
+    E += I_back * 
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin, view_direction, world_position, world_radius, atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+        );
 
     return E;
 }
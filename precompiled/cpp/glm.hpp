@@ -0,0 +1,164 @@
+#pragma once
+
+// "glm.hpp" is a small subset of the glsl type system, written so the academics layer can compile as C++.
+// It mirrors the role that glm-js plays for postcompiled/Academics.js:
+//   it provides vec2/vec3/vec4/mat2/mat3/mat4 along with the glsl builtin functions that the academics layer needs.
+// Only functionality that's seen within *.glsl.c files belongs here.
+// If you need something more exotic, consider swapping in the real glm library, which uses the same names.
+// Matrices are stored in column major order, same as glsl.
+
+#include <cmath>
+#include <type_traits>
+
+namespace glm {
+
+struct vec2 {
+    float x, y;
+    vec2()                          : x(0.f), y(0.f) {}
+    explicit vec2(float s)          : x(s),   y(s)   {}
+    vec2(float x_, float y_)        : x(x_),  y(y_)  {}
+    float& operator[](int i)       { return (&x)[i]; }
+    float  operator[](int i) const { return (&x)[i]; }
+};
+struct vec3 {
+    float x, y, z;
+    vec3()                           : x(0.f), y(0.f), z(0.f) {}
+    explicit vec3(float s)           : x(s),   y(s),   z(s)   {}
+    vec3(float x_, float y_, float z_): x(x_),  y(y_),  z(z_)  {}
+    vec3(const vec2& v, float z_)    : x(v.x), y(v.y), z(z_)  {}
+    float& operator[](int i)       { return (&x)[i]; }
+    float  operator[](int i) const { return (&x)[i]; }
+};
+struct vec4 {
+    float x, y, z, w;
+    vec4()                                    : x(0.f), y(0.f), z(0.f), w(0.f) {}
+    explicit vec4(float s)                    : x(s),   y(s),   z(s),   w(s)   {}
+    vec4(float x_, float y_, float z_, float w_): x(x_),  y(y_),  z(z_),  w(w_)  {}
+    vec4(const vec3& v, float w_)             : x(v.x), y(v.y), z(v.z), w(w_)  {}
+    // NOTE: swizzling is not supported, but ".xyz" is common enough to merit a substitute
+    vec3 xyz() const { return vec3(x, y, z); }
+    float& operator[](int i)       { return (&x)[i]; }
+    float  operator[](int i) const { return (&x)[i]; }
+};
+
+// scalar builtins
+// NOTE: these are declared for float so that glsl code like "sqrt(x)" does not silently promote to double,
+//   and so "abs(x)" does not resolve to the integer version found in <cstdlib>
+inline float abs  (float x)                   { return std::fabs(x); }
+inline float sign (float x)                   { return float((0.f < x) - (x < 0.f)); }
+inline float floor(float x)                   { return std::floor(x); }
+inline float ceil (float x)                   { return std::ceil(x); }
+inline float fract(float x)                   { return x - std::floor(x); }
+inline float sqrt (float x)                   { return std::sqrt(x); }
+inline float exp  (float x)                   { return std::exp(x); }
+inline float log  (float x)                   { return std::log(x); }
+inline float sin  (float x)                   { return std::sin(x); }
+inline float cos  (float x)                   { return std::cos(x); }
+inline float tan  (float x)                   { return std::tan(x); }
+inline float asin (float x)                   { return std::asin(x); }
+inline float acos (float x)                   { return std::acos(x); }
+
+// NOTE: glsl literals like "0." are doubles in C++, so builtins with several parameters 
+//   accept any mix of arithmetic types and narrow them to float. 
+//   This also prevents ambiguity with the double precision overloads found in <cmath>.
+#define GLM_SCALARS(...) typename std::enable_if<glm::are_arithmetic<__VA_ARGS__>::value, float>::type
+template<typename... T> struct are_arithmetic;
+template<> struct are_arithmetic<> : std::true_type {};
+template<typename T, typename... U> struct are_arithmetic<T, U...> : 
+    std::integral_constant<bool, std::is_arithmetic<T>::value && are_arithmetic<U...>::value> {};
+
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   pow  (A x, B y)           { return std::pow(float(x), float(y)); }
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   atan (A y, B x)           { return std::atan2(float(y), float(x)); }
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   min  (A a, B b)           { return float(b) < float(a)? float(b) : float(a); }
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   max  (A a, B b)           { return float(a) < float(b)? float(b) : float(a); }
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   mod  (A x, B y)           { return float(x) - float(y) * std::floor(float(x)/float(y)); }
+template<typename A, typename B>             inline GLM_SCALARS(A,B)   step (A edge, B x)        { return float(x) < float(edge)? 0.f : 1.f; }
+template<typename A, typename B, typename C> inline GLM_SCALARS(A,B,C) clamp(A x, B lo, C hi)    { return min(max(x, lo), hi); }
+template<typename A, typename B, typename C> inline GLM_SCALARS(A,B,C) mix  (A a, B b, C t)      { return float(a) + (float(b)-float(a))*float(t); }
+template<typename A, typename B, typename C> inline GLM_SCALARS(A,B,C) smoothstep(A edge0, B edge1, C x) {
+    float t = clamp((float(x) - float(edge0)) / (float(edge1) - float(edge0)), 0.f, 1.f);
+    return t * t * (3.f - 2.f * t);
+}
+#undef GLM_SCALARS
+
+// vector builtins
+// NOTE: vector types share the same set of componentwise operations, so we generate them here with a macro
+#define GLM_COMPONENTWISE_VECTOR_OPERATIONS(V, N)                                                                 \
+inline V  operator+ (V a, const V& b) { for (int i=0; i<N; ++i) { a[i] += b[i]; } return a; }                    \
+inline V  operator- (V a, const V& b) { for (int i=0; i<N; ++i) { a[i] -= b[i]; } return a; }                    \
+inline V  operator* (V a, const V& b) { for (int i=0; i<N; ++i) { a[i] *= b[i]; } return a; }                    \
+inline V  operator/ (V a, const V& b) { for (int i=0; i<N; ++i) { a[i] /= b[i]; } return a; }                    \
+inline V  operator+ (V a, float b)    { for (int i=0; i<N; ++i) { a[i] += b;    } return a; }                    \
+inline V  operator- (V a, float b)    { for (int i=0; i<N; ++i) { a[i] -= b;    } return a; }                    \
+inline V  operator* (V a, float b)    { for (int i=0; i<N; ++i) { a[i] *= b;    } return a; }                    \
+inline V  operator/ (V a, float b)    { for (int i=0; i<N; ++i) { a[i] /= b;    } return a; }                    \
+inline V  operator+ (float a, V b)    { for (int i=0; i<N; ++i) { b[i] = a + b[i]; } return b; }                 \
+inline V  operator- (float a, V b)    { for (int i=0; i<N; ++i) { b[i] = a - b[i]; } return b; }                 \
+inline V  operator* (float a, V b)    { for (int i=0; i<N; ++i) { b[i] = a * b[i]; } return b; }                 \
+inline V  operator/ (float a, V b)    { for (int i=0; i<N; ++i) { b[i] = a / b[i]; } return b; }                 \
+inline V  operator- (V a)             { for (int i=0; i<N; ++i) { a[i] = -a[i]; } return a; }                    \
+inline V& operator+=(V& a, const V& b){ return a = a + b; }                                                     \
+inline V& operator-=(V& a, const V& b){ return a = a - b; }                                                     \
+inline V& operator*=(V& a, const V& b){ return a = a * b; }                                                     \
+inline V& operator/=(V& a, const V& b){ return a = a / b; }                                                     \
+inline V& operator+=(V& a, float b)   { return a = a + b; }                                                     \
+inline V& operator-=(V& a, float b)   { return a = a - b; }                                                     \
+inline V& operator*=(V& a, float b)   { return a = a * b; }                                                     \
+inline V& operator/=(V& a, float b)   { return a = a / b; }                                                     \
+inline float dot(const V& a, const V& b) { float sum = 0.f; for (int i=0; i<N; ++i) { sum += a[i]*b[i]; } return sum; } \
+inline float length(const V& a)       { return std::sqrt(dot(a,a)); }                                           \
+inline float distance(const V& a, const V& b) { return length(a-b); }                                           \
+inline V  normalize(const V& a)       { return a / length(a); }                                                 \
+inline V  abs  (V a)                  { for (int i=0; i<N; ++i) { a[i] = abs  (a[i]); } return a; }              \
+inline V  sign (V a)                  { for (int i=0; i<N; ++i) { a[i] = sign (a[i]); } return a; }              \
+inline V  floor(V a)                  { for (int i=0; i<N; ++i) { a[i] = floor(a[i]); } return a; }              \
+inline V  fract(V a)                  { for (int i=0; i<N; ++i) { a[i] = fract(a[i]); } return a; }              \
+inline V  sqrt (V a)                  { for (int i=0; i<N; ++i) { a[i] = sqrt (a[i]); } return a; }              \
+inline V  exp  (V a)                  { for (int i=0; i<N; ++i) { a[i] = exp  (a[i]); } return a; }              \
+inline V  log  (V a)                  { for (int i=0; i<N; ++i) { a[i] = log  (a[i]); } return a; }              \
+inline V  pow  (V a, const V& b)      { for (int i=0; i<N; ++i) { a[i] = pow(a[i], b[i]); } return a; }          \
+inline V  min  (V a, const V& b)      { for (int i=0; i<N; ++i) { a[i] = min(a[i], b[i]); } return a; }          \
+inline V  max  (V a, const V& b)      { for (int i=0; i<N; ++i) { a[i] = max(a[i], b[i]); } return a; }          \
+inline V  min  (V a, float b)         { for (int i=0; i<N; ++i) { a[i] = min(a[i], b);    } return a; }          \
+inline V  max  (V a, float b)         { for (int i=0; i<N; ++i) { a[i] = max(a[i], b);    } return a; }          \
+inline V  clamp(V a, float lo, float hi) { for (int i=0; i<N; ++i) { a[i] = clamp(a[i], lo, hi); } return a; }   \
+inline V  mix  (const V& a, const V& b, float t)    { return a + (b-a)*t; }                                     \
+inline V  mix  (const V& a, const V& b, const V& t) { return a + (b-a)*t; }                                     \
+inline V  smoothstep(float edge0, float edge1, V x) { for (int i=0; i<N; ++i) { x[i] = smoothstep(edge0, edge1, x[i]); } return x; }
+
+GLM_COMPONENTWISE_VECTOR_OPERATIONS(vec2, 2)
+GLM_COMPONENTWISE_VECTOR_OPERATIONS(vec3, 3)
+GLM_COMPONENTWISE_VECTOR_OPERATIONS(vec4, 4)
+#undef GLM_COMPONENTWISE_VECTOR_OPERATIONS
+
+inline vec3 cross(const vec3& a, const vec3& b) {
+    return vec3(
+        a.y*b.z - a.z*b.y,
+        a.z*b.x - a.x*b.z,
+        a.x*b.y - a.y*b.x
+    );
+}
+inline vec3 reflect(const vec3& I, const vec3& N) {
+    return I - 2.f * dot(N, I) * N;
+}
+
+// matrix types
+// NOTE: like glsl, matrices are indexed by column, so "m[3].xyz" is the translation component of a mat4
+#define GLM_SQUARE_MATRIX(M, V, N)                                                                                \
+struct M {                                                                                                       \
+    V columns[N];                                                                                                \
+    M() {}                                                                                                       \
+    explicit M(float s) { for (int i=0; i<N; ++i) { columns[i] = V(0.f); columns[i][i] = s; } }                  \
+    V&       operator[](int i)       { return columns[i]; }                                                      \
+    const V& operator[](int i) const { return columns[i]; }                                                      \
+};                                                                                                               \
+inline V operator*(const M& m, const V& v) { V result(0.f); for (int i=0; i<N; ++i) { result += m[i] * v[i]; } return result; } \
+inline M operator*(const M& a, const M& b) { M result; for (int i=0; i<N; ++i) { result[i] = a * b[i]; } return result; }      \
+inline M transpose(const M& m) { M result; for (int i=0; i<N; ++i) { for (int j=0; j<N; ++j) { result[i][j] = m[j][i]; } } return result; }
+
+GLM_SQUARE_MATRIX(mat2, vec2, 2)
+GLM_SQUARE_MATRIX(mat3, vec3, 3)
+GLM_SQUARE_MATRIX(mat4, vec4, 4)
+#undef GLM_SQUARE_MATRIX
+
+}
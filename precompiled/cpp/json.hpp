@@ -0,0 +1,163 @@
+#pragma once
+
+// "json.hpp" is a minimal json parser, for reading the files written by "JsonSerializer.js" without third party libraries.
+// Values are parsed into a tree of "json::value", which is fine for the few files a native tool reads at once.
+// Malformed input throws std::runtime_error.
+
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace json {
+
+struct value {
+    enum type_t { null_type, boolean_type, number_type, string_type, array_type, object_type };
+    type_t                       type;
+    bool                         boolean;
+    double                       number;
+    std::string                  string;
+    std::vector<value>           array;
+    std::map<std::string, value> object;
+
+    value() : type(null_type), boolean(false), number(0.) {}
+
+    bool has(const std::string& key) const { return type == object_type && object.count(key) > 0; }
+    // NOTE: missing keys throw, since callers would otherwise silently read zeros
+    const value& operator[](const std::string& key) const {
+        auto found = object.find(key);
+        if (type != object_type || found == object.end()) {
+            throw std::runtime_error("missing json key: \"" + key + "\"");
+        }
+        return found->second;
+    }
+    const value& operator[](std::size_t i) const { return array.at(i); }
+    std::size_t size() const { return type == array_type? array.size() : object.size(); }
+};
+
+namespace detail {
+
+struct parser {
+    const std::string& text;
+    std::size_t        i;
+
+    parser(const std::string& text_) : text(text_), i(0) {}
+
+    void fail(const char* message) {
+        throw std::runtime_error(std::string("invalid json at character ") + std::to_string(i) + ": " + message);
+    }
+    void skip_whitespace() {
+        while (i < text.size() && (text[i] == ' ' || text[i] == '\n' || text[i] == '\r' || text[i] == '\t')) { ++i; }
+    }
+    char peek() {
+        skip_whitespace();
+        if (i >= text.size()) { fail("unexpected end of input"); }
+        return text[i];
+    }
+    void expect(char c) {
+        if (peek() != c) { fail("unexpected character"); }
+        ++i;
+    }
+    void expect_literal(const char* literal) {
+        for (; *literal; ++literal, ++i) {
+            if (i >= text.size() || text[i] != *literal) { fail("unexpected literal"); }
+        }
+    }
+    std::string parse_string() {
+        expect('"');
+        std::string result;
+        while (true) {
+            if (i >= text.size()) { fail("unterminated string"); }
+            char c = text[i++];
+            if (c == '"') { return result; }
+            if (c != '\\') { result += c; continue; }
+            if (i >= text.size()) { fail("unterminated escape"); }
+            c = text[i++];
+            switch (c) {
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    if (i + 4 > text.size()) { fail("unterminated escape"); }
+                    unsigned long code = std::strtoul(text.substr(i, 4).c_str(), nullptr, 16);
+                    i += 4;
+                    // NOTE: only the basic multilingual plane is supported, which covers every name the app generates
+                    if (code < 0x80) {
+                        result += char(code);
+                    } else if (code < 0x800) {
+                        result += char(0xC0 | (code >> 6));
+                        result += char(0x80 | (code & 0x3F));
+                    } else {
+                        result += char(0xE0 | (code >> 12));
+                        result += char(0x80 | ((code >> 6) & 0x3F));
+                        result += char(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: result += c; break;
+            }
+        }
+    }
+    value parse_value() {
+        value result;
+        char c = peek();
+        if (c == '{') {
+            ++i;
+            result.type = value::object_type;
+            if (peek() == '}') { ++i; return result; }
+            while (true) {
+                std::string key = parse_string();
+                expect(':');
+                result.object[key] = parse_value();
+                if (peek() == ',') { ++i; continue; }
+                expect('}');
+                return result;
+            }
+        } else if (c == '[') {
+            ++i;
+            result.type = value::array_type;
+            if (peek() == ']') { ++i; return result; }
+            while (true) {
+                result.array.push_back(parse_value());
+                if (peek() == ',') { ++i; continue; }
+                expect(']');
+                return result;
+            }
+        } else if (c == '"') {
+            result.type = value::string_type;
+            result.string = parse_string();
+        } else if (c == 't') {
+            expect_literal("true");
+            result.type = value::boolean_type;
+            result.boolean = true;
+        } else if (c == 'f') {
+            expect_literal("false");
+            result.type = value::boolean_type;
+        } else if (c == 'n') {
+            expect_literal("null");
+        } else {
+            const char* start = text.c_str() + i;
+            char* stop = nullptr;
+            result.type = value::number_type;
+            result.number = std::strtod(start, &stop);
+            if (stop == start) { fail("unexpected character"); }
+            i += stop - start;
+        }
+        return result;
+    }
+};
+
+}
+
+inline value parse(const std::string& text) {
+    detail::parser parser(text);
+    value result = parser.parse_value();
+    parser.skip_whitespace();
+    if (parser.i != text.size()) { parser.fail("trailing characters"); }
+    return result;
+}
+
+}
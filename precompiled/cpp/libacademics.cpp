@@ -0,0 +1,102 @@
+// "libacademics.cpp" is the sole translation unit of "build/libacademics.a"
+// It implements the batch entry points in "libacademics.h" using the functions of "Academics.hpp"
+
+#include "precompiled/Academics.hpp"
+#include "precompiled/cpp/raymarching.hpp"
+#include "precompiled/cpp/libacademics.h"
+
+using namespace academics;
+
+static vec3 get_vec3(const float* a, int i) {
+    return vec3(a[3*i+0], a[3*i+1], a[3*i+2]);
+}
+// NOTE: rays are gathered into lanes in groups of SIMD_LANE_COUNT,
+//   and the last group is padded by repeating its last ray, so every lane does useful or harmless work
+static vec3v get_vec3v(const float* a, int i, int count) {
+    vec3v v;
+    for (int k = 0; k < SIMD_LANE_COUNT; ++k) {
+        int j = i+k < count? i+k : count-1;
+        v.x[k] = a[3*j+0];
+        v.y[k] = a[3*j+1];
+        v.z[k] = a[3*j+2];
+    }
+    return v;
+}
+static void set_vec3v(float* a, int i, int count, const vec3v& v) {
+    for (int k = 0; k < SIMD_LANE_COUNT && i+k < count; ++k) {
+        a[3*(i+k)+0] = v.x[k];
+        a[3*(i+k)+1] = v.y[k];
+        a[3*(i+k)+2] = v.z[k];
+    }
+}
+static void set_vec3(float* a, int i, const vec3& v) {
+    a[3*i+0] = v.x;
+    a[3*i+1] = v.y;
+    a[3*i+2] = v.z;
+}
+
+void academics_solve_rgb_intensities_of_light_emitted_by_black_bodies(
+    const float* temperatures, int count,
+    float* rgb_intensities
+){
+    for (int i = 0; i < count; ++i) {
+        set_vec3(rgb_intensities, i, solve_rgb_intensity_of_light_emitted_by_black_body(temperatures[i]));
+    }
+}
+
+void academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world(
+    const float* view_origins,          const float* view_directions,  int view_count,
+    const float* world_position,        float world_radius,
+    const float* light_directions,      const float* light_rgb_intensities, int light_count,
+    const float* background_rgb_intensity,
+    float atmosphere_scale_height,
+    const float* beta_ray, const float* beta_mie, const float* beta_abs,
+    float* rgb_intensities
+){
+    // NOTE: lights beyond MAX_LIGHT_COUNT are ignored, same as the shaders
+    light_count = light_count < MAX_LIGHT_COUNT? light_count : MAX_LIGHT_COUNT;
+    vec3 L[MAX_LIGHT_COUNT];
+    vec3 I[MAX_LIGHT_COUNT];
+    for (int j = 0; j < light_count; ++j) {
+        L[j] = get_vec3(light_directions, j);
+        I[j] = get_vec3(light_rgb_intensities, j);
+    }
+    const vec3 O      = get_vec3(world_position, 0);
+    const vec3 I_back = get_vec3(background_rgb_intensity, 0);
+    const vec3 B_ray  = get_vec3(beta_ray, 0);
+    const vec3 B_mie  = get_vec3(beta_mie, 0);
+    const vec3 B_abs  = get_vec3(beta_abs, 0);
+    for (int i = 0; i < view_count; i += SIMD_LANE_COUNT) {
+        set_vec3v(rgb_intensities, i, view_count,
+            get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+                get_vec3v(view_origins, i, view_count), get_vec3v(view_directions, i, view_count),
+                O, world_radius,
+                L, I, light_count,
+                I_back, 
+                atmosphere_scale_height,
+                B_ray, B_mie, B_abs
+            )
+        );
+    }
+}
+
+void academics_get_rgb_fractions_of_light_transmitted_through_air_for_curved_world(
+    const float* segment_origins,       const float* segment_directions, const float* segment_lengths, int segment_count,
+    const float* world_position,        float world_radius,              float atmosphere_scale_height,
+    const float* beta_ray, const float* beta_mie, const float* beta_abs,
+    float* rgb_fractions
+){
+    const vec3 O      = get_vec3(world_position, 0);
+    const vec3 B_ray  = get_vec3(beta_ray, 0);
+    const vec3 B_mie  = get_vec3(beta_mie, 0);
+    const vec3 B_abs  = get_vec3(beta_abs, 0);
+    for (int i = 0; i < segment_count; ++i) {
+        set_vec3(rgb_fractions, i, 
+            get_rgb_fraction_of_light_transmitted_through_air_for_curved_world(
+                get_vec3(segment_origins, i), get_vec3(segment_directions, i), segment_lengths[i],
+                O, world_radius, atmosphere_scale_height,
+                B_ray, B_mie, B_abs
+            )
+        );
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// "libacademics.h" declares the batch entry points of "build/libacademics.a".
+// Whereas "Academics.hpp" exposes the academics layer one vec3 at a time, 
+// these functions operate on many values per call so the overhead of crossing a library boundary is amortized.
+// Vectors are passed as flat arrays of interleaved floats, e.g. "x0,y0,z0,x1,y1,z1,...",
+// mirroring the buffers used by THREE.BufferGeometry and the "everything" array of VectorRaster.
+// The functions use C linkage so they can be called from other languages.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// see "solve_rgb_intensity_of_light_emitted_by_black_body" in "emission.glsl.c"
+void academics_solve_rgb_intensities_of_light_emitted_by_black_bodies(
+    const float* temperatures, int count,
+    float* rgb_intensities
+);
+
+// see "get_rgb_intensity_of_light_scattered_from_air_for_curved_world" in "raymarching.glsl.c"
+// Rays are processed in batches using the widest vector instructions available, see "raymarching.hpp"
+void academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world(
+    const float* view_origins,          const float* view_directions,  int view_count,
+    const float* world_position,        float world_radius,
+    const float* light_directions,      const float* light_rgb_intensities, int light_count,
+    const float* background_rgb_intensity,
+    float atmosphere_scale_height,
+    const float* beta_ray, const float* beta_mie, const float* beta_abs,
+    float* rgb_intensities
+);
+
+// see "get_rgb_fraction_of_light_transmitted_through_air_for_curved_world" in "raymarching.glsl.c"
+void academics_get_rgb_fractions_of_light_transmitted_through_air_for_curved_world(
+    const float* segment_origins,       const float* segment_directions, const float* segment_lengths, int segment_count,
+    const float* world_position,        float world_radius,              float atmosphere_scale_height,
+    const float* beta_ray, const float* beta_mie, const float* beta_abs,
+    float* rgb_fractions
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+// "png.hpp" writes 8 bit rgb images as png files, without third party libraries.
+// Image data is stored using uncompressed deflate blocks, so files are larger than they could be,
+//   but writing them costs next to nothing compared to rendering.
+// Returns false if the file could not be written.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace png {
+
+namespace detail {
+
+struct crc32_table {
+    uint32_t values[256];
+    crc32_table() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) { c = c & 1? 0xEDB88320u ^ (c >> 1) : c >> 1; }
+            values[n] = c;
+        }
+    }
+};
+inline uint32_t crc32(const uint8_t* data, std::size_t length) {
+    // NOTE: static locals are initialized once, even if several threads write files at once
+    static const crc32_table table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < length; ++i) { crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8); }
+    return ~crc;
+}
+inline void append_u32(std::vector<uint8_t>& out, uint32_t x) {
+    out.push_back(uint8_t(x >> 24));
+    out.push_back(uint8_t(x >> 16));
+    out.push_back(uint8_t(x >>  8));
+    out.push_back(uint8_t(x      ));
+}
+inline void append_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    append_u32(out, uint32_t(data.size()));
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type+4);
+    out.insert(out.end(), data.begin(), data.end());
+    append_u32(out, crc32(out.data() + start, out.size() - start));
+}
+
+}
+
+// "write_rgb" writes "rgb", which holds 3 bytes per pixel in rows from top to bottom
+inline bool write_rgb(const std::string& filename, int width, int height, const std::vector<uint8_t>& rgb) {
+    // every row of a png starts with a filter type, we use none
+    std::vector<uint8_t> raw;
+    raw.reserve(std::size_t(height) * (3*width + 1));
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + std::size_t(y)*3*width, rgb.begin() + std::size_t(y+1)*3*width);
+    }
+
+    // zlib stream of stored deflate blocks, which can each hold up to 65535 bytes
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for (std::size_t i = 0; i < raw.size() || i == 0; i += 65535) {
+        std::size_t length = raw.size() - i < 65535? raw.size() - i : 65535;
+        bool is_final = i + length >= raw.size();
+        zlib.push_back(is_final? 1 : 0);
+        zlib.push_back(uint8_t(length));
+        zlib.push_back(uint8_t(length >> 8));
+        zlib.push_back(uint8_t(~length));
+        zlib.push_back(uint8_t(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + i, raw.begin() + i + length);
+        for (std::size_t j = i; j < i + length; ++j) {
+            a = (a + raw[j]) % 65521;
+            b = (b + a)      % 65521;
+        }
+        if (is_final) { break; }
+    }
+    detail::append_u32(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    detail::append_u32(header, uint32_t(width));
+    detail::append_u32(header, uint32_t(height));
+    header.push_back(8); // bit depth
+    header.push_back(2); // color type: rgb
+    header.push_back(0); // compression method
+    header.push_back(0); // filter method
+    header.push_back(0); // interlace method
+
+    std::vector<uint8_t> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    detail::append_chunk(out, "IHDR", header);
+    detail::append_chunk(out, "IDAT", zlib);
+    detail::append_chunk(out, "IEND", std::vector<uint8_t>());
+
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) { return false; }
+    bool is_written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && is_written;
+}
+
+}
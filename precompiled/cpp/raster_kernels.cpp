@@ -0,0 +1,198 @@
+// "raster_kernels.cpp" is the sole translation unit of "postcompiled/RasterKernels.wasm"
+// It implements a subset of "precompiled/rasters/parallel/RasterKernels.js" for WebAssembly,
+//   using the 128 bit lanes of "simd.hpp" when compiled with "-msimd128".
+// Kernels work on the same layout as the JS rasters: each array is a tightly packed run of floats,
+//   and vector rasters are passed as their separate x, y, and z arrays.
+// Pointers are byte offsets into the memory that the module imports, see "RasterWasmKernels.js".
+// Like their JS counterparts, kernels only write to elements within [start, end).
+// Only freestanding headers are used, so the module needs no C library and imports nothing besides memory.
+
+#include "precompiled/cpp/simd.hpp"
+
+#if defined(__wasm__)
+#define RASTER_KERNEL extern "C" __attribute__((visibility("default")))
+#else
+#define RASTER_KERNEL extern "C"
+#endif
+
+using simd::floatv;
+using simd::intv;
+using simd::broadcast;
+
+static inline floatv load(const float* a, uint32_t i) {
+    floatv v;
+    __builtin_memcpy(&v, a + i, sizeof(floatv));
+    return v;
+}
+static inline void store(float* a, uint32_t i, floatv v) {
+    __builtin_memcpy(a + i, &v, sizeof(floatv));
+}
+// "vector_end" returns the last index at which a full vector can be loaded between "start" and "end"
+static inline uint32_t vector_end(uint32_t start, uint32_t end) {
+    return end - start < SIMD_LANE_COUNT? start : end - (end - start) % SIMD_LANE_COUNT;
+}
+
+RASTER_KERNEL void add_field(const float* a, const float* b, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) + load(b, i));
+    }
+    for (; i < end; ++i) { result[i] = a[i] + b[i]; }
+}
+RASTER_KERNEL void sub_field(const float* a, const float* b, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) - load(b, i));
+    }
+    for (; i < end; ++i) { result[i] = a[i] - b[i]; }
+}
+RASTER_KERNEL void mult_field(const float* a, const float* b, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) * load(b, i));
+    }
+    for (; i < end; ++i) { result[i] = a[i] * b[i]; }
+}
+RASTER_KERNEL void add_scalar(const float* a, float scalar, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) + scalar);
+    }
+    for (; i < end; ++i) { result[i] = a[i] + scalar; }
+}
+RASTER_KERNEL void mult_scalar(const float* a, float scalar, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) * scalar);
+    }
+    for (; i < end; ++i) { result[i] = a[i] * scalar; }
+}
+RASTER_KERNEL void add_scalar_term(const float* a, const float* b, float scalar, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) + scalar * load(b, i));
+    }
+    for (; i < end; ++i) { result[i] = a[i] + scalar * b[i]; }
+}
+RASTER_KERNEL void add_field_product(const float* a, const float* b, const float* c, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, load(a, i) + load(c, i) * load(b, i));
+    }
+    for (; i < end; ++i) { result[i] = a[i] + c[i] * b[i]; }
+}
+
+// NOTE: comparisons are written so that NaN passes through unchanged, as it does in the JS kernels
+static inline floatv clamp(floatv x, floatv lo, floatv hi) {
+    return simd::select(x > hi, hi, simd::select(x < lo, lo, x));
+}
+static inline float clamp(float x, float lo, float hi) {
+    return x > hi? hi : x < lo? lo : x;
+}
+
+RASTER_KERNEL void clamp(const float* x, float min_value, float max_value, float* result, uint32_t start, uint32_t end) {
+    floatv lo = broadcast(min_value);
+    floatv hi = broadcast(max_value);
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, clamp(load(x, i), lo, hi));
+    }
+    for (; i < end; ++i) { result[i] = clamp(x[i], min_value, max_value); }
+}
+RASTER_KERNEL void linearstep(const float* x, float edge0, float edge1, float* result, uint32_t start, uint32_t end) {
+    float inverse_edge_distance = 1.f / (edge1 - edge0);
+    floatv zero = broadcast(0.f);
+    floatv one  = broadcast(1.f);
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        store(result, i, clamp((load(x, i) - edge0) * inverse_edge_distance, zero, one));
+    }
+    for (; i < end; ++i) { result[i] = clamp((x[i] - edge0) * inverse_edge_distance, 0.f, 1.f); }
+}
+RASTER_KERNEL void smoothstep(const float* x, float edge0, float edge1, float* result, uint32_t start, uint32_t end) {
+    float inverse_edge_distance = 1.f / (edge1 - edge0);
+    floatv zero = broadcast(0.f);
+    floatv one  = broadcast(1.f);
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        floatv t = clamp((load(x, i) - edge0) * inverse_edge_distance, zero, one);
+        store(result, i, t*t*(3.f-2.f*t));
+    }
+    for (; i < end; ++i) {
+        float t = clamp((x[i] - edge0) * inverse_edge_distance, 0.f, 1.f);
+        result[i] = t*t*(3.f-2.f*t);
+    }
+}
+
+RASTER_KERNEL void magnitude(const float* x, const float* y, const float* z, float* result, uint32_t start, uint32_t end) {
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        floatv xi = load(x, i), yi = load(y, i), zi = load(z, i);
+        store(result, i, simd::sqrt(xi*xi + yi*yi + zi*zi));
+    }
+    for (; i < end; ++i) { result[i] = __builtin_sqrtf(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]); }
+}
+RASTER_KERNEL void normalize(const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, uint32_t start, uint32_t end) {
+    floatv one = broadcast(1.f);
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        floatv xi = load(x, i), yi = load(y, i), zi = load(z, i);
+        floatv mag = simd::sqrt(xi*xi + yi*yi + zi*zi);
+        // NOTE: this matches "mag||1" in JS, which is 1 for both 0 and NaN
+        mag = simd::select((mag == mag) & (mag != 0.f), mag, one);
+        store(ox, i, xi/mag);
+        store(oy, i, yi/mag);
+        store(oz, i, zi/mag);
+    }
+    for (; i < end; ++i) {
+        float mag = __builtin_sqrtf(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+        mag = mag == mag && mag != 0.f? mag : 1.f;
+        ox[i] = x[i]/mag;
+        oy[i] = y[i]/mag;
+        oz[i] = z[i]/mag;
+    }
+}
+
+// "nearest_cell_ids" is the first pass of "VoronoiSphere.prototype.getNearestIds": 
+//   it finds the index within the table of a VoronoiSphere that each position maps to, and the second pass reads the table.
+// The table lives outside of module memory, so it is read in JS.
+// A position maps to the side of the octahedron that matches the signs of its components, 
+//   and the axes of that side reduce to closed forms of those signs, so no per-lane lookup of axes is needed:
+//   x axis = (sy, -sx, 0) / sqrt(2)
+//   y axis = (sx*sz, sy*sz, -2) / sqrt(6)
+// NOTE: JS finds projections in double precision from axes that are stored as floats, 
+//   so positions that lie within rounding error of a boundary between cells may map to either cell.
+static const float INVERSE_SQRT2 = 0.70710678118654752f;
+static const float INVERSE_SQRT6 = 0.40824829046386302f;
+
+RASTER_KERNEL void nearest_cell_ids(const float* x, const float* y, const float* z, float cell_width, uint32_t dimension_x, uint32_t dimension_y, uint32_t* result, uint32_t start, uint32_t end) {
+    floatv one = broadcast(1.f);
+    intv side_stride = intv{} + (int32_t)(dimension_x * dimension_y);
+    intv row_stride  = intv{} + (int32_t)dimension_y;
+    uint32_t i = start;
+    for (uint32_t li = vector_end(start, end); i < li; i += SIMD_LANE_COUNT) {
+        floatv xi = load(x, i), yi = load(y, i), zi = load(z, i);
+        intv is_x = xi > 0.f, is_y = yi > 0.f, is_z = zi > 0.f;
+        floatv sx = simd::select(is_x, one, -one);
+        floatv sy = simd::select(is_y, one, -one);
+        floatv sz = simd::select(is_z, one, -one);
+        intv side_id = (is_x & 1) + ((is_y & 1) << 1) + ((is_z & 1) << 2);
+        floatv projection_x = (sy*xi - sx*yi) * INVERSE_SQRT2;
+        floatv projection_y = (sx*sz*xi + sy*sz*yi - 2.f*zi) * INVERSE_SQRT6;
+        intv grid_pos_x = __builtin_convertvector(simd::floor((projection_x + 1.f) / cell_width), intv);
+        intv grid_pos_y = __builtin_convertvector(simd::floor((projection_y + 1.f) / cell_width), intv);
+        intv id = side_id * side_stride + grid_pos_x * row_stride + grid_pos_y;
+        __builtin_memcpy(result + i, &id, sizeof(intv));
+    }
+    for (; i < end; ++i) {
+        float sx = x[i] > 0.f? 1.f : -1.f;
+        float sy = y[i] > 0.f? 1.f : -1.f;
+        float sz = z[i] > 0.f? 1.f : -1.f;
+        uint32_t side_id = (x[i] > 0.f) + ((y[i] > 0.f) << 1) + ((z[i] > 0.f) << 2);
+        float projection_x = (sy*x[i] - sx*y[i]) * INVERSE_SQRT2;
+        float projection_y = (sx*sz*x[i] + sy*sz*y[i] - 2.f*z[i]) * INVERSE_SQRT6;
+        uint32_t grid_pos_x = (uint32_t)__builtin_floorf((projection_x + 1.f) / cell_width);
+        uint32_t grid_pos_y = (uint32_t)__builtin_floorf((projection_y + 1.f) / cell_width);
+        result[i] = side_id * dimension_x * dimension_y + grid_pos_x * dimension_y + grid_pos_y;
+    }
+}
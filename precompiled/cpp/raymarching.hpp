@@ -0,0 +1,240 @@
+#pragma once
+
+// "raymarching.hpp" is a batched counterpart to the atmosphere functions of "raymarching.glsl.c".
+// Each function processes one ray for each lane of "simd::floatv", with arguments in "structure of arrays" form.
+// The functions share names with their counterparts and take the same arguments,
+//   except that values that vary by ray are given as lanes.
+// Take care to keep these functions in sync with raymarching.glsl.c,
+//   "tests/cpp/Academics.cpp" checks that they agree.
+
+#include "precompiled/Academics.hpp"
+#include "precompiled/cpp/simd.hpp"
+
+namespace academics {
+
+using simd::floatv;
+using simd::intv;
+
+struct vec3v {
+    floatv x, y, z;
+    vec3v() : x(), y(), z() {}
+    vec3v(floatv x_, floatv y_, floatv z_) : x(x_), y(y_), z(z_) {}
+    explicit vec3v(const vec3& v) : x(simd::broadcast(v.x)), y(simd::broadcast(v.y)), z(simd::broadcast(v.z)) {}
+};
+inline vec3v  operator+ (const vec3v& a, const vec3v& b) { return vec3v(a.x+b.x, a.y+b.y, a.z+b.z); }
+inline vec3v  operator- (const vec3v& a, const vec3v& b) { return vec3v(a.x-b.x, a.y-b.y, a.z-b.z); }
+inline vec3v  operator* (const vec3v& a, floatv b)       { return vec3v(a.x*b,   a.y*b,   a.z*b  ); }
+inline vec3v  operator* (const vec3v& a, const vec3& b)  { return vec3v(a.x*b.x, a.y*b.y, a.z*b.z); }
+inline vec3v  operator* (const vec3v& a, const vec3v& b) { return vec3v(a.x*b.x, a.y*b.y, a.z*b.z); }
+inline vec3v& operator+=(vec3v& a, const vec3v& b)       { return a = a + b; }
+inline floatv dot(const vec3v& a, const vec3v& b)        { return a.x*b.x + a.y*b.y + a.z*b.z; }
+inline floatv dot(const vec3v& a, const vec3&  b)        { return a.x*b.x + a.y*b.y + a.z*b.z; }
+inline vec3v  exp(const vec3v& a)                        { return vec3v(simd::exp(a.x), simd::exp(a.y), simd::exp(a.z)); }
+inline vec3v  select(intv mask, const vec3v& a, const vec3v& b) {
+    return vec3v(simd::select(mask, a.x, b.x), simd::select(mask, a.y, b.y), simd::select(mask, a.z, b.z));
+}
+
+inline intv try_get_relation_between_ray_and_sphere(
+    const float  sphere_radius,
+    const floatv z2,
+    const floatv xz,
+    floatv&      distance_to_entrance,
+    floatv&      distance_to_exit
+){
+    const float sphere_radius2 = sphere_radius * sphere_radius;
+
+    floatv distance_from_closest_approach_to_exit = simd::sqrt(simd::max(sphere_radius2 - z2, simd::broadcast(1e-10f)));
+    distance_to_entrance = xz - distance_from_closest_approach_to_exit;
+    distance_to_exit     = xz + distance_from_closest_approach_to_exit;
+
+    return (distance_to_exit > 0.f) & (z2 < sphere_radius2);
+}
+
+inline floatv approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+    const floatv x_start,
+    const floatv x_stop,
+    const floatv z2,
+    const float  r,
+    const float  H
+){
+    // NOTE: see raymarching.glsl.c for a guide to variable names
+    const float a = 0.45f;
+    const float b = 0.45f;
+
+    floatv x0 = simd::sqrt(simd::max(r *r -z2, simd::broadcast(0.f)));
+    intv is_obstructed = (x_start < x0) & (-x0 < x_stop) & (z2 < r*r);
+
+    float  r1      = r + 6.f*H;
+    floatv x1      = simd::sqrt(simd::max(r1*r1-z2, simd::broadcast(0.f)));
+    floatv xb      = x0+(x1-x0)*b;
+    floatv rb2     = xb*xb + z2;
+    floatv rb      = simd::sqrt(rb2);
+    floatv d2hdx2  = z2 / simd::sqrt(rb2*rb2*rb2);
+    floatv dhdx    = xb / rb;
+    floatv hb      = rb - r;
+    floatv dx0     = x0                   -xb;
+    floatv dx_stop = simd::abs(x_stop )   -xb;
+    floatv dx_start= simd::abs(x_start)   -xb;
+    floatv h0      = (0.5f * a * d2hdx2 * dx0      + dhdx) * dx0      + hb;
+    floatv h_stop  = (0.5f * a * d2hdx2 * dx_stop  + dhdx) * dx_stop  + hb;
+    floatv h_start = (0.5f * a * d2hdx2 * dx_start + dhdx) * dx_start + hb;
+
+    floatv rho0  = simd::exp(-h0/H);
+    floatv sigma =
+        simd::sign(x_stop ) * simd::max(H/dhdx * (rho0 - simd::exp(-h_stop /H)), simd::broadcast(0.f))
+      - simd::sign(x_start) * simd::max(H/dhdx * (rho0 - simd::exp(-h_start/H)), simd::broadcast(0.f));
+
+    intv is_empty = z2 > r1*r1;
+
+    return simd::select(is_obstructed, simd::broadcast(BIG), 
+           simd::select(is_empty,      simd::broadcast(0.f), simd::min(simd::abs(sigma), simd::broadcast(BIG))));
+}
+
+inline floatv get_fraction_of_rayleigh_scattered_light_scattered_by_angle(
+    const floatv cos_scatter_angle
+){
+    return 3.f * (1.f + cos_scatter_angle*cos_scatter_angle) / (16.f * PI);
+}
+
+inline floatv get_fraction_of_mie_scattered_light_scattered_by_angle(
+    const floatv cos_scatter_angle
+){
+    const float g = 0.76f;
+    // NOTE: pow(x, 1.5) is written as x*sqrt(x), since there is no vector instruction for pow
+    floatv x = 1.f + g*g - 2.f*g*cos_scatter_angle;
+    return (1.f - g*g) / ((4.f + PI) * x * simd::sqrt(x));
+}
+
+inline floatv get_fraction_along_raymarch(
+    const floatv u,
+    const floatv u_dense
+){
+    return simd::select(u < u_dense,
+        u_dense - (u_dense-u)*(u_dense-u) / simd::max(u_dense,     simd::broadcast(SMALL)),
+        u_dense + (u-u_dense)*(u-u_dense) / simd::max(1.f-u_dense, simd::broadcast(SMALL)));
+}
+
+inline vec3v get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    const vec3v  view_origin,     const vec3v view_direction,
+    const vec3   world_position,  const float world_radius,
+    const vec3*  light_directions,
+    const vec3*  light_rgb_intensities,
+    const int    light_count,
+    const vec3v  background_rgb_intensity,
+    const float  atmosphere_scale_height,
+    const vec3   beta_ray, const vec3 beta_mie, const vec3 beta_abs
+){
+    // NOTE: see raymarching.glsl.c for a guide to variable names
+    vec3v  P = view_origin - vec3v(world_position);
+    vec3v  V = view_direction;
+    vec3v  I_back = background_rgb_intensity;
+    float  r = world_radius;
+    float  H = atmosphere_scale_height;
+
+    floatv xv  = -dot(P,V);           // distance from view ray origin to closest approach
+    floatv zv2 = dot(P,P) - xv * xv;  // squared distance from the view ray to the center of the world at closest approach
+
+    floatv xv_in_air;      // distance along the view ray at which the ray enters the atmosphere
+    floatv xv_out_air;     // distance along the view ray at which the ray exits the atmosphere
+    floatv xv_in_world;    // distance along the view ray at which the ray enters the surface of the world
+    floatv xv_out_world;   // distance along the view ray at which the ray enters the surface of the world
+
+    intv is_scattered  = try_get_relation_between_ray_and_sphere(r + 12.f*H, zv2, xv, xv_in_air,   xv_out_air  );
+    intv is_obstructed = try_get_relation_between_ray_and_sphere(r,          zv2, xv, xv_in_world, xv_out_world);
+
+    // if no view ray interacts with the atmosphere
+    // don't bother running the raymarch algorithm
+    if (!simd::any(is_scattered)){ return I_back; }
+
+    vec3   beta_sum = beta_ray + beta_mie + beta_abs;
+
+    floatv xv_start = simd::max(xv_in_air, simd::broadcast(0.f));
+    floatv xv_stop  = simd::select(is_obstructed, xv_in_world, xv_out_air);
+
+    // NOTE: steps are chosen the same way as in raymarching.glsl.c, see "RAYMARCH_MIN_STEP_COUNT"
+    floatv xv_surface  = -simd::sqrt(simd::max(r*r - zv2, simd::broadcast(0.f)));
+    floatv sigma_march = approx_air_column_density_ratio_along_2d_ray_for_curved_world(xv_start-xv, simd::select(is_obstructed, xv_surface, xv_stop-xv), zv2, r, H );
+    floatv step_count  = simd::ceil(RAYMARCH_MIN_STEP_COUNT + (RAYMARCH_MAX_STEP_COUNT - RAYMARCH_MIN_STEP_COUNT) *
+        simd::sqrt(simd::min(sigma_march / std::sqrt(0.5f*PI*r*H), simd::broadcast(1.f))));
+    floatv u_dense     = simd::min(simd::max((xv - xv_start) / simd::max(xv_stop - xv_start, simd::broadcast(SMALL)), simd::broadcast(0.f)), simd::broadcast(1.f));
+    float  sigma_v_max = -std::log(RAYMARCH_MIN_TRANSMITTANCE) / glm::max(glm::min(beta_sum.x, glm::min(beta_sum.y, beta_sum.z)), SMALL);
+
+    floatv u_start;     // fraction of the march's distance at which a single iteration of the view ray march starts
+    floatv u_stop = simd::broadcast(0.f); // fraction of the march's distance at which a single iteration of the view ray march stops
+    floatv dx;          // distance covered by a single iteration of the view ray march
+    floatv xvi;         // distance along the view ray from closest approach for a single iteration of the view ray march
+    intv   is_marching; // whether a ray has yet to finish its march
+
+    floatv VL[MAX_LIGHT_COUNT];           // cosine of angle between view and light directions
+    vec3v  beta_gamma[MAX_LIGHT_COUNT];   // fraction of light that scatters towards the camera, irrespective of density
+    for (int j = 0; j < light_count; ++j)
+    {
+        VL[j] = dot(V, light_directions[j]);
+        beta_gamma[j] =
+            vec3v(beta_ray) * get_fraction_of_rayleigh_scattered_light_scattered_by_angle(VL[j]) +
+            vec3v(beta_mie) * get_fraction_of_mie_scattered_light_scattered_by_angle(VL[j]);
+    }
+
+    floatv xl;          // distance from light ray origin to closest approach
+    floatv zl2;         // squared distance ("radius") of the light ray at closest for a single iteration of the view ray march
+    floatv r2;          // squared distance ("radius") from the center of the world for a single iteration of the view ray march
+    floatv h;           // distance ("height") from the surface of the world for a single iteration of the view ray march
+    floatv sigma_v;     // columnar density encountered along the view ray,  relative to surface density
+    floatv sigma_l;     // columnar density encountered along the light ray, relative to surface density
+    vec3v  E;           // total intensity for each color channel, found as the sum of light intensities for each path from the light source to the camera
+
+    // NOTE: rays finish their march after different numbers of steps, so the steps of finished rays are given no distance,
+    //   and the march stops once every ray has finished
+    for (float i = 0.f; i < RAYMARCH_MAX_STEP_COUNT; ++i)
+    {
+        u_start = u_stop;
+        u_stop  = get_fraction_along_raymarch((i+1.f) / step_count, u_dense);
+        xvi = xv_start - xv + get_fraction_along_raymarch((i+0.5f) / step_count, u_dense) * (xv_stop - xv_start);
+        r2  = xvi*xvi+zv2;
+        h   = simd::sqrt(r2) - r;
+        sigma_v = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xvi, zv2, r, H );
+        is_marching = (i < step_count) & (sigma_v <= sigma_v_max) & is_scattered;
+        if (!simd::any(is_marching)) { break; }
+        dx  = simd::select(is_marching, (u_stop - u_start) * (xv_stop - xv_start), simd::broadcast(0.f));
+
+        for (int j = 0; j < light_count; ++j)
+        {
+            xl  = -dot(P+V*(xvi+xv), light_directions[j]);
+            zl2 = r2 - xl*xl;
+            sigma_l = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xl, simd::broadcast(3.f*r), zl2, r, H );
+
+            E += vec3v(light_rgb_intensities[j])
+                // incoming fraction: the fraction of light that scatters towards camera
+                * (beta_gamma[j] * (simd::exp(-h/H) * dx))
+                // outgoing fraction: the fraction of light that scatters away from camera
+                * exp(vec3v(-beta_sum) * (sigma_l + sigma_v));
+        }
+    }
+
+    // now calculate the intensity of light that traveled straight in from the background, and add it to the total
+    sigma_v  = approx_air_column_density_ratio_along_2d_ray_for_curved_world(-xv, xv_stop-xv_start-xv, zv2, r, H );
+    E += I_back * exp(vec3v(-beta_sum) * sigma_v);
+
+    return select(is_scattered, E, I_back);
+}
+
+// NOTE: this overload is for callers whose background is the same for every ray
+inline vec3v get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+    const vec3v  view_origin,     const vec3v view_direction,
+    const vec3   world_position,  const float world_radius,
+    const vec3*  light_directions,
+    const vec3*  light_rgb_intensities,
+    const int    light_count,
+    const vec3   background_rgb_intensity,
+    const float  atmosphere_scale_height,
+    const vec3   beta_ray, const vec3 beta_mie, const vec3 beta_abs
+){
+    return get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+        view_origin, view_direction, world_position, world_radius,
+        light_directions, light_rgb_intensities, light_count,
+        vec3v(background_rgb_intensity),
+        atmosphere_scale_height, beta_ray, beta_mie, beta_abs
+    );
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// "realistic.hpp" is the C++ counterpart to the surface model of the "realistic" shaders.
+// It compiles "realistic_surface.glsl.c" under the "CPP" branch of "cross_platform_macros.glsl.c",
+//   using the most general variant, as for fragmentShaders.realistic with "exact_emission" set.
+
+#include "precompiled/Academics.hpp"
+
+namespace academics {
+// NOTE: some standard headers declare "::abs(float)", which is as near as "glm::abs" to the global namespace,
+//   so it is declared here to keep calls within the shader unambiguous
+using glm::abs;
+
+CONST(int)  VARIANT_LIGHT_COUNT        = MAX_LIGHT_COUNT;
+CONST(bool) VARIANT_HAS_OCEAN          = true;
+CONST(bool) VARIANT_HAS_SPECULAR       = true;
+CONST(bool) VARIANT_HAS_EXACT_EMISSION = true;
+#include "precompiled/shaders/realistic_surface.glsl.c"
+}
@@ -0,0 +1,515 @@
+// "render.cpp" is a command line renderer for the files that are written by JsonSerializer.render_state(),
+//   so thumbnails can be made for many worlds without a browser.
+// It renders the same way as RealisticWorldView.js when it uses float render targets:
+//   the surface is lit by "realistic_surface.glsl.c" (see "realistic.hpp"),
+//   the atmosphere of the globe is raymarched by "raymarching.hpp",
+//   and intensities are tone mapped in the same way as ToneMappingPass.js.
+// Like the gpu, it rasterizes the triangles of the grid and interpolates cell attributes across them.
+// The image is split into bands of rows that are rendered by a pool of threads.
+//
+// Usage: build/render [options] <file>...
+//   --projection <name>          "globe" (default) or "equirectangular"
+//   --width <pixels>             default 512
+//   --height <pixels>            default 512 for the globe, half of width for equirectangular
+//   --longitude <degrees>        longitude at the center of the image, default 0
+//   --latitude <degrees>         latitude at the center of the globe, default 0
+//   --exposure-intensity <W/m^2> default 150, as in View.js
+//   --threads <count>            default is the number of cores
+//   --output-directory <path>    default is the directory of each file
+// Each "<name>.json" is written to "<name>.png".
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "precompiled/Academics.hpp"
+#include "precompiled/cpp/raymarching.hpp"
+#include "precompiled/cpp/realistic.hpp"
+#include "precompiled/cpp/json.hpp"
+#include "precompiled/cpp/png.hpp"
+
+using namespace academics;
+
+// NOTE: these must match the coefficients in RealisticWorldView.js
+static const vec3 SURFACE_AIR_RAYLEIGH_SCATTERING_COEFFICIENTS = vec3(5.20e-6f, 1.21e-5f, 2.96e-5f);
+static const vec3 SURFACE_AIR_MIE_SCATTERING_COEFFICIENTS      = vec3(2.1e-8f,  2.1e-8f,  2.1e-8f );
+static const vec3 SURFACE_AIR_ABSORPTION_COEFFICIENTS          = vec3(0.f);
+static const vec3 OCEAN_RAYLEIGH_SCATTERING_COEFFICIENTS       = vec3(0.005f, 0.01f, 0.03f);
+static const vec3 OCEAN_MIE_SCATTERING_COEFFICIENTS            = vec3(0.f);
+static const vec3 OCEAN_ABSORPTION_COEFFICIENTS                = vec3(3e-1f, 1e-1f, 2e-2f);
+
+// rows of the image that are rendered together by a thread
+static const int BAND_HEIGHT = 16;
+// half the width of the image of the globe, in world radii
+static const float GLOBE_EXTENT = 1.1f;
+
+struct RenderState {
+    std::string        name;
+    float              radius;
+    float              sealevel;
+    float              atmosphere_scale_height;
+    std::vector<vec3>  vertices;
+    std::vector<int>   faces;   // 3 cell ids per face
+    std::vector<vec3>  light_directions;
+    std::vector<vec3>  light_rgb_intensities;
+    std::vector<float> displacement;
+    std::vector<vec3>  gradient;
+    std::vector<float> surface_temperature;
+    std::vector<float> snow_coverage;
+    std::vector<float> plant_coverage;
+};
+
+struct Options {
+    bool        is_globe           = true;
+    int         width              = 512;
+    int         height             = 0;
+    float       longitude          = 0.f;
+    float       latitude           = 0.f;
+    float       exposure_intensity = 150.f;
+    int         thread_count       = 0;
+    std::string output_directory;
+};
+
+// "decode_bytes" reads the ArrayBuffer of a string that was written by the replacer of "JsonSerializer.js"
+static std::vector<uint8_t> decode_bytes(const json::value& value) {
+    const std::string prefix = "buffer:";
+    const std::string& text = value.string;
+    if (value.type != json::value::string_type || text.compare(0, prefix.size(), prefix) != 0) {
+        throw std::runtime_error("expected a buffer");
+    }
+    std::vector<uint8_t> bytes;
+    bytes.reserve(text.size() * 3 / 4);
+    uint32_t accumulator = 0;
+    int      bit_count   = 0;
+    for (std::size_t i = prefix.size(); i < text.size(); ++i) {
+        char c = text[i];
+        int  digit =
+            'A' <= c && c <= 'Z'? c - 'A' :
+            'a' <= c && c <= 'z'? c - 'a' + 26 :
+            '0' <= c && c <= '9'? c - '0' + 52 :
+            c == '+'? 62 : c == '/'? 63 : -1;
+        if (digit < 0) { break; } // padding
+        accumulator = (accumulator << 6) | uint32_t(digit);
+        bit_count += 6;
+        if (bit_count >= 8) {
+            bit_count -= 8;
+            bytes.push_back(uint8_t(accumulator >> bit_count));
+        }
+    }
+    return bytes;
+}
+// "decode_buffer" reads the Float32Array of a string that was written by the replacer of "JsonSerializer.js"
+// NOTE: javascript typed arrays use the byte order of the machine that wrote them, which is little endian in practice
+static std::vector<float> decode_buffer(const json::value& value) {
+    std::vector<uint8_t> bytes = decode_bytes(value);
+    std::vector<float> result(bytes.size() / sizeof(float));
+    std::memcpy(result.data(), bytes.data(), result.size() * sizeof(float));
+    return result;
+}
+// "decode_float16" returns the value of a half precision float, see "RasterKernels.decode_float16"
+static float decode_float16(uint16_t h) {
+    float sign     = h & 0x8000? -1.f : 1.f;
+    int   exponent = (h >> 10) & 0x1f;
+    int   mantissa = h & 0x3ff;
+    if (exponent == 0)    { return sign * std::ldexp(float(mantissa), -24); }
+    if (exponent == 0x1f) { return mantissa == 0? sign * INFINITY : NAN; }
+    return sign * std::ldexp(float(mantissa | 0x400), exponent - 25);
+}
+// "decode_quantized_raster" reads the values of a raster that was stored by "QuantizedRaster.getParameters"
+static std::vector<float> decode_quantized_raster(const json::value& value) {
+    const std::string& encoding = value["encoding"].string;
+    std::vector<uint8_t> bytes = decode_bytes(value["buffer"]);
+    std::vector<uint16_t> q(bytes.size() / sizeof(uint16_t));
+    std::memcpy(q.data(), bytes.data(), q.size() * sizeof(uint16_t));
+    std::vector<float> result(q.size());
+    if (encoding == "fixed16") {
+        float offset = float(value["offset"].number);
+        float scale  = float(value["scale"].number);
+        for (std::size_t i = 0; i < q.size(); ++i) { result[i] = offset + scale * float(q[i]); }
+    } else if (encoding == "float16") {
+        for (std::size_t i = 0; i < q.size(); ++i) { result[i] = decode_float16(q[i]); }
+    } else {
+        throw std::runtime_error("unsupported quantized raster encoding: \"" + encoding + "\"");
+    }
+    return result;
+}
+static vec3 get_vec3(const json::value& value) {
+    return vec3(float(value["x"].number), float(value["y"].number), float(value["z"].number));
+}
+// NOTE: scalar rasters are either a buffer, or the parameters of a QuantizedRaster
+static std::vector<float> get_scalar_raster(const json::value& value, std::size_t cell_count) {
+    std::vector<float> result = value.type == json::value::object_type? decode_quantized_raster(value) : decode_buffer(value);
+    if (result.size() != cell_count) { throw std::runtime_error("raster does not match the grid"); }
+    return result;
+}
+// NOTE: vector rasters are stored as their "everything" array, which holds all x, then all y, then all z
+static std::vector<vec3> get_vector_raster(const json::value& value, std::size_t cell_count) {
+    std::vector<float> everything = decode_buffer(value);
+    if (everything.size() != 3 * cell_count) { throw std::runtime_error("raster does not match the grid"); }
+    std::vector<vec3> result(cell_count);
+    for (std::size_t i = 0; i < cell_count; ++i) {
+        result[i] = vec3(everything[i], everything[i+cell_count], everything[i+2*cell_count]);
+    }
+    return result;
+}
+
+static RenderState load_render_state(const std::string& filename) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file) { throw std::runtime_error("could not read file"); }
+    std::stringstream text;
+    text << file.rdbuf();
+    json::value root = json::parse(text.str());
+    if (!root.has("type") || root["type"].string != "render_state") {
+        throw std::runtime_error("not a file written by JsonSerializer.render_state()");
+    }
+
+    RenderState state;
+    state.name                    = root.has("name")? root["name"].string : "";
+    state.radius                  = float(root["radius"].number);
+    state.sealevel                = float(root["sealevel"].number);
+    state.atmosphere_scale_height = float(root["atmosphere_scale_height"].number);
+    for (const json::value& vertex : root["grid"]["vertices"].array) {
+        state.vertices.push_back(get_vec3(vertex));
+    }
+    for (const json::value& face : root["grid"]["faces"].array) {
+        int ids[3] = { int(face["a"].number), int(face["b"].number), int(face["c"].number) };
+        for (int id : ids) {
+            if (id < 0 || std::size_t(id) >= state.vertices.size()) { throw std::runtime_error("face refers to a missing vertex"); }
+            state.faces.push_back(id);
+        }
+    }
+    for (const json::value& light : root["light_directions"].array) {
+        state.light_directions.push_back(get_vec3(light));
+    }
+    for (const json::value& light : root["light_rgb_intensities"].array) {
+        state.light_rgb_intensities.push_back(get_vec3(light));
+    }
+    std::size_t cell_count = state.vertices.size();
+    state.displacement        = get_scalar_raster(root["displacement"],        cell_count);
+    state.gradient            = get_vector_raster(root["gradient"],            cell_count);
+    state.surface_temperature = get_scalar_raster(root["surface_temperature"], cell_count);
+    state.snow_coverage       = get_scalar_raster(root["snow_coverage"],       cell_count);
+    state.plant_coverage      = get_scalar_raster(root["plant_coverage"],      cell_count);
+    return state;
+}
+
+// "Camera" maps positions on a world of unit radius to pixels, for either projection
+struct Camera {
+    bool  is_globe;
+    int   width, height;
+    float longitude;
+    // the globe is viewed orthographically from "toward", with "right" and "up" along the image
+    vec3  toward, right, up;
+    float pixels_per_radius;
+
+    Camera(const Options& options) :
+        is_globe(options.is_globe), width(options.width), height(options.height), longitude(options.longitude * DEGREE)
+    {
+        // NOTE: latitude is kept from the poles, where "right" would be undefined
+        float latitude = clamp(options.latitude, -89.9f, 89.9f) * DEGREE;
+        // NOTE: longitude follows the convention of the map projection shaders, "atan(-z, x)"
+        toward = vec3(std::cos(latitude)*std::cos(longitude), std::sin(latitude), -std::cos(latitude)*std::sin(longitude));
+        right  = normalize(cross(vec3(0,1,0), toward));
+        up     = cross(toward, right);
+        pixels_per_radius = std::min(width, height) / (2.f * GLOBE_EXTENT);
+    }
+    // returns the pixel coordinates of "position" in x and y, and its distance towards the camera in z
+    vec3 get_screen_position(const vec3& position) const {
+        if (is_globe) {
+            return vec3(
+                0.5f*width  + dot(position, right) * pixels_per_radius,
+                0.5f*height - dot(position, up)    * pixels_per_radius,
+                dot(position, toward)
+            );
+        }
+        float lon = mod(std::atan2(-position.z, position.x) - longitude + PI, 2.f*PI) - PI;
+        float lat = std::asin(clamp(position.y / length(position), -1.f, 1.f));
+        return vec3((lon + PI) / (2.f*PI) * width, (0.5f*PI - lat) / PI * height, 0.f);
+    }
+};
+
+struct Triangle {
+    vec3 screen[3];
+    int  cells[3];
+};
+
+// "get_triangles" projects the faces of the grid,
+//   faces that straddle the edge of an equirectangular map are wrapped so they appear on both sides
+static std::vector<Triangle> get_triangles(const RenderState& state, const Camera& camera) {
+    std::vector<Triangle> triangles;
+    triangles.reserve(state.faces.size() / 3);
+    for (std::size_t i = 0; i < state.faces.size(); i += 3) {
+        Triangle triangle;
+        for (int k = 0; k < 3; ++k) {
+            int cell = state.faces[i+k];
+            // NOTE: land is raised above sea level in the same way as "orthographic.glsl.c"
+            float surface_height = max(state.displacement[cell] - state.sealevel, 0.f);
+            triangle.cells[k]  = cell;
+            triangle.screen[k] = camera.get_screen_position(
+                normalize(state.vertices[cell]) * ((state.radius + surface_height) / state.radius));
+        }
+        if (!camera.is_globe) {
+            float min_x = std::min(triangle.screen[0].x, std::min(triangle.screen[1].x, triangle.screen[2].x));
+            float max_x = std::max(triangle.screen[0].x, std::max(triangle.screen[1].x, triangle.screen[2].x));
+            if (max_x - min_x > 0.5f * camera.width) {
+                for (int k = 0; k < 3; ++k) {
+                    if (triangle.screen[k].x < 0.5f * camera.width) { triangle.screen[k].x += camera.width; }
+                }
+                triangles.push_back(triangle);
+                for (int k = 0; k < 3; ++k) { triangle.screen[k].x -= camera.width; }
+            }
+        }
+        triangles.push_back(triangle);
+    }
+    return triangles;
+}
+
+static float get_edge(const vec3& a, const vec3& b, float x, float y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+// "render_band" renders rows [y0, y1) of the image, writing 8 bit rgb to "rgb"
+static void render_band(
+    const RenderState& state, const Camera& camera, const Options& options,
+    const std::vector<Triangle>& triangles, const std::vector<int>& band_triangles,
+    int y0, int y1, std::vector<uint8_t>& rgb
+){
+    const int width = camera.width;
+    const int pixel_count = width * (y1 - y0);
+
+    // RASTERIZATION: find the nearest triangle and its barycentric coordinates for each pixel
+    std::vector<float> depths   (pixel_count, -INFINITY);
+    std::vector<int>   faces    (pixel_count, -1);
+    std::vector<vec3>  weights  (pixel_count);
+    for (int t : band_triangles) {
+        const Triangle& triangle = triangles[t];
+        const vec3& a = triangle.screen[0];
+        const vec3& b = triangle.screen[1];
+        const vec3& c = triangle.screen[2];
+        float area = get_edge(a, b, c.x, c.y);
+        if (std::abs(area) < 1e-12f) { continue; }
+        int min_x = std::max(0,       int(std::floor(std::min(a.x, std::min(b.x, c.x)))));
+        int max_x = std::min(width-1, int(std::ceil (std::max(a.x, std::max(b.x, c.x)))));
+        int min_y = std::max(y0,      int(std::floor(std::min(a.y, std::min(b.y, c.y)))));
+        int max_y = std::min(y1-1,    int(std::ceil (std::max(a.y, std::max(b.y, c.y)))));
+        for (int y = min_y; y <= max_y; ++y) {
+            for (int x = min_x; x <= max_x; ++x) {
+                // NOTE: dividing by area gives weights that are positive inside, regardless of winding order
+                float px = x + 0.5f;
+                float py = y + 0.5f;
+                vec3 w = vec3(get_edge(b, c, px, py), get_edge(c, a, px, py), get_edge(a, b, px, py)) / area;
+                if (w.x < -1e-6f || w.y < -1e-6f || w.z < -1e-6f) { continue; }
+                float depth = w.x * a.z + w.y * b.z + w.z * c.z;
+                int i = (y - y0) * width + x;
+                if (depth > depths[i]) {
+                    depths[i]  = depth;
+                    faces[i]   = t;
+                    weights[i] = w;
+                }
+            }
+        }
+    }
+
+    // SURFACE: light each pixel, as in "realistic.glsl.c"
+    int  light_count = std::min(int(state.light_directions.size()), MAX_LIGHT_COUNT);
+    vec3 light_directions      [MAX_LIGHT_COUNT];
+    vec3 light_rgb_intensities [MAX_LIGHT_COUNT];
+    for (int j = 0; j < light_count; ++j) {
+        light_directions[j]      = normalize(state.light_directions[j]);
+        light_rgb_intensities[j] = state.light_rgb_intensities[j];
+    }
+    std::vector<vec3> rgb_intensities(pixel_count, vec3(0.f));
+    for (int i = 0; i < pixel_count; ++i) {
+        if (faces[i] < 0) { continue; }
+        const Triangle& triangle = triangles[faces[i]];
+        const vec3& w = weights[i];
+        int a = triangle.cells[0];
+        int b = triangle.cells[1];
+        int c = triangle.cells[2];
+        vec3 position = normalize(
+            w.x * normalize(state.vertices[a]) + w.y * normalize(state.vertices[b]) + w.z * normalize(state.vertices[c]));
+        // NOTE: map projections view each point from above its horizon, as in "texture.glsl.c"
+        vec3 view_direction = camera.is_globe? -camera.toward : normalize(vec3(-position.x, 0.f, -position.z));
+        rgb_intensities[i] = get_rgb_intensity_of_surface_of_world(
+            1.f, 1.f, 1.f, 1.f, 1.f, 1.f, // visibility of ocean, sediment, plants, snow, shadow, and specular reflection
+            light_directions, light_rgb_intensities, light_count,
+            state.atmosphere_scale_height,
+            SURFACE_AIR_RAYLEIGH_SCATTERING_COEFFICIENTS,
+            SURFACE_AIR_MIE_SCATTERING_COEFFICIENTS,
+            SURFACE_AIR_ABSORPTION_COEFFICIENTS,
+            state.sealevel,
+            OCEAN_RAYLEIGH_SCATTERING_COEFFICIENTS,
+            OCEAN_MIE_SCATTERING_COEFFICIENTS,
+            OCEAN_ABSORPTION_COEFFICIENTS,
+            state.radius,
+            w.x * state.displacement[a]        + w.y * state.displacement[b]        + w.z * state.displacement[c],
+            w.x * state.gradient[a]            + w.y * state.gradient[b]            + w.z * state.gradient[c],
+            w.x * state.plant_coverage[a]      + w.y * state.plant_coverage[b]      + w.z * state.plant_coverage[c],
+            w.x * state.snow_coverage[a]       + w.y * state.snow_coverage[b]       + w.z * state.snow_coverage[c],
+            w.x * state.surface_temperature[a] + w.y * state.surface_temperature[b] + w.z * state.surface_temperature[c],
+            position,
+            view_direction
+        );
+    }
+
+    // ATMOSPHERE: only the globe is viewed through the atmosphere, as in GlobeProjectionView.js
+    if (camera.is_globe) {
+        // NOTE: orthographic view rays start from a plane that's well outside the atmosphere
+        const float r = state.radius;
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; x += SIMD_LANE_COUNT) {
+                vec3v view_origins;
+                vec3v backgrounds;
+                for (int k = 0; k < SIMD_LANE_COUNT; ++k) {
+                    // NOTE: lanes past the edge of the image repeat the last pixel, see "libacademics.cpp"
+                    int xk = std::min(x + k, width - 1);
+                    float sx =  (xk + 0.5f - 0.5f*width)         / camera.pixels_per_radius;
+                    float sy = -(y  + 0.5f - 0.5f*camera.height) / camera.pixels_per_radius;
+                    vec3 view_origin = (camera.right * sx + camera.up * sy + camera.toward * 4.f) * r;
+                    const vec3& background = rgb_intensities[(y - y0) * width + xk];
+                    view_origins.x[k] = view_origin.x;  backgrounds.x[k] = background.x;
+                    view_origins.y[k] = view_origin.y;  backgrounds.y[k] = background.y;
+                    view_origins.z[k] = view_origin.z;  backgrounds.z[k] = background.z;
+                }
+                vec3v scattered = get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+                    view_origins, vec3v(-camera.toward),
+                    vec3(0.f), r,
+                    light_directions, light_rgb_intensities, light_count,
+                    backgrounds,
+                    state.atmosphere_scale_height,
+                    SURFACE_AIR_RAYLEIGH_SCATTERING_COEFFICIENTS,
+                    SURFACE_AIR_MIE_SCATTERING_COEFFICIENTS,
+                    SURFACE_AIR_ABSORPTION_COEFFICIENTS
+                );
+                for (int k = 0; k < SIMD_LANE_COUNT && x + k < width; ++k) {
+                    rgb_intensities[(y - y0) * width + x + k] = vec3(scattered.x[k], scattered.y[k], scattered.z[k]);
+                }
+            }
+        }
+    }
+
+    // TONE MAPPING: as in "tone_mapping.glsl.c"
+    for (int i = 0; i < pixel_count; ++i) {
+        vec3 signal = clamp(
+            get_rgb_signal_of_rgb_intensity(
+                get_ldr_rgb_intensity_of_hdr_rgb_intensity(max(rgb_intensities[i], 0.f), options.exposure_intensity)),
+            0.f, 1.f);
+        std::size_t j = 3 * (std::size_t(y0) * width + i);
+        rgb[j+0] = uint8_t(255.f * signal.x + 0.5f);
+        rgb[j+1] = uint8_t(255.f * signal.y + 0.5f);
+        rgb[j+2] = uint8_t(255.f * signal.z + 0.5f);
+    }
+}
+
+static std::vector<uint8_t> render(const RenderState& state, const Options& options) {
+    Camera camera(options);
+    std::vector<Triangle> triangles = get_triangles(state, camera);
+
+    // triangles are binned by the bands of rows they overlap, so each thread only visits its own
+    int band_count = (camera.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    std::vector<std::vector<int>> band_triangles(band_count);
+    for (std::size_t t = 0; t < triangles.size(); ++t) {
+        const Triangle& triangle = triangles[t];
+        float min_y = std::min(triangle.screen[0].y, std::min(triangle.screen[1].y, triangle.screen[2].y));
+        float max_y = std::max(triangle.screen[0].y, std::max(triangle.screen[1].y, triangle.screen[2].y));
+        int first = std::max(0,            int(std::floor(min_y)) / BAND_HEIGHT);
+        int last  = std::min(band_count-1, int(std::ceil (max_y)) / BAND_HEIGHT);
+        for (int band = first; band <= last; ++band) {
+            band_triangles[band].push_back(int(t));
+        }
+    }
+
+    std::vector<uint8_t> rgb(3 * std::size_t(camera.width) * camera.height);
+    std::atomic<int> next_band(0);
+    auto work = [&]() {
+        for (int band = next_band++; band < band_count; band = next_band++) {
+            render_band(state, camera, options, triangles, band_triangles[band],
+                band * BAND_HEIGHT, std::min(camera.height, (band+1) * BAND_HEIGHT), rgb);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < options.thread_count; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return rgb;
+}
+
+static std::string get_output_filename(const std::string& input_filename, const std::string& output_directory) {
+    std::size_t slash = input_filename.find_last_of('/');
+    std::size_t dot   = input_filename.find_last_of('.');
+    std::size_t stem_start = slash == std::string::npos? 0 : slash + 1;
+    std::size_t stem_stop  = dot == std::string::npos || dot < stem_start? input_filename.size() : dot;
+    std::string directory  =
+        !output_directory.empty()? output_directory + "/" : input_filename.substr(0, stem_start);
+    return directory + input_filename.substr(stem_start, stem_stop - stem_start) + ".png";
+}
+
+static int print_usage(const char* program) {
+    std::fprintf(stderr,
+        "usage: %s [--projection globe|equirectangular] [--width pixels] [--height pixels]\n"
+        "          [--longitude degrees] [--latitude degrees] [--exposure-intensity W/m^2]\n"
+        "          [--threads count] [--output-directory path] <file>...\n"
+        "renders files written by JsonSerializer.render_state() to png\n", program);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if      (arg == "--projection"         && has_value) {
+            std::string projection = argv[++i];
+            if (projection != "globe" && projection != "equirectangular") { return print_usage(argv[0]); }
+            options.is_globe = projection == "globe";
+        }
+        else if (arg == "--width"              && has_value) { options.width              = std::atoi(argv[++i]); }
+        else if (arg == "--height"             && has_value) { options.height             = std::atoi(argv[++i]); }
+        else if (arg == "--longitude"          && has_value) { options.longitude          = float(std::atof(argv[++i])); }
+        else if (arg == "--latitude"           && has_value) { options.latitude           = float(std::atof(argv[++i])); }
+        else if (arg == "--exposure-intensity" && has_value) { options.exposure_intensity = float(std::atof(argv[++i])); }
+        else if (arg == "--threads"            && has_value) { options.thread_count       = std::atoi(argv[++i]); }
+        else if (arg == "--output-directory"   && has_value) { options.output_directory   = argv[++i]; }
+        else if (arg.compare(0, 2, "--") == 0)               { return print_usage(argv[0]); }
+        else                                                 { filenames.push_back(arg); }
+    }
+    if (options.height <= 0) {
+        options.height = options.is_globe? options.width : options.width / 2;
+    }
+    if (options.thread_count <= 0) {
+        options.thread_count = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    if (filenames.empty() || options.width <= 0 || options.height <= 0 || options.exposure_intensity <= 0.f) {
+        return print_usage(argv[0]);
+    }
+
+    int failure_count = 0;
+    for (const std::string& filename : filenames) {
+        std::string output_filename = get_output_filename(filename, options.output_directory);
+        try {
+            RenderState state = load_render_state(filename);
+            std::vector<uint8_t> rgb = render(state, options);
+            if (!png::write_rgb(output_filename, options.width, options.height, rgb)) {
+                throw std::runtime_error("could not write " + output_filename);
+            }
+            std::printf("%s -> %s\n", filename.c_str(), output_filename.c_str());
+        } catch (const std::exception& error) {
+            ++failure_count;
+            std::fprintf(stderr, "%s: %s\n", filename.c_str(), error.what());
+        }
+    }
+    return failure_count > 0? 1 : 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// "simd.hpp" provides "floatv", a float type that stores one value for each lane of the widest
+//   vector register the compiler is allowed to use: 16 lanes for AVX-512, 8 for AVX2, and 4 for SSE or NEON.
+// It lets the academics layer process several rays at once in "structure of arrays" form.
+// Arithmetic and comparison operators come from the vector extensions of gcc and clang,
+//   so only builtins that lack an operator are defined here.
+// Comparisons return "intv" masks, where each lane is either 0 (false) or -1 (true).
+// Branches must be replaced with "select()", since lanes may disagree on which path to take.
+// The instruction set is chosen at compile time, e.g. with "-march=native", or "-msimd128" for WebAssembly.
+// NOTE: only freestanding headers are included, so that WebAssembly builds do not need a C library.
+
+#include <stdint.h>
+
+#if defined(__AVX512F__) || defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace simd {
+
+#if defined(__AVX512F__)
+#define SIMD_LANE_COUNT 16
+#elif defined(__AVX__)
+#define SIMD_LANE_COUNT 8
+#else
+#define SIMD_LANE_COUNT 4
+#endif
+
+typedef float   floatv __attribute__((vector_size(4*SIMD_LANE_COUNT)));
+typedef int32_t intv   __attribute__((vector_size(4*SIMD_LANE_COUNT)));
+
+inline floatv broadcast(float a)                          { return floatv{} + a; }
+inline floatv select(intv mask, floatv a, floatv b)       { return mask? a : b; }
+inline bool   any (intv mask)                             { for (int i=0; i<SIMD_LANE_COUNT; ++i) { if ( mask[i]) { return true;  } } return false; }
+inline bool   all (intv mask)                             { for (int i=0; i<SIMD_LANE_COUNT; ++i) { if (!mask[i]) { return false; } } return true;  }
+
+inline floatv min  (floatv a, floatv b)                   { return b < a? b : a; }
+inline floatv max  (floatv a, floatv b)                   { return a < b? b : a; }
+inline floatv abs  (floatv a)                             { return a < 0.f? -a : a; }
+inline floatv sign (floatv a)                             { return select(0.f < a, broadcast(1.f), select(a < 0.f, broadcast(-1.f), broadcast(0.f))); }
+inline floatv floor(floatv a) {
+    floatv t = __builtin_convertvector(__builtin_convertvector(a, intv), floatv);
+    return t > a? t - 1.f : t;
+}
+
+inline floatv ceil (floatv a)                             { return -floor(-a); }
+
+inline floatv sqrt (floatv a) {
+#if defined(__AVX512F__)
+    return (floatv)_mm512_sqrt_ps((__m512)a);
+#elif defined(__AVX__)
+    return (floatv)_mm256_sqrt_ps((__m256)a);
+#elif defined(__SSE2__)
+    return (floatv)_mm_sqrt_ps((__m128)a);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return (floatv)vsqrtq_f32((float32x4_t)a);
+#elif defined(__wasm_simd128__)
+    return (floatv)wasm_f32x4_sqrt((v128_t)a);
+#else
+    for (int i=0; i<SIMD_LANE_COUNT; ++i) { a[i] = __builtin_sqrtf(a[i]); }
+    return a;
+#endif
+}
+
+// NOTE: there is no vector instruction for exp, so we use the polynomial approximation from the Cephes library.
+//   It is accurate to within a few ulp across the range of floats, which is better than most gpus.
+inline floatv exp  (floatv x) {
+    x = min(max(x, broadcast(-88.3762626647949f)), broadcast(88.3762626647950f));
+    floatv n = floor(x * 1.44269504088896341f + 0.5f);
+    x -= n * 0.693359375f;
+    x -= n * -2.12194440e-4f;
+    floatv y = broadcast(1.9875691500e-4f);
+    y = y * x + 1.3981999507e-3f;
+    y = y * x + 8.3334519073e-3f;
+    y = y * x + 4.1665795894e-2f;
+    y = y * x + 1.6666665459e-1f;
+    y = y * x + 5.0000001201e-1f;
+    y = y * x * x + x + 1.f;
+    intv e = (__builtin_convertvector(n, intv) + 127) << 23;
+    return y * (floatv)e;
+}
+
+}
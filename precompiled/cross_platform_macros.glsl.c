@@ -7,6 +7,7 @@
 #define CONST(T) const T
 #define VAR(T) T
 #define FUNC(T) T
+#define ARRAY(T, N) T[N]
 #endif
 
 #ifdef CPP
@@ -15,7 +16,10 @@
 #define OUT(T) T&
 #define CONST(T) const T
 #define VAR(T) T
-#define FUNC(T) T
+// NOTE: functions are defined in headers, so they must be inline to be included by more than one translation unit
+#define FUNC(T) inline T
+// NOTE: arrays decay to pointers, since C++ does not allow the array qualifier to precede the parameter name
+#define ARRAY(T, N) T*
 #endif
 
 #ifdef JS
@@ -25,6 +29,7 @@
 #define CONST(T) const
 #define VAR(T) let
 #define FUNC(T) function
+#define ARRAY(T, N)
 #define vec2 glm.vec2
 #define vec3 glm.vec3
 #define vec4 glm.vec4
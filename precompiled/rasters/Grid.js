@@ -3,10 +3,14 @@
 // It is the lowest level data structure in the app - all raster operations under rasters/ depend on it
 
 function Grid(parameters, options){
-    options = options || {};
-    var neighbor_lookup, face, points, vertex;
+    options = options || Grid.default_options;
 
     this.parameters = parameters;
+
+    // if "is_shared" is set, rasters of this grid are allocated in shared memory, see "RasterArrayBuffer"
+    this.is_shared = !!options.is_shared;
+    // unless "is_cached" is false, what is derived from the mesh is shared with other grids of the same mesh, see "Grid.cache"
+    var is_cached = options.is_cached !== false;
     
     // Precompute map between buffer array ids and grid cell ids
     // This helps with mapping cells within the model to buffer arrays in three.js
@@ -23,7 +27,11 @@ function Grid(parameters, options){
 		};
 	}
 
-    var vertex_ids = new Uint16Array(this.vertices.length);
+    // Cell ids are stored in Uint16Arrays when they fit, so small grids keep their compact layout,
+    // otherwise they are stored in Uint32Arrays. See "Grid.prototype.createIdRaster".
+    this.IdArray = vertices.length > Grid.MAX_UINT16_VERTEX_COUNT? Uint32Array : Uint16Array;
+
+    var vertex_ids = new this.IdArray(this.vertices.length);
     for (var i=0, li=vertex_ids.length; i<li; ++i) {
         vertex_ids[i] = i;
     }
@@ -32,7 +40,7 @@ function Grid(parameters, options){
 
     this.pos = VectorRaster.FromVectors(this.vertices, this);
 
-    var buffer_array_to_cell = new Uint16Array(faces.length * 3);
+    var buffer_array_to_cell = new this.IdArray(faces.length * 3);
     for (var i=0, i3=0, li = faces.length; i<li; i++, i3+=3) {
         var face = faces[i];
         buffer_array_to_cell[i3+0] = face.a;
@@ -41,6 +49,118 @@ function Grid(parameters, options){
     };
     this.buffer_array_to_cell = buffer_array_to_cell;
 
+    // Everything below is derived from the mesh alone, and is expensive to build for large grids,
+    //   so it is built once per mesh and cached, see "Grid.cache"
+    var cache_key = Grid.get_cache_key(faces, vertices);
+    var cached = is_cached? Grid.get_cache_entry(cache_key) : void 0;
+    if (cached === void 0) {
+        cached = Grid.build_cache_entry(faces, vertices, this.pos);
+        if (is_cached) {
+            Grid.set_cache_entry(cache_key, cached);
+        }
+    }
+    this.cache_key = cache_key;
+
+    // NOTE: cached arrays are shared between grids of the same mesh, 
+    //   but each grid gets its own views of them, since rasters keep a reference to their grid
+    // NOTE: cached arrays may be views into a larger buffer, such as those that are sent from another thread
+    var neighbor_count = new Uint8Array(cached.neighbor_count.buffer, cached.neighbor_count.byteOffset, cached.neighbor_count.length);
+    neighbor_count.grid = this;
+    this.neighbor_count = neighbor_count;
+
+    // an "arrow" in graph theory is an ordered set of vertices 
+    // it is also known as a directed edge 
+    // i.e. arrows include duplicate neighbor pairs 
+    // e.g. it includes [1,2] *and* [2,1] 
+    // an "edge" in graph theory is a unordered set of vertices 
+    // i.e. edges do not include duplicate neighbor pairs 
+    // e.g. it includes [1,2] but not [2,1] 
+    //
+    // Arrows and edges are stored as pairs of typed arrays, so that hot loops avoid a heap object per arrow.
+    // Arrows are sorted by the cell they start from, so they also form the "compressed sparse row" representation of the grid:
+    //   the arrows that start from cell i are those from "arrow_offsets[i]" up to but excluding "arrow_offsets[i+1]",
+    //   and the neighbors of cell i are the values of "arrow_to" within that range.
+    this.arrow_from = cached.arrow_from; 
+    this.arrow_to = cached.arrow_to; 
+    this.arrow_offsets = cached.arrow_offsets; 
+    this.edge_from = cached.edge_from; 
+    this.edge_to = cached.edge_to; 
+    
+    var arrow_count = cached.arrow_from.length;
+    this.pos_arrow_differential            = Grid.get_vector_view(cached.pos_arrow_differential, arrow_count);
+    this.pos_arrow_differential_normalized = Grid.get_vector_view(cached.pos_arrow_differential_normalized, arrow_count);
+    this.pos_arrow_distances = cached.pos_arrow_distances;
+    this.average_distance = Float32Dataset.average(this.pos_arrow_distances);
+    this.average_area = this.average_distance * this.average_distance;
+
+    this._voronoi = VoronoiSphere.FromCells(cached.voronoi.cells, cached.voronoi.cell_width, cached.voronoi.dimension_x, cached.voronoi.dimension_y);
+}
+
+// the number of vertices above which cell ids no longer fit in a Uint16Array
+Grid.MAX_UINT16_VERTEX_COUNT = 65536;
+
+// the options used by grids that are constructed without any,
+//   such as those of worlds that are simulated by "noncompiled/models/SimulationWorker.js"
+Grid.default_options = { is_shared: false };
+
+
+// the version of the layout of cache entries, which must change whenever "build_cache_entry" changes what it returns
+Grid.CACHE_VERSION = 1;
+
+// "cache" maps the key of each mesh that a grid was built for onto the structures that were derived from it, see "build_cache_entry"
+// Entries are plain objects of typed arrays, so they can be stored outside of memory and added back, see "GridCache.js"
+// Entries are kept in order of when they were last used, and only the most recent are kept, see "MAX_CACHE_ENTRY_COUNT".
+// Grids keep the arrays of their entry, so an entry that is dropped only costs the time to build it again.
+Grid.cache = new Map();
+
+// the number of entries that "Grid.cache" keeps, which covers a world along with the grids of a few resolutions it was viewed at
+Grid.MAX_CACHE_ENTRY_COUNT = 4;
+
+// "get_cache_entry" returns the entry of "Grid.cache" for "key", if any, and marks it as the most recently used
+Grid.get_cache_entry = function(key) {
+    var entry = Grid.cache.get(key);
+    if (entry !== void 0) {
+        Grid.cache.delete(key);
+        Grid.cache.set(key, entry);
+    }
+    return entry;
+}
+// "set_cache_entry" adds "entry" to "Grid.cache" as its most recently used, 
+//   then drops the least recently used entries until there are no more than "MAX_CACHE_ENTRY_COUNT"
+// NOTE: maps iterate in the order that keys were added, so the first key is always the least recently used
+Grid.set_cache_entry = function(key, entry) {
+    Grid.cache.delete(key);
+    Grid.cache.set(key, entry);
+    while (Grid.cache.size > Grid.MAX_CACHE_ENTRY_COUNT) {
+        Grid.cache.delete(Grid.cache.keys().next().value);
+    }
+}
+
+// "get_cache_key" returns a string that identifies a mesh, made of its version, its size, and a hash of its faces and vertices
+Grid.get_cache_key = function(faces, vertices) {
+    var float64 = new Float64Array(1);
+    var uint32 = new Uint32Array(float64.buffer);
+    var imul = Math.imul;
+    // FNV-1a, on 32 bit words
+    var hash = 0x811c9dc5;
+    for (var i = 0, li = vertices.length; i < li; i++) {
+        var vertex = vertices[i];
+        float64[0] = vertex.x; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+        float64[0] = vertex.y; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+        float64[0] = vertex.z; hash = imul(hash ^ uint32[0], 0x01000193); hash = imul(hash ^ uint32[1], 0x01000193);
+    }
+    for (var i = 0, li = faces.length; i < li; i++) {
+        var face = faces[i];
+        hash = imul(hash ^ face.a, 0x01000193);
+        hash = imul(hash ^ face.b, 0x01000193);
+        hash = imul(hash ^ face.c, 0x01000193);
+    }
+    return `${Grid.CACHE_VERSION}:${vertices.length}:${faces.length}:${(hash >>> 0).toString(16)}`;
+}
+
+// "build_cache_entry" derives the structures of a grid from its mesh, where "pos" holds the position of each vertex
+Grid.build_cache_entry = function(faces, vertices, pos) {
+    var face;
     //Precompute neighbors for O(1) lookups
     var neighbor_lookup = vertices.map(function(vertex) { return {}});
     for(var i=0, il = faces.length; i<il; i++){
@@ -53,66 +173,102 @@ function Grid(parameters, options){
         neighbor_lookup[face.c][face.b] = face.b;
     }
     neighbor_lookup = neighbor_lookup.map(function(set) { return Object.values(set); });
-    this.neighbor_lookup = neighbor_lookup;
 
-    var neighbor_count = Uint8Raster(this);
+    var neighbor_count = new Uint8Array(vertices.length);
     for (var i = 0, li=neighbor_lookup.length; i<li; i++) { 
         neighbor_count[i] = neighbor_lookup[i].length;
     }
-    this.neighbor_count = neighbor_count;
 
-    // an "edge" in graph theory is a unordered set of vertices 
-    // i.e. this.edges does not contain duplicate neighbor pairs 
-    // e.g. it includes [1,2] but not [2,1] 
-    var edges = []; 
-    var edge_lookup = []; 
-    // an "arrow" in graph theory is an ordered set of vertices 
-    // it is also known as a directed edge 
-    // i.e. this.arrows contains duplicate neighbor pairs 
-    // e.g. it includes [1,2] *and* [2,1] 
-    var arrows = [];  
-    var arrow_lookup = []; 
+    var arrow_count = 0;
+    for (var i = 0, li=neighbor_count.length; i<li; i++) { 
+        arrow_count += neighbor_count[i];
+    }
+    var arrow_offsets = new Uint32Array(neighbor_count.length+1);
+    var arrow_from    = new Uint32Array(arrow_count);
+    var arrow_to      = new Uint32Array(arrow_count);
+    var edge_from     = new Uint32Array(arrow_count/2);
+    var edge_to       = new Uint32Array(arrow_count/2);
 
     var neighbors = []; 
     var neighbor = 0; 
+    var arrow_id = 0;
+    var edge_id = 0;
     
     //Precompute a list of neighboring vertex pairs for O(N) traversal 
     for (var i = 0, li=neighbor_lookup.length; i<li; i++) { 
+      arrow_offsets[i] = arrow_id;
       neighbors = neighbor_lookup[i]; 
       for (var j = 0, lj=neighbors.length; j<lj; j++) { 
         neighbor = neighbors[j]; 
-        arrows.push([i, neighbor]); 
-    
-        arrow_lookup[i] = arrow_lookup[i] || []; 
-        arrow_lookup[i].push(arrows.length-1); 
+        arrow_from[arrow_id] = i;
+        arrow_to[arrow_id] = neighbor;
+        arrow_id++;
     
         if (i < neighbor) { 
-          edges.push([i, neighbor]); 
-    
-          edge_lookup[i] = edge_lookup[i] || []; 
-          edge_lookup[i].push(edges.length-1); 
-    
-          edge_lookup[neighbor] = edge_lookup[neighbor] || []; 
-          edge_lookup[neighbor].push(edges.length-1); 
+          edge_from[edge_id] = i;
+          edge_to[edge_id] = neighbor;
+          edge_id++;
         } 
       } 
     } 
+    arrow_offsets[neighbor_lookup.length] = arrow_id;
 
-    this.edges = edges; 
-    this.edge_lookup = edge_lookup; 
-    this.arrows = arrows; 
-    this.arrow_lookup = arrow_lookup; 
-    
-    this.pos_arrow_differential = VectorField.arrow_differential(this.pos); 
-    this.pos_arrow_differential_normalized = VectorRaster.OfLength(arrows.length, undefined)
-    this.pos_arrow_differential_normalized = VectorField.normalize(this.pos_arrow_differential, this.pos_arrow_differential_normalized); 
-    this.pos_arrow_distances = Float32Raster.OfLength(arrows.length, undefined)
-    VectorField.magnitude(this.pos_arrow_differential, this.pos_arrow_distances);
-    this.average_distance = Float32Dataset.average(this.pos_arrow_distances);
-    this.average_area = this.average_distance * this.average_distance;
+    // NOTE: arrow differentials are found without a grid, since the grid they would belong to is still being built
+    var arrow_differential = VectorRaster.OfLength(arrow_count, undefined);
+    var x = pos.x;
+    var y = pos.y;
+    var z = pos.z;
+    for (var i = 0; i < arrow_count; i++) {
+        arrow_differential.x[i] = x[arrow_to[i]] - x[arrow_from[i]];
+        arrow_differential.y[i] = y[arrow_to[i]] - y[arrow_from[i]];
+        arrow_differential.z[i] = z[arrow_to[i]] - z[arrow_from[i]];
+    }
+    var arrow_differential_normalized = VectorRaster.OfLength(arrow_count, undefined);
+    VectorField.normalize(arrow_differential, arrow_differential_normalized);
+    var arrow_distances = Float32Raster.OfLength(arrow_count, undefined);
+    VectorField.magnitude(arrow_differential, arrow_distances);
 
     const CELLS_PER_VERTEX = 8;
-    this._voronoi = new VoronoiSphere(this.pos, Float32Dataset.min(this.pos_arrow_distances)/CELLS_PER_VERTEX, Float32Dataset.max(this.pos_arrow_distances));
+    var voronoi = new VoronoiSphere(pos, Float32Dataset.min(arrow_distances)/CELLS_PER_VERTEX, Float32Dataset.max(arrow_distances));
+
+    return {
+        version:                           Grid.CACHE_VERSION,
+        neighbor_count:                    neighbor_count,
+        arrow_offsets:                     arrow_offsets,
+        arrow_from:                        arrow_from,
+        arrow_to:                          arrow_to,
+        edge_from:                         edge_from,
+        edge_to:                           edge_to,
+        pos_arrow_differential:            arrow_differential.everything,
+        pos_arrow_differential_normalized: arrow_differential_normalized.everything,
+        pos_arrow_distances:               arrow_distances,
+        voronoi: {
+            cells:       voronoi.cells,
+            cell_width:  voronoi.cell_width,
+            dimension_x: voronoi.dimension_x,
+            dimension_y: voronoi.dimension_y,
+        },
+    };
+}
+
+// "get_vector_view" returns a vector raster of "length" whose components are views into "everything"
+Grid.get_vector_view = function(everything, length) {
+    return {
+        x: everything.subarray(0 * length, 1 * length),
+        y: everything.subarray(1 * length, 2 * length),
+        z: everything.subarray(2 * length, 3 * length),
+        everything: everything,
+        grid: undefined,
+    };
+}
+
+// "createIdRaster" returns a raster for "grid" that can store ids of cells within this grid, 
+//   such as those returned by "getNearestIds". "grid" defaults to this grid.
+Grid.prototype.createIdRaster = function(grid) {
+    grid = grid || this;
+    var result = new this.IdArray(grid.vertices.length);
+    result.grid = grid;
+    return result;
 }
 
 Grid.prototype.getNearestId = function(vertex) { 
@@ -120,10 +276,17 @@ Grid.prototype.getNearestId = function(vertex) {
 }
 
 Grid.prototype.getNearestIds = function(pos_field, result) {
-    result = result || Uint16Raster(pos_field.grid);
+    result = result || this.createIdRaster(pos_field.grid);
     return this._voronoi.getNearestIds(pos_field, result);
 }
 
+// "updateNearestIds" is equivalent to getNearestIds() of "pos_field" transformed by "matrix", 
+//   but it only looks up positions that could have changed cells since their last lookup, see "VoronoiSphere.updateNearestIds"
+Grid.prototype.updateNearestIds = function(pos_field, matrix, drift, thresholds, result) {
+    result = result || this.createIdRaster(pos_field.grid);
+    return this._voronoi.updateNearestIds(pos_field, matrix, drift, thresholds, result);
+}
+
 Grid.prototype.getNeighborIds = function(id) {
-    return this.neighbor_lookup[id];
+    return this.arrow_to.subarray(this.arrow_offsets[id], this.arrow_offsets[id+1]);
 }
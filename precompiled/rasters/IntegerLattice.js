@@ -1,23 +1,24 @@
 //Data structure mapping 3d coordinates onto a lattice for fast lookups 
 // lattice assumes that max distance to nearest neighbors will never exceed farthest_nearest_neighbor_distance
 function IntegerLattice(points, getDistance, farthest_nearest_neighbor_distance){
+    // NOTE: bounds are found using reduce(), since Math.max.apply() overflows the stack for large grids
 
     var lattice = [];
     var N = 3;
     var cell_width = 2*farthest_nearest_neighbor_distance;
 
-    var max_x = Math.max.apply(null, points.map(point => point.x));
-    var min_x = Math.min.apply(null, points.map(point => point.x));
+    var max_x = points.reduce((a, point) => Math.max(a, point.x), -Infinity);
+    var min_x = points.reduce((a, point) => Math.min(a, point.x), Infinity);
     var range_x = max_x - min_x;
     var cell_num_x = range_x / cell_width;
 
-    var max_y = Math.max.apply(null, points.map(point => point.y));
-    var min_y = Math.min.apply(null, points.map(point => point.y));
+    var max_y = points.reduce((a, point) => Math.max(a, point.y), -Infinity);
+    var min_y = points.reduce((a, point) => Math.min(a, point.y), Infinity);
     var range_y = max_y - min_y;
     var cell_num_y = range_y / cell_width;
 
-    var max_z = Math.max.apply(null, points.map(point => point.z));
-    var min_z = Math.min.apply(null, points.map(point => point.z));
+    var max_z = points.reduce((a, point) => Math.max(a, point.z), -Infinity);
+    var min_z = points.reduce((a, point) => Math.min(a, point.z), Infinity);
     var range_z = max_z - min_z;
     var cell_num_z = range_z / cell_width;
 
@@ -225,4 +225,16 @@ Matrix3x3.hadamard_matrix = function(A, B, result) {
   C[8] = A[8]*B[8];
   
   return C;
-}
\ No newline at end of file
+}
+// "get_max_displacement" returns an upper bound on the distance between A*v and B*v for any unit vector v,
+//   which is the Frobenius norm of their difference, since that is never less than its largest singular value
+Matrix3x3.get_max_displacement = function(A, B) {
+  ASSERT_IS_3X3_MATRIX(A)
+  ASSERT_IS_3X3_MATRIX(B)
+
+  var sum = 0;
+  for (var i = 0; i < 9; i++) {
+    sum += (A[i]-B[i])*(A[i]-B[i]);
+  }
+  return Math.sqrt(sum);
+}
@@ -0,0 +1,126 @@
+// RasterPool hands out temporary rasters the same way as RasterStackBuffer,
+//   but keeps a free list of rasters for each grid and each type of raster, rather than carving them out of a single buffer.
+// Rasters are acquired within a scope that is opened with "allocate" and closed with "deallocate",
+//   and every raster acquired within a scope is returned to its free list when the scope closes.
+// Rasters are created with the regular constructors, so they can be used by a RasterWorkerPool if their grid is shared,
+//   and the pool grows to fit whatever is needed, so it never overflows.
+// Like RasterStackBuffer, rasters are not cleared: they contain whatever was written to them by their last user.
+//
+// Raster functions use "RasterPool.scratchpad" for implicit temporaries, such as "scratch" arguments that the caller omitted,
+//   so omitting them no longer creates a new raster on every call:
+//
+//   var pool = RasterPool.scratchpad;
+//   pool.allocate('ScalarField.diffusion_by_constant');
+//   scratch = scratch || pool.getFloat32Raster(grid);
+//   ...
+//   pool.deallocate('ScalarField.diffusion_by_constant');
+//
+// Rasters that are returned to the caller must never come from the pool.
+function RasterPool() {
+    this.free_lists = new WeakMap();
+    this.acquired = [];
+    this.acquired_lists = [];
+    this.stack = [];
+    this.method_names = [];
+    // the number of rasters that were acquired, and the number that had to be created, since these were last reset by the Profiler
+    this.acquire_count = 0;
+    this.create_count = 0;
+}
+// open a scope for a method
+RasterPool.prototype.allocate = function(name) {
+    this.stack.push(this.acquired.length);
+    this.method_names.push(name);
+}
+// close the scope of a method, returning every raster acquired within it to the pool
+RasterPool.prototype.deallocate = function(name) {
+    var start = this.stack.pop();
+    var method = this.method_names.pop();
+    if (method !== name) {
+        throw `memory was deallocated for the method, ${name} but memory was not allocated. This indicates improper memory management.`;
+    }
+    var acquired = this.acquired;
+    var acquired_lists = this.acquired_lists;
+    for (var i = acquired.length - 1; i >= start; i--) {
+        acquired_lists[i].push(acquired[i]);
+    }
+    acquired.length = start;
+    acquired_lists.length = start;
+}
+// "get_free_list" returns the list of unused rasters of "grid" that were created by "constructor"
+RasterPool.prototype.get_free_list = function(grid, constructor) {
+    var free_lists = this.free_lists.get(grid);
+    if (free_lists === void 0) {
+        free_lists = new Map();
+        this.free_lists.set(grid, free_lists);
+    }
+    var free_list = free_lists.get(constructor);
+    if (free_list === void 0) {
+        free_list = [];
+        free_lists.set(constructor, free_list);
+    }
+    return free_list;
+}
+// "acquire" returns an unused raster of "grid" that was created by "constructor", creating one only if none are left
+RasterPool.prototype.acquire = function(grid, constructor) {
+    if (this.stack.length === 0) {
+        throw `a raster was requested from the pool outside any method. Call "allocate" first.`;
+    }
+    var free_list = this.get_free_list(grid, constructor);
+    this.acquire_count++;
+    if (free_list.length === 0) {
+        this.create_count++;
+    }
+    var raster = free_list.length > 0? free_list.pop() : constructor(grid);
+    this.acquired.push(raster);
+    this.acquired_lists.push(free_list);
+    return raster;
+}
+RasterPool.prototype.getFloat32Raster = function(grid) {
+    return this.acquire(grid, Float32Raster);
+};
+RasterPool.prototype.getUint8Raster = function(grid) {
+    return this.acquire(grid, Uint8Raster);
+};
+RasterPool.prototype.getUint16Raster = function(grid) {
+    return this.acquire(grid, Uint16Raster);
+};
+RasterPool.prototype.getUint32Raster = function(grid) {
+    return this.acquire(grid, Uint32Raster);
+};
+// "getBitset" returns a bitset for "grid", see "BitsetMorphology"
+RasterPool.prototype.getBitset = function(grid) {
+    return this.acquire(grid, BitsetMorphology.Bitset);
+};
+RasterPool.prototype.getVectorRaster = function(grid) {
+    return this.acquire(grid, VectorRaster);
+};
+
+RasterPool.scratchpad = new RasterPool();
+
+// If "is_debugging" is set, every raster that is created outside a pool is counted by the call site that created it,
+//   so that call sites which create rasters on every step of a simulation can be found. See "Simulation.update".
+// "allocations" records the number of rasters and bytes created at each call site since the last "reset_allocations",
+//   where each call site is named by the function that created the raster, followed by the function that called it.
+RasterPool.is_debugging = false;
+RasterPool.allocations = {};
+RasterPool.record_allocation = function(byte_length) {
+    var frames = new Error().stack.split('\n').slice(1);
+    // skip the frames of the constructors themselves
+    var i = 0;
+    while (i < frames.length - 1 && /RasterArrayBuffer|Raster \(|Raster\.OfLength|Raster\.FromExample|Bitset \(|RasterPool/.test(frames[i])) {
+        i++;
+    }
+    var site = frames.slice(i, i+2).map(frame => frame.trim().replace(/^at /, '')).join(' < ');
+    if (RasterPool.allocations[site] === void 0) {
+        RasterPool.allocations[site] = { site: site, count: 0, bytes: 0 };
+    }
+    RasterPool.allocations[site].count += 1;
+    RasterPool.allocations[site].bytes += byte_length;
+}
+// "get_allocations" returns the entries of "allocations", largest first
+RasterPool.get_allocations = function() {
+    return Object.values(RasterPool.allocations).sort((a,b) => b.bytes - a.bytes);
+}
+RasterPool.reset_allocations = function() {
+    RasterPool.allocations = {};
+}
@@ -5,19 +5,39 @@
 // You can request new rasters without fear of performance penalties or referencing issues
 // Additionally, you can push and pop method names to the stack so the stack knows when to deallocate rasters
 // Think of it as a dedicated stack based memory for Javascript TypedArrays
-function RasterStackBuffer(byte_length){
-    this.buffer = new ArrayBuffer(byte_length);
+// If "is_shared" is set, memory is allocated as a SharedArrayBuffer, so its rasters can be used by a RasterWorkerPool
+// "peak_pos" and "allocation_count" are the highest position, and the number of methods allocated, since they were last reset,
+//   which are reported by the Profiler
+function RasterStackBuffer(byte_length, is_shared){
+    this.buffer = is_shared? new SharedArrayBuffer(byte_length) : new ArrayBuffer(byte_length);
     this.pos = 0;
     this.stack = [];
     this.method_names = [];
+    this.peak_pos = 0;
+    this.allocation_count = 0;
+}
+// "FromArrayBuffer" creates a RasterStackBuffer over memory that is owned by something else,
+//   such as the memory of a WebAssembly module, starting at "byte_offset"
+RasterStackBuffer.FromArrayBuffer = function(buffer, byte_offset) {
+    var result = Object.create(RasterStackBuffer.prototype);
+    result.buffer = buffer;
+    result.pos = 4*Math.ceil((byte_offset || 0)/4);
+    result.stack = [];
+    result.method_names = [];
+    result.peak_pos = result.pos;
+    result.allocation_count = 0;
+    return result;
 }
 // allocate memory to a method
 RasterStackBuffer.prototype.allocate = function(name) {
     this.stack.push(this.pos);
     this.method_names.push(name);
+    this.allocation_count++;
 }
 // deallocate memory reserved for a method
+// NOTE: the position only ever falls here, so this is where its peak is found
 RasterStackBuffer.prototype.deallocate = function(name) {
+    this.peak_pos = Math.max(this.peak_pos, this.pos);
     this.pos = this.stack.pop();
     var method = this.method_names.pop();
     if (method !== name) {
@@ -60,6 +80,30 @@ RasterStackBuffer.prototype.getUint16Raster = function(grid) {
     this.pos = 4*Math.ceil(new_pos/4);
     return raster;
 };
+RasterStackBuffer.prototype.getUint32Raster = function(grid) {
+    var length = grid.vertices.length;
+    var new_pos = this.pos + length * Uint32Array.BYTES_PER_ELEMENT;
+    if (new_pos >= this.buffer.length) {
+        throw `The raster stack buffer is overflowing! Either check for memory leaks, or initialize with more memory`;
+    }
+    var raster = new Uint32Array(this.buffer, this.pos, length);
+    raster.grid = grid;
+    // round to nearest 4 bytes
+    this.pos = 4*Math.ceil(new_pos/4);
+    return raster;
+};
+// "getBitset" returns a bitset for "grid", see "BitsetMorphology"
+RasterStackBuffer.prototype.getBitset = function(grid) {
+    var length = BitsetMorphology.get_word_count(grid.vertices.length);
+    var new_pos = this.pos + length * Uint32Array.BYTES_PER_ELEMENT;
+    if (new_pos >= this.buffer.length) {
+        throw `The raster stack buffer is overflowing! Either check for memory leaks, or initialize with more memory`;
+    }
+    var raster = new Uint32Array(this.buffer, this.pos, length);
+    raster.grid = grid;
+    this.pos = new_pos;
+    return raster;
+};
 RasterStackBuffer.prototype.getVectorRaster = function(grid) {
     var length = grid.vertices.length;
     var byte_length_per_index = length * 4;
@@ -25,7 +25,7 @@
 
 #ifndef IS_PROD
 #define ASSERT_IS_ANY_ARRAY(INPUT) \
-    if (!(INPUT instanceof Float32Array || INPUT instanceof Uint16Array || INPUT instanceof Uint8Array)) { throw #INPUT + ' is not a typed array'; }
+    if (!(INPUT instanceof Float32Array || INPUT instanceof Uint32Array || INPUT instanceof Uint16Array || INPUT instanceof Uint8Array)) { throw #INPUT + ' is not a typed array'; }
 #else
 #define ASSERT_IS_ANY_ARRAY(INPUT)
 #endif
@@ -63,10 +63,14 @@
 #include "precompiled/rasters/Matrix4x4.js"
 #include "precompiled/rasters/Vector.js"
 
+#include "precompiled/rasters/parallel/RasterArrayBuffer.js"
+
 #include "precompiled/rasters/rasters/Float32Raster.js"
 #include "precompiled/rasters/rasters/Uint16Raster.js"
+#include "precompiled/rasters/rasters/Uint32Raster.js"
 #include "precompiled/rasters/rasters/Uint8Raster.js"
 #include "precompiled/rasters/rasters/VectorRaster.js"
+#include "precompiled/rasters/rasters/QuantizedRaster.js"
 
 #include "precompiled/rasters/datasets/Float32Dataset.js"
 #include "precompiled/rasters/datasets/Uint16Dataset.js"
@@ -84,12 +88,20 @@
 #include "precompiled/rasters/raster-graphics/VectorRasterGraphics.js"
 
 #include "precompiled/rasters/interpolation/Float32RasterInterpolation.js"
+#include "precompiled/rasters/expressions/Float32RasterExpression.js"
 #include "precompiled/rasters/trigonometry/Float32RasterTrigonometry.js"
 #include "precompiled/rasters/scalar-transport/ScalarTransport.js"
 #include "precompiled/rasters/image-analysis/VectorImageAnalysis.js"
 #include "precompiled/rasters/morphology/BinaryMorphology.js"
+#include "precompiled/rasters/morphology/BitsetMorphology.js"
+
+#include "precompiled/rasters/parallel/RasterKernels.js"
+#include "precompiled/rasters/parallel/RasterWasmKernels.js"
+#include "precompiled/rasters/parallel/RasterGpuKernels.js"
+#include "precompiled/rasters/parallel/RasterWorkerPool.js"
 
 #include "precompiled/rasters/IntegerLattice.js"
 #include "precompiled/rasters/VoronoiSphere.js"
 #include "precompiled/rasters/Grid.js"
 #include "precompiled/rasters/RasterStackBuffer.js"
+#include "precompiled/rasters/RasterPool.js"
@@ -19,6 +19,14 @@ var VoronoiSphere = (function() {
     var OCTAHEDRON_SIDE_X = VectorRaster.ToArray(OCTAHEDRON_SIDE_X);
     var OCTAHEDRON_SIDE_Y = VectorRaster.ToArray(OCTAHEDRON_SIDE_Y);
     var OCTAHEDRON_SIDE_Z = VectorRaster.ToArray(OCTAHEDRON_SIDE_Z);
+    // the axes of each side, indexed by side id, in "structure of arrays" form,
+    //   so that hot loops index typed arrays rather than look up properties of objects
+    var SIDE_X_X = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.x));
+    var SIDE_X_Y = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.y));
+    var SIDE_X_Z = new Float64Array(OCTAHEDRON_SIDE_X.map(side => side.z));
+    var SIDE_Y_X = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.x));
+    var SIDE_Y_Y = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.y));
+    var SIDE_Y_Z = new Float64Array(OCTAHEDRON_SIDE_Y.map(side => side.z));
 
 
     var cell_count = function (dimensions_x, dimensions_y){
@@ -35,12 +43,15 @@ var VoronoiSphere = (function() {
     function VoronoiSphere(pos, cell_width, farthest_distance){
         var dimension_x = Math.ceil(2./cell_width)+1;
         var dimension_y = Math.ceil(2./cell_width)+1;
-        var cells = new Uint16Array(cell_count(dimension_x, dimension_y));
+        // NOTE: cells store ids of vertices, so they need the same id array type as "Grid.IdArray"
+        var IdArray = pos.x.length > Grid.MAX_UINT16_VERTEX_COUNT? Uint32Array : Uint16Array;
+        var cells = new IdArray(cell_count(dimension_x, dimension_y));
 
         this.cell_width = cell_width;
         this.dimension_x = dimension_x;
         this.dimension_y = dimension_y;
         this.cells = cells;
+        this.IdArray = IdArray;
 
         //Feed locations into an integer lattice for fast lookups
         var points = [];
@@ -102,52 +113,152 @@ var VoronoiSphere = (function() {
             }
         }
     }
+    // "FromCells" returns a VoronoiSphere whose cells were populated earlier, such as those cached by "Grid.cache",
+    //   since populating them is the most expensive part of building a grid
+    VoronoiSphere.FromCells = function(cells, cell_width, dimension_x, dimension_y) {
+        var result = Object.create(VoronoiSphere.prototype);
+        result.cell_width = cell_width;
+        result.dimension_x = dimension_x;
+        result.dimension_y = dimension_y;
+        result.cells = cells;
+        result.IdArray = cells.constructor;
+        return result;
+    }
+    // "get_nearest_cell_ids" is the first pass of "getNearestIds": 
+    //   for each position in "args.x", "args.y", and "args.z", it writes the index of the cell that it maps to within the table
+    // See "nearest_cell_ids" in "precompiled/cpp/raster_kernels.cpp" for its WebAssembly counterpart.
+    var get_nearest_cell_ids = function(args, start, end) {
+        var x = args.x, y = args.y, z = args.z, result = args.result;
+        var cell_width = args.cell_width;
+        var side_stride = args.dimension_x * args.dimension_y;
+        var row_stride = args.dimension_y;
+        var floor = Math.floor;
+        var xi = 0., yi = 0., zi = 0.;
+        var side_id = 0;
+        for (var i = start; i < end; i++) {
+            xi = x[i];
+            yi = y[i];
+            zi = z[i];
+            side_id = 
+              (( xi > 0)     ) +
+              (( yi > 0) << 1) +
+              (( zi > 0) << 2) ; 
+            result[i] = side_id * side_stride
+                + floor((SIDE_X_X[side_id] * xi + SIDE_X_Y[side_id] * yi + SIDE_X_Z[side_id] * zi + 1.) / cell_width) * row_stride
+                + floor((SIDE_Y_X[side_id] * xi + SIDE_Y_Y[side_id] * yi + SIDE_Y_Z[side_id] * zi + 1.) / cell_width);
+        }
+    }
+    // "getNearestIds" runs in two passes over the whole batch of positions: 
+    //   the first finds the index within the table of each position, 
+    //   and the second reads the table at those indices.
+    // Keeping arithmetic and table reads in separate loops keeps the first loop free of memory stalls,
+    //   and lets it run as WebAssembly SIMD when the positions lie within module memory, see "RasterWasmKernels".
+    // NOTE: sorting reads by index was also tried, but sorting costs more than the cache misses it saves
     VoronoiSphere.prototype.getNearestIds = function(pos_field, result) {
-        result = result || new Uint16Array(pos_field.x.length);
+        var length = pos_field.x.length;
+        result = result || new this.IdArray(length);
+
+        var scratchpad = RasterStackBuffer.scratchpad;
+        scratchpad.allocate('getNearestIds');
+
+        var cell_ids = pos_field.grid !== void 0? scratchpad.getUint32Raster(pos_field.grid) : new Uint32Array(length);
+        var args = {
+            x: pos_field.x, 
+            y: pos_field.y, 
+            z: pos_field.z, 
+            cell_width: this.cell_width, 
+            dimension_x: this.dimension_x, 
+            dimension_y: this.dimension_y, 
+            result: cell_ids,
+        };
+        if (RasterWasmKernels.can_run('nearest_cell_ids', args)) {
+            RasterWasmKernels.run('nearest_cell_ids', args, 0, length);
+        } else {
+            get_nearest_cell_ids(args, 0, length);
+        }
+
+        var cells = this.cells;
+        for (var i = 0; i < length; i++) {
+            result[i] = cells[cell_ids[i]];
+        }
+
+        scratchpad.deallocate('getNearestIds');
+        return result;
+    }
+    // "updateNearestIds" finds the nearest ids of "pos_field" after it is transformed by "matrix", like getNearestIds(),
+    //   but only for those positions whose nearest id could have changed since they were last found.
+    // "drift" is an upper bound on how far any position could have moved in total since the first call, see "Matrix3x3.get_max_displacement".
+    // "thresholds" holds, for each position, the drift at which it must next be looked up,
+    //   which is the drift at its last lookup, plus its distance to its nearest boundary between cells.
+    // Within that distance, a position stays in the same cell, and so maps to the same id,
+    //   so results match those of getNearestIds() while only positions near boundaries are looked up.
+    // "thresholds" should start at -Infinity, so that every position is looked up on the first call.
+    VoronoiSphere.prototype.updateNearestIds = function(pos_field, matrix, drift, thresholds, result) {
+        result = result || new this.IdArray(pos_field.x.length);
 
         var cell_width = this.cell_width;
         var dimension_x = this.dimension_x;
         var dimension_y = this.dimension_y;
         var cells = this.cells;
 
-        var side_x = OCTAHEDRON_SIDE_X[0];
-        var side_y = OCTAHEDRON_SIDE_Y[0];
+        var xx = matrix[0];    var xy = matrix[3];    var xz = matrix[6];
+        var yx = matrix[1];    var yy = matrix[4];    var yz = matrix[7];
+        var zx = matrix[2];    var zy = matrix[5];    var zz = matrix[8];
+
+        var pos_x = pos_field.x;
+        var pos_y = pos_field.y;
+        var pos_z = pos_field.z;
 
-        var projection_x = 0;
-        var projection_y = 0;
+        var xi = 0;
+        var yi = 0;
+        var zi = 0;
 
+        var grid_x = 0;
+        var grid_y = 0;
         var grid_pos_x = 0;
         var grid_pos_y = 0;
 
-        var pos_field_xi = 0;
-        var pos_field_yi = 0;
-        var pos_field_zi = 0;
-
         var side_id = 0;
+        var margin = 0;
+
+        // the margin that is lost to rounding of transformed positions, which is well above the precision of 32 bit floats
+        const ROUNDING_MARGIN = 1e-6;
 
-        var dot = Vector.dot_vector;
+        var abs = Math.abs;
+        var min = Math.min;
         var floor = Math.floor;
-        for (var i = 0, li = pos_field.x.length; i < li; i++)
+        // NOTE: transformed positions are rounded to 32 bits, as they would be if they were stored in a VectorRaster first
+        var fround = Math.fround;
+        for (var i = 0, li = pos_x.length; i < li; i++)
         {
-            pos_field_xi = pos_field.x[i];
-            pos_field_yi = pos_field.y[i];
-            pos_field_zi = pos_field.z[i];
-
-            var side_id = 
-              (( pos_field_xi > 0)     ) +
-              (( pos_field_yi > 0) << 1) +
-              (( pos_field_zi > 0) << 2) ; 
-
-            side_x = OCTAHEDRON_SIDE_X[side_id];
-            side_y = OCTAHEDRON_SIDE_Y[side_id];
+            if (drift < thresholds[i]) {
+                continue;
+            }
+            xi = fround(pos_x[i] * xx + pos_y[i] * xy + pos_z[i] * xz);
+            yi = fround(pos_x[i] * yx + pos_y[i] * yy + pos_z[i] * yz);
+            zi = fround(pos_x[i] * zx + pos_y[i] * zy + pos_z[i] * zz);
 
-            projection_x = dot( side_x.x, side_x.y, side_x.z, pos_field_xi, pos_field_yi, pos_field_zi );
-            projection_y = dot( side_y.x, side_y.y, side_y.z, pos_field_xi, pos_field_yi, pos_field_zi );
+            side_id =
+              (( xi > 0)     ) +
+              (( yi > 0) << 1) +
+              (( zi > 0) << 2) ;
 
-            grid_pos_x = floor((projection_x + 1.) / cell_width);
-            grid_pos_y = floor((projection_y + 1.) / cell_width);
+            grid_x = (SIDE_X_X[side_id] * xi + SIDE_X_Y[side_id] * yi + SIDE_X_Z[side_id] * zi + 1.) / cell_width;
+            grid_y = (SIDE_Y_X[side_id] * xi + SIDE_Y_Y[side_id] * yi + SIDE_Y_Z[side_id] * zi + 1.) / cell_width;
+            grid_pos_x = floor(grid_x);
+            grid_pos_y = floor(grid_y);
 
             result[i] = cells[cell_id(side_id, grid_pos_x, grid_pos_y, dimension_x, dimension_y)];
+
+            // a position changes sides when one of its components changes sign,
+            //   and it changes cells when either of its projections crosses a multiple of "cell_width",
+            //   and neither can happen before the position moves by more than the distance to either
+            margin = min(
+                abs(xi), abs(yi), abs(zi),
+                min(grid_x - grid_pos_x, 1. - (grid_x - grid_pos_x)) * cell_width,
+                min(grid_y - grid_pos_y, 1. - (grid_y - grid_pos_y)) * cell_width
+            );
+            thresholds[i] = drift + margin - ROUNDING_MARGIN;
         }
         return result;
     }
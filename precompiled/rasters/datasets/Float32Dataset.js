@@ -31,12 +31,16 @@ Float32Dataset.average = function (dataset) {
   return result / dataset.length;
 };
 Float32Dataset.median = function (dataset, scratch) {
-  scratch = scratch || Float32Raster(dataset.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('Float32Dataset.median');
+  scratch = scratch || pool.getFloat32Raster(dataset.grid);
   ASSERT_IS_ARRAY(dataset, Float32Array)
   ASSERT_IS_ARRAY(scratch, Float32Array)
   Float32Raster.copy(dataset, scratch);
   scratch.sort();
-  return scratch[Math.floor(scratch.length/2)];
+  var median = scratch[Math.floor(scratch.length/2)];
+  pool.deallocate('Float32Dataset.median');
+  return median;
 };
 Float32Dataset.standard_deviation = function (dataset) {
   ASSERT_IS_ARRAY(dataset, Float32Array)
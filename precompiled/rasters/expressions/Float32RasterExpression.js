@@ -0,0 +1,166 @@
+
+// Float32RasterExpression records a chain of element-wise raster operations, then runs them as a single loop.
+// Model code often chains operations like ScalarField.mult_scalar() -> ScalarField.add_field() -> Float32RasterInterpolation.clamp(),
+//   each of which streams a raster through memory and often needs a scratch raster to hold its result.
+// A fused loop reads each input once per cell and writes the result once, with no scratch rasters in between.
+//
+// Usage:
+//   Float32RasterExpression(a).mult_scalar(2).add_field(b).clamp(0, 1).evaluate(result);
+//
+// Methods are named after their counterparts in ScalarField and Float32RasterInterpolation, and behave the same.
+// Operands of "*_field" methods can either be Float32Rasters or other expressions.
+// Since every input is read for a cell before its result is written, "result" can be one of the inputs.
+//
+// "evaluate" generates the source of the loop and compiles it with "new Function".
+// Scalars are passed as parameters rather than written into the source,
+//   so a chain that runs every timestep with different scalars is only compiled once.
+function Float32RasterExpression(operand) {
+    if (!(this instanceof Float32RasterExpression)) {
+        return new Float32RasterExpression(operand);
+    }
+    ASSERT_IS_ARRAY(operand, Float32Array)
+    this.op = 'raster';
+    this.operands = [operand];
+}
+
+// functions that are available to the source of compiled loops
+// NOTE: these are written to match the raster operations they stand in for, including how they treat NaN
+Float32RasterExpression.helpers = {
+    min: function(a, b) {
+        return a < b? a : b;
+    },
+    max: function(a, b) {
+        return a > b? a : b;
+    },
+    clamp: function(x, min_value, max_value) {
+        return x > max_value? max_value : x < min_value? min_value : x;
+    },
+    linearstep: function(x, edge0, edge1) {
+        var fraction = (x - edge0) * (1 / (edge1 - edge0));
+        return fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+    },
+    smoothstep: function(x, edge0, edge1) {
+        var fraction = (x - edge0) * (1 / (edge1 - edge0));
+        var linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+        return linearstep*linearstep*(3-2*linearstep);
+    },
+};
+// compiled loops, indexed by their source
+Float32RasterExpression.compiled = new Map();
+
+// "templates" map each operation onto source, where "$0" is the expression so far, and "$1", "$2" are its operands
+Float32RasterExpression.templates = {
+    add_field:       '($0 + $1)',
+    sub_field:       '($0 - $1)',
+    mult_field:      '($0 * $1)',
+    div_field:       '($0 / $1)',
+    min_field:       'min($0, $1)',
+    max_field:       'max($0, $1)',
+    add_field_term:  '($0 + $2 * $1)',
+    add_scalar:      '($0 + $1)',
+    sub_scalar:      '($0 - $1)',
+    mult_scalar:     '($0 * $1)',
+    div_scalar:      '($0 / $1)',
+    min_scalar:      'min($0, $1)',
+    max_scalar:      'max($0, $1)',
+    pow_scalar:      'pow($0, $1)',
+    add_scalar_term: '($0 + $2 * $1)',
+    sub_scalar_term: '($0 - $2 * $1)',
+    clamp:           'clamp($0, $1, $2)',
+    linearstep:      'linearstep($0, $1, $2)',
+    smoothstep:      'smoothstep($0, $1, $2)',
+};
+
+Float32RasterExpression.prototype.chain = function(op, operands) {
+    var result = Object.create(Float32RasterExpression.prototype);
+    result.op = op;
+    result.operands = [this].concat(operands);
+    return result;
+}
+Float32RasterExpression.prototype.add_field       = function(b)           { return this.chain('add_field', [b]); }
+Float32RasterExpression.prototype.sub_field       = function(b)           { return this.chain('sub_field', [b]); }
+Float32RasterExpression.prototype.mult_field      = function(b)           { return this.chain('mult_field', [b]); }
+Float32RasterExpression.prototype.div_field       = function(b)           { return this.chain('div_field', [b]); }
+Float32RasterExpression.prototype.min_field       = function(b)           { return this.chain('min_field', [b]); }
+Float32RasterExpression.prototype.max_field       = function(b)           { return this.chain('max_field', [b]); }
+Float32RasterExpression.prototype.add_field_term  = function(b, c)        { return this.chain('add_field_term', [b, c]); }
+Float32RasterExpression.prototype.add_scalar      = function(b)           { return this.chain('add_scalar', [b]); }
+Float32RasterExpression.prototype.sub_scalar      = function(b)           { return this.chain('sub_scalar', [b]); }
+Float32RasterExpression.prototype.mult_scalar     = function(b)           { return this.chain('mult_scalar', [b]); }
+Float32RasterExpression.prototype.div_scalar      = function(b)           { return this.chain('div_scalar', [b]); }
+Float32RasterExpression.prototype.min_scalar      = function(b)           { return this.chain('min_scalar', [b]); }
+Float32RasterExpression.prototype.max_scalar      = function(b)           { return this.chain('max_scalar', [b]); }
+Float32RasterExpression.prototype.pow_scalar      = function(b)           { return this.chain('pow_scalar', [b]); }
+Float32RasterExpression.prototype.add_scalar_term = function(b, scalar)   { return this.chain('add_scalar_term', [b, scalar]); }
+Float32RasterExpression.prototype.sub_scalar_term = function(b, scalar)   { return this.chain('sub_scalar_term', [b, scalar]); }
+Float32RasterExpression.prototype.clamp           = function(min_value, max_value) { return this.chain('clamp', [min_value, max_value]); }
+Float32RasterExpression.prototype.linearstep      = function(edge0, edge1) { return this.chain('linearstep', [edge0, edge1]); }
+Float32RasterExpression.prototype.smoothstep      = function(edge0, edge1) { return this.chain('smoothstep', [edge0, edge1]); }
+
+// "evaluate" runs the expression over every cell, storing it in "result"
+Float32RasterExpression.prototype.evaluate = function(result) {
+    var rasters = [];
+    var scalars = [];
+    // NOTE: rasters are found by identity, so a raster that appears several times is only read once per cell
+    function source(operand) {
+        if (operand instanceof Float32RasterExpression) {
+            if (operand.op === 'raster') {
+                return source(operand.operands[0]);
+            }
+            var template = Float32RasterExpression.templates[operand.op];
+            var operand_sources = operand.operands.map(source);
+            return template.replace(/\$(\d)/g, function(match, j) { return operand_sources[j]; });
+        } else if (ArrayBuffer.isView(operand)) {
+            ASSERT_IS_ARRAY(operand, Float32Array)
+            var index = rasters.indexOf(operand);
+            if (index < 0) {
+                index = rasters.length;
+                rasters.push(operand);
+            }
+            return 'x' + index;
+        } else {
+            ASSERT_IS_SCALAR(operand)
+            scalars.push(operand);
+            return 's' + (scalars.length-1);
+        }
+    }
+    var expression = source(this);
+
+    result = result || Float32Raster.FromExample(rasters[0]);
+    ASSERT_IS_ARRAY(result, Float32Array)
+    for (var j = 0; j < rasters.length; j++) {
+        if (rasters[j].length !== result.length) {
+            throw `Float32RasterExpression: rasters must all be the same length`;
+        }
+    }
+
+    // NOTE: the source names every raster and scalar it uses, so it is enough to identify the loop
+    var loop = Float32RasterExpression.compiled.get(expression);
+    if (loop === void 0) {
+        loop = Float32RasterExpression.compile(expression, rasters.length, scalars.length);
+        Float32RasterExpression.compiled.set(expression, loop);
+    }
+    loop(rasters, scalars, result, Float32RasterExpression.helpers);
+    return result;
+}
+// "compile" returns a function that evaluates "expression" for every cell of "result"
+Float32RasterExpression.compile = function(expression, raster_count, scalar_count) {
+    var lines = [
+        'var pow = Math.pow;',
+        'var min = helpers.min, max = helpers.max, clamp = helpers.clamp, linearstep = helpers.linearstep, smoothstep = helpers.smoothstep;',
+    ];
+    var j = 0;
+    for (j = 0; j < raster_count; j++) {
+        lines.push('var r' + j + ' = rasters[' + j + '];');
+    }
+    for (j = 0; j < scalar_count; j++) {
+        lines.push('var s' + j + ' = scalars[' + j + '];');
+    }
+    lines.push('for (var i = 0, li = result.length; i < li; i++) {');
+    for (j = 0; j < raster_count; j++) {
+        lines.push('    var x' + j + ' = r' + j + '[i];');
+    }
+    lines.push('    result[i] = ' + expression + ';');
+    lines.push('}');
+    return new Function('rasters', 'scalars', 'result', 'helpers', lines.join('\n'));
+}
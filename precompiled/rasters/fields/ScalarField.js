@@ -219,9 +219,7 @@ ScalarField.add_scalar_term = function (scalar_field1, scalar_field2, scalar, re
   ASSERT_IS_ANY_ARRAY(scalar_field2) 
   ASSERT_IS_SCALAR(scalar)
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] + scalar * scalar_field2[i];
-  }
+  RasterWorkerPool.run('add_scalar_term', { a: scalar_field1, b: scalar_field2, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.add_field = function (scalar_field1, scalar_field2, result) {
@@ -229,9 +227,7 @@ ScalarField.add_field = function (scalar_field1, scalar_field2, result) {
   ASSERT_IS_ARRAY(scalar_field1, Float32Array)
   ASSERT_IS_ANY_ARRAY(scalar_field2) 
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] + scalar_field2[i];
-  }
+  RasterWorkerPool.run('add_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_field = function (scalar_field1, scalar_field2, result) {
@@ -239,9 +235,7 @@ ScalarField.sub_field = function (scalar_field1, scalar_field2, result) {
   ASSERT_IS_ARRAY(scalar_field1, Float32Array)
   ASSERT_IS_ANY_ARRAY(scalar_field2) 
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] - scalar_field2[i];
-  }
+  RasterWorkerPool.run('sub_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_field_term = function (scalar_field1, scalar_field2, field3, result) {
@@ -271,9 +265,7 @@ ScalarField.mult_field = function (scalar_field1, scalar_field2, result) {
   ASSERT_IS_ARRAY(scalar_field1, Float32Array)
   ASSERT_IS_ANY_ARRAY(scalar_field2) 
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field1[i] * scalar_field2[i];
-  }
+  RasterWorkerPool.run('mult_field', { a: scalar_field1, b: scalar_field2, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.div_field = function (scalar_field1, scalar_field2, result) {
@@ -310,9 +302,7 @@ ScalarField.add_scalar = function (scalar_field, scalar, result) {
   ASSERT_IS_ARRAY(scalar_field, Float32Array)
   ASSERT_IS_SCALAR(scalar)
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field[i] + scalar;
-  }
+  RasterWorkerPool.run('add_scalar', { a: scalar_field, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.sub_scalar = function (scalar_field, scalar, result) {
@@ -330,9 +320,7 @@ ScalarField.mult_scalar = function (scalar_field, scalar, result) {
   ASSERT_IS_ARRAY(scalar_field, Float32Array)
   ASSERT_IS_SCALAR(scalar)
   ASSERT_IS_ARRAY(result, Float32Array)
-  for (var i = 0, li = result.length; i < li; i++) {
-    result[i] = scalar_field[i] * scalar;
-  }
+  RasterWorkerPool.run('mult_scalar', { a: scalar_field, scalar: scalar, result: result }, void 0, result.length);
   return result;
 };
 ScalarField.div_scalar = function (scalar_field, scalar, result) {
@@ -388,8 +376,8 @@ ScalarField.differential = function (scalar_field, result) {
   ASSERT_IS_ARRAY(scalar_field, Float32Array)
   ASSERT_IS_VECTOR_RASTER(result)
   
-  var arrows = scalar_field.grid.arrows;
-  var arrow = [];
+  var arrow_from = scalar_field.grid.arrow_from;
+  var arrow_to = scalar_field.grid.arrow_to;
   var from = 0, to = 0;
   var x = result.x;
   var y = result.y;
@@ -397,62 +385,28 @@ ScalarField.differential = function (scalar_field, result) {
   Float32Raster.fill(x, 0);
   Float32Raster.fill(y, 0);
   Float32Raster.fill(z, 0);
-  for (var i = 0, li = arrows.length; i < li; i++) {
-    arrow = arrows[i];
-    from = arrow[0];
-    to = arrow[1];
+  for (var i = 0, li = arrow_from.length; i < li; i++) {
+    from = arrow_from[i];
+    to = arrow_to[i];
     x[to] += scalar_field[from] - scalar_field[to];
     y[to] += scalar_field[from] - scalar_field[to];
     z[to] += scalar_field[from] - scalar_field[to];
   }
-  var neighbor_lookup = scalar_field.grid.neighbor_lookup;
-  var neighbor_count = 0;
-  for (var i = 0, li = neighbor_lookup.length; i < li; i++) {
-    neighbor_count = neighbor_lookup[i].length;
-    x[i] /= neighbor_count || 1;
-    y[i] /= neighbor_count || 1;
-    z[i] /= neighbor_count || 1;
+  var neighbor_count = scalar_field.grid.neighbor_count;
+  for (var i = 0, li = neighbor_count.length; i < li; i++) {
+    x[i] /= neighbor_count[i] || 1;
+    y[i] /= neighbor_count[i] || 1;
+    z[i] /= neighbor_count[i] || 1;
   }
   return result;
 };
+// NOTE: "scratch" and "scratch2" are no longer used, they are only kept so that existing calls still work
 ScalarField.gradient = function (scalar_field, result, scratch, scratch2) {
   result = result || VectorRaster(scalar_field.grid);
-  scratch = scratch || Float32Raster(scalar_field.grid);
-  scratch2 = scratch2 || Float32Raster(scalar_field.grid);
 
   ASSERT_IS_ARRAY(scalar_field, Float32Array)
-  ASSERT_IS_ARRAY(scratch, Float32Array)
-  ASSERT_IS_ARRAY(scratch2, Float32Array)
   ASSERT_IS_VECTOR_RASTER(result)
 
-  var pos = scalar_field.grid.pos; 
-  var ix = pos.x; 
-  var iy = pos.y; 
-  var iz = pos.z; 
-  var dpos_hat = scalar_field.grid.pos_arrow_differential_normalized; 
-  var dxhat = dpos_hat.x; 
-  var dyhat = dpos_hat.y; 
-  var dzhat = dpos_hat.z; 
-  var dpos = scalar_field.grid.pos_arrow_differential; 
-  var dx = dpos.x; 
-  var dy = dpos.y; 
-  var dz = dpos.z; 
-  var arrows = scalar_field.grid.arrows; 
-  var arrow = []; 
-  var dlength = scalar_field.grid.pos_arrow_distances; 
-  var neighbor_count = scalar_field.grid.neighbor_count; 
-  var average = scratch; 
-  var x = result.x; 
-  var y = result.y; 
-  var z = result.z; 
-  var arrow_distance = 0; 
-  var average_distance = scalar_field.grid.average_distance; 
-  var slope = 0; 
-  var slope_magnitude = 0; 
-  var from = 0; 
-  var to = 0; 
-  var max_slope_from = 0; 
-  var PI = Math.PI; 
   //
   // NOTE: 
   // The naive implementation is to estimate the gradient based on each individual neighbor,
@@ -467,25 +421,7 @@ ScalarField.gradient = function (scalar_field, result, scratch, scratch2) {
   //   ∇ϕ = 1/V ∫∫ₐ ϕn̂ da
   // so find flux out of an area, then divide by volume
   // the area/volume is calculated for a circle that reaches halfway to neighboring vertices
-  Float32Raster.fill(x, 0);
-  Float32Raster.fill(y, 0);
-  Float32Raster.fill(z, 0);
-  var difference = 0;
-  for (var i = 0, li = arrows.length; i < li; i++) { 
-    arrow = arrows[i]; 
-    from = arrow[0]; 
-    to = arrow[1]; 
-    difference = (scalar_field[to] - scalar_field[from]);             
-    x[from] += difference * dxhat[i] * dlength[i]/neighbor_count[from] * PI;
-    y[from] += difference * dyhat[i] * dlength[i]/neighbor_count[from] * PI;
-    z[from] += difference * dzhat[i] * dlength[i]/neighbor_count[from] * PI;
-  } 
-  var inverse_volume = 1 / (PI * (average_distance/2) * (average_distance/2)); 
-  for (var i = 0, li = scalar_field.length; i < li; i++) { 
-    x[i] *= inverse_volume; 
-    y[i] *= inverse_volume; 
-    z[i] *= inverse_volume; 
-  } 
+  RasterWorkerPool.run('gradient', { field: scalar_field, x: result.x, y: result.y, z: result.z }, scalar_field.grid, scalar_field.length);
 
   return result;
 };
@@ -497,17 +433,7 @@ ScalarField.average_difference = function (scalar_field, result) {
   ASSERT_IS_ARRAY(result, Float32Array)
   ASSERT_IS_NOT_EQUAL(scalar_field, result)
 
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-  Float32Raster.fill(result, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      result[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      result[i] /= neighbor_count[i];
-  }
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: 1, result: result }, scalar_field.grid, result.length);
   return result;
 };
  
@@ -539,26 +465,17 @@ ScalarField.laplacian = function (scalar_field, result) {
   ASSERT_IS_ARRAY(result, Float32Array)
   ASSERT_IS_NOT_EQUAL(scalar_field, result)
 
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-
-  Float32Raster.fill(result, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      result[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
   var average_distance = scalar_field.grid.average_distance;
   var average_area = average_distance * average_distance;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      result[i] /= average_area * neighbor_count[i];
-  }
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: average_area, result: result }, scalar_field.grid, result.length);
   return result;
 };
 // iterates through time using the diffusion equation
 ScalarField.diffusion_by_constant = function (scalar_field, constant, result, scratch) {
   result = result || Float32Raster(scalar_field.grid);
-  scratch = scratch || Float32Raster(scalar_field.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('ScalarField.diffusion_by_constant');
+  scratch = scratch || pool.getFloat32Raster(scalar_field.grid);
 
   ASSERT_IS_ARRAY(scalar_field, Float32Array)
   ASSERT_IS_ARRAY(result, Float32Array)
@@ -566,26 +483,18 @@ ScalarField.diffusion_by_constant = function (scalar_field, constant, result, sc
   ASSERT_IS_SCALAR(constant)
 
   var laplacian = scratch;
-  var arrows = scalar_field.grid.arrows;
-  var arrow
-  Float32Raster.fill(laplacian, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      laplacian[arrow[0]] += scalar_field[arrow[1]] - scalar_field[arrow[0]];
-  }
-  var neighbor_count = scalar_field.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      laplacian[i] /= neighbor_count[i];
-  }
-  for (var i=0, li=laplacian.length; i<li; ++i) {
-      result[i] = scalar_field[i] + constant * laplacian[i];
-  }
+  // NOTE: the laplacian is found for every cell before any are written to "result", in case "result" is "scalar_field"
+  RasterWorkerPool.run('average_difference', { field: scalar_field, scale: 1, result: laplacian }, scalar_field.grid, laplacian.length);
+  RasterWorkerPool.run('add_scalar_term', { a: scalar_field, b: laplacian, scalar: constant, result: result }, void 0, laplacian.length);
+  pool.deallocate('ScalarField.diffusion_by_constant');
   return result;
 };
 // iterates through time using the diffusion equation
 ScalarField.diffusion_by_field = function (scalar_field1, scalar_field2, result, scratch) {
   result = result || Float32Raster(scalar_field1.grid);
-  scratch = scratch || Float32Raster(scalar_field1.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('ScalarField.diffusion_by_field');
+  scratch = scratch || pool.getFloat32Raster(scalar_field1.grid);
 
   ASSERT_IS_ARRAY(scalar_field1, Float32Array)
   ASSERT_IS_ARRAY(scalar_field2, Float32Array)
@@ -593,19 +502,52 @@ ScalarField.diffusion_by_field = function (scalar_field1, scalar_field2, result,
   ASSERT_IS_ARRAY(scratch, Float32Array)
 
   var laplacian = scratch;
-  var arrows = scalar_field1.grid.arrows;
-  var arrow
-  Float32Raster.fill(laplacian, 0);
-  for (var i=0, li=arrows.length; i<li; ++i) {
-      arrow = arrows[i];
-      laplacian[arrow[0]] += scalar_field1[arrow[1]] - scalar_field1[arrow[0]];
-  }
-  var neighbor_count = scalar_field1.grid.neighbor_count;
-  for (var i = 0, li = neighbor_count.length; i < li; i++) {
-      laplacian[i] /= neighbor_count[i];
+  // NOTE: the laplacian is found for every cell before any are written to "result", in case "result" is "scalar_field1"
+  RasterWorkerPool.run('average_difference', { field: scalar_field1, scale: 1, result: laplacian }, scalar_field1.grid, laplacian.length);
+  RasterWorkerPool.run('add_field_product', { a: scalar_field1, b: laplacian, c: scalar_field2, result: result }, void 0, laplacian.length);
+  pool.deallocate('ScalarField.diffusion_by_field');
+  return result;
+};
+// iterates through time using the diffusion equation, for "iterations" iterations of "diffusion_by_constant"
+// If enough iterations are requested, they run on the gpu, see "RasterGpuKernels"
+ScalarField.diffusion_by_constant_iterations = function (scalar_field, constant, iterations, result, scratch) {
+  result = result || Float32Raster(scalar_field.grid);
+
+  ASSERT_IS_ARRAY(scalar_field, Float32Array)
+  ASSERT_IS_ARRAY(result, Float32Array)
+  ASSERT_IS_SCALAR(constant)
+
+  if (iterations >= RasterGpuKernels.MIN_ITERATION_COUNT && RasterGpuKernels.can_run(scalar_field.grid)) {
+    return RasterGpuKernels.diffusion(scalar_field, constant, void 0, iterations, result);
+  }
+  if (iterations < 1) {
+    return Float32Raster.copy(scalar_field, result);
+  }
+  ScalarField.diffusion_by_constant(scalar_field, constant, result, scratch);
+  for (var i = 1; i < iterations; i++) {
+    ScalarField.diffusion_by_constant(result, constant, result, scratch);
+  }
+  return result;
+};
+// iterates through time using the diffusion equation, for "iterations" iterations of "diffusion_by_field"
+// If enough iterations are requested, they run on the gpu, see "RasterGpuKernels"
+ScalarField.diffusion_by_field_iterations = function (scalar_field1, scalar_field2, iterations, result, scratch) {
+  result = result || Float32Raster(scalar_field1.grid);
+
+  ASSERT_IS_ARRAY(scalar_field1, Float32Array)
+  ASSERT_IS_ARRAY(scalar_field2, Float32Array)
+  ASSERT_IS_ARRAY(result, Float32Array)
+  ASSERT_IS_NOT_EQUAL(scalar_field2, result)
+
+  if (iterations >= RasterGpuKernels.MIN_ITERATION_COUNT && RasterGpuKernels.can_run(scalar_field1.grid)) {
+    return RasterGpuKernels.diffusion(scalar_field1, 0, scalar_field2, iterations, result);
+  }
+  if (iterations < 1) {
+    return Float32Raster.copy(scalar_field1, result);
   }
-  for (var i=0, li=laplacian.length; i<li; ++i) {
-      result[i] = scalar_field1[i] + scalar_field2[i] * laplacian[i];
+  ScalarField.diffusion_by_field(scalar_field1, scalar_field2, result, scratch);
+  for (var i = 1; i < iterations; i++) {
+    ScalarField.diffusion_by_field(result, scalar_field2, result, scratch);
   }
   return result;
 };
@@ -340,8 +340,8 @@ Uint8Field.gradient = function (scalar_field, result) {
   var dx = dpos.x; 
   var dy = dpos.y; 
   var dz = dpos.z; 
-  var arrows = grid.arrows; 
-  var arrow = []; 
+  var arrow_from = grid.arrow_from; 
+  var arrow_to = grid.arrow_to; 
   var dlength = grid.pos_arrow_distances; 
   var neighbor_count = grid.neighbor_count; 
   var x = result.x; 
@@ -373,10 +373,9 @@ Uint8Field.gradient = function (scalar_field, result) {
   y.fill(0);
   z.fill(0);
   var average_value = 0;
-  for (var i = 0, li = arrows.length; i < li; i++) { 
-    arrow = arrows[i]; 
-    from = arrow[0]; 
-    to = arrow[1]; 
+  for (var i = 0, li = arrow_from.length; i < li; i++) { 
+    from = arrow_from[i]; 
+    to = arrow_to[i]; 
     average_value = (scalar_field[to] - scalar_field[from]); 
     x[from] += average_value * dxhat[i] * PI * dlength[i]/neighbor_count[from]; 
     y[from] += average_value * dyhat[i] * PI * dlength[i]/neighbor_count[from]; 
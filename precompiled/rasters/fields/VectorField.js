@@ -16,9 +16,7 @@ VectorField.add_vector_field = function(vector_field1, vector_field2, result) {
     var v = vector_field2.everything;
     var out = result.everything;
 
-    for (var i=0, li=u.length; i<li; ++i) {
-        out[i] = u[i] + v[i];
-    }
+    RasterWorkerPool.run('add_field', { a: u, b: v, result: out }, void 0, u.length);
 
     return result;
 };
@@ -34,9 +32,7 @@ VectorField.sub_vector_field = function(vector_field1, vector_field2, result) {
     var v = vector_field2.everything;
     var out = result.everything;
 
-    for (var i=0, li=u.length; i<li; ++i) {
-        out[i] = u[i] - v[i];
-    }
+    RasterWorkerPool.run('sub_field', { a: u, b: v, result: out }, void 0, u.length);
 
     return result;
 };
@@ -675,16 +671,7 @@ VectorField.magnitude = function(vector_field, result) {
     var y = vector_field.y;
     var z = vector_field.z;
 
-    var xi=0, yi=0, zi=0;
-    var sqrt = Math.sqrt;
-    for (var i = 0, li = result.length; i<li; i++) {
-        var xi = x[i];
-        var yi = y[i];
-        var zi = z[i];
-        result[i] = sqrt(    xi * xi + 
-                            yi * yi + 
-                            zi * zi      );
-    }
+    RasterWorkerPool.run('magnitude', { x: x, y: y, z: z, result: result }, void 0, result.length);
     return result;
 }
 
@@ -702,20 +689,7 @@ VectorField.normalize = function(vector_field, result) {
     var oy = result.y;
     var oz = result.z;
 
-    var xi=0., yi=0., zi=0.;
-    var sqrt = Math.sqrt;
-    var mag = 0.;
-    for (var i = 0, li = x.length; i<li; i++) {
-        var xi = x[i];
-        var yi = y[i];
-        var zi = z[i];
-        mag = sqrt(    xi * xi + 
-                    yi * yi + 
-                    zi * zi      );
-        ox[i] = xi/(mag||1);
-        oy[i] = yi/(mag||1);
-        oz[i] = zi/(mag||1);
-    }
+    RasterWorkerPool.run('normalize', { x: x, y: y, z: z, ox: ox, oy: oy, oz: oz }, void 0, x.length);
     return result;
 }
 
@@ -723,7 +697,7 @@ VectorField.normalize = function(vector_field, result) {
 // NOTE: should arrow_differential exist at all? 
 // Consider moving its code to grid
 VectorField.arrow_differential = function(vector_field, result) {
-    result = result || VectorRaster.OfLength(vector_field.grid.arrows.length, undefined);
+    result = result || VectorRaster.OfLength(vector_field.grid.arrow_from.length, undefined);
     
     ASSERT_IS_VECTOR_RASTER(vector_field)
     ASSERT_IS_VECTOR_RASTER(result)
@@ -736,12 +710,13 @@ VectorField.arrow_differential = function(vector_field, result) {
     var y = result.y;
     var z = result.z;
 
-    var arrows = vector_field.grid.arrows;
+    var arrow_from = vector_field.grid.arrow_from;
+    var arrow_to = vector_field.grid.arrow_to;
     var from = 0;
     var to = 0;
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
+    for (var i = 0, li = arrow_from.length; i<li; i++) {
+        from = arrow_from[i];
+        to = arrow_to[i];
         x[i] = x1[to] - x1[from];
         y[i] = y1[to] - y1[from];
         z[i] = z1[to] - z1[from];
@@ -772,36 +747,7 @@ VectorField.divergence = function(vector_field, result) {
     ASSERT_IS_VECTOR_RASTER(vector_field)
     ASSERT_IS_ARRAY(result, Float32Array)
 
-    var dlength = vector_field.grid.pos_arrow_distances;
-
-    var arrows = vector_field.grid.arrows;
-
-    var x = vector_field.x;
-    var y = vector_field.y;
-    var z = vector_field.z;
-
-    var arrow_pos_diff_normalized = vector_field.grid.pos_arrow_differential_normalized;
-    var dxhat = arrow_pos_diff_normalized.x;
-    var dyhat = arrow_pos_diff_normalized.y;
-    var dzhat = arrow_pos_diff_normalized.z;
-
-    var from = 0;
-    var to = 0;
-    Float32Raster.fill(result, 0);
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
-
-        result[from] += 
-          ( (x[to] - x[from]) * dxhat[i]   
-           +(y[to] - y[from]) * dyhat[i]   
-           +(z[to] - z[from]) * dzhat[i]) / dlength[i];
-    }
-
-    var neighbor_count = vector_field.grid.neighbor_count;
-    for (var i = 0, li = neighbor_count.length; i < li; i++) {
-        result[i] /= neighbor_count[i] || 1;
-    }
+    RasterWorkerPool.run('divergence', { x: vector_field.x, y: vector_field.y, z: vector_field.z, result: result }, vector_field.grid, result.length);
 
     return result;
 }
@@ -825,7 +771,8 @@ VectorField.curl = function(vector_field, result) {
 
     var dlength = vector_field.grid.pos_arrow_distances;
 
-    var arrows = vector_field.grid.arrows;
+    var arrow_from = vector_field.grid.arrow_from;
+    var arrow_to = vector_field.grid.arrow_to;
 
     var curl_fx = result.x;
     var curl_fy = result.y;
@@ -848,9 +795,9 @@ VectorField.curl = function(vector_field, result) {
     Float32Raster.fill(curl_fx, 0);
     Float32Raster.fill(curl_fy, 0);
     Float32Raster.fill(curl_fz, 0);
-    for (var i = 0, li = arrows.length; i<li; i++) {
-        from = arrows[i][0];
-        to = arrows[i][1];
+    for (var i = 0, li = arrow_from.length; i<li; i++) {
+        from = arrow_from[i];
+        to = arrow_to[i];
 
         dfx = fx[to] - fx[from];
         dfy = fy[to] - fy[from];
@@ -9,13 +9,19 @@ var VectorImageAnalysis = {};
 // NOTE: this uses no particular algorithm, I wrote it before I started looking into the research
 // This function repeatedly uses the flood fill algorithm from VectorRasterGraphics
 VectorImageAnalysis.image_segmentation = function(vector_field, segment_num, min_segment_size, result, scratch_ui8_1, scratch_ui8_2, scratch_ui8_3) {
-  var scratch_ui8_1 = scratch_ui8_1 || Uint8Raster(vector_field.grid);
-  var scratch_ui8_2 = scratch_ui8_2 || Uint8Raster(vector_field.grid);
-  var scratch_ui8_3 = scratch_ui8_3 || Uint8Raster(vector_field.grid);
+  var pool = RasterPool.scratchpad;
+  pool.allocate('VectorImageAnalysis.image_segmentation');
+  var scratch_ui8_1 = scratch_ui8_1 || pool.getUint8Raster(vector_field.grid);
+  var scratch_ui8_2 = scratch_ui8_2 || pool.getUint8Raster(vector_field.grid);
+  if (!scratch_ui8_3) {
+    // rasters from the pool are not cleared, unlike new rasters
+    scratch_ui8_3 = pool.getUint8Raster(vector_field.grid);
+    Uint8Raster.fill(scratch_ui8_3, 0);
+  }
 
   var max_iterations = 2 * segment_num;
 
-  var magnitude = VectorField.magnitude(vector_field);
+  var magnitude = VectorField.magnitude(vector_field, pool.getFloat32Raster(vector_field.grid));
 
   var segments = result || Uint8Raster(vector_field.grid);
   Uint8Raster.fill(segments, 0);
@@ -42,6 +48,7 @@ VectorImageAnalysis.image_segmentation = function(vector_field, segment_num, min
     }
   }
 
+  pool.deallocate('VectorImageAnalysis.image_segmentation');
   return segments;
 }
 
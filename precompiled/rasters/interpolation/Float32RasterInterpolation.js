@@ -35,11 +35,7 @@ Float32RasterInterpolation.clamp = function(x, min_value, max_value, result) {
     ASSERT_IS_ARRAY(x, Float32Array)
     result = result || Float32Raster.FromExample(x);
     ASSERT_IS_ARRAY(result, Float32Array)
-    var x_i = 0.0;
-    for (var i = 0, li = x.length; i < li; i++) {
-        x_i = x[i];
-        result[i] = x_i > max_value? max_value : x_i < min_value? min_value : x_i;
-    }
+    RasterWorkerPool.run('clamp', { x: x, min_value: min_value, max_value: max_value, result: result }, void 0, x.length);
     return result;
 }
 Float32RasterInterpolation.step = function(edge, x, result) {
@@ -55,26 +51,14 @@ Float32RasterInterpolation.linearstep = function(edge0, edge1, x, result) {
     ASSERT_IS_ARRAY(x, Float32Array)
     result = result || Float32Raster.FromExample(x);
     ASSERT_IS_ARRAY(result, Float32Array)
-    var fraction = 0.;
-    var inverse_edge_distance = 1 / (edge1 - edge0);
-    for (var i = 0, li = result.length; i < li; i++) {
-        fraction = (x[i] - edge0) * inverse_edge_distance;
-        result[i] = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
-    }
+    RasterWorkerPool.run('linearstep', { x: x, edge0: edge0, edge1: edge1, result: result }, void 0, result.length);
     return result;
 }
 Float32RasterInterpolation.smoothstep = function(edge0, edge1, x, result) {
     ASSERT_IS_ARRAY(x, Float32Array)
     result = result || Float32Raster.FromExample(x);
     ASSERT_IS_ARRAY(result, Float32Array)
-    var inverse_edge_distance = 1 / (edge1 - edge0);
-    var fraction = 0.;
-    var linearstep = 0.;
-    for (var i = 0, li = result.length; i < li; i++) {
-        fraction = (x[i] - edge0) * inverse_edge_distance;
-        linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
-        result[i] = linearstep*linearstep*(3-2*linearstep);
-    }
+    RasterWorkerPool.run('smoothstep', { x: x, edge0: edge0, edge1: edge1, result: result }, void 0, result.length);
     return result;
 }
 // NOTE: you probably don't want to use this - you should use "smoothstep", instead
@@ -96,7 +80,9 @@ Float32RasterInterpolation.smoothstep2 = function(x, k, result) {
 Float32RasterInterpolation.lerp = function(control_points_x, control_points_y, x, result, scratch) {
     ASSERT_IS_ARRAY(x, Float32Array)
     result = result || Float32Raster.FromExample(x);
-    scratch = scratch || Float32Raster.FromExample(x);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('Float32RasterInterpolation.lerp');
+    scratch = scratch || pool.getFloat32Raster(x.grid);
 
     var mix = Float32RasterInterpolation.mix_fsf;
     var linearstep = Float32RasterInterpolation.linearstep;
@@ -107,5 +93,6 @@ Float32RasterInterpolation.lerp = function(control_points_x, control_points_y, x
         mix         (result, control_points_y[i], scratch,           result);
     }
 
+    pool.deallocate('Float32RasterInterpolation.lerp');
     return result;
 }
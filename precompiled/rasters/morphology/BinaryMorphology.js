@@ -75,69 +75,49 @@ BinaryMorphology.negation = function(field, result) {
 BinaryMorphology.dilation = function(field, radius, result, scratch) {
     radius = radius || 1;
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.dilation');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     ASSERT_IS_ARRAY(field, Uint8Array);
     ASSERT_IS_ARRAY(result, Uint8Array);
     var buffer1 = radius % 2 == 1? result:                 scratch;
     var buffer2 = radius % 2 == 0? result:                 scratch;
-    scratch.set(field);
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
     var temp = buffer1;
 
-    var neighbor_lookup = field.grid.neighbor_lookup;
-    var neighbors = [];
-    var buffer_i = true;
-
     for (var k=0; k<radius; ++k) {
-        for (var i=0, li=neighbor_lookup.length; i<li; ++i) {
-            neighbors = neighbor_lookup[i];
-            buffer_i = buffer2[i] === 1;
-            for (var j=0, lj=neighbors.length; j<lj; ++j) {
-                if (buffer_i) {
-                    continue;
-                }
-                buffer_i = buffer_i || buffer2[neighbors[j]] === 1;
-            }
-            buffer1[i] = buffer_i? 1:0;
-        }
+        RasterWorkerPool.run('dilation', { field: buffer2, result: buffer1 }, field.grid, field.length);
         temp = buffer1;
         buffer1 = buffer2;
         buffer2 = temp;
     }
 
+    pool.deallocate('BinaryMorphology.dilation');
     return buffer2;
 }
 BinaryMorphology.erosion = function(field, radius, result, scratch) {
     radius = radius || 1;
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.erosion');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     ASSERT_IS_ARRAY(field, Uint8Array);
     ASSERT_IS_ARRAY(result, Uint8Array);
     var buffer1 = radius % 2 == 1? result:                 scratch;
     var buffer2 = radius % 2 == 0? result:                 scratch;
-    scratch.set(field);
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
     var temp = buffer1;
 
-    var neighbor_lookup = field.grid.neighbor_lookup;
-    var neighbors = [];
-    var buffer_i = true;
-
     for (var k=0; k<radius; ++k) {
-        for (var i=0, li=neighbor_lookup.length; i<li; ++i) {
-            neighbors = neighbor_lookup[i];
-            buffer_i = buffer2[i] === 1;
-            for (var j=0, lj=neighbors.length; j<lj; ++j) {
-                if (!buffer_i) {
-                    continue;
-                }
-                buffer_i = buffer_i && buffer2[neighbors[j]] === 1;
-            }
-            buffer1[i] = buffer_i? 1:0;
-        }
+        RasterWorkerPool.run('erosion', { field: buffer2, result: buffer1 }, field.grid, field.length);
         temp = buffer1;
         buffer1 = buffer2;
         buffer2 = temp;
     }
 
+    pool.deallocate('BinaryMorphology.erosion');
     return buffer2;
 }
 BinaryMorphology.opening = function(field, radius) {
@@ -164,26 +144,34 @@ BinaryMorphology.black_top_hat = function(field, radius) {
 // Its name eludes to the "margin" concept within the html box model
 BinaryMorphology.margin = function(field, radius, result, scratch) {
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.margin');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     ASSERT_IS_ARRAY(field, Uint8Array);
     ASSERT_IS_ARRAY(result, Uint8Array);
     ASSERT_IS_ARRAY(scratch, Uint8Array);
-    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
     var dilation = result; // reuse result raster for performance reasons
     BinaryMorphology.dilation(field, radius, dilation, scratch);
-    return BinaryMorphology.difference(dilation, field, result);
+    BinaryMorphology.difference(dilation, field, result);
+    pool.deallocate('BinaryMorphology.margin');
+    return result;
 }
 // NOTE: this is not a standard concept in math morphology
 // It is meant to represent the difference between a figure and its erosion
 // Its name eludes to the "padding" concept within the html box model
 BinaryMorphology.padding = function(field, radius, result, scratch) {
     result = result || Uint8Raster(field.grid);
-    scratch = scratch || Uint8Raster(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BinaryMorphology.padding');
+    scratch = scratch || pool.getUint8Raster(field.grid);
     ASSERT_IS_ARRAY(field, Uint8Array);
     ASSERT_IS_ARRAY(result, Uint8Array);
     ASSERT_IS_ARRAY(scratch, Uint8Array);
-    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
     var erosion = result; // reuse result raster for performance reasons
     BinaryMorphology.erosion(field, radius, erosion, scratch);
-    return BinaryMorphology.difference(field, erosion, result, scratch);
+    BinaryMorphology.difference(field, erosion, result, scratch);
+    pool.deallocate('BinaryMorphology.padding');
+    return result;
 }
\ No newline at end of file
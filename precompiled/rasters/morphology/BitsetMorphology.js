@@ -0,0 +1,346 @@
+// BitsetMorphology mirrors BinaryMorphology for masks that are packed into bitsets, 32 cells per Uint32 word.
+// Cell i of a bitset is bit (i % 32) of word floor(i / 32). Bits past the last cell of a grid are always 0.
+// Boolean operations work on whole words, "count" finds area with a popcount,
+//   and dilation/erosion decide whole words at once wherever a word and its neighbors agree, see "get_neighborhood".
+// Bitsets are 8x smaller than the Uint8Arrays of BinaryMorphology, and convert to and from them with "pack" and "unpack".
+var BitsetMorphology = {};
+
+BitsetMorphology.Bitset = function(grid) {
+    var result = new Uint32Array(RasterArrayBuffer(grid, BitsetMorphology.get_word_count(grid.vertices.length) * Uint32Array.BYTES_PER_ELEMENT));
+    result.grid = grid;
+    return result;
+}
+
+// "get_word_count" returns the number of words in a bitset of "cell_count" cells
+BitsetMorphology.get_word_count = function(cell_count) {
+    return (cell_count + 31) >>> 5;
+}
+// "get_tail_mask" returns the bits of the last word of a bitset of "cell_count" cells that belong to cells
+BitsetMorphology.get_tail_mask = function(cell_count) {
+    var tail_length = cell_count & 31;
+    return tail_length === 0? 0xFFFFFFFF : ((1 << tail_length) - 1) >>> 0;
+}
+
+// "neighborhoods" are indexed by grid, since they never change once a grid is created
+BitsetMorphology.neighborhoods = new WeakMap();
+
+// "get_neighborhood" returns, for each word of a bitset of "grid", the other words that hold neighbors of its cells,
+//   along with masks of which bits within those words are neighbors, stored as compressed sparse rows:
+//   the neighbors of word i are "words[j]" and "masks[j]" for j from "offsets[i]" up to but excluding "offsets[i+1]".
+// Since grid cells are numbered so that nearby cells have nearby ids, each word has only a few neighboring words,
+//   so a word can be tested against all of its neighbors at once by "dilation" and "erosion".
+BitsetMorphology.get_neighborhood = function(grid) {
+    var neighborhood = BitsetMorphology.neighborhoods.get(grid);
+    if (neighborhood !== void 0) {
+        return neighborhood;
+    }
+    var word_count = BitsetMorphology.get_word_count(grid.vertices.length);
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var offsets = new Uint32Array(word_count+1);
+    var words = [];
+    var masks = [];
+    var word_masks = new Map();
+    for (var w = 0; w < word_count; w++) {
+        offsets[w] = words.length;
+        word_masks.clear();
+        for (var i = w << 5, li = Math.min(i + 32, grid.vertices.length); i < li; i++) {
+            for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+                var neighbor = arrow_to[j];
+                var neighbor_word = neighbor >>> 5;
+                if (neighbor_word !== w) {
+                    word_masks.set(neighbor_word, (word_masks.get(neighbor_word) || 0) | (1 << (neighbor & 31)));
+                }
+            }
+        }
+        word_masks.forEach(function(mask, neighbor_word) {
+            words.push(neighbor_word);
+            masks.push(mask >>> 0);
+        });
+    }
+    offsets[word_count] = words.length;
+    neighborhood = { offsets: offsets, words: new Uint32Array(words), masks: new Uint32Array(masks) };
+    BitsetMorphology.neighborhoods.set(grid, neighborhood);
+    return neighborhood;
+}
+
+// "pack" converts "field", a Uint8Array as used by BinaryMorphology, to a bitset
+BitsetMorphology.pack = function(field, result) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint8Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    var word = 0;
+    for (var w = 0, i = 0, li = field.length, lw = result.length; w < lw; w++) {
+        word = 0;
+        for (var b = 0; b < 32 && i < li; b++, i++) {
+            word |= (field[i] === 1? 1:0) << b;
+        }
+        result[w] = word;
+    }
+    return result;
+}
+// "unpack" converts "bitset" to a Uint8Array as used by BinaryMorphology
+BitsetMorphology.unpack = function(bitset, result) {
+    result = result || Uint8Raster(bitset.grid);
+    ASSERT_IS_ARRAY(bitset, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint8Array);
+    for (var i = 0, li = result.length; i < li; i++) {
+        result[i] = (bitset[i >>> 5] >>> (i & 31)) & 1;
+    }
+    return result;
+}
+// "get_ids" is the counterpart of "Uint8Raster.get_ids": bit i of the result is the bit of "bitset" at "id_array[i]"
+BitsetMorphology.get_ids = function(bitset, id_array, result) {
+    result = result || BitsetMorphology.Bitset(id_array.grid);
+    ASSERT_IS_ARRAY(bitset, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    var word = 0;
+    var id = 0;
+    for (var w = 0, i = 0, li = id_array.length, lw = result.length; w < lw; w++) {
+        word = 0;
+        for (var b = 0; b < 32 && i < li; b++, i++) {
+            id = id_array[i];
+            word |= ((bitset[id >>> 5] >>> (id & 31)) & 1) << b;
+        }
+        result[w] = word;
+    }
+    return result;
+}
+
+BitsetMorphology.universal = function(result) {
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    result.fill(0xFFFFFFFF);
+    result[result.length-1] = BitsetMorphology.get_tail_mask(result.grid.vertices.length);
+}
+BitsetMorphology.empty = function(result) {
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    result.fill(0);
+}
+
+BitsetMorphology.union = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    ASSERT_IS_ARRAY(field1, Uint32Array);
+    ASSERT_IS_ARRAY(field2, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] | field2[w];
+    }
+    return result;
+}
+BitsetMorphology.intersection = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    ASSERT_IS_ARRAY(field1, Uint32Array);
+    ASSERT_IS_ARRAY(field2, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] & field2[w];
+    }
+    return result;
+}
+BitsetMorphology.difference = function(field1, field2, result) {
+    result = result || BitsetMorphology.Bitset(field1.grid);
+    ASSERT_IS_ARRAY(field1, Uint32Array);
+    ASSERT_IS_ARRAY(field2, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    for (var w = 0, lw = field1.length; w < lw; ++w) {
+        result[w] = field1[w] & ~field2[w];
+    }
+    return result;
+}
+BitsetMorphology.negation = function(field, result) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    for (var w = 0, lw = field.length; w < lw; ++w) {
+        result[w] = ~field[w];
+    }
+    // NOTE: bits past the last cell must stay 0, so that "count" and whole word tests stay correct
+    result[field.length-1] &= BitsetMorphology.get_tail_mask(field.grid.vertices.length);
+    return result;
+}
+
+// "count" returns the number of cells that are set within "field"
+BitsetMorphology.count = function(field) {
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    var count = 0;
+    var word = 0;
+    for (var w = 0, lw = field.length; w < lw; ++w) {
+        // population count, see "Bit Twiddling Hacks" by Sean Eron Anderson
+        word = field[w];
+        word = word - ((word >>> 1) & 0x55555555);
+        word = (word & 0x33333333) + ((word >>> 2) & 0x33333333);
+        count += Math.imul((word + (word >>> 4)) & 0x0F0F0F0F, 0x01010101) >>> 24;
+    }
+    return count;
+}
+
+// "dilate_once" sets each cell of "result" that is set in "field", or that neighbors a cell set in "field"
+// Words with no set cells among themselves or their neighbors are left empty, and full words are left full,
+//   so only words near the border of the mask are visited cell by cell.
+BitsetMorphology.dilate_once = function(field, grid, result) {
+    var neighborhood = BitsetMorphology.get_neighborhood(grid);
+    var offsets = neighborhood.offsets;
+    var words = neighborhood.words;
+    var masks = neighborhood.masks;
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var last_word = field.length-1;
+    var cell_count = grid.vertices.length;
+    var tail_mask = BitsetMorphology.get_tail_mask(cell_count);
+    var word = 0;
+    var nearby = 0;
+    var result_word = 0;
+    var neighbor = 0;
+    for (var w = 0; w <= last_word; w++) {
+        word = field[w];
+        nearby = word;
+        for (var j = offsets[w], lj = offsets[w+1]; j < lj; j++) {
+            nearby |= field[words[j]] & masks[j];
+        }
+        if (nearby === 0 || word === (w === last_word? tail_mask : 0xFFFFFFFF)) {
+            result[w] = word;
+            continue;
+        }
+        result_word = word;
+        for (var b = 0, i = w << 5; b < 32 && i < cell_count; b++, i++) {
+            if ((word >>> b) & 1) { continue; }
+            for (var k = arrow_offsets[i], lk = arrow_offsets[i+1]; k < lk; k++) {
+                neighbor = arrow_to[k];
+                if ((field[neighbor >>> 5] >>> (neighbor & 31)) & 1) {
+                    result_word |= 1 << b;
+                    break;
+                }
+            }
+        }
+        result[w] = result_word;
+    }
+}
+// "erode_once" sets each cell of "result" that is set in "field", and whose neighbors are all set in "field"
+// Empty words are left empty, and full words whose neighbors are all set are left full,
+//   so only words near the border of the mask are visited cell by cell.
+BitsetMorphology.erode_once = function(field, grid, result) {
+    var neighborhood = BitsetMorphology.get_neighborhood(grid);
+    var offsets = neighborhood.offsets;
+    var words = neighborhood.words;
+    var masks = neighborhood.masks;
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var last_word = field.length-1;
+    var cell_count = grid.vertices.length;
+    var tail_mask = BitsetMorphology.get_tail_mask(cell_count);
+    var word = 0;
+    var is_surrounded = true;
+    var result_word = 0;
+    var neighbor = 0;
+    for (var w = 0; w <= last_word; w++) {
+        word = field[w];
+        if (word === 0) {
+            result[w] = 0;
+            continue;
+        }
+        if (word === (w === last_word? tail_mask : 0xFFFFFFFF)) {
+            is_surrounded = true;
+            for (var j = offsets[w], lj = offsets[w+1]; j < lj && is_surrounded; j++) {
+                is_surrounded = ((field[words[j]] & masks[j]) >>> 0) === masks[j];
+            }
+            if (is_surrounded) {
+                result[w] = word;
+                continue;
+            }
+        }
+        result_word = word;
+        for (var b = 0, i = w << 5; b < 32 && i < cell_count; b++, i++) {
+            if (((word >>> b) & 1) === 0) { continue; }
+            for (var k = arrow_offsets[i], lk = arrow_offsets[i+1]; k < lk; k++) {
+                neighbor = arrow_to[k];
+                if (((field[neighbor >>> 5] >>> (neighbor & 31)) & 1) === 0) {
+                    result_word &= ~(1 << b);
+                    break;
+                }
+            }
+        }
+        result[w] = result_word;
+    }
+}
+
+BitsetMorphology.dilation = function(field, radius, result, scratch) {
+    radius = radius || 1;
+    result = result || BitsetMorphology.Bitset(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.dilation');
+    scratch = scratch || pool.getBitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    var buffer1 = radius % 2 == 1? result:                 scratch;
+    var buffer2 = radius % 2 == 0? result:                 scratch;
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
+    var temp = buffer1;
+
+    for (var k=0; k<radius; ++k) {
+        BitsetMorphology.dilate_once(buffer2, field.grid, buffer1);
+        temp = buffer1;
+        buffer1 = buffer2;
+        buffer2 = temp;
+    }
+
+    pool.deallocate('BitsetMorphology.dilation');
+    return buffer2;
+}
+BitsetMorphology.erosion = function(field, radius, result, scratch) {
+    radius = radius || 1;
+    result = result || BitsetMorphology.Bitset(field.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.erosion');
+    scratch = scratch || pool.getBitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    var buffer1 = radius % 2 == 1? result:                 scratch;
+    var buffer2 = radius % 2 == 0? result:                 scratch;
+    // NOTE: "buffer2" is read first, so it must start with "field", whichever raster it is
+    buffer2.set(field);
+    var temp = buffer1;
+
+    for (var k=0; k<radius; ++k) {
+        BitsetMorphology.erode_once(buffer2, field.grid, buffer1);
+        temp = buffer1;
+        buffer1 = buffer2;
+        buffer2 = temp;
+    }
+
+    pool.deallocate('BitsetMorphology.erosion');
+    return buffer2;
+}
+
+// see "BinaryMorphology.margin"
+BitsetMorphology.margin = function(field, radius, result, scratch) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - margin() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.margin');
+    scratch = scratch || pool.getBitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    ASSERT_IS_ARRAY(scratch, Uint32Array);
+    var dilation = result; // reuse result raster for performance reasons
+    BitsetMorphology.dilation(field, radius, dilation, scratch);
+    BitsetMorphology.difference(dilation, field, result);
+    pool.deallocate('BitsetMorphology.margin');
+    return result;
+}
+// see "BinaryMorphology.padding"
+BitsetMorphology.padding = function(field, radius, result, scratch) {
+    result = result || BitsetMorphology.Bitset(field.grid);
+    if(field === result) throw ("cannot use same input for 'field' and 'result' - padding() is not an in-place function")
+    var pool = RasterPool.scratchpad;
+    pool.allocate('BitsetMorphology.padding');
+    scratch = scratch || pool.getBitset(field.grid);
+    ASSERT_IS_ARRAY(field, Uint32Array);
+    ASSERT_IS_ARRAY(result, Uint32Array);
+    ASSERT_IS_ARRAY(scratch, Uint32Array);
+    var erosion = result; // reuse result raster for performance reasons
+    BitsetMorphology.erosion(field, radius, erosion, scratch);
+    BitsetMorphology.difference(field, erosion, result);
+    pool.deallocate('BitsetMorphology.padding');
+    return result;
+}
@@ -0,0 +1,12 @@
+
+// "RasterArrayBuffer" returns the buffer that backs a new raster of "grid".
+// If the grid was created with the "is_shared" option, it returns a SharedArrayBuffer, 
+//   so that the raster can be read and written by the workers of a RasterWorkerPool without being copied.
+// Otherwise it returns a plain ArrayBuffer, which is what rasters have always used.
+// Every raster that is created outside a pool passes through here, so this is where allocations are counted, see "RasterPool.is_debugging".
+function RasterArrayBuffer(grid, byte_length) {
+    if (RasterPool.is_debugging) {
+        RasterPool.record_allocation(byte_length);
+    }
+    return grid !== void 0 && grid.is_shared? new SharedArrayBuffer(byte_length) : new ArrayBuffer(byte_length);
+}
@@ -0,0 +1,240 @@
+// RasterGpuKernels runs iterated neighbor stencils, such as many iterations of diffusion, on the gpu using WebGL.
+// Rasters are uploaded to float textures once, iterated by rendering back and forth between two float render targets,
+//   and read back only once every iteration is done, see "diffusion.glsl.c" for how rasters and grids are laid out.
+// It renders using its own context on an offscreen canvas, rather than the context of the view,
+//   so that it never disturbs the state that three.js keeps for its context, and so that it also works within workers.
+// The gpu adds in 32 bit floats, whereas RasterKernels adds in 64 bit floats, so results differ within float precision.
+// If the context can not be created, or can not render to float textures and read them back, nothing changes:
+//   "can_run" returns false, and callers run RasterKernels instead.
+var RasterGpuKernels = {};
+
+// the context, if it loaded
+RasterGpuKernels.gl = void 0;
+RasterGpuKernels.programs = {};
+
+// the number of iterations below which the cost of uploading and reading back rasters exceeds what the gpu saves
+RasterGpuKernels.MIN_ITERATION_COUNT = 4;
+// NOTE: this must match the number of calls to add_neighbor() in "diffusion.glsl.c"
+RasterGpuKernels.MAX_NEIGHBOR_COUNT = 8;
+
+RasterGpuKernels.vertex_shader = `
+#include "precompiled/shaders/compute/quad.glsl.c"
+`;
+RasterGpuKernels.fragment_shaders = {};
+RasterGpuKernels.fragment_shaders.diffusion = `
+#include "precompiled/shaders/compute/diffusion.glsl.c"
+`;
+
+// "load" creates the context and compiles its programs, returning whether it succeeded
+RasterGpuKernels.load = function() {
+    var canvas =
+        typeof OffscreenCanvas !== 'undefined'? new OffscreenCanvas(1, 1) :
+        typeof document !== 'undefined'?        document.createElement('canvas') : void 0;
+    var gl = canvas !== void 0 && canvas.getContext? canvas.getContext('webgl', { antialias: false, depth: false, stencil: false }) : void 0;
+    if (!gl || !gl.getExtension('OES_texture_float')) {
+        return false;
+    }
+    gl.getExtension('WEBGL_color_buffer_float');
+    try {
+        RasterGpuKernels.programs.diffusion = RasterGpuKernels.get_program(gl, RasterGpuKernels.vertex_shader, RasterGpuKernels.fragment_shaders.diffusion);
+    } catch (error) {
+        console.log(error);
+        return false;
+    }
+    if (!RasterGpuKernels.is_float_readable(gl)) {
+        return false;
+    }
+
+    // every program draws the same quad
+    var quad = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, quad);
+    gl.bufferData(gl.ARRAY_BUFFER, new Float32Array([-1,-1, 1,-1, -1,1, 1,1]), gl.STATIC_DRAW);
+    gl.disable(gl.DEPTH_TEST);
+    gl.disable(gl.BLEND);
+
+    RasterGpuKernels.gl = gl;
+    RasterGpuKernels.grid_states = new WeakMap();
+    return true;
+}
+RasterGpuKernels.get_program = function(gl, vertex_source, fragment_source) {
+    function get_shader(type, source) {
+        var shader = gl.createShader(type);
+        gl.shaderSource(shader, source);
+        gl.compileShader(shader);
+        if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+            throw `RasterGpuKernels: could not compile shader: ${gl.getShaderInfoLog(shader)}`;
+        }
+        return shader;
+    }
+    var program = gl.createProgram();
+    gl.attachShader(program, get_shader(gl.VERTEX_SHADER,   vertex_source));
+    gl.attachShader(program, get_shader(gl.FRAGMENT_SHADER, fragment_source));
+    gl.bindAttribLocation(program, 0, 'position');
+    gl.linkProgram(program);
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+        throw `RasterGpuKernels: could not link program: ${gl.getProgramInfoLog(program)}`;
+    }
+    var uniforms = {};
+    for (var i = 0, li = gl.getProgramParameter(program, gl.ACTIVE_UNIFORMS); i < li; i++) {
+        var name = gl.getActiveUniform(program, i).name;
+        uniforms[name] = gl.getUniformLocation(program, name);
+    }
+    return { program: program, uniforms: uniforms };
+}
+// "is_float_readable" indicates whether a float texture can be rendered to, then read back without loss
+// WebGL only guarantees reading back bytes, so this is checked by reading back a value that bytes can not represent.
+RasterGpuKernels.is_float_readable = function(gl) {
+    var target = RasterGpuKernels.get_render_target(gl, 1, 1);
+    var is_readable = gl.checkFramebufferStatus(gl.FRAMEBUFFER) === gl.FRAMEBUFFER_COMPLETE;
+    if (is_readable) {
+        var pixel = new Float32Array(4);
+        gl.clearColor(0.3125, 0, 0, 1);
+        gl.clear(gl.COLOR_BUFFER_BIT);
+        gl.readPixels(0, 0, 1, 1, gl.RGBA, gl.FLOAT, pixel);
+        is_readable = gl.getError() === gl.NO_ERROR && pixel[0] === 0.3125;
+    }
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    gl.deleteFramebuffer(target.framebuffer);
+    gl.deleteTexture(target.texture);
+    return is_readable;
+}
+RasterGpuKernels.get_texture = function(gl, width, height, format, data) {
+    var texture = gl.createTexture();
+    gl.bindTexture(gl.TEXTURE_2D, texture);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    gl.texImage2D(gl.TEXTURE_2D, 0, format, width, height, 0, format, gl.FLOAT, data || null);
+    return texture;
+}
+// "get_render_target" returns an RGBA float texture that is attached to a framebuffer, leaving the framebuffer bound
+RasterGpuKernels.get_render_target = function(gl, width, height) {
+    var texture = RasterGpuKernels.get_texture(gl, width, height, gl.RGBA);
+    var framebuffer = gl.createFramebuffer();
+    gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+    gl.framebufferTexture2D(gl.FRAMEBUFFER, gl.COLOR_ATTACHMENT0, gl.TEXTURE_2D, texture, 0);
+    return { texture: texture, framebuffer: framebuffer };
+}
+
+// "get_texture_width" returns the width of textures for a grid of "cell_count" cells,
+//   a power of two so that ids convert to texels exactly, see "diffusion.glsl.c"
+RasterGpuKernels.get_texture_width = function(cell_count) {
+    return 1 << Math.ceil(Math.log2(Math.max(Math.sqrt(cell_count), 1)));
+}
+// "get_neighbor_ids" returns the ids of the neighbors of each cell of "grid" as laid out in "diffusion.glsl.c",
+//   in the order of "arrow_to", which is the order that RasterKernels.average_difference visits them
+RasterGpuKernels.get_neighbor_ids = function(grid, texel_count) {
+    var arrow_offsets = grid.arrow_offsets;
+    var arrow_to = grid.arrow_to;
+    var MAX_NEIGHBOR_COUNT = RasterGpuKernels.MAX_NEIGHBOR_COUNT;
+    var result = [new Float32Array(4*texel_count).fill(-1), new Float32Array(4*texel_count).fill(-1)];
+    for (var i = 0, li = grid.vertices.length; i < li; i++) {
+        for (var j = arrow_offsets[i], k = 0, lj = arrow_offsets[i+1]; j < lj && k < MAX_NEIGHBOR_COUNT; j++, k++) {
+            result[k >> 2][4*i + (k & 3)] = arrow_to[j];
+        }
+    }
+    return result;
+}
+// "get_grid_state" returns the textures, render targets, and staging arrays for rasters of "grid",
+//   or undefined if the gpu can not run kernels for the grid. States are created on first use, then kept for the life of the grid.
+RasterGpuKernels.get_grid_state = function(grid) {
+    var state = RasterGpuKernels.grid_states.get(grid);
+    if (state !== void 0) {
+        return state || void 0;
+    }
+    var gl = RasterGpuKernels.gl;
+    var cell_count = grid.vertices.length;
+    var width = RasterGpuKernels.get_texture_width(cell_count);
+    var height = Math.ceil(cell_count / width);
+    var max_neighbor_count = 0;
+    for (var i = 0; i < cell_count; i++) {
+        max_neighbor_count = Math.max(max_neighbor_count, grid.neighbor_count[i]);
+    }
+    if (max_neighbor_count > RasterGpuKernels.MAX_NEIGHBOR_COUNT || width > gl.getParameter(gl.MAX_TEXTURE_SIZE)) {
+        RasterGpuKernels.grid_states.set(grid, null);
+        return void 0;
+    }
+    var neighbor_ids = RasterGpuKernels.get_neighbor_ids(grid, width * height);
+    state = {
+        width:                width,
+        height:               height,
+        neighbor_ids_texture0: RasterGpuKernels.get_texture(gl, width, height, gl.RGBA, neighbor_ids[0]),
+        neighbor_ids_texture1: RasterGpuKernels.get_texture(gl, width, height, gl.RGBA, neighbor_ids[1]),
+        field_texture:        RasterGpuKernels.get_texture(gl, width, height, gl.LUMINANCE),
+        diffusivity_texture:  RasterGpuKernels.get_texture(gl, width, height, gl.LUMINANCE),
+        targets:              [RasterGpuKernels.get_render_target(gl, width, height), RasterGpuKernels.get_render_target(gl, width, height)],
+        // rasters are padded to fill whole rows when uploaded, and read back as RGBA
+        upload:               new Float32Array(width * height),
+        readback:             new Float32Array(4 * width * height),
+    };
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    RasterGpuKernels.grid_states.set(grid, state);
+    return state;
+}
+RasterGpuKernels.upload = function(gl, state, texture, raster) {
+    state.upload.set(raster);
+    gl.bindTexture(gl.TEXTURE_2D, texture);
+    gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, state.width, state.height, gl.LUMINANCE, gl.FLOAT, state.upload);
+}
+RasterGpuKernels.read = function(gl, state, framebuffer, result) {
+    var readback = state.readback;
+    gl.bindFramebuffer(gl.FRAMEBUFFER, framebuffer);
+    gl.readPixels(0, 0, state.width, state.height, gl.RGBA, gl.FLOAT, readback);
+    gl.bindFramebuffer(gl.FRAMEBUFFER, null);
+    for (var i = 0, li = result.length; i < li; i++) {
+        result[i] = readback[4*i];
+    }
+}
+
+// "can_run" indicates whether kernels can run on the gpu for rasters of "grid"
+RasterGpuKernels.can_run = function(grid) {
+    var gl = RasterGpuKernels.gl;
+    return gl !== void 0 && !gl.isContextLost() && grid !== void 0 && RasterGpuKernels.get_grid_state(grid) !== void 0;
+}
+// "diffusion" runs "iterations" iterations of ScalarField.diffusion_by_constant,
+//   or of ScalarField.diffusion_by_field if "diffusivity_field" is given, in which case "diffusivity" is ignored.
+// "iterations" must be at least 1, and "result" may be "field".
+RasterGpuKernels.diffusion = function(field, diffusivity, diffusivity_field, iterations, result) {
+    var gl = RasterGpuKernels.gl;
+    var state = RasterGpuKernels.get_grid_state(field.grid);
+    var program = RasterGpuKernels.programs.diffusion;
+    var uniforms = program.uniforms;
+
+    RasterGpuKernels.upload(gl, state, state.field_texture, field);
+    if (diffusivity_field !== void 0) {
+        RasterGpuKernels.upload(gl, state, state.diffusivity_texture, diffusivity_field);
+    }
+
+    gl.useProgram(program.program);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 2, gl.FLOAT, false, 0, 0);
+    gl.viewport(0, 0, state.width, state.height);
+    gl.uniform1i(uniforms.field_texture, 0);
+    gl.uniform1i(uniforms.neighbor_ids_texture0, 1);
+    gl.uniform1i(uniforms.neighbor_ids_texture1, 2);
+    gl.uniform1i(uniforms.diffusivity_texture, 3);
+    gl.uniform1i(uniforms.has_diffusivity_texture, diffusivity_field !== void 0? 1 : 0);
+    gl.uniform1f(uniforms.diffusivity, diffusivity);
+    gl.uniform2f(uniforms.texture_size, state.width, state.height);
+    gl.activeTexture(gl.TEXTURE1);
+    gl.bindTexture(gl.TEXTURE_2D, state.neighbor_ids_texture0);
+    gl.activeTexture(gl.TEXTURE2);
+    gl.bindTexture(gl.TEXTURE_2D, state.neighbor_ids_texture1);
+    gl.activeTexture(gl.TEXTURE3);
+    gl.bindTexture(gl.TEXTURE_2D, state.diffusivity_texture);
+
+    // the first iteration reads the uploaded field, then iterations alternate between render targets
+    var input = state.field_texture;
+    var output = void 0;
+    for (var i = 0; i < iterations; i++) {
+        output = state.targets[i % 2];
+        gl.bindFramebuffer(gl.FRAMEBUFFER, output.framebuffer);
+        gl.activeTexture(gl.TEXTURE0);
+        gl.bindTexture(gl.TEXTURE_2D, input);
+        gl.drawArrays(gl.TRIANGLE_STRIP, 0, 4);
+        input = output.texture;
+    }
+    RasterGpuKernels.read(gl, state, output.framebuffer, result);
+    return result;
+}
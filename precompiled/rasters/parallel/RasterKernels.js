@@ -0,0 +1,286 @@
+
+// The RasterKernels namespace contains the loops of raster operations that can be run in parallel by a RasterWorkerPool.
+// Kernels are called as "kernel(args, grid, start, end)", where:
+//   "args" is an object that only contains typed arrays and numbers, so that it can be posted to workers,
+//   "grid" is either a Grid or a copy of its arrays in shared memory, see "RasterWorkerPool.prototype.get_shared_grid",
+//   "start" and "end" are the range of cells that the kernel must write to.
+// A kernel must only write to cells in [start, end) of its outputs, so that partitions never write to the same cell.
+// Arrow-wise kernels visit the arrows that start from cells within that range, 
+//   which thanks to Grid sorting arrows by the cell they start from, are the arrows within [arrow_offsets[start], arrow_offsets[end]).
+// Raster operations such as ScalarField.laplacian() call kernels through "RasterWorkerPool.run", never directly.
+var RasterKernels = {};
+
+RasterKernels.add_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + b[i];
+  }
+};
+RasterKernels.sub_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] - b[i];
+  }
+};
+RasterKernels.mult_field = function(args, grid, start, end) {
+  var a = args.a, b = args.b, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] * b[i];
+  }
+};
+RasterKernels.add_scalar = function(args, grid, start, end) {
+  var a = args.a, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + scalar;
+  }
+};
+RasterKernels.mult_scalar = function(args, grid, start, end) {
+  var a = args.a, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] * scalar;
+  }
+};
+RasterKernels.add_scalar_term = function(args, grid, start, end) {
+  var a = args.a, b = args.b, scalar = args.scalar, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + scalar * b[i];
+  }
+};
+RasterKernels.add_field_product = function(args, grid, start, end) {
+  var a = args.a, b = args.b, c = args.c, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = a[i] + c[i] * b[i];
+  }
+};
+
+RasterKernels.magnitude = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z, result = args.result;
+  var sqrt = Math.sqrt;
+  var xi = 0., yi = 0., zi = 0.;
+  for (var i = start; i < end; i++) {
+    xi = x[i];
+    yi = y[i];
+    zi = z[i];
+    result[i] = sqrt(xi * xi + yi * yi + zi * zi);
+  }
+};
+RasterKernels.normalize = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z;
+  var ox = args.ox, oy = args.oy, oz = args.oz;
+  var sqrt = Math.sqrt;
+  var xi = 0., yi = 0., zi = 0., mag = 0.;
+  for (var i = start; i < end; i++) {
+    xi = x[i];
+    yi = y[i];
+    zi = z[i];
+    mag = sqrt(xi * xi + yi * yi + zi * zi);
+    ox[i] = xi/(mag||1);
+    oy[i] = yi/(mag||1);
+    oz[i] = zi/(mag||1);
+  }
+};
+
+RasterKernels.clamp = function(args, grid, start, end) {
+  var x = args.x, min_value = args.min_value, max_value = args.max_value, result = args.result;
+  var x_i = 0.;
+  for (var i = start; i < end; i++) {
+    x_i = x[i];
+    result[i] = x_i > max_value? max_value : x_i < min_value? min_value : x_i;
+  }
+};
+RasterKernels.linearstep = function(args, grid, start, end) {
+  var x = args.x, edge0 = args.edge0, result = args.result;
+  var inverse_edge_distance = 1 / (args.edge1 - edge0);
+  var fraction = 0.;
+  for (var i = start; i < end; i++) {
+    fraction = (x[i] - edge0) * inverse_edge_distance;
+    result[i] = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+  }
+};
+RasterKernels.smoothstep = function(args, grid, start, end) {
+  var x = args.x, edge0 = args.edge0, result = args.result;
+  var inverse_edge_distance = 1 / (args.edge1 - edge0);
+  var fraction = 0.;
+  var linearstep = 0.;
+  for (var i = start; i < end; i++) {
+    fraction = (x[i] - edge0) * inverse_edge_distance;
+    linearstep = fraction > 1.0? 1.0 : fraction < 0.0? 0.0 : fraction;
+    result[i] = linearstep*linearstep*(3-2*linearstep);
+  }
+};
+
+// quantization kernels, see "QuantizedRaster"
+RasterKernels.encode_fixed16 = function(args, grid, start, end) {
+  var x = args.x, offset = args.offset, result = args.result;
+  var inverse_scale = 1 / args.scale;
+  var q = 0.;
+  for (var i = start; i < end; i++) {
+    q = Math.round((x[i] - offset) * inverse_scale);
+    // NOTE: NaN fails both comparisons, so it is stored as 0
+    result[i] = q > 65535? 65535 : q > 0? q : 0;
+  }
+};
+RasterKernels.decode_fixed16 = function(args, grid, start, end) {
+  var x = args.x, offset = args.offset, scale = args.scale, result = args.result;
+  for (var i = start; i < end; i++) {
+    result[i] = offset + scale * x[i];
+  }
+};
+// "encode_float16" rounds to the nearest half precision float, with ties to even,
+//   by operating on the bits of each 32 bit float. Magnitudes above 65504 become infinite.
+RasterKernels.encode_float16 = function(args, grid, start, end) {
+  var x = args.x, result = args.result;
+  var float = new Float32Array(1);
+  var bits = new Uint32Array(float.buffer);
+  var b = 0, sign = 0, exponent = 0, mantissa = 0, shift = 0, remainder = 0, halfway = 0, h = 0;
+  for (var i = start; i < end; i++) {
+    float[0] = x[i];
+    b = bits[0];
+    sign = (b >>> 16) & 0x8000;
+    exponent = ((b >>> 23) & 0xff) - 127 + 15;
+    mantissa = b & 0x7fffff;
+    if (exponent === 0xff - 127 + 15) {
+      // infinity, or NaN
+      h = sign | 0x7c00 | (mantissa !== 0? 0x200 : 0);
+    } else if (exponent >= 0x1f) {
+      h = sign | 0x7c00;
+    } else if (exponent <= 0) {
+      // subnormal, or too small to represent
+      if (exponent < -10) {
+        h = sign;
+      } else {
+        mantissa = mantissa | 0x800000;
+        shift = 14 - exponent;
+        h = mantissa >>> shift;
+        remainder = mantissa & ((1 << shift) - 1);
+        halfway = 1 << (shift - 1);
+        if (remainder > halfway || (remainder === halfway && (h & 1))) { h++; }
+        h = sign | h;
+      }
+    } else {
+      h = (exponent << 10) | (mantissa >>> 13);
+      remainder = mantissa & 0x1fff;
+      // NOTE: a carry out of the mantissa correctly increments the exponent, and rounds to infinity past 65504
+      if (remainder > 0x1000 || (remainder === 0x1000 && (h & 1))) { h++; }
+      h = sign | h;
+    }
+    result[i] = h;
+  }
+};
+RasterKernels.decode_float16 = function(args, grid, start, end) {
+  var x = args.x, result = args.result;
+  var float = new Float32Array(1);
+  var bits = new Uint32Array(float.buffer);
+  var h = 0, sign = 0, exponent = 0, mantissa = 0;
+  for (var i = start; i < end; i++) {
+    h = x[i];
+    sign = (h & 0x8000) << 16;
+    exponent = (h >>> 10) & 0x1f;
+    mantissa = h & 0x3ff;
+    if (exponent === 0) {
+      // subnormal, or zero
+      result[i] = (sign? -1 : 1) * mantissa * 5.960464477539063e-8; // 2^-24
+    } else {
+      bits[0] = sign | ((exponent === 0x1f? 0xff : exponent - 15 + 127) << 23) | (mantissa << 13);
+      result[i] = float[0];
+    }
+  }
+};
+
+// arrow-wise kernels
+
+RasterKernels.average_difference = function(args, grid, start, end) {
+  var field = args.field, result = args.result, scale = args.scale;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var field_i = 0.;
+  var sum = 0.;
+  for (var i = start; i < end; i++) {
+    field_i = field[i];
+    sum = 0.;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      sum += field[arrow_to[j]] - field_i;
+    }
+    result[i] = sum / (scale * neighbor_count[i]);
+  }
+};
+RasterKernels.gradient = function(args, grid, start, end) {
+  var field = args.field;
+  var x = args.x, y = args.y, z = args.z;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var dlength = grid.pos_arrow_distances;
+  var dxhat = grid.pos_arrow_differential_normalized.x;
+  var dyhat = grid.pos_arrow_differential_normalized.y;
+  var dzhat = grid.pos_arrow_differential_normalized.z;
+  var average_distance = grid.average_distance;
+  var PI = Math.PI;
+  var inverse_volume = 1 / (PI * (average_distance/2) * (average_distance/2));
+  var difference = 0.;
+  var xi = 0., yi = 0., zi = 0.;
+  for (var i = start; i < end; i++) {
+    xi = 0.;
+    yi = 0.;
+    zi = 0.;
+    // see ScalarField.gradient for why this is weighted the way it is
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      difference = field[arrow_to[j]] - field[i];
+      xi += difference * dxhat[j] * dlength[j]/neighbor_count[i] * PI;
+      yi += difference * dyhat[j] * dlength[j]/neighbor_count[i] * PI;
+      zi += difference * dzhat[j] * dlength[j]/neighbor_count[i] * PI;
+    }
+    x[i] = xi * inverse_volume;
+    y[i] = yi * inverse_volume;
+    z[i] = zi * inverse_volume;
+  }
+};
+RasterKernels.divergence = function(args, grid, start, end) {
+  var x = args.x, y = args.y, z = args.z, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var neighbor_count = grid.neighbor_count;
+  var dlength = grid.pos_arrow_distances;
+  var dxhat = grid.pos_arrow_differential_normalized.x;
+  var dyhat = grid.pos_arrow_differential_normalized.y;
+  var dzhat = grid.pos_arrow_differential_normalized.z;
+  var to = 0;
+  var sum = 0.;
+  for (var i = start; i < end; i++) {
+    sum = 0.;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj; j++) {
+      to = arrow_to[j];
+      sum += ( (x[to] - x[i]) * dxhat[j]   
+              +(y[to] - y[i]) * dyhat[j]   
+              +(z[to] - z[i]) * dzhat[j]) / dlength[j];
+    }
+    result[i] = sum / (neighbor_count[i] || 1);
+  }
+};
+RasterKernels.dilation = function(args, grid, start, end) {
+  var field = args.field, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var result_i = false;
+  for (var i = start; i < end; i++) {
+    result_i = field[i] === 1;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj && !result_i; j++) {
+      result_i = field[arrow_to[j]] === 1;
+    }
+    result[i] = result_i? 1:0;
+  }
+};
+RasterKernels.erosion = function(args, grid, start, end) {
+  var field = args.field, result = args.result;
+  var arrow_offsets = grid.arrow_offsets;
+  var arrow_to = grid.arrow_to;
+  var result_i = true;
+  for (var i = start; i < end; i++) {
+    result_i = field[i] === 1;
+    for (var j = arrow_offsets[i], lj = arrow_offsets[i+1]; j < lj && result_i; j++) {
+      result_i = field[arrow_to[j]] === 1;
+    }
+    result[i] = result_i? 1:0;
+  }
+};
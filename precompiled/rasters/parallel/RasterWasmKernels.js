@@ -0,0 +1,109 @@
+
+// RasterWasmKernels runs a subset of "RasterKernels.js" using "postcompiled/RasterKernels.wasm",
+//   which is built from "precompiled/cpp/raster_kernels.cpp" by "make wasm", using 128 bit SIMD.
+// WebAssembly can only read its own memory, so kernels only run here if every raster they are given
+//   is a Float32Array that lives within that memory. Otherwise, the JS kernel runs instead.
+// Only temporary rasters from the scratchpad ever live there: the fields of models are allocated
+//   by "RasterArrayBuffer" in memory of their own, so operations on them are out of scope, and always run in JS.
+// Once loaded, "RasterStackBuffer.scratchpad" is replaced by a buffer within that memory,
+//   so temporary rasters that are requested from the scratchpad are eligible.
+// A shared scratchpad belongs to a "RasterWorkerPool" instead, so it is never replaced:
+//   the workers can't see the memory of this module, and the pool would stop dispatching to them.
+// The memory is created with a fixed size, so it never grows, and views into it are never detached.
+// If the module fails to load, for instance if the browser does not support SIMD, nothing changes.
+// The module is not committed, since it needs a clang that targets wasm32, so it is only loaded if enabled.
+var RasterWasmKernels = {};
+
+// whether the module should be loaded, which is set under "?wasm", once "make wasm" has built it
+RasterWasmKernels.is_enabled = false;
+
+// the exports of the module, if it has loaded
+RasterWasmKernels.exports = void 0;
+RasterWasmKernels.memory = void 0;
+
+// "load" fetches and instantiates the module, returning a promise that resolves to whether it loaded
+// Failures are silent, since the JS kernels are always there to fall back to.
+// "byte_length" is the size of the scratchpad, and defaults to the size of the scratchpad it replaces
+RasterWasmKernels.load = function(url, byte_length) {
+    url = url || 'postcompiled/RasterKernels.wasm';
+    byte_length = byte_length || RasterStackBuffer.scratchpad.buffer.byteLength;
+    if (typeof WebAssembly === 'undefined' || typeof fetch === 'undefined') {
+        return Promise.resolve(false);
+    }
+    var page_byte_length = 65536;
+    // NOTE: extra pages are reserved for the data and stack of the module, which live below "__heap_base"
+    var page_count = Math.ceil(byte_length / page_byte_length) + 16;
+    var memory = new WebAssembly.Memory({ initial: page_count, maximum: page_count });
+    return fetch(url)
+        .then(function(response) {
+            if (!response.ok) {
+                throw `RasterWasmKernels: could not fetch "${url}"`;
+            }
+            return response.arrayBuffer();
+        })
+        .then(function(bytes) { return WebAssembly.instantiate(bytes, { env: { memory: memory } }); })
+        .then(function(result) {
+            var exports = result.instance.exports;
+            var heap_base = exports.__heap_base !== void 0? exports.__heap_base.value : 0;
+            RasterWasmKernels.exports = exports;
+            RasterWasmKernels.memory = memory;
+            // NOTE: load() resolves between simulation steps, when nothing has been allocated from the scratchpad
+            var scratchpad = RasterStackBuffer.scratchpad;
+            var is_shared = typeof SharedArrayBuffer !== 'undefined' && scratchpad.buffer instanceof SharedArrayBuffer;
+            if (scratchpad.stack.length === 0 && !is_shared) {
+                RasterStackBuffer.scratchpad = RasterStackBuffer.FromArrayBuffer(memory.buffer, heap_base);
+            }
+            return true;
+        })
+        .catch(function() {
+            return false;
+        });
+}
+
+// "adapters" map the "args" of a JS kernel onto the parameters of its export
+// Rasters are passed as byte offsets into memory, followed by the range of cells to write to.
+RasterWasmKernels.adapters = {
+    add_field:         function(e, args, start, end) { e.add_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    sub_field:         function(e, args, start, end) { e.sub_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    mult_field:        function(e, args, start, end) { e.mult_field(args.a.byteOffset, args.b.byteOffset, args.result.byteOffset, start, end); },
+    add_scalar:        function(e, args, start, end) { e.add_scalar(args.a.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    mult_scalar:       function(e, args, start, end) { e.mult_scalar(args.a.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    add_scalar_term:   function(e, args, start, end) { e.add_scalar_term(args.a.byteOffset, args.b.byteOffset, args.scalar, args.result.byteOffset, start, end); },
+    add_field_product: function(e, args, start, end) { e.add_field_product(args.a.byteOffset, args.b.byteOffset, args.c.byteOffset, args.result.byteOffset, start, end); },
+    clamp:             function(e, args, start, end) { e.clamp(args.x.byteOffset, args.min_value, args.max_value, args.result.byteOffset, start, end); },
+    linearstep:        function(e, args, start, end) { e.linearstep(args.x.byteOffset, args.edge0, args.edge1, args.result.byteOffset, start, end); },
+    smoothstep:        function(e, args, start, end) { e.smoothstep(args.x.byteOffset, args.edge0, args.edge1, args.result.byteOffset, start, end); },
+    magnitude:         function(e, args, start, end) { e.magnitude(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.result.byteOffset, start, end); },
+    normalize:         function(e, args, start, end) {
+        e.normalize(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.ox.byteOffset, args.oy.byteOffset, args.oz.byteOffset, start, end);
+    },
+    nearest_cell_ids:  function(e, args, start, end) {
+        e.nearest_cell_ids(args.x.byteOffset, args.y.byteOffset, args.z.byteOffset, args.cell_width, args.dimension_x, args.dimension_y, args.result.byteOffset, start, end);
+    },
+};
+
+// "array_types" lists the arguments of kernels that are typed arrays other than Float32Arrays, along with their types
+RasterWasmKernels.array_types = {
+    nearest_cell_ids: { result: Uint32Array },
+};
+
+// "can_run" indicates whether "kernel_name" has an export, and every typed array in "args" is of its expected type within its memory
+// Typed arrays are expected to be Float32Arrays unless listed in "array_types".
+RasterWasmKernels.can_run = function(kernel_name, args) {
+    if (RasterWasmKernels.exports === void 0 || RasterWasmKernels.exports[kernel_name] === void 0 || RasterWasmKernels.adapters[kernel_name] === void 0) {
+        return false;
+    }
+    var buffer = RasterWasmKernels.memory.buffer;
+    var types = RasterWasmKernels.array_types[kernel_name] || {};
+    var value;
+    for (var key in args) {
+        value = args[key];
+        if (ArrayBuffer.isView(value) && !(value instanceof (types[key] || Float32Array) && value.buffer === buffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+RasterWasmKernels.run = function(kernel_name, args, start, end) {
+    RasterWasmKernels.adapters[kernel_name](RasterWasmKernels.exports, args, start, end);
+}
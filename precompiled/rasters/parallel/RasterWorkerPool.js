@@ -0,0 +1,181 @@
+
+// RasterWorkerPool runs the kernels in "RasterKernels.js" across a pool of Web Workers.
+// Each worker loads "postcompiled/Rasters.js" as its script, so workers share every kernel with the thread that calls them.
+//
+// Work is partitioned into contiguous ranges of cells, one per worker plus one for the calling thread.
+// Arrow-wise kernels visit the arrows that start from cells within their range,
+//   which works because Grid sorts arrows by the cell they start from, so no two partitions ever write to the same cell.
+//
+// Workers only see rasters that are allocated in shared memory, see "RasterArrayBuffer".
+// Grid arrays are copied to shared memory once per grid, see "get_shared_grid".
+// Kernels are dispatched synchronously: the calling thread blocks with Atomics.wait() until every partition is done,
+//   so raster operations keep their signatures and callers never notice whether they ran in parallel.
+// Browsers only allow blocking outside the main thread, so kernels run on the calling thread instead if:
+//   the calling thread is the main thread, no pool was started, workers have yet to load,
+//   the raster is too small to be worth it, or any raster is not in shared memory.
+// Shared memory needs cross origin isolation, so the page must be served with these headers,
+//   or through "CrossOriginIsolationWorker.js" where the host can't send them:
+//   Cross-Origin-Opener-Policy: same-origin
+//   Cross-Origin-Embedder-Policy: require-corp
+// The scratchpad is owned by the pool whenever it is shared, and "RasterWasmKernels.load" leaves it alone.
+function RasterWorkerPool(worker_count, script_url) {
+    script_url = script_url || 'postcompiled/Rasters.js';
+
+    // status[READY_COUNT]:     the number of workers that are ready to run kernels
+    // status[REMAINING_COUNT]: the number of partitions that have yet to finish
+    // status[ERROR_COUNT]:     the number of partitions that threw since the last dispatch
+    this.status = new Int32Array(new SharedArrayBuffer(3 * Int32Array.BYTES_PER_ELEMENT));
+    this.workers = [];
+    for (var i = 0; i < worker_count; i++) {
+        var worker = new Worker(script_url);
+        worker.postMessage({ type: 'raster_worker_init', status: this.status });
+        this.workers.push(worker);
+    }
+    this.shared_grids = new WeakMap();
+}
+RasterWorkerPool.READY_COUNT     = 0;
+RasterWorkerPool.REMAINING_COUNT = 1;
+RasterWorkerPool.ERROR_COUNT     = 2;
+
+// the number of cells below which dispatching to workers costs more than it saves
+RasterWorkerPool.MIN_PARALLEL_LENGTH = 16384;
+
+// the pool that "RasterWorkerPool.run" dispatches to, if any, see "RasterWorkerPool.start"
+RasterWorkerPool.instance = void 0;
+
+// indicates whether the calling thread is allowed to block using Atomics.wait()
+RasterWorkerPool.is_blocking_allowed =
+    typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope &&
+    typeof SharedArrayBuffer !== 'undefined' && typeof Atomics !== 'undefined';
+
+// "start" creates the pool that raster operations dispatch to
+// "worker_count" defaults to one less than the number of logical processors, since the calling thread also takes a partition
+RasterWorkerPool.start = function(worker_count, script_url) {
+    if (RasterWorkerPool.instance !== void 0) {
+        RasterWorkerPool.instance.terminate();
+    }
+    worker_count = worker_count !== void 0? worker_count : Math.max((navigator.hardwareConcurrency || 1) - 1, 1);
+    RasterWorkerPool.instance = new RasterWorkerPool(worker_count, script_url);
+    return RasterWorkerPool.instance;
+}
+
+// "run" is called by raster operations. It runs "RasterKernels[kernel_name]" over cells [0, length),
+//   using the workers of "RasterWorkerPool.instance" if possible, or the calling thread if not.
+// On the calling thread, the WebAssembly version of the kernel is used if it can be, see "RasterWasmKernels.js".
+RasterWorkerPool.run = function(kernel_name, args, grid, length) {
+    var pool = RasterWorkerPool.instance;
+    if (pool !== void 0 &&
+        RasterWorkerPool.is_blocking_allowed &&
+        length >= RasterWorkerPool.MIN_PARALLEL_LENGTH &&
+        pool.is_ready() &&
+        RasterWorkerPool.is_shared(args)) {
+        pool.run(kernel_name, args, grid, length);
+    } else if (RasterWasmKernels.can_run(kernel_name, args)) {
+        RasterWasmKernels.run(kernel_name, args, 0, length);
+    } else {
+        RasterKernels[kernel_name](args, grid, 0, length);
+    }
+}
+// "is_shared" indicates whether every typed array in "args" is backed by shared memory
+RasterWorkerPool.is_shared = function(args) {
+    var value;
+    for (var key in args) {
+        value = args[key];
+        if (ArrayBuffer.isView(value) && !(value.buffer instanceof SharedArrayBuffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RasterWorkerPool.prototype.is_ready = function() {
+    return Atomics.load(this.status, RasterWorkerPool.READY_COUNT) === this.workers.length;
+}
+// "get_shared_grid" returns copies of the arrays of "grid" that kernels need, in shared memory
+// Grid arrays never change once a grid is created, so copies are made only once per grid.
+RasterWorkerPool.prototype.get_shared_grid = function(grid) {
+    var shared_grid = this.shared_grids.get(grid);
+    if (shared_grid !== void 0) {
+        return shared_grid;
+    }
+    function share(array) {
+        var copy = new array.constructor(new SharedArrayBuffer(array.byteLength));
+        copy.set(array);
+        return copy;
+    }
+    shared_grid = {
+        arrow_offsets:       share(grid.arrow_offsets),
+        arrow_from:          share(grid.arrow_from),
+        arrow_to:            share(grid.arrow_to),
+        neighbor_count:      share(grid.neighbor_count),
+        pos_arrow_distances: share(grid.pos_arrow_distances),
+        pos_arrow_differential_normalized: {
+            x: share(grid.pos_arrow_differential_normalized.x),
+            y: share(grid.pos_arrow_differential_normalized.y),
+            z: share(grid.pos_arrow_differential_normalized.z),
+        },
+        average_distance:    grid.average_distance,
+    };
+    this.shared_grids.set(grid, shared_grid);
+    return shared_grid;
+}
+RasterWorkerPool.prototype.run = function(kernel_name, args, grid, length) {
+    var status = this.status;
+    var workers = this.workers;
+    var partition_count = workers.length + 1;
+    var shared_grid = grid !== void 0? this.get_shared_grid(grid) : void 0;
+
+    Atomics.store(status, RasterWorkerPool.ERROR_COUNT, 0);
+    Atomics.store(status, RasterWorkerPool.REMAINING_COUNT, workers.length);
+    for (var i = 0; i < workers.length; i++) {
+        workers[i].postMessage({
+            type:   'raster_kernel',
+            kernel: kernel_name,
+            args:   args,
+            grid:   shared_grid,
+            start:  Math.floor( i    * length / partition_count),
+            end:    Math.floor((i+1) * length / partition_count),
+        });
+    }
+    // the calling thread takes the last partition, while workers handle the rest
+    RasterKernels[kernel_name](args, grid, Math.floor(workers.length * length / partition_count), length);
+
+    var remaining = 0;
+    while ((remaining = Atomics.load(status, RasterWorkerPool.REMAINING_COUNT)) > 0) {
+        Atomics.wait(status, RasterWorkerPool.REMAINING_COUNT, remaining);
+    }
+    if (Atomics.load(status, RasterWorkerPool.ERROR_COUNT) > 0) {
+        throw `RasterWorkerPool: the kernel "${kernel_name}" threw an error within a worker`;
+    }
+}
+RasterWorkerPool.prototype.terminate = function() {
+    for (var i = 0; i < this.workers.length; i++) {
+        this.workers[i].terminate();
+    }
+    this.workers = [];
+}
+
+// if this script is running within a worker, it can be used as a worker of a RasterWorkerPool
+if (typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope) {
+    (function() {
+        var status = void 0;
+        self.addEventListener('message', function(event) {
+            var message = event.data;
+            if (message.type === 'raster_worker_init') {
+                status = message.status;
+                Atomics.add(status, RasterWorkerPool.READY_COUNT, 1);
+            } else if (message.type === 'raster_kernel') {
+                try {
+                    RasterKernels[message.kernel](message.args, message.grid, message.start, message.end);
+                } catch (error) {
+                    Atomics.add(status, RasterWorkerPool.ERROR_COUNT, 1);
+                    throw error;
+                } finally {
+                    if (Atomics.sub(status, RasterWorkerPool.REMAINING_COUNT, 1) === 1) {
+                        Atomics.notify(status, RasterWorkerPool.REMAINING_COUNT);
+                    }
+                }
+            }
+        });
+    })();
+}
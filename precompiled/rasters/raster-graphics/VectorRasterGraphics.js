@@ -6,7 +6,13 @@ var VectorRasterGraphics = {};
 
 VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, start_id, mask, result, scratch_ui8) {
     result = result || Uint8Raster(vector_raster.grid);
-    scratch_ui8 = scratch_ui8 || Uint8Raster(vector_raster.grid);
+    var pool = RasterPool.scratchpad;
+    pool.allocate('VectorRasterGraphics.magic_wand_select');
+    if (!scratch_ui8) {
+        // rasters from the pool are not cleared, unlike new rasters
+        scratch_ui8 = pool.getUint8Raster(vector_raster.grid);
+        Uint8Raster.fill(scratch_ui8, 0);
+    }
     
     ASSERT_IS_VECTOR_RASTER(vector_raster)
     ASSERT_IS_TYPE(start_id, number)
@@ -14,7 +20,8 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
     ASSERT_IS_ARRAY(result, Uint8Array)
 
     Uint8Raster.fill(result, 0);
-    var neighbor_lookup = vector_raster.grid.neighbor_lookup;
+    var arrow_offsets = vector_raster.grid.arrow_offsets;
+    var arrow_to = vector_raster.grid.arrow_to;
     var similarity = Vector.similarity;
     var magnitude = Vector.magnitude;
 
@@ -30,7 +37,6 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
 
     var id = 0;
     var neighbor_id = 0;
-    var neighbors = [];
     var is_similar = 0;
     var threshold = Math.cos(Math.PI * 60/180);
 
@@ -46,9 +52,8 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
         if (is_similar) {
             grouped[id] = 1;
 
-            neighbors = neighbor_lookup[id];
-            for (var i=0, li=neighbors.length; i<li; ++i) {
-                neighbor_id = neighbors[i];
+            for (var i=arrow_offsets[id], li=arrow_offsets[id+1]; i<li; ++i) {
+                neighbor_id = arrow_to[i];
                 if (searched[neighbor_id] === 0 && mask[id] != 0) {
                     searching.push(neighbor_id);
                     searched[neighbor_id] = 1;
@@ -57,6 +62,7 @@ VectorRasterGraphics.magic_wand_select = function function_name(vector_raster, s
         }
     }
 
+    pool.deallocate('VectorRasterGraphics.magic_wand_select');
     return result;
 }
 
@@ -16,7 +16,7 @@
 // I want raster objects to be as bare as possible, functioning more like primitive datatypes.
 
 function Float32Raster(grid, fill) {
-    var result = new Float32Array(grid.vertices.length);
+    var result = new Float32Array(RasterArrayBuffer(grid, grid.vertices.length * Float32Array.BYTES_PER_ELEMENT));
     result.grid = grid;
     if (fill !== void 0) { 
     result.fill(fill);
@@ -25,19 +25,19 @@ function Float32Raster(grid, fill) {
 };
 Float32Raster.FromExample = function(raster) {
   var length = 0; 
-  if (raster instanceof Float32Array || raster instanceof Uint8Array || raster instanceof Uint16Array) { 
+  if (raster instanceof Float32Array || raster instanceof Uint8Array || raster instanceof Uint16Array || raster instanceof Uint32Array) { 
     length = raster.length; 
   } else if(raster !== void 0 && raster.x instanceof Float32Array) { 
     length = raster.x.length; 
   } else { 
     throw 'must supply a vector or scalar raster' 
   } 
-  var result = new Float32Array(length);
+  var result = new Float32Array(RasterArrayBuffer(raster.grid, length * Float32Array.BYTES_PER_ELEMENT));
   result.grid = raster.grid;
   return result;
 }
 Float32Raster.OfLength = function(length, grid) {
-  var result = new Float32Array(length);
+  var result = new Float32Array(RasterArrayBuffer(grid, length * Float32Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   return result;
 }
@@ -70,6 +70,22 @@ Float32Raster.FromUint16Raster = function(raster, result) {
   }
   return result;
 }
+Float32Raster.FromUint32Raster = function(raster, result) {
+  var result = result || Float32Raster(raster.grid);
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  ASSERT_IS_ARRAY(result, Float32Array)
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = raster[i];
+  }
+  return result;
+}
+// "FromIdRaster" converts a raster that was created by "Grid.prototype.createIdRaster", 
+//   which may be either a Uint16Raster or a Uint32Raster depending on the size of the grid
+Float32Raster.FromIdRaster = function(raster, result) {
+  return raster instanceof Uint32Array? 
+    Float32Raster.FromUint32Raster(raster, result) : 
+    Float32Raster.FromUint16Raster(raster, result);
+}
 Float32Raster.copy = function(raster, result) {
   var result = result || Float32Raster(raster.grid);
   ASSERT_IS_ARRAY(raster, Float32Array)
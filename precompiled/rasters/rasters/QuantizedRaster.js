@@ -0,0 +1,106 @@
+// QuantizedRaster represents a grid where each cell contains a value that is stored in 16 bits rather than 32
+// It is a Uint16Array with a "grid", like Uint16Raster, along with the "encoding" of its values:
+//    "fixed16" stores "offset + scale * q" for an integer q in [0, 65535],
+//      so it suits fields of known range, such as coverage fractions in [0,1], where it resolves steps of (max-min)/65535
+//    "float16" stores an IEEE 754 half precision float, with "offset" and "scale" left at 0 and 1,
+//      so it suits fields of unknown range that only need 3 significant figures. It can not represent magnitudes above 65504.
+//
+// QuantizedRasters only store values: raster operations never read them directly.
+// They are decoded into a Float32Raster before use ("decode"), and encoded from one once a result is known ("encode"),
+//   e.g. within a pooled scope, see "RasterPool":
+//
+//   var field = QuantizedRaster.decode(quantized, pool.getFloat32Raster(grid));
+//   ScalarField.diffusion_by_constant(field, 1, field);
+//   QuantizedRaster.encode(field, quantized);
+//
+// Values that fall outside the range of a "fixed16" raster are clamped, and NaN is stored as "offset".
+// NOTE: there is no quantized equivalent of VectorRaster, since vector fields are either normalized or used in full precision
+function QuantizedRaster(grid, encoding, min, max) {
+    var result = new Uint16Array(RasterArrayBuffer(grid, grid.vertices.length * Uint16Array.BYTES_PER_ELEMENT));
+    return QuantizedRaster.describe(result, grid, encoding, min, max);
+};
+QuantizedRaster.Fixed16 = function(grid, min, max) {
+    return QuantizedRaster(grid, 'fixed16', min, max);
+}
+QuantizedRaster.Float16 = function(grid) {
+    return QuantizedRaster(grid, 'float16');
+}
+// "describe" attaches "grid" and an encoding to "array", a Uint16Array, see "QuantizedRaster"
+QuantizedRaster.describe = function(array, grid, encoding, min, max) {
+    if (encoding === 'fixed16') {
+        if (!(max > min)) {
+            throw `a fixed16 raster requires a range where max > min, but min is ${min} and max is ${max}`;
+        }
+        array.offset = min;
+        array.scale = (max - min) / QuantizedRaster.FIXED16_MAX;
+    } else if (encoding === 'float16') {
+        array.offset = 0;
+        array.scale = 1;
+    } else {
+        throw `unsupported quantized raster encoding: ${encoding}`;
+    }
+    array.grid = grid;
+    array.encoding = encoding;
+    return array;
+}
+QuantizedRaster.FIXED16_MAX = 65535;
+// "FromExample" returns a new raster with the same grid and encoding as "raster"
+QuantizedRaster.FromExample = function(raster) {
+    var result = new Uint16Array(RasterArrayBuffer(raster.grid, raster.length * Uint16Array.BYTES_PER_ELEMENT));
+    result.grid = raster.grid;
+    result.encoding = raster.encoding;
+    result.offset = raster.offset;
+    result.scale = raster.scale;
+    return result;
+}
+QuantizedRaster.FromBuffer = function(buffer, grid, start, encoding, min, max) {
+    start = start || 0;
+    var result = new Uint16Array(buffer, start, grid.vertices.length);
+    return QuantizedRaster.describe(result, grid, encoding, min, max);
+}
+// "getParameters" returns what's needed to recreate "raster" with "FromParameters",
+//   including its values as an ArrayBuffer, so they are stored at 2 bytes per cell by BinarySerializer and JsonSerializer,
+//   e.g. for the coverage fractions of "JsonSerializer.render_state"
+QuantizedRaster.getParameters = function(raster) {
+    return {
+        encoding:   raster.encoding,
+        offset:     raster.offset,
+        scale:      raster.scale,
+        buffer:     raster.slice(0).buffer,
+    };
+}
+QuantizedRaster.FromParameters = function(parameters, grid) {
+    var result = new Uint16Array(parameters.buffer, 0, grid.vertices.length);
+    result.grid = grid;
+    result.encoding = parameters.encoding;
+    result.offset = parameters.offset;
+    result.scale = parameters.scale;
+    return result;
+}
+// "encode" stores the values of "raster", a Float32Raster, in "result", which must be a QuantizedRaster
+QuantizedRaster.encode = function(raster, result) {
+    ASSERT_IS_ARRAY(raster, Float32Array)
+    ASSERT_IS_ARRAY(result, Uint16Array)
+    if (result.encoding === 'fixed16') {
+        RasterWorkerPool.run('encode_fixed16', { x: raster, offset: result.offset, scale: result.scale, result: result }, void 0, raster.length);
+    } else if (result.encoding === 'float16') {
+        RasterWorkerPool.run('encode_float16', { x: raster, result: result }, void 0, raster.length);
+    } else {
+        throw `unsupported quantized raster encoding: ${result.encoding}`;
+    }
+    return result;
+}
+// "decode" returns the values of "raster", a QuantizedRaster, as a Float32Raster
+QuantizedRaster.decode = function(raster, result) {
+    ASSERT_IS_ARRAY(raster, Uint16Array)
+    result = result || Float32Raster(raster.grid);
+    ASSERT_IS_ARRAY(result, Float32Array)
+    if (raster.encoding === 'fixed16') {
+        RasterWorkerPool.run('decode_fixed16', { x: raster, offset: raster.offset, scale: raster.scale, result: result }, void 0, raster.length);
+    } else if (raster.encoding === 'float16') {
+        RasterWorkerPool.run('decode_float16', { x: raster, result: result }, void 0, raster.length);
+    } else {
+        throw `unsupported quantized raster encoding: ${raster.encoding}`;
+    }
+    return result;
+}
@@ -0,0 +1,96 @@
+// Uint32Raster represents a grid where each cell contains a 32 bit unsigned integer
+// Uint32Rasters are mostly used to store ids of cells within grids that have too many vertices to be indexed by a Uint16Raster.
+// Use "Grid.prototype.createIdRaster" if you need to store cell ids, since it picks whichever of the two a grid needs.
+// 
+// Like other rasters, operations on Uint32Rasters are spread out as friend functions across several namespaces.
+// Only the operations that are needed to store and look up cell ids are implemented here.
+
+function Uint32Raster(grid, fill) {
+  var result = new Uint32Array(grid.vertices.length);
+  result.grid = grid;
+  if (fill !== void 0) { 
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = fill;
+  }
+  }
+  return result;
+};
+Uint32Raster.OfLength = function(length, grid) {
+  var result = new Uint32Array(length);
+  result.grid = grid;
+  return result;
+}
+Uint32Raster.FromBuffer = function(buffer, grid) {
+  var result = new Uint32Array(buffer, 0, grid.vertices.length);
+  result.grid = grid;
+  return result;
+}
+Uint32Raster.FromUint16Raster = function(raster) {
+  var result = Uint32Raster(raster.grid);
+  for (var i=0, li=result.length; i<li; ++i) {
+      result[i] = raster[i];
+  }
+  return result;
+}
+Uint32Raster.copy = function(raster, result) {
+  var result = result || Uint32Raster(raster.grid);
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  ASSERT_IS_ARRAY(result, Uint32Array)
+  result.set(raster);
+  return result;
+}
+Uint32Raster.fill = function (raster, value) {
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  raster.fill(value);
+};
+
+Uint32Raster.get_nearest_value = function(raster, pos) {
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  return raster[raster.grid.getNearestId(pos)];
+}
+Uint32Raster.get_nearest_values = function(value_raster, pos_raster, result) {
+  result = result || Uint32Raster(pos_raster.grid);
+  ASSERT_IS_ARRAY(value_raster, Uint32Array)
+  ASSERT_IS_VECTOR_RASTER(pos_raster)
+  ASSERT_IS_ARRAY(result, Uint32Array)
+  var ids = pos_raster.grid.getNearestIds(pos_raster);
+  for (var i=0, li=ids.length; i<li; ++i) {
+      result[i] = value_raster[ids[i]];
+  }
+  return result;
+}
+Uint32Raster.get_ids = function(value_raster, id_array, result) {
+  result = result || (id_array.grid !== void 0? Uint32Raster(id_array.grid) : Uint32Array(id_array.length));
+  ASSERT_IS_ARRAY(value_raster, Uint32Array)
+  ASSERT_IS_ARRAY(result, Uint32Array)
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      result[i] = value_raster[id_array[i]];
+  }
+  return result;
+}
+Uint32Raster.get_mask = function(raster, mask) {
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  ASSERT_IS_ARRAY(mask, Uint8Array)
+  var result = new Uint32Array(Uint8Dataset.sum(mask));
+  for (var i = 0, j = 0, li = mask.length; i < li; i++) {
+    if (mask[i] > 0) {
+      result[j] = raster[i];
+      j++;
+    }
+  }
+  return result;
+}
+Uint32Raster.set_ids_to_value = function(raster, id_array, value) {
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      raster[id_array[i]] = value;
+  }
+  return raster;
+}
+Uint32Raster.set_ids_to_values = function(raster, id_array, value_array) {
+  ASSERT_IS_ARRAY(raster, Uint32Array)
+  for (var i=0, li=id_array.length; i<li; ++i) {
+      raster[id_array[i]] = value_array[i];
+  }
+  return raster;
+}
@@ -16,7 +16,7 @@
 // I want raster objects to be as bare as possible, functioning more like primitive datatypes.
 
 function Uint8Raster(grid, fill) {
-  var result = new Uint8Array(grid.vertices.length);
+  var result = new Uint8Array(RasterArrayBuffer(grid, grid.vertices.length * Uint8Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   if (fill !== void 0) { 
   for (var i=0, li=result.length; i<li; ++i) {
@@ -26,7 +26,7 @@ function Uint8Raster(grid, fill) {
   return result;
 };
 Uint8Raster.OfLength = function(length, grid) {
-  var result = new Uint8Array(length);
+  var result = new Uint8Array(RasterArrayBuffer(grid, length * Uint8Array.BYTES_PER_ELEMENT));
   result.grid = grid;
   return result;
 }
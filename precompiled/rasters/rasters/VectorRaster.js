@@ -19,7 +19,7 @@ function VectorRaster(grid) {
   return VectorRaster.OfLength(grid.vertices.length, grid);
 }
 VectorRaster.OfLength = function(length, grid) {
-  var buffer = new ArrayBuffer(3 * Float32Array.BYTES_PER_ELEMENT * length);
+  var buffer = RasterArrayBuffer(grid, 3 * Float32Array.BYTES_PER_ELEMENT * length);
 
   return {
     x: new Float32Array(buffer, 0 * Float32Array.BYTES_PER_ELEMENT * length, length),
@@ -0,0 +1,55 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+
+// "diffusion.glsl.c" runs one iteration of the diffusion equation over the cells of a grid, see RasterGpuKernels.js.
+// It matches ScalarField.diffusion_by_constant, or ScalarField.diffusion_by_field if "has_diffusivity_texture" is set.
+// Rasters are stored in float textures with one cell per texel, in order of cell id, 
+//   in rows that are "texture_size.x" texels wide. Only the red channel is used.
+// The ids of the neighbors of each cell are stored in the same order, four per texel across two textures,
+//   where missing neighbors are given an id of -1.
+
+precision highp float;
+
+uniform sampler2D field_texture;
+uniform sampler2D neighbor_ids_texture0;
+uniform sampler2D neighbor_ids_texture1;
+uniform sampler2D diffusivity_texture;
+uniform bool      has_diffusivity_texture;
+uniform float     diffusivity;
+uniform vec2      texture_size;
+
+// NOTE: "texture_size.x" is a power of two, so division and floor() are exact for any id below 2^24
+FUNC(float) get_field_value(IN(float) id) {
+    VAR(float) row = floor(id / texture_size.x);
+    VAR(vec2) texel = vec2(id - row * texture_size.x, row);
+    return texture2D(field_texture, (texel + 0.5) / texture_size).r;
+}
+FUNC(void) add_neighbor(IN(float) id, IN(float) field_i, INOUT(float) sum, INOUT(float) neighbor_count) {
+    if (id >= 0.) {
+        sum += get_field_value(id) - field_i;
+        neighbor_count += 1.;
+    }
+}
+
+void main() {
+    VAR(vec2) uv = gl_FragCoord.xy / texture_size;
+    VAR(float) field_i = texture2D(field_texture, uv).r;
+    VAR(vec4) ids0 = texture2D(neighbor_ids_texture0, uv);
+    VAR(vec4) ids1 = texture2D(neighbor_ids_texture1, uv);
+
+    VAR(float) sum = 0.;
+    VAR(float) neighbor_count = 0.;
+    add_neighbor(ids0.x, field_i, sum, neighbor_count);
+    add_neighbor(ids0.y, field_i, sum, neighbor_count);
+    add_neighbor(ids0.z, field_i, sum, neighbor_count);
+    add_neighbor(ids0.w, field_i, sum, neighbor_count);
+    add_neighbor(ids1.x, field_i, sum, neighbor_count);
+    add_neighbor(ids1.y, field_i, sum, neighbor_count);
+    add_neighbor(ids1.z, field_i, sum, neighbor_count);
+    add_neighbor(ids1.w, field_i, sum, neighbor_count);
+
+    // see RasterKernels.average_difference
+    VAR(float) laplacian = sum / max(neighbor_count, 1.);
+    VAR(float) k = has_diffusivity_texture? texture2D(diffusivity_texture, uv).r : diffusivity;
+    gl_FragColor = vec4(field_i + k * laplacian, 0., 0., 1.);
+}
@@ -0,0 +1,8 @@
+// "quad.glsl.c" covers the render target of a compute shader with a quad whose corners are given in clip space,
+//   see RasterGpuKernels.js. Compute shaders find which texel they are writing from gl_FragCoord, so nothing is passed on.
+
+attribute vec2 position;
+
+void main() {
+    gl_Position = vec4(position, 0., 1.);
+}
@@ -0,0 +1,37 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+
+// "air_column_density_lut.glsl.c" builds the lookup table that's described in "raymarching.glsl.c".
+// It is rendered once to a float render target whose dimensions are 
+//   AIR_COLUMN_DENSITY_LUT_WIDTH x AIR_COLUMN_DENSITY_LUT_HEIGHT, 
+//   and again only when the world radius or atmosphere scale height changes.
+
+varying vec2  vUv;
+
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius;
+
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+
+void main() {
+    float r = world_radius;
+    float H = atmosphere_scale_height;
+
+    vec2  ray        = get_air_column_density_lut_ray(vUv, r, H);
+    float R          = r + ray.x;
+    float cos_zenith = ray.y;
+
+    // NOTE: "3.*r" is the same distance used to represent space for light rays, see "raymarching.glsl.c"
+    float sigma = approx_air_column_density_ratio_along_2d_ray_for_curved_world(
+        R * cos_zenith, 3.*r, R*R*(1.-cos_zenith*cos_zenith), r, H
+    );
+
+    gl_FragColor = vec4(sigma);
+}
@@ -26,6 +26,7 @@ uniform mat4  projection_matrix_inverse;
 uniform mat4  view_matrix_inverse;
 uniform float reference_distance;
 uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
 
 // WORLD PROPERTIES ------------------------------------------------------------
 uniform vec3  world_position;
@@ -82,7 +83,12 @@ void main() {
     vec3  view_origin    = view_matrix_inverse[3].xyz * reference_distance;
 
     vec4  background_rgb_signal    = texture2D( background_rgb_signal_texture, vUv );
+#ifdef HDR_RENDER_TARGET
+    // NOTE: float render targets store intensities linearly, there is no signal to decode
+    vec3  background_rgb_intensity = insolation_max * background_rgb_signal.rgb;
+#else
     vec3  background_rgb_intensity = insolation_max * get_rgb_intensity_of_rgb_signal(background_rgb_signal.rgb);
+#endif
         
     // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
     vec3  beta_ray = surface_air_rayleigh_scattering_coefficients;
@@ -103,11 +109,11 @@ void main() {
 
     rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
 
-    // TODO: move this to a separate shader pass!
-    // see https://learnopengl.com/Advanced-Lighting/HDR for an intro to tone mapping
-    float exposure_intensity = 150.; // Watts/m^2
-    vec3  ldr_tone_map = 1.0 - exp(-rgb_intensity/exposure_intensity);
-
-    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(ldr_tone_map), 1);
+#ifdef HDR_RENDER_TARGET
+    // NOTE: intensities are written linearly to a float render target, they are tone mapped by "tone_mapping.glsl.c"
+    gl_FragColor = vec4(rgb_intensity, 1);
+#else
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure_intensity)), 1);
+#endif
     // gl_FragColor = 3.*background_rgb_signal;
 }
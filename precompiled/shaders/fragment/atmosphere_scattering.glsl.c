@@ -0,0 +1,75 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/emission.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/physics/reflectance.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+#include "precompiled/academics/psychophysics.glsl.c"
+#include "precompiled/academics/electronics.glsl.c"
+
+// "atmosphere_scattering" is the first half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It renders the intensity of light that's scattered towards the viewer by the atmosphere, without any light from the background,
+//   and stores whether the view ray is obstructed by the world in the alpha channel.
+// It is meant to be rendered to a float texture that's smaller than the screen, 
+//   and is then upsampled by "atmosphere_upsampling.glsl.c".
+
+varying vec2  vUv;
+
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4  projection_matrix_inverse;
+uniform mat4  view_matrix_inverse;
+uniform float reference_distance;
+
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3  world_position;
+uniform float world_radius;
+
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform vec3  light_rgb_intensities [MAX_LIGHT_COUNT];
+uniform vec3  light_directions      [MAX_LIGHT_COUNT];
+uniform int   light_count;
+
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3  surface_air_rayleigh_scattering_coefficients; 
+uniform vec3  surface_air_mie_scattering_coefficients; 
+uniform vec3  surface_air_absorption_coefficients; 
+
+void main() {
+    vec2  screenspace   = vUv;
+    vec2  clipspace     = 2.0 * screenspace - 1.0;
+    vec3  view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3  view_origin    = view_matrix_inverse[3].xyz * reference_distance;
+
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3  beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3  beta_mie = surface_air_mie_scattering_coefficients;
+    vec3  beta_abs = surface_air_absorption_coefficients; 
+
+    vec3 rgb_intensity = 
+        get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+            view_origin,    view_direction,
+            world_position, world_radius,
+            light_directions,      // rgb vectors indicating intensities of light sources
+            light_rgb_intensities, // unit vectors indicating directions to light sources
+            light_count,
+            vec3(0),               // background light is added back after upsampling
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+
+    // the silhouette of the world, which is used to weigh samples during upsampling
+    vec3  P   = view_origin - world_position;
+    float xv  = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool  is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+
+    gl_FragColor = vec4(rgb_intensity, is_obstructed? 1. : 0.);
+}
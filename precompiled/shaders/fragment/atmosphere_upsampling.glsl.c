@@ -0,0 +1,121 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/emission.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/physics/reflectance.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+#include "precompiled/academics/psychophysics.glsl.c"
+#include "precompiled/academics/electronics.glsl.c"
+
+// "atmosphere_upsampling" is the second half of a reduced resolution alternative to "atmosphere.glsl.c",
+//   see ReducedResolutionAtmospherePass.js for how it's used.
+// It upsamples the light that was scattered by the atmosphere in "atmosphere_scattering.glsl.c",
+//   then adds light from the background that's transmitted through the atmosphere, which is cheap enough to find for every pixel.
+// Scattered light changes suddenly across the silhouette of the world, so upsampling is bilateral:
+//   of the four nearest texels, those that disagree with the pixel on whether the world obstructs the view are given little weight.
+// The result matches "atmosphere.glsl.c" everywhere but the silhouette.
+
+varying vec2  vUv;
+uniform sampler2D background_rgb_signal_texture;
+uniform sampler2D scattering_texture;
+uniform vec2      scattering_texture_size;
+
+// VIEW PROPERTIES -----------------------------------------------------------
+uniform mat4  projection_matrix_inverse;
+uniform mat4  view_matrix_inverse;
+uniform float reference_distance;
+uniform float shaderpass_visibility;
+uniform float exposure_intensity; // Watts/m^2, only used if not rendering to a float render target
+
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform vec3  world_position;
+uniform float world_radius;
+
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3  surface_air_rayleigh_scattering_coefficients; 
+uniform vec3  surface_air_mie_scattering_coefficients; 
+uniform vec3  surface_air_absorption_coefficients; 
+
+// "get_weight_of_scattering_sample" returns the weight of a texel from "scattering_texture", 
+//   given its bilinear weight and whether it agrees with the pixel on obstruction.
+// NOTE: weights are never zero, so the sum of weights is never zero
+float get_weight_of_scattering_sample(float bilinear_weight, float sample_obstruction, float pixel_obstruction)
+{
+    return bilinear_weight * mix(1., 1e-3, abs(sample_obstruction - pixel_obstruction));
+}
+
+vec3 get_rgb_intensity_of_upsampled_scattering(vec2 screenspace, float pixel_obstruction)
+{
+    // NOTE: "scattering_texture" uses nearest filtering, so we can interpolate texels ourselves
+    vec2  texel = screenspace * scattering_texture_size - 0.5;
+    vec2  f     = fract(texel);
+    vec2  uv00  = (floor(texel) + 0.5) / scattering_texture_size;
+    vec2  du    = vec2(1./scattering_texture_size.x, 0.);
+    vec2  dv    = vec2(0., 1./scattering_texture_size.y);
+
+    vec4  s00 = texture2D(scattering_texture, uv00          );
+    vec4  s10 = texture2D(scattering_texture, uv00 + du     );
+    vec4  s01 = texture2D(scattering_texture, uv00      + dv);
+    vec4  s11 = texture2D(scattering_texture, uv00 + du + dv);
+
+    float w00 = get_weight_of_scattering_sample((1.-f.x)*(1.-f.y), s00.a, pixel_obstruction);
+    float w10 = get_weight_of_scattering_sample((   f.x)*(1.-f.y), s10.a, pixel_obstruction);
+    float w01 = get_weight_of_scattering_sample((1.-f.x)*(   f.y), s01.a, pixel_obstruction);
+    float w11 = get_weight_of_scattering_sample((   f.x)*(   f.y), s11.a, pixel_obstruction);
+
+    return (s00.rgb*w00 + s10.rgb*w10 + s01.rgb*w01 + s11.rgb*w11) / (w00 + w10 + w01 + w11);
+}
+
+void main() {
+    vec2  screenspace   = vUv;
+    vec2  clipspace     = 2.0 * screenspace - 1.0;
+    vec3  view_direction = normalize(view_matrix_inverse * projection_matrix_inverse * vec4(clipspace, 1, 1)).xyz;
+    vec3  view_origin    = view_matrix_inverse[3].xyz * reference_distance;
+
+    vec4  background_rgb_signal    = texture2D( background_rgb_signal_texture, vUv );
+#ifdef HDR_RENDER_TARGET
+    // NOTE: float render targets store intensities linearly, there is no signal to decode
+    vec3  background_rgb_intensity = insolation_max * background_rgb_signal.rgb;
+#else
+    vec3  background_rgb_intensity = insolation_max * get_rgb_intensity_of_rgb_signal(background_rgb_signal.rgb);
+#endif
+
+    // "beta_air_*" variables are the scattering coefficients for the atmosphere at sea level
+    vec3  beta_ray = surface_air_rayleigh_scattering_coefficients;
+    vec3  beta_mie = surface_air_mie_scattering_coefficients;
+    vec3  beta_abs = surface_air_absorption_coefficients; 
+
+    vec3  P   = view_origin - world_position;
+    float xv  = dot(-P, view_direction);
+    float zv2 = dot( P, P) - xv * xv;
+    float xv_in_world;
+    float xv_out_world;
+    bool  is_obstructed = try_get_relation_between_ray_and_sphere(world_radius, zv2, xv, xv_in_world, xv_out_world);
+
+    vec3 rgb_intensity = 
+        get_rgb_intensity_of_upsampled_scattering(screenspace, is_obstructed? 1. : 0.) +
+        background_rgb_intensity *
+        get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+            view_origin,    view_direction,
+            world_position, world_radius,
+            atmosphere_scale_height,
+            beta_ray, beta_mie, beta_abs
+        );
+
+    rgb_intensity = mix(background_rgb_intensity, rgb_intensity, shaderpass_visibility);
+
+#ifdef HDR_RENDER_TARGET
+    // NOTE: intensities are written linearly to a float render target, they are tone mapped by "tone_mapping.glsl.c"
+    gl_FragColor = vec4(rgb_intensity, 1);
+#else
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure_intensity)), 1);
+#endif
+}
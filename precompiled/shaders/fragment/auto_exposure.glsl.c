@@ -0,0 +1,40 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/psychophysics.glsl.c"
+
+// "auto_exposure" renders a 1x1 float texture whose red channel is the exposure intensity for "tone_mapping.glsl.c",
+//   see ToneMappingPass.js for how it's used.
+// The average luminance of the scene is found as a geometric mean over a coarse grid of samples,
+//   so that a small bright light source does not darken the rest of the scene.
+// Exposure adapts gradually towards that of the average, the way an eye does, 
+//   so it reads the exposure of the previous frame from "previous_exposure_texture".
+
+uniform sampler2D input_texture;
+uniform sampler2D previous_exposure_texture;
+uniform float     adaptation_rate;         // fraction of the difference in exposure that's closed each frame
+uniform float     min_exposure_intensity;  // Watts/m^2
+uniform float     max_exposure_intensity;  // Watts/m^2
+
+void main() {
+    CONST(float) SAMPLE_COUNT = 8.; // number of samples taken along each axis, for a total of SAMPLE_COUNT^2
+
+    float log_luminance_sum = 0.;
+    for (float i = 0.; i < SAMPLE_COUNT; ++i)
+    {
+        for (float j = 0.; j < SAMPLE_COUNT; ++j)
+        {
+            vec3 rgb_intensity = texture2D( input_texture, (vec2(i, j) + 0.5) / SAMPLE_COUNT ).rgb;
+            // NOTE: luminance is offset so the log of a black sample is finite
+            log_luminance_sum += log(get_luminance_of_rgb_intensity(rgb_intensity) + 1e-4);
+        }
+    }
+    float average_luminance = exp(log_luminance_sum / (SAMPLE_COUNT*SAMPLE_COUNT));
+    float target_exposure   = clamp(get_exposure_intensity_of_average_luminance(average_luminance), 
+                                    min_exposure_intensity, max_exposure_intensity);
+
+    // NOTE: the previous exposure is 0 on the first frame, in which case we adopt the target immediately
+    float previous_exposure = texture2D( previous_exposure_texture, vec2(0.5) ).r;
+    float exposure = previous_exposure > 0.? mix(previous_exposure, target_exposure, adaptation_rate) : target_exposure;
+
+    gl_FragColor = vec4(exposure, 0, 0, 1);
+}
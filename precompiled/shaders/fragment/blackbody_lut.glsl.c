@@ -0,0 +1,16 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/emission.glsl.c"
+
+// "blackbody_lut.glsl.c" builds the lookup table for black body emission that's described in "emission.glsl.c".
+// It is rendered to a float render target whose dimensions are BLACKBODY_LUT_WIDTH x 1, 
+//   and only once, since black body emission only depends on temperature.
+
+varying vec2  vUv;
+
+void main() {
+    gl_FragColor = vec4(get_blackbody_lut_texel(get_blackbody_lut_temperature(vUv.x)), 1.);
+}
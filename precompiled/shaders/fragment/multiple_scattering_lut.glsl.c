@@ -0,0 +1,39 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/constants.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+
+// "multiple_scattering_lut.glsl.c" builds the lookup table for multiple scattering that's described in "raymarching.glsl.c".
+// It is rendered to a float render target whose dimensions are 
+//   MULTIPLE_SCATTERING_LUT_WIDTH x MULTIPLE_SCATTERING_LUT_HEIGHT, 
+//   and again only when properties of the world or atmosphere change.
+
+varying vec2  vUv;
+
+// WORLD PROPERTIES ------------------------------------------------------------
+uniform float world_radius;
+
+// ATMOSPHERE PROPERTIES -------------------------------------------------------
+uniform float atmosphere_scale_height;
+uniform vec3  surface_air_rayleigh_scattering_coefficients; 
+uniform vec3  surface_air_mie_scattering_coefficients; 
+uniform vec3  surface_air_absorption_coefficients; 
+
+void main() {
+    vec2 point = get_multiple_scattering_lut_point(vUv, atmosphere_scale_height);
+
+    gl_FragColor = vec4(
+        get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+            point.x, point.y, 
+            world_radius, atmosphere_scale_height,
+            surface_air_rayleigh_scattering_coefficients,
+            surface_air_mie_scattering_coefficients,
+            surface_air_absorption_coefficients
+        ), 
+        1.
+    );
+}
@@ -0,0 +1,20 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/electronics.glsl.c"
+
+// "realistic_vertex_lit.glsl.c" is the counterpart to "realistic.glsl.c" for vertex shaders that light the surface,
+//   see "vertex/vertex_lighting.glsl.c". It only interpolates the intensity of light between vertices.
+
+// LIGHT SOURCE PROPERTIES -----------------------------------------------------
+uniform float insolation_max;
+
+varying vec3  rgb_intensity_v;
+
+void main() {
+#ifdef HDR_RENDER_TARGET
+    // NOTE: intensities are written linearly to a float render target, so they are not clipped
+    gl_FragColor = vec4(rgb_intensity_v/insolation_max,1);
+#else
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(rgb_intensity_v/insolation_max),1);
+#endif
+}
@@ -0,0 +1,21 @@
+#define GL_ES
+#include "precompiled/cross_platform_macros.glsl.c"
+#include "precompiled/academics/psychophysics.glsl.c"
+#include "precompiled/academics/electronics.glsl.c"
+
+// "tone_mapping" maps the linear intensities of a float render target to the rgb signals of a monitor,
+//   see ToneMappingPass.js for how it's used.
+// Exposure is either given by "exposure_intensity", 
+//   or if "auto_exposure_visibility" is 1, it's read from the 1x1 texture that's rendered by "auto_exposure.glsl.c".
+
+varying vec2  vUv;
+uniform sampler2D input_texture;
+uniform sampler2D exposure_texture;
+uniform float     exposure_intensity;       // Watts/m^2
+uniform float     auto_exposure_visibility;
+
+void main() {
+    vec3  rgb_intensity = texture2D( input_texture, vUv ).rgb;
+    float exposure = mix(exposure_intensity, texture2D( exposure_texture, vec2(0.5) ).r, auto_exposure_visibility);
+    gl_FragColor = vec4(get_rgb_signal_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(rgb_intensity, exposure)), 1);
+}
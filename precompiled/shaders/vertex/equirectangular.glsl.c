@@ -9,7 +9,7 @@ float lat(vec3 pos) {
 
 void main() {
     displacement_v = displacement;
-    gradient_v = gradient;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
     plant_coverage_v = plant_coverage;
     surface_temperature_v = surface_temperature;
     snow_coverage_v = snow_coverage;
@@ -40,4 +40,9 @@ void main() {
     view_origin_v = view_matrix_inverse[3].xyz * reference_distance;
     view_origin_v.y = 0.;
     view_origin_v = normalize(view_origin_v);
+
+#ifdef VERTEX_LIGHTING
+    // NOTE: this must be called after all varyings are written, since it reads from them
+    rgb_intensity_v = get_rgb_intensity_of_surface_of_world();
+#endif
 }
\ No newline at end of file
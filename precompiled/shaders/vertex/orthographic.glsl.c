@@ -2,7 +2,7 @@
 
 void main() {
     displacement_v = displacement;
-    gradient_v = gradient;
+    gradient_v = vec3(gradient_x, gradient_y, gradient_z);
     plant_coverage_v = plant_coverage;
     snow_coverage_v = snow_coverage;
     surface_temperature_v = surface_temperature;
@@ -16,7 +16,10 @@ uniform   float sealevel;
 uniform   float world_radius;
 
 attribute float displacement;
-attribute vec3  gradient;
+// NOTE: vector rasters are uploaded as one attribute per component, see "GridBufferGeometry"
+attribute float gradient_x;
+attribute float gradient_y;
+attribute float gradient_z;
 attribute float surface_temperature;
 attribute float snow_coverage;
 attribute float plant_coverage;
@@ -35,3 +38,10 @@ uniform   float map_projection_offset;
 uniform   float animation_phase_angle;
 attribute float vector_fraction_traversed;
 varying   float vector_fraction_traversed_v;
+
+#ifdef VERTEX_LIGHTING
+// LIGHTING PROPERTIES
+// NOTE: the surface is lit once per vertex, see "vertex_lighting.glsl.c"
+varying   vec3  rgb_intensity_v;
+#include "precompiled/shaders/vertex/vertex_lighting.glsl.c"
+#endif
@@ -0,0 +1,13 @@
+// "vertex_lighting.glsl.c" lets map projection vertex shaders light the surface of a world once per vertex,
+//   using the same model that "fragment/realistic.glsl.c" uses once per pixel.
+// It is only included by "template.glsl.c" if "VERTEX_LIGHTING" is defined, see get_realistic_vertex_shader() in "precompiled/Shaders.js"
+// NOTE: "math/constants.glsl.c" is already included by "template.glsl.c"
+#include "precompiled/academics/units.glsl.c"
+#include "precompiled/academics/math/geometry.glsl.c"
+#include "precompiled/academics/physics/constants.glsl.c"
+#include "precompiled/academics/physics/emission.glsl.c"
+#include "precompiled/academics/physics/scattering.glsl.c"
+#include "precompiled/academics/physics/reflectance.glsl.c"
+#include "precompiled/academics/raymarching.glsl.c"
+
+#include "precompiled/shaders/realistic_surface.glsl.c"
@@ -0,0 +1,293 @@
+// Native counterpart to "tests/scripts/Academics.js"
+// It checks that the academics layer behaves the same when compiled as C++, 
+// and that the batch functions of "libacademics.h" agree with the functions they wrap.
+// Run with "make test-native"
+
+#include <cstdio>
+#include <vector>
+
+#include "precompiled/Academics.hpp"
+#include "precompiled/cpp/raymarching.hpp"
+#include "precompiled/cpp/realistic.hpp"
+#include "precompiled/cpp/libacademics.h"
+
+using namespace academics;
+
+static int failure_count = 0;
+
+static void test_value_is_between(float estimate, float lo, float hi, const char* op_name, const char* message) {
+    bool is_ok = lo < estimate && estimate < hi;
+    if (!is_ok) { ++failure_count; }
+    std::printf("%s %s(...) %s (%g < %g < %g)\n", is_ok? "ok    " : "not ok", op_name, message, lo, estimate, hi);
+}
+static void set_vec3(float* a, int i, const vec3& v) {
+    a[3*i+0] = v.x;
+    a[3*i+1] = v.y;
+    a[3*i+2] = v.z;
+}
+static void test_value_is_above(float estimate, float threshold, const char* op_name, const char* message) {
+    test_value_is_between(estimate, threshold, INFINITY, op_name, message);
+}
+
+int main() {
+    // from https://www.reddit.com/r/askscience/comments/2gerkk/how_much_of_the_heat_from_the_sun_comes_from/
+    test_value_is_above(
+        solve_fraction_of_light_emitted_by_black_body_below_wavelength(760.*NANOMETER, SOLAR_TEMPERATURE),
+        0.5,
+        "solve_fraction_of_light_emitted_by_black_body_below_wavelength",
+        "must predict that the sun will return mostly visible light"
+    );
+    test_value_is_above(
+        solve_fraction_of_light_emitted_by_black_body_between_wavelengths(380.*NANOMETER, 760.*NANOMETER, SOLAR_TEMPERATURE),
+        0.4,
+        "solve_fraction_of_light_emitted_by_black_body_between_wavelengths",
+        "must predict that the sun will return mostly visible light"
+    );
+    test_value_is_between(
+        get_intensity_of_light_emitted_by_black_body(SOLAR_TEMPERATURE) * 
+            get_surface_area_of_sphere(SOLAR_RADIUS) / 
+            get_surface_area_of_sphere(ASTRONOMICAL_UNIT),
+        0.99*GLOBAL_SOLAR_CONSTANT,
+        1.01*GLOBAL_SOLAR_CONSTANT,
+        "get_intensity_of_light_emitted_by_black_body",
+        "must predict the global solar constant to within 1%"
+    );
+
+    // batch functions must agree with the functions they wrap
+    float temperatures[3] = { 1000.f, SOLAR_TEMPERATURE, 10000.f };
+    float rgb_intensities[9];
+    academics_solve_rgb_intensities_of_light_emitted_by_black_bodies(temperatures, 3, rgb_intensities);
+    for (int i = 0; i < 3; ++i) {
+        vec3 expected = solve_rgb_intensity_of_light_emitted_by_black_body(temperatures[i]);
+        for (int j = 0; j < 3; ++j) {
+            test_value_is_between(
+                rgb_intensities[3*i+j], 0.999f*expected[j], 1.001f*expected[j],
+                "academics_solve_rgb_intensities_of_light_emitted_by_black_bodies",
+                "must agree with solve_rgb_intensity_of_light_emitted_by_black_body"
+            );
+        }
+    }
+
+    // the black body lookup table must reproduce emission once it's interpolated the way a gpu would
+    std::vector<vec3> blackbody_lut_texels(static_cast<int>(BLACKBODY_LUT_WIDTH));
+    for (int i = 0; i < int(BLACKBODY_LUT_WIDTH); ++i) {
+        blackbody_lut_texels[i] = get_blackbody_lut_texel(get_blackbody_lut_temperature((i + 0.5f) / BLACKBODY_LUT_WIDTH));
+    }
+    float max_blackbody_lut_error = 0.f;
+    for (float T = BLACKBODY_LUT_MIN_TEMPERATURE; T < 10000.f; T *= 1.01f) {
+        float x = get_blackbody_lut_texcoord(T) * BLACKBODY_LUT_WIDTH - 0.5f;
+        int   i = glm::min(int(x), int(BLACKBODY_LUT_WIDTH) - 2);
+        vec3  estimate = exp(mix(blackbody_lut_texels[i], blackbody_lut_texels[i+1], x - i));
+        vec3  expected = solve_rgb_intensity_of_light_emitted_by_black_body(T);
+        for (int j = 0; j < 3; ++j) {
+            // NOTE: intensities that are too small to see are ignored
+            if (expected[j] > 1e-20f) {
+                max_blackbody_lut_error = glm::max(max_blackbody_lut_error, glm::abs(estimate[j] - expected[j]) / expected[j]);
+            }
+        }
+    }
+    test_value_is_between(
+        max_blackbody_lut_error, -1.f, 1e-2f,
+        "get_blackbody_lut_texel",
+        "must agree with solve_rgb_intensity_of_light_emitted_by_black_body to within 1% once interpolated"
+    );
+
+    // auto exposure must map the average luminance of a scene to middle grey
+    const float average_luminance = 37.f;
+    test_value_is_between(
+        get_luminance_of_rgb_intensity(get_ldr_rgb_intensity_of_hdr_rgb_intensity(
+            vec3(average_luminance), get_exposure_intensity_of_average_luminance(average_luminance))),
+        0.999f*MIDDLE_GREY_INTENSITY, 1.001f*MIDDLE_GREY_INTENSITY,
+        "get_exposure_intensity_of_average_luminance",
+        "must map the average luminance to middle grey"
+    );
+
+    // a view of earth's sky at noon must be blue
+    const float r = 6.371e6;
+    const float H = 8.5e3;
+    const float view_origin[3]    = { 0.f, r+1.f, 0.f };
+    const float view_direction[3] = { 0.f, 1.f,   0.f };
+    const float world_position[3] = { 0.f, 0.f,   0.f };
+    const float light_direction[3]= { 0.f, 1.f,   0.f };
+    const float light_rgb_intensity[3] = { 1.f, 1.f, 1.f };
+    const float background_rgb_intensity[3] = { 0.f, 0.f, 0.f };
+    const float beta_ray[3] = { 5.20e-6f, 12.1e-6f, 29.6e-6f };
+    const float beta_mie[3] = { 2.1e-6f, 2.1e-6f, 2.1e-6f };
+    const float beta_abs[3] = { 0.f, 0.f, 0.f };
+    float sky_rgb_intensity[3];
+    academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world(
+        view_origin, view_direction, 1,
+        world_position, r,
+        light_direction, light_rgb_intensity, 1,
+        background_rgb_intensity, H,
+        beta_ray, beta_mie, beta_abs,
+        sky_rgb_intensity
+    );
+    test_value_is_above(
+        sky_rgb_intensity[2] / sky_rgb_intensity[0], 1.,
+        "academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world",
+        "must predict that the sky at noon is blue"
+    );
+
+    // the air column density lookup table must map texture coordinates back to the rays they were found from
+    float max_lut_error = 0.f;
+    for (int i = 0; i <= 10; ++i) {
+        for (int j = 0; j <= 10; ++j) {
+            float h   = (i * 0.1f) * (i * 0.1f) * AIR_COLUMN_DENSITY_LUT_SCALE_HEIGHTS * H;
+            float R   = r + h;
+            float cos_horizon = -sqrt(max(1. - (r*r)/(R*R), 0.));
+            float cos_zenith  = cos_horizon + (j * 0.1f) * (1.f - cos_horizon);
+            vec2  ray = get_air_column_density_lut_ray(get_air_column_density_lut_texcoord(h, cos_zenith, r, H), r, H);
+            max_lut_error = glm::max(max_lut_error, glm::abs(ray.x - h) / H + glm::abs(ray.y - cos_zenith));
+        }
+    }
+    test_value_is_between(
+        max_lut_error, -1.f, 1e-3f,
+        "get_air_column_density_lut_ray",
+        "must be the inverse of get_air_column_density_lut_texcoord"
+    );
+
+    // multiple scattering must be brighter for higher suns, and must never exceed single scattering
+    vec3 multiple_scattering_at_noon     = get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+        0.f, 1.f,  r, H, vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0]), vec3(0.f));
+    vec3 multiple_scattering_at_twilight = get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world(
+        0.f, -0.05f, r, H, vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0]), vec3(0.f));
+    test_value_is_between(
+        multiple_scattering_at_twilight.z / multiple_scattering_at_noon.z, 0.f, 1.f,
+        "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world",
+        "must predict less light at twilight than at noon"
+    );
+    test_value_is_between(
+        multiple_scattering_at_noon.z, 0.f, 1.f / (4.f*PI),
+        "get_rgb_fraction_of_light_scattered_multiple_times_from_air_for_curved_world",
+        "must predict less light than if the sky were fully lit and scattered uniformly"
+    );
+
+    // light scattered without a background plus transmitted light from the background must equal light scattered with a background,
+    // since shaders that raymarch at reduced resolution rely on this to add the background back in at full resolution
+    const vec3 sunset_directions[1] = { normalize(vec3(1.f, 0.05f, 0.f)) };
+    const vec3 sunset_rgb_intensities[1] = { vec3(1.f) };
+    const vec3 background(0.2f, 0.5f, 0.3f);
+    const vec3 sunset_view_origin(0.f, r+1.f, 0.f);
+    const vec3 sunset_view_direction = normalize(vec3(1.f, -0.01f, 0.f));
+    vec3 with_background = get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+        sunset_view_origin, sunset_view_direction, vec3(0.f), r, sunset_directions, sunset_rgb_intensities, 1,
+        background, H, vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0]), vec3(0.f));
+    vec3 without_background = get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+        sunset_view_origin, sunset_view_direction, vec3(0.f), r, sunset_directions, sunset_rgb_intensities, 1,
+        vec3(0.f), H, vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0]), vec3(0.f));
+    vec3 transmitted = background * get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world(
+        sunset_view_origin, sunset_view_direction, vec3(0.f), r, H, vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0]), vec3(0.f));
+    vec3 split_error = glm::abs(without_background + transmitted - with_background) / with_background;
+    test_value_is_between(
+        glm::max(split_error.x, glm::max(split_error.y, split_error.z)), -1.f, 1e-5f,
+        "get_rgb_fraction_of_background_light_transmitted_through_air_for_curved_world",
+        "must account for the background light of get_rgb_intensity_of_light_scattered_from_air_for_curved_world"
+    );
+
+    // steps of the view ray march must cover the whole march, in order, and must be closest together where air is densest
+    float max_raymarch_error = 0.f;
+    for (int i = 0; i <= 4; ++i) {
+        float u_dense = i * 0.25f;
+        float last = 0.f;
+        float min_step = 1.f;
+        float step_at_dense = 1.f;
+        for (int j = 1; j <= 8; ++j) {
+            float next = get_fraction_along_raymarch(j / 8.f, u_dense);
+            max_raymarch_error = glm::max(max_raymarch_error, glm::max(last - next, 0.f));
+            min_step = glm::min(min_step, next - last);
+            if (last <= u_dense && u_dense <= next) { step_at_dense = glm::min(step_at_dense, next - last); }
+            last = next;
+        }
+        max_raymarch_error = glm::max(max_raymarch_error, glm::abs(last - 1.f) + glm::abs(step_at_dense - min_step));
+    }
+    test_value_is_between(
+        max_raymarch_error, -1.f, 1e-6f,
+        "get_fraction_along_raymarch",
+        "must span the march with steps that are smallest where air is densest"
+    );
+
+    // batched raymarching must agree with the scalar implementation,
+    // NOTE: we test a count that is not divisible by the lane count, to exercise padding
+    const int VIEW_COUNT = 1001;
+    std::vector<float> view_origins(3*VIEW_COUNT);
+    std::vector<float> view_directions(3*VIEW_COUNT);
+    std::vector<float> batch_rgb_intensities(3*VIEW_COUNT);
+    const float light_directions[6] = { 0.f, 1.f, 0.f,   0.6f, 0.f, 0.8f };
+    const float light_rgb_intensities[6] = { 1.f, 1.f, 1.f,   0.5f, 0.2f, 0.1f };
+    for (int i = 0; i < VIEW_COUNT; ++i) {
+        // a deterministic spread of rays, some from the ground and some from space,
+        // using golden angle spirals so results are not sensitive to the lane width
+        float t = (i + 0.5f) / VIEW_COUNT;
+        vec3  U = vec3(cos(2.39996323f*i) * sqrt(1.f-(2.f*t-1.f)*(2.f*t-1.f)), 2.f*t-1.f, sin(2.39996323f*i) * sqrt(1.f-(2.f*t-1.f)*(2.f*t-1.f)));
+        vec3  D = normalize(vec3(U.z, U.x, -U.y) + 0.5f*U);
+        set_vec3(view_origins.data(),    i, U * (i%2? r+1.f : 3.f*r));
+        set_vec3(view_directions.data(), i, i%2? D : -U);
+    }
+    academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world(
+        view_origins.data(), view_directions.data(), VIEW_COUNT,
+        world_position, r,
+        light_directions, light_rgb_intensities, 2,
+        background_rgb_intensity, H,
+        beta_ray, beta_mie, beta_abs,
+        batch_rgb_intensities.data()
+    );
+    const vec3 L[2] = { vec3(0.f, 1.f, 0.f),  vec3(0.6f, 0.f, 0.8f) };
+    const vec3 I[2] = { vec3(1.f, 1.f, 1.f),  vec3(0.5f, 0.2f, 0.1f) };
+    // NOTE: rays that graze the surface are ill conditioned, and their results are sensitive to rounding, 
+    //   so error is measured relative to the brightest intensity in the sky
+    std::vector<float> expected_rgb_intensities(3*VIEW_COUNT);
+    float max_intensity = 0.f;
+    for (int i = 0; i < VIEW_COUNT; ++i) {
+        vec3 expected = get_rgb_intensity_of_light_scattered_from_air_for_curved_world(
+            vec3(view_origins[3*i], view_origins[3*i+1], view_origins[3*i+2]), 
+            vec3(view_directions[3*i], view_directions[3*i+1], view_directions[3*i+2]),
+            vec3(0.f), r,
+            L, I, 2,
+            vec3(0.f), H,
+            vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0], beta_mie[1], beta_mie[2]), vec3(0.f)
+        );
+        set_vec3(expected_rgb_intensities.data(), i, expected);
+        max_intensity = glm::max(max_intensity, glm::max(expected.x, glm::max(expected.y, expected.z)));
+    }
+    float max_error = 0.f;
+    for (int i = 0; i < 3*VIEW_COUNT; ++i) {
+        max_error = glm::max(max_error, glm::abs(batch_rgb_intensities[i] - expected_rgb_intensities[i]) / max_intensity);
+    }
+    test_value_is_between(
+        max_error, -1.f, 1e-3f,
+        "academics_get_rgb_intensities_of_light_scattered_from_air_for_curved_world",
+        "must agree with the scalar implementation to within 0.1%"
+    );
+
+    // the surface model of "realistic_surface.glsl.c" must also compile natively, see "realistic.hpp"
+    const vec3 surface_light_directions[1]      = { normalize(vec3(1.f, 0.2f, 0.f)) };
+    const vec3 surface_light_rgb_intensities[1] = { vec3(GLOBAL_SOLAR_CONSTANT) };
+    vec3 surface_rgb_intensities[2];
+    for (int i = 0; i < 2; ++i) {
+        vec3 position = vec3(i == 0? 1.f : -1.f, 0.f, 0.f);
+        surface_rgb_intensities[i] = get_rgb_intensity_of_surface_of_world(
+            1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+            surface_light_directions, surface_light_rgb_intensities, 1,
+            H, 
+            vec3(beta_ray[0], beta_ray[1], beta_ray[2]), vec3(beta_mie[0], beta_mie[1], beta_mie[2]), vec3(0.f),
+            0.f, vec3(0.005f, 0.01f, 0.03f), vec3(0.f), vec3(3e-1f, 1e-1f, 2e-2f),
+            r,
+            1000.f, vec3(0.f), 0.f, 0.f, 288.f, position,
+            -position
+        );
+    }
+    test_value_is_between(
+        surface_rgb_intensities[1].y / surface_rgb_intensities[0].y, -1.f, 1e-3f,
+        "get_rgb_intensity_of_surface_of_world",
+        "must predict that the night side of a temperate world is dark"
+    );
+    test_value_is_between(
+        surface_rgb_intensities[0].y / GLOBAL_SOLAR_CONSTANT, 0.01f, 1.f,
+        "get_rgb_intensity_of_surface_of_world",
+        "must predict that the day side reflects a fraction of sunlight"
+    );
+
+    std::printf("%d failed\n", failure_count);
+    return failure_count > 0;
+}
@@ -0,0 +1,327 @@
+// Benchmarks for raster kernels, model steps, and shader passes.
+// Unlike the other scripts here, these measure speed rather than correctness, so karma does not run them.
+// They are run by "tools/benchmark.js" from the command line, which skips shader passes,
+//   and by "tests/benchmark.html" in a browser, which runs everything.
+//
+// Every case runs on a world that's generated from "Benchmark.SEED" for each of "Benchmark.GRID_DETAILS",
+//   so results are comparable between runs, and between machines that run the same version.
+// A result is an object of the form:
+//   { name, grid_detail, count, unit, milliseconds, per_second, timer }
+//   where "count" is the number of "unit"'s that are processed per run, e.g. cells or pixels,
+//   "milliseconds" is the time of a run, and "per_second" is the throughput, "count" divided by that time.
+//   "timer" is "cpu" if runs are timed by performance.now(), or "gpu" if they're timed by a gpu timer query.
+// A report is the JSON of { version, user_agent, date, results }, see "Benchmark.get_report".
+// Reports can be compared against a report that's stored as a baseline, see "Benchmark.compare".
+var Benchmark = {};
+Benchmark.VERSION = 1;
+Benchmark.SEED = 12345;
+// icosahedron subdivisions of the grids that are used, which have 642, 2562, and 10242 cells
+Benchmark.GRID_DETAILS = [3, 4, 5];
+// each case is timed for at least this long, over at least MIN_RUN_COUNT batches, see "Benchmark.time"
+Benchmark.MIN_MILLISECONDS = 250;
+Benchmark.MIN_RUN_COUNT = 5;
+Benchmark.MIN_BATCH_MILLISECONDS = 2;
+Benchmark.WARMUP_MILLISECONDS = 50;
+// the timestep of model steps, in seconds, which is large enough for plates to move, see "Lithosphere.is_perceivable"
+Benchmark.TIMESTEP = Units.MEGAYEAR;
+// a case regresses if its throughput fell by more than this fraction of the baseline
+Benchmark.REGRESSION_TOLERANCE = 0.2;
+
+// "get_simulation" returns a simulation of a single world around a single star, generated from "Benchmark.SEED",
+//   which has been stepped once so that its plates are separated. Simulations are cached by "grid_detail".
+Benchmark.simulations = {};
+Benchmark.get_simulation = function(grid_detail) {
+    if (Benchmark.simulations[grid_detail] !== void 0) {
+        return Benchmark.simulations[grid_detail];
+    }
+    var sim = new Simulation({ seed: Benchmark.SEED.toString(), speed: Benchmark.TIMESTEP });
+    var geometry = new THREE.IcosahedronGeometry(1, grid_detail);
+    // NOTE: this is the system of index.html, less the precession of the world's spin
+    var universe = new Universe({
+        system: {
+            name: 'galactic orbit',
+            motion: {
+                type: 'orbit',
+                semi_major_axis: 2.35e20, // meters
+                effective_combined_mass: 1.262e41, // kg
+            },
+            invariant_insolation: true,
+            body: { type: 'star', name: 'star', mass: Units.SOLAR_MASS },
+            children: [
+                {
+                    name: 'orbit',
+                    motion: {
+                        type: 'orbit',
+                        semi_major_axis: 1. * Units.ASTRONOMICAL_UNIT,
+                        eccentricity: 0.0167,
+                        effective_combined_mass: 2e30, // kg
+                    },
+                    children: [
+                        {
+                            name: 'spin',
+                            motion: {
+                                type: 'spin',
+                                angular_speed: 2*Math.PI/(60*60*24),
+                                axial_tilt: Math.PI * 23.5/180,
+                            },
+                            body: {
+                                type: 'world',
+                                name: 'world',
+                                grid: {
+                                    faces:    geometry.faces.map(f => { return {a: f.a, b: f.b, c: f.c, vertexNormals: f.vertexNormals} }),
+                                    vertices: geometry.vertices.map(v => { return {x: v.x, y: v.y, z: v.z} }),
+                                },
+                            },
+                        },
+                    ],
+                },
+            ],
+        },
+    });
+    var world = universe.body_id_to_node_map['world'].body;
+    CrustGenerator.get_crust_from_height_ranks(
+        SphericalGeometry.get_random_surface_field(world.grid, sim.random),
+        CrustGenerator.modern_earth_hypsography,
+        CrustGenerator.modern_earth_attribute_height_maps,
+        sim.random,
+        world.lithosphere.total_crust
+    );
+    sim.model(universe);
+    sim.focus = world;
+    Benchmark.step(sim);
+    Benchmark.simulations[grid_detail] = sim;
+    return sim;
+}
+// "step" steps "sim" by "Benchmark.TIMESTEP", regardless of how much time has passed since it was last stepped
+Benchmark.step = function(sim) {
+    var model = sim.model();
+    model.invalidate(Benchmark.TIMESTEP);
+    model.calcChanges(Benchmark.TIMESTEP);
+    model.applyChanges(Benchmark.TIMESTEP);
+}
+
+// Cases that run on the cpu. Each has a "name", and a "setup" that's called with a simulation,
+//   which returns the function that's timed, so that its inputs and outputs are allocated only once.
+Benchmark.cpu_cases = [
+    {
+        name: 'ScalarField.gradient',
+        setup: function(sim) {
+            var field = sim.focus.lithosphere.displacement.value();
+            var result = VectorRaster(field.grid);
+            return () => ScalarField.gradient(field, result);
+        },
+    },
+    {
+        name: 'ScalarField.laplacian',
+        setup: function(sim) {
+            var field = sim.focus.lithosphere.displacement.value();
+            var result = Float32Raster(field.grid);
+            return () => ScalarField.laplacian(field, result);
+        },
+    },
+    {
+        name: 'ScalarField.diffusion_by_constant',
+        setup: function(sim) {
+            var field = sim.focus.lithosphere.displacement.value();
+            var result = Float32Raster(field.grid);
+            return () => ScalarField.diffusion_by_constant(field, 1, result);
+        },
+    },
+    {
+        name: 'Grid',
+        setup: function(sim) {
+            var grid = sim.focus.grid;
+            var parameters = { faces: grid.faces, vertices: grid.vertices };
+            // NOTE: grids of the same mesh share what they derive from it, see "Grid.cache", so the cache is bypassed to build it again
+            return () => new Grid(parameters, { is_cached: false });
+        },
+    },
+    {
+        name: 'VoronoiSphere.getNearestIds',
+        setup: function(sim) {
+            var grid = sim.focus.grid;
+            var rotated = VectorField.mult_matrix(grid.pos, Matrix3x3.RotationAboutAxis(0, 0, 1, 0.1));
+            var result = grid.getNearestIds(rotated);
+            return () => grid.getNearestIds(rotated, result);
+        },
+    },
+    {
+        name: 'Plate.move',
+        setup: function(sim) {
+            var plate = sim.focus.lithosphere.plates[0];
+            return () => plate.move(Benchmark.TIMESTEP);
+        },
+    },
+    {
+        name: 'Universe step',
+        setup: function(sim) {
+            return () => Benchmark.step(sim);
+        },
+    },
+];
+// Shader passes that are timed within "tests/benchmark.html", named by the fragment shader that they run.
+// The first pass of a View's composer renders the scene, which the "satellite" view draws with fragmentShaders.realistic.
+Benchmark.shader_case_names = ['realistic', 'atmosphere', 'tone_mapping'];
+
+// "time" returns the number of milliseconds that "run" takes, see "MIN_MILLISECONDS" and "MIN_RUN_COUNT"
+// Runs are timed in batches that take at least MIN_BATCH_MILLISECONDS, so that fast cases are not lost to timer resolution,
+//   and batches are only timed once cases have run for WARMUP_MILLISECONDS, so that they're timed once they're compiled.
+// The fastest batch is used, since anything else that runs on the machine only ever makes batches slower.
+Benchmark.time = function(run) {
+    function time_batch(run_count) {
+        var start = performance.now();
+        for (var i = 0; i < run_count; i++) {
+            run();
+        }
+        return performance.now() - start;
+    }
+    var batch_run_count = 1;
+    var warmup = 0;
+    while (warmup < Benchmark.WARMUP_MILLISECONDS) {
+        var milliseconds = time_batch(batch_run_count);
+        warmup += milliseconds;
+        if (milliseconds < Benchmark.MIN_BATCH_MILLISECONDS) {
+            batch_run_count *= 2;
+        }
+    }
+    var times = [];
+    var total = 0;
+    while (total < Benchmark.MIN_MILLISECONDS || times.length < Benchmark.MIN_RUN_COUNT) {
+        var milliseconds = time_batch(batch_run_count);
+        times.push(milliseconds / batch_run_count);
+        total += milliseconds;
+    }
+    return Math.min(...times);
+}
+Benchmark.get_result = function(name, grid_detail, count, unit, milliseconds, timer) {
+    return {
+        name:           name,
+        grid_detail:    grid_detail,
+        count:          count,
+        unit:           unit,
+        milliseconds:   milliseconds,
+        per_second:     count / (milliseconds / 1000),
+        timer:          timer,
+    };
+}
+// "run_cpu_cases" returns results for each case of "cpu_cases" whose name matches "filter", a RegExp,
+//   at each of "grid_details", calling back "on_result" with each one as soon as it's known
+Benchmark.run_cpu_cases = function(grid_details, filter, on_result) {
+    grid_details = grid_details || Benchmark.GRID_DETAILS;
+    var results = [];
+    for (var grid_detail of grid_details) {
+        var sim = Benchmark.get_simulation(grid_detail);
+        var cell_count = sim.focus.grid.vertices.length;
+        for (var test_case of Benchmark.cpu_cases) {
+            if (filter !== void 0 && !filter.test(test_case.name)) {
+                continue;
+            }
+            var result = Benchmark.get_result(test_case.name, grid_detail, cell_count, 'cells',
+                Benchmark.time(test_case.setup(sim)), 'cpu');
+            results.push(result);
+            if (on_result !== void 0) {
+                on_result(result);
+            }
+        }
+    }
+    return results;
+}
+
+// "run_shader_cases" renders "frame_count" frames of "view", timing each pass of its composer with a Profiler.GpuTimer,
+//   and returns a promise of a result for each pass in "shader_case_names"
+// "view" must already show a world of "grid_detail" with the "satellite" view, see "tests/benchmark.html".
+Benchmark.run_shader_cases = function(view, grid_detail, frame_count) {
+    var gl_state = view.gl_state;
+    var renderer = gl_state.renderer;
+    var timer = new Profiler.GpuTimer(renderer.context);
+    var pixel_count = renderer.domElement.width * renderer.domElement.height;
+    var times = {};
+    // the scene is rendered by the first pass, and every other pass is named by its fragment shader
+    function get_pass_name(pass) {
+        if (pass === gl_state.renderpass) {
+            return 'realistic';
+        }
+        var fragment_shader = pass.material !== void 0? pass.material.fragmentShader : void 0;
+        return Benchmark.shader_case_names.find(name =>
+            fragment_shader === fragmentShaders[name] || fragment_shader === fragmentShaders[name + '_using_luts']);
+    }
+    // wrap the render() of each pass so that it's timed
+    var passes = gl_state.composer.passes;
+    var renders = passes.map(pass => pass.render);
+    passes.forEach(function(pass, i) {
+        var name = get_pass_name(pass);
+        if (name === void 0) {
+            return;
+        }
+        times[name] = [];
+        pass.render = function() {
+            timer.begin(milliseconds => times[name].push(milliseconds));
+            renders[i].apply(pass, arguments);
+            timer.end();
+        }
+    });
+    return new Promise(function(resolve) {
+        var frame = 0;
+        function animate() {
+            if (frame < frame_count) {
+                // NOTE: every pass must run each frame, rather than only tone mapping, see View.render()
+                gl_state.scene_version++;
+                view.render();
+                frame++;
+                timer.poll();
+                requestAnimationFrame(animate);
+            } else if (timer.poll() > 0) {
+                requestAnimationFrame(animate);
+            } else {
+                passes.forEach((pass, i) => pass.render = renders[i]);
+                resolve(Object.keys(times).filter(name => times[name].length > 0).map(name =>
+                    Benchmark.get_result(name, grid_detail, pixel_count, 'pixels', Math.min(...times[name]), timer.timer)));
+            }
+        }
+        animate();
+    });
+}
+
+Benchmark.get_report = function(results) {
+    return {
+        version:    Benchmark.VERSION,
+        user_agent: typeof navigator !== 'undefined'? navigator.userAgent : void 0,
+        date:       new Date().toISOString(),
+        results:    results,
+    };
+}
+// "compare" returns a row for each result of "report" that's listed in "baseline", another report, of the form:
+//   { name, grid_detail, per_second, baseline_per_second, ratio, is_regression }
+//   where "ratio" is the throughput of the result relative to the baseline, so values below 1 are slower.
+// Results are only compared to baselines with the same timer, unit, and count, since they are otherwise not comparable.
+Benchmark.compare = function(report, baseline, tolerance) {
+    tolerance = tolerance !== void 0? tolerance : Benchmark.REGRESSION_TOLERANCE;
+    var rows = [];
+    for (var result of report.results) {
+        var match = baseline.results.find(other =>
+            other.name === result.name && other.grid_detail === result.grid_detail &&
+            other.timer === result.timer && other.unit === result.unit && other.count === result.count);
+        if (match === void 0) {
+            continue;
+        }
+        var ratio = result.per_second / match.per_second;
+        rows.push({
+            name:                result.name,
+            grid_detail:         result.grid_detail,
+            per_second:          result.per_second,
+            baseline_per_second: match.per_second,
+            ratio:               ratio,
+            is_regression:       ratio < 1 - tolerance,
+        });
+    }
+    return rows;
+}
+// "format_result" and "format_comparison" return a line of text that describes a result, or a row of "compare"
+Benchmark.format_result = function(result) {
+    return `${result.name} (detail ${result.grid_detail}): ${result.milliseconds.toFixed(3)} ms, ` +
+        `${result.per_second.toPrecision(3)} ${result.unit}/s (${result.timer})`;
+}
+Benchmark.format_comparison = function(row) {
+    return `${row.is_regression? 'REGRESSED' : 'ok       '} ${row.name} (detail ${row.grid_detail}): ` +
+        `${(row.ratio*100).toFixed(0)}% of baseline`;
+}
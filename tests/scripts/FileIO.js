@@ -0,0 +1,161 @@
+/* eslint-env qunit */
+QUnit.module('FileIO');
+
+// "binary_save_parameters" returns parameters that exercise everything a binary save stores:
+//   buffers at any depth, strings that look like section references, and plain values
+function binary_save_parameters() {
+    return {
+        name:     'section:0',
+        escaped:  'string:section:1',
+        age:      4.5e9,
+        is_ready: true,
+        world: {
+            displacement: new Float32Array([1, -2, 3.5]).buffer,
+            plates: [ new Uint8Array([1, 2, 3, 4, 5]).buffer, 'plain' ],
+        },
+    };
+}
+// "is_binary_save_parameters" indicates whether "parameters" equals what "binary_save_parameters" returns
+function is_binary_save_parameters(parameters) {
+    var expected = binary_save_parameters();
+    var displacement = new Float32Array(parameters.world.displacement);
+    var plate = new Uint8Array(parameters.world.plates[0]);
+    return parameters.name === expected.name &&
+        parameters.escaped === expected.escaped &&
+        parameters.age === expected.age &&
+        parameters.is_ready === expected.is_ready &&
+        parameters.world.plates[1] === expected.world.plates[1] &&
+        displacement.join() === new Float32Array(expected.world.displacement).join() &&
+        plate.join() === new Uint8Array(expected.world.plates[0]).join();
+}
+// "concat" joins Uint8Arrays, such as the chunks returned by "BinarySerializer.parameters"
+function concat(chunks) {
+    var result = new Uint8Array(chunks.reduce((length, chunk) => length + chunk.length, 0));
+    var offset = 0;
+    for (var chunk of chunks) {
+        result.set(chunk, offset);
+        offset += chunk.length;
+    }
+    return result;
+}
+// "stream_of" returns a ReadableStream of "bytes", split into chunks of "chunk_byte_length"
+function stream_of(bytes, chunk_byte_length) {
+    return new ReadableStream({
+        start: function(controller) {
+            for (var i = 0; i < bytes.length; i += chunk_byte_length) {
+                controller.enqueue(bytes.slice(i, i + chunk_byte_length));
+            }
+            controller.close();
+        },
+    });
+}
+// "test_stream_outcomes" reads each stream in "cases" in turn, and checks whether it loads as expected,
+//   returning a promise that resolves once every case is checked
+function test_stream_outcomes(assert, cases) {
+    return cases.reduce(function(previous, test_case) {
+        return previous.then(function() {
+            return BinaryDeserializer.parameters_from_stream(test_case.stream()).then(
+                function(parameters) {
+                    assert.ok(!test_case.is_rejected && test_case.is_expected(parameters), `BinaryDeserializer.parameters_from_stream ${test_case.message}`);
+                },
+                function(error) {
+                    assert.ok(test_case.is_rejected, `BinaryDeserializer.parameters_from_stream ${test_case.message} (${error})`);
+                }
+            );
+        });
+    }, Promise.resolve());
+}
+
+QUnit.test(`BinarySerializer Round trip tests`, function (assert) {
+    var bytes = concat(BinarySerializer.parameters(binary_save_parameters()));
+    assert.strictEqual(bytes.length % BinarySerializer.ALIGNMENT, 0, `BinarySerializer.parameters must pad sections to the alignment`);
+
+    var reader = new BinaryDeserializer.Reader();
+    for (var i = 0; i < bytes.length; i++) {
+        reader.push(bytes.subarray(i, i+1));
+    }
+    assert.ok(reader.is_done(), `BinaryDeserializer.Reader must finish once every byte is pushed`);
+    assert.ok(is_binary_save_parameters(reader.parameters()), `BinaryDeserializer.Reader must read back what was stored, one byte at a time`);
+
+    var done = assert.async();
+    test_stream_outcomes(assert, [1, 3, 7, 16, 64, bytes.length].map(chunk_byte_length => ({
+        stream:      () => stream_of(bytes, chunk_byte_length),
+        is_expected: is_binary_save_parameters,
+        message:     `must read back what was stored, in chunks of ${chunk_byte_length} bytes`,
+    })).concat([{
+        stream:      () => stream_of(new TextEncoder().encode(JsonSerializer.parameters({ name: 'section:0', age: 1 })), 3),
+        is_expected: parameters => parameters.name === 'section:0' && parameters.age === 1,
+        message:     `must read back JSON saves, in chunks that are smaller than the magic string`,
+    }])).then(done, done);
+});
+QUnit.test(`BinarySerializer Compression tests`, function (assert) {
+    if (typeof CompressionStream === 'undefined') {
+        assert.ok(true, `BinarySerializer compression is not supported by this browser`);
+        return;
+    }
+    var done = assert.async();
+    BinarySerializer.blob(BinarySerializer.parameters(binary_save_parameters()), true)
+        .then(blob => blob.arrayBuffer())
+        .then(function(buffer) {
+            var compressed = new Uint8Array(buffer);
+            assert.ok(BinaryDeserializer.is_gzip(compressed), `BinarySerializer.blob must gzip compress if asked to`);
+            return test_stream_outcomes(assert, [1, 5, compressed.length].map(chunk_byte_length => ({
+                stream:      () => stream_of(compressed, chunk_byte_length),
+                is_expected: is_binary_save_parameters,
+                message:     `must read back compressed saves, in chunks of ${chunk_byte_length} bytes`,
+            })).concat([{
+                stream:      () => stream_of(compressed.subarray(0, compressed.length/2), 16),
+                is_rejected: true,
+                message:     `must reject compressed saves that are truncated`,
+            }]));
+        })
+        .then(done, done);
+});
+QUnit.test(`BinaryDeserializer Corruption tests`, function (assert) {
+    var bytes = concat(BinarySerializer.parameters(binary_save_parameters()));
+    var header_byte_length = new DataView(bytes.buffer).getUint32(12, true);
+    var future_version = bytes.slice();
+    new DataView(future_version.buffer).setUint32(8, BinarySerializer.VERSION+1, true);
+    var corrupt_header = bytes.slice();
+    corrupt_header[BinarySerializer.PREFIX_BYTE_LENGTH] = '}'.charCodeAt(0);
+    var missing_section = new TextEncoder().encode(JSON.stringify({ sections: [], parameters: { raster: 'section:0' } }));
+    var missing_section_bytes = concat([bytes.slice(0, BinarySerializer.PREFIX_BYTE_LENGTH), missing_section]);
+    new DataView(missing_section_bytes.buffer).setUint32(12, missing_section.length, true);
+    missing_section_bytes = concat([missing_section_bytes, new Uint8Array(BinarySerializer.get_padding(missing_section.length))]);
+
+    var reader = new BinaryDeserializer.Reader();
+    assert.throws(function() { reader.push(concat([bytes, new Uint8Array(8)])); }, `BinaryDeserializer.Reader must throw on bytes after the end of a save`);
+
+    var done = assert.async();
+    test_stream_outcomes(assert, [
+        { stream: () => stream_of(new Uint8Array(0), 1),                       is_rejected: true, message: `must reject saves that are empty` },
+        { stream: () => stream_of(bytes.subarray(0, 5), 1),                    is_rejected: true, message: `must reject saves that end within the magic string` },
+        { stream: () => stream_of(bytes.subarray(0, BinarySerializer.PREFIX_BYTE_LENGTH + header_byte_length/2), 7),
+                                                                               is_rejected: true, message: `must reject saves that end within the header` },
+        { stream: () => stream_of(bytes.subarray(0, bytes.length-4), 7),       is_rejected: true, message: `must reject saves that end within a section` },
+        { stream: () => stream_of(future_version, 7),                          is_rejected: true, message: `must reject saves of a later version` },
+        { stream: () => stream_of(corrupt_header, 7),                          is_rejected: true, message: `must reject saves whose header is corrupt` },
+        { stream: () => stream_of(missing_section_bytes, 7),                   is_rejected: true, message: `must reject saves that refer to missing sections` },
+    ]).then(done, done);
+});
+QUnit.test(`QuantizedRaster Save tests`, function (assert) {
+    var grid = new Grid(new THREE.IcosahedronGeometry(1, 2));
+    var coverage = Float32Raster(grid);
+    for (var i = 0; i < coverage.length; i++) {
+        coverage[i] = 0.5 + 0.5 * grid.pos.z[i];
+    }
+    var quantized = QuantizedRaster.encode(coverage, QuantizedRaster.Fixed16(grid, 0, 1));
+    var parameters = QuantizedRaster.getParameters(quantized);
+    assert.strictEqual(parameters.buffer.byteLength, 2 * grid.vertices.length, `QuantizedRaster.getParameters must store 2 bytes per cell`);
+    // "is_coverage" indicates whether "loaded" is the parameters of "quantized", and decodes to "coverage"
+    function is_coverage(loaded) {
+        var decoded = QuantizedRaster.decode(QuantizedRaster.FromParameters(loaded, grid));
+        return loaded.encoding === 'fixed16' && 
+            Array.prototype.every.call(decoded, (value, i) => Math.abs(value - coverage[i]) <= quantized.scale/2 + 1e-7);
+    }
+    assert.ok(is_coverage(JsonDeserializer.parameters(JsonSerializer.parameters(parameters))), 
+        `QuantizedRaster.FromParameters must read back what JsonSerializer stored`);
+    var reader = new BinaryDeserializer.Reader();
+    reader.push(concat(BinarySerializer.parameters({ coverage: parameters })));
+    assert.ok(is_coverage(reader.parameters().coverage), `QuantizedRaster.FromParameters must read back what BinarySerializer stored`);
+});
@@ -0,0 +1,148 @@
+/* eslint-env qunit */
+QUnit.module('Models');
+
+QUnit.test(`Memo pure dependency tests`, function (assert) {
+    var source = 1;
+    var computed_count = 0;
+    var a = new Memo(0, () => source);
+    var b = new Memo(0, () => { computed_count++; return 2 * a.value(); }, true, { is_pure: true });
+
+    assert.strictEqual(b.value(), 2, `Memo.value() must compute a pure memo the first time it is called`);
+    assert.strictEqual(computed_count, 1, `Memo.value() must compute a pure memo once`);
+
+    a.invalidate();
+    b.invalidate();
+    assert.strictEqual(b.value(), 2, `Memo.value() must return the last value of a pure memo it skips`);
+    assert.strictEqual(computed_count, 1, `Memo.value() must skip a pure memo whose dependencies recomputed to the same value`);
+
+    source = 3;
+    a.invalidate();
+    b.invalidate();
+    assert.strictEqual(b.value(), 6, `Memo.value() must recompute a pure memo whose dependencies changed`);
+    assert.strictEqual(computed_count, 2, `Memo.value() must recompute a pure memo once when its dependencies changed`);
+
+    b.invalidate();
+    b.value();
+    assert.strictEqual(computed_count, 2, `Memo.value() must skip a pure memo whose dependencies were never invalidated`);
+});
+QUnit.test(`Memo epsilon tests`, function (assert) {
+    var source = 1;
+    var computed_count = 0;
+    var a = new Memo(0, () => source, true, { epsilon: 0.1 });
+    var b = new Memo(0, () => { computed_count++; return a.value(); }, true, { is_pure: true });
+    b.value();
+
+    source = 1.05;
+    a.invalidate();
+    b.invalidate();
+    b.value();
+    assert.strictEqual(computed_count, 1, `Memo.value() must skip a pure memo whose dependencies changed within epsilon`);
+
+    source = 1.09;
+    a.invalidate();
+    b.invalidate();
+    b.value();
+    assert.strictEqual(computed_count, 1, `Memo.value() must compare against the value that dependents last saw, so changes within epsilon can't accumulate`);
+
+    source = 1.5;
+    a.invalidate();
+    b.invalidate();
+    assert.strictEqual(b.value(), 1.5, `Memo.value() must recompute a pure memo whose dependencies changed beyond epsilon`);
+    assert.strictEqual(computed_count, 2, `Memo.value() must recompute a pure memo once when its dependencies changed beyond epsilon`);
+
+    var field = new Float32Array([1, 2, 3]);
+    var c = new Memo(void 0, () => field, true, { epsilon: 0.1 });
+    var d = new Memo(0, () => { computed_count++; return c.value()[0]; }, true, { is_pure: true });
+    d.value();
+    field = new Float32Array([1.05, 2, 3]);
+    c.invalidate();
+    d.invalidate();
+    d.value();
+    assert.strictEqual(computed_count, 3, `Memo.value() must compare typed arrays cell by cell within epsilon`);
+    field = new Float32Array([1.05, 2, 3.5]);
+    c.invalidate();
+    d.invalidate();
+    d.value();
+    assert.strictEqual(computed_count, 4, `Memo.value() must detect a typed array whose cells changed beyond epsilon`);
+});
+QUnit.test(`Memo version tests`, function (assert) {
+    var source = 1;
+    var a = new Memo(0, () => source);
+    var impure = new Memo(0, () => a.value());
+    impure.value();
+    assert.notOk(a.has_pure_dependents, `Memo.has_pure_dependents must not be set by memos that are impure`);
+    var version = a.version;
+    a.invalidate();
+    a.value();
+    assert.strictEqual(a.version, version+1, `Memo.version must increase on every computation if no pure memo depends on it`);
+
+    var pure = new Memo(0, () => a.value(), true, { is_pure: true });
+    pure.value();
+    assert.ok(a.has_pure_dependents, `Memo.has_pure_dependents must be set once a pure memo depends on it`);
+    assert.strictEqual(pure.dependencies[0], a, `Memo.dependencies must record the memos used during computation`);
+    assert.strictEqual(pure.dependency_versions[0], a.version, `Memo.dependency_versions must record the versions used during computation`);
+    var version = a.version;
+    a.invalidate();
+    a.value();
+    assert.strictEqual(a.version, version, `Memo.version must not increase when a value with pure dependents is unchanged`);
+    source = 2;
+    a.invalidate();
+    a.value();
+    assert.strictEqual(a.version, version+1, `Memo.version must increase when a value with pure dependents changes`);
+});
+QUnit.test(`Memo timing tests`, function (assert) {
+    var a = new Memo(0, () => 1);
+    var b = new Memo(0, () => a.value(), true, { is_pure: true, name: 'Models.js memo timing test' });
+    b.value();
+    a.invalidate();
+    b.invalidate();
+    b.value();
+    var timing = Memo.timings['Models.js memo timing test'];
+    assert.strictEqual(timing.computed, 1, `Memo.timings must count the computations of a named memo`);
+    assert.strictEqual(timing.skipped, 1, `Memo.timings must count the skipped computations of a named memo`);
+});
+
+QUnit.test(`Scheduler carry over tests`, function (assert) {
+    var scheduler = new Scheduler(10, 100, 4);
+    var substeps = [];
+    var step = substep => substeps.push(substep);
+    assert.strictEqual(scheduler.advance(4, step), 0, `Scheduler.advance must not step before "min_timestep" has passed`);
+    assert.strictEqual(scheduler.advance(4, step), 0, `Scheduler.advance must not step before "min_timestep" has passed`);
+    assert.strictEqual(scheduler.advance(4, step), 1, `Scheduler.advance must step once "min_timestep" has passed`);
+    assert.strictEqual(substeps[0], 12, `Scheduler.advance must carry over time from advances that did not step`);
+    assert.strictEqual(scheduler.pending_time, 0, `Scheduler.advance must not carry over time that it stepped`);
+    assert.strictEqual(scheduler.advance(0, step), 0, `Scheduler.advance must not step when no time has passed`);
+});
+QUnit.test(`Scheduler substep tests`, function (assert) {
+    var scheduler = new Scheduler(10, 100, 4);
+    var substeps = [];
+    var step = substep => substeps.push(substep);
+    assert.strictEqual(scheduler.advance(250, step), 3, `Scheduler.advance must split steps that exceed "max_timestep"`);
+    assert.ok(substeps.every(substep => substep === 250/3), `Scheduler.advance must split steps into equal substeps`);
+
+    substeps = [];
+    assert.strictEqual(scheduler.advance(1000, step), 4, `Scheduler.advance must run no more than "max_substep_count" substeps`);
+    assert.ok(substeps.every(substep => substep === 250), `Scheduler.advance must take longer substeps once it reaches "max_substep_count"`);
+    assert.strictEqual(substeps.reduce((a, b) => a + b), 1000, `Scheduler.advance must step over all of the time that passed, even past "max_substep_count"`);
+
+    var scheduler = new Scheduler();
+    substeps = [];
+    assert.strictEqual(scheduler.advance(1e20, step), 1, `Scheduler must step once per advance by default`);
+    assert.strictEqual(substeps[0], 1e20, `Scheduler must step over the whole timestep by default`);
+});
+QUnit.test(`Scheduler small timestep tests`, function (assert) {
+    var scheduler = new Scheduler(0, 100, 4);
+    var substeps = [];
+    var step = substep => substeps.push(substep);
+    for (var i = 0; i < 5; i++) {
+        assert.strictEqual(scheduler.advance(1e-3, step), 1, `Scheduler.advance must step on every advance if "min_timestep" is 0, however small the timestep`);
+    }
+    assert.ok(substeps.length === 5 && substeps.every(substep => substep === 1e-3), `Scheduler.advance must step over each small timestep as it is given`);
+    assert.strictEqual(scheduler.pending_time, 0, `Scheduler.advance must not hold back small timesteps`);
+
+    substeps = [];
+    var default_scheduler = new Scheduler();
+    default_scheduler.advance(1, step);
+    default_scheduler.advance(1e-6, step);
+    assert.ok(substeps.length === 2 && substeps[0] === 1 && substeps[1] === 1e-6, `Scheduler must not hold back small timesteps by default`);
+});
@@ -709,3 +709,386 @@ test_equivalence(
 //     mult_vector_field_happy_args, 
 // );
 
+
+// NOTE: grids only switch to 32 bit cell ids above "Grid.MAX_UINT16_VERTEX_COUNT", 
+//   so the threshold is lowered here rather than building a grid of more than 65536 cells.
+//   The cache is bypassed under the lowered threshold, since the ids of the cached voronoi cells depend on it.
+QUnit.test(`Grid 32 bit id tests`, function (assert) {
+    var geometry = new THREE.IcosahedronGeometry(1, 2);
+    var uint16_grid = new Grid(geometry);
+    var max_uint16_vertex_count = Grid.MAX_UINT16_VERTEX_COUNT;
+    Grid.MAX_UINT16_VERTEX_COUNT = 0;
+    try {
+        var uint32_grid = new Grid(geometry, { is_cached: false });
+    } finally {
+        Grid.MAX_UINT16_VERTEX_COUNT = max_uint16_vertex_count;
+    }
+
+    assert.strictEqual(uint16_grid.IdArray, Uint16Array, `Grid must store ids in a Uint16Array at or below Grid.MAX_UINT16_VERTEX_COUNT`);
+    assert.strictEqual(uint32_grid.IdArray, Uint32Array, `Grid must store ids in a Uint32Array above Grid.MAX_UINT16_VERTEX_COUNT`);
+    assert.ok(uint32_grid.vertex_ids instanceof Uint32Array, `Grid.vertex_ids must be a Uint32Array above Grid.MAX_UINT16_VERTEX_COUNT`);
+    assert.ok(uint32_grid.buffer_array_to_cell instanceof Uint32Array, `Grid.buffer_array_to_cell must be a Uint32Array above Grid.MAX_UINT16_VERTEX_COUNT`);
+
+    var id_raster = uint32_grid.createIdRaster();
+    assert.ok(id_raster instanceof Uint32Array, `Grid.createIdRaster must return a Uint32Array above Grid.MAX_UINT16_VERTEX_COUNT`);
+    assert.strictEqual(id_raster.length, uint32_grid.vertices.length, `Grid.createIdRaster must return a raster with a cell for each vertex`);
+    assert.strictEqual(id_raster.grid, uint32_grid, `Grid.createIdRaster must return a raster of its grid`);
+
+    // rotate the grid, so that the ids are not just the identity permutation
+    var rotation = Matrix3x3.RotationAboutAxis(0, 0, 1, 0.3);
+    var pos = VectorField.mult_matrix(uint32_grid.pos, rotation);
+    var uint32_ids = uint32_grid.getNearestIds(pos);
+    var uint16_ids = uint16_grid.getNearestIds(VectorField.mult_matrix(uint16_grid.pos, rotation));
+    assert.ok(uint32_ids instanceof Uint32Array, `Grid.getNearestIds must return a Uint32Array above Grid.MAX_UINT16_VERTEX_COUNT`);
+    assert.ok(Array.prototype.every.call(uint32_ids, (id, i) => id === uint16_ids[i]), 
+        `Grid.getNearestIds must return the same ids regardless of the type that stores them`);
+
+    var values = Uint32Raster(uint32_grid);
+    for (var i = 0; i < values.length; i++) { values[i] = 3*i; }
+    var resampled = Uint32Raster.get_ids(values, uint32_ids);
+    assert.strictEqual(resampled.grid, uint32_grid, `Uint32Raster.get_ids must return a raster of the grid of its ids`);
+    assert.ok(Array.prototype.every.call(resampled, (value, i) => value === 3*uint16_ids[i]), 
+        `Uint32Raster.get_ids must look up values by 32 bit ids`);
+    var float32_resampled = Float32Raster.get_ids(Float32Raster.FromUint32Raster(values), uint32_ids);
+    assert.ok(Array.prototype.every.call(float32_resampled, (value, i) => value === 3*uint16_ids[i]), 
+        `Float32Raster.get_ids must look up values by 32 bit ids`);
+});
+
+// "is_float32_approx" indicates whether every cell of "a" and "b" agrees to within the precision of a float32,
+//   which is as close as a fused loop can get to the same chain of operations, since the chain rounds after each one
+function is_float32_approx(a, b) {
+    for (var i = 0; i < a.length; i++) {
+        if (!(Math.abs(a[i] - b[i]) <= 1e-5 * Math.max(1, Math.abs(b[i])))) {
+            return false;
+        }
+    }
+    return a.length === b.length;
+}
+var expression_grid = new Grid(new THREE.IcosahedronGeometry(1, 2));
+var expression_a = ScalarField.mult_scalar(Float32Raster.FromArray(expression_grid.pos.x, expression_grid), 3);
+var expression_b = Float32Raster.FromArray(expression_grid.pos.y, expression_grid);
+var expression_c = ScalarField.add_scalar(Float32Raster.FromArray(expression_grid.pos.z, expression_grid), 2);
+QUnit.test(`Float32RasterExpression Equivalence tests`, function (assert) {
+    var a = expression_a, b = expression_b, c = expression_c;
+
+    var fused = Float32RasterExpression(a).mult_scalar(2).add_field(b).sub_scalar_term(c, 0.5).max_field(b).clamp(-3, 4).evaluate();
+    var unfused = ScalarField.mult_scalar(a, 2);
+    ScalarField.add_field(unfused, b, unfused);
+    ScalarField.sub_scalar_term(unfused, c, 0.5, unfused);
+    ScalarField.max_field(unfused, b, unfused);
+    Float32RasterInterpolation.clamp(unfused, -3, 4, unfused);
+    assert.ok(is_float32_approx(fused, unfused), 
+        `Float32RasterExpression must behave equivalently to the chain of ScalarField operations it stands in for`);
+
+    var fused = Float32RasterExpression(a).div_field(c).add_field_term(b, c).pow_scalar(2).min_scalar(5).evaluate();
+    var unfused = ScalarField.div_field(a, c);
+    ScalarField.add_field_term(unfused, b, c, unfused);
+    ScalarField.pow_scalar(unfused, 2, unfused);
+    ScalarField.min_scalar(unfused, 5, unfused);
+    assert.ok(is_float32_approx(fused, unfused), 
+        `Float32RasterExpression must behave equivalently to a chain that includes field terms and powers`);
+
+    var fused = Float32RasterExpression(a).smoothstep(-1, 2).mult_field(Float32RasterExpression(b).linearstep(-0.5, 0.5)).evaluate();
+    var unfused = ScalarField.mult_field(Float32RasterInterpolation.smoothstep(-1, 2, a), Float32RasterInterpolation.linearstep(-0.5, 0.5, b));
+    assert.ok(is_float32_approx(fused, unfused), 
+        `Float32RasterExpression must behave equivalently to interpolation, including that of nested expressions`);
+
+    var result = Float32Raster.copy(a);
+    Float32RasterExpression(result).mult_scalar(2).add_field(result).evaluate(result);
+    assert.ok(is_float32_approx(result, ScalarField.mult_scalar(a, 3)), 
+        `Float32RasterExpression must allow its result to be one of its inputs`);
+});
+QUnit.test(`Float32RasterExpression Cache tests`, function (assert) {
+    var a = expression_a, b = expression_b;
+    Float32RasterExpression(a).mult_scalar(2).add_field(b).clamp(0, 1).evaluate();
+    var compiled_count = Float32RasterExpression.compiled.size;
+    var result = Float32RasterExpression(a).mult_scalar(5).add_field(b).clamp(-1, 3).evaluate();
+    assert.strictEqual(Float32RasterExpression.compiled.size, compiled_count, 
+        `Float32RasterExpression must not compile a chain again when only its scalars change`);
+    var unfused = Float32RasterInterpolation.clamp(ScalarField.add_field(ScalarField.mult_scalar(a, 5), b), -1, 3);
+    assert.ok(is_float32_approx(result, unfused), 
+        `Float32RasterExpression must use the scalars it was last given when reusing a compiled chain`);
+    Float32RasterExpression(b).mult_scalar(5).add_field(a).clamp(-1, 3).evaluate();
+    assert.strictEqual(Float32RasterExpression.compiled.size, compiled_count, 
+        `Float32RasterExpression must not compile a chain again when only its rasters change`);
+    Float32RasterExpression(a).mult_scalar(5).sub_field(b).clamp(-1, 3).evaluate();
+    assert.strictEqual(Float32RasterExpression.compiled.size, compiled_count+1, 
+        `Float32RasterExpression must compile a chain whose operations are new`);
+});
+
+QUnit.test(`Grid cache tests`, function (assert) {
+    var meshes = [0.5, 0.6, 0.7, 0.8, 0.9, 1.1].map(radius => new THREE.IcosahedronGeometry(radius, 1));
+    var keys = meshes.map(mesh => Grid.get_cache_key(mesh.faces, mesh.vertices));
+    var grids = meshes.map(mesh => new Grid(mesh));
+    assert.ok(Grid.cache.size <= Grid.MAX_CACHE_ENTRY_COUNT, `Grid.cache must keep no more than Grid.MAX_CACHE_ENTRY_COUNT entries`);
+    assert.notOk(Grid.cache.has(keys[0]), `Grid.cache must drop the least recently used entries`);
+    assert.ok(Grid.cache.has(keys[keys.length-1]), `Grid.cache must keep the most recently used entries`);
+
+    var entry = Grid.get_cache_entry(keys[keys.length - Grid.MAX_CACHE_ENTRY_COUNT]);
+    new Grid(meshes[0]);
+    assert.strictEqual(Grid.get_cache_entry(keys[keys.length - Grid.MAX_CACHE_ENTRY_COUNT]), entry, `Grid.get_cache_entry must mark the entries it returns as recently used`);
+    assert.notOk(Grid.cache.has(keys[keys.length - Grid.MAX_CACHE_ENTRY_COUNT + 1]), `Grid.cache must drop the least recently used entries, even if they were added later`);
+
+    var uncached = new Grid(meshes[1], { is_cached: false });
+    assert.notOk(Grid.cache.has(keys[1]), `Grid must not add to the cache if "is_cached" is false`);
+    assert.ok(Array.prototype.every.call(uncached.arrow_to, (id, i) => id === grids[1].arrow_to[i]), `Grid must derive the same structures whether or not they are cached`);
+
+    // cache entries that are sent between threads can be views into a larger buffer, see "SimulationWorker.js"
+    var offset_entry = Object.assign({}, Grid.get_cache_entry(keys[keys.length-1]));
+    var neighbor_count = new Uint8Array(offset_entry.neighbor_count.length + 16);
+    neighbor_count.set(offset_entry.neighbor_count, 8);
+    offset_entry.neighbor_count = neighbor_count.subarray(8, 8 + offset_entry.neighbor_count.length);
+    Grid.set_cache_entry(keys[keys.length-1], offset_entry);
+    var grid = new Grid(meshes[meshes.length-1]);
+    assert.strictEqual(grid.neighbor_count.length, grid.vertices.length, `Grid.neighbor_count must span only the cells of its cache entry`);
+    assert.ok(Array.prototype.every.call(grid.neighbor_count, (count, i) => count === grids[grids.length-1].neighbor_count[i]), 
+        `Grid.neighbor_count must honor the offset of its cache entry`);
+});
+
+QUnit.test(`VoronoiSphere.updateNearestIds Equivalence tests`, function (assert) {
+    var grid = new Grid(new THREE.IcosahedronGeometry(1, 3));
+    var thresholds = new Float32Array(grid.vertices.length).fill(-Infinity);
+    var result = grid.createIdRaster();
+    var drift = 0;
+    var last_matrix = Matrix3x3.Identity();
+    var is_any_skipped = false;
+    var is_any_looked_up_again = false;
+    // rotations accumulate, from those that are far below the distance of each position to its nearest boundary, to those far above
+    var angles = [0, 1e-5, 1e-4, 1e-4, 1e-3, 1e-2, 1e-2, 0.1, 0.5, 1e-5, 2];
+    var angle = 0;
+    for (var i = 0; i < angles.length; i++) {
+        angle += angles[i];
+        var matrix = Matrix3x3.RotationAboutAxis(0.3, 0.8, 0.52, angle);
+        drift += Matrix3x3.get_max_displacement(matrix, last_matrix);
+        last_matrix = matrix;
+
+        var lookup_count = Array.prototype.filter.call(thresholds, threshold => !(drift < threshold)).length;
+        is_any_skipped = is_any_skipped || (i > 0 && lookup_count < thresholds.length);
+        is_any_looked_up_again = is_any_looked_up_again || (i > 0 && lookup_count > 0);
+
+        grid.updateNearestIds(grid.pos, matrix, drift, thresholds, result);
+        var expected = grid.getNearestIds(VectorField.mult_matrix(grid.pos, matrix));
+        assert.ok(Array.prototype.every.call(result, (id, j) => id === expected[j]), 
+            `VoronoiSphere.updateNearestIds must behave equivalently to VoronoiSphere.getNearestIds after a rotation of ${angle} radians`);
+    }
+    assert.ok(is_any_skipped, `VoronoiSphere.updateNearestIds must skip positions whose drift is below their threshold`);
+    assert.ok(is_any_looked_up_again, `VoronoiSphere.updateNearestIds must look up positions whose drift exceeds their threshold`);
+});
+
+// NOTE: 642 cells is not a multiple of 32, so the last word of a bitset of this grid is only partly made of cells
+var morphology_grid = new Grid(new THREE.IcosahedronGeometry(1, 3));
+// "is_uint8_equal" indicates whether two Uint8Arrays agree cell for cell
+function is_uint8_equal(a, b) {
+    return a.length === b.length && Array.prototype.every.call(a, (value, i) => value === b[i]);
+}
+// "get_morphology_masks" returns masks of "morphology_grid" that have blobs, holes, and isolated cells, along with the empty and universal masks
+function get_morphology_masks() {
+    var grid = morphology_grid;
+    var blob = Uint8Raster(grid);
+    var speckle = Uint8Raster(grid);
+    var universal = Uint8Raster(grid);
+    var empty = Uint8Raster(grid);
+    for (var i = 0; i < blob.length; i++) {
+        blob[i] = grid.pos.x[i] > 0.2 && Math.abs(grid.pos.y[i]) > 0.1? 1 : 0;
+        speckle[i] = (i * 7919) % 13 < 4? 1 : 0;
+    }
+    BinaryMorphology.universal(universal);
+    return { blob: blob, speckle: speckle, universal: universal, empty: empty };
+}
+QUnit.test(`BitsetMorphology Packing tests`, function (assert) {
+    var masks = get_morphology_masks();
+    var last_word = BitsetMorphology.get_word_count(morphology_grid.vertices.length) - 1;
+    var tail_mask = BitsetMorphology.get_tail_mask(morphology_grid.vertices.length);
+    for (var name in masks) {
+        var bitset = BitsetMorphology.pack(masks[name]);
+        assert.strictEqual(bitset.length, last_word+1, `BitsetMorphology.pack must return a word for every 32 cells, rounded up (${name})`);
+        assert.ok(is_uint8_equal(BitsetMorphology.unpack(bitset), masks[name]), `BitsetMorphology.unpack must invert BitsetMorphology.pack (${name})`);
+        assert.strictEqual((bitset[last_word] & ~tail_mask) >>> 0, 0, `BitsetMorphology.pack must leave bits past the last cell empty (${name})`);
+        assert.strictEqual(BitsetMorphology.count(bitset), Uint8Dataset.sum(masks[name]), `BitsetMorphology.count must count the cells that are set (${name})`);
+    }
+    var universal = BitsetMorphology.Bitset(morphology_grid);
+    BitsetMorphology.universal(universal);
+    assert.strictEqual(BitsetMorphology.count(universal), morphology_grid.vertices.length, `BitsetMorphology.universal must set every cell, and nothing past the last`);
+});
+QUnit.test(`BitsetMorphology Boolean Equivalence tests`, function (assert) {
+    var masks = get_morphology_masks();
+    var last_word = BitsetMorphology.get_word_count(morphology_grid.vertices.length) - 1;
+    var tail_mask = BitsetMorphology.get_tail_mask(morphology_grid.vertices.length);
+    for (var name1 in masks) {
+        var a = masks[name1];
+        var A = BitsetMorphology.pack(a);
+        var negation = BitsetMorphology.negation(A);
+        assert.ok(is_uint8_equal(BitsetMorphology.unpack(negation), BinaryMorphology.negation(a)), 
+            `BitsetMorphology.negation must behave equivalently to BinaryMorphology.negation (${name1})`);
+        assert.strictEqual((negation[last_word] & ~tail_mask) >>> 0, 0, `BitsetMorphology.negation must leave bits past the last cell empty (${name1})`);
+        assert.strictEqual(BitsetMorphology.count(negation), a.length - Uint8Dataset.sum(a), `BitsetMorphology.negation must not count bits past the last cell (${name1})`);
+        for (var name2 in masks) {
+            var b = masks[name2];
+            var B = BitsetMorphology.pack(b);
+            var args = `(${name1}, ${name2})`;
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.union(A, B)), BinaryMorphology.union(a, b)), 
+                `BitsetMorphology.union must behave equivalently to BinaryMorphology.union ${args}`);
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.intersection(A, B)), BinaryMorphology.intersection(a, b)), 
+                `BitsetMorphology.intersection must behave equivalently to BinaryMorphology.intersection ${args}`);
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.difference(A, B)), BinaryMorphology.difference(a, b)), 
+                `BitsetMorphology.difference must behave equivalently to BinaryMorphology.difference ${args}`);
+        }
+    }
+});
+QUnit.test(`BitsetMorphology Morphology Equivalence tests`, function (assert) {
+    var masks = get_morphology_masks();
+    for (var name in masks) {
+        var a = masks[name];
+        var A = BitsetMorphology.pack(a);
+        for (var radius = 1; radius <= 4; radius++) {
+            var args = `(${name}, radius ${radius})`;
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.dilation(A, radius)), BinaryMorphology.dilation(a, radius)), 
+                `BitsetMorphology.dilation must behave equivalently to BinaryMorphology.dilation ${args}`);
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.erosion(A, radius)), BinaryMorphology.erosion(a, radius)), 
+                `BitsetMorphology.erosion must behave equivalently to BinaryMorphology.erosion ${args}`);
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.margin(A, radius)), BinaryMorphology.margin(a, radius)), 
+                `BitsetMorphology.margin must behave equivalently to BinaryMorphology.margin ${args}`);
+            assert.ok(is_uint8_equal(BitsetMorphology.unpack(BitsetMorphology.padding(A, radius)), BinaryMorphology.padding(a, radius)), 
+                `BitsetMorphology.padding must behave equivalently to BinaryMorphology.padding ${args}`);
+        }
+    }
+});
+QUnit.test(`BinaryMorphology Radius tests`, function (assert) {
+    var masks = get_morphology_masks();
+    for (var name in masks) {
+        var a = masks[name];
+        var dilation = Uint8Raster.copy(a);
+        var erosion = Uint8Raster.copy(a);
+        for (var radius = 1; radius <= 4; radius++) {
+            dilation = BinaryMorphology.dilation(dilation, 1);
+            erosion = BinaryMorphology.erosion(erosion, 1);
+            var args = `(${name}, radius ${radius})`;
+            assert.ok(is_uint8_equal(BinaryMorphology.dilation(a, radius), dilation), 
+                `BinaryMorphology.dilation must behave equivalently to repeated dilation by a radius of 1 ${args}`);
+            assert.ok(is_uint8_equal(BinaryMorphology.erosion(a, radius), erosion), 
+                `BinaryMorphology.erosion must behave equivalently to repeated erosion by a radius of 1 ${args}`);
+            var result = Uint8Raster.copy(a);
+            assert.ok(is_uint8_equal(BinaryMorphology.dilation(result, radius, result), dilation), 
+                `BinaryMorphology.dilation must allow its result to be its input ${args}`);
+        }
+    }
+});
+QUnit.test(`RasterPool tests`, function (assert) {
+    var pool = new RasterPool();
+    var grid = morphology_grid;
+    var free_list = pool.get_free_list(grid, Float32Raster);
+
+    assert.throws(function() { pool.getFloat32Raster(grid); }, `RasterPool.acquire must throw outside any scope`);
+
+    pool.allocate('outer');
+    var outer = pool.getFloat32Raster(grid);
+    pool.allocate('inner');
+    var inner = pool.getFloat32Raster(grid);
+    var bitset = pool.getBitset(grid);
+    assert.notOk(inner === outer, `RasterPool.acquire must never return a raster that is still acquired`);
+    assert.strictEqual(free_list.length, 0, `RasterPool.acquire must take rasters off their free list`);
+    pool.deallocate('inner');
+    assert.ok(free_list.length === 1 && free_list[0] === inner, `RasterPool.deallocate must return the rasters of its scope to their free list`);
+    assert.ok(pool.get_free_list(grid, BitsetMorphology.Bitset)[0] === bitset, `RasterPool.deallocate must return each raster to the free list of its own type`);
+    assert.ok(pool.getFloat32Raster(grid) === inner, `RasterPool.acquire must reuse rasters that were returned to their free list`);
+    assert.strictEqual(pool.create_count, 3, `RasterPool.acquire must only create rasters if none are free`);
+
+    pool.deallocate('outer');
+    assert.ok(free_list.indexOf(outer) !== -1 && free_list.indexOf(inner) !== -1, `RasterPool.deallocate must return rasters that were acquired within nested scopes`);
+    assert.throws(function() { pool.getFloat32Raster(grid); }, `RasterPool.acquire must throw once every scope is closed`);
+
+    pool.allocate('outer');
+    assert.throws(function() { pool.deallocate('inner'); }, `RasterPool.deallocate must throw if its name does not match the scope it closes`);
+});
+
+// "encode_values" returns the 16 bit encodings of "values" for a QuantizedRaster of the given encoding,
+//   which needn't have the same length as a grid, since kernels only visit the cells of the rasters they're given
+function encode_values(values, encoding, min, max) {
+    var quantized = QuantizedRaster.describe(new Uint16Array(values.length), morphology_grid, encoding, min, max);
+    return QuantizedRaster.encode(new Float32Array(values), quantized);
+}
+// "round_trip_values" returns "values" once they are encoded and decoded by a QuantizedRaster of the given encoding
+function round_trip_values(values, encoding, min, max) {
+    var quantized = encode_values(values, encoding, min, max);
+    return Array.from(QuantizedRaster.decode(quantized, new Float32Array(values.length)));
+}
+QUnit.test(`QuantizedRaster float16 tests`, function (assert) {
+    var cases = [
+        // value                    expected bits   expected decoding       description
+        [0,                         0x0000,         0,                      `zero`],
+        [-0,                        0x8000,         -0,                     `negative zero`],
+        [1,                         0x3c00,         1,                      `one`],
+        [-2,                        0xc000,         -2,                     `negative numbers`],
+        [65504,                     0x7bff,         65504,                  `the largest finite number`],
+        [65519,                     0x7bff,         65504,                  `numbers that round down to the largest finite number`],
+        [65520,                     0x7c00,         Infinity,               `numbers halfway past the largest finite number, which round to infinity`],
+        [-1e6,                      0xfc00,         -Infinity,              `numbers far past the largest finite number`],
+        [Infinity,                  0x7c00,         Infinity,               `infinity`],
+        [-Infinity,                 0xfc00,         -Infinity,              `negative infinity`],
+        [Math.pow(2,-14),           0x0400,         Math.pow(2,-14),        `the smallest normal number`],
+        [Math.pow(2,-24),           0x0001,         Math.pow(2,-24),        `the smallest subnormal number`],
+        [3*Math.pow(2,-24),         0x0003,         3*Math.pow(2,-24),      `subnormal numbers`],
+        [Math.pow(2,-25),           0x0000,         0,                      `numbers halfway to the smallest subnormal number, which round to zero, which is even`],
+        [-Math.pow(2,-25),          0x8000,         -0,                     `negative numbers halfway to the smallest subnormal number`],
+        [Math.pow(2,-25)*(1+Math.pow(2,-20)), 
+                                    0x0001,         Math.pow(2,-24),        `numbers just above halfway to the smallest subnormal number`],
+        [Math.pow(2,-26),           0x0000,         0,                      `numbers too small to represent`],
+        [1.5*Math.pow(2,-24),       0x0002,         2*Math.pow(2,-24),      `subnormal ties, which round to even`],
+        [2.5*Math.pow(2,-24),       0x0002,         2*Math.pow(2,-24),      `subnormal ties, which round to even`],
+        [1+Math.pow(2,-11),         0x3c00,         1,                      `normal ties, which round down to even`],
+        [1+3*Math.pow(2,-11),       0x3c02,         1+Math.pow(2,-9),       `normal ties, which round up to even`],
+        [1+Math.pow(2,-11)+Math.pow(2,-20), 
+                                    0x3c01,         1+Math.pow(2,-10),      `numbers just above a tie`],
+        [2048-0.5,                  0x6800,         2048,                   `numbers that carry into the exponent`],
+    ];
+    var bits = encode_values(cases.map(c => c[0]), 'float16');
+    var decoded = round_trip_values(cases.map(c => c[0]), 'float16');
+    for (var i = 0; i < cases.length; i++) {
+        assert.strictEqual(bits[i], cases[i][1], `encode_float16 must encode ${cases[i][3]} (${cases[i][0]})`);
+        assert.ok(Object.is(decoded[i], cases[i][2]), `decode_float16 must decode ${cases[i][3]} (${cases[i][0]} becomes ${decoded[i]})`);
+    }
+    assert.strictEqual(encode_values([NaN], 'float16')[0] & 0x7c00, 0x7c00, `encode_float16 must encode NaN with every exponent bit set`);
+    assert.ok((encode_values([NaN], 'float16')[0] & 0x3ff) !== 0, `encode_float16 must encode NaN with a mantissa`);
+    assert.ok(isNaN(round_trip_values([NaN], 'float16')[0]), `decode_float16 must decode NaN`);
+
+    var every_bit_pattern = new Uint16Array(65536).map((_, i) => i);
+    var is_every_pattern_preserved = true;
+    var float16 = QuantizedRaster.describe(every_bit_pattern, morphology_grid, 'float16');
+    var reencoded = QuantizedRaster.encode(QuantizedRaster.decode(float16, new Float32Array(65536)), 
+        QuantizedRaster.describe(new Uint16Array(65536), morphology_grid, 'float16'));
+    for (var i = 0; i < 65536; i++) {
+        var is_nan = (i & 0x7c00) === 0x7c00 && (i & 0x3ff) !== 0;
+        if (is_nan? (reencoded[i] & 0x7c00) !== 0x7c00 || (reencoded[i] & 0x3ff) === 0 : reencoded[i] !== i) {
+            is_every_pattern_preserved = false;
+        }
+    }
+    assert.ok(is_every_pattern_preserved, `encode_float16 must invert decode_float16 for every half precision float`);
+});
+QUnit.test(`QuantizedRaster fixed16 tests`, function (assert) {
+    var min = -2;
+    var max = 6;
+    var bits = encode_values([min, max, -3, 1e9, NaN, -Infinity, Infinity], 'fixed16', min, max);
+    assert.strictEqual(bits[0], 0, `encode_fixed16 must encode the minimum as 0`);
+    assert.strictEqual(bits[1], QuantizedRaster.FIXED16_MAX, `encode_fixed16 must encode the maximum as FIXED16_MAX`);
+    assert.strictEqual(bits[2], 0, `encode_fixed16 must clamp values below the minimum`);
+    assert.strictEqual(bits[3], QuantizedRaster.FIXED16_MAX, `encode_fixed16 must clamp values above the maximum`);
+    assert.strictEqual(bits[4], 0, `encode_fixed16 must encode NaN as the offset`);
+    assert.strictEqual(bits[5], 0, `encode_fixed16 must clamp negative infinity`);
+    assert.strictEqual(bits[6], QuantizedRaster.FIXED16_MAX, `encode_fixed16 must clamp infinity`);
+
+    var decoded = round_trip_values([min, max, NaN, 1e9], 'fixed16', min, max);
+    assert.strictEqual(decoded[0], min, `decode_fixed16 must decode 0 as the minimum`);
+    assert.strictEqual(decoded[1], max, `decode_fixed16 must decode FIXED16_MAX as the maximum`);
+    assert.strictEqual(decoded[2], min, `decode_fixed16 must decode NaN as the offset`);
+    assert.strictEqual(decoded[3], max, `decode_fixed16 must decode clamped values as the maximum`);
+
+    var values = [];
+    for (var i = 0; i < 1000; i++) {
+        values.push(Math.fround(min + (max-min) * ((i * 0.6180339887) % 1)));
+    }
+    var step = (max - min) / QuantizedRaster.FIXED16_MAX;
+    var round_trip = round_trip_values(values, 'fixed16', min, max);
+    assert.ok(values.every((value, i) => Math.abs(round_trip[i] - value) <= step/2 + 1e-6), 
+        `decode_fixed16 must return values within half a step of what was encoded`);
+    assert.throws(function() { QuantizedRaster.Fixed16(morphology_grid, 1, 1); }, `QuantizedRaster.Fixed16 must throw if its range is empty`);
+});
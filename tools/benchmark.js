@@ -0,0 +1,82 @@
+/* eslint-env node */
+// "benchmark.js" runs the cpu cases of "tests/scripts/Benchmark.js" from the command line, without a browser.
+// Shader passes need a gpu, so they are only run by "tests/benchmark.html".
+//
+// Usage: node tools/benchmark.js [options]
+//   --details <list>         comma separated icosahedron subdivisions of grids, default "3,4,5"
+//   --filter <regex>         only run cases whose name matches
+//   --output <path>          write the report as JSON
+//   --baseline <path>        compare against a report, default "build/benchmark-baseline.json" if it exists
+//   --save-baseline          write the report to the baseline path, rather than comparing against it
+//   --tolerance <fraction>   fraction of baseline throughput that a case can lose before it regresses, default 0.2
+// The process exits with status 1 if any case regressed.
+//
+// Scripts are loaded in the same order as index.html, less the views, so the model is exactly what the app runs.
+// Run "make" beforehand, so that postcompiled scripts are up to date.
+'use strict';
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const root = path.join(__dirname, '..');
+const default_baseline_path = path.join(root, 'build', 'benchmark-baseline.json');
+
+function parse_args(argv) {
+    const args = { details: void 0, filter: void 0, output: void 0, baseline: void 0, save_baseline: false, tolerance: void 0 };
+    for (let i = 0; i < argv.length; i++) {
+        switch (argv[i]) {
+            case '--details':       args.details = argv[++i].split(',').map(detail => parseInt(detail)); break;
+            case '--filter':        args.filter = new RegExp(argv[++i]); break;
+            case '--output':        args.output = argv[++i]; break;
+            case '--baseline':      args.baseline = argv[++i]; break;
+            case '--save-baseline': args.save_baseline = true; break;
+            case '--tolerance':     args.tolerance = parseFloat(argv[++i]); break;
+            default: throw `benchmark.js: unknown option "${argv[i]}"`;
+        }
+    }
+    return args;
+}
+// "get_scripts" returns the scripts of index.html that the model needs, in order
+function get_scripts() {
+    const html = fs.readFileSync(path.join(root, 'index.html'), 'utf8');
+    const scripts = [];
+    for (const match of html.matchAll(/<script src="([^"]+)"/g)) {
+        const script = match[1];
+        if (/^(libraries\/three\.js\/Three|libraries\/random|libraries\/base64|postcompiled\/|noncompiled\/)/.test(script) &&
+            !/^noncompiled\/views\//.test(script)) {
+            scripts.push(script);
+        }
+    }
+    scripts.push('tests/scripts/Benchmark.js');
+    return scripts;
+}
+
+const args = parse_args(process.argv.slice(2));
+// the scripts expect to run in a browser, or a worker
+global.self = global;
+global.window = global;
+for (const script of get_scripts()) {
+    vm.runInThisContext(fs.readFileSync(path.join(root, script), 'utf8'), { filename: script });
+}
+
+const results = Benchmark.run_cpu_cases(args.details, args.filter, result => console.log(Benchmark.format_result(result)));
+const report = Benchmark.get_report(results);
+report.user_agent = `node ${process.version}`;
+
+if (args.output !== void 0) {
+    fs.writeFileSync(args.output, JSON.stringify(report, null, 2));
+}
+const baseline_path = args.baseline || default_baseline_path;
+if (args.save_baseline) {
+    fs.mkdirSync(path.dirname(baseline_path), { recursive: true });
+    fs.writeFileSync(baseline_path, JSON.stringify(report, null, 2));
+    console.log(`saved baseline to ${baseline_path}`);
+} else if (fs.existsSync(baseline_path)) {
+    const rows = Benchmark.compare(report, JSON.parse(fs.readFileSync(baseline_path, 'utf8')), args.tolerance);
+    rows.forEach(row => console.log(Benchmark.format_comparison(row)));
+    if (rows.some(row => row.is_regression)) {
+        process.exit(1);
+    }
+} else if (args.baseline !== void 0) {
+    throw `benchmark.js: no baseline at "${baseline_path}"`;
+}